@@ -16,6 +16,8 @@ namespace siis {
 class Strategy;
 class Market;
 class AnalyserConfig;
+class SnapshotWriter;
+class SnapshotReader;
 
 /**
  * @brief Strategy analyser per bar
@@ -93,6 +95,20 @@ public:
      */
     virtual o3d::Bool isNeedUpdate(o3d::Double timestamp) const;
 
+    /**
+     * @brief saveState Write the state of the analyser into a snapshot, to skip the warm-up at the next start.
+     * The base implementation writes the identity of the analyser and the next timestamp.
+     * An analyser having indicators with a state kept between two computes (ticks, recursive or streaming
+     * indicators) overrides it to write them after the state of its base.
+     */
+    virtual void saveState(SnapshotWriter &writer) const;
+
+    /**
+     * @brief loadState Restore a state written by saveState.
+     * @return False if the snapshot does not match the configuration of the analyser.
+     */
+    virtual o3d::Bool loadState(SnapshotReader &reader);
+
     /**
      * @brief lastPrice Last updated price (last close price).
      */
@@ -155,6 +171,16 @@ protected:
     inline void incNumLastBars(o3d::Int32 num) { m_numLastBars += num; }
     inline void resetNumLastBars() { m_numLastBars = 0; }
 
+    /**
+     * @brief saveOhlc Write the bars of a circular array, from the oldest to the most recent.
+     */
+    static void saveOhlc(SnapshotWriter &writer, const OhlcCircular &ohlc);
+
+    /**
+     * @brief loadOhlc Replace the content of a circular array by the bars written by saveOhlc.
+     */
+    static o3d::Bool loadOhlc(SnapshotReader &reader, OhlcCircular &ohlc);
+
 private:
 
     Strategy *m_strategy;
@@ -48,6 +48,9 @@ public:
     virtual void process(o3d::Double timestamp, o3d::Double lastTimestamp) override;
     virtual void compute(o3d::Double timestamp, o3d::Double lastTimestamp) = 0;
 
+    virtual void saveState(SnapshotWriter &writer) const override;
+    virtual o3d::Bool loadState(SnapshotReader &reader) override;
+
     virtual o3d::Double lastPrice() const override;
 
     virtual o3d::String formatUnit() const override;
@@ -16,6 +16,8 @@
 
 namespace siis {
 
+class TimeframeCascade;
+
 /**
  * @brief Strategy analyser for a timeframe bar serie.
  * @author Frederic Scherma
@@ -47,17 +49,32 @@ public:
     virtual void process(o3d::Double timestamp, o3d::Double lastTimestamp) override;
     virtual void compute(o3d::Double timestamp, o3d::Double lastTimestamp) = 0;
 
+    virtual void saveState(SnapshotWriter &writer) const override;
+    virtual o3d::Bool loadState(SnapshotReader &reader) override;
+
     virtual o3d::Double lastPrice() const override;
 
     virtual o3d::String formatUnit() const override;
 
     o3d::Double sourceTimeframe() const;
 
+    /**
+     * @brief attachCascade Generate the bars from the base bars of a cascade shared by the analysers of the
+     * strategy, or from the source timeframe if null. The cascade calls updateTick.
+     * @note Done by the cascade of the strategy, added at init when the strategy base timeframe is the tick.
+     */
+    void attachCascade(const TimeframeCascade *cascade);
+
+    const TimeframeCascade* cascade() const { return m_cascade; }
+
     inline const Price& price() const { return m_price; }
     inline const Volume& volume() const { return m_volume; }
 
 private:
 
+    o3d::Double m_sourceTimeframe;
+    const TimeframeCascade *m_cascade;
+
     TimeframeOhlcGen m_ohlcGen;
     OhlcCircular m_ohlc;
 
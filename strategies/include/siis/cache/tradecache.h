@@ -9,6 +9,7 @@
 #define SIIS_TRADECACHE_H
 
 #include "siis/trade/trade.h"
+#include "siis/database/tradedb.h"
 
 namespace siis {
 
@@ -28,14 +29,23 @@ public:
     virtual Cache* cache() = 0;
     virtual const Cache* cache() const = 0;
 
-    virtual void setTrade(const o3d::String &brokerId, const o3d::String &marketId,
+    virtual void setTrade(const o3d::String &brokerId, const o3d::String &accountId, const o3d::String &marketId,
                           const o3d::String &strategyId, const Trade &trade) = 0;
 
-    virtual void delTrade(const o3d::String &brokerId, const o3d::String &marketId,
+    virtual void delTrade(const o3d::String &brokerId, const o3d::String &accountId, const o3d::String &marketId,
                           const o3d::String &strategyId, const Trade &trade) = 0;
 
+    /**
+     * @brief delAll Delete every cached trade of a strategy for a broker (asynchronous).
+     */
     virtual void delAll(const o3d::String &brokerId, const o3d::String &strategyId) = 0;
 
+    /**
+     * @brief setTrades Queue a batch of trade records (set or delete), written at the next execute.
+     * @return False if the cache is not connected, then none of the records are queued.
+     */
+    virtual o3d::Bool setTrades(const std::vector<TradeRecord> &records) = 0;
+
     virtual void execute() = 0;
 };
 
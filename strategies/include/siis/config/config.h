@@ -21,6 +21,10 @@ namespace siis {
 class StrategyConfig;
 class GlobalStatistics;
 class AccountStatistics;
+class ParameterSpace;
+class Validation;
+class Distribution;
+class Pruning;
 
 /**
  * @brief Per market specific config.
@@ -87,7 +91,9 @@ public:
         HANDLER_LIVE = 1,
         HANDLER_BACKTEST,
         HANDLER_LEARN,
-        HANDLER_OPTIMIZE
+        HANDLER_OPTIMIZE,
+        HANDLER_COORDINATOR,
+        HANDLER_WORKER
     };
 
     Config();
@@ -102,6 +108,7 @@ public:
     void loadProfileSpec(const o3d::String filename);
     void loadLearningSpec(const o3d::String filename);
     void loadSupervisorSpec(const o3d::String filename);
+    void loadOptimizationSpec(const o3d::String filename);
 
     HandlerType getHandlerType() const { return m_handlerType; }
     o3d::Bool isPaperMode() const { return m_paperMode; }
@@ -112,6 +119,7 @@ public:
     //
 
     const o3d::String& getBrokerId() const { return m_brokerId; }
+    const o3d::String& getAccountId() const { return m_accountId; }
     const o3d::String& getConnectorHost() const { return m_connectorHost; }
     o3d::UInt32 getConnectorPort() const { return m_connectorPort; }
     const o3d::String& getConnectorKey() { return m_connectorKey; }
@@ -127,6 +135,70 @@ public:
     const o3d::String& getDBUser() const { return m_dbUser; }
     const o3d::String& getDBPwd() const { return m_dbPwd; }
 
+    /**
+     * @brief getDBPoolSize Number of additional connections used by the parallel jobs (market data preparation).
+     * Default to 4 in backtest and optimization modes, at least 1 in these modes, else 0.
+     */
+    o3d::Int32 getDBPoolSize() const { return m_dbPoolSize; }
+
+    /**
+     * @brief getTradeBatchSize Number of pending trade records triggering a write (live mode).
+     */
+    o3d::Int32 getTradeBatchSize() const { return m_tradeBatchSize; }
+
+    /**
+     * @brief getTradeFlushDelay Max delay in seconds before writing the pending trade records (live mode).
+     */
+    o3d::Double getTradeFlushDelay() const { return m_tradeFlushDelay; }
+
+    /**
+     * @brief getTradeHighWatermark Pending trade records queue depth considered as an overflow.
+     */
+    o3d::Int32 getTradeHighWatermark() const { return m_tradeHighWatermark; }
+
+    /**
+     * @brief isOhlcCacheEnabled Local binary cache of the OHLC fetched from the database.
+     */
+    o3d::Bool isOhlcCacheEnabled() const { return m_ohlcCacheEnabled; }
+
+    /**
+     * @brief isDetailedStatistics Retain the results of each trade and the daily samples of the account,
+     * else only the online statistics are computed. Implied by a learning file or a validation.
+     */
+    o3d::Bool isDetailedStatistics() const;
+
+    /**
+     * @brief getOhlcCachePath Root path of the OHLC cache files, default to the markets path.
+     */
+    o3d::String getOhlcCachePath() const {
+        return m_ohlcCachePath.isEmpty() ? m_marketsPath.getFullPathName() : m_ohlcCachePath;
+    }
+
+    //
+    // snapshots
+    //
+
+    /**
+     * @brief isSnapshotRestore Restore the state of the strategies from their last snapshot, in place of the warm-up.
+     */
+    o3d::Bool isSnapshotRestore() const { return m_snapshotRestore; }
+
+    /**
+     * @brief isSnapshotSave Save a snapshot of the state of the strategies at termination.
+     */
+    o3d::Bool isSnapshotSave() const { return m_snapshotSave; }
+
+    /**
+     * @brief getSnapshotMaxGap Maximal age in seconds of a snapshot restored in live mode.
+     */
+    o3d::Double getSnapshotMaxGap() const { return m_snapshotMaxGap; }
+
+    /**
+     * @brief getSnapshotFilename Snapshot file of a strategy instance for a market of the configured broker.
+     * Snapshots path default to the markets path.
+     */
+    o3d::String getSnapshotFilename(const o3d::String &strategyIdentifier, const o3d::String &marketId) const;
+
     //
     // cache
     //
@@ -156,6 +228,25 @@ public:
 
     o3d::Int32 getNumWorkers() const { return m_numWorkers; }
 
+    //
+    // asynchronous logger
+    //
+
+    /**
+     * @brief isLogEnabled False if the logger must be fully disabled for the current handler mode.
+     */
+    o3d::Bool isLogEnabled() const { return m_logEnabled; }
+
+    /**
+     * @brief getLogRingSize Number of records of the per thread log ring.
+     */
+    o3d::Int32 getLogRingSize() const { return m_logRingSize; }
+
+    /**
+     * @brief getLogRateLimits Per channel maximum number of messages per second.
+     */
+    const o3d::StringMap<o3d::Int32>& getLogRateLimits() const { return m_logRateLimits; }
+
     const o3d::String& getStrategy() const { return m_strategy; }
     const o3d::String& getStrategyIdentifier() const { return m_strategyIdentifier; }
 
@@ -177,6 +268,58 @@ public:
      */
     const o3d::String& getLearningFilename() const { return m_learningFilename; }
 
+    /**
+     * @brief getOptimizationFilename Filename defined by loadOptimizationSpec.
+     */
+    const o3d::String& getOptimizationFilename() const { return m_optimizationFilename; }
+
+    /**
+     * @brief getParameterSpace Parameter space of the optimize mode, null if not defined.
+     */
+    const ParameterSpace* getParameterSpace() const { return m_parameterSpace; }
+
+    /**
+     * @brief getValidation Walk-forward or cross-validation of the optimize mode, null if not defined.
+     */
+    const Validation* getValidation() const { return m_validation; }
+
+    /**
+     * @brief getPruning Pruning rules of the backtest and optimize modes, null if not defined.
+     * Defined by the profile, and overridden by the optimization specification.
+     */
+    const Pruning* getPruning() const { return m_pruning; }
+
+    /**
+     * @brief getDistribution Distribution of the optimize mode over a coordinator and workers, null if not defined.
+     * The address could be overridden from the command line.
+     */
+    const Distribution* getDistribution() const { return m_distribution; }
+
+    /**
+     * @brief isResultStoreEnabled Append the results of each candidate of the optimize mode to a binary store.
+     */
+    o3d::Bool isResultStoreEnabled() const { return m_resultStore; }
+
+    /**
+     * @brief getEquityCurveTimeframe Sampling of the equity curve stored per candidate, 0 if not stored.
+     */
+    o3d::Double getEquityCurveTimeframe() const { return m_equityCurveTimeframe; }
+
+    /**
+     * @brief getTraceFilename File of the event trace recorded by the backtest, empty if not recorded.
+     */
+    const o3d::String& getTraceFilename() const { return m_traceFilename; }
+
+    /**
+     * @brief getTraceReference Trace to compare with the recorded one at the end of the backtest, empty if none.
+     */
+    const o3d::String& getTraceReference() const { return m_traceReference; }
+
+    /**
+     * @brief getTraceEpsilon Relative tolerance of the comparison of the traces, 0 for a bitwise comparison.
+     */
+    o3d::Double getTraceEpsilon() const { return m_traceEpsilon; }
+
     /**
      * @brief getAuthor Profile/strategy author nmae.
      */
@@ -247,8 +390,10 @@ public:
 
     /**
      * @brief overwriteLearningFile Overwrite the previously loaded learning file with results of the training.
+     * @param pruned Reason of the pruning of the run, empty if it completed.
      */
-    void overwriteLearningFile(const GlobalStatistics &global, const AccountStatistics &account) const;
+    void overwriteLearningFile(const GlobalStatistics &global, const AccountStatistics &account,
+                               const o3d::String &pruned = o3d::String()) const;
     void printGlobalStats(const GlobalStatistics &global, const AccountStatistics &account) const;
 
     /**
@@ -272,6 +417,7 @@ private:
     o3d::Bool m_noInteractive;
 
     o3d::String m_brokerId;
+    o3d::String m_accountId;
     o3d::String m_connectorHost;
     o3d::UInt32 m_connectorPort;
     o3d::String m_connectorKey;
@@ -282,6 +428,21 @@ private:
     o3d::UInt32 m_dbPort;
     o3d::String m_dbUser;
     o3d::String m_dbPwd;
+    o3d::Int32 m_dbPoolSize;
+
+    o3d::Int32 m_tradeBatchSize;
+    o3d::Double m_tradeFlushDelay;
+    o3d::Int32 m_tradeHighWatermark;
+
+    o3d::Bool m_ohlcCacheEnabled;
+
+    o3d::Bool m_detailedStatistics;
+    o3d::String m_ohlcCachePath;
+
+    o3d::Bool m_snapshotRestore;
+    o3d::Bool m_snapshotSave;
+    o3d::String m_snapshotsPath;
+    o3d::Double m_snapshotMaxGap;
 
     o3d::String m_cacheType;
     o3d::String m_cacheName;
@@ -292,6 +453,10 @@ private:
 
     o3d::Int32 m_numWorkers;
 
+    o3d::Bool m_logEnabled;
+    o3d::Int32 m_logRingSize;
+    o3d::StringMap<o3d::Int32> m_logRateLimits;
+
     o3d::String m_strategy;
     o3d::String m_strategyIdentifier;
 
@@ -312,6 +477,7 @@ private:
     o3d::String m_strategyFilename;
     o3d::String m_supervisorFilename;
     o3d::String m_learningFilename;
+    o3d::String m_optimizationFilename;
 
     o3d::String m_author;
     o3d::DateTime m_created;
@@ -320,6 +486,19 @@ private:
 
     o3d::Double m_initialBalance;
     o3d::CString m_initialCurrency;
+
+    ParameterSpace *m_parameterSpace;
+    Validation *m_validation;
+    Pruning *m_pruning;
+    Distribution *m_distribution;
+    o3d::String m_distributionAddress;
+
+    o3d::Bool m_resultStore;
+    o3d::Double m_equityCurveTimeframe;
+
+    o3d::String m_traceFilename;
+    o3d::String m_traceReference;
+    o3d::Double m_traceEpsilon;
 };
 
 } // namespace siis
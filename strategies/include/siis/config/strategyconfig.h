@@ -249,11 +249,13 @@ public:
     o3d::Bool parseLearningOverrides(const o3d::Dir &basePath, const o3d::String &filename);
 
     /**
-     * @brief parseOverrides In order : strategy or profile and then learning file.
+     * @brief parseOverrides In order : strategy or profile, then learning file and finally the optional
+     * dot formatted parameters (optimize mode candidate).
      * @param config
+     * @param parameters Null or dot formatted parameters.
      * @return
      */
-    o3d::Bool parseOverrides(const Config *config);
+    o3d::Bool parseOverrides(const Config *config, const Json::Value *parameters = nullptr);
 
     /**
      * @brief parseMarketOverrides : Load market specific overrides.
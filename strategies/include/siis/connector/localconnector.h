@@ -147,13 +147,21 @@ protected:
         o3d::CString currency = "USD";
         o3d::Int32 precision = 2;
 
-        std::vector<AccountSample> samples;  //!< per day sample of the state of the account
+        o3d::Bool detailed = true;           //!< retains the samples
+        std::vector<AccountSample> samples;  //!< per day sample of the state of the account, if detailed
+        AccountAccumulator accumulator;      //!< online results of the completed days
         o3d::CStringMap<VirtualAsset> assets;
 
+        AccountSample currentSample;         //!< sample of the current day
+        o3d::Bool hasCurrentSample = false;
+
         o3d::Double updateBalance();
         void updateDrawDown();
         void dailyUpdate(o3d::Double timestamp);
 
+        //! Add the sample of a completed day.
+        void addSample(const AccountSample &sample);
+
         o3d::Double lastUpdateTimestamp = 0.0;
     };
 
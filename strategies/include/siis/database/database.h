@@ -12,8 +12,11 @@
 
 #include <o3d/core/string.h>
 #include <o3d/core/thread.h>
+#include <o3d/core/mutex.h>
 #include <o3d/core/database.h>
 
+#include <vector>
+
 namespace siis {
 
 class OhlcDb;
@@ -25,6 +28,8 @@ class TradeDb;
  * @brief Strategy database connector interface.
  * @author Frederic Scherma
  * @date 2019-03-07
+ * The DAOs query through db(), that is the primary connection or the connection of the pool
+ * acquired by the calling thread.
  */
 class SIIS_API Database : public o3d::Runnable
 {
@@ -48,22 +53,86 @@ public:
     void start();
     void stop();
 
+    /**
+     * @brief setPoolSize Number of additional connections, must be defined before init.
+     * With a pool of 0 there is nothing to acquire, the primary connection being never lent.
+     */
+    void setPoolSize(o3d::Int32 size);
+    o3d::Int32 getPoolSize() const { return m_poolSize; }
+
+    /**
+     * @brief acquire Bind a free connection of the pool to the calling thread, wait if none.
+     * @exception E_InvalidPrecondition If the pool size is 0.
+     */
+    void acquire();
+
+    /**
+     * @brief setNumDedicated Number of connections reserved to long running threads, must be defined before init.
+     * They are not part of the shared pool then never waited for by the parallel jobs.
+     */
+    void setNumDedicated(o3d::Int32 num);
+    o3d::Int32 getNumDedicated() const { return m_numDedicated; }
+
+    /**
+     * @brief acquireDedicated Bind a reserved connection to the calling thread for its whole life.
+     * @return False if none is remaining, then the thread queries through the primary connection.
+     */
+    o3d::Bool acquireDedicated();
+
+    /**
+     * @brief release Release the connection (pooled or dedicated) bound to the calling thread.
+     */
+    void release();
+
+    /**
+     * @brief registerQuery Register a query on the primary connection and on each connection of the pool.
+     */
+    void registerQuery(const o3d::String &name, const o3d::CString &query);
+
     OhlcDb* ohlc();
     RangeBarDb* rangeBar();
     MarketDb* market();
     TradeDb* trade();
 
-    virtual o3d::Database* db() = 0;
+    /**
+     * @brief enableOhlcCache Put a local binary cache in front of the OHLC DAO.
+     * @param path Root path of the cache files.
+     */
+    void enableOhlcCache(const o3d::String &path);
+
+    o3d::Database* db();
 
 protected:
 
     o3d::Thread m_thread;
     o3d::Bool m_running;
 
+    o3d::Database *m_db;    //!< primary connection
+
+    o3d::Int32 m_poolSize;
+    std::vector<o3d::Database*> m_pool;
+    std::vector<o3d::Database*> m_freeConnections;
+
+    o3d::Int32 m_numDedicated;
+    std::vector<o3d::Database*> m_dedicatedConnections;   //!< free reserved connections
+
+    o3d::FastMutex m_poolMutex;
+    o3d::WaitCondition m_poolCondition;
+
     OhlcDb *m_ohlc;
     RangeBarDb *m_rangeBar;
     MarketDb *m_market;
     TradeDb *m_trade;
+
+    OhlcDb *m_ohlcCache;   //!< optional cache in front of m_ohlc
+
+    /**
+     * @brief newConnection Create and connect a new connection to the database.
+     */
+    virtual o3d::Database* newConnection() = 0;
+
+    void createPool();
+    void destroyPool();
 };
 
 } // namespace siis
@@ -0,0 +1,160 @@
+/**
+ * @brief SiiS strategy OHLC local binary cache.
+ * @copyright Copyright (C) 2024 SiiS
+ * @author Frederic SCHERMA (frederic.scherma@gmail.com)
+ * @date 2024-10-07
+ */
+
+#ifndef SIIS_OHLCCACHEDB_H
+#define SIIS_OHLCCACHEDB_H
+
+#include "ohlcdb.h"
+
+#include <o3d/core/mutex.h>
+
+#include <set>
+#include <string>
+
+namespace siis {
+
+/**
+ * @brief Strategy OHLC local binary cache, in front of an OHLC database DAO.
+ * @author Frederic Scherma
+ * @date 2024-10-07
+ *
+ * Bars are stored per (broker, market, timeframe, month) into files of the cache path :
+ * <path>/<broker-id>/<market-id>/O/<timeframe>/<YYYYMM>.dat
+ *
+ * A file is a 64 bytes header followed by the bars, each one of 8 doubles, exactly the memory layout of Ohlc,
+ * so a file is memory mapped and copied as a block into an OhlcArray.
+ *
+ * A month is filled once from the source DAO. A month not fully closed at the time it was written
+ * is invalidated when the source has a more recent bar than the last cached one.
+ * Files are written into a temporary file then renamed, so concurrent processes can share the cache.
+ *
+ * Thread-safe, the parallel jobs of the market data preparation share the instance :
+ * the reads only map the files, and a month is filled by a single thread at time, the others waiting for it.
+ * The source DAO queries through the connection acquired by the calling thread.
+ */
+class SIIS_API OhlcCacheDb : public OhlcDb
+{
+public:
+
+    /**
+     * @param source Source DAO (not owned).
+     * @param path Root path of the cache.
+     */
+    OhlcCacheDb(OhlcDb *source, const o3d::String &path);
+
+    virtual ~OhlcCacheDb() override;
+
+    OhlcDb* source() { return m_source; }
+    const OhlcDb* source() const { return m_source; }
+
+    virtual Database* db() override;
+    virtual const Database* db() const override;
+
+    virtual o3d::Bool fetchOhlc(
+            const o3d::String &brokerId, const o3d::String &marketId,
+            o3d::Double timeframe, o3d::Double timestamp,
+            Ohlc &out) override;
+
+    virtual o3d::Int32 fetchOhlcArrayFromTo(
+            const o3d::String &brokerId, const o3d::String &marketId,
+            o3d::Double timeframe,
+            o3d::Double from, o3d::Double to,
+            OhlcArray &out) override;
+
+    virtual o3d::Int32 fetchOhlcArrayLast(
+            const o3d::String &brokerId, const o3d::String &marketId,
+            o3d::Double timeframe,
+            o3d::Int32 lastN,
+            OhlcArray &out) override;
+
+    virtual o3d::Int32 fetchOhlcArrayLastTo(
+            const o3d::String &brokerId, const o3d::String &marketId,
+            o3d::Double timeframe,
+            o3d::Int32 lastN,
+            o3d::Double to,
+            OhlcArray &out) override;
+
+    virtual o3d::Int32 fetchOhlcArrayFrom(
+            const o3d::String &brokerId, const o3d::String &marketId,
+            o3d::Double timeframe,
+            o3d::Double from,
+            OhlcArray &out) override;
+
+    virtual o3d::Bool getLastOhlc(const o3d::String &brokerId, const o3d::String &marketId,
+            o3d::Double timeframe, Ohlc &out) override;
+
+    /**
+     * @brief Max number of consecutive empty months before stopping a backward search (last N).
+     */
+    static constexpr o3d::Int32 MAX_EMPTY_MONTHS = 12;
+
+private:
+
+    struct Header
+    {
+        o3d::UInt32 magic;
+        o3d::UInt32 version;
+        o3d::Double timeframe;
+        o3d::Int64 count;           //!< number of bars
+        o3d::Double lastTimestamp;  //!< timestamp of the last bar, 0 if none
+        o3d::Double writeTime;      //!< epoch time of the write
+        o3d::Int32 complete;        //!< 1 if the month was closed at write time
+        o3d::Int32 reserved[5];
+    };
+
+    static_assert(sizeof(Header) == 64, "OHLC cache header must be 64 bytes");
+
+    static const o3d::UInt32 MAGIC;
+    static const o3d::UInt32 VERSION;
+
+    OhlcDb *m_source;
+    o3d::String m_path;
+
+    o3d::FastMutex m_fillMutex;
+    o3d::WaitCondition m_fillCondition;
+    std::set<std::string> m_filling;    //!< files being filled
+
+    /**
+     * @brief monthIndex Month index (year*12 + month-1) of a timestamp (UTC).
+     */
+    static o3d::Int32 monthIndex(o3d::Double timestamp);
+
+    /**
+     * @brief monthStart Timestamp of the first second of a month index (UTC).
+     */
+    static o3d::Double monthStart(o3d::Int32 month);
+
+    o3d::CString monthFile(const o3d::String &brokerId, const o3d::String &marketId,
+                           o3d::Double timeframe, o3d::Int32 month, o3d::Bool create) const;
+
+    /**
+     * @brief readMonth Append the cached bars of a month in [from, to] to out, filling the cache if necessary.
+     * @return Number of appended bars.
+     */
+    o3d::Int32 readMonth(const o3d::String &brokerId, const o3d::String &marketId,
+                         o3d::Double timeframe, o3d::Int32 month,
+                         o3d::Double from, o3d::Double to,
+                         OhlcArray &out);
+
+    /**
+     * @brief fillMonth Fill the cache file of a month, or wait for the thread already filling it.
+     */
+    o3d::Bool fillMonth(const o3d::String &brokerId, const o3d::String &marketId,
+                        o3d::Double timeframe, o3d::Int32 month,
+                        const o3d::CString &filename);
+
+    /**
+     * @brief writeMonth Fetch a full month from the source and write the cache file.
+     */
+    o3d::Bool writeMonth(const o3d::String &brokerId, const o3d::String &marketId,
+                         o3d::Double timeframe, o3d::Int32 month,
+                         const o3d::CString &filename);
+};
+
+} // namespace siis
+
+#endif // SIIS_OHLCCACHEDB_H
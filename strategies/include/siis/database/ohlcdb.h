@@ -11,8 +11,26 @@
 #include "siis/ohlc.h"
 #include "siis/database/database.h"
 
+#include <vector>
+
 namespace siis {
 
+/**
+ * @brief Request of a batched OHLC fetch, one per timeframe.
+ * @author Frederic Scherma
+ * @date 2024-10-08
+ */
+struct SIIS_API OhlcRequest
+{
+    o3d::Double timeframe{0.0};
+    o3d::Double from{0.0};      //!< ignored when lastN is defined
+    o3d::Double to{0.0};
+    o3d::Int32 lastN{0};        //!< last N OHLC until to, or 0 for the from/to range
+
+    OhlcArray *out{nullptr};    //!< OHLC are appended in ascending timestamp order
+    o3d::Int32 count{0};        //!< number of fetched OHLC
+};
+
 /**
  * @brief Strategy OHLC (timeframe bar) database DAO.
  * @author Frederic Scherma
@@ -59,6 +77,14 @@ public:
     virtual o3d::Bool getLastOhlc(const o3d::String &brokerId, const o3d::String &marketId,
             o3d::Double timeframe, Ohlc &out) = 0;
 
+    /**
+     * @brief fetchOhlcArrays Fetch many timeframes of a market at once.
+     * Default implementation performs a fetch per request, overloaded when a single round trip is possible.
+     * @return Total number of fetched OHLC.
+     */
+    virtual o3d::Int32 fetchOhlcArrays(const o3d::String &brokerId, const o3d::String &marketId,
+            std::vector<OhlcRequest> &requests);
+
     // virtual void storeOhlc(const o3d::String &brokerId, const o3d::String &marketId, const Ohlc &ohlc) = 0;
 };
 
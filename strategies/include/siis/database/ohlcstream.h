@@ -16,6 +16,9 @@
 #include <o3d/core/templatearray.h>
 #include <o3d/core/instream.h>
 #include <o3d/core/datetime.h>
+#include <o3d/core/mutex.h>
+#include <o3d/core/thread.h>
+#include <o3d/core/runnable.h>
 
 namespace siis {
 
@@ -27,8 +30,14 @@ class OhlcDb;
  * @author Frederic Scherma
  * @date 2019-03-24
  * @todo stream using a list of multiples markets in case of futurs contracts
+ *
+ * Paged reader over OhlcDb::fetchOhlcArrayFromTo. Each page contains up to pageSize bars of the timeframe.
+ * The next page is prefetched by a dedicated thread while the current one is consumed by the backtest clock.
+ * The thread fetches through a connection acquired from the pool, then without pool the pages are fetched
+ * synchronously through the primary connection.
+ * A bar is delivered once it is closed, meaning when its timestamp + timeframe is reached.
  */
-class SIIS_API OhlcStream
+class SIIS_API OhlcStream : public o3d::Runnable
 {
 public:
 
@@ -37,33 +46,40 @@ public:
             const o3d::String &marketPath,
             const o3d::String &brokerId,
             const o3d::String &marketId,
+            o3d::Double timeframe,
+            Ohlc::Type ohlcType,
             const o3d::DateTime &from,
             const o3d::DateTime &to,
-            o3d::Int32 bufferSize = 8192);  //!< multiplied by 8 float per ohlc
+            o3d::Int32 pageSize = 8192,    //!< number of ohlc per page (multiplied by 8 double per ohlc)
+            o3d::Bool prefetch = true);
 
-    ~OhlcStream();
+    virtual ~OhlcStream() override;
 
     const o3d::String& brokerId() const { return m_brokerId; }
     const o3d::String& marketId() const { return m_marketId; }
 
+    o3d::Double timeframe() const { return m_timeframe; }
+    Ohlc::Type ohlcType() const { return m_ohlcType; }
+
     /**
-     * @brief fillNext Fill block of 4 double until timestamp is reached.
-     * @param timestamp Limit timestamp to reach (inclusive).
+     * @brief fillNext Fill block of 8 double until timestamp is reached.
+     * @param timestamp Limit timestamp to reach (inclusive), compared to the close time of the bars.
      * @param out Array where to append the new values.
-     * @return Number of filled ticks.
+     * @return Number of filled ohlc.
      */
     o3d::Int32 fillNext(o3d::Double timestamp, DataArray &out);
 
     /**
-     * @brief fillNext Fill block of 4 double until timestamp is reached in an optimized ohlc atomic array.
-     * @param timestamp Limit timestamp to reach (inclusive).
+     * @brief fillNext Fill ohlc until timestamp is reached in an optimized ohlc atomic array.
+     * @param timestamp Limit timestamp to reach (inclusive), compared to the close time of the bars.
      * @param out Array where to append the new values.
-     * @return Number of filled ticks.
+     * @return Number of filled ohlc.
      */
     o3d::Int32 fillNext(o3d::Double timestamp, OhlcArray &out);
 
+    o3d::Bool finished() const { return m_finished; }
 
-    o3d::Bool finished() const { return (m_cur >= m_to) && m_finished; }
+    virtual o3d::Int32 run(void *) override;
 
 private:
 
@@ -74,22 +90,42 @@ private:
     o3d::String m_brokerId;
     o3d::String m_marketId;
 
+    o3d::Double m_timeframe;
+    Ohlc::Type m_ohlcType;
+
     o3d::DateTime m_from;
     o3d::DateTime m_to;
-    o3d::DateTime m_cur;
 
     o3d::Double m_fromTs;
     o3d::Double m_toTs;
 
-    DataArray m_buffer;
-    // o3d::Int32 m_bufferSize;
+    o3d::Int32 m_pageSize;
+    o3d::Double m_pageFromTs;     //!< begin of the next page to fetch (only modified by the fetcher)
+
+    OhlcArray m_pages[2];
+    OhlcArray *m_page;            //!< current consumed page
+    OhlcArray *m_next;            //!< next page, filled by the fetcher
+
+    o3d::Int32 m_ofs;             //!< next ohlc to deliver from the current page
 
     o3d::Bool m_finished;
-    // o3d::Int32 m_ofs;
+    o3d::Bool m_opened;
+
+    o3d::Bool m_prefetch;
+    o3d::Bool m_running;
+    o3d::Bool m_request;          //!< a page is requested to the fetcher thread
+    o3d::Bool m_nextReady;        //!< next page is ready to be swapped
+    o3d::Bool m_nextEnd;          //!< no more pages after the next one
+
+    o3d::FastMutex m_mutex;
+    o3d::WaitCondition m_condition;
+    o3d::Thread m_thread;
 
-    OhlcDb *m_ohlcDb;
+    Database *m_db;               //!< not owned
+    OhlcDb *m_ohlcDb;             //!< not owned
 
     void bufferize();
+    o3d::Bool fetchPage(OhlcArray &out);
 };
 
 } // namespace siis
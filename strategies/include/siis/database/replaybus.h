@@ -0,0 +1,156 @@
+/**
+ * @brief SiiS strategy shared market data replay bus.
+ * @copyright Copyright (C) 2024 SiiS
+ * @author Frederic SCHERMA (frederic.scherma@gmail.com)
+ * @date 2024-10-10
+ */
+
+#ifndef SIIS_REPLAYBUS_H
+#define SIIS_REPLAYBUS_H
+
+#include "../base.h"
+#include "../tick.h"
+#include "../ohlc.h"
+#include "../datasource.h"
+
+#include <o3d/core/datetime.h>
+#include <o3d/core/mutex.h>
+#include <o3d/core/templatearray.h>
+
+#include <atomic>
+
+namespace siis {
+
+class Database;
+class Market;
+class Strategy;
+class ReplayBus;
+class TickStream;
+class OhlcStream;
+
+/**
+ * @brief Immutable and reference counted chunk of decoded market data for one timestep.
+ * @author Frederic Scherma
+ * @date 2024-10-10
+ * Consumed by pointer by any number of strategies, each consumer calling release once done.
+ * The last release gives the chunk back to its bus for reuse.
+ */
+class SIIS_API ReplayChunk
+{
+public:
+
+    const TickArray& ticks() const { return m_ticks; }
+    const OhlcArray& ohlcs(Ohlc::Type ohlcType) const { return m_ohlcs[ohlcType]; }
+
+    o3d::Bool hasTicks() const { return m_ticks.getSize() > 0; }
+    o3d::Bool hasOhlcs(Ohlc::Type ohlcType) const { return m_ohlcs[ohlcType].getSize() > 0; }
+
+    //! Timestamp of the last tick.
+    o3d::Double tickTimestamp() const { return m_tickTimestamp; }
+
+    //! Close timestamp of the last ohlc of the type.
+    o3d::Double ohlcTimestamp(Ohlc::Type ohlcType) const { return m_ohlcTimestamps[ohlcType]; }
+
+    //! Timestamp of the most recent data of the chunk.
+    o3d::Double lastTimestamp() const { return m_lastTimestamp; }
+
+    /**
+     * @brief release Release one reference, the last one gives back the chunk to the bus.
+     */
+    void release() const;
+
+private:
+
+    friend class ReplayBus;
+
+    ReplayChunk(ReplayBus *bus);
+
+    ReplayBus *m_bus;
+
+    TickArray m_ticks;
+    OhlcArray m_ohlcs[Ohlc::NUM_TYPE];
+
+    o3d::Double m_tickTimestamp;
+    o3d::Double m_ohlcTimestamps[Ohlc::NUM_TYPE];
+    o3d::Double m_lastTimestamp;
+
+    mutable std::atomic<o3d::Int32> m_refCount;
+
+    void reset();
+};
+
+/**
+ * @brief Replay bus of a market for a time range, with a single reader per data source.
+ * @author Frederic Scherma
+ * @date 2024-10-10
+ * The data are decoded once per timestep into a chunk, shared with every consumers, then any number
+ * of strategies on the same market cost a single decoding. Only one timeframe per ohlc type.
+ */
+class SIIS_API ReplayBus
+{
+public:
+
+    ReplayBus(Database *database,
+              const o3d::String &marketPath,
+              const o3d::String &brokerId,
+              const o3d::String &marketId,
+              const o3d::DateTime &from,
+              const o3d::DateTime &to);
+
+    ~ReplayBus();
+
+    const o3d::String& marketId() const { return m_marketId; }
+
+    /**
+     * @brief subscribe Create the reader of the data source if not already existing.
+     * @return False if the source is not supported or if another timeframe is already streamed for this ohlc type.
+     */
+    o3d::Bool subscribe(const DataSource &dataSource);
+
+    o3d::Bool hasTickStream() const { return m_tickStream != nullptr; }
+
+    const OhlcStream* ohlcStream(Ohlc::Type ohlcType) const { return m_ohlcStreams[ohlcType]; }
+
+    /**
+     * @brief next Decode the data until timestamp into a chunk referenced numConsumers times.
+     * @return A chunk or null if there is nothing new for this timestep.
+     */
+    const ReplayChunk* next(o3d::Double timestamp, o3d::Int32 numConsumers);
+
+    /**
+     * @brief feedStrategy Inject the ticks (through Strategy::feedTicks) and the closed ohlc of a chunk into a
+     * strategy, and update its market prices.
+     * The chunk is not released. Thread-safe as long as each strategy and market is fed by a single thread.
+     */
+    void feedStrategy(Strategy *strategy, Market *market, const ReplayChunk *chunk) const;
+
+    //! Number of chunks still referenced by some consumers.
+    o3d::Int32 numPendingChunks() const;
+
+private:
+
+    friend class ReplayChunk;
+
+    Database *m_database;
+
+    o3d::String m_marketPath;
+    o3d::String m_brokerId;
+    o3d::String m_marketId;
+
+    o3d::DateTime m_from;
+    o3d::DateTime m_to;
+
+    TickStream *m_tickStream;
+    OhlcStream *m_ohlcStreams[Ohlc::NUM_TYPE];  //!< one per ohlc type, indexed by Ohlc::Type
+
+    mutable o3d::FastMutex m_mutex;
+
+    o3d::TemplateArray<ReplayChunk*> m_freeChunks;
+    o3d::Int32 m_numChunks;
+
+    void recycle(ReplayChunk *chunk);
+};
+
+} // namespace siis
+
+#endif // SIIS_REPLAYBUS_H
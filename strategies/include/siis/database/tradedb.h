@@ -10,10 +10,46 @@
 
 #include "siis/trade/trade.h"
 
+#include <vector>
+
 namespace siis {
 
 class Database;
 
+/**
+ * @brief Serialized state of a trade, as persisted into the database and the cache.
+ * @author Frederic Scherma
+ * @date 2024-10-05
+ * It is a snapshot, then it can be queued and written later from another thread.
+ */
+struct SIIS_API TradeRecord
+{
+    TradeRecord();
+
+    TradeRecord(const o3d::String &brokerId, const o3d::String &accountId, const o3d::String &marketId,
+                const o3d::String &strategyId, const Trade &trade);
+
+    TradeRecord(const o3d::String &brokerId, const o3d::String &accountId, const o3d::String &marketId,
+                const o3d::String &strategyId, o3d::Int32 tradeId);
+
+    o3d::CString brokerId;
+    o3d::CString accountId;
+    o3d::CString marketId;
+    o3d::CString strategyId;
+
+    o3d::Int32 tradeId;
+    o3d::Int32 tradeType;
+
+    o3d::Bool removed;      //!< true if the trade must be deleted
+
+    o3d::CString data;      //!< JSON object of the trade state
+
+    /**
+     * @brief key Unique key of the trade (strategy, broker, market, trade-id).
+     */
+    o3d::CString key() const;
+};
+
 /**
  * @brief Strategy trade database DAO.
  * @author Frederic Scherma
@@ -34,8 +70,15 @@ public:
 
     virtual std::list<Trade*> fetchTradeList(const o3d::String &brokerId, const o3d::String &marketId) = 0;
 
-    virtual void storeTrade(const o3d::String &brokerId, const o3d::String &marketId,
+    virtual void storeTrade(const o3d::String &brokerId, const o3d::String &accountId, const o3d::String &marketId,
                             const o3d::String &strategyId, const Trade &trade) = 0;
+
+    /**
+     * @brief storeTrades Write a batch of trade records, using multi-rows upsert as possible.
+     * Removed records delete the related trades.
+     * @return Number of processed records.
+     */
+    virtual o3d::Int32 storeTrades(const std::vector<TradeRecord> &records) = 0;
 };
 
 } // namespace siis
@@ -0,0 +1,146 @@
+/**
+ * @brief SiiS strategy asynchronous trade persistence.
+ * @copyright Copyright (C) 2024 SiiS
+ * @author Frederic SCHERMA (frederic.scherma@gmail.com)
+ * @date 2024-10-05
+ */
+
+#ifndef SIIS_TRADESTORE_H
+#define SIIS_TRADESTORE_H
+
+#include "tradedb.h"
+
+#include <o3d/core/mutex.h>
+#include <o3d/core/thread.h>
+#include <o3d/core/runnable.h>
+#include <o3d/core/stringmap.h>
+
+#include <vector>
+
+namespace siis {
+
+class Database;
+class TradeCache;
+
+/**
+ * @brief SiiS strategy asynchronous trade persistence.
+ * @author Frederic Scherma
+ * @date 2024-10-05
+ *
+ * Trade changes are enqueued from the strategy threads as serialized records, and coalesced per trade :
+ * only the last state of a trade is kept until the next flush.
+ *
+ * A background thread flushes the pending records in batches to the database (multi-rows upsert)
+ * and to the cache (pipelined commands), when the batch size is reached or after the flush delay.
+ *
+ * Producers never wait for the database. If the pending queue exceeds the high watermark
+ * the flush is immediately triggered and the event is counted into the metrics.
+ *
+ * The thread writes through a dedicated connection of the database, that must be reserved before starting.
+ * A batch failed on the database or refused by the disconnected cache is put back into the pending records
+ * (unless a newer state of the trade is pending) and retried at the next flush, the writes being idempotent.
+ */
+class SIIS_API TradeStore : public o3d::Runnable
+{
+public:
+
+    struct Metrics
+    {
+        o3d::UInt64 enqueued = 0;         //!< number of enqueued changes
+        o3d::UInt64 coalesced = 0;        //!< number of changes merged with a pending one
+        o3d::UInt64 written = 0;          //!< number of records written to the database
+        o3d::UInt64 batches = 0;          //!< number of flushes
+        o3d::UInt64 overflows = 0;        //!< number of times the high watermark was exceeded
+        o3d::UInt64 failures = 0;         //!< number of failed flushes
+        o3d::UInt64 retried = 0;          //!< number of records put back after a failed flush
+
+        o3d::Int32 pending = 0;           //!< current queue depth
+        o3d::Int32 maxPending = 0;        //!< max reached queue depth
+
+        o3d::Double lastFlushTime = 0.0;  //!< duration of the last flush in seconds
+        o3d::Double maxFlushTime = 0.0;   //!< max duration of a flush in seconds
+    };
+
+    /**
+     * @param database Database connector, the trade DAO is used, can be null.
+     * @param tradeCache Cache DAO, can be null.
+     * @param batchSize Number of pending records triggering a flush.
+     * @param flushDelay Max delay in seconds before flushing pending records.
+     * @param highWatermark Queue depth considered as an overflow.
+     */
+    TradeStore(Database *database,
+               TradeCache *tradeCache,
+               o3d::Int32 batchSize = 64,
+               o3d::Double flushDelay = 0.5,
+               o3d::Int32 highWatermark = 4096);
+
+    virtual ~TradeStore() override;
+
+    /**
+     * @brief start Start the writer thread.
+     * @exception E_InvalidPrecondition If the database has no dedicated connection.
+     */
+    void start();
+    void stop();
+
+    /**
+     * @brief storeTrade Enqueue the current state of a trade (thread-safe).
+     */
+    void storeTrade(const o3d::String &brokerId, const o3d::String &accountId, const o3d::String &marketId,
+                    const o3d::String &strategyId, const Trade &trade);
+
+    /**
+     * @brief removeTrade Enqueue the removal of a trade (thread-safe).
+     */
+    void removeTrade(const o3d::String &brokerId, const o3d::String &accountId, const o3d::String &marketId,
+                     const o3d::String &strategyId, o3d::Int32 tradeId);
+
+    /**
+     * @brief flush Write any pending records from the calling thread.
+     */
+    void flush();
+
+    /**
+     * @brief metrics Back-pressure and throughput metrics (copy).
+     */
+    Metrics metrics() const;
+
+    virtual o3d::Int32 run(void *) override;
+
+private:
+
+    Database *m_database;
+    TradeDb *m_tradeDb;
+    TradeCache *m_tradeCache;
+
+    o3d::Int32 m_batchSize;
+    o3d::Double m_flushDelay;
+    o3d::Int32 m_highWatermark;
+
+    o3d::Bool m_running;
+    o3d::Thread m_thread;
+
+    mutable o3d::FastMutex m_mutex;     //!< protect the pending records and the metrics
+    o3d::FastMutex m_flushMutex;        //!< serialize the flushes
+
+    std::vector<TradeRecord> m_pending;
+    std::vector<TradeRecord> m_writing;
+
+    o3d::CStringMap<size_t> m_index;    //!< trade key to index into pending records
+
+    o3d::Double m_lastFlush;
+    o3d::Bool m_urgent;
+    o3d::Bool m_failed;                 //!< last flush failed, retry after a delay
+
+    Metrics m_metrics;
+
+    void enqueue(TradeRecord &record);
+    o3d::Int32 doFlush();
+
+    //! put back the failed records, a newer pending state of the same trade is kept (must be locked)
+    o3d::Int32 requeue();
+};
+
+} // namespace siis
+
+#endif // SIIS_TRADESTORE_H
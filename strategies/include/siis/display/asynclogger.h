@@ -0,0 +1,383 @@
+/**
+ * @brief SiiS strategy asynchronous and deferred format logger.
+ * @copyright Copyright (C) 2024 SiiS
+ * @author Frederic SCHERMA (frederic.scherma@gmail.com)
+ * @date 2024-10-02
+ */
+
+#ifndef SIIS_ASYNCLOGGER_H
+#define SIIS_ASYNCLOGGER_H
+
+#include "../base.h"
+
+#include <o3d/core/string.h>
+#include <o3d/core/mutex.h>
+#include <o3d/core/thread.h>
+#include <o3d/core/runnable.h>
+#include <o3d/core/stringmap.h>
+
+#include <atomic>
+#include <vector>
+#include <cstring>
+
+namespace siis {
+
+class Displayer;
+class Handler;
+
+/**
+ * @brief Raw argument of a binary log record. Formatting is done by the logger thread.
+ */
+struct SIIS_API LogArg
+{
+    enum Type : o3d::UInt8
+    {
+        ARG_NONE = 0,
+        ARG_INT = 1,
+        ARG_DOUBLE = 2,
+        ARG_STR = 3,
+        ARG_TIMESTAMP = 4     //!< formatted as a datetime by the logger thread
+    };
+
+    static constexpr o3d::Int32 MAX_STR_LEN = 15;
+
+    Type type;
+    o3d::Int8 decimals;   //!< -1 mean default formatting for ARG_DOUBLE
+
+    union {
+        o3d::Int32 i;
+        o3d::Double d;
+        char s[MAX_STR_LEN+1];
+    };
+
+    /**
+     * @brief dec Double argument formatted with a fixed number of decimals.
+     */
+    static LogArg dec(o3d::Double v, o3d::Int32 decimals)
+    {
+        LogArg a;
+        a.type = ARG_DOUBLE;
+        a.decimals = static_cast<o3d::Int8>(decimals);
+        a.d = v;
+        return a;
+    }
+
+    /**
+     * @brief ts Timestamp argument formatted as a datetime.
+     */
+    static LogArg ts(o3d::Double v)
+    {
+        LogArg a;
+        a.type = ARG_TIMESTAMP;
+        a.decimals = -1;
+        a.d = v;
+        return a;
+    }
+};
+
+inline void setLogArg(LogArg &a, const LogArg &v) { a = v; }
+inline void setLogArg(LogArg &a, o3d::Int32 v) { a.type = LogArg::ARG_INT; a.i = v; }
+inline void setLogArg(LogArg &a, o3d::Double v) { a.type = LogArg::ARG_DOUBLE; a.decimals = -1; a.d = v; }
+inline void setLogArg(LogArg &a, const char *v)
+{
+    a.type = LogArg::ARG_STR;
+    strncpy(a.s, v, LogArg::MAX_STR_LEN);
+    a.s[LogArg::MAX_STR_LEN] = '\0';
+}
+
+/**
+ * @brief Binary log record. Fixed size, no allocation.
+ * A preformatted text (legacy Handler::log path) is stored in UTF-8 in place of the arguments,
+ * continued into the next records of the ring if longer.
+ */
+struct SIIS_API LogRecord
+{
+    static constexpr o3d::Int32 MAX_ARGS = 8;
+    static constexpr o3d::Int32 MAX_ID_LEN = 31;
+    static constexpr o3d::Int32 MAX_UNIT_LEN = 7;
+
+    static constexpr o3d::Int32 TEXT_SIZE = MAX_ARGS * static_cast<o3d::Int32>(sizeof(LogArg));
+    static constexpr o3d::Int32 MAX_TEXT_RECORDS = 8;   //!< longer texts are truncated
+
+    o3d::Double timestamp;
+    o3d::UInt16 formatId;     //!< 0 mean a preformatted text
+    o3d::UInt8 numArgs;       //!< or number of records of a text, this one included
+
+    o3d::Int8 type;           //!< message level of a text
+    o3d::Int16 channel;       //!< channel of a text
+    o3d::UInt16 textLen;      //!< bytes of text in this record
+
+    char marketId[MAX_ID_LEN+1];
+    char unit[MAX_UNIT_LEN+1];
+
+    union {
+        LogArg args[MAX_ARGS];
+        char text[TEXT_SIZE];   //!< not null terminated
+    };
+};
+
+/**
+ * @brief Single producer single consumer lock-free ring of log records.
+ * One ring is allocated per producer thread, the logger thread is the unique consumer.
+ */
+class SIIS_API LogRing
+{
+public:
+
+    LogRing(o3d::UInt32 capacity);
+    ~LogRing();
+
+    /**
+     * @brief reserve Return the first of the next count writable records or nullptr if the ring is full
+     * (producer side).
+     */
+    inline LogRecord* reserve(o3d::UInt32 count = 1)
+    {
+        const o3d::UInt32 head = m_head.load(std::memory_order_relaxed);
+        if (head - m_tail.load(std::memory_order_acquire) + count > m_mask + 1) {
+            return nullptr;
+        }
+
+        return &m_records[head & m_mask];
+    }
+
+    /**
+     * @brief commit Publish the previously reserved records (producer side).
+     */
+    inline void commit(o3d::UInt32 count = 1)
+    {
+        m_head.store(m_head.load(std::memory_order_relaxed) + count, std::memory_order_release);
+    }
+
+    /**
+     * @brief following Record after a reserved or published one, in the order of the ring.
+     */
+    inline LogRecord* following(const LogRecord *record)
+    {
+        return &m_records[static_cast<o3d::UInt32>(record - m_records + 1) & m_mask];
+    }
+
+    /**
+     * @brief front Return the oldest published record or nullptr if empty (consumer side).
+     */
+    inline LogRecord* front()
+    {
+        const o3d::UInt32 tail = m_tail.load(std::memory_order_relaxed);
+        if (tail == m_head.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+
+        return &m_records[tail & m_mask];
+    }
+
+    /**
+     * @brief pop Release the record returned by front and its following records (consumer side).
+     */
+    inline void pop(o3d::UInt32 count = 1)
+    {
+        m_tail.store(m_tail.load(std::memory_order_relaxed) + count, std::memory_order_release);
+    }
+
+private:
+
+    LogRecord *m_records;
+    o3d::UInt32 m_mask;
+
+    alignas(64) std::atomic<o3d::UInt32> m_head;
+    alignas(64) std::atomic<o3d::UInt32> m_tail;
+};
+
+/**
+ * @brief SiiS strategy asynchronous and deferred format logger.
+ * @author Frederic Scherma
+ * @date 2024-10-02
+ *
+ * The hot path (strategy, analysers, trade manager on the workers threads) only records a format identifier
+ * and the raw arguments into a per thread lock-free ring. The datetime and string formatting and the call to
+ * the displayer are done by a dedicated background thread.
+ *
+ * Formats are registered once (at strategy initialization) and attached to a channel. Each channel can have a
+ * rate limit in messages per second, exceeding messages are dropped and counted.
+ *
+ * The logger can be disabled, for example during backtesting or optimization, then only the warnings and
+ * the errors are recorded.
+ */
+class SIIS_API AsyncLogger : public o3d::Runnable
+{
+public:
+
+    static constexpr o3d::Int32 MAX_FORMATS = 256;
+    static constexpr o3d::Int32 MAX_CHANNELS = 64;
+
+    AsyncLogger(Handler *handler, Displayer *displayer, o3d::UInt32 ringSize = 4096);
+    virtual ~AsyncLogger() override;
+
+    void start();
+    void stop();
+
+    void setEnabled(o3d::Bool enabled) { m_enabled.store(enabled, std::memory_order_relaxed); }
+    o3d::Bool enabled() const { return m_enabled.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief setRateLimit Maximum number of messages per second for a channel, 0 mean unlimited.
+     * @note Must be defined before the registration of the related formats.
+     */
+    void setRateLimit(const o3d::String &channel, o3d::Int32 maxPerSecond);
+
+    /**
+     * @brief registerFormat Register a message format (using {n} placeholders) for a channel.
+     * @return A format identifier greater than 0, or 0 if the table of formats is full.
+     * Registering twice the same channel and pattern returns the same identifier.
+     */
+    o3d::UInt16 registerFormat(const o3d::String &channel,
+                               const o3d::String &pattern,
+                               o3d::System::MessageLevel type = o3d::System::MSG_INFO);
+
+    /**
+     * @brief log Record a message using a registered format and its raw arguments.
+     * @return false if disabled (except for the warnings and errors), rate limited,
+     * or the ring of the current thread is full.
+     */
+    template<typename ...Args>
+    o3d::Bool log(o3d::UInt16 formatId, const o3d::CString &marketId, const char *unit, const Args&... args)
+    {
+        static_assert(sizeof...(Args) <= LogRecord::MAX_ARGS, "Too many log arguments");
+
+        LogRing *ring = nullptr;
+        LogRecord *record = reserve(formatId, marketId, ring);
+        if (!record) {
+            return false;
+        }
+
+        copyText(record->unit, LogRecord::MAX_UNIT_LEN, unit);
+
+        record->numArgs = static_cast<o3d::UInt8>(sizeof...(Args));
+        fillArgs(record->args, args...);
+
+        ring->commit();
+        return true;
+    }
+
+    //! Same with the unit given as a string, copied without allocation.
+    template<typename ...Args>
+    o3d::Bool log(o3d::UInt16 formatId, const o3d::CString &marketId, const o3d::String &unit, const Args&... args)
+    {
+        static_assert(sizeof...(Args) <= LogRecord::MAX_ARGS, "Too many log arguments");
+
+        LogRing *ring = nullptr;
+        LogRecord *record = reserve(formatId, marketId, ring);
+        if (!record) {
+            return false;
+        }
+
+        copyText(record->unit, LogRecord::MAX_UNIT_LEN, unit);
+
+        record->numArgs = static_cast<o3d::UInt8>(sizeof...(Args));
+        fillArgs(record->args, args...);
+
+        ring->commit();
+        return true;
+    }
+
+    /**
+     * @brief logText Record a preformatted message (legacy Handler::log path).
+     * The message is copied into the fixed size records, datetime formatting and display are still deferred
+     * to the logger thread. Recorded even if disabled for the warnings and errors.
+     */
+    o3d::Bool logText(const o3d::String &unit,
+                      const o3d::String &marketId,
+                      const o3d::String &channel,
+                      const o3d::String &msg,
+                      o3d::System::MessageLevel type = o3d::System::MSG_INFO);
+
+    /**
+     * @brief flush Process any pending records from the calling thread. Useful at termination.
+     */
+    void flush();
+
+    /**
+     * @brief numDropped Total number of dropped messages (full rings and rate limits).
+     */
+    o3d::UInt32 numDropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+    virtual o3d::Int32 run(void *) override;
+
+private:
+
+    struct Channel
+    {
+        o3d::String name;
+        std::atomic<o3d::Int32> maxPerSecond{0};
+
+        std::atomic<o3d::UInt64> window{0};   //!< second of the window in the high part, count in the low part
+    };
+
+    struct Format
+    {
+        o3d::String pattern;
+        o3d::Int32 channel{-1};
+        o3d::System::MessageLevel type{o3d::System::MSG_INFO};
+    };
+
+    Handler *m_handler;
+    Displayer *m_displayer;
+
+    o3d::UInt32 m_ringSize;
+    o3d::UInt32 m_uid;
+
+    std::atomic<bool> m_enabled;
+    std::atomic<bool> m_running;   //!< written by start/stop, read by the logger thread
+
+    o3d::FastMutex m_mutex;
+    o3d::Thread m_thread;
+
+    std::vector<LogRing*> m_rings;
+
+    Channel m_channels[MAX_CHANNELS];
+    Format m_formats[MAX_FORMATS];
+
+    std::atomic<o3d::Int32> m_numChannels;
+    std::atomic<o3d::Int32> m_numFormats;
+
+    o3d::StringMap<o3d::Int32> m_rateLimits;
+
+    std::atomic<o3d::UInt32> m_dropped;
+    o3d::UInt32 m_reportedDropped;
+
+    //! Warnings and errors are recorded even if disabled.
+    static inline o3d::Bool isUrgent(o3d::System::MessageLevel type)
+    {
+        return type == o3d::System::MSG_WARNING || type == o3d::System::MSG_ERROR ||
+               type == o3d::System::MSG_CRITICAL;
+    }
+
+    //! Copy and truncate to maxLen chars, null terminated.
+    static void copyText(char *out, o3d::Int32 maxLen, const char *text);
+    static void copyText(char *out, o3d::Int32 maxLen, const o3d::String &text);
+
+    //! Encode in UTF-8 into at most size bytes, without cutting a char. Return the number of bytes.
+    static o3d::Int32 encodeText(char *out, o3d::Int32 size, const o3d::String &text);
+
+    LogRecord* reserve(o3d::UInt16 formatId, const o3d::CString &marketId, LogRing *&ring);
+    LogRing* threadRing();
+
+    o3d::Int32 channelId(const o3d::String &channel);
+    o3d::Int32 textChannelId(const o3d::String &channel);
+    o3d::Bool acceptChannel(o3d::Int32 channel);
+
+    o3d::Int32 drain();
+    void output(LogRing &ring, const LogRecord &record);
+
+    inline void fillArgs(LogArg *) {}
+
+    template<typename T, typename ...Args>
+    inline void fillArgs(LogArg *out, const T &v, const Args&... args)
+    {
+        setLogArg(*out, v);
+        fillArgs(out+1, args...);
+    }
+};
+
+} // namespace siis
+
+#endif // SIIS_ASYNCLOGGER_H
@@ -24,6 +24,8 @@ class Cache;
 class Market;
 class Strategy;
 class TraderProxy;
+class AsyncLogger;
+class TradeStore;
 
 /**
  * @brief SiiS strategy handler processing interface.
@@ -140,6 +142,16 @@ public:
      */
     virtual Cache *cache() = 0;
 
+    /**
+     * @brief tradeStore Asynchronous trade persistence, or nullptr if trades are not persisted (default).
+     */
+    virtual TradeStore* tradeStore();
+
+    /**
+     * @brief logger Asynchronous logger of the handler, for deferred format messages.
+     */
+    virtual AsyncLogger* logger() = 0;
+
     /**
      * @brief log Log a message throught the message logger of the handler.
      * @param unit Bar model (timeframe or non-temporal bar) related to the message or en empty string.
@@ -0,0 +1,130 @@
+/**
+ * @brief SiiS ATR based support/resistance indicator.
+ * @copyright Copyright (C) 2024 SiiS
+ * @author Frederic SCHERMA (frederic.scherma@gmail.com)
+ * @date 2024-10-18
+ */
+
+#ifndef SIIS_ATRSR_H
+#define SIIS_ATRSR_H
+
+#include "../indicator.h"
+#include "../../dataarray.h"
+#include "../zigzag/zigzag.h"
+
+#include <vector>
+
+namespace siis {
+
+class SnapshotWriter;
+class SnapshotReader;
+
+/**
+ * @brief SiiS ATR based support/resistance indicator.
+ * @author Frederic Scherma
+ * @date 2024-10-18
+ * Support and resistance levels from the swing pivots of a streaming ZigZag.
+ * A new pivot within tolerance * ATR of an active level touches it, else it creates a level, replacing the
+ * least recently touched one when there is max levels. A level is broken when a bar closes beyond it by more
+ * than the tolerance, then its role is inverted (a broken resistance becomes a support).
+ * Each closed bar costs O(max levels), the history of the bars is never rescanned.
+ */
+class SIIS_API AtrSR : public Indicator
+{
+public:
+
+    // TYPE_SUPPORT_RESISTANCE
+    // CLS_OVERLAY
+
+    struct Level
+    {
+        o3d::Double price {0};
+        o3d::Int32 direction {0};          //!< 1 for a resistance, -1 for a support
+        o3d::Int32 touches {0};            //!< number of pivots merged into the level
+        o3d::Double timestamp {0};         //!< of the first pivot
+        o3d::Double lastTimestamp {0};     //!< of the last touch or break
+    };
+
+    typedef std::vector<Level> T_Level;
+
+    /**
+     * @param threshold Pivot threshold, in percent or factor of the ATR (@see ZigZag).
+     * @param tolerance Factor of the ATR merging a pivot into a level.
+     * @param maxLevels Max number of active levels.
+     */
+    AtrSR(const o3d::String &name,
+          o3d::Double timeframe,
+          o3d::Double threshold=3.0,
+          ZigZag::Mode mode=ZigZag::MODE_ATR,
+          o3d::Int32 atrLen=14,
+          o3d::Double tolerance=0.5,
+          o3d::Int32 maxLevels=8);
+
+    AtrSR(const o3d::String &name, o3d::Double timeframe, IndicatorConfig conf);
+
+    void setConf(IndicatorConfig conf);
+
+    o3d::Double tolerance() const { return m_tolerance; }
+    o3d::Int32 maxLevels() const { return m_maxLevels; }
+
+    const ZigZag& zigzag() const { return m_zigzag; }
+
+    /**
+     * @brief levels Active levels, unordered.
+     */
+    const T_Level& levels() const { return m_levels; }
+
+    /**
+     * @brief support Nearest support lower or equal to a price.
+     * @return Null if none.
+     */
+    const Level* support(o3d::Double price) const;
+
+    /**
+     * @brief resistance Nearest resistance greater or equal to a price.
+     * @return Null if none.
+     */
+    const Level* resistance(o3d::Double price) const;
+
+    void reset();
+
+    /**
+     * @brief update Process a closed bar. O(max levels).
+     */
+    void update(o3d::Double timestamp, o3d::Double high, o3d::Double low, o3d::Double close);
+
+    /**
+     * @brief compute Process the closed bars since the previous call.
+     * @note The last bar of the arrays is considered as the current non closed bar and is ignored.
+     */
+    void compute(o3d::Double timestamp, const DataArray &timestamps,
+                 const DataArray &high, const DataArray &low, const DataArray &close);
+
+    /**
+     * @brief lookback Min number of necessary samples.
+     */
+    o3d::Int32 lookback() const;
+
+    //! Write the levels and the state of the ZigZag.
+    void saveState(SnapshotWriter &writer) const;
+
+    //! Restore a state written by saveState, false if the configuration differs.
+    o3d::Bool loadState(SnapshotReader &reader);
+
+private:
+
+    ZigZag m_zigzag;
+
+    o3d::Double m_tolerance;
+    o3d::Int32 m_maxLevels;
+
+    T_Level m_levels;
+
+    o3d::Double m_lastBarTimestamp;
+
+    void addPivot(const ZigZag::Pivot &pivot);
+};
+
+} // namespace siis
+
+#endif // SIIS_ATRSR_H
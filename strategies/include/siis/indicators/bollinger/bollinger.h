@@ -11,6 +11,7 @@
 #include "../indicator.h"
 #include "../../constants.h"
 #include "../../dataarray.h"
+#include "../native/nativevolatility.h"
 
 namespace siis {
 
@@ -60,11 +61,26 @@ public:
      */
     void compute(o3d::Double timestamp, const DataArray &price);
 
+    /**
+     * @brief compute Same with the timestamp of each bar, the native backend then only feeding the new bars.
+     * Without them the native state is computed again from the first bar at each compute.
+     * @param timestamps An array of the timestamp of each of the given prices.
+     */
+    void compute(o3d::Double timestamp, const DataArray &timestamps, const DataArray &price);
+
     /**
      * @brief lookback Min number of necessary samples.
      */
     o3d::Int32 lookback() const;
 
+    /**
+     * @brief saveState Write the results and the native state, to continue from them after a restart.
+     */
+    void saveState(SnapshotWriter &writer) const;
+
+    //! Restore a state written by saveState, false if the configuration differs.
+    o3d::Bool loadState(SnapshotReader &reader);
+
 private:
 
     o3d::Int32 m_len;
@@ -76,6 +92,9 @@ private:
     DataArray m_middle;
     DataArray m_lower;
 
+    NativeFeed m_feed;
+    NativeBollinger m_native;   //!< only for a SMA, EMA or WMA middle, else TA-Lib
+
     o3d::Double m_prevUpper;
     o3d::Double m_lastUpper;
 
@@ -84,6 +103,10 @@ private:
 
     o3d::Double m_prevLower;
     o3d::Double m_lastLower;
+
+    void compute(o3d::Double timestamp, const DataArray *timestamps, const DataArray &price);
+    void computeNative(const DataArray *timestamps, const DataArray &price);
+    void computeTaLib(const DataArray &price, DataArray &upper, DataArray &middle, DataArray &lower) const;
 };
 
 } // namespace siis
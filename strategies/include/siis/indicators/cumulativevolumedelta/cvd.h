@@ -15,6 +15,9 @@
 
 namespace siis {
 
+class SnapshotWriter;
+class SnapshotReader;
+
 /**
  * @brief SiiS tick Cumulative Volume Delta indicator.
  * @author Frederic Scherma
@@ -64,6 +67,12 @@ public:
      */
     void update(const Tick &tick, o3d::Bool finalize=false);
 
+    //! Write the values and the accumulators, the ticks being not replayed after a restart.
+    void saveState(SnapshotWriter &writer) const;
+
+    //! Restore a state written by saveState, false if the configuration differs.
+    o3d::Bool loadState(SnapshotReader &reader);
+
 private:
 
     o3d::Double m_cvdTimeframe;
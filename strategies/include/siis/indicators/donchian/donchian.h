@@ -10,6 +10,7 @@
 
 #include "../indicator.h"
 #include "../../dataarray.h"
+#include "../../utils/rollingextremum.h"
 
 namespace siis {
 
@@ -32,8 +33,8 @@ public:
 
     o3d::Int32 len() const { return m_len; }
 
-    const DataArray& upper() const { return m_upper; }
-    const DataArray& lower() const { return m_lower; }
+    const DataArray& upper() const { return m_highest.values(); }
+    const DataArray& lower() const { return m_lowest.values(); }
 
     o3d::Double lastUpper() const { return m_lastUpper; }
     o3d::Double prevUpper() const { return m_prevUpper; }
@@ -55,8 +56,9 @@ public:
 private:
 
     o3d::Int32 m_len;
-    DataArray m_upper;
-    DataArray m_lower;
+
+    RollingExtremum m_highest;
+    RollingExtremum m_lowest;
 
     o3d::Double m_prevUpper;
     o3d::Double m_lastUpper;
@@ -11,6 +11,7 @@
 #include "../indicator.h"
 #include "../../constants.h"
 #include "../../dataarray.h"
+#include "../../utils/rollingextremum.h"
 
 namespace siis {
 
@@ -75,10 +76,21 @@ public:
 
 private:
 
+    //! Middle of the highest high and of the lowest low of the windows (as TA_MIDPRICE).
+    static void midPrice(RollingExtremum &highest, RollingExtremum &lowest,
+                         const DataArray &high, const DataArray &low, DataArray &out);
+
     o3d::Int32 m_tenkanLen;
     o3d::Int32 m_kijunLen;
     o3d::Int32 m_senkouSpanBLen;
 
+    RollingExtremum m_tenkanHighest;
+    RollingExtremum m_tenkanLowest;
+    RollingExtremum m_kijunHighest;
+    RollingExtremum m_kijunLowest;
+    RollingExtremum m_ssbHighest;
+    RollingExtremum m_ssbLowest;
+
     DataArray m_tenkan;
     DataArray m_kijun;
     DataArray m_ssa;
@@ -10,6 +10,7 @@
 
 #include "../indicator.h"
 #include "../../dataarray.h"
+#include "../../utils/priceintervals.h"
 
 #include <list>
 
@@ -41,6 +42,8 @@ public:
  *
  * @note If compute at each new bar it is ok but if many initial bar are given to compute
  * some imbalance could have been filled/partially and that case is not checked.
+ *
+ * Imbalances are indexed by price, an update only visits the ones overlapping the price range of the bars.
  */
 class SIIS_API BarImbalance : public Indicator
 {
@@ -75,7 +78,7 @@ public:
     /**
      * @brief imbalance Retrieves all previous and recents imbalances, orderer from older to most recent.
      */
-    const T_Imbalance& imbalance() const { return m_imbalances; }
+    const T_Imbalance& imbalance() const { return m_imbalances.items(); }
 
     /**
      * @brief lastImbalances Retrieves only the last generated imbalances (since last compute call).
@@ -101,11 +104,10 @@ private:
     o3d::Int32 m_depth;
     o3d::Double m_minHeight;
 
-    T_Imbalance m_imbalances;
+    PriceIntervals<Imbalance> m_imbalances;
     T_Imbalance m_foundImbalances;
 
-    T_Imbalance updateImbalances(T_Imbalance& imbalances,
-                                 const DataArray &high, const DataArray &low, o3d::Int32 numLastBars);
+    void updateImbalances(const DataArray &high, const DataArray &low, o3d::Int32 numLastBars);
 };
 
 } // namespace siis
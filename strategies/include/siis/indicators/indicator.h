@@ -58,11 +58,21 @@ public:
         NORM_100 = 2
     };
 
+    /**
+     * @brief Computation of the indicators having a native streaming version, else always TA-Lib.
+     */
+    enum Backend {
+        BACKEND_NATIVE = 0,   //!< native streaming state, updated with the new bars only (default)
+        BACKEND_TALIB = 1,    //!< TA-Lib over the whole arrays at each compute
+        BACKEND_VERIFY = 2    //!< native, then compared with TA-Lib at each compute (slow)
+    };
+
     Indicator(const o3d::String &name, o3d::Double timeframe) :
         m_name(name),
         m_timeframe(timeframe),
         m_lastTimestamp(0.0),
-        m_active(true)
+        m_active(true),
+        m_backend(BACKEND_NATIVE)
     {
     }
 
@@ -80,6 +90,13 @@ public:
      */
     void disable() { m_active = false; }
 
+    Backend backend() const { return m_backend; }
+
+    /**
+     * @brief setBackend Change the computation, before the first compute.
+     */
+    void setBackend(Backend backend) { m_backend = backend; }
+
     // o3d::Int32 lookback() const;
     // void trace(StrategyLogger &logger) const;
 
@@ -93,6 +110,7 @@ private:
     o3d::Double m_timeframe;
     o3d::Double m_lastTimestamp;
     o3d::Bool m_active;
+    Backend m_backend;
 };
 
 template <class T>
@@ -104,6 +122,19 @@ configureIndicator(const AnalyserConfig &conf, const o3d::CString &name, T &indi
     if (indicators.isMember(name.getData())) {
         Json::Value cnf = indicators.get(name.getData(), Json::Value());
         indicator.setConf(IndicatorConfig(cnf));
+
+        // optional "backend": "native" (default), "talib" or "verify"
+        if (cnf.isObject() && cnf.isMember("backend")) {
+            const std::string backend = cnf.get("backend", "native").asString();
+
+            if (backend == "talib") {
+                indicator.setBackend(Indicator::BACKEND_TALIB);
+            } else if (backend == "verify") {
+                indicator.setBackend(Indicator::BACKEND_VERIFY);
+            } else {
+                indicator.setBackend(Indicator::BACKEND_NATIVE);
+            }
+        }
     } else {
         indicator.disable();
     }
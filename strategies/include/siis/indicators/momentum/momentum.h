@@ -10,6 +10,7 @@
 
 #include "../indicator.h"
 #include "../../dataarray.h"
+#include "../native/nativeoscillator.h"
 
 namespace siis {
 
@@ -43,18 +44,40 @@ public:
      */
     void compute(o3d::Double timestamp, const DataArray &price);
 
+    /**
+     * @brief compute Same with the timestamp of each bar, the native backend then only feeding the new bars.
+     * Without them the native state is computed again from the first bar at each compute.
+     * @param timestamps An array of the timestamp of each of the given prices.
+     */
+    void compute(o3d::Double timestamp, const DataArray &timestamps, const DataArray &price);
+
     /**
      * @brief lookback Min number of necessary samples.
      */
     o3d::Int32 lookback() const;
 
+    /**
+     * @brief saveState Write the results and the native state, to continue from them after a restart.
+     */
+    void saveState(SnapshotWriter &writer) const;
+
+    //! Restore a state written by saveState, false if the configuration differs.
+    o3d::Bool loadState(SnapshotReader &reader);
+
 private:
 
     o3d::Int32 m_len;
     DataArray m_mmt;
 
+    NativeFeed m_feed;
+    NativeMomentum m_native;
+
     o3d::Double m_prev;
     o3d::Double m_last;
+
+    void compute(o3d::Double timestamp, const DataArray *timestamps, const DataArray &price);
+    void computeNative(const DataArray *timestamps, const DataArray &price);
+    void computeTaLib(const DataArray &price, DataArray &out) const;
 };
 
 } // namespace siis
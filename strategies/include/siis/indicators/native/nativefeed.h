@@ -0,0 +1,116 @@
+/**
+ * @brief SiiS native streaming indicators, feed of the price arrays.
+ * @copyright Copyright (C) 2024 SiiS
+ * @author Frederic SCHERMA (frederic.scherma@gmail.com)
+ * @date 2024-10-18
+ */
+
+#ifndef SIIS_NATIVEFEED_H
+#define SIIS_NATIVEFEED_H
+
+#include "../../base.h"
+#include "../../dataarray.h"
+
+namespace siis {
+
+class Indicator;
+class SnapshotWriter;
+class SnapshotReader;
+
+/**
+ * @brief Input of the native indicators having a high, a low and a close.
+ */
+struct NativeBar
+{
+    o3d::Double high;
+    o3d::Double low;
+    o3d::Double close;
+};
+
+//! Same zero test as TA-Lib, for the divisions of the native indicators.
+inline o3d::Bool nativeIsZero(o3d::Double value)
+{
+    return -0.00000001 < value && value < 0.00000001;
+}
+
+/**
+ * @brief Feed of the price arrays given to the compute of an indicator to its native streaming state.
+ * @author Frederic Scherma
+ * @date 2024-10-18
+ * The price arrays are a window over the circular bar store, shifted when new bars are appended, or growing
+ * until the depth is reached, and else only their last value (the forming bar) is updated. The feed finds the
+ * previous forming bar in the timestamps of the bars to know from which index the closed bars must be pushed to
+ * the state, the last value always being the forming bar (provisional update). Only the timestamp of the previous
+ * forming bar and the count of the bars sharing it are kept, as the range bars can share a timestamp.
+ * Without the timestamps, or if the previous forming bar is not found, the state must be reset and fed from the
+ * first index, as TA-Lib does. A closed bar is never modified, a history correction is not detected.
+ */
+class SIIS_API NativeFeed
+{
+public:
+
+    //! Max number of new bars between two calls to compute for an incremental update.
+    static const o3d::Int32 MAX_SHIFT = 8;
+
+    //! Relative tolerance of the verification of the indicators over a window, the rounding only.
+    static const o3d::Double WINDOW_TOLERANCE;
+
+    //! Relative tolerance of the verification of the recursive indicators, TA-Lib restarting at the first bar.
+    static const o3d::Double RECURSIVE_TOLERANCE;
+
+    NativeFeed();
+
+    void reset();
+
+    /**
+     * @brief saveState Write the previous inputs, the indicator writing its outputs and the state of its kernel,
+     * to continue from them after a restart.
+     */
+    void saveState(SnapshotWriter &writer) const;
+
+    //! Restore a state written by saveState, else reset.
+    o3d::Bool loadState(SnapshotReader &reader);
+
+    /**
+     * @brief compute Find the shift of the bars since the previous compute.
+     * @param timestamps Timestamp of each bar of the inputs, or nullptr to always restart.
+     * @param size Size of the inputs.
+     * @return The first index to feed, 0 if restarted.
+     */
+    o3d::Int32 compute(const DataArray *timestamps, o3d::Int32 size);
+
+    //! True if the state must be reset and fed from the first index.
+    o3d::Bool restarted() const { return m_shift < 0; }
+
+    //! Number of bars removed at the front since the previous compute, -1 if restarted.
+    o3d::Int32 shift() const { return m_shift; }
+
+    o3d::Int32 size() const { return m_size; }
+
+    /**
+     * @brief align Resize an output array to the size of the inputs, and move its previous results at the
+     * index of their bars. Only the values from the first index to feed are then to be written.
+     */
+    void align(DataArray &out) const;
+
+    /**
+     * @brief verify Log a warning if a native value differs from the TA-Lib one by more than a relative
+     * tolerance.
+     */
+    static void verify(const Indicator &indicator, const o3d::String &output,
+                       o3d::Double native, o3d::Double reference, o3d::Double tolerance);
+
+private:
+
+    o3d::Int32 m_prevSize;
+    o3d::Int32 m_size;
+    o3d::Int32 m_shift;
+    o3d::Int32 m_kept;              //!< number of previous results kept at the front
+
+    o3d::Double m_lastTimestamp;    //!< of the previous forming bar
+    o3d::Int32 m_lastCount;         //!< number of bars of this timestamp at the end of the previous inputs
+};
+
+} // namespace siis
+
+#endif // SIIS_NATIVEFEED_H
@@ -0,0 +1,191 @@
+/**
+ * @brief SiiS native streaming moving averages.
+ * @copyright Copyright (C) 2024 SiiS
+ * @author Frederic SCHERMA (frederic.scherma@gmail.com)
+ * @date 2024-10-18
+ */
+
+#ifndef SIIS_NATIVEMA_H
+#define SIIS_NATIVEMA_H
+
+#include "nativefeed.h"
+#include "../../constants.h"
+
+#include <vector>
+
+namespace siis {
+
+/**
+ * @brief Native streaming simple moving average.
+ * @author Frederic Scherma
+ * @date 2024-10-18
+ * As all the native indicators :
+ *  - update pushes a closed bar and returns the value at this bar,
+ *  - updateProvisional returns the value with a forming bar, without changing the state,
+ *  - the values before lookback bars are 0, the first ones are the same as TA-Lib.
+ * The running sum is computed again from the window each time the ring wraps, to not accumulate rounding.
+ */
+class SIIS_API NativeSma
+{
+public:
+
+    NativeSma(o3d::Int32 len = 20);
+
+    //! Change the length and reset.
+    void setLen(o3d::Int32 len);
+
+    void reset();
+
+    //! Write the state, to continue from it after a restart.
+    void saveState(SnapshotWriter &writer) const;
+
+    //! Restore a state written by saveState, false if the parameters differ.
+    o3d::Bool loadState(SnapshotReader &reader);
+
+    o3d::Int32 len() const { return m_len; }
+    o3d::Int32 lookback() const { return m_len - 1; }
+    o3d::Int32 count() const { return m_count; }
+
+    o3d::Double update(o3d::Double value);
+    o3d::Double updateProvisional(o3d::Double value) const;
+
+private:
+
+    o3d::Int32 m_len;
+
+    std::vector<o3d::Double> m_values;  //!< ring of the last len closed values
+    o3d::Int32 m_pos;                   //!< of the oldest value once full
+
+    o3d::Int32 m_count;
+    o3d::Double m_sum;
+};
+
+/**
+ * @brief Native streaming exponential moving average, seeded by the simple average of the first len values.
+ * @author Frederic Scherma
+ * @date 2024-10-18
+ */
+class SIIS_API NativeEma
+{
+public:
+
+    NativeEma(o3d::Int32 len = 20);
+
+    //! Change the length and reset.
+    void setLen(o3d::Int32 len);
+
+    void reset();
+
+    //! Write the state, to continue from it after a restart.
+    void saveState(SnapshotWriter &writer) const;
+
+    //! Restore a state written by saveState, false if the parameters differ.
+    o3d::Bool loadState(SnapshotReader &reader);
+
+    o3d::Int32 len() const { return m_len; }
+    o3d::Int32 lookback() const { return m_len - 1; }
+    o3d::Int32 count() const { return m_count; }
+
+    o3d::Double update(o3d::Double value);
+    o3d::Double updateProvisional(o3d::Double value) const;
+
+private:
+
+    o3d::Int32 m_len;
+    o3d::Double m_k;
+
+    o3d::Int32 m_count;
+    o3d::Double m_sum;      //!< of the first values, for the seed
+    o3d::Double m_ema;
+};
+
+/**
+ * @brief Native streaming linearly weighted moving average.
+ * @author Frederic Scherma
+ * @date 2024-10-18
+ * The weighted sum is updated by subtracting the sum of the window, and computed again each time the ring wraps.
+ */
+class SIIS_API NativeWma
+{
+public:
+
+    NativeWma(o3d::Int32 len = 20);
+
+    //! Change the length and reset.
+    void setLen(o3d::Int32 len);
+
+    void reset();
+
+    //! Write the state, to continue from it after a restart.
+    void saveState(SnapshotWriter &writer) const;
+
+    //! Restore a state written by saveState, false if the parameters differ.
+    o3d::Bool loadState(SnapshotReader &reader);
+
+    o3d::Int32 len() const { return m_len; }
+    o3d::Int32 lookback() const { return m_len - 1; }
+    o3d::Int32 count() const { return m_count; }
+
+    o3d::Double update(o3d::Double value);
+    o3d::Double updateProvisional(o3d::Double value) const;
+
+private:
+
+    o3d::Int32 m_len;
+    o3d::Double m_divider;
+
+    std::vector<o3d::Double> m_values;  //!< ring of the last len closed values
+    o3d::Int32 m_pos;                   //!< of the oldest value once full
+
+    o3d::Int32 m_count;
+    o3d::Double m_sum;                  //!< sum of the window
+    o3d::Double m_weightedSum;          //!< weights from 1 for the oldest to len for the newest
+};
+
+/**
+ * @brief Native streaming moving average of a type, for the indicators having a configurable smoothing.
+ * @author Frederic Scherma
+ * @date 2024-10-18
+ * Only SMA, EMA and WMA have a native version, the indicators keep TA-Lib for the other types.
+ */
+class SIIS_API NativeMa
+{
+public:
+
+    NativeMa(MAType maType = MA_SMA, o3d::Int32 len = 20);
+
+    static o3d::Bool supported(MAType maType) { return maType == MA_SMA || maType == MA_EMA || maType == MA_WMA; }
+
+    //! Change the type and the length and reset.
+    void setup(MAType maType, o3d::Int32 len);
+
+    void reset();
+
+    //! Write the state, to continue from it after a restart.
+    void saveState(SnapshotWriter &writer) const;
+
+    //! Restore a state written by saveState, false if the parameters differ.
+    o3d::Bool loadState(SnapshotReader &reader);
+
+    MAType maType() const { return m_maType; }
+    o3d::Int32 len() const { return m_len; }
+    o3d::Int32 lookback() const { return m_len - 1; }
+    o3d::Int32 count() const;
+
+    o3d::Double update(o3d::Double value);
+    o3d::Double updateProvisional(o3d::Double value) const;
+
+private:
+
+    MAType m_maType;
+    o3d::Int32 m_len;
+
+    // only the one of the type has the length, the others are of length 1
+    NativeSma m_sma;
+    NativeEma m_ema;
+    NativeWma m_wma;
+};
+
+} // namespace siis
+
+#endif // SIIS_NATIVEMA_H
@@ -0,0 +1,249 @@
+/**
+ * @brief SiiS native streaming oscillators.
+ * @copyright Copyright (C) 2024 SiiS
+ * @author Frederic SCHERMA (frederic.scherma@gmail.com)
+ * @date 2024-10-18
+ */
+
+#ifndef SIIS_NATIVEOSCILLATOR_H
+#define SIIS_NATIVEOSCILLATOR_H
+
+#include "nativema.h"
+#include "../../utils/rollingextremum.h"
+
+namespace siis {
+
+/**
+ * @brief Native streaming relative strength index, with the Wilder smoothing of the gains and losses.
+ * @author Frederic Scherma
+ * @date 2024-10-18
+ */
+class SIIS_API NativeRsi
+{
+public:
+
+    NativeRsi(o3d::Int32 len = 21);
+
+    //! Change the length and reset.
+    void setLen(o3d::Int32 len);
+
+    void reset();
+
+    //! Write the state, to continue from it after a restart.
+    void saveState(SnapshotWriter &writer) const;
+
+    //! Restore a state written by saveState, false if the parameters differ.
+    o3d::Bool loadState(SnapshotReader &reader);
+
+    o3d::Int32 len() const { return m_len; }
+    o3d::Int32 lookback() const { return m_len; }
+    o3d::Int32 count() const { return m_state.count; }
+
+    o3d::Double update(o3d::Double value) { return step(m_state, value); }
+    o3d::Double updateProvisional(o3d::Double value) const { State state = m_state; return step(state, value); }
+
+private:
+
+    struct State
+    {
+        o3d::Int32 count;
+        o3d::Double prevValue;
+        o3d::Double gain;       //!< sum then average
+        o3d::Double loss;       //!< sum then average
+    };
+
+    o3d::Int32 m_len;
+    State m_state;
+
+    o3d::Double step(State &state, o3d::Double value) const;
+};
+
+/**
+ * @brief Native streaming momentum, difference with the value of len bars ago.
+ * @author Frederic Scherma
+ * @date 2024-10-18
+ */
+class SIIS_API NativeMomentum
+{
+public:
+
+    NativeMomentum(o3d::Int32 len = 21);
+
+    //! Change the length and reset.
+    void setLen(o3d::Int32 len);
+
+    void reset();
+
+    //! Write the state, to continue from it after a restart.
+    void saveState(SnapshotWriter &writer) const;
+
+    //! Restore a state written by saveState, false if the parameters differ.
+    o3d::Bool loadState(SnapshotReader &reader);
+
+    o3d::Int32 len() const { return m_len; }
+    o3d::Int32 lookback() const { return m_len; }
+    o3d::Int32 count() const { return m_count; }
+
+    o3d::Double update(o3d::Double value);
+    o3d::Double updateProvisional(o3d::Double value) const;
+
+private:
+
+    o3d::Int32 m_len;
+
+    std::vector<o3d::Double> m_values;  //!< ring of the last len closed values
+    o3d::Int32 m_pos;                   //!< of the oldest value once full
+
+    o3d::Int32 m_count;
+};
+
+/**
+ * @brief Native streaming commodity channel index.
+ * @author Frederic Scherma
+ * @date 2024-10-18
+ * The mean deviation has no running form, then each bar costs O(len) over a ring of the typical prices, in place
+ * of O(len) per bar of the whole array.
+ */
+class SIIS_API NativeCci
+{
+public:
+
+    NativeCci(o3d::Int32 len = 20);
+
+    //! Change the length and reset.
+    void setLen(o3d::Int32 len);
+
+    void reset();
+
+    //! Write the state, to continue from it after a restart.
+    void saveState(SnapshotWriter &writer) const;
+
+    //! Restore a state written by saveState, false if the parameters differ.
+    o3d::Bool loadState(SnapshotReader &reader);
+
+    o3d::Int32 len() const { return m_len; }
+    o3d::Int32 lookback() const { return m_len - 1; }
+    o3d::Int32 count() const { return m_count; }
+
+    o3d::Double update(const NativeBar &bar);
+    o3d::Double updateProvisional(const NativeBar &bar) const;
+
+private:
+
+    o3d::Int32 m_len;
+
+    std::vector<o3d::Double> m_values;  //!< ring of the typical prices
+    o3d::Int32 m_pos;                   //!< of the next one
+
+    o3d::Int32 m_count;
+
+    //! CCI of the window having the typical price at the current position.
+    o3d::Double value(o3d::Double typicalPrice) const;
+};
+
+/**
+ * @brief Native streaming MACD, difference of a fast and of a slow EMA, and its signal EMA.
+ * @author Frederic Scherma
+ * @date 2024-10-18
+ * As TA-Lib, the fast EMA starts so that its first value is at the same bar as the slow one.
+ */
+class SIIS_API NativeMacd
+{
+public:
+
+    struct Value
+    {
+        o3d::Double macd;
+        o3d::Double signal;
+        o3d::Double hist;
+    };
+
+    NativeMacd(o3d::Int32 fastLen = 12, o3d::Int32 slowLen = 26, o3d::Int32 signalLen = 9);
+
+    //! Change the lengths and reset.
+    void setup(o3d::Int32 fastLen, o3d::Int32 slowLen, o3d::Int32 signalLen);
+
+    void reset();
+
+    //! Write the state, to continue from it after a restart.
+    void saveState(SnapshotWriter &writer) const;
+
+    //! Restore a state written by saveState, false if the parameters differ.
+    o3d::Bool loadState(SnapshotReader &reader);
+
+    o3d::Int32 lookback() const { return m_slow.lookback() + m_signal.lookback(); }
+    o3d::Int32 count() const { return m_count; }
+
+    Value update(o3d::Double value);
+    Value updateProvisional(o3d::Double value) const;
+
+private:
+
+    NativeEma m_fast;
+    NativeEma m_slow;
+    NativeEma m_signal;
+
+    o3d::Int32 m_count;
+};
+
+/**
+ * @brief Native streaming stochastic, slow %K and slow %D.
+ * @author Frederic Scherma
+ * @date 2024-10-18
+ * The highest high and the lowest low of the fast %K are rolling extremums, the smoothings native moving averages.
+ */
+class SIIS_API NativeStoch
+{
+public:
+
+    struct Value
+    {
+        o3d::Double slowK;
+        o3d::Double slowD;
+    };
+
+    NativeStoch(o3d::Int32 fastK_Len = 9,
+                o3d::Int32 slowK_Len = 12, MAType slowK_MAType = MA_SMA,
+                o3d::Int32 slowD_Len = 3, MAType slowD_MAType = MA_SMA);
+
+    //! Change the lengths and reset.
+    void setup(o3d::Int32 fastK_Len,
+               o3d::Int32 slowK_Len, MAType slowK_MAType,
+               o3d::Int32 slowD_Len, MAType slowD_MAType);
+
+    void reset();
+
+    //! Write the state, to continue from it after a restart.
+    void saveState(SnapshotWriter &writer) const;
+
+    //! Restore a state written by saveState, false if the parameters differ.
+    o3d::Bool loadState(SnapshotReader &reader);
+
+    o3d::Int32 lookback() const { return m_fastK_Len - 1 + m_slowK.lookback() + m_slowD.lookback(); }
+    o3d::Int32 count() const { return m_count; }
+
+    Value update(const NativeBar &bar);
+    Value updateProvisional(const NativeBar &bar) const;
+
+private:
+
+    o3d::Int32 m_fastK_Len;
+
+    RollingExtremum m_highest;
+    RollingExtremum m_lowest;
+
+    NativeMa m_slowK;
+    NativeMa m_slowD;
+
+    o3d::Int32 m_count;
+
+    static inline o3d::Double fastK(o3d::Double close, o3d::Double highest, o3d::Double lowest)
+    {
+        const o3d::Double diff = (highest - lowest) / 100.0;
+        return diff != 0.0 ? (close - lowest) / diff : 0.0;
+    }
+};
+
+} // namespace siis
+
+#endif // SIIS_NATIVEOSCILLATOR_H
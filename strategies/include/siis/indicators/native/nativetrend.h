@@ -0,0 +1,123 @@
+/**
+ * @brief SiiS native streaming trend indicators.
+ * @copyright Copyright (C) 2024 SiiS
+ * @author Frederic SCHERMA (frederic.scherma@gmail.com)
+ * @date 2024-10-18
+ */
+
+#ifndef SIIS_NATIVETREND_H
+#define SIIS_NATIVETREND_H
+
+#include "nativefeed.h"
+
+namespace siis {
+
+/**
+ * @brief Native streaming average directional index, with the Wilder smoothing of the directional movements,
+ * of the true range and of the DX.
+ * @author Frederic Scherma
+ * @date 2024-10-18
+ */
+class SIIS_API NativeAdx
+{
+public:
+
+    NativeAdx(o3d::Int32 len = 14);
+
+    //! Change the length and reset.
+    void setLen(o3d::Int32 len);
+
+    void reset();
+
+    //! Write the state, to continue from it after a restart.
+    void saveState(SnapshotWriter &writer) const;
+
+    //! Restore a state written by saveState, false if the parameters differ.
+    o3d::Bool loadState(SnapshotReader &reader);
+
+    o3d::Int32 len() const { return m_len; }
+    o3d::Int32 lookback() const { return 2 * m_len - 1; }
+    o3d::Int32 count() const { return m_state.count; }
+
+    o3d::Double update(const NativeBar &bar) { return step(m_state, bar); }
+    o3d::Double updateProvisional(const NativeBar &bar) const { State state = m_state; return step(state, bar); }
+
+private:
+
+    struct State
+    {
+        o3d::Int32 count;
+
+        o3d::Double prevHigh;
+        o3d::Double prevLow;
+        o3d::Double prevClose;
+
+        o3d::Double plusDM;
+        o3d::Double minusDM;
+        o3d::Double tr;
+
+        o3d::Double sumDX;      //!< of the first DX, for the seed
+        o3d::Double adx;
+    };
+
+    o3d::Int32 m_len;
+    State m_state;
+
+    o3d::Double step(State &state, const NativeBar &bar) const;
+};
+
+/**
+ * @brief Native streaming parabolic SAR.
+ * @author Frederic Scherma
+ * @date 2024-10-18
+ * As TA-Lib, the initial direction is given by the directional movement of the two first bars.
+ */
+class SIIS_API NativeSar
+{
+public:
+
+    NativeSar(o3d::Double accel = 0.02, o3d::Double max = 0.2);
+
+    //! Change the parameters and reset.
+    void setup(o3d::Double accel, o3d::Double max);
+
+    void reset();
+
+    //! Write the state, to continue from it after a restart.
+    void saveState(SnapshotWriter &writer) const;
+
+    //! Restore a state written by saveState, false if the parameters differ.
+    o3d::Bool loadState(SnapshotReader &reader);
+
+    o3d::Int32 lookback() const { return 1; }
+    o3d::Int32 count() const { return m_state.count; }
+
+    o3d::Double update(const NativeBar &bar) { return step(m_state, bar); }
+    o3d::Double updateProvisional(const NativeBar &bar) const { State state = m_state; return step(state, bar); }
+
+private:
+
+    struct State
+    {
+        o3d::Int32 count;
+        o3d::Bool isLong;
+
+        o3d::Double sar;
+        o3d::Double ep;         //!< extreme point
+        o3d::Double af;         //!< acceleration factor
+
+        o3d::Double newHigh;    //!< of the last bar
+        o3d::Double newLow;
+    };
+
+    o3d::Double m_accel;
+    o3d::Double m_max;
+
+    State m_state;
+
+    o3d::Double step(State &state, const NativeBar &bar) const;
+};
+
+} // namespace siis
+
+#endif // SIIS_NATIVETREND_H
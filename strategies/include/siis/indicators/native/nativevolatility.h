@@ -0,0 +1,137 @@
+/**
+ * @brief SiiS native streaming volatility indicators.
+ * @copyright Copyright (C) 2024 SiiS
+ * @author Frederic SCHERMA (frederic.scherma@gmail.com)
+ * @date 2024-10-18
+ */
+
+#ifndef SIIS_NATIVEVOLATILITY_H
+#define SIIS_NATIVEVOLATILITY_H
+
+#include "nativema.h"
+
+#include <cmath>
+
+namespace siis {
+
+/**
+ * @brief Native streaming average true range, with the Wilder smoothing.
+ * @author Frederic Scherma
+ * @date 2024-10-18
+ */
+class SIIS_API NativeAtr
+{
+public:
+
+    NativeAtr(o3d::Int32 len = 14);
+
+    //! Change the length and reset.
+    void setLen(o3d::Int32 len);
+
+    void reset();
+
+    //! Write the state, to continue from it after a restart.
+    void saveState(SnapshotWriter &writer) const;
+
+    //! Restore a state written by saveState, false if the parameters differ.
+    o3d::Bool loadState(SnapshotReader &reader);
+
+    o3d::Int32 len() const { return m_len; }
+    o3d::Int32 lookback() const { return m_len > 1 ? m_len : 1; }
+    o3d::Int32 count() const { return m_state.count; }
+
+    o3d::Double update(const NativeBar &bar) { return step(m_state, bar); }
+    o3d::Double updateProvisional(const NativeBar &bar) const { State state = m_state; return step(state, bar); }
+
+    static inline o3d::Double trueRange(o3d::Double high, o3d::Double low, o3d::Double prevClose)
+    {
+        o3d::Double greatest = high - low;
+
+        const o3d::Double val2 = std::fabs(prevClose - high);
+        if (val2 > greatest) {
+            greatest = val2;
+        }
+
+        const o3d::Double val3 = std::fabs(prevClose - low);
+        if (val3 > greatest) {
+            greatest = val3;
+        }
+
+        return greatest;
+    }
+
+private:
+
+    struct State
+    {
+        o3d::Int32 count;
+        o3d::Double prevClose;
+        o3d::Double atr;        //!< sum of the first true ranges then average
+    };
+
+    o3d::Int32 m_len;
+    State m_state;
+
+    o3d::Double step(State &state, const NativeBar &bar) const;
+};
+
+/**
+ * @brief Native streaming Bollinger bands, standard deviation of the window around a moving average.
+ * @author Frederic Scherma
+ * @date 2024-10-18
+ * The variance comes from the running sums of the values and of their squares, computed again each time the
+ * ring wraps.
+ */
+class SIIS_API NativeBollinger
+{
+public:
+
+    struct Value
+    {
+        o3d::Double upper;
+        o3d::Double middle;
+        o3d::Double lower;
+    };
+
+    NativeBollinger(o3d::Int32 len = 20, o3d::Double numDevUp = 2.0, o3d::Double numDevDn = 2.0,
+                    MAType maType = MA_SMA);
+
+    //! Change the parameters and reset.
+    void setup(o3d::Int32 len, o3d::Double numDevUp, o3d::Double numDevDn, MAType maType);
+
+    void reset();
+
+    //! Write the state, to continue from it after a restart.
+    void saveState(SnapshotWriter &writer) const;
+
+    //! Restore a state written by saveState, false if the parameters differ.
+    o3d::Bool loadState(SnapshotReader &reader);
+
+    o3d::Int32 len() const { return m_len; }
+    o3d::Int32 lookback() const { return m_len - 1; }
+    o3d::Int32 count() const { return m_count; }
+
+    Value update(o3d::Double value);
+    Value updateProvisional(o3d::Double value) const;
+
+private:
+
+    o3d::Int32 m_len;
+    o3d::Double m_numDevUp;
+    o3d::Double m_numDevDn;
+
+    NativeMa m_ma;
+
+    std::vector<o3d::Double> m_values;  //!< ring of the last len closed values
+    o3d::Int32 m_pos;                   //!< of the oldest value once full
+
+    o3d::Int32 m_count;
+    o3d::Double m_sum;
+    o3d::Double m_sumSq;
+
+    Value bands(o3d::Double middle, o3d::Double sum, o3d::Double sumSq) const;
+};
+
+} // namespace siis
+
+#endif // SIIS_NATIVEVOLATILITY_H
@@ -0,0 +1,139 @@
+/**
+ * @brief SiiS order flow footprint data model.
+ * @copyright Copyright (C) 2024 SiiS
+ * @author Frederic SCHERMA (frederic.scherma@gmail.com)
+ * @date 2024-10-18
+ */
+
+#ifndef SIIS_FOOTPRINT_H
+#define SIIS_FOOTPRINT_H
+
+#include "../../base.h"
+
+#include <vector>
+
+namespace siis {
+
+class SnapshotWriter;
+class SnapshotReader;
+
+/**
+ * @brief SiiS dense ladder of the bid and ask volumes per price.
+ * @author Frederic Scherma
+ * @date 2024-10-18
+ * Indexed by price level, a level being the price divided by the tick size. The ladder grows on both sides
+ * when a level is out of its range, and keeps its capacity on reset, then after a few bars it no longer
+ * allocates, up to MAX_LEVELS levels. The bid volume is the volume of the sellers (hitting the bid),
+ * the ask volume the one of the buyers (lifting the ask).
+ */
+class SIIS_API PriceLadder
+{
+public:
+
+    static constexpr o3d::Int64 MAX_LEVELS = 1 << 20;   //!< max range of levels (16MB of volumes)
+
+    PriceLadder();
+
+    //! Clear the volumes, keep the capacity.
+    void reset();
+
+    //! Add volumes at a level. Amortized O(1). False if the range would exceed MAX_LEVELS, nothing added.
+    o3d::Bool add(o3d::Int64 level, o3d::Double bidVolume, o3d::Double askVolume);
+
+    o3d::Bool empty() const { return m_lowLevel > m_highLevel; }
+
+    //! Lowest and highest levels having volume, low greater than high if empty.
+    o3d::Int64 lowLevel() const { return m_lowLevel; }
+    o3d::Int64 highLevel() const { return m_highLevel; }
+
+    o3d::Double bidAt(o3d::Int64 level) const { return has(level) ? m_bid[level - m_base] : 0.0; }
+    o3d::Double askAt(o3d::Int64 level) const { return has(level) ? m_ask[level - m_base] : 0.0; }
+
+    o3d::Double volumeAt(o3d::Int64 level) const { return bidAt(level) + askAt(level); }
+    o3d::Double deltaAt(o3d::Int64 level) const { return askAt(level) - bidAt(level); }
+
+    o3d::Double volume() const { return m_volume; }
+    o3d::Double delta() const { return m_delta; }
+
+    //! Level of the max volume (point of control).
+    o3d::Int64 pocLevel() const { return m_pocLevel; }
+    o3d::Double pocVolume() const { return m_pocVolume; }
+
+    /**
+     * @brief buyImbalance Diagonal buy imbalance ratio, ask volume at a level over the bid volume at the
+     * level below. 0 if there is no ask volume, the ask volume if there is no bid volume.
+     */
+    o3d::Double buyImbalance(o3d::Int64 level) const;
+
+    /**
+     * @brief sellImbalance Diagonal sell imbalance ratio, bid volume at a level over the ask volume at the
+     * level above. 0 if there is no bid volume, the bid volume if there is no ask volume.
+     */
+    o3d::Double sellImbalance(o3d::Int64 level) const;
+
+    /**
+     * @brief stackedImbalances Longest run of consecutive levels having a buy (direction > 0) or a sell
+     * (direction < 0) imbalance of at least ratio. O(number of levels).
+     * @param outLowLevel If not null, lowest level of the run.
+     */
+    o3d::Int32 stackedImbalances(o3d::Int32 direction, o3d::Double ratio, o3d::Int64 *outLowLevel=nullptr) const;
+
+    //! Write the totals and the volumes of the used range of levels.
+    void saveState(SnapshotWriter &writer) const;
+    o3d::Bool loadState(SnapshotReader &reader);
+
+private:
+
+    std::vector<o3d::Double> m_bid;
+    std::vector<o3d::Double> m_ask;
+
+    o3d::Int64 m_base;        //!< level of the first element
+
+    o3d::Int64 m_lowLevel;
+    o3d::Int64 m_highLevel;
+
+    o3d::Double m_volume;
+    o3d::Double m_delta;
+
+    o3d::Int64 m_pocLevel;
+    o3d::Double m_pocVolume;
+
+    inline o3d::Bool has(o3d::Int64 level) const { return level >= m_lowLevel && level <= m_highLevel; }
+
+    //! False if the range would exceed MAX_LEVELS.
+    o3d::Bool grow(o3d::Int64 level);
+};
+
+/**
+ * @brief SiiS footprint of a bar.
+ * @author Frederic Scherma
+ * @date 2024-10-18
+ */
+class SIIS_API FootprintBar
+{
+public:
+
+    o3d::Double timestamp {0};     //!< of the first tick
+
+    o3d::Double open {0};
+    o3d::Double high {0};
+    o3d::Double low {0};
+    o3d::Double close {0};
+
+    o3d::Double minDelta {0};      //!< lowest delta during the bar
+    o3d::Double maxDelta {0};      //!< highest delta during the bar
+
+    PriceLadder ladder;
+
+    void reset(o3d::Double timestamp, o3d::Double price);
+
+    void saveState(SnapshotWriter &writer) const;
+    o3d::Bool loadState(SnapshotReader &reader);
+
+    o3d::Double volume() const { return ladder.volume(); }
+    o3d::Double delta() const { return ladder.delta(); }
+};
+
+} // namespace siis
+
+#endif // SIIS_FOOTPRINT_H
@@ -0,0 +1,186 @@
+/**
+ * @brief SiiS tick order flow indicator.
+ * @copyright Copyright (C) 2024 SiiS
+ * @author Frederic SCHERMA (frederic.scherma@gmail.com)
+ * @date 2024-10-18
+ */
+
+#ifndef SIIS_ORDERFLOW_H
+#define SIIS_ORDERFLOW_H
+
+#include "footprint.h"
+#include "../../tick.h"
+
+#include "../indicator.h"
+#include "../../datacircular.h"
+
+#include <vector>
+
+namespace siis {
+
+/**
+ * @brief SiiS tick order flow indicator.
+ * @author Frederic Scherma
+ * @date 2024-10-18
+ * Single pass aggregator of the ticks, each tick being classified once then accumulated into :
+ *  - the footprint of the current bar (bid/ask volumes per price level), with a ring of the previous bars
+ *  - the volume profile of the current session (bid/ask volumes per price level, POC)
+ *  - the cumulative volume delta of the session, a value per bar
+ * Then several views (CVD, profile, footprint, imbalances) are available to the analysers, without another
+ * pass over the ticks.
+ *
+ * The aggressor side is given by the tick, else by the tick rule (up tick buy, down tick sell). If the price
+ * is unchanged the CVD keeps the volume until the next up or down tick (as CumulativeVolumeDelta), and
+ * the ladders split it 50% on the bid and 50% on the ask (as VolumeProfile).
+ *
+ * The CVD being the same as CumulativeVolumeDelta, the configuration accepts its "cvd-timeframe" in place
+ * of "session-timeframe".
+ */
+class SIIS_API OrderFlow : public Indicator
+{
+public:
+
+    // TYPE_VOLUME
+    // CLS_CUMULATIVE
+
+    /**
+     * @brief OrderFlow
+     * @param name
+     * @param timeframe Related bar timeframe or 0
+     * @param depth Max series size. Must be the same as analyser depth
+     * @param sessionTimeframe Session of the CVD and of the profile (one of "1d", "1w", "1M")
+     * @param historySize Number of previous footprints, min 1
+     * @param imbalanceRatio Min diagonal ratio of an imbalance
+     * @param sessionFilter If defined, ticks received out of the session are ignored
+     */
+    OrderFlow(const o3d::String &name, o3d::Double timeframe, o3d::Int32 depth,
+              const o3d::CString &sessionTimeframe="1d",
+              o3d::Int32 historySize=10,
+              o3d::Double imbalanceRatio=3.0,
+              o3d::Bool sessionFilter=false);
+
+    OrderFlow(const o3d::String &name, o3d::Double timeframe, o3d::Int32 depth, IndicatorConfig conf);
+
+    ~OrderFlow();
+
+    void setConf(IndicatorConfig conf);
+
+    /**
+     * @brief init Initialize from instrument price limit.
+     * @param tickSize Tick size (price limit step) positive value or default to 0.00000001
+     */
+    void init(o3d::Double tickSize);
+
+    void setSession(o3d::Double sessionOffset, o3d::Double sessionDuration);
+
+    o3d::Int32 depth() const { return m_depth; }
+    o3d::Int32 historySize() const { return m_historySize; }
+    o3d::Double imbalanceRatio() const { return m_imbalanceRatio; }
+    o3d::Bool hasSessionFilter() const { return m_sessionFilter; }
+
+    o3d::Double tickSize() const { return m_tickSize; }
+
+    //! Price level of a price.
+    o3d::Int64 level(o3d::Double price) const;
+
+    //! Price of a level.
+    o3d::Double price(o3d::Int64 level) const { return level * m_tickSize; }
+
+    //
+    // cvd
+    //
+
+    const DataCircular& cvd() const { return m_cvd; }
+
+    o3d::Double last() const { return m_last; }
+    o3d::Double prev() const { return m_prev; }
+
+    //! Aggressor side of the last tick, 1 buy, -1 sell or 0 if unknown.
+    o3d::Int32 lastSide() const { return m_lastSide; }
+
+    //
+    // profile
+    //
+
+    //! Volume profile of the current session.
+    const PriceLadder& profile() const { return m_profile; }
+
+    o3d::Double pocPrice() const { return m_profile.empty() ? 0.0 : price(m_profile.pocLevel()); }
+
+    //
+    // footprint
+    //
+
+    o3d::Bool hasCurrent() const { return m_hasCurrent; }
+
+    //! Number of previous footprints, at most history size.
+    o3d::Int32 numPrevious() const { return m_numPrevious; }
+
+    /**
+     * @brief footprint Footprint of the current bar (0) or of a previous one (negative index or positive).
+     * @exception IndexOutOfRange
+     */
+    const FootprintBar& footprint(o3d::Int32 n=0) const;
+
+    /**
+     * @brief stackedImbalances Longest run of buy (direction > 0) or sell (direction < 0) imbalances of the
+     * footprint of a bar, at the configured ratio.
+     */
+    o3d::Int32 stackedImbalances(o3d::Int32 direction, o3d::Int32 n=0) const
+    {
+        return footprint(n).ladder.stackedImbalances(direction, m_imbalanceRatio);
+    }
+
+    /**
+     * @brief update Process a tick.
+     * @param finalize Once the related bar closed it must finalize the current footprint.
+     */
+    void update(const Tick &tick, o3d::Bool finalize=false);
+
+    //! Write the CVD, the session profile and the footprints, the ticks being not replayed after a restart.
+    void saveState(SnapshotWriter &writer) const;
+
+    //! Restore a state written by saveState, false if the configuration or the tick size differ.
+    o3d::Bool loadState(SnapshotReader &reader);
+
+private:
+
+    o3d::Double m_sessionTimeframe;
+
+    o3d::Double m_sessionOffset;     //!< 0 means starts at 00:00 UTC
+    o3d::Double m_sessionDuration;   //!< 0 means full day
+
+    o3d::Int32 m_depth;
+    o3d::Int32 m_historySize;
+    o3d::Double m_imbalanceRatio;
+
+    o3d::Bool m_sessionFilter;
+
+    o3d::Double m_tickSize;
+    o3d::Double m_invTickSize;
+
+    o3d::Double m_openTimestamp;
+
+    // classification
+    o3d::Double m_prevTickPrice;
+    o3d::Double m_tmpCvd;
+    o3d::Int32 m_lastSide;
+
+    DataCircular m_cvd;
+
+    PriceLadder m_profile;
+
+    std::vector<FootprintBar> m_bars;   //!< ring of the current and of the previous footprints
+    o3d::Int32 m_lastBar;               //!< index of the current or of the last finalized footprint
+    o3d::Int32 m_numPrevious;
+    o3d::Bool m_hasCurrent;
+
+    o3d::Double m_prev;
+    o3d::Double m_last;
+
+    void finalize();
+};
+
+} // namespace siis
+
+#endif // SIIS_ORDERFLOW_H
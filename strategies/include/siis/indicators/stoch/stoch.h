@@ -11,6 +11,7 @@
 #include "../indicator.h"
 #include "../../dataarray.h"
 #include "../../constants.h"
+#include "../native/nativeoscillator.h"
 
 namespace siis {
 
@@ -55,11 +56,27 @@ public:
      */
     void compute(o3d::Double timestamp, const DataArray &high, const DataArray &low, const DataArray &close);
 
+    /**
+     * @brief compute Same with the timestamp of each bar, the native backend then only feeding the new bars.
+     * Without them the native state is computed again from the first bar at each compute.
+     * @param timestamps An array of the timestamp of each of the given prices.
+     */
+    void compute(o3d::Double timestamp, const DataArray &timestamps,
+                 const DataArray &high, const DataArray &low, const DataArray &close);
+
     /**
      * @brief lookback Min number of necessary samples.
      */
     o3d::Int32 lookback() const;
 
+    /**
+     * @brief saveState Write the results and the native state, to continue from them after a restart.
+     */
+    void saveState(SnapshotWriter &writer) const;
+
+    //! Restore a state written by saveState, false if the configuration differs.
+    o3d::Bool loadState(SnapshotReader &reader);
+
 private:
 
     o3d::Int32 m_fastK_Len;
@@ -72,11 +89,23 @@ private:
     DataArray m_slowK;
     DataArray m_slowD;
 
+    NativeFeed m_feed;
+    NativeStoch m_native;   //!< only for SMA, EMA or WMA smoothings, else TA-Lib
+
     o3d::Double m_prevSlowK;
     o3d::Double m_lastSlowK;
 
     o3d::Double m_prevSlowD;
     o3d::Double m_lastSlowD;
+
+    o3d::Bool nativeSupported() const;
+
+    void compute(o3d::Double timestamp, const DataArray *timestamps,
+                 const DataArray &high, const DataArray &low, const DataArray &close);
+    void computeNative(const DataArray *timestamps,
+                       const DataArray &high, const DataArray &low, const DataArray &close);
+    void computeTaLib(const DataArray &high, const DataArray &low, const DataArray &close,
+                      DataArray &slowK, DataArray &slowD) const;
 };
 
 } // namespace siis
@@ -11,6 +11,7 @@
 #include "../indicator.h"
 #include "../../dataarray.h"
 #include "../../constants.h"
+#include "../../utils/rollingextremum.h"
 
 namespace siis {
 
@@ -64,6 +65,10 @@ private:
     o3d::Int32 m_fastD_Len;
     MAType m_fastD_MAType;
 
+    RollingExtremum m_highest;
+    RollingExtremum m_lowest;
+
+    DataArray m_rsi;     //!< temporary
     DataArray m_fastK;
     DataArray m_fastD;
 
@@ -13,11 +13,15 @@
 
 #include "../indicator.h"
 #include "../../dataarray.h"
+#include "../../utils/math.h"
 
 #include <deque>
 
 namespace siis {
 
+class SnapshotWriter;
+class SnapshotReader;
+
 /**
  * @brief SiiS tick volume profile indicator.
  * @author Frederic Scherma
@@ -44,7 +48,7 @@ public:
      * @param name
      * @param timeframe Related bar timeframe or 0
      * @param historySize min 1
-     * @param sensibility bin width
+     * @param sensibility bin width, rounded to a multiple of the tick size
      * @param valueAreaSize In percent ]0..100]
      * @param computePeaksAndValleys Auto compute at finalize (default false)
      * @param tickScale Supplementary tick scalar to adjust price computation
@@ -127,6 +131,12 @@ public:
      */
     void update(const Tick &tick, o3d::Bool finalize=false);
 
+    //! Write the current and the previous profiles, the ticks being not replayed after a restart.
+    void saveState(SnapshotWriter &writer) const;
+
+    //! Restore a state written by saveState, false if the configuration or the bin size differ.
+    o3d::Bool loadState(SnapshotReader &reader);
+
     void updateValueArea();
     void updatePeaksAndValleys();
 
@@ -152,6 +162,10 @@ private:
     o3d::Double m_tickSize;          //!< from market data
     o3d::Int32 m_pricePrecision;     //!< from market data
 
+    o3d::Double m_invTickSize;       //!< inverse of the tick size
+    o3d::Int64 m_binTicks;           //!< sensibility in ticks
+    o3d::Double m_binSize;           //!< sensibility rounded to a multiple of the tick size
+
     o3d::Int32 m_historySize;
     o3d::Double m_sensibility;
 
@@ -164,15 +178,21 @@ private:
     VolumeProfileData *m_pCurrent;
     o3d::Double m_openTimestamp;
 
-    o3d::Double m_currentMinPrice;
-    o3d::Double m_currentMaxPrice;
+    o3d::Int64 m_currentMinBin;
+    o3d::Int64 m_currentMaxBin;
 
     o3d::Bool m_consolidated;
 
     std::deque<VolumeProfileData*> m_vp;
 
     void createVolumeProfile(o3d::Double timestamp, o3d::Double price);
-    o3d::Double basePrice(o3d::Double price) const;
+    void updateBinSize();
+
+    //! Index of the bin of a price, the price being quantized to an integer number of ticks.
+    inline o3d::Int64 binLevel(o3d::Double price) const { return floorDiv(tickLevel(price, m_invTickSize), m_binTicks); }
+
+    //! Key of a bin, its centered price.
+    inline o3d::Double binPrice(o3d::Int64 bin) const { return (static_cast<o3d::Double>(bin) + 0.5) * m_binSize; }
 
     VolumeProfileData::IT_BinHashMap setAt(o3d::Double price);
     void updatePoc(VolumeProfileData::IT_BinHashMap basePriceIt);
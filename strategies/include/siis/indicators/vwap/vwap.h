@@ -14,7 +14,7 @@
 #include "../indicator.h"
 #include "../../dataarray.h"
 
-#include <deque>
+#include <vector>
 
 namespace siis {
 
@@ -22,6 +22,8 @@ namespace siis {
  * @brief SiiS tick VWAP indicator.
  * @author Frederic Scherma
  * @date 2024-08-18
+ * The current and the previous sessions are a ring of records allocated once, and each tick is an O(1)
+ * update of their running sums. In addition, up to MAX_ANCHORS anchored VWAP are updated from any timestamp.
  */
 class SIIS_API VWap : public Indicator
 {
@@ -30,6 +32,9 @@ public:
     // TYPE_AVERAGE_PRICE
     // CLS_INDEX
 
+    //! Max number of anchored VWAP.
+    static const o3d::Int32 MAX_ANCHORS = 4;
+
     /**
      * @brief VWap
      * @param name
@@ -57,13 +62,14 @@ public:
     o3d::Int32 historySize() const { return m_historySize; }
     o3d::Bool hasSessionFilter() const { return m_sessionFilter; }
 
-    o3d::Bool hasValues() const { return !m_vwap.empty(); }
+    o3d::Bool hasValues() const { return m_numPrevious > 0; }
 
-    const std::deque<VWapData*> vwap() const { return m_vwap; }
+    //! Number of previous sessions, at most history size.
+    o3d::Int32 numPrevious() const { return m_numPrevious; }
 
-    o3d::Bool hasCurrent() const { return m_pCurrent != nullptr; }
+    o3d::Bool hasCurrent() const { return m_hasCurrent; }
 
-    const VWapData* current() const { return m_pCurrent; }
+    const VWapData* current() const { return m_hasCurrent ? &m_sessions[m_lastSession] : nullptr; }
 
     o3d::Double last() const { return m_last; }
     o3d::Double prev() const { return m_prev; }
@@ -76,6 +82,31 @@ public:
      */
     const VWapData* previous(o3d::Int32 n) const;
 
+    //
+    // anchored VWAP
+    //
+
+    /**
+     * @brief addAnchor Start an anchored VWAP at a timestamp, with the ticks from this timestamp.
+     * If there is already MAX_ANCHORS it replaces the older one.
+     * @return Index of the anchor.
+     */
+    o3d::Int32 addAnchor(o3d::Double timestamp);
+
+    void removeAnchor(o3d::Int32 n);
+    void clearAnchors();
+
+    o3d::Int32 numAnchors() const { return m_numAnchors; }
+
+    /**
+     * @brief anchor Running sums of an anchored VWAP.
+     * @exception IndexOutOfRange
+     */
+    const VWapAccumulator& anchor(o3d::Int32 n) const;
+
+    o3d::Double anchorVWap(o3d::Int32 n) const { return anchor(n).vwap(); }
+    o3d::Double anchorStdDev(o3d::Int32 n, o3d::Int32 stdDevNum) const;
+
     o3d::Double vwapAt(o3d::Int32 n) const;
     o3d::Double stdDevAt(o3d::Int32 n, o3d::Int32 stdDevNum) const;
 
@@ -85,6 +116,12 @@ public:
      */
     void update(const Tick &tick, o3d::Bool finalize=false);
 
+    //! Write the sessions and the anchors, the ticks being not replayed after a restart.
+    void saveState(SnapshotWriter &writer) const;
+
+    //! Restore a state written by saveState, false if the configuration differs.
+    o3d::Bool loadState(SnapshotReader &reader);
+
 private:
 
     o3d::Double m_vwapTimeframe;
@@ -98,20 +135,20 @@ private:
 
     o3d::Bool m_sessionFilter;
 
-    VWapData *m_pCurrent;
-
     o3d::Double m_openTimestamp;
 
-    o3d::Double m_pvs;
-    o3d::Double m_volumes;
-    o3d::Double m_volume_dev;
-    o3d::Double m_dev2;
+    std::vector<VWapData> m_sessions;   //!< ring of the current and of the previous sessions
+    o3d::Int32 m_lastSession;           //!< index of the current or of the last finalized session
+    o3d::Int32 m_numPrevious;
+    o3d::Bool m_hasCurrent;
 
-    std::deque<VWapData*> m_vwap;
+    VWapAccumulator m_anchors[MAX_ANCHORS];
+    o3d::Int32 m_numAnchors;
 
     o3d::Double m_prev;
     o3d::Double m_last;
 
+    void init();
     void finalize();
 };
 
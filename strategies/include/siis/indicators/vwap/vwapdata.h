@@ -1,4 +1,4 @@
- /**
+/**
  * @brief SiiS tick VWAP data model.
  * @copyright Copyright (C) 2024 SiiS
  * @author Frederic SCHERMA (frederic.scherma@gmail.com)
@@ -10,12 +10,51 @@
 
 #include "../../dataarray.h"
 
+#include <vector>
+
 namespace siis {
 
+class SnapshotWriter;
+class SnapshotReader;
+
+/**
+ * @brief SiiS VWAP running sums, from a session open or from an anchor.
+ * @author Frederic Scherma
+ * @date 2024-10-18
+ */
+class SIIS_API VWapAccumulator
+{
+public:
+
+    o3d::Double timestamp {0};     //!< of the first accumulated tick, or of the anchor
+
+    o3d::Double pvs {0};           //!< sum of price * volume
+    o3d::Double volumes {0};       //!< sum of volume
+    o3d::Double p2vs {0};          //!< sum of price^2 * volume
+
+    void reset(o3d::Double timestamp);
+
+    inline void add(o3d::Double price, o3d::Double volume)
+    {
+        pvs += price * volume;
+        volumes += volume;
+        p2vs += (price * price) * volume;
+    }
+
+    inline o3d::Double vwap() const { return volumes > 0.0 ? pvs / volumes : 0.0; }
+
+    o3d::Double stdDev() const;
+
+    void saveState(SnapshotWriter &writer) const;
+    o3d::Bool loadState(SnapshotReader &reader);
+};
+
 /**
  * @brief SiiS VWAP data model.
  * @author Frederic Scherma
  * @date 2024-08-18
+ * Record of a VWAP session, reused from a session to another, its arrays being allocated once.
+ * The arrays contain a value per bar, the last one being updated at each tick, at most depth values.
  */
 class SIIS_API VWapData
 {
@@ -24,14 +63,41 @@ public:
     o3d::Double timestamp {0};     //!< open timestamp
     o3d::Double timeframe {0};     //!< or duration
 
+    VWapAccumulator sums;
+
     DataArray vwap;
 
     std::vector<DataArray> plusStdDev;
     std::vector<DataArray> minusStdDev;
 
-    VWapData(o3d::Double vwapTimeframe, o3d::Double timestamp, o3d::Int32 numStdDev);
+    VWapData();
+
+    //! Allocate the arrays, once.
+    void init(o3d::Int32 depth, o3d::Int32 numStdDev);
+
+    //! Start a new session.
+    void reset(o3d::Double vwapTimeframe, o3d::Double timestamp);
 
+    //! Accumulate a tick and update the values of the last bar. O(numStdDev).
+    void add(o3d::Double price, o3d::Double volume);
+
+    //! The last bar is closed, the next one starts with its values. Drops the older value above depth.
+    void closeBar();
+
+    /**
+     * @brief stdDevAt Band at a positive or negative number of standard deviations.
+     * @exception IndexOutOfRange
+     */
     const DataArray& stdDevAt(o3d::Int32 stdDev) const;
+
+    void saveState(SnapshotWriter &writer) const;
+
+    //! Restore a state written by saveState, false if the depth or the number of deviations differ.
+    o3d::Bool loadState(SnapshotReader &reader);
+
+private:
+
+    o3d::Int32 m_depth;
 };
 
 } // namespace siis
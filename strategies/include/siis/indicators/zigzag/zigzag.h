@@ -12,12 +12,23 @@
 #include "../../constants.h"
 #include "../../dataarray.h"
 
+#include <deque>
+
 namespace siis {
 
+class SnapshotWriter;
+class SnapshotReader;
+
 /**
  * @brief ZigZag indicator.
  * @author Frederic Scherma
  * @date 2019-08-17
+ * Streaming swing pivots detector. A pivot is confirmed once the price reverses from the extremum of the
+ * current leg by more than a distance :
+ *  - percent mode : threshold * price of the extremum (ie. 0.05 for 5%)
+ *  - atr mode : threshold * ATR (Wilder smoothing of the true range of len bars)
+ * Each closed bar costs an O(1) update, the history of the bars is never rescanned.
+ * @note The last bar of the arrays is considered as the current non closed bar and is ignored.
  */
 class SIIS_API ZigZag : public Indicator
 {
@@ -26,33 +37,122 @@ public:
     // TYPE_TREND
     // CLS_OVERLAY
 
+    enum Mode
+    {
+        MODE_PERCENT = 0,
+        MODE_ATR = 1
+    };
+
+    struct Pivot
+    {
+        o3d::Double timestamp {0};   //!< of the bar of the extremum
+        o3d::Int32 direction {0};    //!< 1 for a swing high, -1 for a swing low
+        o3d::Double price {0};
+    };
+
+    typedef std::deque<Pivot> T_Pivots;
+
     ZigZag(const o3d::String &name,
            o3d::Double timeframe,
-           o3d::Double threshold);
+           o3d::Double threshold,
+           Mode mode=MODE_PERCENT,
+           o3d::Int32 atrLen=14,
+           o3d::Int32 depth=32);
     ZigZag(const o3d::String &name, o3d::Double timeframe, IndicatorConfig conf);
 
     void setConf(IndicatorConfig conf);
 
     o3d::Double threshold() const { return m_threshold; }
+    Mode mode() const { return m_mode; }
+    o3d::Int32 atrLen() const { return m_atrLen; }
+    o3d::Int32 depth() const { return m_depth; }
+
+    /**
+     * @brief pivots Confirmed pivots, ordered from older to most recent, at most depth.
+     */
+    const T_Pivots& pivots() const { return m_pivots; }
+
+    //! Number of pivots confirmed by the last compute.
+    o3d::Int32 numNewPivots() const { return m_numNewPivots; }
+
+    //! 1 for an upward leg, -1 for a downward leg, 0 until the first pivot.
+    o3d::Int32 direction() const { return m_direction; }
+
+    //! Extremum of the current leg, the next pivot candidate.
+    o3d::Double extremePrice() const { return m_extremePrice; }
+    o3d::Double extremeTimestamp() const { return m_extremeTimestamp; }
+
+    //! Last ATR, 0 until len bars.
+    o3d::Double atr() const { return m_atr; }
+
+    void reset();
+
+    /**
+     * @brief update Process a closed bar. O(1).
+     * @return True if a pivot is confirmed by this bar.
+     */
+    o3d::Bool update(o3d::Double timestamp, o3d::Double high, o3d::Double low, o3d::Double close);
+
+    /**
+     * @brief compute Process the closed bars since the previous call.
+     * @param timestamps Timestamps of the bars.
+     * @param high High array of price.
+     * @param low Low array of price.
+     * @param close Close array of price.
+     */
+    void compute(o3d::Double timestamp, const DataArray &timestamps,
+                 const DataArray &high, const DataArray &low, const DataArray &close);
 
-    const DataArray& lower() const { return m_lower; }
-    const DataArray& higher() const { return m_higher; }
+    /**
+     * @brief firstNewBar Index of the first closed bar more recent than lastBarTimestamp, or the index of the
+     * last bar if none. O(number of new bars).
+     */
+    static o3d::Int32 firstNewBar(const DataArray &timestamps, o3d::Double lastBarTimestamp);
+
+    //! "atr" or "percent" (default).
+    static Mode modeFromStr(const o3d::String &mode);
 
     /**
-     * @brief compute Compute an Hilbert sine wave.
-     * @param open Open array of price.
-     * @param open High array of price.
-     * @param open Low array of price.
-     * @param open Close array of price.
+     * @brief lookback Min number of necessary samples.
      */
-    void compute(o3d::Double timestamp, const DataArray &open, const DataArray &high, const DataArray &low, const DataArray &close);
+    o3d::Int32 lookback() const;
+
+    //! Write the pivots and the current leg, the bars being not processed again after a restart.
+    void saveState(SnapshotWriter &writer) const;
+
+    //! Restore a state written by saveState, false if the configuration differs.
+    o3d::Bool loadState(SnapshotReader &reader);
 
 private:
 
     o3d::Double m_threshold;
+    Mode m_mode;
+    o3d::Int32 m_atrLen;
+    o3d::Int32 m_depth;
+
+    T_Pivots m_pivots;
+    o3d::Int32 m_numNewPivots;
+
+    o3d::Int32 m_direction;
+    o3d::Double m_extremePrice;
+    o3d::Double m_extremeTimestamp;
+
+    // until the first pivot
+    o3d::Double m_highPrice;
+    o3d::Double m_highTimestamp;
+    o3d::Double m_lowPrice;
+    o3d::Double m_lowTimestamp;
+
+    o3d::Int32 m_numBars;
+    o3d::Double m_prevClose;
+    o3d::Double m_trSum;
+    o3d::Double m_atr;
+
+    o3d::Double m_lastBarTimestamp;
+
+    o3d::Double distance(o3d::Double price) const;
 
-    DataArray m_lower;
-    DataArray m_higher;
+    void addPivot(o3d::Double timestamp, o3d::Int32 direction, o3d::Double price);
 };
 
 } // namespace siis
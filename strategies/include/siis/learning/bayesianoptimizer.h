@@ -0,0 +1,79 @@
+/**
+ * @brief SiiS strategy gaussian process bayesian optimizer.
+ * @copyright Copyright (C) 2024 SiiS
+ * @author Frederic SCHERMA (frederic.scherma@gmail.com)
+ * @date 2024-10-13
+ */
+
+#ifndef SIIS_BAYESIANOPTIMIZER_H
+#define SIIS_BAYESIANOPTIMIZER_H
+
+#include "optimizer.h"
+
+namespace siis {
+
+/**
+ * @brief Bayesian optimizer using a gaussian process surrogate and the expected improvement.
+ * @author Frederic Scherma
+ * @date 2024-10-13
+ * The first points are randomly sampled. Next the gaussian process (squared exponential kernel, length scale
+ * selected by marginal likelihood) is fitted on the standardized scores, and each point of a batch maximizes
+ * the expected improvement over a set of random proposals. The following points of the same batch are chosen
+ * as if the previous ones had scored the predicted mean (kriging believer), for diversity.
+ */
+class SIIS_API BayesianOptimizer : public Optimizer
+{
+public:
+
+    /**
+     * @param initialSamples Number of random points before using the surrogate, 0 for 2 * dimension + 2.
+     * @param numProposals Number of random proposals evaluated per point of a batch.
+     * @param maxHistory Maximal number of evaluations used to fit the surrogate (the best ones).
+     */
+    BayesianOptimizer(o3d::Int32 dimension, o3d::UInt32 seed,
+                      o3d::Int32 initialSamples=0,
+                      o3d::Int32 numProposals=512,
+                      o3d::Int32 maxHistory=200);
+
+    virtual ~BayesianOptimizer() override;
+
+    virtual o3d::String typeName() const override;
+
+    virtual void ask(o3d::Int32 count, std::vector<Point> &points) override;
+
+    o3d::Double lengthScale() const { return m_lengthScale; }
+
+protected:
+
+    virtual void update(const std::vector<Point> &points, const std::vector<o3d::Double> &scores) override;
+
+private:
+
+    o3d::Int32 m_initialSamples;
+    o3d::Int32 m_numProposals;
+    o3d::Int32 m_maxHistory;
+
+    o3d::Double m_lengthScale;
+
+    // surrogate state
+    std::vector<Point> m_x;
+    std::vector<o3d::Double> m_y;       //!< standardized scores
+    std::vector<o3d::Double> m_chol;    //!< lower cholesky factor of the kernel matrix, n*n
+    std::vector<o3d::Double> m_alpha;   //!< K^-1 y
+
+    o3d::Double kernel(const Point &a, const Point &b) const;
+
+    /**
+     * @brief fit Factorize the kernel matrix of the training set.
+     * @return The log marginal likelihood, or -infinity if the matrix is not positive definite.
+     */
+    o3d::Double fit();
+
+    void predict(const Point &x, o3d::Double &mean, o3d::Double &sigma) const;
+
+    Point propose(o3d::Double bestY);
+};
+
+} // namespace siis
+
+#endif // SIIS_BAYESIANOPTIMIZER_H
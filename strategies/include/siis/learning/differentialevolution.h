@@ -0,0 +1,56 @@
+/**
+ * @brief SiiS strategy differential evolution optimizer.
+ * @copyright Copyright (C) 2024 SiiS
+ * @author Frederic SCHERMA (frederic.scherma@gmail.com)
+ * @date 2024-10-13
+ */
+
+#ifndef SIIS_DIFFERENTIALEVOLUTION_H
+#define SIIS_DIFFERENTIALEVOLUTION_H
+
+#include "optimizer.h"
+
+namespace siis {
+
+/**
+ * @brief Differential evolution optimizer (DE/rand/1/bin).
+ * @author Frederic Scherma
+ * @date 2024-10-13
+ * The size of the population is the size of the first asked batch, a latin hypercube sampling.
+ * Each next batch contains one trial per member of the population, replacing it if at least as good.
+ */
+class SIIS_API DifferentialEvolution : public Optimizer
+{
+public:
+
+    /**
+     * @param mutation Differential weight F, generally in [0.4..1].
+     * @param crossover Crossover probability CR in [0..1].
+     */
+    DifferentialEvolution(o3d::Int32 dimension, o3d::UInt32 seed,
+                          o3d::Double mutation=0.6, o3d::Double crossover=0.9);
+
+    virtual ~DifferentialEvolution() override;
+
+    virtual o3d::String typeName() const override;
+
+    virtual void ask(o3d::Int32 count, std::vector<Point> &points) override;
+
+    o3d::Int32 populationSize() const { return static_cast<o3d::Int32>(m_population.size()); }
+
+protected:
+
+    virtual void update(const std::vector<Point> &points, const std::vector<o3d::Double> &scores) override;
+
+private:
+
+    o3d::Double m_mutation;
+    o3d::Double m_crossover;
+
+    std::vector<Point> m_population;
+    std::vector<o3d::Double> m_fitness;
+};
+
+} // namespace siis
+
+#endif // SIIS_DIFFERENTIALEVOLUTION_H
@@ -0,0 +1,180 @@
+/**
+ * @brief SiiS strategy distribution of the optimize mode over a coordinator and its workers.
+ * @copyright Copyright (C) 2024 SiiS
+ * @author Frederic SCHERMA (frederic.scherma@gmail.com)
+ * @date 2024-10-17
+ */
+
+#ifndef SIIS_DISTRIBUTION_H
+#define SIIS_DISTRIBUTION_H
+
+#include "../base.h"
+#include "../config/jsonparser.h"
+
+#include <o3d/core/string.h>
+
+#include <string>
+#include <vector>
+#include <list>
+
+namespace siis {
+
+/**
+ * @brief Specification of a distributed optimization, and partition of the campaign into jobs.
+ * @author Frederic Scherma
+ * @date 2024-10-17
+ * A coordinator partitions the candidates per market (optional), per time fold and per chunk of candidates,
+ * then serves the jobs to any number of workers processes, each one running its jobs with its local market
+ * data and pushing back the results. A job whose worker is silent for longer than the timeout is queued
+ * again, up to the max number of retries. Each time fold is an independent run with its own warm-up,
+ * the results of the folds being summed per candidate. Example of specification :
+ * {
+ *     "bind": "tcp://0.0.0.0:5600",        // coordinator
+ *     "connect": "tcp://127.0.0.1:5600",   // workers
+ *     "time-folds": 4,
+ *     "candidates-per-job": 8,             // share the decoding of the market data into a worker
+ *     "split-markets": true,               // a job per market, else a job for all the markets
+ *     "heartbeat": 5,                      // in seconds, from a worker running a job
+ *     "timeout": 30,                       // in seconds, before a job is considered as lost
+ *     "max-retries": 3
+ * }
+ */
+class SIIS_API Distribution
+{
+public:
+
+    enum JobState
+    {
+        JOB_PENDING = 0,
+        JOB_RUNNING = 1,
+        JOB_DONE = 2,
+        JOB_FAILED = 3
+    };
+
+    /**
+     * @brief A set of candidates, on one or many markets, over one time fold.
+     */
+    struct Job
+    {
+        o3d::Int32 id = 0;
+        o3d::Int32 iteration = 0;
+        o3d::Int32 fold = 0;
+
+        std::vector<std::string> markets;
+        std::vector<o3d::Int32> candidates;
+
+        o3d::Double fromTs = 0.0;
+        o3d::Double toTs = 0.0;
+
+        JobState state = JOB_PENDING;
+        o3d::Int32 attempt = 0;          //!< incremented at each lease
+        std::string worker;              //!< identity of the worker of the current attempt
+        o3d::Double deadline = 0.0;      //!< wall-clock time the current attempt is lost without heartbeat
+    };
+
+    Distribution();
+
+    /**
+     * @brief parse Parse the specification.
+     * @return False if invalid.
+     */
+    o3d::Bool parse(const Json::Value &root);
+
+    const o3d::String& bindAddress() const { return m_bindAddress; }
+    const o3d::String& connectAddress() const { return m_connectAddress; }
+
+    //! Override the bind or the connect address, from the command line.
+    void setAddress(const o3d::String &address);
+
+    o3d::Int32 numTimeFolds() const { return m_numTimeFolds; }
+    o3d::Int32 candidatesPerJob() const { return m_candidatesPerJob; }
+    o3d::Bool splitMarkets() const { return m_splitMarkets; }
+
+    o3d::Double heartbeat() const { return m_heartbeat; }
+    o3d::Double timeout() const { return m_timeout; }
+    o3d::Int32 maxRetries() const { return m_maxRetries; }
+
+    //
+    // jobs
+    //
+
+    /**
+     * @brief partition Append the jobs of the candidates of an iteration.
+     */
+    void partition(o3d::Int32 iteration,
+                   const std::vector<o3d::Int32> &candidates,
+                   const std::vector<std::string> &markets,
+                   o3d::Double fromTs,
+                   o3d::Double toTs);
+
+    const std::vector<Job>& jobs() const { return m_jobs; }
+    const Job* job(o3d::Int32 id) const;
+
+    /**
+     * @brief lease Give the next pending job to a worker.
+     * @return Null if no pending job.
+     */
+    const Job* lease(const std::string &worker, o3d::Double now);
+
+    /**
+     * @brief heartbeat Extend the lease of a running job.
+     * @return False if the attempt is no longer the current one.
+     */
+    o3d::Bool heartbeat(o3d::Int32 id, o3d::Int32 attempt, o3d::Double now);
+
+    /**
+     * @brief complete Mark a job as done.
+     * @return False if the job is already done or failed, the results must then be ignored.
+     */
+    o3d::Bool complete(o3d::Int32 id);
+
+    /**
+     * @brief retry Queue again a job rejected by its worker, or failed if retried too many times.
+     */
+    void retry(o3d::Int32 id, o3d::Int32 attempt);
+
+    /**
+     * @brief expire Queue again the running jobs past their deadline.
+     * @return Number of expired jobs.
+     */
+    o3d::Int32 expire(o3d::Double now);
+
+    //! Number of jobs done or failed.
+    o3d::Int32 numFinished() const { return m_numFinished; }
+    o3d::Int32 numFailed() const { return m_numFailed; }
+
+    //! True if every job of the iteration is done or failed.
+    o3d::Bool finished(o3d::Int32 iteration) const;
+
+    //
+    // messages between the coordinator and the workers, as compact JSON objects with a "type"
+    //
+
+    static std::string encode(const Json::Value &message);
+    static o3d::Bool decode(const char *data, size_t size, Json::Value &message);
+
+private:
+
+    o3d::String m_bindAddress;
+    o3d::String m_connectAddress;
+
+    o3d::Int32 m_numTimeFolds;
+    o3d::Int32 m_candidatesPerJob;
+    o3d::Bool m_splitMarkets;
+
+    o3d::Double m_heartbeat;
+    o3d::Double m_timeout;
+    o3d::Int32 m_maxRetries;
+
+    std::vector<Job> m_jobs;       //!< indexed by id
+    std::list<o3d::Int32> m_queue; //!< pending jobs, retried first
+
+    o3d::Int32 m_numFinished;
+    o3d::Int32 m_numFailed;
+
+    void requeue(Job &job);
+};
+
+} // namespace siis
+
+#endif // SIIS_DISTRIBUTION_H
@@ -10,20 +10,69 @@
 
 #include "../base.h"
 
+#include <o3d/core/string.h>
+
+#include <random>
+#include <vector>
+
 namespace siis {
 
 /**
  * @brief SiiS strategy machine learning strategy optimizer interface.
  * @author Frederic Scherma
  * @date 2019-03-28
+ * Iterative ask and tell optimizer over the unit hypercube of the parameter space, maximizing a score.
+ * Each asked batch is evaluated in parallel, then its scores are told before asking the next batch.
  */
 class SIIS_API Optimizer
 {
 public:
 
+    typedef std::vector<o3d::Double> Point;  //!< normalized coordinates in [0..1] per parameter
+
+    Optimizer(o3d::Int32 dimension, o3d::UInt32 seed);
+
     virtual ~Optimizer() = 0;
 
-    // @todo
+    virtual o3d::String typeName() const = 0;
+
+    o3d::Int32 dimension() const { return m_dimension; }
+
+    /**
+     * @brief ask Generate the next batch of points to evaluate.
+     */
+    virtual void ask(o3d::Int32 count, std::vector<Point> &points) = 0;
+
+    /**
+     * @brief tell Give the scores of the points of the last asked batch, in the same order.
+     */
+    void tell(const std::vector<Point> &points, const std::vector<o3d::Double> &scores);
+
+    o3d::Int32 numEvaluations() const { return static_cast<o3d::Int32>(m_scores.size()); }
+
+    o3d::Bool hasBest() const { return !m_scores.empty(); }
+    const Point& bestPoint() const { return m_bestPoint; }
+    o3d::Double bestScore() const { return m_bestScore; }
+
+protected:
+
+    o3d::Int32 m_dimension;
+    std::mt19937 m_rng;
+
+    std::vector<Point> m_points;        //!< every evaluated points
+    std::vector<o3d::Double> m_scores;  //!< and theirs scores
+
+    Point m_bestPoint;
+    o3d::Double m_bestScore;
+
+    /**
+     * @brief update Called by tell once the evaluations are recorded.
+     */
+    virtual void update(const std::vector<Point> &points, const std::vector<o3d::Double> &scores) = 0;
+
+    Point randomPoint();
+
+    static o3d::Double clip(o3d::Double u) { return u < 0.0 ? 0.0 : (u > 1.0 ? 1.0 : u); }
 };
 
 } // namespace siis
@@ -0,0 +1,152 @@
+/**
+ * @brief SiiS strategy optimization parameter space.
+ * @copyright Copyright (C) 2024 SiiS
+ * @author Frederic SCHERMA (frederic.scherma@gmail.com)
+ * @date 2024-10-09
+ */
+
+#ifndef SIIS_PARAMETERSPACE_H
+#define SIIS_PARAMETERSPACE_H
+
+#include "../base.h"
+#include "../config/jsonparser.h"
+
+#include <vector>
+
+namespace siis {
+
+class Optimizer;
+
+/**
+ * @brief Parameter space of the optimize mode, candidates sampler.
+ * @author Frederic Scherma
+ * @date 2024-10-09
+ * Each candidate is a JSON object of dot formatted strategy parameters overrides, in the same
+ * format as the parameters of a learning file. Example of specification :
+ * {
+ *     "method": "grid" | "random" | "latin-hypercube" | "differential-evolution" | "bayesian",
+ *     "samples": 64,
+ *     "seed": 0,
+ *     "max-candidates": 4096,
+ *     "iterations": 10,       // iterative methods only, number of evaluated batches
+ *     "batch-size": 16,       // iterative methods only, number of candidates per batch
+ *     "early-stopping": {"checkpoints": 4, "quantile": 0.5, "max-loss": 0.1},
+ *     "parameters": {
+ *         "max-trades": {"values": [1, 2, 3]},
+ *         "timeframes.4h.depth": {"min": 10, "max": 40, "step": 5, "type": "int"}
+ *     },
+ *     "validation": {"method": "walk-forward", "folds": 5},  // optional, see Validation
+ *     "pruning": {"max-draw-down": 0.25, "checkpoints": 4},  // optional, see Pruning
+ *     "results": {"store": true, "equity-curve": "1d"},      // optional, see ResultStore
+ *     "distributed": {"time-folds": 4, "timeout": 30}        // optional, see Distribution
+ * }
+ */
+class SIIS_API ParameterSpace
+{
+public:
+
+    enum Method
+    {
+        METHOD_GRID = 0,
+        METHOD_RANDOM = 1,
+        METHOD_LATIN_HYPERCUBE = 2,
+        METHOD_DIFFERENTIAL_EVOLUTION = 3,
+        METHOD_BAYESIAN = 4
+    };
+
+    /**
+     * @brief Early stopping of the clearly losing candidates of a batch, at regular checkpoints of the period.
+     * At each checkpoint, the candidates with a loss greater than max-loss, and the worst quantile of the
+     * candidates in loss, are stopped. Their score is their performance at that time.
+     */
+    struct EarlyStopping
+    {
+        o3d::Int32 checkpoints{0};   //!< number of checkpoints over the period, 0 to disable
+        o3d::Double quantile{0.0};   //!< ratio of the candidates in loss stopped at each checkpoint
+        o3d::Double maxLoss{0.0};    //!< loss rate stopping a candidate at any checkpoint, 0 to disable
+    };
+
+    struct Range
+    {
+        std::string name;              //!< dot formatted parameter name
+        o3d::Bool integer{false};      //!< round the sampled values
+
+        o3d::Double min{0.0};
+        o3d::Double max{0.0};
+        o3d::Double step{0.0};         //!< grid step, or sampling precision if greater than 0
+
+        std::vector<Json::Value> values;  //!< explicit list of values, replaces min/max/step
+    };
+
+    ParameterSpace();
+
+    /**
+     * @brief parse Parse the specification of the space.
+     * @return False if the method is unknown or a parameter range is invalid.
+     */
+    o3d::Bool parse(const Json::Value &root);
+
+    Method method() const { return m_method; }
+    o3d::Int32 numSamples() const { return m_numSamples; }
+    o3d::UInt32 seed() const { return m_seed; }
+
+    const std::vector<Range>& ranges() const { return m_ranges; }
+
+    o3d::Int32 dimension() const { return static_cast<o3d::Int32>(m_ranges.size()); }
+
+    /**
+     * @brief iterative True if the candidates are given batch per batch by an optimizer.
+     */
+    o3d::Bool iterative() const;
+
+    o3d::Int32 numIterations() const { return m_numIterations; }
+    o3d::Int32 batchSize() const { return m_batchSize; }
+
+    const EarlyStopping& earlyStopping() const { return m_earlyStopping; }
+
+    /**
+     * @brief createOptimizer Create the optimizer of an iterative method, or return nullptr.
+     */
+    Optimizer* createOptimizer() const;
+
+    /**
+     * @brief candidateAt Candidate at the normalized coordinates of an optimizer point.
+     */
+    Json::Value candidateAt(const std::vector<o3d::Double> &point) const;
+
+    /**
+     * @brief generate Generate the candidates, each one an object of dot formatted overrides.
+     * The number of candidates is bounded by max-candidates. Nothing for the iterative methods.
+     */
+    void generate(std::vector<Json::Value> &candidates) const;
+
+private:
+
+    Method m_method;
+    o3d::Int32 m_numSamples;
+    o3d::Int32 m_maxCandidates;
+    o3d::UInt32 m_seed;
+
+    o3d::Int32 m_numIterations;
+    o3d::Int32 m_batchSize;
+
+    o3d::Double m_mutation;
+    o3d::Double m_crossover;
+    o3d::Int32 m_initialSamples;
+
+    EarlyStopping m_earlyStopping;
+
+    std::vector<Range> m_ranges;
+
+    void generateGrid(std::vector<Json::Value> &candidates) const;
+    void generateRandom(std::vector<Json::Value> &candidates) const;
+    void generateLatinHypercube(std::vector<Json::Value> &candidates) const;
+
+    static o3d::Int32 numSteps(const Range &range);
+    static Json::Value valueAtStep(const Range &range, o3d::Int32 i);
+    static Json::Value valueAt(const Range &range, o3d::Double u);
+};
+
+} // namespace siis
+
+#endif // SIIS_PARAMETERSPACE_H
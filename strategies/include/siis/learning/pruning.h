@@ -0,0 +1,128 @@
+/**
+ * @brief SiiS strategy pruning rules of the backtest and optimize modes.
+ * @copyright Copyright (C) 2024 SiiS
+ * @author Frederic SCHERMA (frederic.scherma@gmail.com)
+ * @date 2024-10-14
+ */
+
+#ifndef SIIS_PRUNING_H
+#define SIIS_PRUNING_H
+
+#include "../base.h"
+#include "../config/jsonparser.h"
+
+#include <o3d/core/string.h>
+
+#include <vector>
+
+namespace siis {
+
+/**
+ * @brief Rules stopping a backtest run as soon as its results violate the constraints.
+ * @author Frederic Scherma
+ * @date 2024-10-14
+ * The rules are evaluated on the fly, after each timestep, from the realized plus unrealized performance
+ * and the number of closed trades of the run. A pruned run is stopped and reported with its reason.
+ * The median rule compares the performance of a run at each checkpoint of the period to the median of
+ * the performances of the others runs having reached the same checkpoint, so it applies only to the
+ * optimize mode. Example of specification :
+ * {
+ *     "max-draw-down": 0.25,         // loss from the highest performance, 0 to disable
+ *     "min-trades-per-month": 2,     // 0 to disable
+ *     "min-trades-after": "1M",      // grace period before checking the number of trades
+ *     "checkpoints": 4,              // optimize only, number of median checkpoints, 0 to disable
+ *     "median-margin": 0.02,         // pruned if lower than the median minus this margin
+ *     "min-references": 5            // number of performances at a checkpoint to define its median
+ * }
+ */
+class SIIS_API Pruning
+{
+public:
+
+    enum Reason
+    {
+        REASON_NONE = 0,
+        REASON_DRAW_DOWN = 1,
+        REASON_MIN_TRADES = 2,
+        REASON_BELOW_MEDIAN = 3
+    };
+
+    /**
+     * @brief State of the rules for a run.
+     */
+    struct State
+    {
+        Reason reason = REASON_NONE;
+        o3d::Double timestamp = 0.0;    //!< when pruned
+
+        o3d::Double peak = 0.0;         //!< highest performance
+        o3d::Double drawDown = 0.0;     //!< max loss from the highest performance
+
+        o3d::Int32 checkpoint = 0;      //!< number of reached checkpoints
+
+        o3d::Bool pruned() const { return reason != REASON_NONE; }
+    };
+
+    Pruning();
+
+    /**
+     * @brief parse Parse the specification of the rules.
+     * @return False if a rule is invalid.
+     */
+    o3d::Bool parse(const Json::Value &root);
+
+    /**
+     * @brief enabled True if at least one rule is defined.
+     */
+    o3d::Bool enabled() const;
+
+    o3d::Double maxDrawDown() const { return m_maxDrawDown; }
+    o3d::Double minTradesPerMonth() const { return m_minTradesPerMonth; }
+    o3d::Int32 numCheckpoints() const { return m_numCheckpoints; }
+
+    /**
+     * @brief setPeriod Define the evaluated period, before any update.
+     */
+    void setPeriod(o3d::Double fromTs, o3d::Double toTs);
+
+    /**
+     * @brief update Evaluate the draw-down and the number of trades rules.
+     * @param performance Realized plus unrealized performance in percentiles.
+     * @param numTrades Number of closed trades.
+     * @return True if the run is pruned, the reason being set into the state.
+     */
+    o3d::Bool update(State &state, o3d::Double performance, o3d::Int32 numTrades, o3d::Double timestamp) const;
+
+    /**
+     * @brief reachCheckpoint Index of the checkpoint reached at timestamp, or -1.
+     * Each checkpoint is reached only once per state.
+     */
+    o3d::Int32 reachCheckpoint(State &state, o3d::Double timestamp) const;
+
+    /**
+     * @brief checkMedian Evaluate the median rule at a reached checkpoint.
+     * @param references Performances at the same checkpoint of the runs having reached it.
+     * @return True if the run is pruned, the reason being set into the state.
+     */
+    o3d::Bool checkMedian(State &state, o3d::Double performance,
+                          const std::vector<o3d::Double> &references, o3d::Double timestamp) const;
+
+    static o3d::String reasonToStr(Reason reason);
+
+private:
+
+    o3d::Double m_maxDrawDown;
+    o3d::Double m_minTradesPerMonth;
+    o3d::Double m_minTradesAfter;
+
+    o3d::Int32 m_numCheckpoints;
+    o3d::Double m_medianMargin;
+    o3d::Int32 m_minReferences;
+
+    o3d::Double m_fromTs;
+    o3d::Double m_toTs;
+};
+
+} // namespace siis
+
+#endif // SIIS_PRUNING_H
@@ -0,0 +1,143 @@
+/**
+ * @brief SiiS strategy append-only binary store of the optimization results.
+ * @copyright Copyright (C) 2024 SiiS
+ * @author Frederic SCHERMA (frederic.scherma@gmail.com)
+ * @date 2024-10-16
+ */
+
+#ifndef SIIS_RESULTSTORE_H
+#define SIIS_RESULTSTORE_H
+
+#include "../base.h"
+#include "../config/jsonparser.h"
+
+#include <o3d/core/string.h>
+#include <o3d/core/mutex.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace siis {
+
+/**
+ * @brief Append-only binary store of one row of results per candidate of the optimize mode.
+ * @author Frederic Scherma
+ * @date 2024-10-16
+ * Rows are appended and flushed one by one, from any thread, then a run interrupted at any time keeps
+ * its completed rows. Values are written in the little endian byte order. File layout :
+ *  - header : magic "SIISRSLT", uint32 version, then a block of the schema
+ *  - block : uint32 payload size, uint32 CRC32 of the payload, then the payload
+ *  - schema : int32 count and strings of the parameters names, int32 count and strings of the stats names
+ *  - then a block per row : int32 candidate, int32 iteration, int32 pruning reason, int32 flags,
+ *    per parameter a uint8 type (0 null, 1 number, 2 string) then a double or a string,
+ *    a double per stat, and the equity curve
+ *  - equity curve : int32 count, and if not empty double from, double step, double scale,
+ *    int32 size then the bytes of the zig-zag varint deltas of the values divided by scale
+ *  - string : int32 size then the UTF-8 bytes
+ * A truncated or corrupted row ends the reading.
+ */
+class SIIS_API ResultStore
+{
+public:
+
+    static const o3d::UInt32 VERSION = 1;
+
+    enum Flags
+    {
+        FLAG_EARLY_STOPPED = 1
+    };
+
+    /**
+     * @brief Results of a candidate.
+     */
+    struct Row
+    {
+        o3d::Int32 candidate = 0;
+        o3d::Int32 iteration = 0;
+        o3d::Int32 pruned = 0;              //!< Pruning::Reason
+        o3d::Int32 flags = 0;
+
+        std::vector<Json::Value> parameters;  //!< in the order of the schema
+        std::vector<o3d::Double> stats;       //!< in the order of the schema
+
+        o3d::Double equityFrom = 0.0;       //!< timestamp of the first equity sample
+        o3d::Double equityStep = 0.0;       //!< duration between two equity samples
+        std::vector<o3d::Double> equity;    //!< performance at each sample, optional
+    };
+
+    ResultStore();
+    ~ResultStore();
+
+    /**
+     * @brief create Create or truncate the file and write its schema.
+     * @param precision Precision of the equity curve values.
+     */
+    o3d::Bool create(const o3d::String &filename,
+                     const std::vector<std::string> &parameters,
+                     const std::vector<std::string> &stats,
+                     o3d::Double precision = 1e-6);
+
+    void close();
+
+    o3d::Bool isOpen() const { return m_file != nullptr; }
+    const o3d::String& filename() const { return m_filename; }
+    o3d::Int32 numRows() const { return m_numRows; }
+
+    /**
+     * @brief append Encode then write a row. Thread-safe.
+     */
+    o3d::Bool append(const Row &row);
+
+private:
+
+    o3d::FastMutex m_mutex;
+    FILE *m_file;
+
+    o3d::String m_filename;
+    o3d::Int32 m_numParameters;
+    o3d::Int32 m_numStats;
+    o3d::Double m_precision;
+
+    o3d::Int32 m_numRows;
+};
+
+/**
+ * @brief Reader of a result store file.
+ * @author Frederic Scherma
+ * @date 2024-10-16
+ */
+class SIIS_API ResultStoreReader
+{
+public:
+
+    ResultStoreReader();
+    ~ResultStoreReader();
+
+    /**
+     * @brief open Open the file and read its schema.
+     */
+    o3d::Bool open(const o3d::String &filename);
+
+    void close();
+
+    const std::vector<std::string>& parameters() const { return m_parameters; }
+    const std::vector<std::string>& stats() const { return m_stats; }
+
+    /**
+     * @brief next Read the next row.
+     * @return False at the end of the file, or on a truncated or corrupted row.
+     */
+    o3d::Bool next(ResultStore::Row &row);
+
+private:
+
+    FILE *m_file;
+
+    std::vector<std::string> m_parameters;
+    std::vector<std::string> m_stats;
+};
+
+} // namespace siis
+
+#endif // SIIS_RESULTSTORE_H
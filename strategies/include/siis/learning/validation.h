@@ -0,0 +1,136 @@
+/**
+ * @brief SiiS strategy walk-forward and cross-validation of the optimize mode.
+ * @copyright Copyright (C) 2024 SiiS
+ * @author Frederic SCHERMA (frederic.scherma@gmail.com)
+ * @date 2024-10-11
+ */
+
+#ifndef SIIS_VALIDATION_H
+#define SIIS_VALIDATION_H
+
+#include "../base.h"
+#include "../config/jsonparser.h"
+#include "../statistics/statistics.h"
+
+#include <vector>
+
+namespace siis {
+
+/**
+ * @brief Walk-forward and k-fold time-series cross-validation of the candidates of a parameter space.
+ * @author Frederic Scherma
+ * @date 2024-10-11
+ * Every candidate runs a single time over [from, to], and the folds are windows over its closed trades,
+ * then the analysers stay warm from a window to the next and all the folds are evaluated in the same pass.
+ * For each fold the candidate having the best in-sample performance is selected, and its out-of-sample
+ * results are reported. A trade is counted in the window of its entry. The in-sample trades living in the
+ * out-of-sample block, widened by the embargo on each side, are purged, then no in-sample trade shares
+ * a period with the out-of-sample ones. Example of specification :
+ * {
+ *     "method": "walk-forward" | "k-fold",
+ *     "folds": 5,
+ *     "in-sample-ratio": 0.75,   // walk-forward only, in-sample part of each fold window
+ *     "anchored": false,         // walk-forward only, in-sample windows always start at from
+ *     "embargo": "1d"            // optional gap around each out-of-sample block, as a timeframe
+ * }
+ */
+class SIIS_API Validation
+{
+public:
+
+    enum Method
+    {
+        METHOD_WALK_FORWARD = 0,
+        METHOD_K_FOLD = 1
+    };
+
+    struct Fold
+    {
+        o3d::Int32 index;
+
+        o3d::Double inSampleFrom;
+        o3d::Double inSampleTo;
+
+        o3d::Double outOfSampleFrom;
+        o3d::Double outOfSampleTo;
+
+        o3d::Double purgeFrom;   //!< out-of-sample block widened by the embargo,
+        o3d::Double purgeTo;     //!< the in-sample trades living in it are excluded
+    };
+
+    /**
+     * @brief Results of the closed trades over a window.
+     */
+    struct WindowStats
+    {
+        o3d::Double performance = 0.0;      //!< in percentiles
+        o3d::Double maxDrawDownRate = 0.0;  //!< in percentiles, from the cumulated performance
+
+        o3d::Double best = 0.0;
+        o3d::Double worst = 0.0;
+
+        o3d::Int32 succeedTrades = 0;
+        o3d::Int32 failedTrades = 0;
+        o3d::Int32 totalTrades = 0;
+    };
+
+    Validation();
+
+    /**
+     * @brief parse Parse the specification of the validation.
+     * @return False if the method is unknown or the number of folds invalid.
+     */
+    o3d::Bool parse(const Json::Value &root);
+
+    Method method() const { return m_method; }
+    o3d::Int32 numFolds() const { return m_numFolds; }
+    o3d::Double embargo() const { return m_embargo; }
+
+    /**
+     * @brief generate Slice [fromTs, toTs] into the folds.
+     */
+    void generate(o3d::Double fromTs, o3d::Double toTs);
+
+    const std::vector<Fold>& folds() const { return m_folds; }
+
+    /**
+     * @brief inSampleStats Results of a candidate over the in-sample part of a fold.
+     * @param stats Statistics of each strategy (one per market) of the candidate.
+     */
+    WindowStats inSampleStats(const std::vector<const Statistics*> &stats, const Fold &fold) const;
+
+    /**
+     * @brief outOfSampleStats Results of a candidate over the out-of-sample part of a fold.
+     */
+    WindowStats outOfSampleStats(const std::vector<const Statistics*> &stats, const Fold &fold) const;
+
+    /**
+     * @brief inSampleDuration Duration of the in-sample part of a fold, excluding its purged period.
+     */
+    static o3d::Double inSampleDuration(const Fold &fold);
+
+    /**
+     * @brief windowStats Results of the trades entered in [from, to[, excluding those whose lifetime from their
+     * entry to their exit overlaps [excludeFrom, excludeTo[.
+     */
+    static WindowStats windowStats(const std::vector<const Statistics*> &stats,
+                                   o3d::Double from, o3d::Double to,
+                                   o3d::Double excludeFrom = 0.0, o3d::Double excludeTo = 0.0);
+
+private:
+
+    Method m_method;
+    o3d::Int32 m_numFolds;
+    o3d::Double m_inSampleRatio;
+    o3d::Bool m_anchored;
+    o3d::Double m_embargo;
+
+    o3d::Double m_fromTs;
+    o3d::Double m_toTs;
+
+    std::vector<Fold> m_folds;
+};
+
+} // namespace siis
+
+#endif // SIIS_VALIDATION_H
@@ -282,6 +282,11 @@ public:
 
     void setMarginFactor(o3d::Double marginFactor);
 
+    /**
+     * @brief copyInfo Copy the details, fees, filters and last prices of another market, not the buffers.
+     */
+    void copyInfo(const Market &market);
+
     //
     // helpers
     //
@@ -244,6 +244,25 @@ public:
         forceSize(t+1);
         memcpy(getContent(t), ohlc.data(), 64);
     }
+
+    /**
+     * @brief pushArray Push back n ohlc given as contiguous blocks of 8 doubles, growth of the array size if necessary.
+     */
+    inline void pushArray(const o3d::Double *data, o3d::Int32 n)
+    {
+        if (n <= 0) {
+            return;
+        }
+
+        o3d::Int32 t = getSize();
+
+        while (t + n >= getMaxSize()) {
+            growSize();
+        }
+
+        forceSize(t+n);
+        memcpy(getContent(t), data, static_cast<size_t>(n)*64);
+    }
 };
 
 /**
@@ -342,9 +361,37 @@ public:
         return res;
     }
 
+    /**
+     * @brief lastElt Return the last written ohlc or nullptr if empty.
+     */
+    inline Ohlc* lastElt()
+    {
+        if (m_size == 0) {
+            return nullptr;
+        }
+
+        return m_last == get(0) ? m_end - 1 : m_last - 1;
+    }
+
     inline Cit cbegin() const { return Cit(this, m_size > 0 ? m_first : nullptr); }
     inline Cit cend() const { return Cit(this, nullptr); }
 
+    /**
+     * @brief segments Data of the ohlc from the older to the newer, as two contiguous segments of 8 doubles
+     * per ohlc, the first one until the end of the buffer, the second one from its start once wrapped.
+     * Allows a linear processing without the wrap detection of the iterator.
+     * @return Number of ohlc of the first segment, the second segment having size() minus this number.
+     */
+    inline o3d::Int32 segments(const o3d::Double *&first, const o3d::Double *&second) const
+    {
+        const o3d::Int32 firstIdx = static_cast<o3d::Int32>(m_first - get(0));
+
+        first = getContent(firstIdx);
+        second = getContent(0);
+
+        return o3d::min(m_size, getSize() - firstIdx);
+    }
+
     inline o3d::Int32 size() const { return m_size; }
     inline o3d::Bool full() const { return m_size == getSize(); }
 
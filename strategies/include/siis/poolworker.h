@@ -8,7 +8,9 @@
 #ifndef SIIS_POOLWORKER_H
 #define SIIS_POOLWORKER_H
 
+#include <o3d/core/error.h>
 #include <o3d/core/mutex.h>
+#include <o3d/core/runnable.h>
 #include "worker.h"
 
 #include <deque>
@@ -16,6 +18,8 @@
 namespace siis {
 
 class Strategy;
+class Connector;
+class Database;
 
 /**
  * @brief Pool of worker (parallelized jobs executions).
@@ -33,12 +37,36 @@ public:
         o3d::WaitCondition condition;
         o3d::FastMutex mutex;
 
+        o3d::String error;     //!< first error of the jobs, empty if none
+
+        /**
+         * @brief wait Wait for the end of the jobs.
+         * @exception E_InvalidResult The first error of the failed jobs, raised on the waiting thread.
+         */
         void wait()
         {
             mutex.lock();
             while (count > 0) {
                 condition.wait(mutex);
             }
+
+            o3d::String msg = error;
+            error = o3d::String();
+
+            mutex.unlock();
+
+            if (!msg.isEmpty()) {
+                O3D_ERROR(o3d::E_InvalidResult(msg));
+            }
+        }
+
+        //! Keep the error of a failed job, the job must be counted down after.
+        void fail(const o3d::String &msg)
+        {
+            mutex.lock();
+            if (error.isEmpty()) {
+                error = msg;
+            }
             mutex.unlock();
         }
 
@@ -55,9 +83,24 @@ public:
 
     struct Job
     {
+        enum Type
+        {
+            PROCESS = 0,    //!< process the strategy at timestamp
+            PREPARE = 1,    //!< prepare the market data of the strategy from timestamp to toTimestamp
+            RUNNABLE = 2    //!< run a runnable with its data
+        };
+
+        Type type{PROCESS};
         CountDown *countDown{nullptr};
         Strategy *strategy;
         o3d::Double timestamp;
+
+        Connector *connector{nullptr};
+        Database *database{nullptr};
+        o3d::Double toTimestamp{0.0};
+
+        o3d::Runnable *runnable{nullptr};
+        void *data{nullptr};
     };
 
     PoolWorker(o3d::Int32 numWorker=8);
@@ -71,6 +114,17 @@ public:
     Job* nextJob();
     void addJob(Strategy *strategy, o3d::Double timestamp, CountDown *countDown = nullptr);
 
+    /**
+     * @brief addPrepareJob Prepare the market data of a strategy, using a connection of the database pool.
+     */
+    void addPrepareJob(Strategy *strategy, Connector *connector, Database *database,
+                       o3d::Double fromTs, o3d::Double toTs, CountDown *countDown = nullptr);
+
+    /**
+     * @brief addRunnableJob Run any runnable on a worker, data is given to run.
+     */
+    void addRunnableJob(o3d::Runnable *runnable, void *data, CountDown *countDown = nullptr);
+
     void ping();
 
 private:
@@ -22,24 +22,35 @@ class Trade;
  * @brief SiiS statistic sampler for notional or currency values.
  * @author Frederic Scherma
  * @date 2024-07-15
+ * Online (Welford) accumulator of the mean and the variance. The samples are only retained on demand.
  */
 class SIIS_API Sampler
 {
 public:
 
     o3d::String name;
-    std::vector<o3d::Double> samples;
+    std::vector<o3d::Double> samples;  //!< only if keepSamples
     o3d::Double minValue = 0.0;
     o3d::Double maxValue = 0.0;
     o3d::Double cumulated = 0.0;
 
-    o3d::Double avg = 0.0;
-    o3d::Double stdDev = 0.0;
+    o3d::Double avg = 0.0;     //!< running mean
+    o3d::Double stdDev = 0.0;  //!< computed by finalize
 
-    Sampler(const o3d::String &_name);
+    o3d::Int32 n = 0;          //!< number of samples
+    o3d::Double m2 = 0.0;      //!< running sum of the squared deviations from the mean
+
+    o3d::Bool keepSamples = false;
+
+    Sampler(const o3d::String &_name, o3d::Bool _keepSamples = false);
 
     void addSample(o3d::Double value);
 
+    /**
+     * @brief merge Combine the samples of another sampler (Chan's parallel algorithm).
+     */
+    void merge(const Sampler &other);
+
     o3d::Int32 count() const;
 
     Sampler& finalize();
@@ -55,12 +66,41 @@ class SIIS_API PercentSampler : public Sampler
 {
 public:
 
-    PercentSampler(const o3d::String &_name);
+    PercentSampler(const o3d::String &_name, o3d::Bool _keepSamples = false);
 
     PercentSampler& finalize();
 };
 
 
+/**
+ * @brief SiiS statistic sampler of a value per period of time.
+ * @author Frederic Scherma
+ * @date 2024-10-15
+ * Either the sum or the peak of the values of each period is sampled, the periods without value
+ * are sampled with a zero. The current period is sampled by finalize.
+ */
+class SIIS_API PeriodSampler : public Sampler
+{
+public:
+
+    o3d::Double period = 0.0;
+    o3d::Double periodTimestamp = 0.0;  //!< base time of the current period, 0 before the first value
+    o3d::Double current = 0.0;          //!< value of the current period
+
+    PeriodSampler(const o3d::String &_name, o3d::Double _period);
+
+    /**
+     * @brief advance Move to the period of timestamp, sampling the completed periods.
+     */
+    void advance(o3d::Double timestamp);
+
+    void accumulate(o3d::Double value) { current += value; }
+    void peak(o3d::Double value) { current = o3d::max(current, value); }
+
+    PeriodSampler& finalize();
+};
+
+
 /**
  * @brief SiiS statistic token for notional values.
  * @author Frederic Scherma
@@ -139,6 +179,74 @@ public:
 };
 
 
+/**
+ * @brief SiiS online accumulator of the results of the closed trades.
+ * @author Frederic Scherma
+ * @date 2024-10-15
+ * Updated per trade, in the order of their exit, without retaining them.
+ */
+class SIIS_API TradesAccumulator
+{
+public:
+
+    Sampler anyTradePnl;
+    PercentSampler anyTradePnlPct;
+
+    Sampler winningTradePnl;
+    PercentSampler winningTradePnlPct;
+
+    Sampler loosingTradePnl;
+    PercentSampler loosingTradePnlPct;
+
+    PercentSampler mfePct;
+    PercentSampler maePct;
+    PercentSampler etdPct;
+
+    PercentSampler eefPct;
+    PercentSampler xefPct;
+    PercentSampler tefPct;
+
+    Sampler timeInMarket;
+
+    PeriodSampler profitPerMonthPct;
+    PeriodSampler profitPerMonth;
+
+    o3d::Double cumPnlPct = 0.0;
+    o3d::Double cumPnl = 0.0;
+
+    o3d::Double maxPnlPct = 0.0;
+    o3d::Double maxPnl = 0.0;
+
+    o3d::Double maxPnlPctTs = 0.0;
+    o3d::Double maxPnlTs = 0.0;
+
+    o3d::Double maxTimeToRecoverPct = 0.0;
+    o3d::Double maxTimeToRecover = 0.0;
+
+    o3d::Double sumDrawDownsSqrPct = 0.0;  //!< for the Ulcer index
+    o3d::Double sumDrawDownsSqr = 0.0;
+
+    o3d::Double longestFlatPeriod = 0.0;
+
+    o3d::Double firstTradeTs = 0.0;        //!< entry of the first trade
+    o3d::Double lastTradeTs = 0.0;         //!< entry of the last trade
+    o3d::Double lastExitTs = 0.0;
+
+    o3d::Int32 numTrades = 0;
+
+    TradesAccumulator();
+
+    void addTrade(const TradeResults &trade);
+
+    /**
+     * @brief merge Combine the trades of another market.
+     * @note The samplers are exactly merged, but the values depending on the sequence of the trades
+     * (time to recover, Ulcer index, flat period, profit per month) are approximated by those of each market.
+     */
+    void merge(const TradesAccumulator &other);
+};
+
+
 /**
  * @brief SiiS statistics base model and compatible for export for a strategy (per market).
  * @author Frederic Scherma
@@ -173,7 +281,11 @@ public:
     o3d::Int32 stopLossInGain = 0;
     o3d::Int32 takeProfitInGain = 0;
 
-    std::vector<TradeResults> tradesResults;   //!< any trades
+    o3d::Bool detailed = true;                 //!< retains the results of any trades
+    std::vector<TradeResults> tradesResults;   //!< any trades, if detailed
+
+    TradesAccumulator accumulator;             //!< online results of any trades
+
     void addTrade(const Trade *trade);
 
     // the following members are only used for internals processes
@@ -201,10 +313,28 @@ public:
 };
 
 
+/**
+ * @brief SiiS online accumulator of the daily samples of the account.
+ * @author Frederic Scherma
+ * @date 2024-10-15
+ */
+class SIIS_API AccountAccumulator
+{
+public:
+
+    PeriodSampler drawDownPerMonthPct;
+    PeriodSampler drawDownPerMonth;
+
+    AccountAccumulator();
+
+    void addSample(const AccountSample &sample);
+};
+
+
 /**
  * @brief The AccountStatistics class
  * Statistics for the account in currency, with equity and pnl.
- * Also contains samples at a daily frequency.
+ * Also contains samples at a daily frequency, if detailed.
  */
 class SIIS_API AccountStatistics
 {
@@ -217,7 +347,8 @@ public:
     o3d::Double maxDrawDownRate = 0.0;  //!< in percentile of equity
     o3d::Double maxDrawDown = 0.0;      //!< in currency
 
-    std::vector<AccountSample> samples;  //!< per day sample of the state of the account
+    std::vector<AccountSample> samples;  //!< per day sample of the state of the account, if detailed
+    AccountAccumulator accumulator;      //!< online results of any samples
 };
 
 /**
@@ -254,7 +385,10 @@ public:
     o3d::Int32 stopLossInGain = 0;
     o3d::Int32 takeProfitInGain = 0;
 
-    std::vector<TradeResults> tradesResults;
+    o3d::Bool detailed = true;                //!< every added statistics retained the results of their trades
+    std::vector<TradeResults> tradesResults;  //!< if detailed
+
+    TradesAccumulator accumulator;            //!< merged online results of the trades
 
     o3d::Double longestFlatPeriod = 0.0;     //!< longest duration between two trade, but issue with weekend or other holidays
     o3d::Double avgTimeInMarket = 0.0;
@@ -269,6 +403,11 @@ public:
     void reset();
     void add(const Statistics &stats);
 
+    /**
+     * @brief computeStats Compute the final statistics.
+     * If detailed the trades of the markets are replayed in the order of their exit, else the merged
+     * online results are used.
+     */
     void computeStats(const AccountStatistics& accountStats);
 };
 
@@ -21,6 +21,12 @@
 #include "siis/statistics/statistics.h"
 #include "siis/trade/trade.h"
 #include "siis/tradingsession.h"
+#include "siis/display/asynclogger.h"
+#include "siis/utils/timeframecascade.h"
+
+namespace Json {
+class Value;
+}
 
 namespace siis {
 
@@ -29,6 +35,10 @@ class Connector;
 class Database;
 class OrderSignal;
 class PositionSignal;
+class Analyser;
+class SnapshotWriter;
+class SnapshotReader;
+class TraceStream;
 
 /**
  * @brief Strategy base class from which to inherit.
@@ -56,6 +66,7 @@ public:
 
     const o3d::String& identifier() const { return m_identifier; }
     const o3d::String& brokerId() const { return m_brokerId; }
+    const o3d::String& accountId() const { return m_accountId; }
 
     /**
      * @brief property Get a strategy global property (not the parameters).
@@ -90,6 +101,17 @@ public:
      */
     void setMarket(Market *market);
 
+    /**
+     * @brief setParameterOverrides Dot formatted parameters applied after the learning overrides (optimize mode).
+     * @note Must be defined before init.
+     */
+    void setParameterOverrides(const Json::Value &overrides);
+
+    /**
+     * @brief parameterOverrides Null if none.
+     */
+    const Json::Value* parameterOverrides() const { return m_parameterOverrides; }
+
     /**
      * @brief setBaseQuantity Set per trade base quantity.
      */
@@ -143,6 +165,12 @@ public:
      */
     virtual void onTickUpdate(o3d::Double timestamp, const TickArray &ticks) = 0;
 
+    /**
+     * @brief feedTicks Update the base bars of the cascade from the new input ticks, then onTickUpdate.
+     * The timeframe bar analysers attached to the cascade derive their bars from them.
+     */
+    void feedTicks(o3d::Double timestamp, const TickArray &ticks);
+
     /**
      * @brief onTicksUpdate Update from the market data at each new Ohlc data.
      * @param timestamp Current timestamp.
@@ -220,6 +248,52 @@ public:
     void log(const o3d::String &unit, const o3d::String &channel, const o3d::String &msg,
              o3d::System::MessageLevel type = o3d::System::MSG_INFO);
 
+    /**
+     * @brief logf Log a message using a format registered on the asynchronous logger.
+     * Only the format identifier and the raw arguments are recorded, formatting is deferred.
+     * @param formatId Identifier returned by logger()->registerFormat().
+     * @param unit Bar model (timeframe or non-temporal bar) related to the message or en empty string.
+     */
+    template<typename ...Args>
+    inline void logf(o3d::UInt16 formatId, const char *unit, const Args&... args)
+    {
+        if (m_logger) {
+            m_logger->log(formatId, m_market->marketId(), unit, args...);
+        }
+    }
+
+    //! Same with the unit given as a string, copied into the record without allocation.
+    template<typename ...Args>
+    inline void logf(o3d::UInt16 formatId, const o3d::String &unit, const Args&... args)
+    {
+        if (m_logger) {
+            m_logger->log(formatId, m_market->marketId(), unit, args...);
+        }
+    }
+
+    /**
+     * @brief logTradeEntry Log an opened trade (trade-entry channel) with a deferred formatting.
+     */
+    void logTradeEntry(const o3d::String &unit, const Trade *trade, o3d::Int32 direction, o3d::Double price,
+                       o3d::Double stopLossPrice, o3d::Double takeProfitPrice, o3d::Double quantity);
+
+    /**
+     * @brief logOrderExit Log the exit order of a trade (order-exit channel) with a deferred formatting.
+     */
+    void logOrderExit(const o3d::String &unit, const Trade *trade);
+
+    /**
+     * @brief logOhlcFetch Log the result of the initial OHLC fetch of an analyser (init channel).
+     * @param count Number of retrieved OHLCs, 0 if none.
+     * @param lastTimestamp Timestamp of the most recent OHLC if count > 0.
+     */
+    void logOhlcFetch(const o3d::String &unit, o3d::Int32 count, o3d::Int32 depth, o3d::Double lastTimestamp);
+
+    /**
+     * @brief logger Asynchronous logger of the handler (could be null).
+     */
+    AsyncLogger* logger() { return m_logger; }
+
     //
     // accessors
     //
@@ -252,6 +326,13 @@ public:
     o3d::Bool needUpdate() const { return m_needUpdate; }
     o3d::Double baseTimeframe() const { return m_baseTimeframe; }
 
+    /**
+     * @brief cascade Bars of the lowest timeframe of the analysers, built once from the ticks when the base
+     * timeframe is the tick.
+     */
+    TimeframeCascade& cascade() { return m_cascade; }
+    const TimeframeCascade& cascade() const { return m_cascade; }
+
     /**
      * @brief tradeType Strategy trade type to instanciate.
      */
@@ -267,6 +348,11 @@ public:
      */
     const Statistics& statistics() const { return m_stats; }
 
+    /**
+     * @brief setDetailedStatistics Retain the results of each trade, else only the online statistics.
+     */
+    void setDetailedStatistics(o3d::Bool detailed) { m_stats.detailed = detailed; }
+
     /**
      * @brief updateStats Update max drawn down and some others stuffs.
      */
@@ -277,6 +363,74 @@ public:
      */
     void addClosedTrade(Trade *trade);
 
+    //
+    // trace
+    //
+
+    /**
+     * @brief setTrace Record the events of the strategy into this stream, or null to disable it.
+     */
+    void setTrace(TraceStream *trace) { m_trace = trace; }
+
+    /**
+     * @brief trace Stream of the recorded events, null if not traced.
+     */
+    TraceStream* trace() { return m_trace; }
+
+    /**
+     * @brief traceEntrySignal Record an entry signal, before opening its trade.
+     */
+    void traceEntrySignal(o3d::Double timestamp, o3d::Int32 direction,
+                          o3d::Double price, o3d::Double takeProfitPrice, o3d::Double stopLossPrice);
+
+    /**
+     * @brief traceExitSignal Record an exit signal of a trade, before closing it.
+     */
+    void traceExitSignal(o3d::Double timestamp, Trade *trade, o3d::Double price);
+
+    //
+    // snapshot
+    //
+
+    /**
+     * @brief saveSnapshot Write the state of the strategy and of its analysers into a versioned binary file,
+     * in order to skip the warm-up at the next start.
+     * @note The trades are not part of the snapshot, live retrieves them from the trade store and the broker.
+     */
+    o3d::Bool saveSnapshot(const o3d::String &filename) const;
+
+    /**
+     * @brief loadSnapshot Restore a state written by saveSnapshot, in place of prepareMarketData.
+     * @param fromTs Timestamp the strategy starts from. The snapshot must not be more recent.
+     * @param maxGap Maximal delay in seconds between the snapshot and fromTs, or 0 for no limit.
+     * @return False if the file is missing, invalid, outdated or does not match the strategy configuration.
+     * In that case nothing is restored and the market data must be prepared as usual.
+     */
+    o3d::Bool loadSnapshot(const o3d::String &filename, o3d::Double fromTs, o3d::Double maxGap);
+
+    /**
+     * @brief writeSnapshot Write the state of the strategy into a snapshot in memory.
+     */
+    void writeSnapshot(SnapshotWriter &writer) const;
+
+    /**
+     * @brief readSnapshot Restore a state written by writeSnapshot, in place of prepareMarketData.
+     * @param origin Name of the snapshot for the logs.
+     * @see loadSnapshot
+     */
+    o3d::Bool readSnapshot(SnapshotReader &reader, o3d::Double fromTs, o3d::Double maxGap, const o3d::String &origin);
+
+    /**
+     * @brief saveState Write the specific state of the strategy into a snapshot. Default writes nothing.
+     */
+    virtual void saveState(SnapshotWriter &writer) const;
+
+    /**
+     * @brief loadState Restore the specific state written by saveState.
+     * Default returns false, the strategy not supporting the snapshots, then its market data are prepared.
+     */
+    virtual o3d::Bool loadState(SnapshotReader &reader);
+
     //
     // trading sessions
     //
@@ -342,6 +496,23 @@ protected:
                               o3d::Double &fromTs, o3d::Double &toTs,
                               o3d::Int32 &nLast) const;
 
+    /**
+     * @brief prepareOhlcAnalysers Fetch the initial OHLC of the analysers, every timeframes in a single query,
+     * then update each analyser in order.
+     */
+    void prepareOhlcAnalysers(const std::vector<Analyser*> &analysers, Ohlc::Type ohlcType,
+                              o3d::Double fromTs, o3d::Double toTs);
+
+    /**
+     * @brief saveAnalysersState Write the layout of the analysers followed by the state of each of them.
+     */
+    void saveAnalysersState(SnapshotWriter &writer, const std::vector<Analyser*> &analysers) const;
+
+    /**
+     * @brief loadAnalysersState Validate the layout of the analysers before restoring any of them.
+     */
+    o3d::Bool loadAnalysersState(SnapshotReader &reader, const std::vector<Analyser*> &analysers);
+
     //
     // state
     //
@@ -370,9 +541,11 @@ protected:
 private:
 
     Handler *m_handler;
+    AsyncLogger *m_logger;
 
     o3d::String m_identifier;
     o3d::String m_brokerId;
+    o3d::String m_accountId;
 
     o3d::FastMutex m_mutex;
 
@@ -380,6 +553,7 @@ private:
     State m_nextState;
 
     Statistics m_stats;
+    TraceStream *m_trace;   //!< null if not traced
 
     o3d::StringMap<o3d::String> m_properties;
     std::list<DataSource> m_dataSources;
@@ -398,6 +572,8 @@ private:
 
     o3d::Double m_baseTimeframe;
 
+    TimeframeCascade m_cascade;     //!< tick source bars shared by the timeframe bar analysers
+
     Trade::Type m_tradeType;
 
     o3d::Double m_baseQuantity;
@@ -408,6 +584,14 @@ private:
 
     //! allowed trading session (empty mean anytime) else must be explicit. each session is a TradingSession model.
     std::vector<TradingSession> m_tradingSessions;
+
+    o3d::UInt16 m_dailyReportFmt;   //!< daily-report log format
+    o3d::UInt16 m_tradeEntryFmt;    //!< trade-entry log format
+    o3d::UInt16 m_orderExitFmt;     //!< order-exit log format
+    o3d::UInt16 m_ohlcFetchFmt;     //!< init log format of the retrieved OHLCs
+    o3d::UInt16 m_ohlcNotFoundFmt;  //!< init log format of no OHLCs found
+
+    Json::Value *m_parameterOverrides;
 };
 
 } // namespace siis
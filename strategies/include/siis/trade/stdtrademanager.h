@@ -17,6 +17,7 @@
 namespace siis {
 
 class Strategy;
+class TradeStore;
 
 /**
  * @brief Strategy standard implementation of the trades manager.
@@ -75,12 +76,23 @@ public:
     void saveTrades(TradeDb *tradeDb);
     void loadTrades(TradeDb *tradeDb, TraderProxy *traderProxy);
 
+    /**
+     * @brief persistTrade Enqueue the current state of a trade to the asynchronous trade store (live only).
+     */
+    void persistTrade(const Trade *trade);
+
 protected:
 
     o3d::FastMutex m_mutex;
     Strategy *m_strategy;
 
     std::list<Trade*> m_trades;
+
+    o3d::UInt16 m_tradeExitFmt;   //!< trade-exit log format
+
+    TradeStore *m_tradeStore;     //!< null if trades are not persisted
+
+    void unpersistTrade(const Trade *trade);
 };
 
 } // namespace siis
@@ -45,6 +45,11 @@ SIIS_API o3d::String orderTypeToStr(o3d::Int32 orderType);
 
 SIIS_API o3d::String orderReturnCodeToStr(o3d::Int32 returnCode);
 
+/**
+ * @brief crc32 CRC-32 (IEEE 802.3) checksum of a block of data.
+ */
+SIIS_API o3d::UInt32 crc32(const o3d::UInt8 *data, size_t size);
+
 /**
  * @brief cmpTimeframe Compare 2 timeframe.
  * @return -1 if a is lesser, 0 if equal, 1 if a is greater.
@@ -34,6 +34,23 @@ inline o3d::Int32 decimalPlace(T value)
     return -o3d::Int32(floor(log10(value)));
 }
 
+/**
+ * @brief tickLevel Price quantized to an integer number of ticks.
+ * @param invTickSize Inverse of the tick size, computed once.
+ */
+inline o3d::Int64 tickLevel(o3d::Double price, o3d::Double invTickSize)
+{
+    return static_cast<o3d::Int64>(::llround(price * invTickSize));
+}
+
+/**
+ * @brief floorDiv Integer division rounded toward negative infinity.
+ */
+inline o3d::Int64 floorDiv(o3d::Int64 a, o3d::Int64 b)
+{
+    return a / b - ((a % b != 0 && (a < 0) != (b < 0)) ? 1 : 0);
+}
+
 } // namespace siis
 
 #endif // SIIS_MATH_H
@@ -0,0 +1,119 @@
+/**
+ * @brief SiiS price intervals index.
+ * @copyright Copyright (C) 2024 SiiS
+ * @author Frederic SCHERMA (frederic.scherma@gmail.com)
+ * @date 2024-10-18
+ */
+
+#ifndef SIIS_PRICEINTERVALS_H
+#define SIIS_PRICEINTERVALS_H
+
+#include "../base.h"
+
+#include <list>
+#include <map>
+#include <vector>
+
+namespace siis {
+
+/**
+ * @brief Set of price intervals (imbalances, zones...) with a query of the intervals overlapping a price range.
+ * @author Frederic Scherma
+ * @date 2024-10-18
+ * T must have the lowPrice and highPrice members, with lowPrice lower than highPrice.
+ * The intervals are kept in their order of insertion, and indexed by their low price. The max height of the
+ * intervals bounds the low prices of the overlapping ones, then a query only visits the intervals starting
+ * in [low - max height, high[, and the others are never touched nor copied.
+ * @note The max height is an upper bound, it is not reduced when the highest interval is removed or reduced.
+ */
+template <class T>
+class SIIS_API_TEMPLATE PriceIntervals
+{
+public:
+
+    typedef std::list<T> T_List;
+    typedef typename T_List::iterator IT_List;
+    typedef typename T_List::const_iterator CIT_List;
+
+    PriceIntervals() :
+        m_maxHeight(0.0)
+    {
+    }
+
+    //! Intervals ordered from older to most recent.
+    const T_List& items() const { return m_items; }
+
+    size_t size() const { return m_items.size(); }
+    o3d::Bool empty() const { return m_items.empty(); }
+
+    void clear()
+    {
+        m_items.clear();
+        m_index.clear();
+        m_maxHeight = 0.0;
+    }
+
+    void add(const T &item)
+    {
+        m_items.push_back(item);
+
+        IT_List it = m_items.end();
+        --it;
+
+        m_index.insert(std::make_pair(item.lowPrice, it));
+        m_maxHeight = o3d::max(m_maxHeight, item.highPrice - item.lowPrice);
+    }
+
+    /**
+     * @brief update Call func for each interval overlapping ]low, high[, in the order of their low price.
+     * @param func Functor taking a T& and returning false to remove the interval. It can modify its prices.
+     * @return Number of visited intervals.
+     */
+    template <class F>
+    size_t update(o3d::Double low, o3d::Double high, F func)
+    {
+        m_hits.clear();
+
+        auto end = m_index.lower_bound(high);
+        for (auto it = m_index.upper_bound(low - m_maxHeight); it != end; ++it) {
+            if (it->second->highPrice > low) {
+                m_hits.push_back(it);
+            }
+        }
+
+        // modified after the lookup, a reindexed interval must not be visited twice
+        for (IT_Index hit : m_hits) {
+            IT_List item = hit->second;
+            const o3d::Double lowPrice = item->lowPrice;
+
+            if (!func(*item)) {
+                m_index.erase(hit);
+                m_items.erase(item);
+            } else if (item->lowPrice != lowPrice) {
+                m_index.erase(hit);
+                m_index.insert(std::make_pair(item->lowPrice, item));
+                m_maxHeight = o3d::max(m_maxHeight, item->highPrice - item->lowPrice);
+            } else {
+                m_maxHeight = o3d::max(m_maxHeight, item->highPrice - item->lowPrice);
+            }
+        }
+
+        return m_hits.size();
+    }
+
+private:
+
+    typedef std::multimap<o3d::Double, IT_List> T_Index;
+    typedef typename T_Index::iterator IT_Index;
+
+    T_List m_items;
+    T_Index m_index;           //!< low price to item
+
+    o3d::Double m_maxHeight;
+
+    std::vector<IT_Index> m_hits;   //!< reused by update
+};
+
+} // namespace siis
+
+#endif // SIIS_PRICEINTERVALS_H
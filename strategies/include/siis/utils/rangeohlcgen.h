@@ -11,12 +11,15 @@
 #include "../ohlc.h"
 #include "../tick.h"
 #include "../utils/common.h"
+#include "tickprice.h"
 
 #include <o3d/core/base.h>
 
 namespace siis {
 
 class Analyser;
+class SnapshotWriter;
+class SnapshotReader;
 
 /**
  * @brief Generator OHLC for a specific size and scale of range-bar
@@ -24,6 +27,9 @@ class Analyser;
  * @date 2024-04-12
  * The current, non consolidated OHLC is kept as the last ohlc of the out array.
  * It can generate from a tick series or from a lower timeframe (multiple of).
+ * Each price is quantized once to an integer number of (scaled) ticks, and the size of the bar is compared in
+ * this integer space.
+ * The loop over the ticks is specialized at compile time per price type, and selected once at construction.
  */
 class SIIS_API RangeOhlcGen
 {
@@ -65,6 +71,16 @@ public:
      */
     const Ohlc* current() const { return m_curOhlc; }
 
+    /**
+     * @brief saveState Write the state of the generator. The bars are written by the owner of the out array.
+     */
+    void saveState(SnapshotWriter &writer) const;
+
+    /**
+     * @brief loadState Restore the state of the generator, once the bars of out are restored.
+     */
+    o3d::Bool loadState(SnapshotReader &reader, OhlcCircular &out);
+
     /**
      * @brief updateFromTick Update from one more tick and last ohlc from out.
      * @return True if a new ohlc is append to out.
@@ -77,6 +93,11 @@ public:
 
 private:
 
+    typedef o3d::UInt32 (RangeOhlcGen::*GenTicksMethod)(const TickArray&, OhlcCircular&, Analyser*);
+
+    GenTicksMethod m_genTicks;           //!< loop over the ticks of the ohlc type
+    GenTicksMethod m_genTicksAnalyser;   //!< same calling updateTick
+
     o3d::Int32 m_barSize;
     o3d::Double m_tickScale;
 
@@ -86,14 +107,21 @@ private:
     o3d::UInt32 m_numLastConsumed;
 
     o3d::Double m_tickSize;        //!< Instrument tick size
+    o3d::Double m_invTickSize;     //!< Inverse of the tick size
     o3d::Int32 m_pricePrecision;   //!< Instrument price precision
 
     Ohlc *m_curOhlc;
 
-    /**
-     * @brief adjustPrice Adjust the price according to the precision.
-     */
-    o3d::Double adjustPrice(o3d::Double price) const;
+    // high and low of the current bar in ticks
+    o3d::Int64 m_highLevel;
+    o3d::Int64 m_lowLevel;
+
+    template <class P, o3d::Bool A>
+    o3d::UInt32 genTicks(const TickArray &ticks, OhlcCircular &out, Analyser *analyser);
+
+    void selectGenTicks();
+
+    o3d::Bool updateFromPrice(const Tick *tick, o3d::Double price, OhlcCircular &out);
 };
 
 } // namespace siis
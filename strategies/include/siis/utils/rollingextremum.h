@@ -0,0 +1,128 @@
+/**
+ * @brief SiiS streaming rolling minimum or maximum.
+ * @copyright Copyright (C) 2024 SiiS
+ * @author Frederic SCHERMA (frederic.scherma@gmail.com)
+ * @date 2024-10-18
+ */
+
+#ifndef SIIS_ROLLINGEXTREMUM_H
+#define SIIS_ROLLINGEXTREMUM_H
+
+#include "../base.h"
+#include "../dataarray.h"
+
+#include <vector>
+
+namespace siis {
+
+class SnapshotWriter;
+class SnapshotReader;
+
+/**
+ * @brief Streaming rolling minimum or maximum over a window of len values.
+ * @author Frederic Scherma
+ * @date 2024-10-18
+ * A monotonic deque retains only the values that could still be the extremum of a next window, then each
+ * new value costs an amortized O(1), in place of a rescan of the window.
+ * The price arrays given to the indicators are a window over the circular bar store, shifted when new bars
+ * are appended, and else only their last value (the forming bar) is updated. Compute compares the array
+ * with the previous one to continue from the previous results whenever possible.
+ */
+class SIIS_API RollingExtremum
+{
+public:
+
+    enum Mode
+    {
+        MODE_MIN = 0,
+        MODE_MAX = 1
+    };
+
+    //! Max number of new bars between two calls to compute for an incremental update.
+    static const o3d::Int32 MAX_SHIFT = 8;
+
+    RollingExtremum(Mode mode, o3d::Int32 len = 14);
+
+    //! Change the window length and reset.
+    void setLen(o3d::Int32 len);
+
+    void reset();
+
+    /**
+     * @brief saveState Write the streaming state, to continue from it after a restart. The results of the
+     * price array are not written, the next compute being a full one.
+     */
+    void saveState(SnapshotWriter &writer) const;
+
+    //! Restore a state written by saveState, false if the mode or the length differ.
+    o3d::Bool loadState(SnapshotReader &reader);
+
+    Mode mode() const { return m_mode; }
+    o3d::Int32 len() const { return m_len; }
+
+    //
+    // streaming
+    //
+
+    /**
+     * @brief push Append a closed value. Amortized O(1).
+     */
+    void push(o3d::Double value);
+
+    /**
+     * @brief provisional Extremum of the window of the last len-1 closed values and of the value of the forming
+     * bar. O(1).
+     */
+    o3d::Double provisional(o3d::Double forming) const
+    {
+        if (m_size == 0) {
+            return forming;
+        }
+
+        const o3d::Double front = m_items[m_head].value;
+        return m_mode == MODE_MAX ? (front >= forming ? front : forming) : (front <= forming ? front : forming);
+    }
+
+    //
+    // price array
+    //
+
+    /**
+     * @brief compute Rolling extremum of each window of len values of a price array, at the indices from len-1
+     * (as TA_MAX and TA_MIN). O(1) if only the last value changed since the previous call, O(new bars) plus
+     * a move of the results if the array is shifted by at most MAX_SHIFT new bars, else O(size).
+     * @return The first index recomputed.
+     */
+    o3d::Int32 compute(const DataArray &in);
+
+    /**
+     * @brief values Results of the last compute, the values before the index len-1 are undefined.
+     */
+    const DataArray& values() const { return m_values; }
+
+    o3d::Double last() const { return m_values.last(); }
+
+private:
+
+    struct Item
+    {
+        o3d::Int32 pos;      //!< in the stream of the closed values
+        o3d::Double value;
+    };
+
+    Mode m_mode;
+    o3d::Int32 m_len;
+
+    std::vector<Item> m_items;  //!< ring buffer of the deque, capacity of len
+    size_t m_head;
+    size_t m_size;
+
+    o3d::Int32 m_count;         //!< number of pushed closed values
+
+    DataArray m_prev;           //!< input of the previous compute
+    DataArray m_values;
+};
+
+} // namespace siis
+
+#endif // SIIS_ROLLINGEXTREMUM_H
@@ -0,0 +1,116 @@
+/**
+ * @brief SiiS strategy binary snapshot of states.
+ * @copyright Copyright (C) 2024 SiiS
+ * @author Frederic SCHERMA (frederic.scherma@gmail.com)
+ * @date 2024-10-12
+ */
+
+#ifndef SIIS_SNAPSHOT_H
+#define SIIS_SNAPSHOT_H
+
+#include "../base.h"
+#include "../datacircular.h"
+
+#include <o3d/core/string.h>
+
+#include <vector>
+
+namespace siis {
+
+/**
+ * @brief Binary snapshot writer, in memory until saved.
+ * @author Frederic Scherma
+ * @date 2024-10-12
+ * File layout : magic "SIISSNAP", format version, payload size, CRC32 of the payload, then the payload.
+ * Values are written in the native byte order (snapshots are not portable between architectures).
+ */
+class SIIS_API SnapshotWriter
+{
+public:
+
+    static const o3d::UInt32 VERSION = 2;
+
+    SnapshotWriter();
+
+    void writeBool(o3d::Bool value);
+    void writeInt32(o3d::Int32 value);
+    void writeInt64(o3d::Int64 value);
+    void writeDouble(o3d::Double value);
+    void writeDoubles(const o3d::Double *values, o3d::Int32 count);
+    void writeString(const o3d::String &value);
+
+    //! Size and values of an array.
+    void writeArray(const DataArray &array);
+
+    //! Size and values of a circular array, from the oldest to the most recent.
+    void writeCircular(const DataCircular &circular);
+
+    o3d::Int32 size() const { return static_cast<o3d::Int32>(m_data.size()); }
+
+    const std::vector<o3d::UInt8>& data() const { return m_data; }
+
+    /**
+     * @brief save Write the header and the payload into a temporary file then rename it.
+     */
+    o3d::Bool save(const o3d::String &filename) const;
+
+private:
+
+    std::vector<o3d::UInt8> m_data;
+
+    void write(const void *data, size_t size);
+};
+
+/**
+ * @brief Binary snapshot reader, validated on load.
+ * @author Frederic Scherma
+ * @date 2024-10-12
+ * Any read after the end of the payload set the failed state and return zero values.
+ */
+class SIIS_API SnapshotReader
+{
+public:
+
+    SnapshotReader();
+
+    /**
+     * @brief load Read the file and validate the magic, the version, the size and the checksum.
+     */
+    o3d::Bool load(const o3d::String &filename);
+
+    /**
+     * @brief load Read the payload of a writer, without file (copy of a state in memory).
+     */
+    void load(const SnapshotWriter &writer);
+
+    o3d::Bool readBool();
+    o3d::Int32 readInt32();
+    o3d::Int64 readInt64();
+    o3d::Double readDouble();
+    o3d::Bool readDoubles(o3d::Double *values, o3d::Int32 count);
+    o3d::String readString();
+
+    //! Resize the array to the read size.
+    o3d::Bool readArray(DataArray &array);
+
+    //! Replace the content of a circular array, keeping its capacity, that must be enough.
+    o3d::Bool readCircular(DataCircular &circular);
+
+    o3d::Bool failed() const { return m_failed; }
+    o3d::Bool atEnd() const { return m_pos >= m_data.size(); }
+
+    //! Number of bytes not read, to validate a size before allocating.
+    size_t remaining() const { return m_pos < m_data.size() ? m_data.size() - m_pos : 0; }
+
+private:
+
+    std::vector<o3d::UInt8> m_data;
+    size_t m_pos;
+    o3d::Bool m_failed;
+
+    o3d::Bool read(void *data, size_t size);
+};
+
+} // namespace siis
+
+#endif // SIIS_SNAPSHOT_H
@@ -0,0 +1,43 @@
+/**
+ * @brief SiiS tick price extraction policies.
+ * @copyright Copyright (C) 2024 SiiS
+ * @author Frederic SCHERMA (frederic.scherma@gmail.com)
+ * @date 2024-10-18
+ */
+
+#ifndef SIIS_TICKPRICE_H
+#define SIIS_TICKPRICE_H
+
+#include "../tick.h"
+
+namespace siis {
+
+/**
+ * @brief Price of a tick for each type of ohlc, as template parameter of the bar generators.
+ * @author Frederic Scherma
+ * @date 2024-10-18
+ * The type of ohlc is then resolved at compile time and the update of a bar inlined into the loop over the ticks.
+ */
+struct TickPriceLast
+{
+    static inline o3d::Double price(const Tick *tick) { return tick->last(); }
+};
+
+struct TickPriceMid
+{
+    static inline o3d::Double price(const Tick *tick) { return tick->price(); }
+};
+
+struct TickPriceBid
+{
+    static inline o3d::Double price(const Tick *tick) { return tick->bid(); }
+};
+
+struct TickPriceAsk
+{
+    static inline o3d::Double price(const Tick *tick) { return tick->ask(); }
+};
+
+} // namespace siis
+
+#endif // SIIS_TICKPRICE_H
@@ -0,0 +1,98 @@
+/**
+ * @brief SiiS strategy multi-timeframe bar cascade.
+ * @copyright Copyright (C) 2024 SiiS
+ * @author Frederic SCHERMA (frederic.scherma@gmail.com)
+ * @date 2024-10-18
+ */
+
+#ifndef SIIS_TIMEFRAMECASCADE_H
+#define SIIS_TIMEFRAMECASCADE_H
+
+#include "timeframeohlcgen.h"
+
+#include <vector>
+
+namespace siis {
+
+class TimeframeBarAnalyser;
+
+/**
+ * @brief Bars of the lowest timeframe of the analysers of a strategy, built once from the ticks.
+ * @author Frederic Scherma
+ * @date 2024-10-18
+ * Each attached analyser derives its bars from the base bars updated by the last ticks, the finished ones plus the
+ * current one, in place of a pass over the ticks per analyser. The ticks are still forwarded to the per tick
+ * processing of the analysers (updateTick), with the finalize state of their own timeframe.
+ * Analysers having a timeframe that is not a multiple of the base timeframe are not attached, and keep generating
+ * their bars from the ticks.
+ * Each strategy owns one, the timeframe bar analysers of a tick based strategy being added at their init.
+ */
+class SIIS_API TimeframeCascade
+{
+public:
+
+    TimeframeCascade(Ohlc::Type ohlcType=Ohlc::TYPE_MID);
+    ~TimeframeCascade();
+
+    /**
+     * @brief add Add an analyser and setup again.
+     * @note Must be done before the first update.
+     */
+    void add(TimeframeBarAnalyser *analyser);
+
+    /**
+     * @brief remove Detach and remove an analyser, then setup again with the others.
+     */
+    void remove(TimeframeBarAnalyser *analyser);
+
+    /**
+     * @brief setup Select the lowest timeframe of the analysers as base timeframe, and attach the analysers
+     * having a multiple of it.
+     */
+    void setup();
+
+    /**
+     * @brief clear Detach and remove the analysers.
+     */
+    void clear();
+
+    o3d::Double baseTimeframe() const { return m_baseTf; }
+    o3d::Int32 numAttached() const { return static_cast<o3d::Int32>(m_analysers.size()); }
+
+    /**
+     * @brief bars Base bars updated by the last ticks, the finished ones then the current one.
+     */
+    const OhlcArray& bars() const { return m_bars; }
+
+    /**
+     * @brief onTickUpdate Update the base bars, and the per tick processing of the attached analysers.
+     * Must be called before the onTickUpdate of the analysers.
+     */
+    void onTickUpdate(o3d::Double timestamp, const TickArray &ticks);
+
+private:
+
+    Ohlc::Type m_ohlcType;
+    o3d::Double m_baseTf;
+
+    TimeframeOhlcGen m_ohlcGen;
+    OhlcCircular m_ohlc;     //!< only the current and the previous base bars
+    OhlcArray m_bars;
+
+    std::vector<TimeframeBarAnalyser*> m_added;
+    std::vector<TimeframeBarAnalyser*> m_analysers;
+    std::vector<o3d::Double> m_barTimestamps;   //!< timestamp of the current bar of each attached analyser
+
+    typedef void (TimeframeCascade::*UpdateTicksMethod)(const TickArray&);
+
+    UpdateTicksMethod m_updateTicks;   //!< loop over the ticks of the ohlc type
+
+    void detach();
+
+    template <class P>
+    void updateTicks(const TickArray &ticks);
+};
+
+} // namespace siis
+
+#endif // SIIS_TIMEFRAMECASCADE_H
@@ -11,12 +11,15 @@
 #include "../ohlc.h"
 #include "../tick.h"
 #include "../utils/common.h"
+#include "tickprice.h"
 
 #include <o3d/core/base.h>
 
 namespace siis {
 
 class Analyser;
+class SnapshotWriter;
+class SnapshotReader;
 
 /**
  * @brief Generator OHLC for a specific fixed timeframe.
@@ -24,6 +27,11 @@ class Analyser;
  * @date 2019-03-07
  * The current, non consolidated OHLC is kept as the last ohlc of the out array.
  * It can generate from a tick series or from a lower timeframe (multiple of).
+ * From a lower timeframe the source bars are the finished ones, each merged once, plus the current non
+ * consolidated one, which can be given again at each update, the current bar being the merge of the finished
+ * source bars of its period and of the last given non consolidated one.
+ * The update per tick is specialized at compile time per price type, the loop over the ticks being selected
+ * once at construction.
  */
 class SIIS_API TimeframeOhlcGen
 {
@@ -77,7 +85,25 @@ public:
     const Ohlc* current() const { return m_curOhlc; }
 
     /**
-     * @brief updateFromTick Update from one more tick and last ohlc from out.
+     * @brief saveState Write the state of the generator. The bars are written by the owner of the out array.
+     */
+    void saveState(SnapshotWriter &writer) const;
+
+    /**
+     * @brief loadState Restore the state of the generator, once the bars of out are restored.
+     */
+    o3d::Bool loadState(SnapshotReader &reader, OhlcCircular &out);
+
+    /**
+     * @brief updateFromTick Update from one more tick and last ohlc from out, at the price given by the policy P
+     * (one of TickPriceLast, TickPriceMid, TickPriceBid, TickPriceAsk).
+     * @return True if a new ohlc is append to out.
+     */
+    template <class P>
+    o3d::Bool updateFromTick(const Tick *tick, OhlcCircular &out);
+
+    /**
+     * @brief updateFromTickMid Update from one more tick and last ohlc from out.
      * @return True if a new ohlc is append to out.
      */
     o3d::Bool updateFromTickMid(const Tick *tick, OhlcCircular &out);
@@ -98,6 +124,18 @@ public:
 
 private:
 
+    typedef o3d::UInt32 (TimeframeOhlcGen::*GenTicksMethod)(const TickArray&, OhlcCircular&, Analyser*);
+
+    GenTicksMethod m_genTicks;           //!< loop over the ticks of the ohlc type
+    GenTicksMethod m_genTicksAnalyser;   //!< same calling updateTick
+
+    template <class P, o3d::Bool A>
+    o3d::UInt32 genTicks(const TickArray &ticks, OhlcCircular &out, Analyser *analyser);
+
+    void selectGenTicks();
+
+    o3d::Bool updateFromOhlc(const Ohlc *ohlc, OhlcCircular &out);
+
     o3d::Double m_fromTf;
     o3d::Double m_toTf;
     Ohlc::Type m_ohlcType;
@@ -106,6 +144,13 @@ private:
     o3d::UInt32 m_numLastConsumed;
 
     Ohlc *m_curOhlc;
+
+    // merge of the finished source bars of the current bar
+    o3d::Bool m_hasMerged;
+    o3d::Double m_mergedOpen;
+    o3d::Double m_mergedHigh;
+    o3d::Double m_mergedLow;
+    o3d::Double m_mergedVolume;
 };
 
 } // namespace siis
@@ -0,0 +1,182 @@
+/**
+ * @brief SiiS strategy event trace of a backtest and its reproducibility checker.
+ * @copyright Copyright (C) 2024 SiiS
+ * @author Frederic SCHERMA (frederic.scherma@gmail.com)
+ * @date 2024-10-18
+ */
+
+#ifndef SIIS_TRACE_H
+#define SIIS_TRACE_H
+
+#include "../base.h"
+
+#include <o3d/core/string.h>
+#include <o3d/core/mutex.h>
+
+#include <cstdio>
+#include <vector>
+
+namespace siis {
+
+class Trace;
+
+/**
+ * @brief Sequence of the events of a strategy, on its market.
+ * @author Frederic Scherma
+ * @date 2024-10-18
+ * The events are buffered then written per block into the file of the trace. Thread-safe, because the
+ * fills could be notified by the connector while the strategy is processed by a worker.
+ */
+class SIIS_API TraceStream
+{
+public:
+
+    enum EventType
+    {
+        EVENT_STEP = 1,          //!< value : number of ticks, a : number of ohlc
+        EVENT_ENTRY_SIGNAL = 2,  //!< value : direction, a : price, b : take-profit, c : stop-loss
+        EVENT_EXIT_SIGNAL = 3,   //!< value : trade id, a : price
+        EVENT_ORDER = 4,         //!< value : direction, a : quantity, b : price, c : order type
+        EVENT_FILL = 5,          //!< value : direction, a : price, b : filled, c : cumulative filled
+        EVENT_TRADE_EXIT = 6     //!< value : direction, a : entry price, b : exit price, c : profit/loss rate
+    };
+
+    struct Event
+    {
+        o3d::UInt8 type = 0;
+        o3d::Int32 value = 0;
+        o3d::Double timestamp = 0.0;
+        o3d::Double a = 0.0;
+        o3d::Double b = 0.0;
+        o3d::Double c = 0.0;
+    };
+
+    static const size_t BLOCK_SIZE = 4096;
+
+    ~TraceStream();
+
+    o3d::UInt32 index() const { return m_index; }
+    const o3d::CString& marketId() const { return m_marketId; }
+
+    //! Ticks and ohlc injected for a step, define the timestamp of the next orders.
+    void step(o3d::Double timestamp, o3d::Int32 numTicks, o3d::Int32 numOhlcs);
+
+    void entrySignal(o3d::Double timestamp, o3d::Int32 direction,
+                     o3d::Double price, o3d::Double takeProfitPrice, o3d::Double stopLossPrice);
+
+    void exitSignal(o3d::Double timestamp, o3d::Int32 tradeId, o3d::Double price);
+
+    //! Order created at the timestamp of the current step.
+    void order(o3d::Int32 direction, o3d::Int32 orderType, o3d::Double quantity, o3d::Double price);
+
+    void fill(o3d::Double timestamp, o3d::Int32 direction,
+              o3d::Double price, o3d::Double filled, o3d::Double cumulativeFilled);
+
+    void tradeExit(o3d::Double timestamp, o3d::Int32 direction,
+                   o3d::Double entryPrice, o3d::Double exitPrice, o3d::Double profitLossRate);
+
+    //! Write the buffered events.
+    void flush();
+
+private:
+
+    friend class Trace;
+
+    TraceStream(Trace *trace, o3d::UInt32 index, const o3d::CString &marketId);
+
+    void add(o3d::UInt8 type, o3d::Int32 value, o3d::Double timestamp,
+             o3d::Double a, o3d::Double b = 0.0, o3d::Double c = 0.0);
+
+    Trace *m_trace;
+
+    o3d::UInt32 m_index;
+    o3d::CString m_marketId;
+
+    o3d::FastMutex m_mutex;
+    std::vector<Event> m_events;
+
+    o3d::Double m_timestamp;   //!< of the last step
+};
+
+/**
+ * @brief Compact binary trace of the events of the strategies of a backtest.
+ * @author Frederic Scherma
+ * @date 2024-10-18
+ * Two runs of the same backtest must produce the same trace, then comparing the trace of a modified
+ * version with a reference trace verifies the results are unchanged, and locates the first divergence.
+ * The blocks of the streams are interleaved in the order of the writes, then only the order of the events
+ * of a stream is meaningful. Values are written in the little endian byte order. File layout :
+ *  - header : magic "SIISTRCE", uint32 version
+ *  - stream block : uint8 1, uint32 index, int32 size then the UTF-8 bytes of the market identifier
+ *  - events block : uint8 2, uint32 index, uint32 count, then per event uint8 type, int32 value,
+ *    double timestamp, double a, double b, double c
+ * A truncated block ends the reading.
+ */
+class SIIS_API Trace
+{
+public:
+
+    static const o3d::UInt32 VERSION = 1;
+
+    /**
+     * @brief First divergence of two traces.
+     */
+    struct Divergence
+    {
+        o3d::Bool diverged = false;
+        o3d::CString marketId;
+        o3d::Int32 index = -1;         //!< of the event into the stream
+        o3d::Double timestamp = 0.0;
+        o3d::String description;
+    };
+
+    Trace();
+    ~Trace();
+
+    /**
+     * @brief create Create or truncate the file and write its header.
+     */
+    o3d::Bool create(const o3d::String &filename);
+
+    /**
+     * @brief addStream Add the stream of the events of a market. Must be called before any event.
+     * @return The stream, owned by the trace.
+     */
+    TraceStream* addStream(const o3d::CString &marketId);
+
+    //! Flush the streams then close the file.
+    void close();
+
+    o3d::Bool isOpen() const { return m_file != nullptr; }
+    const o3d::String& filename() const { return m_filename; }
+
+    /**
+     * @brief compare Compare the events of the streams of two traces.
+     * @param epsilon Relative tolerance on the values, 0 for a bitwise comparison.
+     * @param divergence The earliest divergence in time over the streams, if any.
+     * @return False if a file cannot be read.
+     */
+    static o3d::Bool compare(const o3d::String &filename,
+                             const o3d::String &reference,
+                             o3d::Double epsilon,
+                             Divergence &divergence);
+
+    static o3d::String eventTypeToStr(o3d::Int32 type);
+
+private:
+
+    friend class TraceStream;
+
+    //! Thread-safe.
+    void write(const std::vector<o3d::UInt8> &data);
+
+    o3d::FastMutex m_mutex;
+    FILE *m_file;
+
+    o3d::String m_filename;
+    std::vector<TraceStream*> m_streams;
+};
+
+} // namespace siis
+
+#endif // SIIS_TRACE_H
@@ -7,6 +7,7 @@
 
 #include "siis/analysers/analyser.h"
 #include "siis/strategy.h"
+#include "siis/utils/snapshot.h"
 
 using namespace siis;
 
@@ -49,6 +50,66 @@ o3d::Bool Analyser::isNeedUpdate(o3d::Double timestamp) const
     return timestamp >= m_nextTimestamp;
 }
 
+void Analyser::saveState(SnapshotWriter &writer) const
+{
+    writer.writeString(m_name);
+    writer.writeDouble(m_timeframe);
+    writer.writeInt32(m_barSize);
+    writer.writeInt32(m_depth);
+
+    writer.writeDouble(m_nextTimestamp);
+}
+
+o3d::Bool Analyser::loadState(SnapshotReader &reader)
+{
+    o3d::String name = reader.readString();
+    o3d::Double timeframe = reader.readDouble();
+    o3d::Int32 barSize = reader.readInt32();
+    o3d::Int32 depth = reader.readInt32();
+
+    o3d::Double nextTimestamp = reader.readDouble();
+
+    if (reader.failed() || name != m_name || timeframe != m_timeframe || barSize != m_barSize || depth != m_depth) {
+        return false;
+    }
+
+    m_nextTimestamp = nextTimestamp;
+    m_numLastBars = 0;
+
+    return true;
+}
+
+void Analyser::saveOhlc(SnapshotWriter &writer, const OhlcCircular &ohlc)
+{
+    writer.writeInt32(ohlc.size());
+
+    for (auto cit = ohlc.cbegin(); cit != ohlc.cend(); ++cit) {
+        writer.writeDoubles((*cit)->data(), 8);
+    }
+}
+
+o3d::Bool Analyser::loadOhlc(SnapshotReader &reader, OhlcCircular &ohlc)
+{
+    o3d::Int32 n = reader.readInt32();
+    if (reader.failed() || n < 0 || n > ohlc.getSize()) {
+        return false;
+    }
+
+    ohlc.clear();
+
+    o3d::Double data[8];
+
+    for (o3d::Int32 i = 0; i < n; ++i) {
+        if (!reader.readDoubles(data, 8)) {
+            return false;
+        }
+
+        ohlc.writeElt()->copy(data);
+    }
+
+    return true;
+}
+
 void Analyser::log(const o3d::String &channel, const o3d::String &msg)
 {
     m_strategy->log(formatUnit(), channel, msg);
@@ -8,6 +8,7 @@
 #include "siis/analysers/rangebaranalyser.h"
 #include "siis/market.h"
 #include "siis/strategy.h"
+#include "siis/utils/snapshot.h"
 
 using namespace siis;
 
@@ -115,6 +116,30 @@ void RangeBarAnalyser::process(o3d::Double timestamp, o3d::Double lastTimestamp)
     resetNumLastBars();
 }
 
+void RangeBarAnalyser::saveState(SnapshotWriter &writer) const
+{
+    Analyser::saveState(writer);
+
+    saveOhlc(writer, m_ohlc);
+    m_ohlcGen.saveState(writer);
+}
+
+o3d::Bool RangeBarAnalyser::loadState(SnapshotReader &reader)
+{
+    if (!Analyser::loadState(reader)) {
+        return false;
+    }
+
+    if (!loadOhlc(reader, m_ohlc) || !m_ohlcGen.loadState(reader, m_ohlc)) {
+        return false;
+    }
+
+    // price and volume are fully recomputed from the restored bars at the next process
+    incNumLastBars(m_ohlc.size());
+
+    return true;
+}
+
 o3d::Double RangeBarAnalyser::lastPrice() const
 {
     return m_price.close().last();
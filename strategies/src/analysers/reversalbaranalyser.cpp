@@ -8,6 +8,7 @@
 #include "siis/analysers/reversalbaranalyser.h"
 #include "siis/market.h"
 #include "siis/strategy.h"
+#include "siis/utils/snapshot.h"
 
 using namespace siis;
 
@@ -100,6 +101,30 @@ void ReversalBarAnalyser::process(o3d::Double timestamp, o3d::Double lastTimesta
     resetNumLastBars();
 }
 
+void ReversalBarAnalyser::saveState(SnapshotWriter &writer) const
+{
+    Analyser::saveState(writer);
+
+    saveOhlc(writer, m_ohlc);
+    m_ohlcGen.saveState(writer);
+}
+
+o3d::Bool ReversalBarAnalyser::loadState(SnapshotReader &reader)
+{
+    if (!Analyser::loadState(reader)) {
+        return false;
+    }
+
+    if (!loadOhlc(reader, m_ohlc) || !m_ohlcGen.loadState(reader, m_ohlc)) {
+        return false;
+    }
+
+    // price and volume are fully recomputed from the restored bars at the next process
+    incNumLastBars(m_ohlc.size());
+
+    return true;
+}
+
 o3d::Double ReversalBarAnalyser::lastPrice() const
 {
     return m_price.close().last();
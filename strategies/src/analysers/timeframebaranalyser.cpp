@@ -8,6 +8,8 @@
 #include "siis/analysers/timeframebaranalyser.h"
 #include "siis/market.h"
 #include "siis/strategy.h"
+#include "siis/utils/snapshot.h"
+#include "siis/utils/timeframecascade.h"
 
 using namespace siis;
 
@@ -19,6 +21,8 @@ TimeframeBarAnalyser::TimeframeBarAnalyser(Strategy *strategy,
         o3d::Double history,
         Price::Method priceMethod) :
     Analyser(strategy, name, timeframe, 0, depth, history),
+    m_sourceTimeframe(sourceTimeframe),
+    m_cascade(nullptr),
     m_ohlcGen(sourceTimeframe, timeframe),
     m_ohlc(depth),
     m_price("price", timeframe, priceMethod),
@@ -29,7 +33,7 @@ TimeframeBarAnalyser::TimeframeBarAnalyser(Strategy *strategy,
 
 TimeframeBarAnalyser::~TimeframeBarAnalyser()
 {
-
+    strategy()->cascade().remove(this);
 }
 
 void TimeframeBarAnalyser::init(const AnalyserConfig &conf)
@@ -38,6 +42,11 @@ void TimeframeBarAnalyser::init(const AnalyserConfig &conf)
     if (conf.data().isMember("update-at-close")) {
         setUpdateAtClose(conf.data().get("update-at-close", false).asBool());
     }
+
+    // bars derived from the base bars built once from the ticks for all the analysers
+    if (strategy()->baseTimeframe() == TF_TICK) {
+        strategy()->cascade().add(this);
+    }
 }
 
 void TimeframeBarAnalyser::prepare(o3d::Double timestamp)
@@ -47,6 +56,21 @@ void TimeframeBarAnalyser::prepare(o3d::Double timestamp)
 
 void TimeframeBarAnalyser::onTickUpdate(o3d::Double timestamp, const TickArray &ticks)
 {
+    if (m_cascade) {
+        // generate the ohlc from the base bars updated by the last market update
+        o3d::Int32 n = m_ohlcGen.genFromOhlc(m_cascade->bars(), m_ohlc, *this);
+
+        // new generated bars
+        incNumLastBars(n);
+
+        // plus the current one
+        if (m_cascade->bars().getSize() > 0 && m_ohlcGen.current() != nullptr) {
+            incNumLastBars(1);
+        }
+
+        return;
+    }
+
     // generate the ohlc from the last market update
     o3d::Int32 n = m_ohlcGen.genFromTicks(ticks, m_ohlc, *this);
 
@@ -114,6 +138,30 @@ void TimeframeBarAnalyser::process(o3d::Double timestamp, o3d::Double lastTimest
     resetNumLastBars();
 }
 
+void TimeframeBarAnalyser::saveState(SnapshotWriter &writer) const
+{
+    Analyser::saveState(writer);
+
+    saveOhlc(writer, m_ohlc);
+    m_ohlcGen.saveState(writer);
+}
+
+o3d::Bool TimeframeBarAnalyser::loadState(SnapshotReader &reader)
+{
+    if (!Analyser::loadState(reader)) {
+        return false;
+    }
+
+    if (!loadOhlc(reader, m_ohlc) || !m_ohlcGen.loadState(reader, m_ohlc)) {
+        return false;
+    }
+
+    // price and volume are fully recomputed from the restored bars at the next process
+    incNumLastBars(m_ohlc.size());
+
+    return true;
+}
+
 o3d::Double TimeframeBarAnalyser::lastPrice() const
 {
     return m_price.close().last();
@@ -128,3 +176,9 @@ o3d::Double TimeframeBarAnalyser::sourceTimeframe() const
 {
     return m_ohlcGen.fromTimeframe();
 }
+
+void TimeframeBarAnalyser::attachCascade(const TimeframeCascade *cascade)
+{
+    m_cascade = cascade;
+    m_ohlcGen = TimeframeOhlcGen(cascade ? cascade->baseTimeframe() : m_sourceTimeframe, timeframe());
+}
@@ -10,7 +10,8 @@
 #include "siis/connector/localconnector.h"
 #include "siis/connector/traderproxy.h"
 
-#include "siis/database/tickstream.h"
+#include "siis/database/ohlcstream.h"
+#include "siis/database/replaybus.h"
 
 #include "siis/poolworker.h"
 
@@ -18,8 +19,10 @@
 #include "siis/market.h"
 #include "siis/collection.h"
 #include "siis/display/displayer.h"
+#include "siis/display/asynclogger.h"
 
 #include "siis/utils/common.h"
+#include "siis/utils/trace.h"
 
 #include "siis/database/database.h"
 #include "siis/database/marketdb.h"
@@ -35,6 +38,11 @@ o3d::Bool Handler::isBacktesting() const
     return false;
 }
 
+TradeStore *Handler::tradeStore()
+{
+    return nullptr;
+}
+
 Backtest::Backtest() :
     m_thread(this),
     m_running(false),
@@ -42,8 +50,11 @@ Backtest::Backtest() :
     m_toTs(0.0),
     m_curTs(0.0),
     m_timestep(0.0),
+    m_pruning(nullptr),
+    m_trace(nullptr),
     m_connector(nullptr),
-    m_traderProxy(nullptr)
+    m_traderProxy(nullptr),
+    m_logger(nullptr)
 {
 
 }
@@ -69,6 +80,15 @@ void Backtest::init(
     O3D_ASSERT(cache != nullptr);
 
     m_displayer = displayer;
+
+    // asynchronous logger (must exists before building the strategies)
+    m_logger = new AsyncLogger(this, displayer, static_cast<o3d::UInt32>(config->getLogRingSize()));
+    m_logger->setEnabled(config->isLogEnabled());
+
+    for (auto pair : config->getLogRateLimits()) {
+        m_logger->setRateLimit(pair.first, pair.second);
+    }
+
     m_database = database;
 
     m_fromTs = config->getFromTs();
@@ -101,6 +121,12 @@ void Backtest::init(
     m_poolWorker = poolWorker;
     m_cache = cache;
 
+    if (config->getPruning() && config->getPruning()->enabled()) {
+        // stop as soon as the results violate the constraints
+        m_pruning = new Pruning(*config->getPruning());
+        m_pruning->setPeriod(m_fromTs, m_toTs);
+    }
+
     o3d::DateTime fromDt;
     fromDt.fromTime(m_fromTs, true);
 
@@ -117,13 +143,52 @@ void Backtest::init(
 
         Strategy *strategy = collection->build(this, config->getStrategy(), config->getStrategyIdentifier());
         strategy->setMarket(market);
+        strategy->setDetailedStatistics(config->isDetailedStatistics());
         strategy->init(config);
 
         StrategyElt elt;
         elt.strategy = strategy;
         elt.market = market;
+        elt.replayBus = new ReplayBus(database, config->getMarketsPath().getFullPathName(),
+                                      config->getBrokerId(), mc->marketId, fromDt, toDt);
+
+        m_strategies[mc->marketId] = elt;
+    }
+
+    // restore the state of the strategies from their snapshot when it ends right before the beginning
+    std::vector<Strategy*> prepares;
+
+    for (auto &pair : m_strategies) {
+        Strategy *strategy = pair.second.strategy;
+
+        if (config->isSnapshotRestore()) {
+            o3d::String filename = config->getSnapshotFilename(strategy->identifier(), pair.first);
+            o3d::Double maxGap = o3d::max(strategy->baseTimeframe(), m_timestep);
+
+            if (strategy->loadSnapshot(filename, m_fromTs, maxGap)) {
+                continue;
+            }
+        }
+
+        prepares.push_back(strategy);
+    }
+
+    // prepare the others market data in parallel, each job using its own connection to the database
+    PoolWorker::CountDown countDown;
+    countDown.count = static_cast<o3d::Int32>(prepares.size());
+
+    for (Strategy *strategy : prepares) {
+        m_poolWorker->addPrepareJob(strategy, m_connector, m_database, m_fromTs, m_toTs, &countDown);
+    }
+
+    countDown.wait();
+
+    for (MarketConfig *mc : config->getConfiguredMarkets()) {
+        StrategyElt &elt = m_strategies[mc->marketId];
+
+        Strategy *strategy = elt.strategy;
+        Market *market = elt.market;
 
-        strategy->prepareMarketData(m_connector, m_database, m_fromTs, m_toTs);
         strategy->finalizeMarketData(m_connector, m_database);
 
         if (mc->marketTradeType > -1) {
@@ -131,25 +196,22 @@ void Backtest::init(
         }
 
         for (DataSource ds : strategy->getDataSources()) {
-            // create the stream (for now only tick stream, but could offer OHLC too, but no possibility for order-book history)
-            if (ds.type == DataSource::TICK) {
-                TickStream *ts = new TickStream(config->getMarketsPath().getFullPathName(),
-                                                config->getBrokerId(), mc->marketId, fromDt, toDt);
-
-                elt.tickStream = ts;
-
-            } else if (ds.type == DataSource::OHLC_MID) {
-                // @todo fetch and stream ...
-            } else if (ds.type == DataSource::OHLC_BID) {
-                // @todo ...
-            } else if (ds.type == DataSource::OHLC_ASK) {
-                // @todo ...
-            } else if (ds.type == DataSource::ORDER_BOOK) {
-                // not possible for now
-            }
+            // create the readers (no possibility for order-book history, only one timeframe per ohlc type)
+            elt.replayBus->subscribe(ds);
         }
+    }
 
-        m_strategies[mc->marketId] = elt;
+    if (config->getTraceFilename().isValid()) {
+        m_trace = new Trace();
+
+        if (!m_trace->create(config->getTraceFilename())) {
+            O3D_ERROR(o3d::E_InvalidPrecondition(o3d::String("Unable to create trace ") + config->getTraceFilename()));
+        }
+
+        // a stream per strategy, in the order of the markets
+        for (auto &pair : m_strategies) {
+            pair.second.strategy->setTrace(m_trace->addStream(pair.first));
+        }
     }
 }
 
@@ -167,6 +229,11 @@ void Backtest::terminate(Config *config)
     for (auto pair : m_strategies) {
         Strategy *strategy = pair.second.strategy;
 
+        if (config->isSnapshotSave()) {
+            // checkpoint for a next run starting at the end of this one
+            strategy->saveSnapshot(config->getSnapshotFilename(strategy->identifier(), pair.first));
+        }
+
         strategy->terminate(m_connector, m_database);
 
         // compute final statistics
@@ -174,19 +241,34 @@ void Backtest::terminate(Config *config)
 
         o3d::deletePtr(pair.second.strategy);
         o3d::deletePtr(pair.second.market);
-        o3d::deletePtr(pair.second.tickStream);
+        o3d::deletePtr(pair.second.replayBus);
     }
 
     m_strategies.clear();
 
+    if (m_trace) {
+        m_trace->close();
+        o3d::deletePtr(m_trace);
+
+        if (config->getTraceReference().isValid()) {
+            checkTrace(config);
+        }
+    }
+
     // retrieve final account data and daily samples
     m_connector->finalAccountStats(accountStats);
 
     globalStats.computeStats(accountStats);
 
+    o3d::String pruned = Pruning::reasonToStr(m_pruningState.reason);
+
     // if learning write final
     if (config->getLearningFilename().isValid()) {
-        config->overwriteLearningFile(globalStats, accountStats);
+        config->overwriteLearningFile(globalStats, accountStats, pruned);
+    }
+
+    if (m_pruningState.pruned()) {
+        INFO("results", o3d::String("Pruned by {0} at {1}").arg(pruned).arg(timestampToStr(m_pruningState.timestamp)));
     }
 
     INFO("results", o3d::String("Global performance {0}%, Win/Loss {1}/{2}={3}, MFE={4}%, MAE={5}%, Max Adj. Win/Loss={6}/{7}")
@@ -217,6 +299,12 @@ void Backtest::terminate(Config *config)
         o3d::deletePtr(m_connector);
     }
 
+    if (m_logger) {
+        o3d::deletePtr(m_logger);
+    }
+
+    o3d::deletePtr(m_pruning);
+
     m_poolWorker = nullptr;
     m_database = nullptr;
     m_cache = nullptr;
@@ -224,6 +312,10 @@ void Backtest::terminate(Config *config)
 
 void Backtest::start()
 {
+    if (m_logger) {
+        m_logger->start();
+    }
+
      // create a decicaded thread for the timecounter
     if (!m_running) {
         m_running = true;
@@ -239,6 +331,10 @@ void Backtest::stop()
         m_running = false;
         m_thread.waitFinish();
     }
+
+    if (m_logger) {
+        m_logger->stop();
+    }
 }
 
 void Backtest::sync()
@@ -345,29 +441,96 @@ Cache *Backtest::cache()
     return m_cache;
 }
 
+AsyncLogger *Backtest::logger()
+{
+    return m_logger;
+}
+
 void Backtest::log(const o3d::String &unit, const o3d::String &marketId, const o3d::String &channel,
                    const o3d::String &msg, o3d::System::MessageLevel type)
 {
     // @todo throught the monitor send a log message
     // m_monitor.log(timestamp(), unit, marketId, channel, msg);
-    o3d::DateTime dt;
-    dt.fromTime(timestamp(), true);
 
-    if (unit.isEmpty()) {
-        m_displayer->display(channel, o3d::String("[{0}] <{1}> : {2}").arg(dt.buildString("%Y-%m-%d %H:%M:%S"))
-                                          .arg(marketId).arg(msg), type);
+    // deferred datetime formatting and display into the logger thread
+    if (m_logger) {
+        m_logger->logText(unit, marketId, channel, msg, type);
+    }
+}
+
+o3d::Double Backtest::feedStrategy(StrategyElt &elt, o3d::Double timestamp)
+{
+    // no need to acquire/release because we are always synchronous in backtesting
+    const ReplayChunk *chunk = elt.replayBus->next(timestamp, 1);
+    if (!chunk) {
+        return 0.0;
+    }
+
+    o3d::Double lastTimestamp = chunk->lastTimestamp();
+
+    // inject ticks and closed ohlc into the strategy
+    elt.replayBus->feedStrategy(elt.strategy, elt.market, chunk);
+
+    if (elt.strategy->trace()) {
+        o3d::Int32 numOhlcs = 0;
+        for (o3d::Int32 i = 0; i < Ohlc::NUM_TYPE; ++i) {
+            numOhlcs += chunk->ohlcs(static_cast<Ohlc::Type>(i)).getSize();
+        }
+
+        elt.strategy->trace()->step(lastTimestamp, chunk->ticks().getSize(), numOhlcs);
+    }
+
+    // consume them
+    chunk->release();
+
+    return lastTimestamp;
+}
+
+void Backtest::checkTrace(Config *config)
+{
+    Trace::Divergence divergence;
+
+    if (!Trace::compare(config->getTraceFilename(), config->getTraceReference(), config->getTraceEpsilon(), divergence)) {
+        return;
+    }
+
+    if (divergence.diverged) {
+        WARN("trace", o3d::String("Trace diverges from {0} on {1} at event {2} : {3}")
+             .arg(config->getTraceReference()).arg(divergence.marketId)
+             .arg(divergence.index).arg(divergence.description));
     } else {
-        m_displayer->display(channel, o3d::String("[{0}] @{1} <{2}> : {3}").arg(dt.buildString("%Y-%m-%d %H:%M:%S"))
-                                          .arg(unit).arg(marketId).arg(msg), type);
+        INFO("trace", o3d::String("Trace identical to {0}").arg(config->getTraceReference()));
+    }
+}
+
+o3d::Bool Backtest::prune()
+{
+    o3d::Double performance = 0.0;
+    o3d::Int32 numTrades = 0;
+
+    for (auto &pair : m_strategies) {
+        const Statistics &stats = pair.second.strategy->statistics();
+
+        performance += stats.performance + stats.unrealizedPerformance;
+        numTrades += stats.totalTrades;
     }
+
+    if (m_pruning->update(m_pruningState, performance, numTrades, m_curTs)) {
+        WARN("backtest", o3d::String("Backtest pruned by {0} at {1} with performance {2}% max draw-down {3}%")
+             .arg(Pruning::reasonToStr(m_pruningState.reason))
+             .arg(timestampToStr(m_curTs))
+             .arg(performance*100, 2)
+             .arg(m_pruningState.drawDown*100, 2));
+
+        return true;
+    }
+
+    return false;
 }
 
 o3d::Int32 Backtest::run(void *)
 {
     Strategy *strategy = nullptr;
-    Market *market = nullptr;
-    o3d::Int32 n = 0;
-    DataArray ticks;
     o3d::Double lastTimestamp = 0.0;
     o3d::Double maxDeltaTime = 0.0;
 
@@ -377,40 +540,20 @@ o3d::Int32 Backtest::run(void *)
                 break;
             }
 
-            for (auto pair : m_strategies) {
+            for (auto &pair : m_strategies) {
                 strategy = pair.second.strategy;
-                market = pair.second.market;
 
                 if (!strategy->running()) {
                     continue;
                 }
 
-                if (pair.second.tickStream) {
-                    // no need to acquire/release because we are always synchronous in backtesting
-                    n = pair.second.tickStream->fillNext(m_curTs, market->getTickBuffer());
-                   // n = pair.second.tickStream->fillNext(m_curTs, ticks);
-                }
+                lastTimestamp = feedStrategy(pair.second, m_curTs);
 
-                if (n <= 0) {
-                    // no ticks for this run
+                if (lastTimestamp <= 0.0) {
+                    // no ticks neither ohlc for this run
                     continue;
                 }
 
-                lastTimestamp = market->getTickBuffer().last().timestamp();
-
-//                printf("%i %f\n", market->getTickBuffer().getSize(), m_curTs);
-//                if (market->getTickBuffer().getSize() > 0) {
-//                    printf(">until %s first tick found at %f \n", timestamp, market->getTickBuffer().getData()[0]);
-//                }
-
-                // inject ticks into the strategy
-                strategy->onTickUpdate(lastTimestamp/*m_curTs*/, market->getTickBuffer());
-
-                // consume them
-                market->setLastTick(market->getTickBuffer().last());
-                market->getTickBuffer().forceSize(0);
-                // ticks.destroy();
-
                 // process one strategy iteration
                 strategy->process(lastTimestamp/*m_curTs*/);
 
@@ -423,6 +566,10 @@ o3d::Int32 Backtest::run(void *)
                 m_connector->update();
             }
 
+            if (m_pruning && prune()) {
+                break;
+            }
+
             m_curTs += m_timestep;
 
             // yield
@@ -431,44 +578,38 @@ o3d::Int32 Backtest::run(void *)
     } else {
         // using PoolWorker and synchronization
         PoolWorker::CountDown countDown;
+        std::vector<Strategy*> updated;
+
+        updated.reserve(m_strategies.size());
 
         while (m_running) {
             if (m_curTs > m_toTs) {
                 break;
             }
 
-            // reset the countdown
-            countDown.count = static_cast<o3d::Int32>(m_strategies.size());
+            updated.clear();
 
-            for (auto pair : m_strategies) {
+            for (auto &pair : m_strategies) {
                 strategy = pair.second.strategy;
-                market = pair.second.market;
 
                 if (!strategy->running()) {
                     continue;
                 }
 
-                if (pair.second.tickStream) {
-                    // no need to acquire/release because we are always synchronous in backtesting
-                    n = pair.second.tickStream->fillNext(m_curTs, market->getTickBuffer());
-                    // n = pair.second.tickStream->fillNext(m_curTs, ticks);
-                }
-
-                if (n <= 0) {
-                    // no ticks for this run
+                if (feedStrategy(pair.second, m_curTs) <= 0.0) {
+                    // no ticks neither ohlc for this run
                     continue;
                 }
 
-                // inject ticks into the strategy
-                strategy->onTickUpdate(m_curTs, market->getTickBuffer());
+                updated.push_back(strategy);
+            }
 
-                // consume them
-                market->setLastTick(market->getTickBuffer().last());
-                market->getTickBuffer().forceSize(0);
-                // ticks.destroy();
+            // count only the strategies really processed, else the countdown never reach zero
+            countDown.count = static_cast<o3d::Int32>(updated.size());
 
+            for (Strategy *updatedStrategy : updated) {
                 // process one strategy iteration
-                m_poolWorker->addJob(strategy, m_curTs, &countDown);
+                m_poolWorker->addJob(updatedStrategy, m_curTs, &countDown);
 
                 // update the local connector to manage orders, positions and virtual account details
                 m_connector->update();
@@ -477,6 +618,10 @@ o3d::Int32 Backtest::run(void *)
             // sync before continue
             countDown.wait();
 
+            if (m_pruning && prune()) {
+                break;
+            }
+
             m_curTs += m_timestep;
 
             // yield
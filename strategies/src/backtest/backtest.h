@@ -9,6 +9,7 @@
 #define SIIS_BACKTEST_H
 
 #include "siis/handler.h"
+#include "siis/learning/pruning.h"
 
 #include <o3d/core/configfile.h>
 #include <o3d/core/mutex.h>
@@ -70,6 +71,8 @@ public:
     virtual Database* database() override;
     virtual Cache* cache() override;
 
+    virtual AsyncLogger* logger() override;
+
     virtual void log(const o3d::String &unit,
                      const o3d::String &marketId,
                      const o3d::String &channel,
@@ -94,12 +97,33 @@ private:
     {
         class Strategy *strategy;
         class Market *market;
-        class TickStream *tickStream;
-        class OhlcStream *ohlcStream;
+        class ReplayBus *replayBus;   //!< decoded ticks and ohlc of the market
     };
 
     o3d::CStringMap<StrategyElt> m_strategies;
 
+    /**
+     * @brief feedStrategy Inject the ticks and the closed ohlc until timestamp into the strategy.
+     * @return The timestamp of the last injected data, or 0 if nothing new.
+     */
+    o3d::Double feedStrategy(StrategyElt &elt, o3d::Double timestamp);
+
+    Pruning *m_pruning;            //!< null if no pruning rules
+    Pruning::State m_pruningState;
+
+    class Trace *m_trace;          //!< null if the events are not traced
+
+    /**
+     * @brief prune Evaluate the pruning rules on the global results of the strategies.
+     * @return True if the backtest must be stopped.
+     */
+    o3d::Bool prune();
+
+    /**
+     * @brief checkTrace Compare the recorded trace with the reference and log the first divergence.
+     */
+    void checkTrace(Config *config);
+
     Displayer *m_displayer;
 
     class Connector *m_connector;
@@ -111,6 +135,8 @@ private:
 
     Database *m_database;
     Cache *m_cache;
+
+    AsyncLogger *m_logger;
 };
 
 } // namespace siis
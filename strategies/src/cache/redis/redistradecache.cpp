@@ -12,7 +12,11 @@
 
 #include "siis/trade/trade.h"
 
+#include <o3d/core/debug.h>
+
 using namespace siis;
+using o3d::Debug;
+using o3d::Logger;
 
 RedisTradeCache::RedisTradeCache(RedisCache *cache) :
     m_redisCache(cache)
@@ -35,83 +39,187 @@ const Cache *RedisTradeCache::cache() const
     return m_redisCache;
 }
 
-void RedisTradeCache::setTrade(
-        const o3d::String &brokerId, const o3d::String &marketId, const o3d::String &strategyId, const Trade &trade)
+void RedisTradeCache::setTrade(const o3d::String &brokerId, const o3d::String &accountId, const o3d::String &marketId,
+                               const o3d::String &strategyId, const Trade &trade)
 {
-    m_mutex.lock();
-
-    // this way avoid memory allocation
-    m_buffer = "RPUSH trade.";
-    m_buffer += strategyId;
-    m_buffer += '.';
-    m_buffer += brokerId;
-    m_buffer += '.';
-    m_buffer += marketId;
-    m_buffer += '.';
-    m_buffer.concat(trade.id());
-    m_buffer += " \"";
-    m_buffer.concat(trade.entryPrice());  // @todo serialize all the members
-    m_buffer += '\"';
-
-    m_cmdList.push_back(m_buffer);
+    TradeRecord record(brokerId, accountId, marketId, strategyId, trade);
 
+    m_mutex.lock();
+    m_pending.push_back(record);
     m_mutex.unlock();
 }
 
-void RedisTradeCache::delTrade(
-        const o3d::String &brokerId, const o3d::String &marketId, const o3d::String &strategyId, const Trade &trade)
+void RedisTradeCache::delTrade(const o3d::String &brokerId, const o3d::String &accountId, const o3d::String &marketId,
+                               const o3d::String &strategyId, const Trade &trade)
 {
+    TradeRecord record(brokerId, accountId, marketId, strategyId, trade.id());
+
     m_mutex.lock();
+    m_pending.push_back(record);
     m_mutex.unlock();
 }
 
 void RedisTradeCache::delAll(const o3d::String &brokerId, const o3d::String &strategyId)
 {
-    m_mutex.lock();
+    // same prefix as TradeRecord::key(), processed by the cache thread
+    o3d::String pattern(strategyId);
+    pattern += '.';
+    pattern += brokerId;
+    pattern += ".*";
 
-    // this way avoid memory allocation
-//    m_buffer = "RPUSH trade.";
-//    m_buffer += strategyId;
-//    m_buffer += '.';
-//    m_buffer += brokerId;
-//    m_buffer += '.';
-//    m_buffer += marketId;
-//    m_buffer += '.';
-//    m_buffer.concat(trade.id());
-//    m_buffer += " \"";
-//    m_buffer += '\"';
+    m_mutex.lock();
+    m_pendingDelAll.push_back(pattern.toUtf8());
+    m_mutex.unlock();
+}
 
-//    ::redisCommand(m_redisCache->redis(), "KEYS trade");
+o3d::Bool RedisTradeCache::setTrades(const std::vector<TradeRecord> &records)
+{
+    // not while disconnected, the caller keeps them coalesced instead of growing the queue
+    const redisContext *redis = m_redisCache->redis();
+    if (!redis || redis->err) {
+        return false;
+    }
 
+    m_mutex.lock();
+    m_pending.insert(m_pending.end(), records.begin(), records.end());
     m_mutex.unlock();
+
+    return true;
 }
 
-#include "siis/trade/assettrade.h"
 void RedisTradeCache::execute()
 {
-    // @todo remove debug test
-//    AssetTrade trade(1.0);
-//    trade.setId(1);
-//    setTrade("binance.com", "ETHUSDT", "SUP", trade);
-    // o3d::System::waitMs(2000);
+    std::vector<o3d::CString> delAll;
 
+    // swap to release the producers as soon as possible
     m_mutex.lock();
+    m_writing.swap(m_pending);
+    delAll.swap(m_pendingDelAll);
+    m_mutex.unlock();
 
-//    if (m_cmdList.isValid()) {
-//        for (o3d::Int32 i = 0; i < m_cmdList.getSize(); ++i) {
-//            ::redisCommand(m_redisCache->redis(), m_cmdList[i].toUtf8().getData());
-//        }
+    if (m_writing.empty() && delAll.empty()) {
+        return;
+    }
+
+    redisContext *redis = m_redisCache->redis();
+    if (!redis) {
+        m_writing.clear();
+        return;
+    }
+
+    if (redis->err) {
+        // the previous execution failed, keep everything until reconnected
+        if (::redisReconnect(redis) != REDIS_OK) {
+            m_mutex.lock();
+            m_pending.insert(m_pending.begin(), m_writing.begin(), m_writing.end());
+            m_pendingDelAll.insert(m_pendingDelAll.begin(), delAll.begin(), delAll.end());
+            m_mutex.unlock();
+
+            m_writing.clear();
+            return;
+        }
+    }
 
-//        m_cmdList.setSize(0);
-//    }
+    // deletions before the records, that are more recent
+    for (size_t i = 0; i < delAll.size(); ++i) {
+        if (!deleteMatching(redis, delAll[i])) {
+            O3D_WARNING(o3d::String("Redis trade cache deletion failed, retried : {0}").arg(redis->errstr));
 
-    if (!m_cmdList.empty()) {
-        for (auto it = m_cmdList.begin(); it != m_cmdList.end(); ++it) {
-            ::redisCommand(m_redisCache->redis(), (*it).toUtf8().getData());
+            m_mutex.lock();
+            m_pending.insert(m_pending.begin(), m_writing.begin(), m_writing.end());
+            m_pendingDelAll.insert(m_pendingDelAll.begin(), delAll.begin() + static_cast<std::ptrdiff_t>(i), delAll.end());
+            m_mutex.unlock();
+
+            m_writing.clear();
+            return;
         }
+    }
 
-        m_cmdList.clear();
+    if (m_writing.empty()) {
+        return;
     }
 
-    m_mutex.unlock();
+    // pipelined, one round-trip for the whole batch
+    o3d::Int32 numCommands = 0;
+
+    for (const TradeRecord &record : m_writing) {
+        o3d::CString key = record.key();
+
+        if (record.removed) {
+            ::redisAppendCommand(redis, "DEL trade.%s", key.getData());
+        } else {
+            ::redisAppendCommand(redis, "SET trade.%s %b", key.getData(), record.data.getData(),
+                                 static_cast<size_t>(record.data.length()));
+        }
+
+        ++numCommands;
+    }
+
+    o3d::Int32 numReplies = 0;
+
+    for (; numReplies < numCommands; ++numReplies) {
+        void *reply = nullptr;
+        if (::redisGetReply(redis, &reply) != REDIS_OK) {
+            break;
+        }
+
+        ::freeReplyObject(reply);
+    }
+
+    if (numReplies < numCommands) {
+        // connection lost, the unacknowledged commands are sent again once reconnected (idempotent)
+        O3D_WARNING(o3d::String("Redis trade cache failed, {0} records kept for retry : {1}")
+                    .arg(numCommands - numReplies).arg(redis->errstr));
+
+        m_mutex.lock();
+        m_pending.insert(m_pending.begin(), m_writing.begin() + numReplies, m_writing.end());
+        m_mutex.unlock();
+    }
+
+    m_writing.clear();
+}
+
+o3d::Bool RedisTradeCache::deleteMatching(redisContext *redis, const o3d::CString &pattern)
+{
+    o3d::CString cursor("0");
+    o3d::Bool done = false;
+
+    while (!done) {
+        redisReply *reply = static_cast<redisReply*>(::redisCommand(
+                                redis, "SCAN %s MATCH trade.%s COUNT 100", cursor.getData(), pattern.getData()));
+
+        if (!reply) {
+            return false;
+        }
+
+        if (reply->type != REDIS_REPLY_ARRAY || reply->elements != 2) {
+            ::freeReplyObject(reply);
+            return false;
+        }
+
+        // a cursor of 0 ends the iteration
+        cursor = o3d::CString(reply->element[0]->str, static_cast<o3d::Int32>(reply->element[0]->len));
+        done = reply->element[0]->len == 1 && reply->element[0]->str[0] == '0';
+
+        const redisReply *keys = reply->element[1];
+        o3d::Int32 numCommands = 0;
+
+        for (size_t i = 0; i < keys->elements; ++i) {
+            ::redisAppendCommand(redis, "DEL %b", keys->element[i]->str, keys->element[i]->len);
+            ++numCommands;
+        }
+
+        ::freeReplyObject(reply);
+
+        for (o3d::Int32 i = 0; i < numCommands; ++i) {
+            void *delReply = nullptr;
+            if (::redisGetReply(redis, &delReply) != REDIS_OK) {
+                return false;
+            }
+
+            ::freeReplyObject(delReply);
+        }
+    }
+
+    return true;
 }
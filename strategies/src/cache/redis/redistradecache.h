@@ -10,7 +10,6 @@
 
 #include "siis/cache/tradecache.h"
 
-#include <o3d/core/templatearray.h>
 #include <o3d/core/string.h>
 #include <o3d/core/mutex.h>
 
@@ -34,23 +33,30 @@ public:
     virtual Cache* cache() override;
     virtual const Cache* cache() const override;
 
-    virtual void setTrade(const o3d::String &brokerId, const o3d::String &marketId,
+    virtual void setTrade(const o3d::String &brokerId, const o3d::String &accountId, const o3d::String &marketId,
                           const o3d::String &strategyId, const Trade &trade) override;
 
-    virtual void delTrade(const o3d::String &brokerId, const o3d::String &marketId,
+    virtual void delTrade(const o3d::String &brokerId, const o3d::String &accountId, const o3d::String &marketId,
                           const o3d::String &strategyId, const Trade &trade) override;
 
     virtual void delAll(const o3d::String &brokerId, const o3d::String &strategyId) override;
 
+    virtual o3d::Bool setTrades(const std::vector<TradeRecord> &records) override;
+
     virtual void execute() override;
 
 private:
 
+    //! SCAN the keys matching the pattern and DEL them, false if the connection failed
+    o3d::Bool deleteMatching(struct redisContext *redis, const o3d::CString &pattern);
+
     RedisCache *m_redisCache;
-    // o3d::TemplateArray<o3d::String> m_cmdList;   //!< this structure avoid lot of memory reallocations
-    std::list<o3d::String> m_cmdList;
 
-    o3d::String m_buffer;
+    std::vector<TradeRecord> m_pending;   //!< filled by the producers
+    std::vector<TradeRecord> m_writing;   //!< swapped and pipelined by execute
+
+    std::vector<o3d::CString> m_pendingDelAll;   //!< key patterns to scan and delete by execute
+
     o3d::FastMutex m_mutex;
 };
 
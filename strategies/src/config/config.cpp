@@ -10,6 +10,11 @@
 #include "siis/market.h"
 #include "siis/statistics/statistics.h"
 #include "siis/statistics/statisticstojson.h"
+#include "siis/learning/parameterspace.h"
+#include "siis/learning/validation.h"
+#include "siis/learning/pruning.h"
+#include "siis/learning/distribution.h"
+#include "siis/utils/common.h"
 
 #include <o3d/core/filemanager.h>
 #include <o3d/core/file.h>
@@ -39,6 +44,15 @@ Config::Config() :
     m_dbPort(5432),
     m_dbUser("siis"),
     m_dbPwd("siis"),
+    m_dbPoolSize(0),
+    m_tradeBatchSize(64),
+    m_tradeFlushDelay(0.5),
+    m_tradeHighWatermark(4096),
+    m_ohlcCacheEnabled(false),
+    m_detailedStatistics(false),
+    m_snapshotRestore(false),
+    m_snapshotSave(false),
+    m_snapshotMaxGap(3600.0),
     m_cacheType("redis"),
     m_cacheName("siis"),
     m_cacheHost("127.0.0.1"),
@@ -46,6 +60,8 @@ Config::Config() :
     m_cacheUser("siis"),
     m_cachePwd("siis"),
     m_numWorkers(-1),
+    m_logEnabled(true),
+    m_logRingSize(4096),
     m_fromTs(0),
     m_toTs(0),
     m_timestep(1),
@@ -54,7 +70,14 @@ Config::Config() :
     m_modified(),
     m_revision(1),
     m_initialBalance(0.0),
-    m_initialCurrency("USD")
+    m_initialCurrency("USD"),
+    m_parameterSpace(nullptr),
+    m_validation(nullptr),
+    m_pruning(nullptr),
+    m_distribution(nullptr),
+    m_resultStore(false),
+    m_equityCurveTimeframe(0.0),
+    m_traceEpsilon(0.0)
 {
 
 }
@@ -64,6 +87,11 @@ Config::~Config()
     for (MarketConfig *mc : m_configuredMarkets) {
         o3d::deletePtr(mc);
     }
+
+    o3d::deletePtr(m_parameterSpace);
+    o3d::deletePtr(m_validation);
+    o3d::deletePtr(m_pruning);
+    o3d::deletePtr(m_distribution);
 }
 
 void Config::initPaths(const o3d::Dir &basePath)
@@ -172,10 +200,36 @@ void Config::loadCmdLine(const o3d::CommandLine *cmdLine)
             O3D_ERROR(o3d::E_InvalidParameter("optimize and learn switches are mutually exclusives"));
         }
 
+        if (cmdLine->getSwitch('C') && cmdLine->getSwitch('W')) {
+            O3D_ERROR(o3d::E_InvalidParameter("coordinator and worker switches are mutually exclusives"));
+        }
+
+        if ((cmdLine->getSwitch('C') || cmdLine->getSwitch('W')) && !cmdLine->getSwitch('o')) {
+            O3D_ERROR(o3d::E_InvalidParameter("coordinator and worker switches need the optimize switch"));
+        }
+
+        m_distributionAddress = cmdLine->getOptionValue('A');
+
+        m_traceFilename = cmdLine->getOptionValue('T');
+        m_traceReference = cmdLine->getOptionValue('R');
+        m_traceEpsilon = cmdLine->getOptionValue('e').toDouble();
+
+        if (m_traceFilename.isValid() && !cmdLine->getSwitch('b')) {
+            O3D_ERROR(o3d::E_InvalidParameter("trace option needs the backtest switch"));
+        }
+
+        if (m_traceReference.isValid() && m_traceFilename.isEmpty()) {
+            O3D_ERROR(o3d::E_InvalidParameter("reference option needs the trace option"));
+        }
+
         if (cmdLine->getSwitch('b')) {
             m_handlerType = HANDLER_BACKTEST;
         } else if (cmdLine->getSwitch('L')) {
             m_handlerType = HANDLER_LEARN;
+        } else if (cmdLine->getSwitch('o') && cmdLine->getSwitch('C')) {
+            m_handlerType = HANDLER_COORDINATOR;
+        } else if (cmdLine->getSwitch('o') && cmdLine->getSwitch('W')) {
+            m_handlerType = HANDLER_WORKER;
         } else if (cmdLine->getSwitch('o')) {
             m_handlerType = HANDLER_OPTIMIZE;
         } else if (cmdLine->getSwitch('l')) {
@@ -211,6 +265,32 @@ void Config::loadCommon()
         Json::Value global = parser.root().get("global", Json::Value());
         m_numWorkers = global.get("workers", -1).asInt();
 
+        // asynchronous logger, could be fully disabled for backtest and optimization
+        Json::Value log = parser.root().get("log", Json::Value());
+        m_logEnabled = log.get("enabled", true).asBool();
+        m_logRingSize = log.get("ring-size", 4096).asInt();
+
+        if (m_handlerType == HANDLER_BACKTEST || m_handlerType == HANDLER_LEARN) {
+            m_logEnabled = m_logEnabled && log.get("backtest", true).asBool();
+        } else if (m_handlerType == HANDLER_OPTIMIZE || m_handlerType == HANDLER_WORKER) {
+            m_logEnabled = m_logEnabled && log.get("optimization", false).asBool();
+        }
+
+        if (log.isMember("rate-limits")) {
+            Json::Value rateLimits = log.get("rate-limits", Json::Value());
+            for (auto it = rateLimits.begin(); it != rateLimits.end(); ++it) {
+                const std::string channel = it.name();
+
+                // the window is in wall clock time, a fast backtest would drop most of its trade events
+                if (m_handlerType != HANDLER_LIVE && (channel.compare(0, 6, "trade-") == 0 ||
+                                                      channel.compare(0, 6, "order-") == 0)) {
+                    continue;
+                }
+
+                m_logRateLimits[channel.c_str()] = it->asInt();
+            }
+        }
+
         // database
         Json::Value database = parser.root().get("database", Json::Value());
         m_dbType = database.get("type", "postgresql" /*mysql*/).asString().c_str();
@@ -220,6 +300,40 @@ void Config::loadCommon()
         m_dbName = database.get("name", "siis").asString().c_str();
         m_dbUser = database.get("user", "siis").asString().c_str();
         m_dbPwd = database.get("pwd", "siis").asString().c_str();
+        // only the backtest and the optimization prepare the markets in parallel, they need at least one
+        const o3d::Bool parallelPrepare = m_handlerType == HANDLER_BACKTEST || m_handlerType == HANDLER_OPTIMIZE;
+
+        m_dbPoolSize = database.get("pool-size", parallelPrepare ? 4 : 0).asInt();
+
+        if (parallelPrepare) {
+            m_dbPoolSize = o3d::max(m_dbPoolSize, 1);
+        }
+
+        if (database.isMember("trade-store")) {
+            Json::Value tradeStore = database.get("trade-store", Json::Value());
+
+            m_tradeBatchSize = tradeStore.get("batch-size", 64).asInt();
+            m_tradeFlushDelay = tradeStore.get("flush-delay", 0.5).asDouble();
+            m_tradeHighWatermark = tradeStore.get("high-watermark", 4096).asInt();
+        }
+
+        if (database.isMember("ohlc-cache")) {
+            Json::Value ohlcCache = database.get("ohlc-cache", Json::Value());
+
+            m_ohlcCacheEnabled = ohlcCache.get("enabled", false).asBool();
+            m_ohlcCachePath = ohlcCache.get("path", "").asString().c_str();
+        }
+
+        // statistics, detailed for the reports else only computed online
+        Json::Value statistics = parser.root().get("statistics", Json::Value());
+        m_detailedStatistics = statistics.get("detailed", false).asBool();
+
+        // strategy state snapshots, to skip the warm-up
+        Json::Value snapshots = parser.root().get("snapshots", Json::Value());
+        m_snapshotRestore = snapshots.get("restore", false).asBool();
+        m_snapshotSave = snapshots.get("save", false).asBool();
+        m_snapshotsPath = snapshots.get("path", "").asString().c_str();
+        m_snapshotMaxGap = snapshots.get("max-gap", 3600.0).asDouble();
 
         // cache
         Json::Value cache = parser.root().get("cache", Json::Value());
@@ -237,6 +351,20 @@ void Config::loadCommon()
     }
 }
 
+o3d::Bool Config::isDetailedStatistics() const
+{
+    // learning file reports the daily samples, and validation needs the results of each trade
+    return m_detailedStatistics || m_learningFilename.isValid() || m_validation != nullptr;
+}
+
+o3d::String Config::getSnapshotFilename(const o3d::String &strategyIdentifier, const o3d::String &marketId) const
+{
+    o3d::String path = m_snapshotsPath.isEmpty() ? m_marketsPath.getFullPathName() : m_snapshotsPath;
+    o3d::String filename = o3d::String("{0}-{1}-{2}.snap").arg(strategyIdentifier).arg(m_brokerId).arg(marketId);
+
+    return o3d::File(path, filename).getFullFileName();
+}
+
 o3d::Int32 marketTradeTypeFromStr(const o3d::String &type)
 {
     if (type == "spot" || type == "asset" || type == "buysell") {
@@ -283,6 +411,7 @@ void Config::loadStrategySpec(const o3d::String filename)
             Json::Value connector = parser.root().get("connector", Json::Value());
 
             m_brokerId = connector.get("broker-id", "").asString().c_str();
+            m_accountId = connector.get("account-id", "").asString().c_str();
             m_connectorHost = connector.get("host", "127.0.0.1").asString().c_str();
             m_connectorPort = static_cast<o3d::UInt32>(connector.get("port", 6401).asInt());
             m_connectorKey = connector.get("key", "").asString().c_str();
@@ -473,6 +602,7 @@ void Config::loadProfileSpec(const o3d::String filename)
             }
 
             m_brokerId = trader.get("name", "").asString().c_str();
+            m_accountId = trader.get("account-id", "").asString().c_str();
             // m_connectorHost = connector.get("host", "127.0.0.1").asString().c_str();
             // m_connectorPort = static_cast<o3d::UInt32>(connector.get("port", 6401).asInt());
             // m_connectorKey = connector.get("key", "").asString().c_str();
@@ -580,6 +710,19 @@ void Config::loadProfileSpec(const o3d::String filename)
 
             m_strategy = strategy.get("name", "").asString().c_str();
             m_strategyIdentifier = strategy.get("id", "").asString().c_str();
+
+            // optional pruning rules of the backtest
+            if (parser.root().isMember("pruning")) {
+                Pruning *pruning = new Pruning();
+
+                if (!pruning->parse(parser.root().get("pruning", Json::Value()))) {
+                    o3d::deletePtr(pruning);
+                    O3D_ERROR(o3d::E_InvalidParameter("Invalid pruning rules for profile " + filename));
+                }
+
+                o3d::deletePtr(m_pruning);
+                m_pruning = pruning;
+            }
         }
 
         m_profileFilename = filename;
@@ -684,7 +827,98 @@ void Config::loadSupervisorSpec(const o3d::String filename)
     }
 }
 
-void Config::overwriteLearningFile(const GlobalStatistics &global, const AccountStatistics &account) const
+void Config::loadOptimizationSpec(const o3d::String filename)
+{
+    o3d::File lfile(m_learningPath.getFullPathName(), filename);
+    if (!lfile.exists()) {
+        O3D_ERROR(o3d::E_InvalidParameter(o3d::String("{0} optimization configuration file not found").arg(filename)));
+    }
+
+    try {
+        JsonParser parser;
+        if (parser.parse(m_learningPath, filename)) {
+            ParameterSpace *parameterSpace = new ParameterSpace();
+
+            if (!parameterSpace->parse(parser.root())) {
+                o3d::deletePtr(parameterSpace);
+                O3D_ERROR(o3d::E_InvalidParameter("Invalid parameter space for optimization " + filename));
+            }
+
+            o3d::deletePtr(m_parameterSpace);
+            m_parameterSpace = parameterSpace;
+
+            // optional walk-forward or cross-validation of the candidates
+            o3d::deletePtr(m_validation);
+
+            if (parser.root().isMember("validation")) {
+                Validation *validation = new Validation();
+
+                if (!validation->parse(parser.root().get("validation", Json::Value()))) {
+                    o3d::deletePtr(validation);
+                    O3D_ERROR(o3d::E_InvalidParameter("Invalid validation for optimization " + filename));
+                }
+
+                m_validation = validation;
+            }
+
+            // optional pruning rules of the candidates, overrides those of the profile
+            if (parser.root().isMember("pruning")) {
+                Pruning *pruning = new Pruning();
+
+                if (!pruning->parse(parser.root().get("pruning", Json::Value()))) {
+                    o3d::deletePtr(pruning);
+                    O3D_ERROR(o3d::E_InvalidParameter("Invalid pruning rules for optimization " + filename));
+                }
+
+                o3d::deletePtr(m_pruning);
+                m_pruning = pruning;
+            }
+
+            // optional distribution over a coordinator and workers processes
+            o3d::deletePtr(m_distribution);
+
+            if (parser.root().isMember("distributed")) {
+                Distribution *distribution = new Distribution();
+
+                if (!distribution->parse(parser.root().get("distributed", Json::Value()))) {
+                    o3d::deletePtr(distribution);
+                    O3D_ERROR(o3d::E_InvalidParameter("Invalid distribution for optimization " + filename));
+                }
+
+                m_distribution = distribution;
+            }
+
+            if ((m_handlerType == HANDLER_COORDINATOR || m_handlerType == HANDLER_WORKER) && !m_distribution) {
+                // default local distribution
+                m_distribution = new Distribution();
+            }
+
+            if (m_distribution && m_distributionAddress.isValid()) {
+                m_distribution->setAddress(m_distributionAddress);
+            }
+
+            // optional binary store of the results, with the equity curve of each candidate
+            if (parser.root().isMember("results")) {
+                Json::Value results = parser.root().get("results", Json::Value());
+
+                m_resultStore = results.get("store", false).asBool();
+                m_equityCurveTimeframe = timeframeFromStr(results.get("equity-curve", "").asString().c_str());
+
+                if (m_equityCurveTimeframe < 0.0) {
+                    O3D_ERROR(o3d::E_InvalidParameter("Invalid equity curve timeframe for optimization " + filename));
+                }
+            }
+        }
+
+        m_optimizationFilename = filename;
+    }
+    catch (Json::LogicError &e) {
+        O3D_ERROR(o3d::E_InvalidParameter("Invalid JSON format for optimization " + filename));
+    }
+}
+
+void Config::overwriteLearningFile(const GlobalStatistics &global, const AccountStatistics &account,
+                                   const o3d::String &pruned) const
 {
     if (m_learningFilename.isEmpty()) {
         return;
@@ -751,6 +985,13 @@ void Config::overwriteLearningFile(const GlobalStatistics &global, const Account
             root["max-loss-series"] = global.maxAdjacentLoss;
             root["max-win-series"] = global.maxAdjacentWin;
 
+            // stopped before the end of the period by a pruning rule
+            if (pruned.isValid()) {
+                root["pruned"] = pruned.toAscii().getData();
+            } else if (root.isMember("pruned")) {
+                root.removeMember("pruned");
+            }
+
             StatisticsToJson::dumpsGlobalStatistics(global, root);
 
             parser.save(m_learningPath.getFullPathName(), m_learningFilename);
@@ -295,7 +295,7 @@ o3d::Bool StrategyConfig::parseLearningOverrides(const o3d::Dir &basePath, const
     return false;
 }
 
-o3d::Bool StrategyConfig::parseOverrides(const Config *config)
+o3d::Bool StrategyConfig::parseOverrides(const Config *config, const Json::Value *parameters)
 {
     if (config == nullptr) {
         return false;
@@ -311,6 +311,9 @@ o3d::Bool StrategyConfig::parseOverrides(const Config *config)
     if (config->getLearningFilename().isValid()) {
         parseLearningOverrides(config->getLearningPath(), config->getLearningFilename());
     }
+    if (parameters) {
+        mergeWithDotFormat(m_root, *parameters);
+    }
 
     return true;
 }
@@ -202,6 +202,7 @@ void LocalConnector::init(Config *config)
 {
     if (config) {
         m_virtualAccount.balance = config->getInitialBalance();
+        m_virtualAccount.detailed = config->isDetailedStatistics();
         m_virtualAccount.initialBalance = config->getInitialBalance();
         m_virtualAccount.currency = config->getInitialCurrency();
 
@@ -475,9 +476,16 @@ void LocalConnector::finalAccountStats(AccountStatistics &accountStats) const
     accountStats.profitLoss = m_virtualAccount.profitLoss;
     // @todo currency and precision for formatting
 
-    // copy samples
-    for (auto const &sample : m_virtualAccount.samples) {
-        accountStats.samples.push_back(sample);
+    // copy samples, and the current day
+    accountStats.samples = m_virtualAccount.samples;
+    accountStats.accumulator = m_virtualAccount.accumulator;
+
+    if (m_virtualAccount.hasCurrentSample) {
+        if (m_virtualAccount.detailed) {
+            accountStats.samples.push_back(m_virtualAccount.currentSample);
+        }
+
+        accountStats.accumulator.addSample(m_virtualAccount.currentSample);
     }
 }
 
@@ -736,16 +744,15 @@ void LocalConnector::VirtualAccountData::dailyUpdate(o3d::Double timestamp)
 {
     o3d::Double currentBt = baseTime(timestamp, TF_DAY);
 
-    if (samples.empty()) {
+    if (!hasCurrentSample) {
         // initial sample
-        AccountSample sample;
-        sample.timestamp = currentBt;
-        sample.drawDown = drawDown;
-        sample.drawDownRate = drawDownRate;
-        sample.equity = balance;
-        sample.profitLoss = profitLoss;
+        currentSample.timestamp = currentBt;
+        currentSample.drawDown = drawDown;
+        currentSample.drawDownRate = drawDownRate;
+        currentSample.equity = balance;
+        currentSample.profitLoss = profitLoss;
 
-        samples.push_back(sample);
+        hasCurrentSample = true;
     }
 
     if (lastUpdateTimestamp > 0.0) {
@@ -754,29 +761,30 @@ void LocalConnector::VirtualAccountData::dailyUpdate(o3d::Double timestamp)
 
         o3d::Int32 elapsedDays = o3d::min(999, static_cast<o3d::Int32>((currentBt - previousBt) / TF_DAY));
         if (elapsedDays > 0) {
-            const AccountSample &prevSample = samples.back();
-
+            // complete the previous day, the next ones starting with its state
             while (elapsedDays-- > 0) {
-                previousBt += TF_DAY;
-
-                AccountSample sample;
-                sample.timestamp = previousBt;
-                sample.drawDown = prevSample.drawDown;
-                sample.drawDownRate = prevSample.drawDownRate;
-                sample.equity = prevSample.equity;
-                sample.profitLoss = prevSample.profitLoss;
+                addSample(currentSample);
 
-                samples.push_back(sample);
+                previousBt += TF_DAY;
+                currentSample.timestamp = previousBt;
             }
         }
 
         // update current day
-        AccountSample &currSample = samples.back();
-        currSample.drawDown = drawDown;
-        currSample.drawDownRate = drawDownRate;
-        currSample.equity = balance;
-        currSample.profitLoss = profitLoss;
+        currentSample.drawDown = drawDown;
+        currentSample.drawDownRate = drawDownRate;
+        currentSample.equity = balance;
+        currentSample.profitLoss = profitLoss;
     }
 
     lastUpdateTimestamp = timestamp;
 }
+
+void LocalConnector::VirtualAccountData::addSample(const AccountSample &sample)
+{
+    accumulator.addSample(sample);
+
+    if (detailed) {
+        samples.push_back(sample);
+    }
+}
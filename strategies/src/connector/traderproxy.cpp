@@ -25,6 +25,7 @@
 #include "siis/connector/ordersignal.h"
 #include "siis/connector/marketsignal.h"
 #include "siis/connector/positionsignal.h"
+#include "siis/utils/trace.h"
 
 #include <o3d/core/uuid.h>
 
@@ -232,6 +233,10 @@ void TraderProxy::freeTrade(Trade *trade)
 
 o3d::Int32 TraderProxy::createOrder(Order *order)
 {
+    if (order->strategy && order->strategy->trace()) {
+        order->strategy->trace()->order(order->direction, order->orderType, order->orderQuantity, order->orderPrice);
+    }
+
     if (m_connector) {
         return m_connector->createOrder(order);
     }
@@ -519,6 +524,11 @@ void TraderProxy::onOrderSignal(const OrderSignal &signal)
         // dispatch to the related strategy
         Strategy *strategy = m_connector->handler()->strategy(market->marketId());
         if (strategy) {
+            if (signal.event == OrderSignal::TRADED && strategy->trace()) {
+                strategy->trace()->fill(signal.executed, signal.direction, signal.execPrice,
+                                        signal.filled, signal.cumulativeFilled);
+            }
+
             strategy->onOrderSignal(signal);
         }
     }
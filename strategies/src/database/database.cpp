@@ -6,6 +6,7 @@
  */
 
 #include "siis/database/database.h"
+#include "siis/database/ohlccachedb.h"
 #include <o3d/core/error.h>
 
 #include "mysql/mysql.h"
@@ -32,13 +33,22 @@ Database *Database::builder(
     }
 }
 
+// connection of the pool acquired by the current thread
+static thread_local const Database *t_owner = nullptr;
+static thread_local o3d::Database *t_connection = nullptr;
+static thread_local o3d::Bool t_dedicated = false;
+
 Database::Database() :
     m_thread(this),
     m_running(false),
+    m_db(nullptr),
+    m_poolSize(0),
+    m_numDedicated(0),
     m_ohlc(nullptr),
     m_rangeBar(nullptr),
     m_market(nullptr),
-    m_trade(nullptr)
+    m_trade(nullptr),
+    m_ohlcCache(nullptr)
 {
 
 }
@@ -62,7 +72,7 @@ void Database::stop()
 
 OhlcDb *Database::ohlc()
 {
-    return m_ohlc;
+    return m_ohlcCache ? m_ohlcCache : m_ohlc;
 }
 
 RangeBarDb *Database::rangeBar()
@@ -80,7 +90,151 @@ TradeDb *Database::trade()
     return m_trade;
 }
 
-Database::~Database()
+void Database::setPoolSize(o3d::Int32 size)
+{
+    m_poolSize = o3d::max(0, size);
+}
+
+void Database::setNumDedicated(o3d::Int32 num)
+{
+    m_numDedicated = o3d::max(0, num);
+}
+
+void Database::acquire()
+{
+    O3D_ASSERT(t_owner == nullptr);
+
+    // the primary connection is never lent, it is used by the main thread
+    if (m_poolSize <= 0) {
+        O3D_ERROR(o3d::E_InvalidPrecondition("No database connection pool, the pool-size must be at least 1"));
+    }
+
+    m_poolMutex.lock();
+
+    while (m_freeConnections.empty()) {
+        m_poolCondition.wait(m_poolMutex);
+    }
+
+    t_connection = m_freeConnections.back();
+    t_owner = this;
+
+    m_freeConnections.pop_back();
+
+    m_poolMutex.unlock();
+}
+
+o3d::Bool Database::acquireDedicated()
+{
+    O3D_ASSERT(t_owner == nullptr);
+
+    m_poolMutex.lock();
+
+    if (m_dedicatedConnections.empty()) {
+        m_poolMutex.unlock();
+        return false;
+    }
+
+    t_connection = m_dedicatedConnections.back();
+    t_owner = this;
+    t_dedicated = true;
+
+    m_dedicatedConnections.pop_back();
+
+    m_poolMutex.unlock();
+
+    return true;
+}
+
+void Database::release()
+{
+    if (t_owner != this) {
+        return;
+    }
+
+    m_poolMutex.lock();
+
+    if (t_dedicated) {
+        m_dedicatedConnections.push_back(t_connection);
+    } else {
+        m_freeConnections.push_back(t_connection);
+        m_poolCondition.wakeOne();
+    }
+
+    t_connection = nullptr;
+    t_owner = nullptr;
+    t_dedicated = false;
+
+    m_poolMutex.unlock();
+}
+
+void Database::registerQuery(const o3d::String &name, const o3d::CString &query)
+{
+    if (m_db) {
+        m_db->registerQuery(name, query);
+    }
+
+    for (o3d::Database *conn : m_pool) {
+        conn->registerQuery(name, query);
+    }
+}
+
+o3d::Database *Database::db()
+{
+    if (t_owner == this) {
+        return t_connection;
+    }
+
+    return m_db;
+}
+
+void Database::createPool()
+{
+    m_poolMutex.lock();
+
+    for (o3d::Int32 i = 0; i < m_poolSize; ++i) {
+        o3d::Database *conn = newConnection();
+
+        m_pool.push_back(conn);
+        m_freeConnections.push_back(conn);
+    }
+
+    // reserved connections, registered as the pool ones but never shared
+    for (o3d::Int32 i = 0; i < m_numDedicated; ++i) {
+        o3d::Database *conn = newConnection();
+
+        m_pool.push_back(conn);
+        m_dedicatedConnections.push_back(conn);
+    }
+
+    m_poolMutex.unlock();
+}
+
+void Database::destroyPool()
+{
+    m_poolMutex.lock();
+
+    for (o3d::Database *conn : m_pool) {
+        conn->unregisterAll();
+        conn->disconnect();
+
+        o3d::deletePtr(conn);
+    }
+
+    m_pool.clear();
+    m_freeConnections.clear();
+    m_dedicatedConnections.clear();
+
+    m_poolMutex.unlock();
+}
+
+void Database::enableOhlcCache(const o3d::String &path)
 {
+    if (m_ohlc && !m_ohlcCache) {
+        m_ohlcCache = new OhlcCacheDb(m_ohlc, path);
+    }
+}
 
+Database::~Database()
+{
+    o3d::deletePtr(m_ohlcCache);
 }
@@ -23,12 +23,15 @@ siis::MySql::MySql(
             const o3d::String &name,
             const o3d::String &user,
             const o3d::String &pwd) :
-    m_db(nullptr)
+    m_host(host),
+    m_port(port),
+    m_name(name),
+    m_user(user),
+    m_pwd(pwd)
 {
     o3d::mysql::MySql::init();
 
-    m_db = new o3d::mysql::MySqlDb();
-    m_db->connect(host, port, name, user, pwd, true);
+    m_db = newConnection();
 
 //    m_db->registerQuery("fetch-market", "");
 //    m_db->registerQuery("fetch-trades", "");
@@ -45,6 +48,9 @@ siis::MySql::~MySql()
 void MySql::init()
 {
     if (m_db) {
+        // before the DAOs for the registration of the queries
+        createPool();
+
         m_ohlc = new MySqlOhlcDb(this);
         m_rangeBar = new MySqlRangeBarDb(this);
         m_market = new MySqlMarketDb(this);
@@ -60,6 +66,8 @@ void siis::MySql::terminate()
         o3d::deletePtr(m_market);
         o3d::deletePtr(m_trade);
 
+        destroyPool();
+
         m_db->disconnect();
         o3d::deletePtr(m_db);
     }
@@ -76,7 +84,10 @@ o3d::Int32 siis::MySql::run(void *)
     return 0;
 }
 
-o3d::Database *MySql::db()
+o3d::Database *MySql::newConnection()
 {
-    return m_db;
+    o3d::Database *conn = new o3d::mysql::MySqlDb();
+    conn->connect(m_host, m_port, m_name, m_user, m_pwd, true);
+
+    return conn;
 }
@@ -10,6 +10,8 @@
 
 #include "siis/database/tradedb.h"
 
+#include <o3d/core/database.h>
+
 namespace siis {
 
 class MySql;
@@ -36,12 +38,19 @@ public:
 
     virtual std::list<Trade*> fetchTradeList(const o3d::String &brokerId, const o3d::String &marketId);
 
-    virtual void storeTrade(const o3d::String &brokerId, const o3d::String &marketId,
+    virtual void storeTrade(const o3d::String &brokerId, const o3d::String &accountId, const o3d::String &marketId,
                             const o3d::String &strategyId, const Trade &trade);
 
+    virtual o3d::Int32 storeTrades(const std::vector<TradeRecord> &records);
+
 private:
 
+    //! number of rows of the multi-rows upsert query
+    static constexpr o3d::Int32 BATCH_SIZE = 16;
+
     MySql *m_db;
+
+    void bindTrade(o3d::DbQuery *query, o3d::UInt32 offset, const TradeRecord &record);
 };
 
 } // namespace siis
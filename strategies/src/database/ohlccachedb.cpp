@@ -0,0 +1,402 @@
+/**
+ * @brief SiiS strategy OHLC local binary cache.
+ * @copyright Copyright (C) 2024 SiiS
+ * @author Frederic SCHERMA (frederic.scherma@gmail.com)
+ * @date 2024-10-07
+ */
+
+#include "siis/database/ohlccachedb.h"
+
+#include <ctime>
+#include <cstdio>
+#include <vector>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace siis;
+
+const o3d::UInt32 OhlcCacheDb::MAGIC = 0x43484f53;  // "SOHC"
+const o3d::UInt32 OhlcCacheDb::VERSION = 1;
+
+static o3d::Bool makePath(const o3d::CString &path)
+{
+    // mkdir -p
+    std::string p(path.getData());
+    for (size_t i = 1; i <= p.size(); ++i) {
+        if (i == p.size() || p[i] == '/') {
+            std::string sub = p.substr(0, i);
+            if (::mkdir(sub.c_str(), 0755) != 0 && errno != EEXIST) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+static o3d::Double nowTime()
+{
+    return static_cast<o3d::Double>(::time(nullptr));
+}
+
+OhlcCacheDb::OhlcCacheDb(OhlcDb *source, const o3d::String &path) :
+    m_source(source),
+    m_path(path)
+{
+    O3D_ASSERT(m_source != nullptr);
+}
+
+OhlcCacheDb::~OhlcCacheDb()
+{
+
+}
+
+Database *OhlcCacheDb::db()
+{
+    return m_source->db();
+}
+
+const Database *OhlcCacheDb::db() const
+{
+    return m_source->db();
+}
+
+o3d::Bool OhlcCacheDb::fetchOhlc(const o3d::String &brokerId,
+                                 const o3d::String &marketId,
+                                 o3d::Double timeframe,
+                                 o3d::Double timestamp,
+                                 Ohlc &out)
+{
+    return m_source->fetchOhlc(brokerId, marketId, timeframe, timestamp, out);
+}
+
+o3d::Int32 OhlcCacheDb::fetchOhlcArrayFromTo(const o3d::String &brokerId,
+                                             const o3d::String &marketId,
+                                             o3d::Double timeframe,
+                                             o3d::Double from,
+                                             o3d::Double to,
+                                             OhlcArray &out)
+{
+    if (timeframe <= 0.0 || from > to) {
+        return m_source->fetchOhlcArrayFromTo(brokerId, marketId, timeframe, from, to, out);
+    }
+
+    o3d::Int32 n = 0;
+    o3d::Int32 lastMonth = monthIndex(o3d::min(to, nowTime()));
+
+    for (o3d::Int32 month = monthIndex(from); month <= lastMonth; ++month) {
+        n += readMonth(brokerId, marketId, timeframe, month, from, to, out);
+    }
+
+    return n;
+}
+
+o3d::Int32 OhlcCacheDb::fetchOhlcArrayLast(const o3d::String &brokerId,
+                                           const o3d::String &marketId,
+                                           o3d::Double timeframe,
+                                           o3d::Int32 lastN,
+                                           OhlcArray &out)
+{
+    return fetchOhlcArrayLastTo(brokerId, marketId, timeframe, lastN, nowTime(), out);
+}
+
+o3d::Int32 OhlcCacheDb::fetchOhlcArrayLastTo(const o3d::String &brokerId,
+                                             const o3d::String &marketId,
+                                             o3d::Double timeframe,
+                                             o3d::Int32 lastN,
+                                             o3d::Double to,
+                                             OhlcArray &out)
+{
+    if (timeframe <= 0.0 || lastN <= 0) {
+        return m_source->fetchOhlcArrayLastTo(brokerId, marketId, timeframe, lastN, to, out);
+    }
+
+    // walk backward month per month until enough bars
+    std::vector<OhlcArray*> months;
+    o3d::Int32 total = 0;
+    o3d::Int32 emptyMonths = 0;
+
+    for (o3d::Int32 month = monthIndex(o3d::min(to, nowTime())); total < lastN && emptyMonths < MAX_EMPTY_MONTHS; --month) {
+        OhlcArray *bars = new OhlcArray();
+        o3d::Int32 k = readMonth(brokerId, marketId, timeframe, month, 0.0, to, *bars);
+
+        if (k > 0) {
+            months.push_back(bars);
+            total += k;
+            emptyMonths = 0;
+        } else {
+            o3d::deletePtr(bars);
+            ++emptyMonths;
+        }
+    }
+
+    // oldest first, skipping the surplus of the oldest month
+    o3d::Int32 skip = o3d::max(0, total - lastN);
+    o3d::Int32 n = 0;
+
+    for (auto it = months.rbegin(); it != months.rend(); ++it) {
+        OhlcArray *bars = *it;
+        o3d::Int32 s = o3d::min(skip, bars->getSize());
+
+        out.pushArray(bars->getContent(0) + s*8, bars->getSize() - s);
+
+        n += bars->getSize() - s;
+        skip -= s;
+
+        o3d::deletePtr(bars);
+    }
+
+    return n;
+}
+
+o3d::Int32 OhlcCacheDb::fetchOhlcArrayFrom(const o3d::String &brokerId,
+                                           const o3d::String &marketId,
+                                           o3d::Double timeframe,
+                                           o3d::Double from,
+                                           OhlcArray &out)
+{
+    return fetchOhlcArrayFromTo(brokerId, marketId, timeframe, from, nowTime(), out);
+}
+
+o3d::Bool OhlcCacheDb::getLastOhlc(const o3d::String &brokerId,
+                                   const o3d::String &marketId,
+                                   o3d::Double timeframe,
+                                   Ohlc &out)
+{
+    return m_source->getLastOhlc(brokerId, marketId, timeframe, out);
+}
+
+o3d::Int32 OhlcCacheDb::monthIndex(o3d::Double timestamp)
+{
+    time_t t = static_cast<time_t>(timestamp);
+    struct tm dt;
+    ::gmtime_r(&t, &dt);
+
+    return (dt.tm_year + 1900) * 12 + dt.tm_mon;
+}
+
+o3d::Double OhlcCacheDb::monthStart(o3d::Int32 month)
+{
+    struct tm dt;
+    memset(&dt, 0, sizeof(struct tm));
+
+    dt.tm_year = month / 12 - 1900;
+    dt.tm_mon = month % 12;
+    dt.tm_mday = 1;
+
+    return static_cast<o3d::Double>(::timegm(&dt));
+}
+
+o3d::CString OhlcCacheDb::monthFile(const o3d::String &brokerId,
+                                    const o3d::String &marketId,
+                                    o3d::Double timeframe,
+                                    o3d::Int32 month,
+                                    o3d::Bool create) const
+{
+    o3d::String path = o3d::String("{0}/{1}/{2}/O/{3}").arg(m_path).arg(brokerId).arg(marketId)
+                       .arg(static_cast<o3d::Int32>(timeframe));
+
+    if (create) {
+        makePath(path.toUtf8());
+    }
+
+    char filename[16];
+    snprintf(filename, sizeof(filename), "/%04i%02i.dat", month / 12, month % 12 + 1);
+
+    path += filename;
+    return path.toUtf8();
+}
+
+o3d::Int32 OhlcCacheDb::readMonth(const o3d::String &brokerId,
+                                  const o3d::String &marketId,
+                                  o3d::Double timeframe,
+                                  o3d::Int32 month,
+                                  o3d::Double from,
+                                  o3d::Double to,
+                                  OhlcArray &out)
+{
+    if (monthStart(month) > nowTime()) {
+        // not started month
+        return 0;
+    }
+
+    const o3d::CString filename = monthFile(brokerId, marketId, timeframe, month, true);
+
+    // second attempt after a (re)fill
+    for (o3d::Int32 attempt = 0; attempt < 2; ++attempt) {
+        int fd = ::open(filename.getData(), O_RDONLY);
+        if (fd < 0) {
+            if (attempt == 0 && fillMonth(brokerId, marketId, timeframe, month, filename)) {
+                continue;
+            }
+
+            return 0;
+        }
+
+        struct stat st;
+        if (::fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(Header))) {
+            ::close(fd);
+
+            if (attempt == 0 && fillMonth(brokerId, marketId, timeframe, month, filename)) {
+                continue;
+            }
+
+            return 0;
+        }
+
+        size_t size = static_cast<size_t>(st.st_size);
+        void *map = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+
+        if (map == MAP_FAILED) {
+            return 0;
+        }
+
+        const Header *header = reinterpret_cast<const Header*>(map);
+
+        o3d::Bool valid = header->magic == MAGIC && header->version == VERSION &&
+                          header->timeframe == timeframe &&
+                          size == sizeof(Header) + static_cast<size_t>(header->count) * 64;
+
+        if (valid && !header->complete) {
+            // month not closed at write time, invalid if the source has more recent bars
+            Ohlc last;
+            if (m_source->getLastOhlc(brokerId, marketId, timeframe, last) && last.timestamp() > header->lastTimestamp) {
+                valid = false;
+            }
+        }
+
+        if (!valid) {
+            ::munmap(map, size);
+
+            if (attempt == 0 && fillMonth(brokerId, marketId, timeframe, month, filename)) {
+                continue;
+            }
+
+            return 0;
+        }
+
+        const o3d::Double *bars = reinterpret_cast<const o3d::Double*>(reinterpret_cast<const o3d::UInt8*>(map) + sizeof(Header));
+        o3d::Int32 count = static_cast<o3d::Int32>(header->count);
+
+        // bars are ordered by timestamp, binary search the bounds
+        o3d::Int32 lo = 0, hi = count;
+        while (lo < hi) {
+            o3d::Int32 mid = (lo + hi) / 2;
+            if (bars[mid*8] < from) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+
+        o3d::Int32 first = lo;
+
+        lo = first, hi = count;
+        while (lo < hi) {
+            o3d::Int32 mid = (lo + hi) / 2;
+            if (bars[mid*8] <= to) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+
+        o3d::Int32 n = lo - first;
+        if (n > 0) {
+            out.pushArray(bars + first*8, n);
+        }
+
+        ::munmap(map, size);
+        return n;
+    }
+
+    return 0;
+}
+
+o3d::Bool OhlcCacheDb::fillMonth(const o3d::String &brokerId,
+                                 const o3d::String &marketId,
+                                 o3d::Double timeframe,
+                                 o3d::Int32 month,
+                                 const o3d::CString &filename)
+{
+    const std::string key(filename.getData());
+
+    m_fillMutex.lock();
+
+    if (m_filling.find(key) != m_filling.end()) {
+        // another thread fills the same month, read its file once done
+        while (m_filling.find(key) != m_filling.end()) {
+            m_fillCondition.wait(m_fillMutex);
+        }
+
+        m_fillMutex.unlock();
+        return true;
+    }
+
+    m_filling.insert(key);
+    m_fillMutex.unlock();
+
+    o3d::Bool ok = writeMonth(brokerId, marketId, timeframe, month, filename);
+
+    m_fillMutex.lock();
+    m_filling.erase(key);
+    m_fillCondition.wakeAll();
+    m_fillMutex.unlock();
+
+    return ok;
+}
+
+o3d::Bool OhlcCacheDb::writeMonth(const o3d::String &brokerId,
+                                  const o3d::String &marketId,
+                                  o3d::Double timeframe,
+                                  o3d::Int32 month,
+                                  const o3d::CString &filename)
+{
+    o3d::Double from = monthStart(month);
+    o3d::Double to = monthStart(month+1);
+
+    OhlcArray bars;
+    m_source->fetchOhlcArrayFromTo(brokerId, marketId, timeframe, from, to - 0.001, bars);
+
+    Header header;
+    memset(&header, 0, sizeof(Header));
+
+    header.magic = MAGIC;
+    header.version = VERSION;
+    header.timeframe = timeframe;
+    header.count = bars.getSize();
+    header.lastTimestamp = bars.getSize() > 0 ? bars.get(bars.getSize()-1)->timestamp() : 0.0;
+    header.writeTime = nowTime();
+    header.complete = header.writeTime >= to + timeframe ? 1 : 0;
+
+    // write to a temporary file then rename, atomic for the concurrent readers
+    char suffix[32];
+    snprintf(suffix, sizeof(suffix), ".tmp.%i", static_cast<int>(::getpid()));
+
+    std::string tmpName(filename.getData());
+    tmpName += suffix;
+
+    FILE *f = ::fopen(tmpName.c_str(), "wb");
+    if (!f) {
+        return false;
+    }
+
+    o3d::Bool ok = ::fwrite(&header, sizeof(Header), 1, f) == 1;
+    if (ok && bars.getSize() > 0) {
+        ok = ::fwrite(bars.getContent(0), 64, static_cast<size_t>(bars.getSize()), f) == static_cast<size_t>(bars.getSize());
+    }
+
+    ok = (::fclose(f) == 0) && ok;
+
+    if (!ok || ::rename(tmpName.c_str(), filename.getData()) != 0) {
+        ::unlink(tmpName.c_str());
+        return false;
+    }
+
+    return true;
+}
@@ -13,3 +13,24 @@ OhlcDb::~OhlcDb()
 {
 
 }
+
+o3d::Int32 OhlcDb::fetchOhlcArrays(const o3d::String &brokerId,
+                                   const o3d::String &marketId,
+                                   std::vector<OhlcRequest> &requests)
+{
+    o3d::Int32 n = 0;
+
+    for (OhlcRequest &request : requests) {
+        if (request.lastN > 0) {
+            request.count = fetchOhlcArrayLastTo(brokerId, marketId, request.timeframe,
+                                                 request.lastN, request.to, *request.out);
+        } else {
+            request.count = fetchOhlcArrayFromTo(brokerId, marketId, request.timeframe,
+                                                 request.from, request.to, *request.out);
+        }
+
+        n += request.count;
+    }
+
+    return n;
+}
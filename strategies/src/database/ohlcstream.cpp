@@ -25,27 +25,50 @@ OhlcStream::OhlcStream(
         const o3d::String &marketPath,
         const o3d::String &brokerId,
         const o3d::String &marketId,
+        o3d::Double timeframe,
+        Ohlc::Type ohlcType,
         const o3d::DateTime &from,
         const o3d::DateTime &to,
-        o3d::Int32 bufferSize) :
+        o3d::Int32 pageSize,
+        o3d::Bool prefetch) :
     m_marketPath(marketPath),
     m_brokerId(brokerId),
     m_marketId(marketId),
+    m_timeframe(timeframe),
+    m_ohlcType(ohlcType),
     m_from(from),
     m_to(to),
-    m_cur(from),
-    m_buffer(bufferSize*8, bufferSize*8),
-    // m_bufferSize(bufferSize),
+    m_pageSize(o3d::max(1, pageSize)),
+    m_pageFromTs(0.0),
+    m_page(&m_pages[0]),
+    m_next(&m_pages[1]),
+    m_ofs(0),
     m_finished(false),
-    // m_ofs(0),
+    m_opened(false),
+    m_prefetch(prefetch && db && db->getPoolSize() > 0),
+    m_running(false),
+    m_request(false),
+    m_nextReady(false),
+    m_nextEnd(false),
+    m_thread(this),
+    m_db(db),
     m_ohlcDb(nullptr)
 {
     O3D_ASSERT(db != nullptr);
+    O3D_ASSERT(timeframe > 0.0);
 
     m_fromTs = from.toDoubleTimestamp(true);
     m_toTs = to.toDoubleTimestamp(true);
 
-    // @todo build a new ohlcDb from db
+    m_pageFromTs = m_fromTs;
+
+    if (db) {
+        m_ohlcDb = db->ohlc();
+    }
+
+    if (!m_ohlcDb || m_timeframe <= 0.0) {
+        m_finished = true;
+    }
 }
 
 OhlcStream::~OhlcStream()
@@ -55,15 +78,30 @@ OhlcStream::~OhlcStream()
 
 void OhlcStream::open()
 {
-    if (m_ohlcDb) {
+    if (m_opened) {
         return;
     }
+
+    m_opened = true;
+
+    if (m_prefetch) {
+        m_request = true;
+        m_running = true;
+
+        m_thread.start();
+        m_thread.setName("siis::ohlcstream");
+    }
 }
 
 void OhlcStream::close()
 {
-    if (m_ohlcDb) {
-        o3d::deletePtr(m_ohlcDb);
+    if (m_running) {
+        m_mutex.lock();
+        m_running = false;
+        m_condition.wakeAll();
+        m_mutex.unlock();
+
+        m_thread.waitFinish();
     }
 }
 
@@ -71,7 +109,32 @@ o3d::Int32 OhlcStream::fillNext(o3d::Double timestamp, DataArray &out)
 {
     o3d::Int32 n = 0;
 
-    // @todo
+    while (!m_finished) {
+        if (m_ofs >= m_page->getSize()) {
+            // end of the page reached, swap with the next one
+            bufferize();
+            continue;
+        }
+
+        const Ohlc *ohlc = m_page->get(m_ofs);
+
+        if (ohlc->timestamp() < m_fromTs) {
+            ++m_ofs;  // ignore older than min timestamp
+        } else if (ohlc->timestamp() > m_toTs) {
+            // finished when reach max timestamp
+            m_finished = true;
+            close();
+            break;
+        } else if (ohlc->timestamp() + m_timeframe <= timestamp) {
+            // 8 more double for 1 ohlc
+            out.pushArray(ohlc->data(), 8);
+
+            ++m_ofs;
+            ++n;
+        } else {
+            break;
+        }
+    }
 
     return n;
 }
@@ -81,7 +144,38 @@ o3d::Int32 OhlcStream::fillNext(o3d::Double timestamp, OhlcArray &out)
     o3d::Int32 n = 0;
     o3d::Int32 t = out.getSize();
 
-    // @todo
+    while (!m_finished) {
+        if (m_ofs >= m_page->getSize()) {
+            // end of the page reached, swap with the next one
+            bufferize();
+            continue;
+        }
+
+        const Ohlc *ohlc = m_page->get(m_ofs);
+
+        if (ohlc->timestamp() < m_fromTs) {
+            ++m_ofs;  // ignore older than min timestamp
+        } else if (ohlc->timestamp() > m_toTs) {
+            // finished when reach max timestamp
+            m_finished = true;
+            close();
+            break;
+        } else if (ohlc->timestamp() + m_timeframe <= timestamp) {
+            // grow output size
+            if (t >= out.getMaxSize()-1) {
+                out.forceSize(t);
+                out.growSize();
+            }
+
+            out.get(t)->copy(ohlc->data());
+
+            ++m_ofs;
+            ++n;
+            ++t;
+        } else {
+            break;
+        }
+    }
 
     // new exact number of elements
     out.forceSize(t);
@@ -90,36 +184,119 @@ o3d::Int32 OhlcStream::fillNext(o3d::Double timestamp, OhlcArray &out)
 
 void OhlcStream::bufferize()
 {
-    if (m_cur < m_to) {
-        if (!m_ohlcDb) {
-            open();
+    if (!m_opened) {
+        open();
+    }
+
+    m_ofs = 0;
+    m_page->clear();
+
+    if (!m_prefetch) {
+        // synchronous fetch
+        if (!fetchPage(*m_page)) {
+            m_finished = m_page->getSize() == 0;
+        }
+
+        return;
+    }
+
+    m_mutex.lock();
+
+    while (!m_nextReady && m_running) {
+        m_condition.wait(m_mutex);
+    }
+
+    if (!m_nextReady) {
+        // fetcher stopped
+        m_mutex.unlock();
+        m_finished = true;
+        return;
+    }
+
+    // take the prefetched page and ask for the following one
+    OhlcArray *page = m_page;
+    m_page = m_next;
+    m_next = page;
+
+    m_nextReady = false;
+    o3d::Bool end = m_nextEnd;
+
+    if (!end) {
+        m_request = true;
+        m_condition.wakeAll();
+    }
+
+    m_mutex.unlock();
+
+    if (end) {
+        if (m_page->getSize() == 0) {
+            m_finished = true;
         }
 
-        o3d::Bool rowsEnd = false;
+        // the last page, no longer need of the fetcher
+        close();
+    }
+}
 
-        if (m_ohlcDb) {
-            // @todo results from row to buffer
-            rowsEnd = true;
+o3d::Bool OhlcStream::fetchPage(OhlcArray &out)
+{
+    out.clear();
+
+    if (m_prefetch) {
+        // the fetcher thread queries through its own connection, the primary one is used by the main thread
+        m_db->acquire();
+    }
+
+    // skip empty pages (week-end, market closed...)
+    while (out.getSize() == 0 && m_pageFromTs <= m_toTs) {
+        o3d::Double pageToTs = o3d::min(m_pageFromTs + m_pageSize * m_timeframe, m_toTs + m_timeframe);
+
+        // upper bound is inclusive at the millisecond precision
+        m_ohlcDb->fetchOhlcArrayFromTo(m_brokerId, m_marketId, m_timeframe, m_pageFromTs, pageToTs - 0.001, out);
+
+        m_pageFromTs = pageToTs;
+    }
+
+    if (m_prefetch) {
+        // per page, the streams being more than the connections of the pool
+        m_db->release();
+    }
+
+    // true if there is more pages
+    return m_pageFromTs <= m_toTs;
+}
+
+o3d::Int32 OhlcStream::run(void *)
+{
+    m_mutex.lock();
+
+    while (m_running) {
+        while (m_running && !m_request) {
+            m_condition.wait(m_mutex);
         }
 
-        if (rowsEnd) {
-            // next month/year
-            if (m_cur.month == o3d::MONTH_DECEMBER) {
-                ++m_cur.year;
-                m_cur.month = o3d::MONTH_JANUARY;
-            } else {
-                ++m_cur.month;
-            }
+        if (!m_running) {
+            break;
+        }
 
-            if (m_cur < m_to) {
-                // @todo next query
-            }
+        m_request = false;
+        m_mutex.unlock();
 
-            if (!m_ohlcDb) {
-                m_finished = true;
-            }
+        // the next page is not accessed by the consumer until ready
+        o3d::Bool more = fetchPage(*m_next);
+
+        m_mutex.lock();
+
+        m_nextEnd = !more;
+        m_nextReady = true;
+        m_condition.wakeAll();
+
+        if (m_nextEnd) {
+            break;
         }
-    } else {
-        m_finished = true;
     }
+
+    m_mutex.unlock();
+
+    return 0;
 }
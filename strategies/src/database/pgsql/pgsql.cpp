@@ -26,12 +26,16 @@ siis::PgSql::PgSql(
             o3d::UInt32 port,
             const o3d::String &name,
             const o3d::String &user,
-            const o3d::String &pwd)
+            const o3d::String &pwd) :
+    m_host(host),
+    m_port(port),
+    m_name(name),
+    m_user(user),
+    m_pwd(pwd)
 {
     o3d::pgsql::PgSql::init();
 
-    m_db = new o3d::pgsql::PgSqlDb();
-    m_db->connect(host, port, name, user, pwd, true);
+    m_db = newConnection();
 }
 
 siis::PgSql::~PgSql()
@@ -42,6 +46,9 @@ siis::PgSql::~PgSql()
 void siis::PgSql::init()
 {
     if (m_db) {
+        // before the DAOs for the registration of the queries
+        createPool();
+
         m_ohlc = new PgSqlOhlcDb(this);
         m_rangeBar = new PgSqlRangeBarDb(this);
         m_market = new PgSqlMarketDb(this);
@@ -57,6 +64,8 @@ void siis::PgSql::terminate()
         o3d::deletePtr(m_market);
         o3d::deletePtr(m_trade);
 
+        destroyPool();
+
         m_db->unregisterAll();
         m_db->disconnect();
 
@@ -75,7 +84,10 @@ o3d::Int32 PgSql::run(void *)
     return 0;
 }
 
-o3d::Database *PgSql::db()
+o3d::Database *PgSql::newConnection()
 {
-    return m_db;
+    o3d::Database *conn = new o3d::pgsql::PgSqlDb();
+    conn->connect(m_host, m_port, m_name, m_user, m_pwd, true);
+
+    return conn;
 }
@@ -35,11 +35,17 @@ public:
 
     virtual o3d::Int32 run(void *) override;
 
-    virtual o3d::Database *db() override;
+protected:
+
+    virtual o3d::Database* newConnection() override;
 
 private:
 
-    o3d::Database *m_db;
+    o3d::String m_host;
+    o3d::UInt32 m_port;
+    o3d::String m_name;
+    o3d::String m_user;
+    o3d::String m_pwd;
 };
 
 } // namespace siis
@@ -13,26 +13,26 @@ using namespace siis;
 PgSqlMarketDb::PgSqlMarketDb(siis::PgSql *db) :
     m_db(db)
 {
-    m_db->db()->registerQuery("get-market-margin-factor-info",
-                              R"SQL(SELECT margin_factor FROM market WHERE broker_id = $1 AND market_id = $2)SQL");
-
-    m_db->db()->registerQuery("get-market-info",
-                              R"SQL(SELECT symbol,
-                                        market_type, unit_type, contract_type,
-                                        trade_type, orders,
-                                        base, base_display, base_precision,
-                                        quote, quote_display, quote_precision,
-                                        settlement, settlement_display, settlement_precision,
-                                        expiry, timestamp,
-                                        lot_size, contract_size, base_exchange_rate,
-                                        value_per_pip, one_pip_means, margin_factor,
-                                        min_size, max_size, step_size,
-                                        min_notional, max_notional, step_notional,
-                                        min_price, max_price, step_price,
-                                        maker_fee, taker_fee,
-                                        maker_commission, taker_commission,
-                                        flags FROM market
-                                    WHERE broker_id = $1 AND market_id = $2)SQL");
+    m_db->registerQuery("get-market-margin-factor-info",
+                        R"SQL(SELECT margin_factor FROM market WHERE broker_id = $1 AND market_id = $2)SQL");
+
+    m_db->registerQuery("get-market-info",
+                        R"SQL(SELECT symbol,
+                                  market_type, unit_type, contract_type,
+                                  trade_type, orders,
+                                  base, base_display, base_precision,
+                                  quote, quote_display, quote_precision,
+                                  settlement, settlement_display, settlement_precision,
+                                  expiry, timestamp,
+                                  lot_size, contract_size, base_exchange_rate,
+                                  value_per_pip, one_pip_means, margin_factor,
+                                  min_size, max_size, step_size,
+                                  min_notional, max_notional, step_notional,
+                                  min_price, max_price, step_price,
+                                  maker_fee, taker_fee,
+                                  maker_commission, taker_commission,
+                                  flags FROM market
+                              WHERE broker_id = $1 AND market_id = $2)SQL");
 
     // @todo store market data
 }
@@ -13,29 +13,38 @@ using namespace siis;
 PgSqlOhlcDb::PgSqlOhlcDb(siis::PgSql *db) :
     m_db(db)
 {
-    m_db->db()->registerQuery("get-last-ohlc",
-                              R"SQL(SELECT timestamp, open, high, low, close, spread, volume FROM ohlc
-                                WHERE broker_id = $1 AND market_id = $2 AND timeframe = $3 ORDER BY timestamp DESC LIMIT 1)SQL");
-
-    m_db->db()->registerQuery("get-ohlc",
-                              R"SQL(SELECT timestamp, open, high, low, close, spread, volume FROM ohlc
-                                WHERE broker_id = $1 AND market_id = $2 AND timeframe = $3 AND timestamp = $4)SQL");
-
-    m_db->db()->registerQuery("get-array-from-to-ohlc",
-                              R"SQL(SELECT timestamp, open, high, low, close, spread, volume FROM ohlc
-                                WHERE broker_id = $1 AND market_id = $2 AND timeframe = $3 AND timestamp >= $4 AND timestamp <= $5 ORDER BY timestamp ASC)SQL");
-
-    m_db->db()->registerQuery("get-array-last-ohlc",
-                              R"SQL(SELECT timestamp, open, high, low, close, spread, volume FROM ohlc
-                                WHERE broker_id = $1 AND market_id = $2 AND timeframe = $3 ORDER BY timestamp DESC LIMIT $4)SQL");
-
-    m_db->db()->registerQuery("get-array-last-to-ohlc",
-                              R"SQL(SELECT timestamp, open, high, low, close, spread, volume FROM ohlc
-                                WHERE broker_id = $1 AND market_id = $2 AND timeframe = $3 AND timestamp <= $4 ORDER BY timestamp DESC LIMIT $5)SQL");
-
-    m_db->db()->registerQuery("get-array-from-ohlc",
-                              R"SQL(SELECT timestamp, open, high, low, close, spread, volume FROM ohlc
-                                WHERE broker_id = $1 AND market_id = $2 AND timeframe = $3 AND timestamp >= $4 ORDER BY timestamp ASC)SQL");
+    m_db->registerQuery("get-last-ohlc",
+                        R"SQL(SELECT timestamp, open, high, low, close, spread, volume FROM ohlc
+                          WHERE broker_id = $1 AND market_id = $2 AND timeframe = $3 ORDER BY timestamp DESC LIMIT 1)SQL");
+
+    m_db->registerQuery("get-ohlc",
+                        R"SQL(SELECT timestamp, open, high, low, close, spread, volume FROM ohlc
+                          WHERE broker_id = $1 AND market_id = $2 AND timeframe = $3 AND timestamp = $4)SQL");
+
+    m_db->registerQuery("get-array-from-to-ohlc",
+                        R"SQL(SELECT timestamp, open, high, low, close, spread, volume FROM ohlc
+                          WHERE broker_id = $1 AND market_id = $2 AND timeframe = $3 AND timestamp >= $4 AND timestamp <= $5 ORDER BY timestamp ASC)SQL");
+
+    m_db->registerQuery("get-array-last-ohlc",
+                        R"SQL(SELECT timestamp, open, high, low, close, spread, volume FROM ohlc
+                          WHERE broker_id = $1 AND market_id = $2 AND timeframe = $3 ORDER BY timestamp DESC LIMIT $4)SQL");
+
+    m_db->registerQuery("get-array-last-to-ohlc",
+                        R"SQL(SELECT timestamp, open, high, low, close, spread, volume FROM ohlc
+                          WHERE broker_id = $1 AND market_id = $2 AND timeframe = $3 AND timestamp <= $4 ORDER BY timestamp DESC LIMIT $5)SQL");
+
+    m_db->registerQuery("get-array-from-ohlc",
+                        R"SQL(SELECT timestamp, open, high, low, close, spread, volume FROM ohlc
+                          WHERE broker_id = $1 AND market_id = $2 AND timeframe = $3 AND timestamp >= $4 ORDER BY timestamp ASC)SQL");
+
+    // one request per row of the arrays, lateral join limited to the last N when defined
+    m_db->registerQuery("get-arrays-ohlc",
+                        R"SQL(SELECT r.i, o.timestamp, o.open, o.high, o.low, o.close, o.spread, o.volume
+                          FROM unnest($3::integer[], $4::bigint[], $5::bigint[], $6::integer[]) WITH ORDINALITY AS r(timeframe, from_ts, to_ts, last_n, i)
+                          CROSS JOIN LATERAL (SELECT timestamp, open, high, low, close, spread, volume FROM ohlc
+                            WHERE broker_id = $1 AND market_id = $2 AND timeframe = r.timeframe AND timestamp >= r.from_ts AND timestamp <= r.to_ts
+                            ORDER BY timestamp DESC LIMIT NULLIF(r.last_n, 0)) AS o
+                          ORDER BY r.i ASC, o.timestamp ASC)SQL");
 }
 
 PgSqlOhlcDb::~PgSqlOhlcDb()
@@ -365,3 +374,85 @@ o3d::Bool PgSqlOhlcDb::getLastOhlc(
 
     return true;
 }
+
+o3d::Int32 PgSqlOhlcDb::fetchOhlcArrays(const o3d::String &brokerId,
+                                        const o3d::String &marketId,
+                                        std::vector<OhlcRequest> &requests)
+{
+    if (requests.empty()) {
+        return 0;
+    }
+
+    o3d::DbQuery *query = m_db->db()->findQuery("get-arrays-ohlc");
+    if (!query) {
+        return 0;
+    }
+
+    // arrays as literals
+    o3d::String timeframes, froms, tos, lastNs;
+
+    for (size_t i = 0; i < requests.size(); ++i) {
+        const OhlcRequest &request = requests[i];
+
+        if (i > 0) {
+            timeframes += ",";
+            froms += ",";
+            tos += ",";
+            lastNs += ",";
+        }
+
+        timeframes += o3d::String::print("%i", static_cast<o3d::Int32>(request.timeframe));
+        froms += o3d::String::print("%lli", request.lastN > 0 ? 0LL : static_cast<long long>(request.from * 1000.0));
+        tos += o3d::String::print("%lli", static_cast<long long>(request.to * 1000.0));
+        lastNs += o3d::String::print("%i", o3d::max(0, request.lastN));
+
+        requests[i].count = 0;
+    }
+
+    query->setCString(0, brokerId.toUtf8());
+    query->setCString(1, marketId.toUtf8());
+    query->setCString(2, ("{" + timeframes + "}").toUtf8());
+    query->setCString(3, ("{" + froms + "}").toUtf8());
+    query->setCString(4, ("{" + tos + "}").toUtf8());
+    query->setCString(5, ("{" + lastNs + "}").toUtf8());
+
+    query->execute();
+
+    o3d::Int32 n = query->getNumRows();
+    o3d::Int32 m = 0;
+
+    if (n <= 0) {
+        return 0;
+    }
+
+    while (query->fetch()) {
+        // ordinality starts at 1
+        size_t i = static_cast<size_t>(query->getOut("i").toInt32() - 1);
+        if (i >= requests.size()) {
+            continue;
+        }
+
+        OhlcRequest &request = requests[i];
+        Ohlc ohlc;
+
+        ohlc.setTimestamp(query->getOut("timestamp").toDouble() * 0.001);
+        ohlc.setTimeframe(request.timeframe);
+
+        ohlc.setO(query->getOut("open").toDouble());
+        ohlc.setH(query->getOut("high").toDouble());
+        ohlc.setL(query->getOut("low").toDouble());
+        ohlc.setC(query->getOut("close").toDouble());
+
+        // ohlc.setSpread(query->getOut("spread").toDouble());
+        ohlc.setVolume(query->getOut("volume").toDouble());
+
+        ohlc.setConsolidated();
+        request.out->push(ohlc);
+
+        ++request.count;
+        ++m;
+    }
+
+    O3D_ASSERT(n == m);
+    return n;
+}
@@ -63,6 +63,9 @@ public:
     virtual o3d::Bool getLastOhlc(const o3d::String &brokerId, const o3d::String &marketId,
             o3d::Double timeframe, Ohlc &out) override;
 
+    virtual o3d::Int32 fetchOhlcArrays(const o3d::String &brokerId, const o3d::String &marketId,
+            std::vector<OhlcRequest> &requests) override;
+
     // virtual void storeOhlc(const o3d::String &brokerId, const o3d::String &marketId, const Ohlc &ohlc) override;
 
 private:
@@ -13,29 +13,29 @@ using namespace siis;
 PgSqlRangeBarDb::PgSqlRangeBarDb(siis::PgSql *db) :
     m_db(db)
 {
-    m_db->db()->registerQuery("get-last-range-bar",
-                              R"SQL(SELECT timestamp, duration, open, high, low, close, volume FROM range_bar
-                                WHERE broker_id = $1 AND market_id = $2 AND size = $3 ORDER BY timestamp DESC LIMIT 1)SQL");
+    m_db->registerQuery("get-last-range-bar",
+                        R"SQL(SELECT timestamp, duration, open, high, low, close, volume FROM range_bar
+                          WHERE broker_id = $1 AND market_id = $2 AND size = $3 ORDER BY timestamp DESC LIMIT 1)SQL");
 
-    m_db->db()->registerQuery("get-range-bar",
-                              R"SQL(SELECT timestamp, duration, open, high, low, close, volume FROM range_bar
-                                WHERE broker_id = $1 AND market_id = $2 AND size = $3 AND timestamp = $4)SQL");
+    m_db->registerQuery("get-range-bar",
+                        R"SQL(SELECT timestamp, duration, open, high, low, close, volume FROM range_bar
+                          WHERE broker_id = $1 AND market_id = $2 AND size = $3 AND timestamp = $4)SQL");
 
-    m_db->db()->registerQuery("get-array-from-to-range-bar",
-                              R"SQL(SELECT timestamp, duration, open, high, low, close, volume FROM range_bar
-                                WHERE broker_id = $1 AND market_id = $2 AND size = $3 AND timestamp >= $4 AND timestamp <= $5 ORDER BY timestamp ASC)SQL");
+    m_db->registerQuery("get-array-from-to-range-bar",
+                        R"SQL(SELECT timestamp, duration, open, high, low, close, volume FROM range_bar
+                          WHERE broker_id = $1 AND market_id = $2 AND size = $3 AND timestamp >= $4 AND timestamp <= $5 ORDER BY timestamp ASC)SQL");
 
-    m_db->db()->registerQuery("get-array-last-range-bar",
-                              R"SQL(SELECT timestamp, duration, open, high, low, close, volume FROM range_bar
-                                WHERE broker_id = $1 AND market_id = $2 AND size = $3 ORDER BY timestamp DESC LIMIT $4)SQL");
+    m_db->registerQuery("get-array-last-range-bar",
+                        R"SQL(SELECT timestamp, duration, open, high, low, close, volume FROM range_bar
+                          WHERE broker_id = $1 AND market_id = $2 AND size = $3 ORDER BY timestamp DESC LIMIT $4)SQL");
 
-    m_db->db()->registerQuery("get-array-last-to-range-bar",
-                              R"SQL(SELECT timestamp, duration, open, high, low, close, volume FROM range_bar
-                                WHERE broker_id = $1 AND market_id = $2 AND size = $3 AND timestamp <= $4 ORDER BY timestamp DESC LIMIT $5)SQL");
+    m_db->registerQuery("get-array-last-to-range-bar",
+                        R"SQL(SELECT timestamp, duration, open, high, low, close, volume FROM range_bar
+                          WHERE broker_id = $1 AND market_id = $2 AND size = $3 AND timestamp <= $4 ORDER BY timestamp DESC LIMIT $5)SQL");
 
-    m_db->db()->registerQuery("get-array-from-range-bar",
-                              R"SQL(SELECT timestamp, duration, open, high, low, close, volume FROM range_bar
-                                WHERE broker_id = $1 AND market_id = $2 AND size = $3 AND timestamp >= $4 ORDER BY timestamp ASC)SQL");
+    m_db->registerQuery("get-array-from-range-bar",
+                        R"SQL(SELECT timestamp, duration, open, high, low, close, volume FROM range_bar
+                          WHERE broker_id = $1 AND market_id = $2 AND size = $3 AND timestamp >= $4 ORDER BY timestamp ASC)SQL");
 }
 
 PgSqlRangeBarDb::~PgSqlRangeBarDb()
@@ -13,7 +13,32 @@ using namespace siis;
 PgSqlTradeDb::PgSqlTradeDb(siis::PgSql *db) :
     m_db(db)
 {
+    // single and multi-rows upsert, 7 parameters per row
+    o3d::String values;
+    for (o3d::Int32 i = 0; i < BATCH_SIZE; ++i) {
+        if (i > 0) {
+            values += ", ";
+        }
 
+        values += o3d::String("(${0}, ${1}, ${2}, ${3}, ${4}, ${5}, ${6})").arg(i*7+1).arg(i*7+2).arg(i*7+3)
+                  .arg(i*7+4).arg(i*7+5).arg(i*7+6).arg(i*7+7);
+    }
+
+    m_db->registerQuery("store-trade",
+                        R"SQL(INSERT INTO user_trade(broker_id, account_id, market_id, appliance_id, trade_id, trade_type, data)
+                          VALUES ($1, $2, $3, $4, $5, $6, $7)
+                          ON CONFLICT (broker_id, account_id, market_id, appliance_id, trade_id)
+                          DO UPDATE SET trade_type = EXCLUDED.trade_type, data = EXCLUDED.data)SQL");
+
+    m_db->registerQuery("store-trade-batch",
+                        ("INSERT INTO user_trade(broker_id, account_id, market_id, appliance_id, trade_id, trade_type, data) VALUES " +
+                         values +
+                         " ON CONFLICT (broker_id, account_id, market_id, appliance_id, trade_id)"
+                         " DO UPDATE SET trade_type = EXCLUDED.trade_type, data = EXCLUDED.data").toUtf8());
+
+    m_db->registerQuery("delete-trade",
+                        R"SQL(DELETE FROM user_trade
+                          WHERE broker_id = $1 AND account_id = $2 AND market_id = $3 AND appliance_id = $4 AND trade_id = $5)SQL");
 }
 
 PgSqlTradeDb::~PgSqlTradeDb()
@@ -43,7 +68,76 @@ std::list<Trade *> PgSqlTradeDb::fetchTradeList(const o3d::String &brokerId, con
     return results;
 }
 
-void PgSqlTradeDb::storeTrade(const o3d::String &brokerId, const o3d::String &marketId, const o3d::String &strategyId, const Trade &trade)
+void PgSqlTradeDb::storeTrade(const o3d::String &brokerId, const o3d::String &accountId, const o3d::String &marketId,
+                            const o3d::String &strategyId, const Trade &trade)
 {
+    std::vector<TradeRecord> records;
+    records.push_back(TradeRecord(brokerId, accountId, marketId, strategyId, trade));
+
+    storeTrades(records);
+}
+
+o3d::Int32 PgSqlTradeDb::storeTrades(const std::vector<TradeRecord> &records)
+{
+    o3d::DbQuery *storeOne = m_db->db()->findQuery("store-trade");
+    o3d::DbQuery *storeBatch = m_db->db()->findQuery("store-trade-batch");
+    o3d::DbQuery *deleteOne = m_db->db()->findQuery("delete-trade");
+
+    if (!storeOne || !storeBatch || !deleteOne) {
+        return 0;
+    }
+
+    std::vector<const TradeRecord*> upserts;
+    upserts.reserve(records.size());
+
+    o3d::Int32 n = 0;
+
+    for (const TradeRecord &record : records) {
+        if (record.removed) {
+            deleteOne->setCString(0, record.brokerId);
+            deleteOne->setCString(1, record.accountId);
+            deleteOne->setCString(2, record.marketId);
+            deleteOne->setCString(3, record.strategyId);
+            deleteOne->setInt32(4, record.tradeId);
 
+            deleteOne->execute();
+            ++n;
+        } else {
+            upserts.push_back(&record);
+        }
+    }
+
+    // full batches with the multi-rows query, the remaining with the single row query
+    size_t i = 0;
+
+    while (upserts.size() - i >= static_cast<size_t>(BATCH_SIZE)) {
+        for (o3d::Int32 r = 0; r < BATCH_SIZE; ++r) {
+            bindTrade(storeBatch, static_cast<o3d::UInt32>(r*7), *upserts[i+r]);
+        }
+
+        storeBatch->execute();
+
+        i += BATCH_SIZE;
+        n += BATCH_SIZE;
+    }
+
+    for (; i < upserts.size(); ++i) {
+        bindTrade(storeOne, 0, *upserts[i]);
+        storeOne->execute();
+
+        ++n;
+    }
+
+    return n;
+}
+
+void PgSqlTradeDb::bindTrade(o3d::DbQuery *query, o3d::UInt32 offset, const TradeRecord &record)
+{
+    query->setCString(offset+0, record.brokerId);
+    query->setCString(offset+1, record.accountId);
+    query->setCString(offset+2, record.marketId);
+    query->setCString(offset+3, record.strategyId);
+    query->setInt32(offset+4, record.tradeId);
+    query->setInt32(offset+5, record.tradeType);
+    query->setCString(offset+6, record.data);
 }
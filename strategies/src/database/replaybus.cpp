@@ -0,0 +1,217 @@
+/**
+ * @brief SiiS strategy shared market data replay bus.
+ * @copyright Copyright (C) 2024 SiiS
+ * @author Frederic SCHERMA (frederic.scherma@gmail.com)
+ * @date 2024-10-10
+ */
+
+#include "siis/database/replaybus.h"
+#include "siis/database/tickstream.h"
+#include "siis/database/ohlcstream.h"
+#include "siis/strategy.h"
+#include "siis/market.h"
+
+#include <o3d/core/debug.h>
+
+using namespace siis;
+using o3d::Debug;
+using o3d::Logger;
+
+ReplayChunk::ReplayChunk(ReplayBus *bus) :
+    m_bus(bus),
+    m_ticks(512),
+    m_tickTimestamp(0.0),
+    m_lastTimestamp(0.0),
+    m_refCount(0)
+{
+    for (o3d::Int32 i = 0; i < Ohlc::NUM_TYPE; ++i) {
+        m_ohlcTimestamps[i] = 0.0;
+    }
+}
+
+void ReplayChunk::release() const
+{
+    if (m_refCount.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        // last consumer, give it back
+        m_bus->recycle(const_cast<ReplayChunk*>(this));
+    }
+}
+
+void ReplayChunk::reset()
+{
+    m_ticks.forceSize(0);
+
+    for (o3d::Int32 i = 0; i < Ohlc::NUM_TYPE; ++i) {
+        m_ohlcs[i].forceSize(0);
+        m_ohlcTimestamps[i] = 0.0;
+    }
+
+    m_tickTimestamp = 0.0;
+    m_lastTimestamp = 0.0;
+}
+
+ReplayBus::ReplayBus(Database *database,
+                     const o3d::String &marketPath,
+                     const o3d::String &brokerId,
+                     const o3d::String &marketId,
+                     const o3d::DateTime &from,
+                     const o3d::DateTime &to) :
+    m_database(database),
+    m_marketPath(marketPath),
+    m_brokerId(brokerId),
+    m_marketId(marketId),
+    m_from(from),
+    m_to(to),
+    m_tickStream(nullptr),
+    m_numChunks(0)
+{
+    for (o3d::Int32 i = 0; i < Ohlc::NUM_TYPE; ++i) {
+        m_ohlcStreams[i] = nullptr;
+    }
+}
+
+ReplayBus::~ReplayBus()
+{
+    if (numPendingChunks() > 0) {
+        WARN("replay", o3d::String("{0} chunks still referenced on {1}").arg(numPendingChunks()).arg(m_marketId));
+    }
+
+    for (o3d::Int32 i = 0; i < m_freeChunks.getSize(); ++i) {
+        o3d::deletePtr(m_freeChunks[i]);
+    }
+
+    o3d::deletePtr(m_tickStream);
+
+    for (o3d::Int32 i = 0; i < Ohlc::NUM_TYPE; ++i) {
+        o3d::deletePtr(m_ohlcStreams[i]);
+    }
+}
+
+o3d::Bool ReplayBus::subscribe(const DataSource &dataSource)
+{
+    if (dataSource.type == DataSource::TICK) {
+        if (!m_tickStream) {
+            m_tickStream = new TickStream(m_marketPath, m_brokerId, m_marketId, m_from, m_to);
+        }
+
+        return true;
+    } else if (dataSource.type == DataSource::OHLC_MID || dataSource.type == DataSource::OHLC_BID ||
+               dataSource.type == DataSource::OHLC_ASK) {
+        // paged and prefetched from the database, only one timeframe per type
+        Ohlc::Type ohlcType = dataSource.type == DataSource::OHLC_BID ? Ohlc::TYPE_BID :
+                              (dataSource.type == DataSource::OHLC_ASK ? Ohlc::TYPE_ASK : Ohlc::TYPE_MID);
+
+        if (dataSource.timeframe <= 0.0) {
+            return false;
+        }
+
+        if (!m_ohlcStreams[ohlcType]) {
+            m_ohlcStreams[ohlcType] = new OhlcStream(m_database, m_marketPath, m_brokerId, m_marketId,
+                                                     dataSource.timeframe, ohlcType, m_from, m_to);
+            return true;
+        }
+
+        return m_ohlcStreams[ohlcType]->timeframe() == dataSource.timeframe;
+    }
+
+    // no possibility for order-book history
+    return false;
+}
+
+const ReplayChunk *ReplayBus::next(o3d::Double timestamp, o3d::Int32 numConsumers)
+{
+    if (numConsumers <= 0) {
+        return nullptr;
+    }
+
+    ReplayChunk *chunk = nullptr;
+
+    m_mutex.lock();
+
+    if (m_freeChunks.getSize() > 0) {
+        chunk = m_freeChunks.getLast();
+        m_freeChunks.pop();
+    } else {
+        chunk = new ReplayChunk(this);
+        ++m_numChunks;
+    }
+
+    m_mutex.unlock();
+
+    chunk->reset();
+
+    if (m_tickStream && m_tickStream->fillNext(timestamp, chunk->m_ticks) > 0) {
+        chunk->m_tickTimestamp = chunk->m_ticks.last().timestamp();
+        chunk->m_lastTimestamp = chunk->m_tickTimestamp;
+    }
+
+    for (o3d::Int32 i = 0; i < Ohlc::NUM_TYPE; ++i) {
+        OhlcStream *ohlcStream = m_ohlcStreams[i];
+        if (!ohlcStream) {
+            continue;
+        }
+
+        OhlcArray &ohlcs = chunk->m_ohlcs[i];
+        if (ohlcStream->fillNext(timestamp, ohlcs) <= 0) {
+            continue;
+        }
+
+        const Ohlc *ohlc = ohlcs.get(ohlcs.getSize()-1);
+        chunk->m_ohlcTimestamps[i] = ohlc->timestamp() + ohlcStream->timeframe();
+
+        chunk->m_lastTimestamp = o3d::max(chunk->m_lastTimestamp, chunk->m_ohlcTimestamps[i]);
+    }
+
+    if (chunk->m_lastTimestamp <= 0.0) {
+        // nothing new for this timestep
+        recycle(chunk);
+        return nullptr;
+    }
+
+    chunk->m_refCount.store(numConsumers, std::memory_order_release);
+    return chunk;
+}
+
+void ReplayBus::feedStrategy(Strategy *strategy, Market *market, const ReplayChunk *chunk) const
+{
+    if (chunk->hasTicks()) {
+        strategy->feedTicks(chunk->tickTimestamp(), chunk->ticks());
+        market->setLastTick(chunk->ticks().last());
+    }
+
+    for (o3d::Int32 i = 0; i < Ohlc::NUM_TYPE; ++i) {
+        const OhlcStream *ohlcStream = m_ohlcStreams[i];
+        if (!ohlcStream || !chunk->hasOhlcs(ohlcStream->ohlcType())) {
+            continue;
+        }
+
+        const OhlcArray &ohlcs = chunk->ohlcs(ohlcStream->ohlcType());
+        o3d::Double closeTimestamp = chunk->ohlcTimestamp(ohlcStream->ohlcType());
+
+        strategy->onOhlcUpdate(closeTimestamp, ohlcStream->timeframe(), ohlcStream->ohlcType(), ohlcs);
+
+        if (!m_tickStream) {
+            // bar only, the market price is the last close
+            const Ohlc *ohlc = ohlcs.get(ohlcs.getSize()-1);
+
+            market->setPrice(ohlc->close(), ohlc->close(), closeTimestamp);
+            market->setLast(ohlc->close());
+        }
+    }
+}
+
+o3d::Int32 ReplayBus::numPendingChunks() const
+{
+    m_mutex.lock();
+    o3d::Int32 n = m_numChunks - m_freeChunks.getSize();
+    m_mutex.unlock();
+
+    return n;
+}
+
+void ReplayBus::recycle(ReplayChunk *chunk)
+{
+    m_mutex.lock();
+    m_freeChunks.push(chunk);
+    m_mutex.unlock();
+}
@@ -13,3 +13,88 @@ TradeDb::~TradeDb()
 {
 
 }
+
+TradeRecord::TradeRecord() :
+    tradeId(-1),
+    tradeType(Trade::TYPE_ASSET),
+    removed(false)
+{
+
+}
+
+TradeRecord::TradeRecord(const o3d::String &_brokerId, const o3d::String &_accountId, const o3d::String &_marketId,
+                         const o3d::String &_strategyId, const Trade &trade) :
+    brokerId(_brokerId.toUtf8()),
+    accountId(_accountId.toUtf8()),
+    marketId(_marketId.toUtf8()),
+    strategyId(_strategyId.toUtf8()),
+    tradeId(trade.id()),
+    tradeType(trade.type()),
+    removed(false)
+{
+    o3d::String buffer;
+
+    buffer = "{\"id\":";
+    buffer.concat(trade.id());
+    buffer += ",\"type\":";
+    buffer.concat(static_cast<o3d::Int32>(trade.type()));
+    buffer += ",\"direction\":";
+    buffer.concat(trade.direction());
+    buffer += ",\"timeframe\":";
+    buffer.concat(trade.timeframe());
+    buffer += ",\"timestamp\":";
+    buffer.concat(trade.timestamp());
+    buffer += ",\"open-timestamp\":";
+    buffer.concat(trade.openTimestamp());
+    buffer += ",\"exit-timestamp\":";
+    buffer.concat(trade.exitTimestamp());
+    buffer += ",\"order-price\":";
+    buffer.concat(trade.orderPrice());
+    buffer += ",\"order-qty\":";
+    buffer.concat(trade.orderQuantity());
+    buffer += ",\"entry-price\":";
+    buffer.concat(trade.entryPrice());
+    buffer += ",\"exit-price\":";
+    buffer.concat(trade.exitPrice());
+    buffer += ",\"take-profit-price\":";
+    buffer.concat(trade.takeProfitPrice());
+    buffer += ",\"stop-loss-price\":";
+    buffer.concat(trade.stopLossPrice());
+    buffer += ",\"filled-entry-qty\":";
+    buffer.concat(trade.filledEntryQuantity());
+    buffer += ",\"filled-exit-qty\":";
+    buffer.concat(trade.filledExitQuantity());
+    buffer += ",\"profit-loss-rate\":";
+    buffer.concat(trade.profitLossRate());
+    buffer += ",\"active\":";
+    buffer += trade.isActive() ? "true" : "false";
+    buffer += '}';
+
+    data = buffer.toUtf8();
+}
+
+TradeRecord::TradeRecord(const o3d::String &_brokerId, const o3d::String &_accountId, const o3d::String &_marketId,
+                         const o3d::String &_strategyId, o3d::Int32 _tradeId) :
+    brokerId(_brokerId.toUtf8()),
+    accountId(_accountId.toUtf8()),
+    marketId(_marketId.toUtf8()),
+    strategyId(_strategyId.toUtf8()),
+    tradeId(_tradeId),
+    tradeType(Trade::TYPE_ASSET),
+    removed(true)
+{
+
+}
+
+o3d::CString TradeRecord::key() const
+{
+    o3d::String key(strategyId);
+    key += '.';
+    key += o3d::String(brokerId);
+    key += '.';
+    key += o3d::String(marketId);
+    key += '.';
+    key.concat(tradeId);
+
+    return key.toUtf8();
+}
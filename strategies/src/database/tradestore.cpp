@@ -0,0 +1,277 @@
+/**
+ * @brief SiiS strategy asynchronous trade persistence.
+ * @copyright Copyright (C) 2024 SiiS
+ * @author Frederic SCHERMA (frederic.scherma@gmail.com)
+ * @date 2024-10-05
+ */
+
+#include "siis/database/tradestore.h"
+#include "siis/database/database.h"
+#include "siis/cache/tradecache.h"
+
+#include <o3d/core/debug.h>
+#include <o3d/core/error.h>
+
+using namespace siis;
+using o3d::Debug;
+using o3d::Logger;
+
+static const o3d::Double RETRY_DELAY = 1.0;  //!< min delay in seconds before retrying a failed flush
+
+TradeStore::TradeStore(Database *database,
+                       TradeCache *tradeCache,
+                       o3d::Int32 batchSize,
+                       o3d::Double flushDelay,
+                       o3d::Int32 highWatermark) :
+    m_database(database),
+    m_tradeDb(database ? database->trade() : nullptr),
+    m_tradeCache(tradeCache),
+    m_batchSize(o3d::max(1, batchSize)),
+    m_flushDelay(o3d::max(0.0, flushDelay)),
+    m_highWatermark(o3d::max(m_batchSize, highWatermark)),
+    m_running(false),
+    m_thread(this),
+    m_lastFlush(0.0),
+    m_urgent(false),
+    m_failed(false)
+{
+    m_pending.reserve(static_cast<size_t>(m_batchSize));
+    m_writing.reserve(static_cast<size_t>(m_batchSize));
+}
+
+TradeStore::~TradeStore()
+{
+    stop();
+}
+
+void TradeStore::start()
+{
+    if (m_database && m_database->getNumDedicated() <= 0) {
+        O3D_ERROR(o3d::E_InvalidPrecondition("The trade store needs a dedicated database connection"));
+    }
+
+    if (!m_running) {
+        m_lastFlush = static_cast<o3d::Double>(o3d::System::getMsTime()) * 0.001;
+
+        m_running = true;
+        m_thread.start();
+        m_thread.setName("siis::tradestore");
+    }
+}
+
+void TradeStore::stop()
+{
+    if (m_running) {
+        m_running = false;
+        m_thread.waitFinish();
+    }
+
+    // remaining records
+    flush();
+}
+
+void TradeStore::storeTrade(const o3d::String &brokerId, const o3d::String &accountId, const o3d::String &marketId,
+                            const o3d::String &strategyId, const Trade &trade)
+{
+    // serialize out of the lock
+    TradeRecord record(brokerId, accountId, marketId, strategyId, trade);
+    enqueue(record);
+}
+
+void TradeStore::removeTrade(const o3d::String &brokerId, const o3d::String &accountId, const o3d::String &marketId,
+                             const o3d::String &strategyId, o3d::Int32 tradeId)
+{
+    TradeRecord record(brokerId, accountId, marketId, strategyId, tradeId);
+    enqueue(record);
+}
+
+void TradeStore::flush()
+{
+    doFlush();
+}
+
+TradeStore::Metrics TradeStore::metrics() const
+{
+    Metrics metrics;
+
+    m_mutex.lock();
+    metrics = m_metrics;
+    m_mutex.unlock();
+
+    return metrics;
+}
+
+void TradeStore::enqueue(TradeRecord &record)
+{
+    o3d::CString key = record.key();
+
+    m_mutex.lock();
+
+    ++m_metrics.enqueued;
+
+    auto it = m_index.find(key);
+    if (it != m_index.end()) {
+        // coalesce, only the last state matters (a removal supersedes any update)
+        std::swap(m_pending[it->second], record);
+        ++m_metrics.coalesced;
+    } else {
+        m_index[key] = m_pending.size();
+        m_pending.push_back(std::move(record));
+    }
+
+    m_metrics.pending = static_cast<o3d::Int32>(m_pending.size());
+    m_metrics.maxPending = o3d::max(m_metrics.maxPending, m_metrics.pending);
+
+    if (m_metrics.pending >= m_highWatermark && !m_urgent) {
+        // the writer is late, flush as soon as possible
+        ++m_metrics.overflows;
+        m_urgent = true;
+    }
+
+    m_mutex.unlock();
+}
+
+o3d::Int32 TradeStore::doFlush()
+{
+    m_flushMutex.lock();
+
+    // swap the buffers to release the producers as soon as possible
+    m_mutex.lock();
+
+    m_writing.swap(m_pending);
+    m_index.clear();
+
+    m_metrics.pending = 0;
+    m_urgent = false;
+
+    m_mutex.unlock();
+
+    o3d::Int32 n = static_cast<o3d::Int32>(m_writing.size());
+
+    if (n > 0) {
+        o3d::Int64 t = o3d::System::getMsTime();
+
+        o3d::Int32 written = 0;
+        o3d::Bool failed = false;
+        o3d::String error;
+
+        // pipelined by the cache thread
+        if (m_tradeCache && !m_tradeCache->setTrades(m_writing)) {
+            failed = true;
+            error = "cache not connected";
+        }
+
+        if (m_tradeDb) {
+            try {
+                written = m_tradeDb->storeTrades(m_writing);
+                if (written < n) {
+                    failed = true;
+                    error = "missing trade queries";
+                }
+            } catch (o3d::E_BaseException &e) {
+                failed = true;
+                error = e.getMsg();
+            }
+        }
+
+        o3d::Double duration = static_cast<o3d::Double>(o3d::System::getMsTime() - t) * 0.001;
+        o3d::Int32 retried = 0;
+
+        m_mutex.lock();
+
+        m_failed = failed;
+
+        if (failed) {
+            // the whole batch is retried, writes are idempotent
+            retried = requeue();
+
+            ++m_metrics.failures;
+            m_metrics.retried += static_cast<o3d::UInt64>(retried);
+        } else {
+            m_metrics.written += static_cast<o3d::UInt64>(written);
+        }
+
+        ++m_metrics.batches;
+
+        m_metrics.lastFlushTime = duration;
+        m_metrics.maxFlushTime = o3d::max(m_metrics.maxFlushTime, duration);
+
+        m_mutex.unlock();
+
+        m_writing.clear();
+
+        if (failed) {
+            O3D_WARNING(o3d::String("Failed to store {0} trades, {1} put back for retry : {2}").arg(n).arg(retried).arg(error));
+        }
+    }
+
+    m_lastFlush = static_cast<o3d::Double>(o3d::System::getMsTime()) * 0.001;
+
+    m_flushMutex.unlock();
+
+    return n;
+}
+
+o3d::Int32 TradeStore::requeue()
+{
+    o3d::Int32 n = 0;
+
+    for (TradeRecord &record : m_writing) {
+        o3d::CString key = record.key();
+
+        if (m_index.find(key) == m_index.end()) {
+            m_index[key] = m_pending.size();
+            m_pending.push_back(std::move(record));
+            ++n;
+        }
+    }
+
+    m_metrics.pending = static_cast<o3d::Int32>(m_pending.size());
+    m_metrics.maxPending = o3d::max(m_metrics.maxPending, m_metrics.pending);
+
+    return n;
+}
+
+o3d::Int32 TradeStore::run(void *)
+{
+    // never through the primary connection, it belongs to the main thread
+    if (m_database && !m_database->acquireDedicated()) {
+        ERR("tradestore", "No dedicated database connection remaining, the trades are written at stop");
+        return 0;
+    }
+
+    while (m_running) {
+        o3d::Bool needFlush = false;
+        o3d::Double now = static_cast<o3d::Double>(o3d::System::getMsTime()) * 0.001;
+
+        m_mutex.lock();
+
+        if (!m_pending.empty()) {
+            if (m_failed) {
+                // don't hammer a failing database
+                needFlush = now - m_lastFlush >= o3d::max(m_flushDelay, RETRY_DELAY);
+            } else {
+                needFlush = m_urgent ||
+                            static_cast<o3d::Int32>(m_pending.size()) >= m_batchSize ||
+                            now - m_lastFlush >= m_flushDelay;
+            }
+        }
+
+        m_mutex.unlock();
+
+        if (needFlush) {
+            doFlush();
+        } else {
+            o3d::System::waitMs(1);
+        }
+    }
+
+    // remaining records through the same connection
+    doFlush();
+
+    if (m_database) {
+        m_database->release();
+    }
+
+    return 0;
+}
@@ -0,0 +1,512 @@
+/**
+ * @brief SiiS strategy asynchronous and deferred format logger.
+ * @copyright Copyright (C) 2024 SiiS
+ * @author Frederic SCHERMA (frederic.scherma@gmail.com)
+ * @date 2024-10-02
+ */
+
+#include "siis/display/asynclogger.h"
+#include "siis/display/displayer.h"
+#include "siis/handler.h"
+#include "siis/utils/common.h"
+
+#include <o3d/core/datetime.h>
+
+using namespace siis;
+
+static std::atomic<o3d::UInt32> s_nextLoggerUid(1);
+
+// rings of the current thread, one per logger uid (uids are never reused)
+struct ThreadRing
+{
+    o3d::UInt32 owner;
+    LogRing *ring;
+};
+
+static thread_local std::vector<ThreadRing> t_rings;
+static thread_local ThreadRing t_lastRing = {0, nullptr};
+
+LogRing::LogRing(o3d::UInt32 capacity) :
+    m_records(nullptr),
+    m_mask(0),
+    m_head(0),
+    m_tail(0)
+{
+    // round to the next power of two
+    o3d::UInt32 size = 16;
+    while (size < capacity) {
+        size <<= 1;
+    }
+
+    m_records = new LogRecord[size];
+    m_mask = size - 1;
+}
+
+LogRing::~LogRing()
+{
+    o3d::deleteArray(m_records);
+}
+
+AsyncLogger::AsyncLogger(Handler *handler, Displayer *displayer, o3d::UInt32 ringSize) :
+    m_handler(handler),
+    m_displayer(displayer),
+    m_ringSize(ringSize),
+    m_uid(s_nextLoggerUid.fetch_add(1)),
+    m_enabled(true),
+    m_running(false),
+    m_thread(this),
+    m_numChannels(0),
+    m_numFormats(1),   // format 0 is reserved for text records
+    m_dropped(0),
+    m_reportedDropped(0)
+{
+    O3D_ASSERT(m_displayer != nullptr);
+}
+
+AsyncLogger::~AsyncLogger()
+{
+    stop();
+
+    // forget the ring of the calling thread, the other threads never meet this uid again
+    if (t_lastRing.owner == m_uid) {
+        t_lastRing = {0, nullptr};
+    }
+
+    for (auto it = t_rings.begin(); it != t_rings.end(); ++it) {
+        if (it->owner == m_uid) {
+            t_rings.erase(it);
+            break;
+        }
+    }
+
+    for (LogRing *ring : m_rings) {
+        o3d::deletePtr(ring);
+    }
+
+    m_rings.clear();
+}
+
+void AsyncLogger::start()
+{
+    if (!m_running.exchange(true)) {
+        m_thread.start();
+        m_thread.setName("siis::logger");
+    }
+}
+
+void AsyncLogger::stop()
+{
+    if (m_running.exchange(false)) {
+        m_thread.waitFinish();
+    }
+
+    // remaining messages
+    drain();
+}
+
+void AsyncLogger::setRateLimit(const o3d::String &channel, o3d::Int32 maxPerSecond)
+{
+    m_mutex.lock();
+
+    m_rateLimits[channel] = o3d::max(0, maxPerSecond);
+
+    // update an already known channel, read concurrently by the producers
+    for (o3d::Int32 i = 0; i < m_numChannels.load(); ++i) {
+        if (m_channels[i].name == channel) {
+            m_channels[i].maxPerSecond.store(o3d::max(0, maxPerSecond), std::memory_order_relaxed);
+            break;
+        }
+    }
+
+    m_mutex.unlock();
+}
+
+o3d::UInt16 AsyncLogger::registerFormat(const o3d::String &channel,
+                                        const o3d::String &pattern,
+                                        o3d::System::MessageLevel type)
+{
+    o3d::UInt16 formatId = 0;
+
+    m_mutex.lock();
+
+    o3d::Int32 ch = channelId(channel);
+
+    for (o3d::Int32 i = 1; i < m_numFormats.load(); ++i) {
+        if (m_formats[i].channel == ch && m_formats[i].pattern == pattern) {
+            formatId = static_cast<o3d::UInt16>(i);
+            break;
+        }
+    }
+
+    if (formatId == 0 && ch >= 0 && m_numFormats.load() < MAX_FORMATS) {
+        o3d::Int32 i = m_numFormats.load();
+
+        m_formats[i].pattern = pattern;
+        m_formats[i].channel = ch;
+        m_formats[i].type = type;
+
+        // publish once filled
+        m_numFormats.store(i + 1, std::memory_order_release);
+        formatId = static_cast<o3d::UInt16>(i);
+    }
+
+    m_mutex.unlock();
+
+    return formatId;
+}
+
+o3d::Bool AsyncLogger::logText(const o3d::String &unit,
+                               const o3d::String &marketId,
+                               const o3d::String &channel,
+                               const o3d::String &msg,
+                               o3d::System::MessageLevel type)
+{
+    if (!enabled() && !isUrgent(type)) {
+        return false;
+    }
+
+    const o3d::Int32 ch = textChannelId(channel);
+    if (ch < 0) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    char text[LogRecord::TEXT_SIZE * LogRecord::MAX_TEXT_RECORDS];
+    const o3d::Int32 len = encodeText(text, static_cast<o3d::Int32>(sizeof(text)), msg);
+    const o3d::Int32 count = o3d::max(1, (len + LogRecord::TEXT_SIZE - 1) / LogRecord::TEXT_SIZE);
+
+    LogRing *ring = threadRing();
+    LogRecord *record = ring->reserve(static_cast<o3d::UInt32>(count));
+    if (!record) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    record->timestamp = m_handler ? m_handler->timestamp() : 0.0;
+    record->formatId = 0;
+    record->numArgs = static_cast<o3d::UInt8>(count);
+    record->type = static_cast<o3d::Int8>(type);
+    record->channel = static_cast<o3d::Int16>(ch);
+
+    copyText(record->marketId, LogRecord::MAX_ID_LEN, marketId);
+    copyText(record->unit, LogRecord::MAX_UNIT_LEN, unit);
+
+    // the text continues into the following records
+    for (o3d::Int32 i = 0, offset = 0; i < count; ++i, offset += LogRecord::TEXT_SIZE) {
+        const o3d::Int32 n = len - offset < LogRecord::TEXT_SIZE ? len - offset : LogRecord::TEXT_SIZE;
+
+        memcpy(record->text, text + offset, static_cast<size_t>(n));
+        record->textLen = static_cast<o3d::UInt16>(n);
+
+        if (i + 1 < count) {
+            record = ring->following(record);
+        }
+    }
+
+    ring->commit(static_cast<o3d::UInt32>(count));
+    return true;
+}
+
+void AsyncLogger::flush()
+{
+    if (!m_running.load(std::memory_order_acquire)) {
+        drain();
+    }
+}
+
+void AsyncLogger::copyText(char *out, o3d::Int32 maxLen, const char *text)
+{
+    strncpy(out, text ? text : "", static_cast<size_t>(maxLen));
+    out[maxLen] = '\0';
+}
+
+void AsyncLogger::copyText(char *out, o3d::Int32 maxLen, const o3d::String &text)
+{
+    // market identifiers and units are ASCII
+    const o3d::WChar *chars = text.getData();
+    const o3d::Int32 len = chars ? o3d::min(text.length(), maxLen) : 0;
+
+    for (o3d::Int32 i = 0; i < len; ++i) {
+        out[i] = chars[i] < 128 ? static_cast<char>(chars[i]) : '?';
+    }
+
+    out[len] = '\0';
+}
+
+o3d::Int32 AsyncLogger::encodeText(char *out, o3d::Int32 size, const o3d::String &text)
+{
+    const o3d::WChar *chars = text.getData();
+    const o3d::Int32 len = chars ? text.length() : 0;
+
+    o3d::Int32 n = 0;
+
+    for (o3d::Int32 i = 0; i < len; ++i) {
+        const o3d::UInt32 c = static_cast<o3d::UInt32>(chars[i]);
+
+        if (c < 0x80) {
+            if (n + 1 > size) {
+                break;
+            }
+
+            out[n++] = static_cast<char>(c);
+        } else if (c < 0x800) {
+            if (n + 2 > size) {
+                break;
+            }
+
+            out[n++] = static_cast<char>(0xc0 | (c >> 6));
+            out[n++] = static_cast<char>(0x80 | (c & 0x3f));
+        } else if (c < 0x10000) {
+            if (n + 3 > size) {
+                break;
+            }
+
+            out[n++] = static_cast<char>(0xe0 | (c >> 12));
+            out[n++] = static_cast<char>(0x80 | ((c >> 6) & 0x3f));
+            out[n++] = static_cast<char>(0x80 | (c & 0x3f));
+        } else {
+            if (n + 4 > size) {
+                break;
+            }
+
+            out[n++] = static_cast<char>(0xf0 | ((c >> 18) & 0x07));
+            out[n++] = static_cast<char>(0x80 | ((c >> 12) & 0x3f));
+            out[n++] = static_cast<char>(0x80 | ((c >> 6) & 0x3f));
+            out[n++] = static_cast<char>(0x80 | (c & 0x3f));
+        }
+    }
+
+    return n;
+}
+
+LogRecord* AsyncLogger::reserve(o3d::UInt16 formatId, const o3d::CString &marketId, LogRing *&ring)
+{
+    if (formatId == 0 || formatId >= m_numFormats.load(std::memory_order_acquire)) {
+        return nullptr;
+    }
+
+    if (!enabled() && !isUrgent(m_formats[formatId].type)) {
+        return nullptr;
+    }
+
+    if (!acceptChannel(m_formats[formatId].channel)) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    ring = threadRing();
+
+    LogRecord *record = ring->reserve();
+    if (!record) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    record->timestamp = m_handler ? m_handler->timestamp() : 0.0;
+    record->formatId = formatId;
+
+    copyText(record->marketId, LogRecord::MAX_ID_LEN, marketId.getData());
+
+    return record;
+}
+
+LogRing *AsyncLogger::threadRing()
+{
+    if (t_lastRing.owner == m_uid) {
+        return t_lastRing.ring;
+    }
+
+    // thread logging alternately to many loggers, or first message of this thread for this logger
+    for (const ThreadRing &threadRing : t_rings) {
+        if (threadRing.owner == m_uid) {
+            t_lastRing = threadRing;
+            return threadRing.ring;
+        }
+    }
+
+    // allocate the ring once per thread and logger
+    LogRing *ring = new LogRing(m_ringSize);
+
+    m_mutex.lock();
+    m_rings.push_back(ring);
+    m_mutex.unlock();
+
+    t_lastRing = {m_uid, ring};
+    t_rings.push_back(t_lastRing);
+
+    return ring;
+}
+
+o3d::Int32 AsyncLogger::channelId(const o3d::String &channel)
+{
+    // must be called with mutex locked
+    for (o3d::Int32 i = 0; i < m_numChannels.load(); ++i) {
+        if (m_channels[i].name == channel) {
+            return i;
+        }
+    }
+
+    if (m_numChannels.load() >= MAX_CHANNELS) {
+        return -1;
+    }
+
+    o3d::Int32 i = m_numChannels.load();
+
+    m_channels[i].name = channel;
+
+    auto it = m_rateLimits.find(channel);
+    m_channels[i].maxPerSecond.store(it != m_rateLimits.end() ? it->second : 0, std::memory_order_relaxed);
+
+    m_numChannels.store(i + 1, std::memory_order_release);
+
+    return i;
+}
+
+o3d::Int32 AsyncLogger::textChannelId(const o3d::String &channel)
+{
+    // the published channels are never modified, lookup without lock
+    const o3d::Int32 numChannels = m_numChannels.load(std::memory_order_acquire);
+
+    for (o3d::Int32 i = 0; i < numChannels; ++i) {
+        if (m_channels[i].name == channel) {
+            return i;
+        }
+    }
+
+    m_mutex.lock();
+    o3d::Int32 ch = channelId(channel);
+    m_mutex.unlock();
+
+    return ch;
+}
+
+o3d::Bool AsyncLogger::acceptChannel(o3d::Int32 channel)
+{
+    Channel &ch = m_channels[channel];
+
+    const o3d::Int32 maxPerSecond = ch.maxPerSecond.load(std::memory_order_relaxed);
+    if (maxPerSecond <= 0) {
+        return true;
+    }
+
+    // wall clock window, not the handler time, because in backtest the time goes faster
+    const o3d::UInt64 window = static_cast<o3d::UInt64>(o3d::System::getMsTime() / 1000);
+
+    // the second and the count are updated together, the first producer of a new second resets the count
+    o3d::UInt64 state = ch.window.load(std::memory_order_relaxed);
+
+    for (;;) {
+        const o3d::UInt64 count = (state >> 32) == (window & 0xffffffff) ? state & 0xffffffff : 0;
+        if (count >= static_cast<o3d::UInt64>(maxPerSecond)) {
+            return false;
+        }
+
+        const o3d::UInt64 next = ((window & 0xffffffff) << 32) | (count + 1);
+        if (ch.window.compare_exchange_weak(state, next, std::memory_order_relaxed)) {
+            return true;
+        }
+    }
+}
+
+o3d::Int32 AsyncLogger::drain()
+{
+    o3d::Int32 n = 0;
+
+    m_mutex.lock();
+    std::vector<LogRing*> rings(m_rings);
+    m_mutex.unlock();
+
+    for (LogRing *ring : rings) {
+        LogRecord *record = nullptr;
+        while ((record = ring->front()) != nullptr) {
+            output(*ring, *record);
+
+            // a text and its following records
+            ring->pop(record->formatId == 0 ? record->numArgs : 1);
+
+            ++n;
+        }
+    }
+
+    o3d::UInt32 dropped = m_dropped.load(std::memory_order_relaxed);
+    if (dropped != m_reportedDropped) {
+        m_displayer->display("notice", o3d::String("{0} log message(s) dropped").arg(
+                                 static_cast<o3d::Int32>(dropped - m_reportedDropped)), o3d::System::MSG_WARNING);
+        m_reportedDropped = dropped;
+    }
+
+    return n;
+}
+
+void AsyncLogger::output(LogRing &ring, const LogRecord &record)
+{
+    o3d::String channel;
+    o3d::String msg;
+    o3d::System::MessageLevel type = o3d::System::MSG_INFO;
+
+    if (record.formatId == 0) {
+        char text[LogRecord::TEXT_SIZE * LogRecord::MAX_TEXT_RECORDS + 1];
+        o3d::Int32 len = 0;
+
+        const LogRecord *part = &record;
+        for (o3d::Int32 i = 0; i < record.numArgs; ++i) {
+            memcpy(text + len, part->text, part->textLen);
+            len += part->textLen;
+
+            part = ring.following(part);
+        }
+
+        text[len] = '\0';
+
+        channel = m_channels[record.channel].name;
+        msg.fromUtf8(text, static_cast<o3d::UInt32>(len));
+        type = static_cast<o3d::System::MessageLevel>(record.type);
+    } else {
+        const Format &format = m_formats[record.formatId];
+
+        channel = m_channels[format.channel].name;
+        msg = format.pattern;
+        type = format.type;
+
+        for (o3d::Int32 i = 0; i < record.numArgs; ++i) {
+            const LogArg &arg = record.args[i];
+
+            if (arg.type == LogArg::ARG_INT) {
+                msg = msg.arg(arg.i);
+            } else if (arg.type == LogArg::ARG_DOUBLE) {
+                if (arg.decimals >= 0) {
+                    msg = msg.arg(arg.d, arg.decimals);
+                } else {
+                    msg = msg.arg(arg.d);
+                }
+            } else if (arg.type == LogArg::ARG_STR) {
+                msg = msg.arg(o3d::String(arg.s));
+            } else if (arg.type == LogArg::ARG_TIMESTAMP) {
+                msg = msg.arg(timestampToStr(arg.d));
+            }
+        }
+    }
+
+    o3d::DateTime dt;
+    dt.fromTime(record.timestamp, true);
+
+    if (record.unit[0] == '\0') {
+        m_displayer->display(channel, o3d::String("[{0}] <{1}> : {2}").arg(dt.buildString("%Y-%m-%d %H:%M:%S"))
+                                          .arg(record.marketId).arg(msg), type);
+    } else {
+        m_displayer->display(channel, o3d::String("[{0}] @{1} <{2}> : {3}").arg(dt.buildString("%Y-%m-%d %H:%M:%S"))
+                                          .arg(record.unit).arg(record.marketId).arg(msg), type);
+    }
+}
+
+o3d::Int32 AsyncLogger::run(void *)
+{
+    while (m_running.load(std::memory_order_acquire)) {
+        if (drain() == 0) {
+            // nothing to do, don't waste the CPU
+            o3d::System::waitMs(1);
+        }
+    }
+
+    return 0;
+}
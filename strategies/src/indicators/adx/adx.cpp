@@ -7,6 +7,7 @@
 
 #include "siis/indicators/adx/adx.h"
 #include "siis/utils/common.h"
+#include "siis/utils/snapshot.h"
 
 #include <ta-lib/ta_func.h>
 
@@ -17,6 +18,7 @@ using o3d::Debug;
 Adx::Adx(const o3d::String &name, o3d::Double timeframe, o3d::Int32 len) :
     Indicator (name, timeframe),
     m_len(len),
+    m_native(len),
     m_prev(0.0),
     m_last(0.0)
 {
@@ -33,6 +35,8 @@ Adx::Adx(const o3d::String &name, o3d::Double timeframe, IndicatorConfig conf) :
     } else if (conf.data().isArray()) {
         m_len = conf.data().get((Json::ArrayIndex)1, 5).asInt();
     }
+
+    m_native.setLen(m_len);
 }
 
 void Adx::setConf(IndicatorConfig conf)
@@ -42,9 +46,23 @@ void Adx::setConf(IndicatorConfig conf)
     } else if (conf.data().isArray()) {
         m_len = conf.data().get((Json::ArrayIndex)1, 5).asInt();
     }
+
+    m_native.setLen(m_len);
 }
 
 void Adx::compute(o3d::Double timestamp, const DataArray &high, const DataArray &low, const DataArray &close)
+{
+    compute(timestamp, nullptr, high, low, close);
+}
+
+void Adx::compute(o3d::Double timestamp, const DataArray &timestamps,
+                  const DataArray &high, const DataArray &low, const DataArray &close)
+{
+    compute(timestamp, &timestamps, high, low, close);
+}
+
+void Adx::compute(o3d::Double timestamp, const DataArray *timestamps,
+                  const DataArray &high, const DataArray &low, const DataArray &close)
 {
     o3d::Int32 lb = lookback();
     if (high.getSize() <= lb) {
@@ -53,20 +71,91 @@ void Adx::compute(o3d::Double timestamp, const DataArray &high, const DataArray
 
     m_prev = m_last;
 
-    if (m_adx.getSize() != high.getSize()) {
-        m_adx.setSize(high.getSize());
+    if (backend() == BACKEND_TALIB) {
+        computeTaLib(high, low, close, m_adx);
+    } else {
+        computeNative(timestamps, high, low, close);
+
+        if (backend() == BACKEND_VERIFY) {
+            DataArray reference;
+            computeTaLib(high, low, close, reference);
+
+            NativeFeed::verify(*this, "adx", m_adx.getLast(), reference.getLast(), NativeFeed::RECURSIVE_TOLERANCE);
+        }
+    }
+
+    m_last = m_adx.getLast();
+    done(timestamp);
+}
+
+void Adx::computeNative(const DataArray *timestamps,
+                        const DataArray &high, const DataArray &low, const DataArray &close)
+{
+    // only the bars since the previous compute, the last one being the forming bar
+    const o3d::Int32 from = m_feed.compute(timestamps, high.getSize());
+    if (m_feed.restarted()) {
+        m_native.reset();
+    }
+
+    m_feed.align(m_adx);
+
+    const o3d::Int32 last = high.getSize() - 1;
+
+    for (o3d::Int32 i = from; i < last; ++i) {
+        const NativeBar bar = {high[i], low[i], close[i]};
+        m_adx[i] = m_native.update(bar);
+    }
+
+    const NativeBar bar = {high[last], low[last], close[last]};
+    m_adx[last] = m_native.updateProvisional(bar);
+}
+
+void Adx::computeTaLib(const DataArray &high, const DataArray &low, const DataArray &close, DataArray &out) const
+{
+    o3d::Int32 lb = lookback();
+
+    if (out.getSize() != high.getSize()) {
+        out.setSize(high.getSize());
     }
 
     int b, n;
-    TA_RetCode res = ::TA_ADX(0, high.getSize()-1, high.getData(), low.getData(), close.getData(), m_len, &b, &n, m_adx.getData()+lb);
+    TA_RetCode res = ::TA_ADX(0, high.getSize()-1, high.getData(), low.getData(), close.getData(), m_len, &b, &n, out.getData()+lb);
     if (res != TA_SUCCESS) {
         O3D_WARNING(siis::taErrorToStr(res));
     }
 
     O3D_ASSERT(b == lb);
+}
+
+void Adx::saveState(SnapshotWriter &writer) const
+{
+    writer.writeDouble(lastTimestamp());
+
+    writer.writeArray(m_adx);
+    writer.writeDouble(m_prev);
+    writer.writeDouble(m_last);
+
+    m_native.saveState(writer);
+    m_feed.saveState(writer);
+}
+
+o3d::Bool Adx::loadState(SnapshotReader &reader)
+{
+    const o3d::Double timestamp = reader.readDouble();
+
+    reader.readArray(m_adx);
+    m_prev = reader.readDouble();
+    m_last = reader.readDouble();
+
+    // else the native state is computed again from the next compute
+    if (!m_native.loadState(reader) || !m_feed.loadState(reader)) {
+        m_feed.reset();
+        return false;
+    }
 
-    m_last = m_adx.getLast();
     done(timestamp);
+
+    return true;
 }
 
 o3d::Int32 Adx::lookback() const
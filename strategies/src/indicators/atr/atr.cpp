@@ -7,6 +7,7 @@
 
 #include "siis/indicators/atr/atr.h"
 #include "siis/utils/common.h"
+#include "siis/utils/snapshot.h"
 
 #include <ta-lib/ta_func.h>
 
@@ -18,6 +19,7 @@ Atr::Atr(const o3d::String &name, o3d::Double timeframe, o3d::Int32 len, o3d::Do
     Indicator (name, timeframe),
     m_len(len),
     m_factor(factor),
+    m_native(len),
     m_prev(0.0),
     m_last(0.0)
 {
@@ -37,6 +39,8 @@ Atr::Atr(const o3d::String &name, o3d::Double timeframe, IndicatorConfig conf) :
         m_len = conf.data().get((Json::ArrayIndex)1, 20).asInt();
         m_factor = conf.data().get((Json::ArrayIndex)2, 3.5).asDouble();
     }
+
+    m_native.setLen(m_len);
 }
 
 void Atr::setConf(IndicatorConfig conf)
@@ -48,12 +52,23 @@ void Atr::setConf(IndicatorConfig conf)
         m_len = conf.data().get((Json::ArrayIndex)1, 20).asInt();
         m_factor = conf.data().get((Json::ArrayIndex)2, 3.5).asDouble();
     }
+
+    m_native.setLen(m_len);
 }
 
-void Atr::compute(o3d::Double timestamp,
-                  const DataArray &high,
-                  const DataArray &low,
-                  const DataArray &close)
+void Atr::compute(o3d::Double timestamp, const DataArray &high, const DataArray &low, const DataArray &close)
+{
+    compute(timestamp, nullptr, high, low, close);
+}
+
+void Atr::compute(o3d::Double timestamp, const DataArray &timestamps,
+                  const DataArray &high, const DataArray &low, const DataArray &close)
+{
+    compute(timestamp, &timestamps, high, low, close);
+}
+
+void Atr::compute(o3d::Double timestamp, const DataArray *timestamps,
+                  const DataArray &high, const DataArray &low, const DataArray &close)
 {
     o3d::Int32 lb = lookback();
     if (high.getSize() <= lb) {
@@ -62,18 +77,18 @@ void Atr::compute(o3d::Double timestamp,
 
     m_prev = m_last;
 
-    if (m_atr.getSize() != high.getSize()) {
-        m_atr.setSize(high.getSize());
-    }
+    if (backend() == BACKEND_TALIB) {
+        computeTaLib(high, low, close, m_atr);
+    } else {
+        computeNative(timestamps, high, low, close);
 
-    int b, n;
-    TA_RetCode res = ::TA_ATR(0, high.getSize()-1, high.getData(), low.getData(), close.getData(), m_len,
-                              &b, &n, m_atr.getData()+lb);
-    if (res != TA_SUCCESS) {
-        O3D_WARNING(siis::taErrorToStr(res));
-    }
+        if (backend() == BACKEND_VERIFY) {
+            DataArray reference;
+            computeTaLib(high, low, close, reference);
 
-    O3D_ASSERT(b == lb);
+            NativeFeed::verify(*this, "atr", m_atr.getLast(), reference.getLast(), NativeFeed::RECURSIVE_TOLERANCE);
+        }
+    }
 
     m_last = m_atr.getLast();
 
@@ -93,6 +108,81 @@ void Atr::compute(o3d::Double timestamp,
     done(timestamp);
 }
 
+void Atr::computeNative(const DataArray *timestamps,
+                        const DataArray &high, const DataArray &low, const DataArray &close)
+{
+    // only the bars since the previous compute, the last one being the forming bar
+    const o3d::Int32 from = m_feed.compute(timestamps, high.getSize());
+    if (m_feed.restarted()) {
+        m_native.reset();
+    }
+
+    m_feed.align(m_atr);
+
+    const o3d::Int32 last = high.getSize() - 1;
+
+    for (o3d::Int32 i = from; i < last; ++i) {
+        const NativeBar bar = {high[i], low[i], close[i]};
+        m_atr[i] = m_native.update(bar);
+    }
+
+    const NativeBar bar = {high[last], low[last], close[last]};
+    m_atr[last] = m_native.updateProvisional(bar);
+}
+
+void Atr::computeTaLib(const DataArray &high, const DataArray &low, const DataArray &close, DataArray &out) const
+{
+    o3d::Int32 lb = lookback();
+
+    if (out.getSize() != high.getSize()) {
+        out.setSize(high.getSize());
+    }
+
+    int b, n;
+    TA_RetCode res = ::TA_ATR(0, high.getSize()-1, high.getData(), low.getData(), close.getData(), m_len,
+                              &b, &n, out.getData()+lb);
+    if (res != TA_SUCCESS) {
+        O3D_WARNING(siis::taErrorToStr(res));
+    }
+
+    O3D_ASSERT(b == lb);
+}
+
+void Atr::saveState(SnapshotWriter &writer) const
+{
+    writer.writeDouble(lastTimestamp());
+
+    writer.writeArray(m_atr);
+    writer.writeDouble(m_prev);
+    writer.writeDouble(m_last);
+    writer.writeDouble(m_longStopPrice);
+    writer.writeDouble(m_shortStopPrice);
+
+    m_native.saveState(writer);
+    m_feed.saveState(writer);
+}
+
+o3d::Bool Atr::loadState(SnapshotReader &reader)
+{
+    const o3d::Double timestamp = reader.readDouble();
+
+    reader.readArray(m_atr);
+    m_prev = reader.readDouble();
+    m_last = reader.readDouble();
+    m_longStopPrice = reader.readDouble();
+    m_shortStopPrice = reader.readDouble();
+
+    // else the native state is computed again from the next compute
+    if (!m_native.loadState(reader) || !m_feed.loadState(reader)) {
+        m_feed.reset();
+        return false;
+    }
+
+    done(timestamp);
+
+    return true;
+}
+
 o3d::Int32 Atr::lookback() const
 {
     return m_len;  // ::TA_ATR_Lookback(m_len);
@@ -0,0 +1,269 @@
+/**
+ * @brief SiiS ATR based support/resistance indicator.
+ * @copyright Copyright (C) 2024 SiiS
+ * @author Frederic SCHERMA (frederic.scherma@gmail.com)
+ * @date 2024-10-18
+ */
+
+#include "siis/indicators/atrsr/atrsr.h"
+#include "siis/utils/common.h"
+#include "siis/utils/snapshot.h"
+
+using namespace siis;
+using o3d::Logger;
+using o3d::Debug;
+
+AtrSR::AtrSR(const o3d::String &name,
+             o3d::Double timeframe,
+             o3d::Double threshold,
+             ZigZag::Mode mode,
+             o3d::Int32 atrLen,
+             o3d::Double tolerance,
+             o3d::Int32 maxLevels) :
+    Indicator(name, timeframe),
+    m_zigzag(name, timeframe, threshold, mode, atrLen),
+    m_tolerance(tolerance),
+    m_maxLevels(maxLevels),
+    m_lastBarTimestamp(0.0)
+{
+    m_maxLevels = o3d::max(m_maxLevels, 1);
+}
+
+AtrSR::AtrSR(const o3d::String &name, o3d::Double timeframe, IndicatorConfig conf) :
+    Indicator(name, timeframe),
+    m_zigzag(name, timeframe, 3.0, ZigZag::MODE_ATR),
+    m_tolerance(0.5),
+    m_maxLevels(8),
+    m_lastBarTimestamp(0.0)
+{
+    o3d::Double threshold = 3.0;
+    ZigZag::Mode mode = ZigZag::MODE_ATR;
+    o3d::Int32 atrLen = 14;
+
+    if (conf.data().isObject()) {
+        threshold = conf.data().get("threshold", 3.0).asDouble();
+        mode = ZigZag::modeFromStr(conf.data().get("mode", "atr").asString().c_str());
+        atrLen = conf.data().get("atr-len", 14).asInt();
+        m_tolerance = conf.data().get("tolerance", 0.5).asDouble();
+        m_maxLevels = conf.data().get("max-levels", 8).asInt();
+    } else if (conf.data().isArray()) {
+        threshold = conf.data().get((Json::ArrayIndex)1, 3.0).asDouble();
+        mode = ZigZag::modeFromStr(conf.data().get((Json::ArrayIndex)2, "atr").asString().c_str());
+        atrLen = conf.data().get((Json::ArrayIndex)3, 14).asInt();
+        m_tolerance = conf.data().get((Json::ArrayIndex)4, 0.5).asDouble();
+        m_maxLevels = conf.data().get((Json::ArrayIndex)5, 8).asInt();
+    }
+
+    m_zigzag = ZigZag(name, timeframe, threshold, mode, atrLen);
+    m_maxLevels = o3d::max(m_maxLevels, 1);
+}
+
+void AtrSR::setConf(IndicatorConfig conf)
+{
+    o3d::Double threshold = 3.0;
+    ZigZag::Mode mode = ZigZag::MODE_ATR;
+    o3d::Int32 atrLen = 14;
+
+    if (conf.data().isObject()) {
+        threshold = conf.data().get("threshold", 3.0).asDouble();
+        mode = ZigZag::modeFromStr(conf.data().get("mode", "atr").asString().c_str());
+        atrLen = conf.data().get("atr-len", 14).asInt();
+        m_tolerance = conf.data().get("tolerance", 0.5).asDouble();
+        m_maxLevels = conf.data().get("max-levels", 8).asInt();
+    } else if (conf.data().isArray()) {
+        threshold = conf.data().get((Json::ArrayIndex)1, 3.0).asDouble();
+        mode = ZigZag::modeFromStr(conf.data().get((Json::ArrayIndex)2, "atr").asString().c_str());
+        atrLen = conf.data().get((Json::ArrayIndex)3, 14).asInt();
+        m_tolerance = conf.data().get((Json::ArrayIndex)4, 0.5).asDouble();
+        m_maxLevels = conf.data().get((Json::ArrayIndex)5, 8).asInt();
+    }
+
+    m_zigzag = ZigZag(name(), timeframe(), threshold, mode, atrLen);
+    m_maxLevels = o3d::max(m_maxLevels, 1);
+
+    reset();
+}
+
+const AtrSR::Level *AtrSR::support(o3d::Double price) const
+{
+    const Level *nearest = nullptr;
+
+    for (const Level &level : m_levels) {
+        if (level.direction < 0 && level.price <= price && (!nearest || level.price > nearest->price)) {
+            nearest = &level;
+        }
+    }
+
+    return nearest;
+}
+
+const AtrSR::Level *AtrSR::resistance(o3d::Double price) const
+{
+    const Level *nearest = nullptr;
+
+    for (const Level &level : m_levels) {
+        if (level.direction > 0 && level.price >= price && (!nearest || level.price < nearest->price)) {
+            nearest = &level;
+        }
+    }
+
+    return nearest;
+}
+
+void AtrSR::reset()
+{
+    m_zigzag.reset();
+    m_levels.clear();
+    m_levels.reserve(m_maxLevels);
+
+    m_lastBarTimestamp = 0.0;
+}
+
+void AtrSR::update(o3d::Double timestamp, o3d::Double high, o3d::Double low, o3d::Double close)
+{
+    if (m_zigzag.update(timestamp, high, low, close)) {
+        addPivot(m_zigzag.pivots().back());
+    }
+
+    // broken levels invert their role
+    const o3d::Double tolerance = m_tolerance * m_zigzag.atr();
+
+    for (Level &level : m_levels) {
+        if (level.direction > 0 && close > level.price + tolerance) {
+            level.direction = -1;
+            level.lastTimestamp = timestamp;
+        } else if (level.direction < 0 && close < level.price - tolerance) {
+            level.direction = 1;
+            level.lastTimestamp = timestamp;
+        }
+    }
+}
+
+void AtrSR::compute(o3d::Double timestamp, const DataArray &timestamps,
+                    const DataArray &high, const DataArray &low, const DataArray &close)
+{
+    const o3d::Int32 last = timestamps.getSize() - 1;
+
+    for (o3d::Int32 i = ZigZag::firstNewBar(timestamps, m_lastBarTimestamp); i < last; ++i) {
+        update(timestamps[i], high[i], low[i], close[i]);
+        m_lastBarTimestamp = timestamps[i];
+    }
+
+    done(timestamp);
+}
+
+o3d::Int32 AtrSR::lookback() const
+{
+    return m_zigzag.lookback();
+}
+
+void AtrSR::saveState(SnapshotWriter &writer) const
+{
+    writer.writeDouble(m_tolerance);
+    writer.writeInt32(m_maxLevels);
+
+    writer.writeDouble(lastTimestamp());
+
+    m_zigzag.saveState(writer);
+
+    writer.writeInt32(static_cast<o3d::Int32>(m_levels.size()));
+
+    for (const Level &level : m_levels) {
+        writer.writeDouble(level.price);
+        writer.writeInt32(level.direction);
+        writer.writeInt32(level.touches);
+        writer.writeDouble(level.timestamp);
+        writer.writeDouble(level.lastTimestamp);
+    }
+
+    writer.writeDouble(m_lastBarTimestamp);
+}
+
+o3d::Bool AtrSR::loadState(SnapshotReader &reader)
+{
+    if (reader.readDouble() != m_tolerance || reader.readInt32() != m_maxLevels) {
+        return false;
+    }
+
+    reset();
+
+    const o3d::Double timestamp = reader.readDouble();
+
+    if (!m_zigzag.loadState(reader)) {
+        return false;
+    }
+
+    const o3d::Int32 numLevels = reader.readInt32();
+    if (reader.failed() || numLevels < 0 || numLevels > m_maxLevels) {
+        reset();
+        return false;
+    }
+
+    for (o3d::Int32 i = 0; i < numLevels; ++i) {
+        Level level;
+
+        level.price = reader.readDouble();
+        level.direction = reader.readInt32();
+        level.touches = reader.readInt32();
+        level.timestamp = reader.readDouble();
+        level.lastTimestamp = reader.readDouble();
+
+        m_levels.push_back(level);
+    }
+
+    m_lastBarTimestamp = reader.readDouble();
+
+    if (reader.failed()) {
+        reset();
+        return false;
+    }
+
+    done(timestamp);
+
+    return true;
+}
+
+void AtrSR::addPivot(const ZigZag::Pivot &pivot)
+{
+    const o3d::Double tolerance = m_tolerance * m_zigzag.atr();
+
+    Level *nearest = nullptr;
+    Level *oldest = nullptr;
+
+    for (Level &level : m_levels) {
+        if (o3d::abs(level.price - pivot.price) <= tolerance &&
+            (!nearest || o3d::abs(level.price - pivot.price) < o3d::abs(nearest->price - pivot.price))) {
+            nearest = &level;
+        }
+
+        if (!oldest || level.lastTimestamp < oldest->lastTimestamp) {
+            oldest = &level;
+        }
+    }
+
+    if (nearest) {
+        // touch, the price of the level is the mean of its pivots
+        nearest->price += (pivot.price - nearest->price) / (nearest->touches + 1);
+        nearest->direction = pivot.direction;
+        nearest->lastTimestamp = pivot.timestamp;
+        ++nearest->touches;
+
+        return;
+    }
+
+    Level *level = nullptr;
+
+    if (static_cast<o3d::Int32>(m_levels.size()) < m_maxLevels) {
+        m_levels.push_back(Level());
+        level = &m_levels.back();
+    } else {
+        // replace the least recently touched
+        level = oldest;
+    }
+
+    level->price = pivot.price;
+    level->direction = pivot.direction;
+    level->touches = 1;
+    level->timestamp = pivot.timestamp;
+    level->lastTimestamp = pivot.timestamp;
+}
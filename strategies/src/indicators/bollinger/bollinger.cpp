@@ -7,6 +7,7 @@
 
 #include "siis/indicators/bollinger/bollinger.h"
 #include "siis/utils/common.h"
+#include "siis/utils/snapshot.h"
 
 #include <ta-lib/ta_func.h>
 
@@ -25,6 +26,7 @@ Bollinger::Bollinger(const o3d::String &name,
     m_maType(maType),
     m_numDevUp(numDevUp),
     m_numDevDn(numDevDn),
+    m_native(len, numDevUp, numDevDn, NativeMa::supported(maType) ? maType : MA_SMA),
     m_prevUpper(0.0),
     m_lastUpper(0.0),
     m_prevMiddle(0.0),
@@ -59,6 +61,8 @@ Bollinger::Bollinger(const o3d::String &name, o3d::Double timeframe, IndicatorCo
         m_numDevUp = 2.0;
         m_numDevDn = 2.0;
     }
+
+    m_native.setup(m_len, m_numDevUp, m_numDevDn, NativeMa::supported(m_maType) ? m_maType : MA_SMA);
 }
 
 void Bollinger::setConf(IndicatorConfig conf)
@@ -76,9 +80,21 @@ void Bollinger::setConf(IndicatorConfig conf)
 //        m_numDevUp = 2.0;
 //        m_numDevDn = 2.0;
     }
+
+    m_native.setup(m_len, m_numDevUp, m_numDevDn, NativeMa::supported(m_maType) ? m_maType : MA_SMA);
 }
 
 void Bollinger::compute(o3d::Double timestamp, const DataArray &price)
+{
+    compute(timestamp, nullptr, price);
+}
+
+void Bollinger::compute(o3d::Double timestamp, const DataArray &timestamps, const DataArray &price)
+{
+    compute(timestamp, &timestamps, price);
+}
+
+void Bollinger::compute(o3d::Double timestamp, const DataArray *timestamps, const DataArray &price)
 {
     o3d::Int32 lb = lookback();
     if (price.getSize() <= lb) {
@@ -89,28 +105,124 @@ void Bollinger::compute(o3d::Double timestamp, const DataArray &price)
     m_prevMiddle = m_lastMiddle;
     m_prevLower = m_lastLower;
 
-    if (m_upper.getSize() != price.getSize()) {
-        m_upper.setSize(price.getSize());
-        m_middle.setSize(price.getSize());
-        m_lower.setSize(price.getSize());
+    if (backend() == BACKEND_TALIB || !NativeMa::supported(m_maType)) {
+        computeTaLib(price, m_upper, m_middle, m_lower);
+    } else {
+        computeNative(timestamps, price);
+
+        if (backend() == BACKEND_VERIFY) {
+            DataArray upper, middle, lower;
+            computeTaLib(price, upper, middle, lower);
+
+            const o3d::Double tolerance = m_maType == MA_EMA ? NativeFeed::RECURSIVE_TOLERANCE :
+                                                               NativeFeed::WINDOW_TOLERANCE;
+
+            NativeFeed::verify(*this, "upper", m_upper.getLast(), upper.getLast(), tolerance);
+            NativeFeed::verify(*this, "middle", m_middle.getLast(), middle.getLast(), tolerance);
+            NativeFeed::verify(*this, "lower", m_lower.getLast(), lower.getLast(), tolerance);
+        }
+    }
+
+    m_lastUpper = m_upper.getLast();
+    m_lastMiddle = m_middle.getLast();
+    m_lastLower = m_lower.getLast();
+
+    done(timestamp);
+}
+
+void Bollinger::computeNative(const DataArray *timestamps, const DataArray &price)
+{
+    // only the bars since the previous compute, the last one being the forming bar
+    const o3d::Int32 from = m_feed.compute(timestamps, price.getSize());
+    if (m_feed.restarted()) {
+        m_native.reset();
+    }
+
+    m_feed.align(m_upper);
+    m_feed.align(m_middle);
+    m_feed.align(m_lower);
+
+    const o3d::Int32 last = price.getSize() - 1;
+    NativeBollinger::Value value;
+
+    for (o3d::Int32 i = from; i < last; ++i) {
+        value = m_native.update(price[i]);
+
+        m_upper[i] = value.upper;
+        m_middle[i] = value.middle;
+        m_lower[i] = value.lower;
+    }
+
+    value = m_native.updateProvisional(price[last]);
+
+    m_upper[last] = value.upper;
+    m_middle[last] = value.middle;
+    m_lower[last] = value.lower;
+}
+
+void Bollinger::computeTaLib(const DataArray &price, DataArray &upper, DataArray &middle, DataArray &lower) const
+{
+    o3d::Int32 lb = lookback();
+
+    if (upper.getSize() != price.getSize()) {
+        upper.setSize(price.getSize());
+        middle.setSize(price.getSize());
+        lower.setSize(price.getSize());
     }
 
     int b, n;
     TA_RetCode res = ::TA_BBANDS(0, price.getSize()-1, price.getData(), m_len,
                                  m_numDevUp, m_numDevDn,
                                  static_cast<TA_MAType>(m_maType),
-                                 &b, &n, m_upper.getData()+lb, m_middle.getData()+lb, m_lower.getData()+lb);
+                                 &b, &n, upper.getData()+lb, middle.getData()+lb, lower.getData()+lb);
     if (res != TA_SUCCESS) {
         O3D_WARNING(siis::taErrorToStr(res));
     }
 
     O3D_ASSERT(b == lb);
+}
 
-    m_lastUpper = m_upper.getLast();
-    m_lastMiddle = m_middle.getLast();
-    m_lastLower = m_lower.getLast();
+void Bollinger::saveState(SnapshotWriter &writer) const
+{
+    writer.writeDouble(lastTimestamp());
+
+    writer.writeArray(m_upper);
+    writer.writeArray(m_middle);
+    writer.writeArray(m_lower);
+    writer.writeDouble(m_prevUpper);
+    writer.writeDouble(m_lastUpper);
+    writer.writeDouble(m_prevMiddle);
+    writer.writeDouble(m_lastMiddle);
+    writer.writeDouble(m_prevLower);
+    writer.writeDouble(m_lastLower);
+
+    m_native.saveState(writer);
+    m_feed.saveState(writer);
+}
+
+o3d::Bool Bollinger::loadState(SnapshotReader &reader)
+{
+    const o3d::Double timestamp = reader.readDouble();
+
+    reader.readArray(m_upper);
+    reader.readArray(m_middle);
+    reader.readArray(m_lower);
+    m_prevUpper = reader.readDouble();
+    m_lastUpper = reader.readDouble();
+    m_prevMiddle = reader.readDouble();
+    m_lastMiddle = reader.readDouble();
+    m_prevLower = reader.readDouble();
+    m_lastLower = reader.readDouble();
+
+    // else the native state is computed again from the next compute
+    if (!m_native.loadState(reader) || !m_feed.loadState(reader)) {
+        m_feed.reset();
+        return false;
+    }
 
     done(timestamp);
+
+    return true;
 }
 
 o3d::Int32 Bollinger::lookback() const
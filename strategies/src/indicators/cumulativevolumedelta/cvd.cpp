@@ -8,6 +8,7 @@
 #include "siis/indicators/cumulativevolumedelta/cvd.h"
 #include "siis/utils/common.h"
 #include "siis/utils/math.h"
+#include "siis/utils/snapshot.h"
 
 using namespace siis;
 using o3d::Logger;
@@ -183,6 +184,53 @@ void CumulativeVolumeDelta::update(const Tick &tick, o3d::Bool finalize)
     done(tick.timestamp());
 }
 
+void CumulativeVolumeDelta::saveState(SnapshotWriter &writer) const
+{
+    writer.writeDouble(m_cvdTimeframe);
+    writer.writeInt32(m_depth);
+
+    writer.writeDouble(lastTimestamp());
+    writer.writeDouble(m_openTimestamp);
+
+    writer.writeDouble(m_prevTickPrice);
+    writer.writeInt32(m_prevTickDir);
+    writer.writeDouble(m_tmpCvd);
+
+    writer.writeCircular(m_cvd);
+
+    writer.writeDouble(m_prev);
+    writer.writeDouble(m_last);
+}
+
+o3d::Bool CumulativeVolumeDelta::loadState(SnapshotReader &reader)
+{
+    if (reader.readDouble() != m_cvdTimeframe || reader.readInt32() != m_depth) {
+        return false;
+    }
+
+    const o3d::Double timestamp = reader.readDouble();
+    m_openTimestamp = reader.readDouble();
+
+    m_prevTickPrice = reader.readDouble();
+    m_prevTickDir = reader.readInt32();
+    m_tmpCvd = reader.readDouble();
+
+    // at least the current value
+    if (!reader.readCircular(m_cvd) || m_cvd.size() == 0) {
+        m_cvd.clear();
+        m_cvd.append(0.0);
+
+        return false;
+    }
+
+    m_prev = reader.readDouble();
+    m_last = reader.readDouble();
+
+    done(timestamp);
+
+    return !reader.failed();
+}
+
 void CumulativeVolumeDelta::finalize()
 {
     m_cvd.append(m_cvd.back());
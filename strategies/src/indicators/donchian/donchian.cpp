@@ -17,6 +17,8 @@ using o3d::Debug;
 Donchian::Donchian(const o3d::String &name, o3d::Double timeframe, o3d::Int32 len) :
     Indicator (name, timeframe),
     m_len(len),
+    m_highest(RollingExtremum::MODE_MAX, len),
+    m_lowest(RollingExtremum::MODE_MIN, len),
     m_prevUpper(0.0),
     m_lastUpper(0.0),
     m_prevLower(0.0),
@@ -27,6 +29,8 @@ Donchian::Donchian(const o3d::String &name, o3d::Double timeframe, o3d::Int32 le
 Donchian::Donchian(const o3d::String &name, o3d::Double timeframe, IndicatorConfig conf) :
     Indicator (name, timeframe),
     m_len(0),
+    m_highest(RollingExtremum::MODE_MAX),
+    m_lowest(RollingExtremum::MODE_MIN),
     m_prevUpper(0.0),
     m_lastUpper(0.0),
     m_prevLower(0.0),
@@ -37,6 +41,9 @@ Donchian::Donchian(const o3d::String &name, o3d::Double timeframe, IndicatorConf
     } else if (conf.data().isArray()) {
         m_len = conf.data().get((Json::ArrayIndex)1, 14).asInt();
     }
+
+    m_highest.setLen(m_len);
+    m_lowest.setLen(m_len);
 }
 
 void Donchian::setConf(IndicatorConfig conf)
@@ -46,6 +53,9 @@ void Donchian::setConf(IndicatorConfig conf)
     } else if (conf.data().isArray()) {
         m_len = conf.data().get((Json::ArrayIndex)1, 14).asInt();
     }
+
+    m_highest.setLen(m_len);
+    m_lowest.setLen(m_len);
 }
 
 void Donchian::compute(o3d::Double timestamp, const DataArray &high, const DataArray &low)
@@ -62,26 +72,12 @@ void Donchian::compute(o3d::Double timestamp, const DataArray &high, const DataA
     m_prevUpper = m_lastUpper;
     m_prevLower = m_lastLower;
 
-    if (m_upper.getSize() != high.getSize()) {
-        m_upper.setSize(high.getSize());
-        m_lower.setSize(high.getSize());
-    }
-
-    int b, n;
-    TA_RetCode res = ::TA_MAX(0, high.getSize()-1, high.getData(), m_len, &b, &n, m_upper.getData()+lb);
-    if (res != TA_SUCCESS) {
-        O3D_WARNING(siis::taErrorToStr(res));
-    }
-
-    res = ::TA_MIN(0, low.getSize()-1, low.getData(), m_len, &b, &n, m_lower.getData()+lb);
-    if (res != TA_SUCCESS) {
-        O3D_WARNING(siis::taErrorToStr(res));
-    }
-
-    O3D_ASSERT(b == 0);
+    // same results as TA_MAX and TA_MIN, updating only the forming and the new bars
+    m_highest.compute(high);
+    m_lowest.compute(low);
 
-    m_lastUpper = m_upper.getLast();
-    m_lastLower = m_lower.getLast();
+    m_lastUpper = m_highest.last();
+    m_lastLower = m_lowest.last();
     done(timestamp);
 }
 
@@ -23,6 +23,12 @@ Ichimoku::Ichimoku(const o3d::String &name,
     m_tenkanLen(tenkanLen),
     m_kijunLen(kijunLen),
     m_senkouSpanBLen(senkouSpanBLen),
+    m_tenkanHighest(RollingExtremum::MODE_MAX, tenkanLen),
+    m_tenkanLowest(RollingExtremum::MODE_MIN, tenkanLen),
+    m_kijunHighest(RollingExtremum::MODE_MAX, kijunLen),
+    m_kijunLowest(RollingExtremum::MODE_MIN, kijunLen),
+    m_ssbHighest(RollingExtremum::MODE_MAX, senkouSpanBLen),
+    m_ssbLowest(RollingExtremum::MODE_MIN, senkouSpanBLen),
     m_prevTenkan(0.0),
     m_prevKijun(0.0),
     m_prevSsa(0.0),
@@ -42,6 +48,12 @@ Ichimoku::Ichimoku(const o3d::String &name, o3d::Double timeframe, IndicatorConf
     m_tenkanLen(9),
     m_kijunLen(26),
     m_senkouSpanBLen(52),
+    m_tenkanHighest(RollingExtremum::MODE_MAX),
+    m_tenkanLowest(RollingExtremum::MODE_MIN),
+    m_kijunHighest(RollingExtremum::MODE_MAX),
+    m_kijunLowest(RollingExtremum::MODE_MIN),
+    m_ssbHighest(RollingExtremum::MODE_MAX),
+    m_ssbLowest(RollingExtremum::MODE_MIN),
     m_prevTenkan(0.0),
     m_prevKijun(0.0),
     m_prevSsa(0.0),
@@ -62,6 +74,13 @@ Ichimoku::Ichimoku(const o3d::String &name, o3d::Double timeframe, IndicatorConf
         m_kijunLen = conf.data().get((Json::ArrayIndex)2, 26).asInt();
         m_senkouSpanBLen = conf.data().get((Json::ArrayIndex)3, 52).asInt();
     }
+
+    m_tenkanHighest.setLen(m_tenkanLen);
+    m_tenkanLowest.setLen(m_tenkanLen);
+    m_kijunHighest.setLen(m_kijunLen);
+    m_kijunLowest.setLen(m_kijunLen);
+    m_ssbHighest.setLen(m_senkouSpanBLen);
+    m_ssbLowest.setLen(m_senkouSpanBLen);
 }
 
 void Ichimoku::setConf(IndicatorConfig conf)
@@ -75,6 +94,13 @@ void Ichimoku::setConf(IndicatorConfig conf)
         m_kijunLen = conf.data().get((Json::ArrayIndex)2, 26).asInt();
         m_senkouSpanBLen = conf.data().get((Json::ArrayIndex)3, 52).asInt();
     }
+
+    m_tenkanHighest.setLen(m_tenkanLen);
+    m_tenkanLowest.setLen(m_tenkanLen);
+    m_kijunHighest.setLen(m_kijunLen);
+    m_kijunLowest.setLen(m_kijunLen);
+    m_ssbHighest.setLen(m_senkouSpanBLen);
+    m_ssbLowest.setLen(m_senkouSpanBLen);
 }
 
 void Ichimoku::compute(o3d::Double timestamp, const DataArray &high, const DataArray &low, const DataArray &close)
@@ -99,23 +125,10 @@ void Ichimoku::compute(o3d::Double timestamp, const DataArray &high, const DataA
         m_chikou.setSize(close.getSize());
     }
 
-    lb = ::TA_MIDPRICE_Lookback(m_tenkanLen);
-    int b, n;
-    TA_RetCode res = ::TA_MIDPRICE(0, close.getSize()-1, high.getData(), low.getData(), m_tenkanLen, &b, &n, m_tenkan.getData()+lb);
-    if (res != TA_SUCCESS) {
-        O3D_WARNING(siis::taErrorToStr(res));
-    }
+    midPrice(m_tenkanHighest, m_tenkanLowest, high, low, m_tenkan);
 
-    O3D_ASSERT(b == lb);
-
-    // kijun-sen - base-line (window of 9)
-    lb = ::TA_MIDPRICE_Lookback(m_kijunLen);
-    res = ::TA_MIDPRICE(0, close.getSize()-1, high.getData(), low.getData(), m_kijunLen, &b, &n, m_kijun.getData()+lb);
-    if (res != TA_SUCCESS) {
-        O3D_WARNING(siis::taErrorToStr(res));
-    }
-
-    O3D_ASSERT(b == lb);
+    // kijun-sen - base-line (window of 26)
+    midPrice(m_kijunHighest, m_kijunLowest, high, low, m_kijun);
 
     // senkou span A - leading span A
 
@@ -123,13 +136,7 @@ void Ichimoku::compute(o3d::Double timestamp, const DataArray &high, const DataA
     m_ssa = (m_tenkan + m_kijun) * 0.5;
 
     // senkou span B - leading span B
-    lb = ::TA_MIDPRICE_Lookback(m_senkouSpanBLen);
-    res = ::TA_MIDPRICE(0, close.getSize()-1, high.getData(), low.getData(), m_senkouSpanBLen, &b, &n, m_ssb.getData()+lb);
-    if (res != TA_SUCCESS) {
-        O3D_WARNING(siis::taErrorToStr(res));
-    }
-
-    O3D_ASSERT(b == lb);
+    midPrice(m_ssbHighest, m_ssbLowest, high, low, m_ssb);
 
     m_lastTenkan = m_tenkan.last();
     m_lastKijun = m_kijun.last();
@@ -144,3 +151,18 @@ o3d::Int32 Ichimoku::lookback() const
 {
     return m_senkouSpanBLen - 1;
 }
+
+void Ichimoku::midPrice(RollingExtremum &highest, RollingExtremum &lowest,
+                        const DataArray &high, const DataArray &low, DataArray &out)
+{
+    // the kernels only update the windows of the new values, the sum is cheap for the whole array
+    highest.compute(high);
+    lowest.compute(low);
+
+    const o3d::Double *hh = highest.values().getData();
+    const o3d::Double *ll = lowest.values().getData();
+
+    for (o3d::Int32 i = highest.len() - 1; i < out.getSize(); ++i) {
+        out[i] = (hh[i] + ll[i]) / 2.0;
+    }
+}
@@ -89,12 +89,12 @@ void BarImbalance::compute(o3d::Double timestamp, const DataArray &timestamps,
         }
 
         for (o3d::Int32 i = baseIdx; i < endIdx; ++i) {
-            // o3d::Double curOpen = open[baseIdx];
-            // o3d::Double curClose = close[baseIdx];
+            // o3d::Double curOpen = open[i];
+            // o3d::Double curClose = close[i];
 
             // lookup for upper imbalance
-            o3d::Double prevHigh = high[baseIdx-1];
-            o3d::Double nextLow  = low[baseIdx+1];
+            o3d::Double prevHigh = high[i-1];
+            o3d::Double nextLow  = low[i+1];
 
             if (nextLow > prevHigh) {
                 //if (curOpen <= prevHigh && curClose >= nextLow) {
@@ -107,13 +107,13 @@ void BarImbalance::compute(o3d::Double timestamp, const DataArray &timestamps,
                     imbalance.direction = 1;
                     imbalance.lowPrice = prevHigh;
                     imbalance.highPrice = nextLow;
-                    imbalance.barTimestamp = timestamps[baseIdx];
+                    imbalance.barTimestamp = timestamps[i];
                 }
             }
 
             // lookup for downer imbalance
-            o3d::Double prevLow= low[baseIdx-1];
-            o3d::Double nextHigh= high[baseIdx+1];
+            o3d::Double prevLow= low[i-1];
+            o3d::Double nextHigh= high[i+1];
 
             if (nextHigh < prevLow) {
                 //if (curOpen >= prevLow && curClose <= nextHigh) {
@@ -124,29 +124,20 @@ void BarImbalance::compute(o3d::Double timestamp, const DataArray &timestamps,
                     Imbalance &imbalance = m_foundImbalances.back();
 
                     imbalance.direction = -1;
-                    imbalance.lowPrice = prevLow;
-                    imbalance.highPrice = nextHigh;
-                    imbalance.barTimestamp = timestamps[baseIdx];
+                    imbalance.lowPrice = nextHigh;
+                    imbalance.highPrice = prevLow;
+                    imbalance.barTimestamp = timestamps[i];
                 }
             }
         }
     }
 
-    // update previous
-    T_Imbalance previousImbalances = updateImbalances(m_imbalances, high, low, numLastBars);
-//    if (previousImbalances.size() != m_imbalances.size()) {
-//        printf("%s %i %i\n", timestampToStr(timestamp).toAscii().getData(), previousImbalances.size(), m_imbalances.size());
-//    }
+    // update previous, in place
+    updateImbalances(high, low, numLastBars);
 
     // keep filtered previous and newly found
-    m_imbalances = previousImbalances;
-
-    if (m_foundImbalances.size()) {
-        if (m_imbalances.empty()) {
-            m_imbalances = m_foundImbalances;
-        } else {
-            m_imbalances.insert(m_imbalances.end(), m_foundImbalances.begin(), m_foundImbalances.end());
-        }
+    for (const Imbalance &imbalance : m_foundImbalances) {
+        m_imbalances.add(imbalance);
     }
 
     done(timestamp);
@@ -157,13 +148,8 @@ o3d::Int32 BarImbalance::lookback() const
     return 4;
 }
 
-BarImbalance::T_Imbalance BarImbalance::updateImbalances(T_Imbalance &imbalances,
-                                    const DataArray &high, const DataArray &low,
-                                    o3d::Int32 numLastBars)
+void BarImbalance::updateImbalances(const DataArray &high, const DataArray &low, o3d::Int32 numLastBars)
 {
-    T_Imbalance newList;
-    o3d::Bool keep;
-
     // merge bars high/low
     o3d::Int32 i = o3d::max(0, high.getSize() - numLastBars);
 
@@ -177,34 +163,28 @@ BarImbalance::T_Imbalance BarImbalance::updateImbalances(T_Imbalance &imbalances
         lowPrice = o3d::min(lowPrice, low[i]);
     }
 
-    // reduce and remove filled imbalances
-    for (Imbalance imbalance : imbalances) {
-        keep = true;
-
+    // reduce and remove filled imbalances, only the overlapping ones are visited
+    m_imbalances.update(lowPrice, highPrice, [lowPrice, highPrice](Imbalance &imbalance) {
         if (lowPrice > imbalance.lowPrice && highPrice < imbalance.highPrice) {
             // the bar is inside, it cancels and potentially could create 2 news one
-            keep = false;
+            return false;
         } else if (lowPrice <= imbalance.lowPrice && highPrice >= imbalance.highPrice) {
             // the bar eat the imbalance, it cancels the imbalance
-            keep = false;
+            return false;
         } else if (lowPrice <= imbalance.lowPrice && highPrice > imbalance.lowPrice) {
             // partially inside (low part), reduce the lower part
             imbalance.lowPrice = highPrice;
             if (imbalance.lowPrice >= imbalance.highPrice) {
-                keep = false;
+                return false;
             }
         } else if (highPrice >= imbalance.highPrice && lowPrice < imbalance.highPrice) {
             // partially inside (high part), reduce the higher part
             imbalance.highPrice = lowPrice;
             if (imbalance.lowPrice >= imbalance.highPrice) {
-                keep = false;
+                return false;
             }
         }
 
-        if (keep) {
-            newList.push_back(imbalance);
-        }
-    }
-
-    return newList;
+        return true;
+    });
 }
@@ -7,6 +7,7 @@
 
 #include "siis/indicators/macd/macd.h"
 #include "siis/utils/common.h"
+#include "siis/utils/snapshot.h"
 
 #include <ta-lib/ta_func.h>
 
@@ -19,6 +20,7 @@ Macd::Macd(const o3d::String &name, o3d::Double timeframe, o3d::Int32 fastLen, o
     m_fastLen(fastLen),
     m_slowLen(slowLen),
     m_signalLen(signalLen),
+    m_native(fastLen, slowLen, signalLen),
     m_prev_macd(0.0),
     m_last_macd(0.0),
     m_prev_signal(0.0),
@@ -45,6 +47,8 @@ Macd::Macd(const o3d::String &name, o3d::Double timeframe, IndicatorConfig conf)
         m_slowLen = conf.data().get((Json::ArrayIndex)2, 12).asInt();
         m_signalLen = conf.data().get((Json::ArrayIndex)3, 9).asInt();
     }
+
+    m_native.setup(m_fastLen, m_slowLen, m_signalLen);
 }
 
 void Macd::setConf(IndicatorConfig conf)
@@ -58,9 +62,21 @@ void Macd::setConf(IndicatorConfig conf)
         m_slowLen = conf.data().get((Json::ArrayIndex)2, 12).asInt();
         m_signalLen = conf.data().get((Json::ArrayIndex)3, 9).asInt();
     }
+
+    m_native.setup(m_fastLen, m_slowLen, m_signalLen);
 }
 
 void Macd::compute(o3d::Double timestamp, const DataArray &price)
+{
+    compute(timestamp, nullptr, price);
+}
+
+void Macd::compute(o3d::Double timestamp, const DataArray &timestamps, const DataArray &price)
+{
+    compute(timestamp, &timestamps, price);
+}
+
+void Macd::compute(o3d::Double timestamp, const DataArray *timestamps, const DataArray &price)
 {
     o3d::Int32 lb = lookback();
     if (price.getSize() <= lb) {
@@ -70,26 +86,114 @@ void Macd::compute(o3d::Double timestamp, const DataArray &price)
     m_prev_macd = m_last_macd;
     m_prev_signal = m_last_signal;
 
-    if (m_macd.getSize() != price.getSize()) {
-        m_macd.setSize(price.getSize());
-        m_signal.setSize(price.getSize());
-        m_hist.setSize(price.getSize());
+    if (backend() == BACKEND_TALIB) {
+        computeTaLib(price, m_macd, m_signal, m_hist);
+    } else {
+        computeNative(timestamps, price);
+
+        if (backend() == BACKEND_VERIFY) {
+            DataArray macd, signal, hist;
+            computeTaLib(price, macd, signal, hist);
+
+            NativeFeed::verify(*this, "macd", m_macd.getLast(), macd.getLast(), NativeFeed::RECURSIVE_TOLERANCE);
+            NativeFeed::verify(*this, "signal", m_signal.getLast(), signal.getLast(), NativeFeed::RECURSIVE_TOLERANCE);
+        }
+    }
+
+    m_last_macd = m_macd.getLast();
+    m_last_signal = m_signal.getLast();
+
+    done(timestamp);
+}
+
+void Macd::computeNative(const DataArray *timestamps, const DataArray &price)
+{
+    // only the bars since the previous compute, the last one being the forming bar
+    const o3d::Int32 from = m_feed.compute(timestamps, price.getSize());
+    if (m_feed.restarted()) {
+        m_native.reset();
+    }
+
+    m_feed.align(m_macd);
+    m_feed.align(m_signal);
+    m_feed.align(m_hist);
+
+    const o3d::Int32 last = price.getSize() - 1;
+    NativeMacd::Value value;
+
+    for (o3d::Int32 i = from; i < last; ++i) {
+        value = m_native.update(price[i]);
+
+        m_macd[i] = value.macd;
+        m_signal[i] = value.signal;
+        m_hist[i] = value.hist;
+    }
+
+    value = m_native.updateProvisional(price[last]);
+
+    m_macd[last] = value.macd;
+    m_signal[last] = value.signal;
+    m_hist[last] = value.hist;
+}
+
+void Macd::computeTaLib(const DataArray &price, DataArray &macd, DataArray &signal, DataArray &hist) const
+{
+    o3d::Int32 lb = lookback();
+
+    if (macd.getSize() != price.getSize()) {
+        macd.setSize(price.getSize());
+        signal.setSize(price.getSize());
+        hist.setSize(price.getSize());
     }
 
     int b, n;
     TA_RetCode res = ::TA_MACD(0, price.getSize()-1, price.getData(),
                                m_fastLen, m_slowLen, m_signalLen,
-                               &b, &n, m_macd.getData()+lb, m_signal.getData()+lb, m_hist.getData()+lb);
+                               &b, &n, macd.getData()+lb, signal.getData()+lb, hist.getData()+lb);
     if (res != TA_SUCCESS) {
         O3D_WARNING(siis::taErrorToStr(res));
     }
 
     O3D_ASSERT(b == lb);
+}
 
-    m_last_macd = m_macd.getLast();
-    m_last_signal = m_signal.getLast();
+void Macd::saveState(SnapshotWriter &writer) const
+{
+    writer.writeDouble(lastTimestamp());
+
+    writer.writeArray(m_macd);
+    writer.writeArray(m_signal);
+    writer.writeArray(m_hist);
+    writer.writeDouble(m_prev_macd);
+    writer.writeDouble(m_last_macd);
+    writer.writeDouble(m_prev_signal);
+    writer.writeDouble(m_last_signal);
+
+    m_native.saveState(writer);
+    m_feed.saveState(writer);
+}
+
+o3d::Bool Macd::loadState(SnapshotReader &reader)
+{
+    const o3d::Double timestamp = reader.readDouble();
+
+    reader.readArray(m_macd);
+    reader.readArray(m_signal);
+    reader.readArray(m_hist);
+    m_prev_macd = reader.readDouble();
+    m_last_macd = reader.readDouble();
+    m_prev_signal = reader.readDouble();
+    m_last_signal = reader.readDouble();
+
+    // else the native state is computed again from the next compute
+    if (!m_native.loadState(reader) || !m_feed.loadState(reader)) {
+        m_feed.reset();
+        return false;
+    }
 
     done(timestamp);
+
+    return true;
 }
 
 o3d::Int32 Macd::lookback() const
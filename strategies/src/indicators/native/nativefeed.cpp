@@ -0,0 +1,128 @@
+/**
+ * @brief SiiS native streaming indicators, feed of the price arrays.
+ * @copyright Copyright (C) 2024 SiiS
+ * @author Frederic SCHERMA (frederic.scherma@gmail.com)
+ * @date 2024-10-18
+ */
+
+#include "siis/indicators/native/nativefeed.h"
+#include "siis/indicators/indicator.h"
+#include "siis/utils/snapshot.h"
+
+#include <cmath>
+#include <cstring>
+
+using namespace siis;
+using o3d::Logger;
+using o3d::Debug;
+
+const o3d::Double NativeFeed::WINDOW_TOLERANCE = 1e-9;
+const o3d::Double NativeFeed::RECURSIVE_TOLERANCE = 1e-3;
+
+NativeFeed::NativeFeed() :
+    m_prevSize(0),
+    m_size(0),
+    m_shift(-1),
+    m_kept(0),
+    m_lastTimestamp(0.0),
+    m_lastCount(0)
+{
+}
+
+void NativeFeed::reset()
+{
+    m_prevSize = 0;
+    m_size = 0;
+    m_shift = -1;
+    m_kept = 0;
+    m_lastTimestamp = 0.0;
+    m_lastCount = 0;
+}
+
+void NativeFeed::saveState(SnapshotWriter &writer) const
+{
+    writer.writeInt32(m_prevSize);
+    writer.writeDouble(m_lastTimestamp);
+    writer.writeInt32(m_lastCount);
+}
+
+o3d::Bool NativeFeed::loadState(SnapshotReader &reader)
+{
+    m_prevSize = reader.readInt32();
+    m_lastTimestamp = reader.readDouble();
+    m_lastCount = reader.readInt32();
+
+    if (reader.failed() || m_prevSize < 0 || m_lastCount < 0 || m_lastCount > m_prevSize) {
+        reset();
+        return false;
+    }
+
+    return true;
+}
+
+o3d::Int32 NativeFeed::compute(const DataArray *timestamps, o3d::Int32 size)
+{
+    m_size = size;
+    m_shift = -1;
+    m_kept = 0;
+
+    if (timestamps == nullptr || timestamps->getSize() != size || size <= 0) {
+        m_prevSize = 0;
+        return 0;
+    }
+
+    const o3d::Double *ts = timestamps->getData();
+
+    // the previous bars of the timestamp of the previous forming bar must be preceded by an older one
+    if (m_prevSize > m_lastCount && m_lastCount > 0) {
+        o3d::Int32 first = size;
+        while (first > 0 && ts[first-1] >= m_lastTimestamp) {
+            --first;
+        }
+
+        // index of the previous forming bar
+        const o3d::Int32 prev = first + m_lastCount - 1;
+        const o3d::Int32 shift = m_prevSize - 1 - prev;
+
+        if (first > 0 && prev < size && ts[prev] == m_lastTimestamp && shift >= 0 && shift <= MAX_SHIFT) {
+            m_shift = shift;
+            m_kept = m_prevSize - shift;
+        }
+    }
+
+    const o3d::Int32 from = m_shift < 0 ? 0 : m_prevSize - 1 - m_shift;
+
+    m_lastTimestamp = ts[size-1];
+    m_lastCount = 1;
+
+    while (m_lastCount < size && ts[size-1-m_lastCount] == m_lastTimestamp) {
+        ++m_lastCount;
+    }
+
+    m_prevSize = size;
+
+    return from;
+}
+
+void NativeFeed::align(DataArray &out) const
+{
+    if (m_shift > 0 && out.getSize() >= m_shift + m_kept) {
+        // results of the same bars, before a possible growth of the array
+        memmove(out.getData(), out.getData() + m_shift, static_cast<size_t>(m_kept) * sizeof(o3d::Double));
+    }
+
+    if (out.getSize() != m_size) {
+        out.setSize(m_size);
+    }
+}
+
+void NativeFeed::verify(const Indicator &indicator, const o3d::String &output,
+                        o3d::Double native, o3d::Double reference, o3d::Double tolerance)
+{
+    const o3d::Double diff = std::fabs(native - reference);
+
+    if (!(diff <= tolerance * o3d::max(1.0, std::fabs(reference)))) {
+        O3D_WARNING(o3d::String("Native {0} {1} is {2} where TA-Lib gives {3}").arg(indicator.name()).arg(output)
+                    .arg(native).arg(reference));
+    }
+}
@@ -0,0 +1,369 @@
+/**
+ * @brief SiiS native streaming moving averages.
+ * @copyright Copyright (C) 2024 SiiS
+ * @author Frederic SCHERMA (frederic.scherma@gmail.com)
+ * @date 2024-10-18
+ */
+
+#include "siis/indicators/native/nativema.h"
+#include "siis/utils/snapshot.h"
+
+using namespace siis;
+
+//
+// NativeSma
+//
+
+NativeSma::NativeSma(o3d::Int32 len) :
+    m_len(0),
+    m_pos(0),
+    m_count(0),
+    m_sum(0.0)
+{
+    setLen(len);
+}
+
+void NativeSma::setLen(o3d::Int32 len)
+{
+    m_len = o3d::max(len, 1);
+    m_values.assign(static_cast<size_t>(m_len), 0.0);
+
+    reset();
+}
+
+void NativeSma::reset()
+{
+    m_pos = 0;
+    m_count = 0;
+    m_sum = 0.0;
+}
+
+void NativeSma::saveState(SnapshotWriter &writer) const
+{
+    writer.writeInt32(m_len);
+
+    writer.writeDoubles(m_values.data(), static_cast<o3d::Int32>(m_values.size()));
+    writer.writeInt32(m_pos);
+    writer.writeInt32(m_count);
+    writer.writeDouble(m_sum);
+}
+
+o3d::Bool NativeSma::loadState(SnapshotReader &reader)
+{
+    if (reader.readInt32() != m_len) {
+        return false;
+    }
+
+    reader.readDoubles(m_values.data(), static_cast<o3d::Int32>(m_values.size()));
+    m_pos = reader.readInt32();
+    m_count = reader.readInt32();
+    m_sum = reader.readDouble();
+
+    return !reader.failed();
+}
+
+o3d::Double NativeSma::update(o3d::Double value)
+{
+    if (m_count >= m_len) {
+        m_sum -= m_values[m_pos];
+    }
+
+    m_sum += value;
+    m_values[m_pos] = value;
+
+    if (++m_pos == m_len) {
+        m_pos = 0;
+
+        // exact sum of the window once per turn of the ring
+        m_sum = 0.0;
+        for (o3d::Int32 i = 0; i < m_len; ++i) {
+            m_sum += m_values[i];
+        }
+    }
+
+    ++m_count;
+
+    return m_count > lookback() ? m_sum / m_len : 0.0;
+}
+
+o3d::Double NativeSma::updateProvisional(o3d::Double value) const
+{
+    if (m_count < lookback()) {
+        return 0.0;
+    }
+
+    const o3d::Double sum = m_count >= m_len ? m_sum - m_values[m_pos] + value : m_sum + value;
+    return sum / m_len;
+}
+
+//
+// NativeEma
+//
+
+NativeEma::NativeEma(o3d::Int32 len) :
+    m_len(0),
+    m_k(0.0),
+    m_count(0),
+    m_sum(0.0),
+    m_ema(0.0)
+{
+    setLen(len);
+}
+
+void NativeEma::setLen(o3d::Int32 len)
+{
+    m_len = o3d::max(len, 1);
+    m_k = 2.0 / (m_len + 1);
+
+    reset();
+}
+
+void NativeEma::reset()
+{
+    m_count = 0;
+    m_sum = 0.0;
+    m_ema = 0.0;
+}
+
+void NativeEma::saveState(SnapshotWriter &writer) const
+{
+    writer.writeInt32(m_len);
+
+    writer.writeInt32(m_count);
+    writer.writeDouble(m_sum);
+    writer.writeDouble(m_ema);
+}
+
+o3d::Bool NativeEma::loadState(SnapshotReader &reader)
+{
+    if (reader.readInt32() != m_len) {
+        return false;
+    }
+
+    m_count = reader.readInt32();
+    m_sum = reader.readDouble();
+    m_ema = reader.readDouble();
+
+    return !reader.failed();
+}
+
+o3d::Double NativeEma::update(o3d::Double value)
+{
+    if (m_count < m_len) {
+        m_sum += value;
+
+        if (++m_count < m_len) {
+            return 0.0;
+        }
+
+        m_ema = m_sum / m_len;
+    } else {
+        m_ema = ((value - m_ema) * m_k) + m_ema;
+        ++m_count;
+    }
+
+    return m_ema;
+}
+
+o3d::Double NativeEma::updateProvisional(o3d::Double value) const
+{
+    if (m_count < lookback()) {
+        return 0.0;
+    } else if (m_count < m_len) {
+        return (m_sum + value) / m_len;
+    }
+
+    return ((value - m_ema) * m_k) + m_ema;
+}
+
+//
+// NativeWma
+//
+
+NativeWma::NativeWma(o3d::Int32 len) :
+    m_len(0),
+    m_divider(1.0),
+    m_pos(0),
+    m_count(0),
+    m_sum(0.0),
+    m_weightedSum(0.0)
+{
+    setLen(len);
+}
+
+void NativeWma::setLen(o3d::Int32 len)
+{
+    m_len = o3d::max(len, 1);
+    m_divider = static_cast<o3d::Double>((m_len * (m_len + 1)) >> 1);
+    m_values.assign(static_cast<size_t>(m_len), 0.0);
+
+    reset();
+}
+
+void NativeWma::reset()
+{
+    m_pos = 0;
+    m_count = 0;
+    m_sum = 0.0;
+    m_weightedSum = 0.0;
+}
+
+void NativeWma::saveState(SnapshotWriter &writer) const
+{
+    writer.writeInt32(m_len);
+
+    writer.writeDoubles(m_values.data(), static_cast<o3d::Int32>(m_values.size()));
+    writer.writeInt32(m_pos);
+    writer.writeInt32(m_count);
+    writer.writeDouble(m_sum);
+    writer.writeDouble(m_weightedSum);
+}
+
+o3d::Bool NativeWma::loadState(SnapshotReader &reader)
+{
+    if (reader.readInt32() != m_len) {
+        return false;
+    }
+
+    reader.readDoubles(m_values.data(), static_cast<o3d::Int32>(m_values.size()));
+    m_pos = reader.readInt32();
+    m_count = reader.readInt32();
+    m_sum = reader.readDouble();
+    m_weightedSum = reader.readDouble();
+
+    return !reader.failed();
+}
+
+o3d::Double NativeWma::update(o3d::Double value)
+{
+    if (m_count >= m_len) {
+        // each weight decreases by one, the oldest leaves with a weight of 0
+        m_weightedSum -= m_sum;
+        m_sum -= m_values[m_pos];
+
+        m_weightedSum += value * m_len;
+    } else {
+        m_weightedSum += value * (m_count + 1);
+    }
+
+    m_sum += value;
+    m_values[m_pos] = value;
+
+    if (++m_pos == m_len) {
+        m_pos = 0;
+
+        // exact sums of the window once per turn of the ring, oldest first
+        m_sum = 0.0;
+        m_weightedSum = 0.0;
+
+        for (o3d::Int32 i = 0; i < m_len; ++i) {
+            m_sum += m_values[i];
+            m_weightedSum += m_values[i] * (i + 1);
+        }
+    }
+
+    ++m_count;
+
+    return m_count > lookback() ? m_weightedSum / m_divider : 0.0;
+}
+
+o3d::Double NativeWma::updateProvisional(o3d::Double value) const
+{
+    if (m_count < lookback()) {
+        return 0.0;
+    } else if (m_count < m_len) {
+        return (m_weightedSum + value * m_len) / m_divider;
+    }
+
+    return (m_weightedSum - m_sum + value * m_len) / m_divider;
+}
+
+//
+// NativeMa
+//
+
+NativeMa::NativeMa(MAType maType, o3d::Int32 len) :
+    m_maType(MA_SMA),
+    m_len(1),
+    m_sma(1),
+    m_ema(1),
+    m_wma(1)
+{
+    setup(maType, len);
+}
+
+void NativeMa::setup(MAType maType, o3d::Int32 len)
+{
+    m_maType = maType;
+    m_len = o3d::max(len, 1);
+
+    m_sma.setLen(maType == MA_SMA ? m_len : 1);
+    m_ema.setLen(maType == MA_EMA ? m_len : 1);
+    m_wma.setLen(maType == MA_WMA ? m_len : 1);
+}
+
+void NativeMa::reset()
+{
+    m_sma.reset();
+    m_ema.reset();
+    m_wma.reset();
+}
+
+void NativeMa::saveState(SnapshotWriter &writer) const
+{
+    writer.writeInt32(static_cast<o3d::Int32>(m_maType));
+    writer.writeInt32(m_len);
+
+    m_sma.saveState(writer);
+    m_ema.saveState(writer);
+    m_wma.saveState(writer);
+}
+
+o3d::Bool NativeMa::loadState(SnapshotReader &reader)
+{
+    if (reader.readInt32() != static_cast<o3d::Int32>(m_maType) || reader.readInt32() != m_len) {
+        return false;
+    }
+
+    if (!m_sma.loadState(reader) || !m_ema.loadState(reader) || !m_wma.loadState(reader)) {
+        return false;
+    }
+
+    return !reader.failed();
+}
+
+o3d::Int32 NativeMa::count() const
+{
+    switch (m_maType) {
+        case MA_EMA:
+            return m_ema.count();
+        case MA_WMA:
+            return m_wma.count();
+        default:
+            return m_sma.count();
+    }
+}
+
+o3d::Double NativeMa::update(o3d::Double value)
+{
+    switch (m_maType) {
+        case MA_EMA:
+            return m_ema.update(value);
+        case MA_WMA:
+            return m_wma.update(value);
+        default:
+            return m_sma.update(value);
+    }
+}
+
+o3d::Double NativeMa::updateProvisional(o3d::Double value) const
+{
+    switch (m_maType) {
+        case MA_EMA:
+            return m_ema.updateProvisional(value);
+        case MA_WMA:
+            return m_wma.updateProvisional(value);
+        default:
+            return m_sma.updateProvisional(value);
+    }
+}
@@ -0,0 +1,463 @@
+/**
+ * @brief SiiS native streaming oscillators.
+ * @copyright Copyright (C) 2024 SiiS
+ * @author Frederic SCHERMA (frederic.scherma@gmail.com)
+ * @date 2024-10-18
+ */
+
+#include "siis/indicators/native/nativeoscillator.h"
+#include "siis/utils/snapshot.h"
+
+#include <cmath>
+
+using namespace siis;
+
+//
+// NativeRsi
+//
+
+NativeRsi::NativeRsi(o3d::Int32 len) :
+    m_len(0)
+{
+    setLen(len);
+}
+
+void NativeRsi::setLen(o3d::Int32 len)
+{
+    m_len = o3d::max(len, 1);
+
+    reset();
+}
+
+void NativeRsi::reset()
+{
+    m_state.count = 0;
+    m_state.prevValue = 0.0;
+    m_state.gain = 0.0;
+    m_state.loss = 0.0;
+}
+
+void NativeRsi::saveState(SnapshotWriter &writer) const
+{
+    writer.writeInt32(m_len);
+
+    writer.writeInt32(m_state.count);
+    writer.writeDouble(m_state.prevValue);
+    writer.writeDouble(m_state.gain);
+    writer.writeDouble(m_state.loss);
+}
+
+o3d::Bool NativeRsi::loadState(SnapshotReader &reader)
+{
+    if (reader.readInt32() != m_len) {
+        return false;
+    }
+
+    m_state.count = reader.readInt32();
+    m_state.prevValue = reader.readDouble();
+    m_state.gain = reader.readDouble();
+    m_state.loss = reader.readDouble();
+
+    return !reader.failed();
+}
+
+o3d::Double NativeRsi::step(State &state, o3d::Double value) const
+{
+    if (m_len <= 1) {
+        // as TA-Lib, the price itself
+        ++state.count;
+        return value;
+    }
+
+    // number of the difference with the previous value, from 1
+    const o3d::Int32 n = state.count++;
+    if (n == 0) {
+        state.prevValue = value;
+        return 0.0;
+    }
+
+    const o3d::Double diff = value - state.prevValue;
+    state.prevValue = value;
+
+    if (n > m_len) {
+        state.loss *= (m_len - 1);
+        state.gain *= (m_len - 1);
+    }
+
+    if (diff < 0) {
+        state.loss -= diff;
+    } else {
+        state.gain += diff;
+    }
+
+    if (n < m_len) {
+        return 0.0;
+    }
+
+    state.loss /= m_len;
+    state.gain /= m_len;
+
+    const o3d::Double total = state.gain + state.loss;
+    return !nativeIsZero(total) ? 100.0 * (state.gain / total) : 0.0;
+}
+
+//
+// NativeMomentum
+//
+
+NativeMomentum::NativeMomentum(o3d::Int32 len) :
+    m_len(0),
+    m_pos(0),
+    m_count(0)
+{
+    setLen(len);
+}
+
+void NativeMomentum::setLen(o3d::Int32 len)
+{
+    m_len = o3d::max(len, 1);
+    m_values.assign(static_cast<size_t>(m_len), 0.0);
+
+    reset();
+}
+
+void NativeMomentum::reset()
+{
+    m_pos = 0;
+    m_count = 0;
+}
+
+void NativeMomentum::saveState(SnapshotWriter &writer) const
+{
+    writer.writeInt32(m_len);
+
+    writer.writeDoubles(m_values.data(), static_cast<o3d::Int32>(m_values.size()));
+    writer.writeInt32(m_pos);
+    writer.writeInt32(m_count);
+}
+
+o3d::Bool NativeMomentum::loadState(SnapshotReader &reader)
+{
+    if (reader.readInt32() != m_len) {
+        return false;
+    }
+
+    reader.readDoubles(m_values.data(), static_cast<o3d::Int32>(m_values.size()));
+    m_pos = reader.readInt32();
+    m_count = reader.readInt32();
+
+    return !reader.failed();
+}
+
+o3d::Double NativeMomentum::update(o3d::Double value)
+{
+    const o3d::Double result = m_count >= m_len ? value - m_values[m_pos] : 0.0;
+
+    m_values[m_pos] = value;
+
+    if (++m_pos == m_len) {
+        m_pos = 0;
+    }
+
+    ++m_count;
+
+    return result;
+}
+
+o3d::Double NativeMomentum::updateProvisional(o3d::Double value) const
+{
+    return m_count >= m_len ? value - m_values[m_pos] : 0.0;
+}
+
+//
+// NativeCci
+//
+
+NativeCci::NativeCci(o3d::Int32 len) :
+    m_len(0),
+    m_pos(0),
+    m_count(0)
+{
+    setLen(len);
+}
+
+void NativeCci::setLen(o3d::Int32 len)
+{
+    m_len = o3d::max(len, 1);
+    m_values.assign(static_cast<size_t>(m_len), 0.0);
+
+    reset();
+}
+
+void NativeCci::reset()
+{
+    m_pos = 0;
+    m_count = 0;
+}
+
+void NativeCci::saveState(SnapshotWriter &writer) const
+{
+    writer.writeInt32(m_len);
+
+    writer.writeDoubles(m_values.data(), static_cast<o3d::Int32>(m_values.size()));
+    writer.writeInt32(m_pos);
+    writer.writeInt32(m_count);
+}
+
+o3d::Bool NativeCci::loadState(SnapshotReader &reader)
+{
+    if (reader.readInt32() != m_len) {
+        return false;
+    }
+
+    reader.readDoubles(m_values.data(), static_cast<o3d::Int32>(m_values.size()));
+    m_pos = reader.readInt32();
+    m_count = reader.readInt32();
+
+    return !reader.failed();
+}
+
+o3d::Double NativeCci::update(const NativeBar &bar)
+{
+    const o3d::Double typicalPrice = (bar.high + bar.low + bar.close) / 3;
+    const o3d::Double result = m_count >= lookback() ? value(typicalPrice) : 0.0;
+
+    m_values[m_pos] = typicalPrice;
+
+    if (++m_pos == m_len) {
+        m_pos = 0;
+    }
+
+    ++m_count;
+
+    return result;
+}
+
+o3d::Double NativeCci::updateProvisional(const NativeBar &bar) const
+{
+    return m_count >= lookback() ? value((bar.high + bar.low + bar.close) / 3) : 0.0;
+}
+
+o3d::Double NativeCci::value(o3d::Double typicalPrice) const
+{
+    // in the order of the ring, as TA-Lib does with its circular buffer
+    o3d::Double average = 0.0;
+    for (o3d::Int32 j = 0; j < m_len; ++j) {
+        average += j == m_pos ? typicalPrice : m_values[j];
+    }
+
+    average /= m_len;
+
+    o3d::Double meanDeviation = 0.0;
+    for (o3d::Int32 j = 0; j < m_len; ++j) {
+        meanDeviation += std::fabs((j == m_pos ? typicalPrice : m_values[j]) - average);
+    }
+
+    const o3d::Double diff = typicalPrice - average;
+
+    if (diff != 0.0 && meanDeviation != 0.0) {
+        return diff / (0.015 * (meanDeviation / m_len));
+    }
+
+    return 0.0;
+}
+
+//
+// NativeMacd
+//
+
+NativeMacd::NativeMacd(o3d::Int32 fastLen, o3d::Int32 slowLen, o3d::Int32 signalLen) :
+    m_count(0)
+{
+    setup(fastLen, slowLen, signalLen);
+}
+
+void NativeMacd::setup(o3d::Int32 fastLen, o3d::Int32 slowLen, o3d::Int32 signalLen)
+{
+    // as TA-Lib, the lengths are swapped if the slow one is the shortest
+    m_fast.setLen(o3d::min(fastLen, slowLen));
+    m_slow.setLen(o3d::max(fastLen, slowLen));
+    m_signal.setLen(signalLen);
+
+    reset();
+}
+
+void NativeMacd::reset()
+{
+    m_fast.reset();
+    m_slow.reset();
+    m_signal.reset();
+
+    m_count = 0;
+}
+
+void NativeMacd::saveState(SnapshotWriter &writer) const
+{
+    writer.writeInt32(m_count);
+
+    m_fast.saveState(writer);
+    m_slow.saveState(writer);
+    m_signal.saveState(writer);
+}
+
+o3d::Bool NativeMacd::loadState(SnapshotReader &reader)
+{
+    m_count = reader.readInt32();
+
+    if (!m_fast.loadState(reader) || !m_slow.loadState(reader) || !m_signal.loadState(reader)) {
+        return false;
+    }
+
+    return !reader.failed();
+}
+
+NativeMacd::Value NativeMacd::update(o3d::Double value)
+{
+    const o3d::Int32 i = m_count++;
+    Value result = {0.0, 0.0, 0.0};
+
+    // the fast EMA is seeded by the values just before the first slow EMA
+    const o3d::Double fast = i >= m_slow.len() - m_fast.len() ? m_fast.update(value) : 0.0;
+    const o3d::Double slow = m_slow.update(value);
+
+    if (i >= m_slow.lookback()) {
+        const o3d::Double macd = fast - slow;
+        const o3d::Double signal = m_signal.update(macd);
+
+        if (i >= lookback()) {
+            result.macd = macd;
+            result.signal = signal;
+            result.hist = macd - signal;
+        }
+    }
+
+    return result;
+}
+
+NativeMacd::Value NativeMacd::updateProvisional(o3d::Double value) const
+{
+    const o3d::Int32 i = m_count;
+    Value result = {0.0, 0.0, 0.0};
+
+    if (i >= lookback()) {
+        const o3d::Double macd = m_fast.updateProvisional(value) - m_slow.updateProvisional(value);
+        const o3d::Double signal = m_signal.updateProvisional(macd);
+
+        result.macd = macd;
+        result.signal = signal;
+        result.hist = macd - signal;
+    }
+
+    return result;
+}
+
+//
+// NativeStoch
+//
+
+NativeStoch::NativeStoch(o3d::Int32 fastK_Len,
+                         o3d::Int32 slowK_Len, MAType slowK_MAType,
+                         o3d::Int32 slowD_Len, MAType slowD_MAType) :
+    m_fastK_Len(1),
+    m_highest(RollingExtremum::MODE_MAX),
+    m_lowest(RollingExtremum::MODE_MIN),
+    m_count(0)
+{
+    setup(fastK_Len, slowK_Len, slowK_MAType, slowD_Len, slowD_MAType);
+}
+
+void NativeStoch::setup(o3d::Int32 fastK_Len,
+                        o3d::Int32 slowK_Len, MAType slowK_MAType,
+                        o3d::Int32 slowD_Len, MAType slowD_MAType)
+{
+    m_fastK_Len = o3d::max(fastK_Len, 1);
+
+    m_highest.setLen(m_fastK_Len);
+    m_lowest.setLen(m_fastK_Len);
+
+    m_slowK.setup(slowK_MAType, slowK_Len);
+    m_slowD.setup(slowD_MAType, slowD_Len);
+
+    m_count = 0;
+}
+
+void NativeStoch::reset()
+{
+    m_highest.reset();
+    m_lowest.reset();
+
+    m_slowK.reset();
+    m_slowD.reset();
+
+    m_count = 0;
+}
+
+void NativeStoch::saveState(SnapshotWriter &writer) const
+{
+    writer.writeInt32(m_fastK_Len);
+
+    writer.writeInt32(m_count);
+
+    m_highest.saveState(writer);
+    m_lowest.saveState(writer);
+    m_slowK.saveState(writer);
+    m_slowD.saveState(writer);
+}
+
+o3d::Bool NativeStoch::loadState(SnapshotReader &reader)
+{
+    if (reader.readInt32() != m_fastK_Len) {
+        return false;
+    }
+
+    m_count = reader.readInt32();
+
+    if (!m_highest.loadState(reader) || !m_lowest.loadState(reader) ||
+        !m_slowK.loadState(reader) || !m_slowD.loadState(reader)) {
+        return false;
+    }
+
+    return !reader.failed();
+}
+
+NativeStoch::Value NativeStoch::update(const NativeBar &bar)
+{
+    const o3d::Int32 i = m_count++;
+    Value result = {0.0, 0.0};
+
+    const o3d::Double highest = m_highest.provisional(bar.high);
+    const o3d::Double lowest = m_lowest.provisional(bar.low);
+
+    m_highest.push(bar.high);
+    m_lowest.push(bar.low);
+
+    if (i >= m_fastK_Len - 1) {
+        const o3d::Double slowK = m_slowK.update(fastK(bar.close, highest, lowest));
+
+        if (i >= m_fastK_Len - 1 + m_slowK.lookback()) {
+            const o3d::Double slowD = m_slowD.update(slowK);
+
+            if (i >= lookback()) {
+                result.slowK = slowK;
+                result.slowD = slowD;
+            }
+        }
+    }
+
+    return result;
+}
+
+NativeStoch::Value NativeStoch::updateProvisional(const NativeBar &bar) const
+{
+    Value result = {0.0, 0.0};
+
+    if (m_count >= lookback()) {
+        const o3d::Double k = fastK(bar.close, m_highest.provisional(bar.high), m_lowest.provisional(bar.low));
+        const o3d::Double slowK = m_slowK.updateProvisional(k);
+
+        result.slowK = slowK;
+        result.slowD = m_slowD.updateProvisional(slowK);
+    }
+
+    return result;
+}
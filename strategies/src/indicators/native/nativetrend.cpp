@@ -0,0 +1,344 @@
+/**
+ * @brief SiiS native streaming trend indicators.
+ * @copyright Copyright (C) 2024 SiiS
+ * @author Frederic SCHERMA (frederic.scherma@gmail.com)
+ * @date 2024-10-18
+ */
+
+#include "siis/indicators/native/nativetrend.h"
+#include "siis/utils/snapshot.h"
+#include "siis/indicators/native/nativevolatility.h"
+
+#include <cmath>
+
+using namespace siis;
+
+//
+// NativeAdx
+//
+
+NativeAdx::NativeAdx(o3d::Int32 len) :
+    m_len(0)
+{
+    setLen(len);
+}
+
+void NativeAdx::setLen(o3d::Int32 len)
+{
+    m_len = o3d::max(len, 1);
+
+    reset();
+}
+
+void NativeAdx::reset()
+{
+    m_state.count = 0;
+
+    m_state.prevHigh = 0.0;
+    m_state.prevLow = 0.0;
+    m_state.prevClose = 0.0;
+
+    m_state.plusDM = 0.0;
+    m_state.minusDM = 0.0;
+    m_state.tr = 0.0;
+
+    m_state.sumDX = 0.0;
+    m_state.adx = 0.0;
+}
+
+void NativeAdx::saveState(SnapshotWriter &writer) const
+{
+    writer.writeInt32(m_len);
+
+    writer.writeInt32(m_state.count);
+    writer.writeDouble(m_state.prevHigh);
+    writer.writeDouble(m_state.prevLow);
+    writer.writeDouble(m_state.prevClose);
+    writer.writeDouble(m_state.plusDM);
+    writer.writeDouble(m_state.minusDM);
+    writer.writeDouble(m_state.tr);
+    writer.writeDouble(m_state.sumDX);
+    writer.writeDouble(m_state.adx);
+}
+
+o3d::Bool NativeAdx::loadState(SnapshotReader &reader)
+{
+    if (reader.readInt32() != m_len) {
+        return false;
+    }
+
+    m_state.count = reader.readInt32();
+    m_state.prevHigh = reader.readDouble();
+    m_state.prevLow = reader.readDouble();
+    m_state.prevClose = reader.readDouble();
+    m_state.plusDM = reader.readDouble();
+    m_state.minusDM = reader.readDouble();
+    m_state.tr = reader.readDouble();
+    m_state.sumDX = reader.readDouble();
+    m_state.adx = reader.readDouble();
+
+    return !reader.failed();
+}
+
+o3d::Double NativeAdx::step(State &state, const NativeBar &bar) const
+{
+    const o3d::Int32 i = state.count++;
+    if (i == 0) {
+        state.prevHigh = bar.high;
+        state.prevLow = bar.low;
+        state.prevClose = bar.close;
+        return 0.0;
+    }
+
+    const o3d::Double diffP = bar.high - state.prevHigh;  // plus delta
+    const o3d::Double diffM = state.prevLow - bar.low;    // minus delta
+
+    state.prevHigh = bar.high;
+    state.prevLow = bar.low;
+
+    // sums of the first len-1 bars, then smoothed
+    if (i >= m_len) {
+        state.minusDM -= state.minusDM / m_len;
+        state.plusDM -= state.plusDM / m_len;
+    }
+
+    if (diffM > 0 && diffP < diffM) {
+        state.minusDM += diffM;
+    } else if (diffP > 0 && diffP > diffM) {
+        state.plusDM += diffP;
+    }
+
+    const o3d::Double tr = NativeAtr::trueRange(bar.high, bar.low, state.prevClose);
+    state.prevClose = bar.close;
+
+    if (i < m_len) {
+        state.tr += tr;
+        return 0.0;
+    }
+
+    state.tr = state.tr - (state.tr / m_len) + tr;
+
+    if (!nativeIsZero(state.tr)) {
+        const o3d::Double minusDI = 100.0 * (state.minusDM / state.tr);
+        const o3d::Double plusDI = 100.0 * (state.plusDM / state.tr);
+        const o3d::Double sumDI = minusDI + plusDI;
+
+        if (!nativeIsZero(sumDI)) {
+            const o3d::Double dx = 100.0 * (std::fabs(minusDI - plusDI) / sumDI);
+
+            if (i <= lookback()) {
+                state.sumDX += dx;
+            } else {
+                state.adx = ((state.adx * (m_len - 1)) + dx) / m_len;
+            }
+        }
+    }
+
+    if (i < lookback()) {
+        return 0.0;
+    } else if (i == lookback()) {
+        state.adx = state.sumDX / m_len;
+    }
+
+    return state.adx;
+}
+
+//
+// NativeSar
+//
+
+NativeSar::NativeSar(o3d::Double accel, o3d::Double max) :
+    m_accel(0.0),
+    m_max(0.0)
+{
+    setup(accel, max);
+}
+
+void NativeSar::setup(o3d::Double accel, o3d::Double max)
+{
+    m_accel = accel > max ? max : accel;
+    m_max = max;
+
+    reset();
+}
+
+void NativeSar::reset()
+{
+    m_state.count = 0;
+    m_state.isLong = true;
+
+    m_state.sar = 0.0;
+    m_state.ep = 0.0;
+    m_state.af = m_accel;
+
+    m_state.newHigh = 0.0;
+    m_state.newLow = 0.0;
+}
+
+void NativeSar::saveState(SnapshotWriter &writer) const
+{
+    writer.writeDouble(m_accel);
+    writer.writeDouble(m_max);
+
+    writer.writeInt32(m_state.count);
+    writer.writeBool(m_state.isLong);
+    writer.writeDouble(m_state.sar);
+    writer.writeDouble(m_state.ep);
+    writer.writeDouble(m_state.af);
+    writer.writeDouble(m_state.newHigh);
+    writer.writeDouble(m_state.newLow);
+}
+
+o3d::Bool NativeSar::loadState(SnapshotReader &reader)
+{
+    if (reader.readDouble() != m_accel || reader.readDouble() != m_max) {
+        return false;
+    }
+
+    m_state.count = reader.readInt32();
+    m_state.isLong = reader.readBool();
+    m_state.sar = reader.readDouble();
+    m_state.ep = reader.readDouble();
+    m_state.af = reader.readDouble();
+    m_state.newHigh = reader.readDouble();
+    m_state.newLow = reader.readDouble();
+
+    return !reader.failed();
+}
+
+o3d::Double NativeSar::step(State &state, const NativeBar &bar) const
+{
+    const o3d::Int32 i = state.count++;
+    if (i == 0) {
+        state.newHigh = bar.high;
+        state.newLow = bar.low;
+        return 0.0;
+    }
+
+    if (i == 1) {
+        // short if there is a minus directional movement between the two first bars
+        const o3d::Double diffP = bar.high - state.newHigh;
+        const o3d::Double diffM = state.newLow - bar.low;
+
+        state.isLong = !(diffM > 0 && diffP < diffM);
+
+        if (state.isLong) {
+            state.ep = bar.high;
+            state.sar = state.newLow;
+        } else {
+            state.ep = bar.low;
+            state.sar = state.newHigh;
+        }
+
+        state.af = m_accel;
+
+        state.newHigh = bar.high;
+        state.newLow = bar.low;
+    }
+
+    const o3d::Double prevHigh = state.newHigh;
+    const o3d::Double prevLow = state.newLow;
+
+    state.newHigh = bar.high;
+    state.newLow = bar.low;
+
+    o3d::Double result = 0.0;
+
+    if (state.isLong) {
+        if (state.newLow <= state.sar) {
+            // switch to short
+            state.isLong = false;
+            state.sar = state.ep;
+
+            if (state.sar < prevHigh) {
+                state.sar = prevHigh;
+            }
+            if (state.sar < state.newHigh) {
+                state.sar = state.newHigh;
+            }
+
+            result = state.sar;
+
+            state.af = m_accel;
+            state.ep = state.newLow;
+
+            state.sar = state.sar + state.af * (state.ep - state.sar);
+
+            if (state.sar < prevHigh) {
+                state.sar = prevHigh;
+            }
+            if (state.sar < state.newHigh) {
+                state.sar = state.newHigh;
+            }
+        } else {
+            result = state.sar;
+
+            if (state.newHigh > state.ep) {
+                state.ep = state.newHigh;
+                state.af += m_accel;
+
+                if (state.af > m_max) {
+                    state.af = m_max;
+                }
+            }
+
+            state.sar = state.sar + state.af * (state.ep - state.sar);
+
+            if (state.sar > prevLow) {
+                state.sar = prevLow;
+            }
+            if (state.sar > state.newLow) {
+                state.sar = state.newLow;
+            }
+        }
+    } else {
+        if (state.newHigh >= state.sar) {
+            // switch to long
+            state.isLong = true;
+            state.sar = state.ep;
+
+            if (state.sar > prevLow) {
+                state.sar = prevLow;
+            }
+            if (state.sar > state.newLow) {
+                state.sar = state.newLow;
+            }
+
+            result = state.sar;
+
+            state.af = m_accel;
+            state.ep = state.newHigh;
+
+            state.sar = state.sar + state.af * (state.ep - state.sar);
+
+            if (state.sar > prevLow) {
+                state.sar = prevLow;
+            }
+            if (state.sar > state.newLow) {
+                state.sar = state.newLow;
+            }
+        } else {
+            result = state.sar;
+
+            if (state.newLow < state.ep) {
+                state.ep = state.newLow;
+                state.af += m_accel;
+
+                if (state.af > m_max) {
+                    state.af = m_max;
+                }
+            }
+
+            state.sar = state.sar + state.af * (state.ep - state.sar);
+
+            if (state.sar < prevHigh) {
+                state.sar = prevHigh;
+            }
+            if (state.sar < state.newHigh) {
+                state.sar = state.newHigh;
+            }
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,229 @@
+/**
+ * @brief SiiS native streaming volatility indicators.
+ * @copyright Copyright (C) 2024 SiiS
+ * @author Frederic SCHERMA (frederic.scherma@gmail.com)
+ * @date 2024-10-18
+ */
+
+#include "siis/indicators/native/nativevolatility.h"
+#include "siis/utils/snapshot.h"
+
+using namespace siis;
+
+//
+// NativeAtr
+//
+
+NativeAtr::NativeAtr(o3d::Int32 len) :
+    m_len(0)
+{
+    setLen(len);
+}
+
+void NativeAtr::setLen(o3d::Int32 len)
+{
+    m_len = o3d::max(len, 1);
+
+    reset();
+}
+
+void NativeAtr::reset()
+{
+    m_state.count = 0;
+    m_state.prevClose = 0.0;
+    m_state.atr = 0.0;
+}
+
+void NativeAtr::saveState(SnapshotWriter &writer) const
+{
+    writer.writeInt32(m_len);
+
+    writer.writeInt32(m_state.count);
+    writer.writeDouble(m_state.prevClose);
+    writer.writeDouble(m_state.atr);
+}
+
+o3d::Bool NativeAtr::loadState(SnapshotReader &reader)
+{
+    if (reader.readInt32() != m_len) {
+        return false;
+    }
+
+    m_state.count = reader.readInt32();
+    m_state.prevClose = reader.readDouble();
+    m_state.atr = reader.readDouble();
+
+    return !reader.failed();
+}
+
+o3d::Double NativeAtr::step(State &state, const NativeBar &bar) const
+{
+    // number of the true range, from 1
+    const o3d::Int32 n = state.count++;
+    if (n == 0) {
+        state.prevClose = bar.close;
+        return 0.0;
+    }
+
+    const o3d::Double tr = trueRange(bar.high, bar.low, state.prevClose);
+    state.prevClose = bar.close;
+
+    if (m_len <= 1) {
+        return tr;
+    }
+
+    if (n < m_len) {
+        state.atr += tr;
+        return 0.0;
+    } else if (n == m_len) {
+        state.atr += tr;
+        state.atr /= m_len;
+    } else {
+        state.atr *= m_len - 1;
+        state.atr += tr;
+        state.atr /= m_len;
+    }
+
+    return state.atr;
+}
+
+//
+// NativeBollinger
+//
+
+NativeBollinger::NativeBollinger(o3d::Int32 len, o3d::Double numDevUp, o3d::Double numDevDn, MAType maType) :
+    m_len(0),
+    m_numDevUp(0.0),
+    m_numDevDn(0.0),
+    m_pos(0),
+    m_count(0),
+    m_sum(0.0),
+    m_sumSq(0.0)
+{
+    setup(len, numDevUp, numDevDn, maType);
+}
+
+void NativeBollinger::setup(o3d::Int32 len, o3d::Double numDevUp, o3d::Double numDevDn, MAType maType)
+{
+    m_len = o3d::max(len, 1);
+    m_numDevUp = numDevUp;
+    m_numDevDn = numDevDn;
+
+    m_ma.setup(maType, m_len);
+    m_values.assign(static_cast<size_t>(m_len), 0.0);
+
+    reset();
+}
+
+void NativeBollinger::reset()
+{
+    m_ma.reset();
+
+    m_pos = 0;
+    m_count = 0;
+    m_sum = 0.0;
+    m_sumSq = 0.0;
+}
+
+void NativeBollinger::saveState(SnapshotWriter &writer) const
+{
+    writer.writeInt32(m_len);
+    writer.writeDouble(m_numDevUp);
+    writer.writeDouble(m_numDevDn);
+
+    writer.writeDoubles(m_values.data(), static_cast<o3d::Int32>(m_values.size()));
+    writer.writeInt32(m_pos);
+    writer.writeInt32(m_count);
+    writer.writeDouble(m_sum);
+    writer.writeDouble(m_sumSq);
+
+    m_ma.saveState(writer);
+}
+
+o3d::Bool NativeBollinger::loadState(SnapshotReader &reader)
+{
+    if (reader.readInt32() != m_len || reader.readDouble() != m_numDevUp || reader.readDouble() != m_numDevDn) {
+        return false;
+    }
+
+    reader.readDoubles(m_values.data(), static_cast<o3d::Int32>(m_values.size()));
+    m_pos = reader.readInt32();
+    m_count = reader.readInt32();
+    m_sum = reader.readDouble();
+    m_sumSq = reader.readDouble();
+
+    if (!m_ma.loadState(reader)) {
+        return false;
+    }
+
+    return !reader.failed();
+}
+
+NativeBollinger::Value NativeBollinger::update(o3d::Double value)
+{
+    if (m_count >= m_len) {
+        const o3d::Double oldest = m_values[m_pos];
+        m_sum -= oldest;
+        m_sumSq -= oldest * oldest;
+    }
+
+    m_sum += value;
+    m_sumSq += value * value;
+    m_values[m_pos] = value;
+
+    if (++m_pos == m_len) {
+        m_pos = 0;
+
+        // exact sums of the window once per turn of the ring
+        m_sum = 0.0;
+        m_sumSq = 0.0;
+
+        for (o3d::Int32 i = 0; i < m_len; ++i) {
+            m_sum += m_values[i];
+            m_sumSq += m_values[i] * m_values[i];
+        }
+    }
+
+    ++m_count;
+
+    const o3d::Double middle = m_ma.update(value);
+
+    if (m_count <= lookback()) {
+        Value result = {0.0, 0.0, 0.0};
+        return result;
+    }
+
+    return bands(middle, m_sum, m_sumSq);
+}
+
+NativeBollinger::Value NativeBollinger::updateProvisional(o3d::Double value) const
+{
+    if (m_count < lookback()) {
+        Value result = {0.0, 0.0, 0.0};
+        return result;
+    }
+
+    o3d::Double sum = m_sum + value;
+    o3d::Double sumSq = m_sumSq + value * value;
+
+    if (m_count >= m_len) {
+        const o3d::Double oldest = m_values[m_pos];
+        sum -= oldest;
+        sumSq -= oldest * oldest;
+    }
+
+    return bands(m_ma.updateProvisional(value), sum, sumSq);
+}
+
+NativeBollinger::Value NativeBollinger::bands(o3d::Double middle, o3d::Double sum, o3d::Double sumSq) const
+{
+    // around the mean of the window, that is the middle with a SMA
+    const o3d::Double mean = m_ma.maType() == MA_SMA ? middle : sum / m_len;
+    const o3d::Double variance = sumSq / m_len - mean * mean;
+
+    // TA-Lib gives 0 for a variance near to zero or negative (rounding)
+    const o3d::Double stdDev = variance >= 0.00000001 ? std::sqrt(variance) : 0.0;
+
+    Value result = {middle + stdDev * m_numDevUp, middle, middle - stdDev * m_numDevDn};
+    return result;
+}
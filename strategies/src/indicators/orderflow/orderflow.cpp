@@ -0,0 +1,675 @@
+/**
+ * @brief SiiS tick order flow indicator.
+ * @copyright Copyright (C) 2024 SiiS
+ * @author Frederic SCHERMA (frederic.scherma@gmail.com)
+ * @date 2024-10-18
+ */
+
+#include "siis/indicators/orderflow/orderflow.h"
+#include "siis/utils/common.h"
+#include "siis/utils/math.h"
+#include "siis/utils/snapshot.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace siis;
+using o3d::Logger;
+using o3d::Debug;
+
+PriceLadder::PriceLadder() :
+    m_base(0),
+    m_lowLevel(1),
+    m_highLevel(0),
+    m_volume(0.0),
+    m_delta(0.0),
+    m_pocLevel(0),
+    m_pocVolume(0.0)
+{
+}
+
+void PriceLadder::reset()
+{
+    if (!empty()) {
+        // only the used range is cleared
+        std::fill(m_bid.begin() + (m_lowLevel - m_base), m_bid.begin() + (m_highLevel - m_base + 1), 0.0);
+        std::fill(m_ask.begin() + (m_lowLevel - m_base), m_ask.begin() + (m_highLevel - m_base + 1), 0.0);
+    }
+
+    m_lowLevel = 1;
+    m_highLevel = 0;
+
+    m_volume = 0.0;
+    m_delta = 0.0;
+
+    m_pocLevel = 0;
+    m_pocVolume = 0.0;
+}
+
+o3d::Bool PriceLadder::add(o3d::Int64 level, o3d::Double bidVolume, o3d::Double askVolume)
+{
+    const o3d::Int64 size = static_cast<o3d::Int64>(m_bid.size());
+
+    if (size == 0 || level < m_base || level >= m_base + size) {
+        if (!grow(level)) {
+            return false;
+        }
+    }
+
+    if (empty()) {
+        m_lowLevel = m_highLevel = level;
+    } else if (level < m_lowLevel) {
+        m_lowLevel = level;
+    } else if (level > m_highLevel) {
+        m_highLevel = level;
+    }
+
+    const size_t i = static_cast<size_t>(level - m_base);
+
+    m_bid[i] += bidVolume;
+    m_ask[i] += askVolume;
+
+    m_volume += bidVolume + askVolume;
+    m_delta += askVolume - bidVolume;
+
+    const o3d::Double volume = m_bid[i] + m_ask[i];
+    if (volume > m_pocVolume) {
+        m_pocVolume = volume;
+        m_pocLevel = level;
+    }
+
+    return true;
+}
+
+o3d::Double PriceLadder::buyImbalance(o3d::Int64 level) const
+{
+    const o3d::Double ask = askAt(level);
+    const o3d::Double bid = bidAt(level - 1);
+
+    if (ask <= 0.0) {
+        return 0.0;
+    }
+
+    return bid > 0.0 ? ask / bid : ask;
+}
+
+o3d::Double PriceLadder::sellImbalance(o3d::Int64 level) const
+{
+    const o3d::Double bid = bidAt(level);
+    const o3d::Double ask = askAt(level + 1);
+
+    if (bid <= 0.0) {
+        return 0.0;
+    }
+
+    return ask > 0.0 ? bid / ask : bid;
+}
+
+o3d::Int32 PriceLadder::stackedImbalances(o3d::Int32 direction, o3d::Double ratio, o3d::Int64 *outLowLevel) const
+{
+    o3d::Int32 longest = 0;
+    o3d::Int32 count = 0;
+
+    for (o3d::Int64 level = m_lowLevel; level <= m_highLevel; ++level) {
+        const o3d::Double imbalance = direction > 0 ? buyImbalance(level) : sellImbalance(level);
+
+        if (imbalance >= ratio) {
+            ++count;
+
+            if (count > longest) {
+                longest = count;
+
+                if (outLowLevel) {
+                    *outLowLevel = level - count + 1;
+                }
+            }
+        } else {
+            count = 0;
+        }
+    }
+
+    return longest;
+}
+
+void PriceLadder::saveState(SnapshotWriter &writer) const
+{
+    writer.writeInt64(m_lowLevel);
+    writer.writeInt64(m_highLevel);
+
+    writer.writeDouble(m_volume);
+    writer.writeDouble(m_delta);
+
+    writer.writeInt64(m_pocLevel);
+    writer.writeDouble(m_pocVolume);
+
+    if (!empty()) {
+        const o3d::Int32 count = static_cast<o3d::Int32>(m_highLevel - m_lowLevel + 1);
+
+        writer.writeDoubles(m_bid.data() + (m_lowLevel - m_base), count);
+        writer.writeDoubles(m_ask.data() + (m_lowLevel - m_base), count);
+    }
+}
+
+o3d::Bool PriceLadder::loadState(SnapshotReader &reader)
+{
+    reset();
+
+    const o3d::Int64 lowLevel = reader.readInt64();
+    const o3d::Int64 highLevel = reader.readInt64();
+
+    const o3d::Double volume = reader.readDouble();
+    const o3d::Double delta = reader.readDouble();
+
+    const o3d::Int64 pocLevel = reader.readInt64();
+    const o3d::Double pocVolume = reader.readDouble();
+
+    if (reader.failed()) {
+        return false;
+    }
+
+    if (lowLevel > highLevel) {
+        // empty
+        return true;
+    }
+
+    // validated before allocating the range
+    const o3d::Int64 count = highLevel - lowLevel + 1;
+    if (count > MAX_LEVELS || count > static_cast<o3d::Int64>(reader.remaining() / (2 * sizeof(o3d::Double)))) {
+        return false;
+    }
+
+    const o3d::Int64 size = static_cast<o3d::Int64>(m_bid.size());
+
+    if ((size == 0 || lowLevel < m_base || lowLevel >= m_base + size) && !grow(lowLevel)) {
+        return false;
+    }
+
+    // the low level is kept when growing to the high level
+    m_lowLevel = m_highLevel = lowLevel;
+
+    if (highLevel >= m_base + static_cast<o3d::Int64>(m_bid.size()) && !grow(highLevel)) {
+        reset();
+        return false;
+    }
+
+    m_highLevel = highLevel;
+
+    if (!reader.readDoubles(m_bid.data() + (m_lowLevel - m_base), static_cast<o3d::Int32>(count)) ||
+        !reader.readDoubles(m_ask.data() + (m_lowLevel - m_base), static_cast<o3d::Int32>(count))) {
+        reset();
+        return false;
+    }
+
+    m_volume = volume;
+    m_delta = delta;
+
+    m_pocLevel = pocLevel;
+    m_pocVolume = pocVolume;
+
+    return true;
+}
+
+o3d::Bool PriceLadder::grow(o3d::Int64 level)
+{
+    const o3d::Int64 size = static_cast<o3d::Int64>(m_bid.size());
+
+    if (size == 0) {
+        // initial range centered on the level
+        const o3d::Int64 initialSize = 64;
+
+        m_bid.assign(initialSize, 0.0);
+        m_ask.assign(initialSize, 0.0);
+        m_base = level - initialSize / 2;
+
+        return true;
+    }
+
+    if (empty()) {
+        // the volumes are cleared, only moved to the level
+        m_base = level - size / 2;
+        return true;
+    }
+
+    // the used range and the level, a wrong tick size or price could else allocate any memory
+    const o3d::Int64 low = o3d::min(level, m_lowLevel);
+    const o3d::Int64 high = o3d::max(level, m_highLevel);
+
+    if (high - low + 1 > MAX_LEVELS) {
+        return false;
+    }
+
+    // at least twice the size, with a margin on the side of the level
+    o3d::Int64 newSize = o3d::max(size * 2, high - low + 1 + size / 2);
+    if (newSize > MAX_LEVELS) {
+        newSize = MAX_LEVELS;
+    }
+
+    const o3d::Int64 newBase = level < m_base ? high - newSize + 1 : low;
+
+    std::vector<o3d::Double> bid(static_cast<size_t>(newSize), 0.0);
+    std::vector<o3d::Double> ask(static_cast<size_t>(newSize), 0.0);
+
+    // only the used range is moved
+    const size_t from = static_cast<size_t>(m_lowLevel - m_base);
+    const size_t to = static_cast<size_t>(m_highLevel - m_base + 1);
+    const size_t at = static_cast<size_t>(m_lowLevel - newBase);
+
+    std::copy(m_bid.begin() + from, m_bid.begin() + to, bid.begin() + at);
+    std::copy(m_ask.begin() + from, m_ask.begin() + to, ask.begin() + at);
+
+    m_bid.swap(bid);
+    m_ask.swap(ask);
+    m_base = newBase;
+
+    return true;
+}
+
+void FootprintBar::reset(o3d::Double _timestamp, o3d::Double price)
+{
+    timestamp = _timestamp;
+
+    open = high = low = close = price;
+
+    minDelta = 0.0;
+    maxDelta = 0.0;
+
+    ladder.reset();
+}
+
+void FootprintBar::saveState(SnapshotWriter &writer) const
+{
+    writer.writeDouble(timestamp);
+
+    writer.writeDouble(open);
+    writer.writeDouble(high);
+    writer.writeDouble(low);
+    writer.writeDouble(close);
+
+    writer.writeDouble(minDelta);
+    writer.writeDouble(maxDelta);
+
+    ladder.saveState(writer);
+}
+
+o3d::Bool FootprintBar::loadState(SnapshotReader &reader)
+{
+    timestamp = reader.readDouble();
+
+    open = reader.readDouble();
+    high = reader.readDouble();
+    low = reader.readDouble();
+    close = reader.readDouble();
+
+    minDelta = reader.readDouble();
+    maxDelta = reader.readDouble();
+
+    return ladder.loadState(reader);
+}
+
+OrderFlow::OrderFlow(const o3d::String &name,
+                     o3d::Double timeframe,
+                     o3d::Int32 depth,
+                     const o3d::CString &sessionTimeframe,
+                     o3d::Int32 historySize,
+                     o3d::Double imbalanceRatio,
+                     o3d::Bool sessionFilter) :
+    Indicator(name, timeframe),
+    m_sessionTimeframe(0.0),
+    m_sessionOffset(0.0),
+    m_sessionDuration(0.0),
+    m_depth(depth),
+    m_historySize(historySize),
+    m_imbalanceRatio(imbalanceRatio),
+    m_sessionFilter(sessionFilter),
+    m_tickSize(0.00000001),
+    m_invTickSize(100000000.0),
+    m_openTimestamp(0.0),
+    m_prevTickPrice(0.0),
+    m_tmpCvd(0.0),
+    m_lastSide(0),
+    m_cvd(depth),
+    m_lastBar(0),
+    m_numPrevious(0),
+    m_hasCurrent(false),
+    m_prev(0.0),
+    m_last(0.0)
+{
+    O3D_ASSERT(depth > 0);
+
+    if (sessionTimeframe.isValid()) {
+        m_sessionTimeframe = timeframeFromStr(sessionTimeframe);
+    }
+
+    m_historySize = o3d::max(m_historySize, 1);
+    m_bars.resize(static_cast<size_t>(m_historySize + 1));
+
+    // begin the first value
+    m_cvd.append(0.0);
+}
+
+OrderFlow::OrderFlow(const o3d::String &name, o3d::Double timeframe, o3d::Int32 depth, IndicatorConfig conf) :
+    Indicator(name, timeframe),
+    m_sessionTimeframe(0.0),
+    m_sessionOffset(0.0),
+    m_sessionDuration(0.0),
+    m_depth(depth),
+    m_historySize(10),
+    m_imbalanceRatio(3.0),
+    m_sessionFilter(false),
+    m_tickSize(0.00000001),
+    m_invTickSize(100000000.0),
+    m_openTimestamp(0.0),
+    m_prevTickPrice(0.0),
+    m_tmpCvd(0.0),
+    m_lastSide(0),
+    m_cvd(depth),
+    m_lastBar(0),
+    m_numPrevious(0),
+    m_hasCurrent(false),
+    m_prev(0.0),
+    m_last(0.0)
+{
+    O3D_ASSERT(depth > 0);
+
+    if (conf.data().isObject()) {
+        // "cvd-timeframe" as CumulativeVolumeDelta, when configured in place of it
+        m_sessionTimeframe = timeframeFromStr(conf.data().get("session-timeframe",
+                                              conf.data().get("cvd-timeframe", "1d")).asString().c_str());
+        m_historySize = conf.data().get("history", 10).asInt();
+        m_imbalanceRatio = conf.data().get("imbalance-ratio", 3.0).asDouble();
+        m_sessionFilter = conf.data().get("session-filter", false).asBool();
+    } else if (conf.data().isArray()) {
+        m_sessionTimeframe = timeframeFromStr(conf.data().get((Json::ArrayIndex)1, "1d").asString().c_str());
+        m_historySize = conf.data().get((Json::ArrayIndex)2, 10).asInt();
+        m_imbalanceRatio = conf.data().get((Json::ArrayIndex)3, 3.0).asDouble();
+        m_sessionFilter = conf.data().get((Json::ArrayIndex)4, false).asBool();
+    }
+
+    m_historySize = o3d::max(m_historySize, 1);
+    m_bars.resize(static_cast<size_t>(m_historySize + 1));
+
+    // begin the first value
+    m_cvd.append(0.0);
+}
+
+OrderFlow::~OrderFlow()
+{
+
+}
+
+void OrderFlow::setConf(IndicatorConfig conf)
+{
+    if (conf.data().isObject()) {
+        // "cvd-timeframe" as CumulativeVolumeDelta, when configured in place of it
+        m_sessionTimeframe = timeframeFromStr(conf.data().get("session-timeframe",
+                                              conf.data().get("cvd-timeframe", "1d")).asString().c_str());
+        m_historySize = conf.data().get("history", 10).asInt();
+        m_imbalanceRatio = conf.data().get("imbalance-ratio", 3.0).asDouble();
+        m_sessionFilter = conf.data().get("session-filter", false).asBool();
+    } else if (conf.data().isArray()) {
+        m_sessionTimeframe = timeframeFromStr(conf.data().get((Json::ArrayIndex)1, "1d").asString().c_str());
+        m_historySize = conf.data().get((Json::ArrayIndex)2, 10).asInt();
+        m_imbalanceRatio = conf.data().get((Json::ArrayIndex)3, 3.0).asDouble();
+        m_sessionFilter = conf.data().get((Json::ArrayIndex)4, false).asBool();
+    }
+
+    m_historySize = o3d::max(m_historySize, 1);
+    m_bars.resize(static_cast<size_t>(m_historySize + 1));
+
+    m_lastBar = 0;
+    m_numPrevious = 0;
+    m_hasCurrent = false;
+}
+
+void OrderFlow::init(o3d::Double tickSize)
+{
+    if (tickSize <= 0.0) {
+        tickSize = 0.00000001;
+    }
+
+    m_tickSize = tickSize;
+    m_invTickSize = 1.0 / tickSize;
+}
+
+void OrderFlow::setSession(o3d::Double sessionOffset, o3d::Double sessionDuration)
+{
+    m_sessionOffset = sessionOffset;
+
+    if (sessionDuration > 0.0) {
+        m_sessionDuration = sessionDuration;
+    } else {
+        m_sessionDuration = m_sessionTimeframe;
+    }
+}
+
+o3d::Int64 OrderFlow::level(o3d::Double price) const
+{
+    return tickLevel(price, m_invTickSize);
+}
+
+const FootprintBar &OrderFlow::footprint(o3d::Int32 n) const
+{
+    if (n == 0) {
+        if (!m_hasCurrent) throw o3d::E_IndexOutOfRange("OrderFlow::footprint(current)");
+        return m_bars[m_lastBar];
+    }
+
+    o3d::Int32 size = m_numPrevious;
+
+    if (n >= size) throw o3d::E_IndexOutOfRange("OrderFlow::footprint(n>=size)");
+
+    if (n < 0) {
+        n = size + n;
+        if (n < 0) throw o3d::E_IndexOutOfRange("OrderFlow::footprint(n<0)");
+    }
+
+    // the last previous precedes the current footprint into the ring
+    const o3d::Int32 capacity = static_cast<o3d::Int32>(m_bars.size());
+    const o3d::Int32 lastPrevious = m_hasCurrent ? m_lastBar - 1 : m_lastBar;
+
+    return m_bars[(lastPrevious - (size - 1 - n) + 2 * capacity) % capacity];
+}
+
+void OrderFlow::update(const Tick &tick, o3d::Bool finalize)
+{
+    m_prev = m_last;
+
+    if (finalize) {
+        this->finalize();
+    }
+
+    // reset accumulators at each new session and for the initial state
+    if (tick.timestamp() > m_openTimestamp + m_sessionTimeframe) {
+        m_cvd.back() = 0.0;
+        m_profile.reset();
+
+        // new session beginning timestamp
+        m_openTimestamp = baseTime(tick.timestamp(), m_sessionTimeframe);
+
+        // session offset and duration only apply to a daily session
+        if (m_sessionTimeframe == TF_DAY && m_sessionFilter) {
+            m_openTimestamp += m_sessionOffset;
+        }
+    }
+
+    // ignore ticks out of the daily session
+    if (m_sessionFilter && m_sessionTimeframe == TF_DAY && (m_sessionOffset > 0 || m_sessionDuration > 0)) {
+        if (tick.timestamp() < m_openTimestamp) {
+            return;
+        }
+
+        if (tick.timestamp() >= m_openTimestamp + (m_sessionDuration > 0.0 ? m_sessionDuration : m_sessionTimeframe)) {
+            return;
+        }
+    }
+
+    const o3d::Double price = tick.last();
+    const o3d::Double volume = tick.volume();
+
+    // -1 for bid, 1 for ask, or 0 if no info, then the tick rule
+    o3d::Int32 side = tick.buyOrSell();
+
+    if (side == 0 && m_prevTickPrice != 0.0) {
+        if (price > m_prevTickPrice) {
+            side = 1;
+        } else if (price < m_prevTickPrice) {
+            side = -1;
+        }
+    }
+
+    // cvd, an unchanged price waits the next up or down tick
+    o3d::Double deltaVolume = 0.0;
+
+    if (tick.buyOrSell() != 0) {
+        deltaVolume = side * volume;
+    } else if (m_prevTickPrice != 0.0) {
+        if (side != 0) {
+            deltaVolume = side * (volume + m_tmpCvd);
+            m_tmpCvd = 0.0;
+        } else {
+            m_tmpCvd += volume;
+        }
+    }
+
+    m_prevTickPrice = price;
+    m_lastSide = side;
+
+    m_last = m_cvd.back() += deltaVolume;
+
+    // footprint and profile
+    if (!m_hasCurrent) {
+        // reuse the footprint following the last one, the older previous if the ring is full
+        m_lastBar = (m_lastBar + 1) % static_cast<o3d::Int32>(m_bars.size());
+        m_hasCurrent = true;
+
+        m_bars[m_lastBar].reset(tick.timestamp(), price);
+    }
+
+    FootprintBar &bar = m_bars[m_lastBar];
+
+    bar.high = o3d::max(bar.high, price);
+    bar.low = o3d::min(bar.low, price);
+    bar.close = price;
+
+    if (volume > 0.0) {
+        const o3d::Int64 priceLevel = level(price);
+
+        o3d::Double bidVolume = 0.0;
+        o3d::Double askVolume = 0.0;
+
+        if (side < 0) {
+            bidVolume = volume;
+        } else if (side > 0) {
+            askVolume = volume;
+        } else {
+            bidVolume = askVolume = volume * 0.5;
+        }
+
+        bar.ladder.add(priceLevel, bidVolume, askVolume);
+        m_profile.add(priceLevel, bidVolume, askVolume);
+
+        bar.minDelta = o3d::min(bar.minDelta, bar.ladder.delta());
+        bar.maxDelta = o3d::max(bar.maxDelta, bar.ladder.delta());
+    }
+
+    // retain the last tick timestamp
+    done(tick.timestamp());
+}
+
+void OrderFlow::saveState(SnapshotWriter &writer) const
+{
+    writer.writeDouble(m_sessionTimeframe);
+    writer.writeInt32(m_depth);
+    writer.writeInt32(m_historySize);
+    writer.writeDouble(m_tickSize);
+
+    writer.writeDouble(lastTimestamp());
+    writer.writeDouble(m_openTimestamp);
+
+    writer.writeDouble(m_prevTickPrice);
+    writer.writeDouble(m_tmpCvd);
+    writer.writeInt32(m_lastSide);
+
+    writer.writeCircular(m_cvd);
+
+    m_profile.saveState(writer);
+
+    writer.writeInt32(m_lastBar);
+    writer.writeInt32(m_numPrevious);
+    writer.writeBool(m_hasCurrent);
+
+    for (const FootprintBar &bar : m_bars) {
+        bar.saveState(writer);
+    }
+
+    writer.writeDouble(m_prev);
+    writer.writeDouble(m_last);
+}
+
+o3d::Bool OrderFlow::loadState(SnapshotReader &reader)
+{
+    if (reader.readDouble() != m_sessionTimeframe || reader.readInt32() != m_depth ||
+        reader.readInt32() != m_historySize || reader.readDouble() != m_tickSize) {
+        return false;
+    }
+
+    const o3d::Double timestamp = reader.readDouble();
+    m_openTimestamp = reader.readDouble();
+
+    m_prevTickPrice = reader.readDouble();
+    m_tmpCvd = reader.readDouble();
+    m_lastSide = reader.readInt32();
+
+    o3d::Bool result = reader.readCircular(m_cvd) && m_cvd.size() > 0 && m_profile.loadState(reader);
+
+    m_lastBar = reader.readInt32();
+    m_numPrevious = reader.readInt32();
+    m_hasCurrent = reader.readBool();
+
+    result = result && m_lastBar >= 0 && m_lastBar < static_cast<o3d::Int32>(m_bars.size()) &&
+             m_numPrevious >= 0 && m_numPrevious <= m_historySize;
+
+    for (size_t i = 0; result && i < m_bars.size(); ++i) {
+        result = m_bars[i].loadState(reader);
+    }
+
+    m_prev = reader.readDouble();
+    m_last = reader.readDouble();
+
+    if (!result || reader.failed()) {
+        // restart from an empty state
+        m_openTimestamp = 0.0;
+        m_prevTickPrice = 0.0;
+        m_tmpCvd = 0.0;
+
+        m_cvd.clear();
+        m_cvd.append(0.0);
+
+        m_profile.reset();
+
+        m_lastBar = 0;
+        m_numPrevious = 0;
+        m_hasCurrent = false;
+
+        return false;
+    }
+
+    done(timestamp);
+
+    return true;
+}
+
+void OrderFlow::finalize()
+{
+    m_cvd.append(m_cvd.back());
+
+    if (!m_hasCurrent) {
+        return;
+    }
+
+    // the current becomes the last previous, the older is dropped
+    m_numPrevious = o3d::min(m_numPrevious + 1, m_historySize);
+
+    // force to create a new one
+    m_hasCurrent = false;
+}
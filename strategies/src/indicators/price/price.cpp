@@ -71,6 +71,66 @@ void Price::setConf(IndicatorConfig conf)
     }
 }
 
+namespace {
+
+// price of an ohlc given as 8 doubles : timestamp, timeframe, open, high, low, close, volume, ended
+template <Price::Method M> inline o3d::Double methodPrice(const o3d::Double *d);
+
+template <> inline o3d::Double methodPrice<Price::PRICE_CLOSE>(const o3d::Double *d)
+{
+    return d[5];
+}
+
+template <> inline o3d::Double methodPrice<Price::PRICE_HLC>(const o3d::Double *d)
+{
+    return (d[3] + d[4] + d[5]) * (1.0 / 3.0);
+}
+
+template <> inline o3d::Double methodPrice<Price::PRICE_OHLC>(const o3d::Double *d)
+{
+    return (d[2] + d[3] + d[4] + d[5]) * 0.25;
+}
+
+template <> inline o3d::Double methodPrice<Price::PRICE_HL>(const o3d::Double *d)
+{
+    return (d[3] + d[4]) * 0.5;
+}
+
+/**
+ * Unpack n contiguous ohlc into the columns, starting at i. No branch in the loop, the price method
+ * being resolved at compile time.
+ */
+template <Price::Method M>
+void unpack(const o3d::Double *d, o3d::Int32 n, o3d::Int32 i,
+            o3d::Double *timestamp, o3d::Double *open, o3d::Double *high, o3d::Double *low, o3d::Double *close,
+            o3d::Double *price)
+{
+    for (const o3d::Double *end = d + n*8; d != end; d += 8, ++i) {
+        timestamp[i] = d[0];
+        open[i] = d[2];
+        high[i] = d[3];
+        low[i] = d[4];
+        close[i] = d[5];
+
+        price[i] = methodPrice<M>(d);
+    }
+}
+
+//! Unpack the two segments of an ohlc circular array, the older first.
+template <Price::Method M>
+void unpackSegments(const OhlcCircular &ohlc,
+                    o3d::Double *timestamp, o3d::Double *open, o3d::Double *high, o3d::Double *low,
+                    o3d::Double *close, o3d::Double *price)
+{
+    const o3d::Double *first, *second;
+    const o3d::Int32 n = ohlc.segments(first, second);
+
+    unpack<M>(first, n, 0, timestamp, open, high, low, close, price);
+    unpack<M>(second, ohlc.size() - n, n, timestamp, open, high, low, close, price);
+}
+
+} // namespace
+
 void Price::compute(const OhlcCircular &ohlc)
 {
     m_prev = m_last;
@@ -90,104 +150,39 @@ void Price::compute(const OhlcCircular &ohlc)
 
     m_consolidated = false;
 
-    if (m_method == PRICE_CLOSE) {
-        // timestamp, timeframe, open, high, low, close, volume, ended
-        o3d::Int32 i = 0;
-        const Ohlc *cur;
-
-        for (auto cit = ohlc.cbegin(); cit != ohlc.cend(); ++cit) {
-            cur = *cit;
-
-            m_timestamp[i] = cur->timestamp();
-            m_open[i] = cur->open();
-            m_high[i] = cur->high();
-            m_low[i] = cur->low();
-
-            m_price[i] = m_close[i] = cur->close();
-
-            ++i;
-        }
-
-        if (size > 1 && cur && cur->timestamp() > m_lastClosedTimestamp) {
-            m_consolidated = true;
-            m_lastClosedTimestamp = cur->timestamp();
-        }
-    } else if (m_method == PRICE_HLC) {
-        // timestamp, timeframe, open, high, low, close, volume, ended
-        o3d::Int32 i = 0;
-        const Ohlc *cur;
-        const o3d::Double third = 1.0 / 3.0;
-
-        for (auto cit = ohlc.cbegin(); cit != ohlc.cend(); ++cit) {
-            cur = *cit;
-
-            m_timestamp[i] = cur->timestamp();
-            m_open[i] = cur->open();
-            m_high[i] = cur->high();
-            m_low[i] = cur->low();
-            m_close[i] = cur->close();
-
-            m_price[i] = (m_high[i] + m_low[i] + m_close[i]) * third;
-
-            ++i;
-        }
-
-        if (size > 1 && cur && cur->timestamp() > m_lastClosedTimestamp) {
-            m_consolidated = true;
-            m_lastClosedTimestamp = cur->timestamp();
-        }
-    } else if (m_method == PRICE_OHLC) {
-        // timestamp, timeframe, open, high, low, close, volume, ended
-        o3d::Int32 i = 0;
-        const Ohlc *cur;
-        const o3d::Double forth = 1.0 / 4.0;
-
-        for (auto cit = ohlc.cbegin(); cit != ohlc.cend(); ++cit) {
-            cur = *cit;
-
-            m_timestamp[i] = cur->timestamp();
-            m_open[i] = cur->open();
-            m_high[i] = cur->high();
-            m_low[i] = cur->low();
-            m_close[i] = cur->close();
-
-            m_price[i] = (m_open[i] + m_high[i] + m_low[i] + m_close[i]) * forth;
-
-            ++i;
-        }
-
-        if (size > 1 && cur && cur->timestamp() > m_lastClosedTimestamp) {
-            m_consolidated = true;
-            m_lastClosedTimestamp = cur->timestamp();
-        }
-    } else if (m_method == PRICE_HL) {
-        // timestamp, timeframe, open, high, low, close, volume, ended
-        o3d::Int32 i = 0;
-        const Ohlc *cur;
-        const o3d::Double half = 0.5;
-
-        for (auto cit = ohlc.cbegin(); cit != ohlc.cend(); ++cit) {
-            cur = *cit;
-
-            m_timestamp[i] = cur->timestamp();
-            m_open[i] = cur->open();
-            m_high[i] = cur->high();
-            m_low[i] = cur->low();
-            m_close[i] = cur->close();
-
-            m_price[i] = (m_high[i] + m_low[i]) * half;
-
-            ++i;
-        }
-
-        if (size > 1 && cur && cur->timestamp() > m_lastClosedTimestamp) {
-            m_consolidated = true;
-            m_lastClosedTimestamp = cur->timestamp();
-        }
+    if (size == 0) {
+        return;
+    }
+
+    o3d::Double *timestamp = m_timestamp.getData();
+    o3d::Double *open = m_open.getData();
+    o3d::Double *high = m_high.getData();
+    o3d::Double *low = m_low.getData();
+    o3d::Double *close = m_close.getData();
+    o3d::Double *price = m_price.getData();
+
+    switch (m_method) {
+        case PRICE_CLOSE:
+            unpackSegments<PRICE_CLOSE>(ohlc, timestamp, open, high, low, close, price);
+            break;
+        case PRICE_HLC:
+            unpackSegments<PRICE_HLC>(ohlc, timestamp, open, high, low, close, price);
+            break;
+        case PRICE_OHLC:
+            unpackSegments<PRICE_OHLC>(ohlc, timestamp, open, high, low, close, price);
+            break;
+        case PRICE_HL:
+            unpackSegments<PRICE_HL>(ohlc, timestamp, open, high, low, close, price);
+            break;
     }
 
-    m_last = m_price[m_price.getSize()-1];
-    done(m_timestamp[m_timestamp.getSize()-1]);
+    if (size > 1 && timestamp[size-1] > m_lastClosedTimestamp) {
+        m_consolidated = true;
+        m_lastClosedTimestamp = timestamp[size-1];
+    }
+
+    m_last = price[size-1];
+    done(timestamp[size-1]);
 }
 
 void Price::computeMinimalist(const OhlcCircular &ohlc, const Ohlc *current, o3d::Int32 numBars)
@@ -209,73 +204,37 @@ void Price::computeLast(const Ohlc *cur)
 
     m_consolidated = false;
 
-    o3d::Int32 last = m_price.getSize() - 1;
-
-    if (m_method == PRICE_CLOSE) {
-        // timestamp, timeframe, open, high, low, close, volume, ended
-        m_timestamp[last] = cur->timestamp();
-        m_open[last] = cur->open();
-        m_high[last] = cur->high();
-        m_low[last] = cur->low();
-
-        m_price[last] = m_close[last] = cur->close();
-
-        if (cur->timestamp() > m_lastClosedTimestamp) {
-            m_consolidated = true;
-            m_lastClosedTimestamp = cur->timestamp();
-        }
-    } else if (m_method == PRICE_HLC) {
-        // timestamp, timeframe, open, high, low, close, volume, ended
-        const o3d::Double third = 1.0 / 3.0;
-
-        m_timestamp[last] = cur->timestamp();
-        m_open[last] = cur->open();
-        m_high[last] = cur->high();
-        m_low[last] = cur->low();
-        m_close[last] = cur->close();
-
-        m_price[last] = (m_high[last] + m_low[last] + m_close[last]) * third;
-
-        if (cur->timestamp() > m_lastClosedTimestamp) {
-            m_consolidated = true;
-            m_lastClosedTimestamp = cur->timestamp();
-        }
-    } else if (m_method == PRICE_OHLC) {
-        // timestamp, timeframe, open, high, low, close, volume, ended
-        const o3d::Double forth = 1.0 / 4.0;
-
-        m_timestamp[last] = cur->timestamp();
-        m_open[last] = cur->open();
-        m_high[last] = cur->high();
-        m_low[last] = cur->low();
-        m_close[last] = cur->close();
-
-        m_price[last] = (m_open[last] + m_high[last] + m_low[last] + m_close[last]) * forth;
-
-        if (cur->timestamp() > m_lastClosedTimestamp) {
-            m_consolidated = true;
-            m_lastClosedTimestamp = cur->timestamp();
-        }
-    } else if (m_method == PRICE_HL) {
-        // timestamp, timeframe, open, high, low, close, volume, ended
-        const o3d::Double half = 0.5;
-
-        m_timestamp[last] = cur->timestamp();
-        m_open[last] = cur->open();
-        m_high[last] = cur->high();
-        m_low[last] = cur->low();
-        m_close[last] = cur->close();
-
-        m_price[last] = (m_high[last] + m_low[last]) * half;
-
-        if (cur->timestamp() > m_lastClosedTimestamp) {
-            m_consolidated = true;
-            m_lastClosedTimestamp = cur->timestamp();
-        }
+    const o3d::Int32 last = m_price.getSize() - 1;
+
+    o3d::Double *timestamp = m_timestamp.getData();
+    o3d::Double *open = m_open.getData();
+    o3d::Double *high = m_high.getData();
+    o3d::Double *low = m_low.getData();
+    o3d::Double *close = m_close.getData();
+    o3d::Double *price = m_price.getData();
+
+    switch (m_method) {
+        case PRICE_CLOSE:
+            unpack<PRICE_CLOSE>(cur->data(), 1, last, timestamp, open, high, low, close, price);
+            break;
+        case PRICE_HLC:
+            unpack<PRICE_HLC>(cur->data(), 1, last, timestamp, open, high, low, close, price);
+            break;
+        case PRICE_OHLC:
+            unpack<PRICE_OHLC>(cur->data(), 1, last, timestamp, open, high, low, close, price);
+            break;
+        case PRICE_HL:
+            unpack<PRICE_HL>(cur->data(), 1, last, timestamp, open, high, low, close, price);
+            break;
+    }
+
+    if (cur->timestamp() > m_lastClosedTimestamp) {
+        m_consolidated = true;
+        m_lastClosedTimestamp = cur->timestamp();
     }
 
-    m_last = m_price[last];
-    done(m_timestamp[last]);
+    m_last = price[last];
+    done(timestamp[last]);
 }
 
 //void Price::compute(o3d::Double timestamp, const OhlcArray &ohlc, o3d::Int32 ofs)
@@ -7,6 +7,7 @@
 
 #include "siis/indicators/rsi/rsi.h"
 #include "siis/utils/common.h"
+#include "siis/utils/snapshot.h"
 
 #include <ta-lib/ta_func.h>
 
@@ -17,6 +18,7 @@ using o3d::Debug;
 Rsi::Rsi(const o3d::String &name, o3d::Double timeframe, o3d::Int32 len) :
     Indicator (name, timeframe),
     m_len(len),
+    m_native(len),
     m_prev(0.0),
     m_last(0.0)
 {
@@ -33,6 +35,8 @@ Rsi::Rsi(const o3d::String &name, o3d::Double timeframe, IndicatorConfig conf) :
     } else if (conf.data().isArray()) {
         m_len = conf.data().get((Json::ArrayIndex)1, 21).asInt();
     }
+
+    m_native.setLen(m_len);
 }
 
 void Rsi::setConf(IndicatorConfig conf)
@@ -42,9 +46,21 @@ void Rsi::setConf(IndicatorConfig conf)
     } else if (conf.data().isArray()) {
         m_len = conf.data().get((Json::ArrayIndex)1, 21).asInt();
     }
+
+    m_native.setLen(m_len);
 }
 
 void Rsi::compute(o3d::Double timestamp, const DataArray &price)
+{
+    compute(timestamp, nullptr, price);
+}
+
+void Rsi::compute(o3d::Double timestamp, const DataArray &timestamps, const DataArray &price)
+{
+    compute(timestamp, &timestamps, price);
+}
+
+void Rsi::compute(o3d::Double timestamp, const DataArray *timestamps, const DataArray &price)
 {
     o3d::Int32 lb = lookback();
     if (price.getSize() <= lb) {
@@ -53,20 +69,88 @@ void Rsi::compute(o3d::Double timestamp, const DataArray &price)
 
     m_prev = m_last;
 
-    if (m_rsi.getSize() != price.getSize()) {
-        m_rsi.setSize(price.getSize());
+    if (backend() == BACKEND_TALIB) {
+        computeTaLib(price, m_rsi);
+    } else {
+        computeNative(timestamps, price);
+
+        if (backend() == BACKEND_VERIFY) {
+            DataArray reference;
+            computeTaLib(price, reference);
+
+            NativeFeed::verify(*this, "rsi", m_rsi.getLast(), reference.getLast(), NativeFeed::RECURSIVE_TOLERANCE);
+        }
+    }
+
+    m_last = m_rsi.getLast();
+    done(timestamp);
+}
+
+void Rsi::computeNative(const DataArray *timestamps, const DataArray &price)
+{
+    // only the bars since the previous compute, the last one being the forming bar
+    const o3d::Int32 from = m_feed.compute(timestamps, price.getSize());
+    if (m_feed.restarted()) {
+        m_native.reset();
+    }
+
+    m_feed.align(m_rsi);
+
+    const o3d::Int32 last = price.getSize() - 1;
+
+    for (o3d::Int32 i = from; i < last; ++i) {
+        m_rsi[i] = m_native.update(price[i]);
+    }
+
+    m_rsi[last] = m_native.updateProvisional(price[last]);
+}
+
+void Rsi::computeTaLib(const DataArray &price, DataArray &out) const
+{
+    o3d::Int32 lb = lookback();
+
+    if (out.getSize() != price.getSize()) {
+        out.setSize(price.getSize());
     }
 
     int b, n;  // first len data are empty so add offset
-    TA_RetCode res = ::TA_RSI(0, price.getSize(), price.getData(), m_len, &b, &n, m_rsi.getData()+lb);
+    TA_RetCode res = ::TA_RSI(0, price.getSize()-1, price.getData(), m_len, &b, &n, out.getData()+lb);
     if (res != TA_SUCCESS) {
         O3D_WARNING(siis::taErrorToStr(res));
     }
 
     O3D_ASSERT(b == lb);
+}
+
+void Rsi::saveState(SnapshotWriter &writer) const
+{
+    writer.writeDouble(lastTimestamp());
+
+    writer.writeArray(m_rsi);
+    writer.writeDouble(m_prev);
+    writer.writeDouble(m_last);
+
+    m_native.saveState(writer);
+    m_feed.saveState(writer);
+}
+
+o3d::Bool Rsi::loadState(SnapshotReader &reader)
+{
+    const o3d::Double timestamp = reader.readDouble();
+
+    reader.readArray(m_rsi);
+    m_prev = reader.readDouble();
+    m_last = reader.readDouble();
+
+    // else the native state is computed again from the next compute
+    if (!m_native.loadState(reader) || !m_feed.loadState(reader)) {
+        m_feed.reset();
+        return false;
+    }
 
-    m_last = m_rsi.getLast();
     done(timestamp);
+
+    return true;
 }
 
 o3d::Int32 Rsi::lookback() const
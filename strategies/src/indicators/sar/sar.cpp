@@ -7,6 +7,7 @@
 
 #include "siis/indicators/sar/sar.h"
 #include "siis/utils/common.h"
+#include "siis/utils/snapshot.h"
 
 #include <ta-lib/ta_func.h>
 
@@ -18,6 +19,7 @@ Sar::Sar(const o3d::String &name, o3d::Double timeframe, o3d::Double accel, o3d:
     Indicator (name, timeframe),
     m_accel(accel),
     m_max(max),
+    m_native(accel, max),
     m_prev(0.0),
     m_last(0.0)
 {
@@ -37,6 +39,8 @@ Sar::Sar(const o3d::String &name, o3d::Double timeframe, IndicatorConfig conf) :
         m_accel = conf.data().get((Json::ArrayIndex)1, 0.0).asDouble();
         m_max = conf.data().get((Json::ArrayIndex)2, 0.0).asDouble();
     }
+
+    m_native.setup(m_accel, m_max);
 }
 
 void Sar::setConf(IndicatorConfig conf)
@@ -48,9 +52,21 @@ void Sar::setConf(IndicatorConfig conf)
         m_accel = conf.data().get((Json::ArrayIndex)1, 0.0).asDouble();
         m_max = conf.data().get((Json::ArrayIndex)2, 0.0).asDouble();
     }
+
+    m_native.setup(m_accel, m_max);
 }
 
 void Sar::compute(o3d::Double timestamp, const DataArray &high, const DataArray &low)
+{
+    compute(timestamp, nullptr, high, low);
+}
+
+void Sar::compute(o3d::Double timestamp, const DataArray &timestamps, const DataArray &high, const DataArray &low)
+{
+    compute(timestamp, &timestamps, high, low);
+}
+
+void Sar::compute(o3d::Double timestamp, const DataArray *timestamps, const DataArray &high, const DataArray &low)
 {
     o3d::Int32 lb = lookback();
     if (high.getSize() <= lb) {
@@ -59,20 +75,90 @@ void Sar::compute(o3d::Double timestamp, const DataArray &high, const DataArray
 
     m_prev = m_last;
 
-    if (m_sar.getSize() != high.getSize()) {
-        m_sar.setSize(high.getSize());
+    if (backend() == BACKEND_TALIB) {
+        computeTaLib(high, low, m_sar);
+    } else {
+        computeNative(timestamps, high, low);
+
+        if (backend() == BACKEND_VERIFY) {
+            DataArray reference;
+            computeTaLib(high, low, reference);
+
+            NativeFeed::verify(*this, "sar", m_sar.getLast(), reference.getLast(), NativeFeed::RECURSIVE_TOLERANCE);
+        }
+    }
+
+    m_last = m_sar.getLast();
+    done(timestamp);
+}
+
+void Sar::computeNative(const DataArray *timestamps, const DataArray &high, const DataArray &low)
+{
+    // only the bars since the previous compute, the last one being the forming bar
+    const o3d::Int32 from = m_feed.compute(timestamps, high.getSize());
+    if (m_feed.restarted()) {
+        m_native.reset();
+    }
+
+    m_feed.align(m_sar);
+
+    const o3d::Int32 last = high.getSize() - 1;
+
+    for (o3d::Int32 i = from; i < last; ++i) {
+        const NativeBar bar = {high[i], low[i], 0.0};
+        m_sar[i] = m_native.update(bar);
+    }
+
+    const NativeBar bar = {high[last], low[last], 0.0};
+    m_sar[last] = m_native.updateProvisional(bar);
+}
+
+void Sar::computeTaLib(const DataArray &high, const DataArray &low, DataArray &out) const
+{
+    o3d::Int32 lb = lookback();
+
+    if (out.getSize() != high.getSize()) {
+        out.setSize(high.getSize());
     }
 
     int b, n;
-    TA_RetCode res = ::TA_SAR(0, high.getSize()-1, high.getData(), low.getData(), m_accel, m_max, &b, &n, m_sar.getData()+lb);
+    TA_RetCode res = ::TA_SAR(0, high.getSize()-1, high.getData(), low.getData(), m_accel, m_max, &b, &n, out.getData()+lb);
     if (res != TA_SUCCESS) {
         O3D_WARNING(siis::taErrorToStr(res));
     }
 
     O3D_ASSERT(b == lb);
+}
+
+void Sar::saveState(SnapshotWriter &writer) const
+{
+    writer.writeDouble(lastTimestamp());
+
+    writer.writeArray(m_sar);
+    writer.writeDouble(m_prev);
+    writer.writeDouble(m_last);
+
+    m_native.saveState(writer);
+    m_feed.saveState(writer);
+}
+
+o3d::Bool Sar::loadState(SnapshotReader &reader)
+{
+    const o3d::Double timestamp = reader.readDouble();
+
+    reader.readArray(m_sar);
+    m_prev = reader.readDouble();
+    m_last = reader.readDouble();
+
+    // else the native state is computed again from the next compute
+    if (!m_native.loadState(reader) || !m_feed.loadState(reader)) {
+        m_feed.reset();
+        return false;
+    }
 
-    m_last = m_sar.getLast();
     done(timestamp);
+
+    return true;
 }
 
 o3d::Int32 Sar::lookback() const
@@ -7,6 +7,7 @@
 
 #include "siis/indicators/stoch/stoch.h"
 #include "siis/utils/common.h"
+#include "siis/utils/snapshot.h"
 
 #include <ta-lib/ta_func.h>
 
@@ -23,6 +24,9 @@ Stoch::Stoch(const o3d::String &name, o3d::Double timeframe,
     m_slowK_MAType(slowK_MAType),
     m_slowD_Len(slowD_Len),
     m_slowD_MAType(slowD_MAType),
+    m_native(fastK_Len,
+             slowK_Len, NativeMa::supported(slowK_MAType) ? slowK_MAType : MA_SMA,
+             slowD_Len, NativeMa::supported(slowD_MAType) ? slowD_MAType : MA_SMA),
     m_prevSlowK(0.0),
     m_lastSlowK(0.0),
     m_prevSlowD(0.0),
@@ -54,6 +58,10 @@ Stoch::Stoch(const o3d::String &name, o3d::Double timeframe, IndicatorConfig con
         m_slowK_Len = conf.data().get((Json::ArrayIndex)2, 12).asInt();
         m_slowD_Len = conf.data().get((Json::ArrayIndex)3, 3).asInt();
     }
+
+    m_native.setup(m_fastK_Len,
+                   m_slowK_Len, NativeMa::supported(m_slowK_MAType) ? m_slowK_MAType : MA_SMA,
+                   m_slowD_Len, NativeMa::supported(m_slowD_MAType) ? m_slowD_MAType : MA_SMA);
 }
 
 void Stoch::setConf(IndicatorConfig conf)
@@ -70,9 +78,25 @@ void Stoch::setConf(IndicatorConfig conf)
         m_slowK_Len = conf.data().get((Json::ArrayIndex)2, 12).asInt();
         m_slowD_Len = conf.data().get((Json::ArrayIndex)3, 3).asInt();
     }
+
+    m_native.setup(m_fastK_Len,
+                   m_slowK_Len, NativeMa::supported(m_slowK_MAType) ? m_slowK_MAType : MA_SMA,
+                   m_slowD_Len, NativeMa::supported(m_slowD_MAType) ? m_slowD_MAType : MA_SMA);
 }
 
 void Stoch::compute(o3d::Double timestamp, const DataArray &high, const DataArray &low, const DataArray &close)
+{
+    compute(timestamp, nullptr, high, low, close);
+}
+
+void Stoch::compute(o3d::Double timestamp, const DataArray &timestamps,
+                    const DataArray &high, const DataArray &low, const DataArray &close)
+{
+    compute(timestamp, &timestamps, high, low, close);
+}
+
+void Stoch::compute(o3d::Double timestamp, const DataArray *timestamps,
+                    const DataArray &high, const DataArray &low, const DataArray &close)
 {
     o3d::Int32 lb = lookback();
     if (high.getSize() <= lb) {
@@ -82,27 +106,121 @@ void Stoch::compute(o3d::Double timestamp, const DataArray &high, const DataArra
     m_prevSlowK = m_lastSlowK;
     m_prevSlowD = m_lastSlowD;
 
-    o3d::Int32 size = high.getSize();
+    if (backend() == BACKEND_TALIB || !nativeSupported()) {
+        computeTaLib(high, low, close, m_slowK, m_slowD);
+    } else {
+        computeNative(timestamps, high, low, close);
+
+        if (backend() == BACKEND_VERIFY) {
+            DataArray slowK, slowD;
+            computeTaLib(high, low, close, slowK, slowD);
+
+            const o3d::Double tolerance = m_slowK_MAType == MA_EMA || m_slowD_MAType == MA_EMA ?
+                                              NativeFeed::RECURSIVE_TOLERANCE : NativeFeed::WINDOW_TOLERANCE;
+
+            NativeFeed::verify(*this, "slowK", m_slowK.getLast(), slowK.getLast(), tolerance);
+            NativeFeed::verify(*this, "slowD", m_slowD.getLast(), slowD.getLast(), tolerance);
+        }
+    }
+
+    m_lastSlowK = m_slowK.getLast();
+    m_lastSlowD = m_slowD.getLast();
+    done(timestamp);
+}
+
+o3d::Bool Stoch::nativeSupported() const
+{
+    return NativeMa::supported(m_slowK_MAType) && NativeMa::supported(m_slowD_MAType);
+}
+
+void Stoch::computeNative(const DataArray *timestamps,
+                          const DataArray &high, const DataArray &low, const DataArray &close)
+{
+    // only the bars since the previous compute, the last one being the forming bar
+    const o3d::Int32 from = m_feed.compute(timestamps, high.getSize());
+    if (m_feed.restarted()) {
+        m_native.reset();
+    }
+
+    m_feed.align(m_slowK);
+    m_feed.align(m_slowD);
+
+    const o3d::Int32 last = high.getSize() - 1;
+    NativeStoch::Value value;
+
+    for (o3d::Int32 i = from; i < last; ++i) {
+        const NativeBar bar = {high[i], low[i], close[i]};
+        value = m_native.update(bar);
+
+        m_slowK[i] = value.slowK;
+        m_slowD[i] = value.slowD;
+    }
+
+    const NativeBar bar = {high[last], low[last], close[last]};
+    value = m_native.updateProvisional(bar);
 
-    if (m_slowK.getSize() != size) {
-        m_slowK.setSize(size);
-        m_slowD.setSize(size);
+    m_slowK[last] = value.slowK;
+    m_slowD[last] = value.slowD;
+}
+
+void Stoch::computeTaLib(const DataArray &high, const DataArray &low, const DataArray &close,
+                         DataArray &slowK, DataArray &slowD) const
+{
+    o3d::Int32 lb = lookback();
+
+    if (slowK.getSize() != high.getSize()) {
+        slowK.setSize(high.getSize());
+        slowD.setSize(high.getSize());
     }
 
-    int b, n;  // first len data are empty so add offset
+    int b, n;
     TA_RetCode res = ::TA_STOCH(0, high.getSize()-1, high.getData(), low.getData(), close.getData(),
-                                m_fastK_Len, m_slowK_Len, static_cast<TA_MAType>(m_slowK_MAType),
+                                m_fastK_Len,
+                                m_slowK_Len, static_cast<TA_MAType>(m_slowK_MAType),
                                 m_slowD_Len, static_cast<TA_MAType>(m_slowD_MAType),
-                                &b, &n, m_slowK.getData()+lb, m_slowD.getData()+lb);
+                                &b, &n, slowK.getData()+lb, slowD.getData()+lb);
     if (res != TA_SUCCESS) {
         O3D_WARNING(siis::taErrorToStr(res));
     }
 
     O3D_ASSERT(b == lb);
+}
+
+void Stoch::saveState(SnapshotWriter &writer) const
+{
+    writer.writeDouble(lastTimestamp());
+
+    writer.writeArray(m_slowK);
+    writer.writeArray(m_slowD);
+    writer.writeDouble(m_prevSlowK);
+    writer.writeDouble(m_lastSlowK);
+    writer.writeDouble(m_prevSlowD);
+    writer.writeDouble(m_lastSlowD);
+
+    m_native.saveState(writer);
+    m_feed.saveState(writer);
+}
+
+o3d::Bool Stoch::loadState(SnapshotReader &reader)
+{
+    const o3d::Double timestamp = reader.readDouble();
+
+    reader.readArray(m_slowK);
+    reader.readArray(m_slowD);
+    m_prevSlowK = reader.readDouble();
+    m_lastSlowK = reader.readDouble();
+    m_prevSlowD = reader.readDouble();
+    m_lastSlowD = reader.readDouble();
+
+    // else the native state is computed again from the next compute
+    if (!m_native.loadState(reader) || !m_feed.loadState(reader)) {
+        m_feed.reset();
+        return false;
+    }
 
-    m_lastSlowK = m_slowK.getLast();
-    m_lastSlowD = m_slowD.getLast();
     done(timestamp);
+
+    return true;
 }
 
 o3d::Int32 Stoch::lookback() const
@@ -22,6 +22,8 @@ StochRsi::StochRsi(const o3d::String &name, o3d::Double timeframe,
     m_fastK_Len(fastK_Len),
     m_fastD_Len(fastD_Len),
     m_fastD_MAType(fastD_MAType),
+    m_highest(RollingExtremum::MODE_MAX, fastK_Len),
+    m_lowest(RollingExtremum::MODE_MIN, fastK_Len),
     m_prevFastK(0.0),
     m_lastFastK(0.0),
     m_prevFastD(0.0),
@@ -35,6 +37,8 @@ StochRsi::StochRsi(const o3d::String &name, o3d::Double timeframe, IndicatorConf
     m_fastK_Len(0),
     m_fastD_Len(0),
     m_fastD_MAType(MA_SMA),
+    m_highest(RollingExtremum::MODE_MAX),
+    m_lowest(RollingExtremum::MODE_MIN),
     m_prevFastK(0.0),
     m_lastFastK(0.0),
     m_prevFastD(0.0),
@@ -52,6 +56,9 @@ StochRsi::StochRsi(const o3d::String &name, o3d::Double timeframe, IndicatorConf
         m_fastK_Len = conf.data().get((Json::ArrayIndex)2, 12).asInt();
         m_fastD_Len = conf.data().get((Json::ArrayIndex)3, 9).asInt();
     }
+
+    m_highest.setLen(m_fastK_Len);
+    m_lowest.setLen(m_fastK_Len);
 }
 
 void StochRsi::setConf(IndicatorConfig conf)
@@ -68,6 +75,9 @@ void StochRsi::setConf(IndicatorConfig conf)
         m_fastK_Len = conf.data().get((Json::ArrayIndex)2, 12).asInt();
         m_fastD_Len = conf.data().get((Json::ArrayIndex)3, 9).asInt();
     }
+
+    m_highest.setLen(m_fastK_Len);
+    m_lowest.setLen(m_fastK_Len);
 }
 
 void StochRsi::compute(o3d::Double timestamp, const DataArray &price)
@@ -82,20 +92,46 @@ void StochRsi::compute(o3d::Double timestamp, const DataArray &price)
 
     o3d::Int32 size = price.getSize();
 
+    // the values before the lookback of the rsi are never written
+    o3d::Int32 lbRsi = ::TA_RSI_Lookback(m_len);
+
     if (m_fastK.getSize() != size) {
+        m_rsi.setSize(size);
         m_fastK.setSize(size);
         m_fastD.setSize(size);
+
+        m_rsi.zero();
     }
 
     int b, n;
-    TA_RetCode res = ::TA_STOCHRSI(0, price.getSize()-1, price.getData(),
-                                   m_len, m_fastK_Len, m_fastD_Len, static_cast<TA_MAType>(m_fastD_MAType),
-                                   &b, &n, m_fastK.getData()+lb, m_fastD.getData()+lb);
+    TA_RetCode res = ::TA_RSI(0, size-1, price.getData(), m_len, &b, &n, m_rsi.getData()+lbRsi);
+    if (res != TA_SUCCESS) {
+        O3D_WARNING(siis::taErrorToStr(res));
+    }
+
+    // highest and lowest rsi of the fast %K windows
+    m_highest.compute(m_rsi);
+    m_lowest.compute(m_rsi);
+
+    const o3d::Double *hh = m_highest.values().getData();
+    const o3d::Double *ll = m_lowest.values().getData();
+
+    // fast %K with the same operations as TA_STOCHRSI
+    o3d::Int32 lbK = lbRsi + m_fastK_Len - 1;
+
+    for (o3d::Int32 i = lbK; i < size; ++i) {
+        o3d::Double diff = (hh[i] - ll[i]) / 100.0;
+        m_fastK[i] = diff != 0.0 ? (m_rsi[i] - ll[i]) / diff : 0.0;
+    }
+
+    // fast %D smoothing
+    res = ::TA_MA(0, size-1-lbK, m_fastK.getData()+lbK, m_fastD_Len, static_cast<TA_MAType>(m_fastD_MAType),
+                  &b, &n, m_fastD.getData()+lb);
     if (res != TA_SUCCESS) {
         O3D_WARNING(siis::taErrorToStr(res));
     }
 
-    O3D_ASSERT(b == lb);
+    O3D_ASSERT(lbK + b == lb);
 
     m_lastFastK = m_fastK.getLast();
     m_lastFastD = m_fastD.getLast();
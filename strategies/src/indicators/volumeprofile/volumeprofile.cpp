@@ -8,6 +8,7 @@
 #include "siis/indicators/volumeprofile/volumeprofile.h"
 #include "siis/utils/common.h"
 #include "siis/utils/math.h"
+#include "siis/utils/snapshot.h"
 
 #include <vector>
 #include <algorithm>
@@ -16,6 +17,62 @@ using namespace siis;
 using o3d::Logger;
 using o3d::Debug;
 
+static void saveProfile(SnapshotWriter &writer, const VolumeProfileData &vp)
+{
+    writer.writeDouble(vp.timestamp);
+    writer.writeDouble(vp.timeframe);
+    writer.writeDouble(vp.sensibility);
+
+    writer.writeDouble(vp.valPrice);
+    writer.writeDouble(vp.vahPrice);
+
+    writer.writeDouble(vp.pocPrice);
+    writer.writeDouble(vp.pocVolume);
+
+    writer.writeInt32(static_cast<o3d::Int32>(vp.bins.size()));
+
+    for (VolumeProfileData::CIT_BinHashMap cit = vp.bins.cbegin(); cit != vp.bins.cend(); ++cit) {
+        writer.writeDouble(cit->first);
+        writer.writeDouble(cit->second.first);
+        writer.writeDouble(cit->second.second);
+    }
+
+    writer.writeArray(vp.peaks);
+    writer.writeArray(vp.valleys);
+}
+
+static o3d::Bool loadProfile(SnapshotReader &reader, VolumeProfileData &vp)
+{
+    vp.timestamp = reader.readDouble();
+    vp.timeframe = reader.readDouble();
+    vp.sensibility = reader.readDouble();
+
+    vp.valPrice = reader.readDouble();
+    vp.vahPrice = reader.readDouble();
+
+    vp.pocPrice = reader.readDouble();
+    vp.pocVolume = reader.readDouble();
+
+    // validated before allocating the bins
+    const o3d::Int32 numBins = reader.readInt32();
+    if (reader.failed() || numBins < 0 ||
+        static_cast<size_t>(numBins) > reader.remaining() / (3 * sizeof(o3d::Double))) {
+        return false;
+    }
+
+    vp.bins.reserve(static_cast<size_t>(numBins));
+
+    for (o3d::Int32 i = 0; i < numBins; ++i) {
+        const o3d::Double price = reader.readDouble();
+        const o3d::Double bid = reader.readDouble();
+        const o3d::Double ask = reader.readDouble();
+
+        vp.bins[price] = std::make_pair(bid, ask);
+    }
+
+    return reader.readArray(vp.peaks) && reader.readArray(vp.valleys);
+}
+
 
 VolumeProfile::VolumeProfile(const o3d::String &name,
                              o3d::Double timeframe,
@@ -29,6 +86,9 @@ VolumeProfile::VolumeProfile(const o3d::String &name,
     m_sessionDuration(0.0),
     m_tickSize(1.0),
     m_pricePrecision(1),
+    m_invTickSize(1.0),
+    m_binTicks(1),
+    m_binSize(1.0),
     m_historySize(historySize),
     m_sensibility(sensibility),
     m_valueAreaSize(valueAreaSize),
@@ -37,11 +97,11 @@ VolumeProfile::VolumeProfile(const o3d::String &name,
     m_sessionFilter(sessionFilter),
     m_pCurrent(nullptr),
     m_openTimestamp(0.0),
-    m_currentMinPrice(0.0),
-    m_currentMaxPrice(0.0),
+    m_currentMinBin(0),
+    m_currentMaxBin(0),
     m_consolidated(false)
 {
-
+    updateBinSize();
 }
 
 VolumeProfile::VolumeProfile(const o3d::String &name, o3d::Double timeframe, IndicatorConfig conf) :
@@ -50,6 +110,9 @@ VolumeProfile::VolumeProfile(const o3d::String &name, o3d::Double timeframe, Ind
     m_sessionDuration(0.0),
     m_tickSize(1.0),
     m_pricePrecision(1),
+    m_invTickSize(1.0),
+    m_binTicks(1),
+    m_binSize(1.0),
     m_historySize(10),
     m_sensibility(1.0),
     m_valueAreaSize(70.0),
@@ -58,8 +121,8 @@ VolumeProfile::VolumeProfile(const o3d::String &name, o3d::Double timeframe, Ind
     m_sessionFilter(false),
     m_pCurrent(nullptr),
     m_openTimestamp(0.0),
-    m_currentMinPrice(0.0),
-    m_currentMaxPrice(0.0),
+    m_currentMinBin(0),
+    m_currentMaxBin(0),
     m_consolidated(false)
 {
     if (conf.data().isObject()) {
@@ -77,6 +140,8 @@ VolumeProfile::VolumeProfile(const o3d::String &name, o3d::Double timeframe, Ind
         m_tickScale = conf.data().get((Json::ArrayIndex)5, 1.0).asDouble();
         m_sessionFilter = conf.data().get((Json::ArrayIndex)6, 1.0).asBool();
     }
+
+    updateBinSize();
 }
 
 VolumeProfile::~VolumeProfile()
@@ -107,6 +172,8 @@ void VolumeProfile::setConf(IndicatorConfig conf)
         m_tickScale = conf.data().get((Json::ArrayIndex)5, 1.0).asDouble();
         m_sessionFilter = conf.data().get((Json::ArrayIndex)6, 1.0).asBool();
     }
+
+    updateBinSize();
 }
 
 void VolumeProfile::init(o3d::Int32 pricePrecision, o3d::Double tickSize)
@@ -121,6 +188,17 @@ void VolumeProfile::init(o3d::Int32 pricePrecision, o3d::Double tickSize)
 
     m_pricePrecision = pricePrecision;
     m_tickSize = tickSize * m_tickScale;  // pre-mult
+
+    updateBinSize();
+}
+
+void VolumeProfile::updateBinSize()
+{
+    m_invTickSize = 1.0 / m_tickSize;
+
+    // at least one tick per bin
+    m_binTicks = o3d::max<o3d::Int64>(1, ::llround(m_sensibility * m_invTickSize));
+    m_binSize = m_binTicks * m_tickSize;
 }
 
 void VolumeProfile::setSession(o3d::Double sessionOffset, o3d::Double sessionDuration)
@@ -222,6 +300,88 @@ void VolumeProfile::update(const Tick &tick, o3d::Bool finalize)
     done(tick.timestamp());
 }
 
+void VolumeProfile::saveState(SnapshotWriter &writer) const
+{
+    writer.writeInt32(m_historySize);
+    writer.writeDouble(m_binSize);
+
+    writer.writeDouble(lastTimestamp());
+    writer.writeDouble(m_openTimestamp);
+
+    writer.writeInt64(m_currentMinBin);
+    writer.writeInt64(m_currentMaxBin);
+    writer.writeBool(m_consolidated);
+
+    writer.writeBool(m_pCurrent != nullptr);
+    if (m_pCurrent) {
+        saveProfile(writer, *m_pCurrent);
+    }
+
+    writer.writeInt32(static_cast<o3d::Int32>(m_vp.size()));
+
+    for (const VolumeProfileData *vp : m_vp) {
+        saveProfile(writer, *vp);
+    }
+}
+
+o3d::Bool VolumeProfile::loadState(SnapshotReader &reader)
+{
+    if (reader.readInt32() != m_historySize || reader.readDouble() != m_binSize) {
+        return false;
+    }
+
+    if (m_pCurrent) {
+        o3d::deletePtr(m_pCurrent);
+    }
+
+    for (auto vp : m_vp) {
+        o3d::deletePtr(vp);
+    }
+
+    m_vp.clear();
+
+    const o3d::Double timestamp = reader.readDouble();
+    m_openTimestamp = reader.readDouble();
+
+    m_currentMinBin = reader.readInt64();
+    m_currentMaxBin = reader.readInt64();
+    m_consolidated = reader.readBool();
+
+    o3d::Bool result = true;
+
+    if (reader.readBool()) {
+        m_pCurrent = new VolumeProfileData;
+        result = loadProfile(reader, *m_pCurrent);
+    }
+
+    const o3d::Int32 numPrevious = reader.readInt32();
+    result = result && !reader.failed() && numPrevious >= 0 && numPrevious <= m_historySize;
+
+    for (o3d::Int32 i = 0; result && i < numPrevious; ++i) {
+        m_vp.push_back(new VolumeProfileData);
+        result = loadProfile(reader, *m_vp.back());
+    }
+
+    if (!result || reader.failed()) {
+        // restart from an empty state
+        if (m_pCurrent) {
+            o3d::deletePtr(m_pCurrent);
+        }
+
+        for (auto vp : m_vp) {
+            o3d::deletePtr(vp);
+        }
+
+        m_vp.clear();
+
+        return false;
+    }
+
+    done(timestamp);
+
+    return true;
+}
+
 void VolumeProfile::updateValueArea()
 {
 
@@ -455,52 +615,31 @@ void VolumeProfile::createVolumeProfile(o3d::Double timestamp, o3d::Double price
     m_pCurrent->timestamp = timestamp;
     m_pCurrent->sensibility = m_sensibility;
 
-    o3d::Double adjPrice = adjustPrice(price);
-    o3d::Double baseprice = o3d::Int32(adjPrice / m_sensibility) * m_sensibility;
-
-    m_currentMinPrice = m_currentMaxPrice = baseprice;
+    const o3d::Int64 bin = binLevel(price);
 
-    // centered base price
-    o3d::Double centeredBasePrice = baseprice + m_sensibility * 0.5;
+    m_currentMinBin = m_currentMaxBin = bin;
 
-    // initial bin
-    m_pCurrent->bins[centeredBasePrice] = std::make_pair(0.0, 0.0);
+    // initial bin, keyed by its centered price
+    m_pCurrent->bins[binPrice(bin)] = std::make_pair(0.0, 0.0);
 
     // reset state
     m_consolidated = false;
 }
 
-o3d::Double VolumeProfile::basePrice(o3d::Double price) const
-{
-    return o3d::Int32(price / m_sensibility) * m_sensibility;
-}
-
 VolumeProfileData::IT_BinHashMap VolumeProfile::setAt(o3d::Double price)
 {
     O3D_ASSERT(m_pCurrent != nullptr);
 
-    VolumeProfileData::IT_BinHashMap it;
-
-    o3d::Double adjPrice = adjustPrice(price);
-    o3d::Double baseprice = o3d::Int32(adjPrice / m_sensibility) * m_sensibility;
+    const o3d::Int64 bin = binLevel(price);
 
-    // centered base price
-    o3d::Double centeredBasePrice = baseprice + m_sensibility * 0.5;
-
-    if (baseprice < m_currentMinPrice) {
-        m_currentMinPrice = baseprice;
-        it = m_pCurrent->bins.insert(std::make_pair(centeredBasePrice, std::pair<o3d::Double, o3d::Double>(0.0, 0.0))).first;
-    } else if (baseprice > m_currentMaxPrice) {
-        m_currentMaxPrice = baseprice;
-        it = m_pCurrent->bins.insert(std::make_pair(centeredBasePrice, std::pair<o3d::Double, o3d::Double>(0.0, 0.0))).first;
-    } else if (m_pCurrent->bins.find(centeredBasePrice) == m_pCurrent->bins.end()) {
-        // intermediate price;
-        it = m_pCurrent->bins.insert(std::make_pair(centeredBasePrice, std::pair<o3d::Double, o3d::Double>(0.0, 0.0))).first;
-    } else {
-        it = m_pCurrent->bins.find(centeredBasePrice);
+    if (bin < m_currentMinBin) {
+        m_currentMinBin = bin;
+    } else if (bin > m_currentMaxBin) {
+        m_currentMaxBin = bin;
     }
 
-    return it;
+    // found or inserted, keyed by its centered price
+    return m_pCurrent->bins.insert(std::make_pair(binPrice(bin), std::pair<o3d::Double, o3d::Double>(0.0, 0.0))).first;
 }
 
 void VolumeProfile::updatePoc(VolumeProfileData::IT_BinHashMap basePriceIt)
@@ -8,23 +8,134 @@
 #include "siis/indicators/vwap/vwap.h"
 #include "siis/utils/common.h"
 #include "siis/utils/math.h"
+#include "siis/utils/snapshot.h"
 
 #include <o3d/core/math.h>
 
+#include <cstring>
+
 using namespace siis;
 using o3d::Logger;
 using o3d::Debug;
 
-VWapData::VWapData(o3d::Double vwapTimeframe, o3d::Double timestamp, o3d::Int32 numStdDev)
+void VWapAccumulator::reset(o3d::Double _timestamp)
+{
+    timestamp = _timestamp;
+
+    pvs = 0.0;
+    volumes = 0.0;
+    p2vs = 0.0;
+}
+
+o3d::Double VWapAccumulator::stdDev() const
+{
+    if (volumes <= 0.0) {
+        return 0.0;
+    }
+
+    o3d::Double vwap = pvs / volumes;
+    o3d::Double dev2 = o3d::max(p2vs / volumes - vwap * vwap, 0.0);
+
+    return o3d::Math::sqrt(dev2);
+}
+
+void VWapAccumulator::saveState(SnapshotWriter &writer) const
+{
+    writer.writeDouble(timestamp);
+    writer.writeDouble(pvs);
+    writer.writeDouble(volumes);
+    writer.writeDouble(p2vs);
+}
+
+o3d::Bool VWapAccumulator::loadState(SnapshotReader &reader)
+{
+    timestamp = reader.readDouble();
+    pvs = reader.readDouble();
+    volumes = reader.readDouble();
+    p2vs = reader.readDouble();
+
+    return !reader.failed();
+}
+
+VWapData::VWapData() :
+    m_depth(1)
+{
+}
+
+void VWapData::init(o3d::Int32 depth, o3d::Int32 numStdDev)
 {
+    m_depth = o3d::max(depth, 1);
+
+    // reserve the arrays
+    vwap.setSize(m_depth);
     vwap.setSize(1);
 
-    plusStdDev.resize(3);
-    minusStdDev.resize(3);
+    plusStdDev.resize(numStdDev);
+    minusStdDev.resize(numStdDev);
 
     for (o3d::Int32 i = 0; i < numStdDev; ++i) {
+        plusStdDev[i].setSize(m_depth);
+        plusStdDev[i].setSize(1);
+
+        minusStdDev[i].setSize(m_depth);
+        minusStdDev[i].setSize(1);
+    }
+}
+
+void VWapData::reset(o3d::Double vwapTimeframe, o3d::Double _timestamp)
+{
+    timestamp = _timestamp;
+    timeframe = vwapTimeframe;
+
+    sums.reset(_timestamp);
+
+    vwap.setSize(1);
+    vwap[0] = 0.0;
+
+    for (size_t i = 0; i < plusStdDev.size(); ++i) {
         plusStdDev[i].setSize(1);
+        plusStdDev[i][0] = 0.0;
+
         minusStdDev[i].setSize(1);
+        minusStdDev[i][0] = 0.0;
+    }
+}
+
+void VWapData::add(o3d::Double price, o3d::Double volume)
+{
+    sums.add(price, volume);
+
+    const o3d::Double value = sums.vwap();
+    const o3d::Double stdDev = sums.stdDev();
+
+    vwap.set(-1, value);
+
+    for (size_t i = 0; i < plusStdDev.size(); ++i) {
+        minusStdDev[i].set(-1, value - (i+1) * stdDev);
+        plusStdDev[i].set(-1, value + (i+1) * stdDev);
+    }
+}
+
+static void closeArray(DataArray &array, o3d::Int32 depth)
+{
+    const o3d::Double last = array.last();
+
+    if (array.getSize() < depth) {
+        array.push(last);
+    } else {
+        // the older value is dropped, without any allocation
+        memmove(array.getData(), array.getData() + 1, static_cast<size_t>(array.getSize() - 1) * sizeof(o3d::Double));
+        array[array.getSize()-1] = last;
+    }
+}
+
+void VWapData::closeBar()
+{
+    closeArray(vwap, m_depth);
+
+    for (size_t i = 0; i < plusStdDev.size(); ++i) {
+        closeArray(minusStdDev[i], m_depth);
+        closeArray(plusStdDev[i], m_depth);
     }
 }
 
@@ -32,21 +143,58 @@ const DataArray& VWapData::stdDevAt(o3d::Int32 stdDev) const
 {
     if (stdDev == 0) throw o3d::E_IndexOutOfRange("stdDevAt (1)");
 
-    if (stdDev > 0) {
-        o3d::Int32 size = static_cast<o3d::Int32>(minusStdDev.size());
+    o3d::Int32 size = static_cast<o3d::Int32>(minusStdDev.size());
 
-        if (stdDev >= size) throw o3d::E_IndexOutOfRange("stdDevAt (2)");
+    if (stdDev > 0) {
+        if (stdDev > size) throw o3d::E_IndexOutOfRange("stdDevAt (2)");
 
         return plusStdDev[stdDev-1];
     }
 
-    o3d::Int32 size = static_cast<o3d::Int32>(minusStdDev.size());
-
-    if (-stdDev >= size) throw o3d::E_IndexOutOfRange("stdDevAt (3)");
+    if (-stdDev > size) throw o3d::E_IndexOutOfRange("stdDevAt (3)");
 
     return minusStdDev[-stdDev-1];
 }
 
+void VWapData::saveState(SnapshotWriter &writer) const
+{
+    writer.writeInt32(m_depth);
+    writer.writeInt32(static_cast<o3d::Int32>(plusStdDev.size()));
+
+    writer.writeDouble(timestamp);
+    writer.writeDouble(timeframe);
+
+    sums.saveState(writer);
+
+    writer.writeArray(vwap);
+
+    for (size_t i = 0; i < plusStdDev.size(); ++i) {
+        writer.writeArray(minusStdDev[i]);
+        writer.writeArray(plusStdDev[i]);
+    }
+}
+
+o3d::Bool VWapData::loadState(SnapshotReader &reader)
+{
+    if (reader.readInt32() != m_depth || reader.readInt32() != static_cast<o3d::Int32>(plusStdDev.size())) {
+        return false;
+    }
+
+    timestamp = reader.readDouble();
+    timeframe = reader.readDouble();
+
+    sums.loadState(reader);
+
+    reader.readArray(vwap);
+
+    for (size_t i = 0; i < plusStdDev.size(); ++i) {
+        reader.readArray(minusStdDev[i]);
+        reader.readArray(plusStdDev[i]);
+    }
+
+    return !reader.failed();
+}
+
 VWap::VWap(const o3d::String &name,
            o3d::Double timeframe,
            o3d::Int32 depth,
@@ -62,18 +210,19 @@ VWap::VWap(const o3d::String &name,
     m_historySize(historySize),
     m_depth(depth),
     m_sessionFilter(sessionFilter),
-    m_pCurrent(nullptr),
     m_openTimestamp(0.0),
-    m_pvs(0.0),
-    m_volumes(0.0),
-    m_volume_dev(0.0),
-    m_dev2(0.0),
+    m_lastSession(0),
+    m_numPrevious(0),
+    m_hasCurrent(false),
+    m_numAnchors(0),
     m_prev(0.0),
     m_last(0.0)
 {
     if (vwapTimeframe.isValid()) {
         m_vwapTimeframe = timeframeFromStr(vwapTimeframe);
     }
+
+    init();
 }
 
 VWap::VWap(const o3d::String &name, o3d::Double timeframe, o3d::Int32 depth,  IndicatorConfig conf) :
@@ -85,12 +234,11 @@ VWap::VWap(const o3d::String &name, o3d::Double timeframe, o3d::Int32 depth,  In
     m_historySize(0),
     m_depth(depth),
     m_sessionFilter(false),
-    m_pCurrent(nullptr),
     m_openTimestamp(0.0),
-    m_pvs(0.0),
-    m_volumes(0.0),
-    m_volume_dev(0.0),
-    m_dev2(0.0),
+    m_lastSession(0),
+    m_numPrevious(0),
+    m_hasCurrent(false),
+    m_numAnchors(0),
     m_prev(0.0),
     m_last(0.0)
 {
@@ -105,17 +253,12 @@ VWap::VWap(const o3d::String &name, o3d::Double timeframe, o3d::Int32 depth,  In
         m_numStdDev = conf.data().get((Json::ArrayIndex)3, 3).asInt();
         m_sessionFilter = conf.data().get((Json::ArrayIndex)4, false).asBool();
     }
+
+    init();
 }
 
 VWap::~VWap()
 {
-    if (m_pCurrent) {
-        o3d::deletePtr(m_pCurrent);
-    }
-
-    for (auto vwap : m_vwap) {
-        o3d::deletePtr(vwap);
-    }
 }
 
 void VWap::setConf(IndicatorConfig conf)
@@ -131,6 +274,8 @@ void VWap::setConf(IndicatorConfig conf)
         m_numStdDev = conf.data().get((Json::ArrayIndex)3, 3).asInt();
         m_sessionFilter = conf.data().get((Json::ArrayIndex)4, false).asBool();
     }
+
+    init();
 }
 
 void VWap::setSession(o3d::Double sessionOffset, o3d::Double sessionDuration)
@@ -146,7 +291,7 @@ void VWap::setSession(o3d::Double sessionOffset, o3d::Double sessionDuration)
 
 const VWapData* VWap::previous(o3d::Int32 n) const
 {
-    o3d::Int32 size = static_cast<o3d::Int32>(m_vwap.size());
+    o3d::Int32 size = m_numPrevious;
 
     if (n >= size) throw o3d::E_IndexOutOfRange("previous");
 
@@ -155,13 +300,17 @@ const VWapData* VWap::previous(o3d::Int32 n) const
         if (n < 0) throw o3d::E_IndexOutOfRange("previous");
     }
 
-    return m_vwap[n];
+    // the last previous precedes the current session into the ring
+    const o3d::Int32 capacity = static_cast<o3d::Int32>(m_sessions.size());
+    const o3d::Int32 lastPrevious = m_hasCurrent ? m_lastSession - 1 : m_lastSession;
+
+    return &m_sessions[(lastPrevious - (size - 1 - n) + 2 * capacity) % capacity];
 }
 
 o3d::Double VWap::vwapAt(o3d::Int32 n) const
 {
     if (n > -1) {
-        return m_pCurrent != nullptr ? m_pCurrent->vwap.last() : 0.0;
+        return m_hasCurrent ? current()->vwap.last() : 0.0;
     } else {
         return previous(n)->vwap.last();
     }
@@ -170,113 +319,217 @@ o3d::Double VWap::vwapAt(o3d::Int32 n) const
 o3d::Double VWap::stdDevAt(o3d::Int32 n, o3d::Int32 stdDevNum) const
 {
     if (n > -1) {
-        return m_pCurrent != nullptr ? m_pCurrent->stdDevAt(stdDevNum).last() : 0.0;
+        return m_hasCurrent ? current()->stdDevAt(stdDevNum).last() : 0.0;
     } else {
         return previous(n)->stdDevAt(stdDevNum).last();
     }
 }
 
+o3d::Int32 VWap::addAnchor(o3d::Double timestamp)
+{
+    if (m_numAnchors >= MAX_ANCHORS) {
+        // replace the older
+        for (o3d::Int32 i = 1; i < m_numAnchors; ++i) {
+            m_anchors[i-1] = m_anchors[i];
+        }
+
+        --m_numAnchors;
+    }
+
+    m_anchors[m_numAnchors].reset(timestamp);
+
+    return m_numAnchors++;
+}
+
+void VWap::removeAnchor(o3d::Int32 n)
+{
+    if (n < 0 || n >= m_numAnchors) throw o3d::E_IndexOutOfRange("removeAnchor");
+
+    for (o3d::Int32 i = n + 1; i < m_numAnchors; ++i) {
+        m_anchors[i-1] = m_anchors[i];
+    }
+
+    --m_numAnchors;
+}
+
+void VWap::clearAnchors()
+{
+    m_numAnchors = 0;
+}
+
+const VWapAccumulator &VWap::anchor(o3d::Int32 n) const
+{
+    if (n < 0 || n >= m_numAnchors) throw o3d::E_IndexOutOfRange("anchor");
+
+    return m_anchors[n];
+}
+
+o3d::Double VWap::anchorStdDev(o3d::Int32 n, o3d::Int32 stdDevNum) const
+{
+    const VWapAccumulator &acc = anchor(n);
+    return acc.vwap() + stdDevNum * acc.stdDev();
+}
+
 void VWap::update(const Tick &tick, o3d::Bool finalize)
 {
     m_prev = m_last;
 
-    if (m_openTimestamp > 0 && tick.timestamp() >= m_openTimestamp + m_vwapTimeframe) {
+    if (m_hasCurrent && tick.timestamp() >= m_openTimestamp + m_vwapTimeframe) {
         // new VWAP
         this->finalize();
-    } else if (finalize && m_pCurrent) {
+    } else if (finalize && m_hasCurrent) {
         // or finalize the current (intra) bar (not the current VWAP timeframe)
-        m_pCurrent->vwap.push(m_pCurrent->vwap.last());
+        m_sessions[m_lastSession].closeBar();
+    }
 
-        for (o3d::Int32 i = 0; i < m_numStdDev; ++i) {
-            m_pCurrent->minusStdDev[i].push(m_pCurrent->minusStdDev[i].last());
-            m_pCurrent->plusStdDev[i].push(m_pCurrent->plusStdDev[i].last());
+    // anchored VWAP are not limited to the session
+    if (tick.volume() > 0) {
+        for (o3d::Int32 i = 0; i < m_numAnchors; ++i) {
+            if (tick.timestamp() >= m_anchors[i].timestamp) {
+                m_anchors[i].add(tick.last(), tick.volume());
+            }
         }
+    }
+
+    o3d::Double openTimestamp = m_openTimestamp;
+    o3d::Double vwapTimeframe = m_vwapTimeframe;
 
-        if (m_pCurrent->vwap.getSize() > m_depth) {
-            // @todo not optimal with DataArray but could use CircularArray
-            // but in that case it will need a transform to DataArray to process others computations...
+    if (!m_hasCurrent) {
+        // new session beginning timestamp
+        openTimestamp = baseTime(tick.timestamp(), m_vwapTimeframe);
+
+        // session offset and duration only apply to a daily VWAP
+        if (m_vwapTimeframe == TF_DAY && m_sessionFilter) {
+            openTimestamp += m_sessionOffset;
+
+            // timeframe depends on the session duration
+            vwapTimeframe = m_sessionDuration > 0.0 ? m_sessionDuration : m_vwapTimeframe;
         }
     }
 
     // ignore ticks out of the daily session
     if (m_sessionFilter && m_vwapTimeframe == TF_DAY && (m_sessionOffset > 0 || m_sessionDuration > 0)) {
-        if (tick.timestamp() < m_openTimestamp) {
+        if (tick.timestamp() < openTimestamp) {
             return;
         }
 
-        if (tick.timestamp() >= m_openTimestamp + (m_sessionDuration > 0.0 ? m_sessionDuration : m_vwapTimeframe)) {
+        if (tick.timestamp() >= openTimestamp + (m_sessionDuration > 0.0 ? m_sessionDuration : m_vwapTimeframe)) {
             return;
         }
     }
 
-    if (m_pCurrent == nullptr) {
-        // new session beginning timestamp
-        m_openTimestamp = baseTime(tick.timestamp(), m_vwapTimeframe);
+    if (!m_hasCurrent) {
+        // reuse the record following the last one, the older previous if the ring is full
+        m_lastSession = (m_lastSession + 1) % static_cast<o3d::Int32>(m_sessions.size());
+        m_hasCurrent = true;
 
-        o3d::Double vwapTimeframe = 0.0;
+        m_openTimestamp = openTimestamp;
+        m_sessions[m_lastSession].reset(vwapTimeframe, m_openTimestamp);
+    }
 
-        // session offset and duration only apply to a daily VWAP
-        if (m_vwapTimeframe == TF_DAY && m_sessionFilter) {
-            m_openTimestamp += m_sessionOffset;
+    // cumulative
+    if (tick.volume() > 0) {
+        VWapData &current = m_sessions[m_lastSession];
 
-            // timeframe depends on the session duration
-            vwapTimeframe = m_sessionDuration > 0.0 ? m_sessionDuration : m_vwapTimeframe;
-        } else {
-            // or is initially defined
-            vwapTimeframe = m_vwapTimeframe;
-        }
+        current.add(tick.last(), tick.volume());
+        m_last = current.vwap.last();
+    }
+
+    // retain the last tick timestamp
+    done(tick.timestamp());
+}
+
+void VWap::saveState(SnapshotWriter &writer) const
+{
+    writer.writeInt32(static_cast<o3d::Int32>(m_sessions.size()));
+
+    writer.writeDouble(lastTimestamp());
+    writer.writeDouble(m_openTimestamp);
+
+    writer.writeInt32(m_lastSession);
+    writer.writeInt32(m_numPrevious);
+    writer.writeBool(m_hasCurrent);
 
-        m_pCurrent = new VWapData(vwapTimeframe, m_openTimestamp, m_numStdDev);
+    for (const VWapData &session : m_sessions) {
+        session.saveState(writer);
     }
 
-    // cumulative
-    if (tick.volume() > 0) {
-        o3d::Double vwap = 0.0;
+    writer.writeInt32(m_numAnchors);
 
-        m_pvs += tick.last() * tick.volume();  // price * volume
-        m_volumes += tick.volume();
+    for (o3d::Int32 i = 0; i < m_numAnchors; ++i) {
+        m_anchors[i].saveState(writer);
+    }
 
-        m_pCurrent->vwap[m_pCurrent->vwap.getSize()-1] = vwap = m_pvs / m_volumes;
+    writer.writeDouble(m_prev);
+    writer.writeDouble(m_last);
+}
 
-        m_last = m_pCurrent->vwap.last();
+o3d::Bool VWap::loadState(SnapshotReader &reader)
+{
+    if (reader.readInt32() != static_cast<o3d::Int32>(m_sessions.size())) {
+        return false;
+    }
 
-        // std dev
-        m_volume_dev += (tick.last() * tick.last()) * tick.volume();  // price^2 * volume
-        m_dev2 = o3d::max(m_volume_dev / m_volumes - vwap * vwap, 0.0);
+    const o3d::Double timestamp = reader.readDouble();
+    m_openTimestamp = reader.readDouble();
 
-        o3d::Double stdDev = o3d::Math::sqrt(m_dev2);
+    m_lastSession = reader.readInt32();
+    m_numPrevious = reader.readInt32();
+    m_hasCurrent = reader.readBool();
 
-        for (o3d::Int32 i = 0; i < m_numStdDev; ++i) {
-            m_pCurrent->minusStdDev[i].set(-1, vwap - (i+1) * stdDev);
-            m_pCurrent->plusStdDev[i].set(-1, vwap + (i+1) * stdDev);
+    for (VWapData &session : m_sessions) {
+        if (!session.loadState(reader)) {
+            init();
+            return false;
         }
     }
 
-    // retain the last tick timestamp
-    done(tick.timestamp());
+    m_numAnchors = reader.readInt32();
+
+    if (reader.failed() || m_numAnchors < 0 || m_numAnchors > MAX_ANCHORS ||
+        m_lastSession < 0 || m_lastSession >= static_cast<o3d::Int32>(m_sessions.size())) {
+        m_numAnchors = 0;
+        init();
+        return false;
+    }
+
+    for (o3d::Int32 i = 0; i < m_numAnchors; ++i) {
+        m_anchors[i].loadState(reader);
+    }
+
+    m_prev = reader.readDouble();
+    m_last = reader.readDouble();
+
+    done(timestamp);
+
+    return !reader.failed();
 }
 
-void VWap::finalize()
+void VWap::init()
 {
-    if (m_pCurrent == nullptr) {
-        return;
+    m_historySize = o3d::max(m_historySize, 0);
+
+    // current plus history
+    m_sessions.resize(static_cast<size_t>(m_historySize + 1));
+
+    for (VWapData &session : m_sessions) {
+        session.init(m_depth, m_numStdDev);
     }
 
-    if (m_historySize > 0) {
-        m_vwap.push_back(m_pCurrent);
+    m_lastSession = 0;
+    m_numPrevious = 0;
+    m_hasCurrent = false;
+}
 
-        if (static_cast<o3d::Int32>(m_vwap.size()) > m_historySize) {
-            o3d::deletePtr(m_vwap.front());
-            m_vwap.pop_front();
-        }
+void VWap::finalize()
+{
+    if (!m_hasCurrent) {
+        return;
     }
 
-    // reset accumulators
-    m_pvs = 0.0;
-    m_volumes = 0.0;
-    m_volume_dev = 0.0;
-    m_dev2 = 0.0;
+    // the current becomes the last previous, the older is dropped
+    m_numPrevious = o3d::min(m_numPrevious + 1, m_historySize);
 
     // force to create a new one
-    m_pCurrent = nullptr;
+    m_hasCurrent = false;
 }
@@ -7,42 +7,339 @@
 
 #include "siis/indicators/zigzag/zigzag.h"
 #include "siis/utils/common.h"
+#include "siis/utils/snapshot.h"
 
-#include <ta-lib/ta_func.h>
+#include <limits>
 
 using namespace siis;
 using o3d::Logger;
 using o3d::Debug;
 
-ZigZag::ZigZag(const o3d::String &name, o3d::Double timeframe, o3d::Double threshold) :
+ZigZag::ZigZag(const o3d::String &name, o3d::Double timeframe, o3d::Double threshold,
+               Mode mode, o3d::Int32 atrLen, o3d::Int32 depth) :
     Indicator(name, timeframe),
-    m_threshold(threshold)
+    m_threshold(threshold),
+    m_mode(mode),
+    m_atrLen(atrLen),
+    m_depth(depth)
 {
+    reset();
 }
 
 ZigZag::ZigZag(const o3d::String &name, o3d::Double timeframe, IndicatorConfig conf) :
     Indicator(name, timeframe),
-    m_threshold(0.0)
+    m_threshold(0.0),
+    m_mode(MODE_PERCENT),
+    m_atrLen(14),
+    m_depth(32)
 {
     if (conf.data().isObject()) {
         m_threshold = conf.data().get("threshold", 0.05).asDouble();
+        m_mode = modeFromStr(conf.data().get("mode", "percent").asString().c_str());
+        m_atrLen = conf.data().get("atr-len", 14).asInt();
+        m_depth = conf.data().get("depth", 32).asInt();
     } else if (conf.data().isArray()) {
         m_threshold = conf.data().get((Json::ArrayIndex)1, 0.05).asDouble();
+        m_mode = modeFromStr(conf.data().get((Json::ArrayIndex)2, "percent").asString().c_str());
+        m_atrLen = conf.data().get((Json::ArrayIndex)3, 14).asInt();
+        m_depth = conf.data().get((Json::ArrayIndex)4, 32).asInt();
     }
+
+    reset();
 }
 
 void ZigZag::setConf(IndicatorConfig conf)
 {
     if (conf.data().isObject()) {
         m_threshold = conf.data().get("threshold", 0.05).asDouble();
+        m_mode = modeFromStr(conf.data().get("mode", "percent").asString().c_str());
+        m_atrLen = conf.data().get("atr-len", 14).asInt();
+        m_depth = conf.data().get("depth", 32).asInt();
     } else if (conf.data().isArray()) {
         m_threshold = conf.data().get((Json::ArrayIndex)1, 0.05).asDouble();
+        m_mode = modeFromStr(conf.data().get((Json::ArrayIndex)2, "percent").asString().c_str());
+        m_atrLen = conf.data().get((Json::ArrayIndex)3, 14).asInt();
+        m_depth = conf.data().get((Json::ArrayIndex)4, 32).asInt();
     }
+
+    reset();
 }
 
-void ZigZag::compute(o3d::Double timestamp, const DataArray &open, const DataArray &high, const DataArray &low, const DataArray &close)
+void ZigZag::reset()
 {
-    // @todo
+    m_atrLen = o3d::max(m_atrLen, 1);
+    m_depth = o3d::max(m_depth, 1);
+
+    m_pivots.clear();
+    m_numNewPivots = 0;
+
+    m_direction = 0;
+    m_extremePrice = 0.0;
+    m_extremeTimestamp = 0.0;
+
+    m_highPrice = 0.0;
+    m_highTimestamp = 0.0;
+    m_lowPrice = 0.0;
+    m_lowTimestamp = 0.0;
+
+    m_numBars = 0;
+    m_prevClose = 0.0;
+    m_trSum = 0.0;
+    m_atr = 0.0;
+
+    m_lastBarTimestamp = 0.0;
+}
+
+o3d::Bool ZigZag::update(o3d::Double timestamp, o3d::Double high, o3d::Double low, o3d::Double close)
+{
+    // true range and Wilder smoothing
+    o3d::Double tr = high - low;
+    if (m_numBars > 0) {
+        tr = o3d::max(tr, o3d::max(o3d::abs(high - m_prevClose), o3d::abs(low - m_prevClose)));
+    }
+
+    ++m_numBars;
+    m_prevClose = close;
+
+    if (m_numBars < m_atrLen) {
+        m_trSum += tr;
+    } else if (m_numBars == m_atrLen) {
+        m_atr = (m_trSum + tr) / m_atrLen;
+    } else {
+        m_atr = (m_atr * (m_atrLen - 1) + tr) / m_atrLen;
+    }
+
+    if (m_direction == 0) {
+        // range of the bars until the first reversal
+        if (m_numBars == 1 || high > m_highPrice) {
+            m_highPrice = high;
+            m_highTimestamp = timestamp;
+        }
+
+        if (m_numBars == 1 || low < m_lowPrice) {
+            m_lowPrice = low;
+            m_lowTimestamp = timestamp;
+        }
+
+        o3d::Bool up = m_highTimestamp > m_lowTimestamp ||
+                       (m_highTimestamp == m_lowTimestamp && close >= (m_highPrice + m_lowPrice) * 0.5);
+
+        if (up) {
+            if (m_highPrice - m_lowPrice >= distance(m_lowPrice)) {
+                addPivot(m_lowTimestamp, -1, m_lowPrice);
+
+                m_direction = 1;
+                m_extremePrice = m_highPrice;
+                m_extremeTimestamp = m_highTimestamp;
+
+                return true;
+            }
+        } else {
+            if (m_highPrice - m_lowPrice >= distance(m_highPrice)) {
+                addPivot(m_highTimestamp, 1, m_highPrice);
+
+                m_direction = -1;
+                m_extremePrice = m_lowPrice;
+                m_extremeTimestamp = m_lowTimestamp;
+
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    if (m_direction > 0) {
+        if (high > m_extremePrice) {
+            m_extremePrice = high;
+            m_extremeTimestamp = timestamp;
+        }
+
+        if (m_extremePrice - low >= distance(m_extremePrice)) {
+            // swing high confirmed, downward leg
+            addPivot(m_extremeTimestamp, 1, m_extremePrice);
+
+            m_direction = -1;
+            m_extremePrice = low;
+            m_extremeTimestamp = timestamp;
+
+            return true;
+        }
+    } else {
+        if (low < m_extremePrice) {
+            m_extremePrice = low;
+            m_extremeTimestamp = timestamp;
+        }
+
+        if (high - m_extremePrice >= distance(m_extremePrice)) {
+            // swing low confirmed, upward leg
+            addPivot(m_extremeTimestamp, -1, m_extremePrice);
+
+            m_direction = 1;
+            m_extremePrice = high;
+            m_extremeTimestamp = timestamp;
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void ZigZag::compute(o3d::Double timestamp, const DataArray &timestamps,
+                     const DataArray &high, const DataArray &low, const DataArray &close)
+{
+    m_numNewPivots = 0;
+
+    const o3d::Int32 last = timestamps.getSize() - 1;
+
+    for (o3d::Int32 i = firstNewBar(timestamps, m_lastBarTimestamp); i < last; ++i) {
+        if (update(timestamps[i], high[i], low[i], close[i])) {
+            ++m_numNewPivots;
+        }
+
+        m_lastBarTimestamp = timestamps[i];
+    }
 
     done(timestamp);
 }
+
+o3d::Int32 ZigZag::firstNewBar(const DataArray &timestamps, o3d::Double lastBarTimestamp)
+{
+    // the last bar is the current one
+    o3d::Int32 i = timestamps.getSize() - 1;
+
+    while (i > 0 && timestamps[i-1] > lastBarTimestamp) {
+        --i;
+    }
+
+    return o3d::max(i, 0);
+}
+
+o3d::Int32 ZigZag::lookback() const
+{
+    return m_mode == MODE_ATR ? m_atrLen + 1 : 2;
+}
+
+void ZigZag::saveState(SnapshotWriter &writer) const
+{
+    writer.writeDouble(m_threshold);
+    writer.writeInt32(m_mode);
+    writer.writeInt32(m_atrLen);
+    writer.writeInt32(m_depth);
+
+    writer.writeDouble(lastTimestamp());
+
+    writer.writeInt32(static_cast<o3d::Int32>(m_pivots.size()));
+
+    for (const Pivot &pivot : m_pivots) {
+        writer.writeDouble(pivot.timestamp);
+        writer.writeInt32(pivot.direction);
+        writer.writeDouble(pivot.price);
+    }
+
+    writer.writeInt32(m_numNewPivots);
+
+    writer.writeInt32(m_direction);
+    writer.writeDouble(m_extremePrice);
+    writer.writeDouble(m_extremeTimestamp);
+
+    writer.writeDouble(m_highPrice);
+    writer.writeDouble(m_highTimestamp);
+    writer.writeDouble(m_lowPrice);
+    writer.writeDouble(m_lowTimestamp);
+
+    writer.writeInt32(m_numBars);
+    writer.writeDouble(m_prevClose);
+    writer.writeDouble(m_trSum);
+    writer.writeDouble(m_atr);
+
+    writer.writeDouble(m_lastBarTimestamp);
+}
+
+o3d::Bool ZigZag::loadState(SnapshotReader &reader)
+{
+    if (reader.readDouble() != m_threshold || reader.readInt32() != m_mode ||
+        reader.readInt32() != m_atrLen || reader.readInt32() != m_depth) {
+        return false;
+    }
+
+    reset();
+
+    const o3d::Double timestamp = reader.readDouble();
+
+    const o3d::Int32 numPivots = reader.readInt32();
+    if (reader.failed() || numPivots < 0 || numPivots > m_depth) {
+        return false;
+    }
+
+    for (o3d::Int32 i = 0; i < numPivots; ++i) {
+        Pivot pivot;
+
+        pivot.timestamp = reader.readDouble();
+        pivot.direction = reader.readInt32();
+        pivot.price = reader.readDouble();
+
+        m_pivots.push_back(pivot);
+    }
+
+    m_numNewPivots = reader.readInt32();
+
+    m_direction = reader.readInt32();
+    m_extremePrice = reader.readDouble();
+    m_extremeTimestamp = reader.readDouble();
+
+    m_highPrice = reader.readDouble();
+    m_highTimestamp = reader.readDouble();
+    m_lowPrice = reader.readDouble();
+    m_lowTimestamp = reader.readDouble();
+
+    m_numBars = reader.readInt32();
+    m_prevClose = reader.readDouble();
+    m_trSum = reader.readDouble();
+    m_atr = reader.readDouble();
+
+    m_lastBarTimestamp = reader.readDouble();
+
+    if (reader.failed()) {
+        reset();
+        return false;
+    }
+
+    done(timestamp);
+
+    return true;
+}
+
+ZigZag::Mode ZigZag::modeFromStr(const o3d::String &mode)
+{
+    if (mode == "atr") {
+        return MODE_ATR;
+    } else {
+        return MODE_PERCENT;
+    }
+}
+
+o3d::Double ZigZag::distance(o3d::Double price) const
+{
+    if (m_mode == MODE_ATR) {
+        // no pivot until the ATR is defined
+        return m_atr > 0.0 ? m_threshold * m_atr : std::numeric_limits<o3d::Double>::max();
+    } else {
+        return m_threshold * price;
+    }
+}
+
+void ZigZag::addPivot(o3d::Double timestamp, o3d::Int32 direction, o3d::Double price)
+{
+    if (static_cast<o3d::Int32>(m_pivots.size()) >= m_depth) {
+        m_pivots.pop_front();
+    }
+
+    m_pivots.push_back(Pivot());
+
+    Pivot &pivot = m_pivots.back();
+    pivot.timestamp = timestamp;
+    pivot.direction = direction;
+    pivot.price = price;
+}
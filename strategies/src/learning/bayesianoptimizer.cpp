@@ -0,0 +1,274 @@
+/**
+ * @brief SiiS strategy gaussian process bayesian optimizer.
+ * @copyright Copyright (C) 2024 SiiS
+ * @author Frederic SCHERMA (frederic.scherma@gmail.com)
+ * @date 2024-10-13
+ */
+
+#include "siis/learning/bayesianoptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace siis;
+
+namespace {
+
+const o3d::Double NOISE = 1e-4;  //!< kernel diagonal jitter, relative to the standardized scores
+
+//! Solve L x = b in place, L lower triangular n*n.
+void solveLower(const std::vector<o3d::Double> &l, size_t n, std::vector<o3d::Double> &b)
+{
+    for (size_t i = 0; i < n; ++i) {
+        o3d::Double s = b[i];
+        for (size_t k = 0; k < i; ++k) {
+            s -= l[i*n + k] * b[k];
+        }
+        b[i] = s / l[i*n + i];
+    }
+}
+
+//! Solve L^T x = b in place.
+void solveUpper(const std::vector<o3d::Double> &l, size_t n, std::vector<o3d::Double> &b)
+{
+    for (size_t i = n; i-- > 0;) {
+        o3d::Double s = b[i];
+        for (size_t k = i + 1; k < n; ++k) {
+            s -= l[k*n + i] * b[k];
+        }
+        b[i] = s / l[i*n + i];
+    }
+}
+
+o3d::Double normalPdf(o3d::Double z)
+{
+    return std::exp(-0.5 * z * z) / std::sqrt(2.0 * M_PI);
+}
+
+o3d::Double normalCdf(o3d::Double z)
+{
+    return 0.5 * std::erfc(-z / std::sqrt(2.0));
+}
+
+} // anonymous namespace
+
+BayesianOptimizer::BayesianOptimizer(o3d::Int32 dimension, o3d::UInt32 seed,
+                                     o3d::Int32 initialSamples,
+                                     o3d::Int32 numProposals,
+                                     o3d::Int32 maxHistory) :
+    Optimizer(dimension, seed),
+    m_initialSamples(initialSamples > 0 ? initialSamples : 2 * dimension + 2),
+    m_numProposals(o3d::max(16, numProposals)),
+    m_maxHistory(o3d::max(8, maxHistory)),
+    m_lengthScale(0.2)
+{
+
+}
+
+BayesianOptimizer::~BayesianOptimizer()
+{
+
+}
+
+o3d::String BayesianOptimizer::typeName() const
+{
+    return "bayesian";
+}
+
+void BayesianOptimizer::ask(o3d::Int32 count, std::vector<Point> &points)
+{
+    if (numEvaluations() < m_initialSamples) {
+        // random exploration to start
+        for (o3d::Int32 i = 0; i < count; ++i) {
+            points.push_back(randomPoint());
+        }
+
+        return;
+    }
+
+    // training set of the best evaluations, sorted by decreasing score
+    std::vector<size_t> order(m_scores.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+
+    std::sort(order.begin(), order.end(), [this](size_t a, size_t b) { return m_scores[a] > m_scores[b]; });
+
+    if (static_cast<o3d::Int32>(order.size()) > m_maxHistory) {
+        order.resize(static_cast<size_t>(m_maxHistory));
+    }
+
+    o3d::Double mean = 0.0, sqr = 0.0;
+    for (size_t i : order) {
+        mean += m_scores[i];
+        sqr += m_scores[i] * m_scores[i];
+    }
+
+    mean /= order.size();
+    o3d::Double stdDev = std::sqrt(o3d::max(0.0, sqr / order.size() - mean * mean));
+    if (stdDev <= 0.0) {
+        stdDev = 1.0;
+    }
+
+    m_x.clear();
+    m_y.clear();
+
+    for (size_t i : order) {
+        m_x.push_back(m_points[i]);
+        m_y.push_back((m_scores[i] - mean) / stdDev);
+    }
+
+    // length scale of the best marginal likelihood
+    static const o3d::Double LENGTH_SCALES[] = {0.05, 0.1, 0.2, 0.35, 0.5, 0.8};
+
+    o3d::Double bestLikelihood = -std::numeric_limits<o3d::Double>::infinity();
+    o3d::Double bestLengthScale = m_lengthScale;
+
+    for (o3d::Double lengthScale : LENGTH_SCALES) {
+        m_lengthScale = lengthScale;
+        o3d::Double likelihood = fit();
+
+        if (likelihood > bestLikelihood) {
+            bestLikelihood = likelihood;
+            bestLengthScale = lengthScale;
+        }
+    }
+
+    m_lengthScale = bestLengthScale;
+
+    for (o3d::Int32 i = 0; i < count; ++i) {
+        if (fit() == -std::numeric_limits<o3d::Double>::infinity()) {
+            // degenerated surrogate
+            points.push_back(randomPoint());
+            continue;
+        }
+
+        o3d::Double bestY = *std::max_element(m_y.begin(), m_y.end());
+        Point point = propose(bestY);
+
+        // kriging believer : suppose the predicted mean for the next points of the batch
+        o3d::Double mu = 0.0, sigma = 0.0;
+        predict(point, mu, sigma);
+
+        m_x.push_back(point);
+        m_y.push_back(mu);
+
+        points.push_back(point);
+    }
+}
+
+void BayesianOptimizer::update(const std::vector<Point> &, const std::vector<o3d::Double> &)
+{
+    // the surrogate is fitted from the whole history at the next ask
+}
+
+o3d::Double BayesianOptimizer::kernel(const Point &a, const Point &b) const
+{
+    o3d::Double d2 = 0.0;
+    for (size_t d = 0; d < a.size(); ++d) {
+        o3d::Double diff = a[d] - b[d];
+        d2 += diff * diff;
+    }
+
+    return std::exp(-0.5 * d2 / (m_lengthScale * m_lengthScale));
+}
+
+o3d::Double BayesianOptimizer::fit()
+{
+    const size_t n = m_x.size();
+    m_chol.assign(n * n, 0.0);
+
+    // cholesky decomposition of K + noise.I
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j <= i; ++j) {
+            o3d::Double s = kernel(m_x[i], m_x[j]) + (i == j ? NOISE : 0.0);
+
+            for (size_t k = 0; k < j; ++k) {
+                s -= m_chol[i*n + k] * m_chol[j*n + k];
+            }
+
+            if (i == j) {
+                if (s <= 0.0) {
+                    return -std::numeric_limits<o3d::Double>::infinity();
+                }
+
+                m_chol[i*n + i] = std::sqrt(s);
+            } else {
+                m_chol[i*n + j] = s / m_chol[j*n + j];
+            }
+        }
+    }
+
+    m_alpha = m_y;
+    solveLower(m_chol, n, m_alpha);
+    solveUpper(m_chol, n, m_alpha);
+
+    // log marginal likelihood (without the constant)
+    o3d::Double likelihood = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        likelihood -= 0.5 * m_y[i] * m_alpha[i] + std::log(m_chol[i*n + i]);
+    }
+
+    return likelihood;
+}
+
+void BayesianOptimizer::predict(const Point &x, o3d::Double &mean, o3d::Double &sigma) const
+{
+    const size_t n = m_x.size();
+    std::vector<o3d::Double> k(n);
+
+    mean = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        k[i] = kernel(x, m_x[i]);
+        mean += k[i] * m_alpha[i];
+    }
+
+    solveLower(m_chol, n, k);
+
+    o3d::Double var = 1.0;
+    for (size_t i = 0; i < n; ++i) {
+        var -= k[i] * k[i];
+    }
+
+    sigma = std::sqrt(o3d::max(var, 1e-12));
+}
+
+Optimizer::Point BayesianOptimizer::propose(o3d::Double bestY)
+{
+    std::normal_distribution<o3d::Double> gauss(0.0, 1.0);
+    std::uniform_int_distribution<size_t> pick(0, o3d::min<size_t>(m_x.size(), 5) - 1);
+
+    // the training set is sorted by score, then the first ones are the best
+    Point bestPoint;
+    o3d::Double bestEi = -1.0;
+
+    for (o3d::Int32 p = 0; p < m_numProposals; ++p) {
+        Point point;
+
+        if (p % 2 == 0) {
+            // global exploration
+            point = randomPoint();
+        } else {
+            // local exploitation around one of the best points
+            point = m_x[pick(m_rng)];
+            for (o3d::Double &u : point) {
+                u = clip(u + gauss(m_rng) * m_lengthScale * 0.5);
+            }
+        }
+
+        o3d::Double mu = 0.0, sigma = 0.0;
+        predict(point, mu, sigma);
+
+        const o3d::Double xi = 0.01;
+        o3d::Double z = (mu - bestY - xi) / sigma;
+        o3d::Double ei = (mu - bestY - xi) * normalCdf(z) + sigma * normalPdf(z);
+
+        if (ei > bestEi) {
+            bestEi = ei;
+            bestPoint = point;
+        }
+    }
+
+    return bestPoint;
+}
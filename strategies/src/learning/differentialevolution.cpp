@@ -0,0 +1,115 @@
+/**
+ * @brief SiiS strategy differential evolution optimizer.
+ * @copyright Copyright (C) 2024 SiiS
+ * @author Frederic SCHERMA (frederic.scherma@gmail.com)
+ * @date 2024-10-13
+ */
+
+#include "siis/learning/differentialevolution.h"
+
+#include <algorithm>
+
+using namespace siis;
+
+DifferentialEvolution::DifferentialEvolution(o3d::Int32 dimension, o3d::UInt32 seed,
+                                             o3d::Double mutation, o3d::Double crossover) :
+    Optimizer(dimension, seed),
+    m_mutation(mutation),
+    m_crossover(crossover)
+{
+
+}
+
+DifferentialEvolution::~DifferentialEvolution()
+{
+
+}
+
+o3d::String DifferentialEvolution::typeName() const
+{
+    return "differential-evolution";
+}
+
+void DifferentialEvolution::ask(o3d::Int32 count, std::vector<Point> &points)
+{
+    std::uniform_real_distribution<o3d::Double> uniform(0.0, 1.0);
+
+    if (m_population.empty()) {
+        // initial population, one random permutation of the strata per parameter
+        o3d::Int32 n = o3d::max(4, count);
+
+        std::vector<std::vector<o3d::Int32>> strata(static_cast<size_t>(m_dimension));
+        for (std::vector<o3d::Int32> &s : strata) {
+            for (o3d::Int32 i = 0; i < n; ++i) {
+                s.push_back(i);
+            }
+
+            std::shuffle(s.begin(), s.end(), m_rng);
+        }
+
+        for (o3d::Int32 i = 0; i < n; ++i) {
+            Point point(static_cast<size_t>(m_dimension));
+            for (size_t d = 0; d < point.size(); ++d) {
+                point[d] = (strata[d][static_cast<size_t>(i)] + uniform(m_rng)) / n;
+            }
+
+            points.push_back(point);
+        }
+
+        return;
+    }
+
+    const o3d::Int32 n = static_cast<o3d::Int32>(m_population.size());
+    std::uniform_int_distribution<o3d::Int32> pick(0, n - 1);
+    std::uniform_int_distribution<o3d::Int32> pickDim(0, o3d::max(0, m_dimension - 1));
+
+    for (o3d::Int32 i = 0; i < n; ++i) {
+        // three distinct members, distinct from the target
+        o3d::Int32 a, b, c;
+        do { a = pick(m_rng); } while (a == i);
+        do { b = pick(m_rng); } while (b == i || b == a);
+        do { c = pick(m_rng); } while (c == i || c == a || c == b);
+
+        const Point &target = m_population[static_cast<size_t>(i)];
+        const Point &pa = m_population[static_cast<size_t>(a)];
+        const Point &pb = m_population[static_cast<size_t>(b)];
+        const Point &pc = m_population[static_cast<size_t>(c)];
+
+        Point trial(target);
+        o3d::Int32 forced = pickDim(m_rng);
+
+        for (o3d::Int32 d = 0; d < m_dimension; ++d) {
+            if (d == forced || uniform(m_rng) < m_crossover) {
+                o3d::Double v = pa[static_cast<size_t>(d)] + m_mutation * (pb[static_cast<size_t>(d)] - pc[static_cast<size_t>(d)]);
+
+                // bounce back between the target and the violated bound
+                if (v < 0.0) {
+                    v = uniform(m_rng) * target[static_cast<size_t>(d)];
+                } else if (v > 1.0) {
+                    v = target[static_cast<size_t>(d)] + uniform(m_rng) * (1.0 - target[static_cast<size_t>(d)]);
+                }
+
+                trial[static_cast<size_t>(d)] = clip(v);
+            }
+        }
+
+        points.push_back(trial);
+    }
+}
+
+void DifferentialEvolution::update(const std::vector<Point> &points, const std::vector<o3d::Double> &scores)
+{
+    if (m_population.empty()) {
+        m_population = points;
+        m_fitness = scores;
+        return;
+    }
+
+    // greedy selection of the trial against its target
+    for (size_t i = 0; i < points.size() && i < m_population.size(); ++i) {
+        if (scores[i] >= m_fitness[i]) {
+            m_population[i] = points[i];
+            m_fitness[i] = scores[i];
+        }
+    }
+}
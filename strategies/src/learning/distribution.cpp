@@ -0,0 +1,253 @@
+/**
+ * @brief SiiS strategy distribution of the optimize mode over a coordinator and its workers.
+ * @copyright Copyright (C) 2024 SiiS
+ * @author Frederic SCHERMA (frederic.scherma@gmail.com)
+ * @date 2024-10-17
+ */
+
+#include "siis/learning/distribution.h"
+
+#include <o3d/core/debug.h>
+
+#include <json/reader.h>
+#include <json/writer.h>
+
+#include <memory>
+
+using namespace siis;
+using o3d::Debug;
+using o3d::Logger;
+
+Distribution::Distribution() :
+    m_bindAddress("tcp://0.0.0.0:5600"),
+    m_connectAddress("tcp://127.0.0.1:5600"),
+    m_numTimeFolds(1),
+    m_candidatesPerJob(1),
+    m_splitMarkets(true),
+    m_heartbeat(5.0),
+    m_timeout(30.0),
+    m_maxRetries(3),
+    m_numFinished(0),
+    m_numFailed(0)
+{
+
+}
+
+o3d::Bool Distribution::parse(const Json::Value &root)
+{
+    m_bindAddress = root.get("bind", "tcp://0.0.0.0:5600").asString().c_str();
+    m_connectAddress = root.get("connect", "tcp://127.0.0.1:5600").asString().c_str();
+
+    m_numTimeFolds = root.get("time-folds", 1).asInt();
+    m_candidatesPerJob = root.get("candidates-per-job", 1).asInt();
+    m_splitMarkets = root.get("split-markets", true).asBool();
+
+    m_heartbeat = root.get("heartbeat", 5.0).asDouble();
+    m_timeout = root.get("timeout", 30.0).asDouble();
+    m_maxRetries = root.get("max-retries", 3).asInt();
+
+    if (m_numTimeFolds < 1 || m_candidatesPerJob < 1) {
+        ERR("distribution", "Distribution time-folds and candidates-per-job must be greater than 0");
+        return false;
+    }
+
+    if (m_heartbeat <= 0.0 || m_timeout <= m_heartbeat) {
+        ERR("distribution", "Distribution timeout must be greater than the heartbeat");
+        return false;
+    }
+
+    if (m_maxRetries < 0) {
+        ERR("distribution", "Distribution max-retries must be positive");
+        return false;
+    }
+
+    return true;
+}
+
+void Distribution::setAddress(const o3d::String &address)
+{
+    m_bindAddress = address;
+    m_connectAddress = address;
+}
+
+void Distribution::partition(o3d::Int32 iteration,
+                             const std::vector<o3d::Int32> &candidates,
+                             const std::vector<std::string> &markets,
+                             o3d::Double fromTs,
+                             o3d::Double toTs)
+{
+    std::vector<std::vector<std::string>> groups;
+
+    if (m_splitMarkets) {
+        for (const std::string &market : markets) {
+            groups.push_back(std::vector<std::string>(1, market));
+        }
+    } else {
+        groups.push_back(markets);
+    }
+
+    o3d::Double foldLength = (toTs - fromTs) / m_numTimeFolds;
+
+    for (const std::vector<std::string> &group : groups) {
+        for (o3d::Int32 f = 0; f < m_numTimeFolds; ++f) {
+            for (size_t c = 0; c < candidates.size(); c += static_cast<size_t>(m_candidatesPerJob)) {
+                Job job;
+                job.id = static_cast<o3d::Int32>(m_jobs.size());
+                job.iteration = iteration;
+                job.fold = f;
+                job.markets = group;
+                job.fromTs = fromTs + f * foldLength;
+                job.toTs = f + 1 < m_numTimeFolds ? fromTs + (f + 1) * foldLength : toTs;
+
+                size_t end = o3d::min(c + static_cast<size_t>(m_candidatesPerJob), candidates.size());
+                job.candidates.assign(candidates.begin() + static_cast<std::ptrdiff_t>(c),
+                                      candidates.begin() + static_cast<std::ptrdiff_t>(end));
+
+                m_queue.push_back(job.id);
+                m_jobs.push_back(job);
+            }
+        }
+    }
+}
+
+const Distribution::Job *Distribution::job(o3d::Int32 id) const
+{
+    if (id < 0 || id >= static_cast<o3d::Int32>(m_jobs.size())) {
+        return nullptr;
+    }
+
+    return &m_jobs[static_cast<size_t>(id)];
+}
+
+const Distribution::Job *Distribution::lease(const std::string &worker, o3d::Double now)
+{
+    if (m_queue.empty()) {
+        return nullptr;
+    }
+
+    Job &job = m_jobs[static_cast<size_t>(m_queue.front())];
+    m_queue.pop_front();
+
+    job.state = JOB_RUNNING;
+    job.worker = worker;
+    job.deadline = now + m_timeout;
+    ++job.attempt;
+
+    return &job;
+}
+
+o3d::Bool Distribution::heartbeat(o3d::Int32 id, o3d::Int32 attempt, o3d::Double now)
+{
+    if (id < 0 || id >= static_cast<o3d::Int32>(m_jobs.size())) {
+        return false;
+    }
+
+    Job &job = m_jobs[static_cast<size_t>(id)];
+    if (job.state != JOB_RUNNING || job.attempt != attempt) {
+        return false;
+    }
+
+    job.deadline = now + m_timeout;
+    return true;
+}
+
+o3d::Bool Distribution::complete(o3d::Int32 id)
+{
+    if (id < 0 || id >= static_cast<o3d::Int32>(m_jobs.size())) {
+        return false;
+    }
+
+    Job &job = m_jobs[static_cast<size_t>(id)];
+    if (job.state == JOB_DONE || job.state == JOB_FAILED) {
+        return false;
+    }
+
+    if (job.state == JOB_PENDING) {
+        // results of a previous attempt, late but valid
+        m_queue.remove(id);
+    }
+
+    job.state = JOB_DONE;
+    ++m_numFinished;
+
+    return true;
+}
+
+void Distribution::retry(o3d::Int32 id, o3d::Int32 attempt)
+{
+    if (id < 0 || id >= static_cast<o3d::Int32>(m_jobs.size())) {
+        return;
+    }
+
+    Job &job = m_jobs[static_cast<size_t>(id)];
+    if (job.state == JOB_RUNNING && job.attempt == attempt) {
+        requeue(job);
+    }
+}
+
+o3d::Int32 Distribution::expire(o3d::Double now)
+{
+    o3d::Int32 n = 0;
+
+    for (Job &job : m_jobs) {
+        if (job.state == JOB_RUNNING && now > job.deadline) {
+            WARN("distribution", o3d::String("Job {0} lost by worker {1} at attempt {2}")
+                 .arg(job.id).arg(job.worker.c_str()).arg(job.attempt));
+
+            requeue(job);
+            ++n;
+        }
+    }
+
+    return n;
+}
+
+o3d::Bool Distribution::finished(o3d::Int32 iteration) const
+{
+    for (const Job &job : m_jobs) {
+        if (job.iteration == iteration && job.state != JOB_DONE && job.state != JOB_FAILED) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+std::string Distribution::encode(const Json::Value &message)
+{
+    Json::StreamWriterBuilder builder;
+    builder["indentation"] = "";
+
+    return Json::writeString(builder, message);
+}
+
+o3d::Bool Distribution::decode(const char *data, size_t size, Json::Value &message)
+{
+    Json::CharReaderBuilder builder;
+    std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
+
+    std::string errors;
+
+    if (!reader->parse(data, data + size, &message, &errors) || !message.isObject()) {
+        return false;
+    }
+
+    return true;
+}
+
+void Distribution::requeue(Job &job)
+{
+    job.worker.clear();
+
+    if (job.attempt > m_maxRetries) {
+        ERR("distribution", o3d::String("Job {0} failed after {1} attempts").arg(job.id).arg(job.attempt));
+
+        job.state = JOB_FAILED;
+        ++m_numFinished;
+        ++m_numFailed;
+    } else {
+        // retried before the jobs not yet started
+        job.state = JOB_PENDING;
+        m_queue.push_front(job.id);
+    }
+}
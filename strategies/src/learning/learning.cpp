@@ -19,6 +19,7 @@
 #include "siis/learning/supervisor.h"
 #include "siis/collection.h"
 #include "siis/display/displayer.h"
+#include "siis/display/asynclogger.h"
 
 #include "siis/utils/common.h"
 
@@ -43,7 +44,8 @@ Learning::Learning() :
     m_monitor(nullptr),
     m_poolWorker(nullptr),
     m_database(nullptr),
-    m_cache(nullptr)
+    m_cache(nullptr),
+    m_logger(nullptr)
 {
 
 }
@@ -63,6 +65,15 @@ void Learning::init(Displayer *displayer, Config *config, StrategyCollection *co
     O3D_ASSERT(cache != nullptr);
 
     m_displayer = displayer;
+
+    // asynchronous logger (must exists before building the strategies)
+    m_logger = new AsyncLogger(this, displayer, static_cast<o3d::UInt32>(config->getLogRingSize()));
+    m_logger->setEnabled(config->isLogEnabled());
+
+    for (auto pair : config->getLogRateLimits()) {
+        m_logger->setRateLimit(pair.first, pair.second);
+    }
+
     m_database = database;
 
     m_fromTs = config->getFromTs();
@@ -162,6 +173,10 @@ void Learning::terminate(Config *config)
         o3d::deletePtr(m_connector);
     }
 
+    if (m_logger) {
+        o3d::deletePtr(m_logger);
+    }
+
     m_poolWorker = nullptr;
     m_database = nullptr;
     m_cache = nullptr;
@@ -169,6 +184,10 @@ void Learning::terminate(Config *config)
 
 void Learning::start()
 {
+    if (m_logger) {
+        m_logger->start();
+    }
+
      // create a decicaded thread for the timecounter
     if (!m_running) {
         m_running = true;
@@ -184,6 +203,10 @@ void Learning::stop()
         m_running = false;
         m_thread.waitFinish();
     }
+
+    if (m_logger) {
+        m_logger->stop();
+    }
 }
 
 void Learning::sync()
@@ -278,20 +301,20 @@ Cache *Learning::cache()
     return m_cache;
 }
 
+AsyncLogger *Learning::logger()
+{
+    return m_logger;
+}
+
 void Learning::log(const o3d::String &unit, const o3d::String &marketId, const o3d::String &channel,
                    const o3d::String &msg, o3d::System::MessageLevel type)
 {
     // @todo throught the monitor send a log message
-    // m_monitor.log(timestamp(), timeframe, marketId, channel, msg);
-    o3d::DateTime dt;
-    dt.fromTime(timestamp(), true);
+    // m_monitor.log(timestamp(), unit, marketId, channel, msg);
 
-    if (unit.isEmpty()) {
-        m_displayer->display(channel, o3d::String("[{0}] <{2}> : {3}").arg(dt.buildString("%Y-%m-%d %H:%M:%S"))
-                                          .arg(marketId).arg(msg), type);
-    } else {
-        m_displayer->display(channel, o3d::String("[{0}] @{1} <{2}> : {3}").arg(dt.buildString("%Y-%m-%d %H:%M:%S"))
-                                          .arg(unit).arg(marketId).arg(msg), type);
+    // deferred datetime formatting and display into the logger thread
+    if (m_logger) {
+        m_logger->logText(unit, marketId, channel, msg, type);
     }
 }
 
@@ -328,7 +351,7 @@ o3d::Int32 Learning::run(void *)
                 lastTimestamp = market->getTickBuffer().last().timestamp();
 
                 // inject the tick to the strategy
-                supervisor->onTickUpdate(m_curTs, market->getTickBuffer());
+                supervisor->feedTicks(m_curTs, market->getTickBuffer());
 
                 // consume them
                 market->setLastTick(market->getTickBuffer().last());
@@ -382,7 +405,7 @@ o3d::Int32 Learning::run(void *)
                 }
 
                 // inject the tick to the strategy
-                // supervisor->onTickUpdate(m_curTs, market->getTickBuffer());
+                // supervisor->feedTicks(m_curTs, market->getTickBuffer());
 
                 // consume them
                 market->setLastTick(market->getTickBuffer().last());
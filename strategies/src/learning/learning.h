@@ -69,6 +69,8 @@ public:
     virtual Database* database() override;
     virtual Cache* cache() override;
 
+    virtual AsyncLogger* logger() override;
+
     virtual void log(const o3d::String &unit, const o3d::String &marketId, const o3d::String &channel,
                      const o3d::String &msg, o3d::System::MessageLevel type = o3d::System::MSG_INFO) override;
 
@@ -107,6 +109,8 @@ private:
 
     Database *m_database;
     Cache *m_cache;
+
+    AsyncLogger *m_logger;
 };
 
 } // namespace siis
@@ -9,7 +9,42 @@
 
 using namespace siis;
 
+Optimizer::Optimizer(o3d::Int32 dimension, o3d::UInt32 seed) :
+    m_dimension(dimension),
+    m_rng(seed),
+    m_bestScore(0.0)
+{
+
+}
+
 Optimizer::~Optimizer()
 {
 
 }
+
+void Optimizer::tell(const std::vector<Point> &points, const std::vector<o3d::Double> &scores)
+{
+    for (size_t i = 0; i < points.size() && i < scores.size(); ++i) {
+        if (m_scores.empty() || scores[i] > m_bestScore) {
+            m_bestPoint = points[i];
+            m_bestScore = scores[i];
+        }
+
+        m_points.push_back(points[i]);
+        m_scores.push_back(scores[i]);
+    }
+
+    update(points, scores);
+}
+
+Optimizer::Point Optimizer::randomPoint()
+{
+    std::uniform_real_distribution<o3d::Double> uniform(0.0, 1.0);
+
+    Point point(static_cast<size_t>(m_dimension));
+    for (o3d::Double &u : point) {
+        u = uniform(m_rng);
+    }
+
+    return point;
+}
@@ -0,0 +1,316 @@
+/**
+ * @brief SiiS strategy optimization parameter space.
+ * @copyright Copyright (C) 2024 SiiS
+ * @author Frederic SCHERMA (frederic.scherma@gmail.com)
+ * @date 2024-10-09
+ */
+
+#include "siis/learning/parameterspace.h"
+#include "siis/learning/differentialevolution.h"
+#include "siis/learning/bayesianoptimizer.h"
+
+#include <o3d/core/debug.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+using namespace siis;
+using o3d::Debug;
+using o3d::Logger;
+
+ParameterSpace::ParameterSpace() :
+    m_method(METHOD_GRID),
+    m_numSamples(32),
+    m_maxCandidates(4096),
+    m_seed(0),
+    m_numIterations(10),
+    m_batchSize(16),
+    m_mutation(0.6),
+    m_crossover(0.9),
+    m_initialSamples(0)
+{
+
+}
+
+o3d::Bool ParameterSpace::parse(const Json::Value &root)
+{
+    m_ranges.clear();
+
+    o3d::String method = root.get("method", "grid").asString().c_str();
+    if (method == "grid") {
+        m_method = METHOD_GRID;
+    } else if (method == "random") {
+        m_method = METHOD_RANDOM;
+    } else if (method == "latin-hypercube" || method == "lhs") {
+        m_method = METHOD_LATIN_HYPERCUBE;
+    } else if (method == "differential-evolution" || method == "de") {
+        m_method = METHOD_DIFFERENTIAL_EVOLUTION;
+    } else if (method == "bayesian" || method == "gp") {
+        m_method = METHOD_BAYESIAN;
+    } else {
+        ERR("optimization", o3d::String("Unsupported parameter space method {0}").arg(method));
+        return false;
+    }
+
+    m_numSamples = o3d::max(1, root.get("samples", 32).asInt());
+    m_maxCandidates = o3d::max(1, root.get("max-candidates", 4096).asInt());
+    m_seed = root.get("seed", 0).asUInt();
+
+    // iterative methods
+    m_numIterations = o3d::max(1, root.get("iterations", 10).asInt());
+    m_batchSize = o3d::max(4, root.get("batch-size", 16).asInt());
+    m_mutation = root.get("mutation", 0.6).asDouble();
+    m_crossover = o3d::clamp(root.get("crossover", 0.9).asDouble(), 0.0, 1.0);
+    m_initialSamples = root.get("initial-samples", 0).asInt();
+
+    m_earlyStopping = EarlyStopping();
+
+    if (root.isMember("early-stopping")) {
+        Json::Value earlyStopping = root.get("early-stopping", Json::Value());
+
+        m_earlyStopping.checkpoints = o3d::max(0, earlyStopping.get("checkpoints", 0).asInt());
+        m_earlyStopping.quantile = o3d::clamp(earlyStopping.get("quantile", 0.0).asDouble(), 0.0, 1.0);
+        m_earlyStopping.maxLoss = o3d::max(0.0, earlyStopping.get("max-loss", 0.0).asDouble());
+    }
+
+    Json::Value parameters = root.get("parameters", Json::Value());
+    for (auto it = parameters.begin(); it != parameters.end(); ++it) {
+        Range range;
+        range.name = it.name();
+
+        if (it->isMember("values")) {
+            Json::Value values = it->get("values", Json::Value());
+            for (auto vit = values.begin(); vit != values.end(); ++vit) {
+                range.values.push_back(*vit);
+            }
+
+            if (range.values.empty()) {
+                ERR("optimization", o3d::String("Empty list of values for parameter {0}").arg(range.name.c_str()));
+                return false;
+            }
+        } else {
+            range.min = it->get("min", 0.0).asDouble();
+            range.max = it->get("max", 0.0).asDouble();
+            range.step = it->get("step", 0.0).asDouble();
+            range.integer = it->get("type", "float").asString() == "int";
+
+            if (range.max < range.min || range.step < 0.0) {
+                ERR("optimization", o3d::String("Invalid range for parameter {0}").arg(range.name.c_str()));
+                return false;
+            }
+        }
+
+        m_ranges.push_back(range);
+    }
+
+    return true;
+}
+
+void ParameterSpace::generate(std::vector<Json::Value> &candidates) const
+{
+    if (m_ranges.empty()) {
+        // a single candidate with the default parameters
+        candidates.push_back(Json::Value(Json::objectValue));
+        return;
+    }
+
+    if (iterative()) {
+        // given batch per batch by the optimizer
+        return;
+    }
+
+    if (m_method == METHOD_GRID) {
+        generateGrid(candidates);
+    } else if (m_method == METHOD_RANDOM) {
+        generateRandom(candidates);
+    } else if (m_method == METHOD_LATIN_HYPERCUBE) {
+        generateLatinHypercube(candidates);
+    }
+}
+
+void ParameterSpace::generateGrid(std::vector<Json::Value> &candidates) const
+{
+    std::vector<o3d::Int32> index(m_ranges.size(), 0);
+    std::vector<o3d::Int32> steps(m_ranges.size(), 1);
+
+    o3d::Double total = 1.0;
+
+    for (size_t i = 0; i < m_ranges.size(); ++i) {
+        steps[i] = numSteps(m_ranges[i]);
+        total *= steps[i];
+    }
+
+    if (total > m_maxCandidates) {
+        WARN("optimization", o3d::String("Grid of {0} candidates truncated to {1}").arg(total, 0).arg(m_maxCandidates));
+    }
+
+    // odometer over the steps of each parameter
+    while (static_cast<o3d::Int32>(candidates.size()) < m_maxCandidates) {
+        Json::Value candidate(Json::objectValue);
+
+        for (size_t i = 0; i < m_ranges.size(); ++i) {
+            candidate[m_ranges[i].name] = valueAtStep(m_ranges[i], index[i]);
+        }
+
+        candidates.push_back(candidate);
+
+        size_t i = 0;
+        while (i < index.size()) {
+            if (++index[i] < steps[i]) {
+                break;
+            }
+
+            index[i] = 0;
+            ++i;
+        }
+
+        if (i >= index.size()) {
+            break;
+        }
+    }
+}
+
+void ParameterSpace::generateRandom(std::vector<Json::Value> &candidates) const
+{
+    std::mt19937 rng(m_seed);
+    std::uniform_real_distribution<o3d::Double> uniform(0.0, 1.0);
+
+    o3d::Int32 n = o3d::min(m_numSamples, m_maxCandidates);
+
+    for (o3d::Int32 s = 0; s < n; ++s) {
+        Json::Value candidate(Json::objectValue);
+
+        for (const Range &range : m_ranges) {
+            candidate[range.name] = valueAt(range, uniform(rng));
+        }
+
+        candidates.push_back(candidate);
+    }
+}
+
+void ParameterSpace::generateLatinHypercube(std::vector<Json::Value> &candidates) const
+{
+    std::mt19937 rng(m_seed);
+    std::uniform_real_distribution<o3d::Double> uniform(0.0, 1.0);
+
+    o3d::Int32 n = o3d::min(m_numSamples, m_maxCandidates);
+
+    // one random permutation of the n strata per parameter
+    std::vector<std::vector<o3d::Int32>> strata(m_ranges.size());
+
+    for (size_t p = 0; p < m_ranges.size(); ++p) {
+        strata[p].resize(static_cast<size_t>(n));
+        for (o3d::Int32 s = 0; s < n; ++s) {
+            strata[p][static_cast<size_t>(s)] = s;
+        }
+
+        std::shuffle(strata[p].begin(), strata[p].end(), rng);
+    }
+
+    for (o3d::Int32 s = 0; s < n; ++s) {
+        Json::Value candidate(Json::objectValue);
+
+        for (size_t p = 0; p < m_ranges.size(); ++p) {
+            o3d::Double u = (strata[p][static_cast<size_t>(s)] + uniform(rng)) / n;
+            candidate[m_ranges[p].name] = valueAt(m_ranges[p], u);
+        }
+
+        candidates.push_back(candidate);
+    }
+}
+
+o3d::Bool ParameterSpace::iterative() const
+{
+    return (m_method == METHOD_DIFFERENTIAL_EVOLUTION || m_method == METHOD_BAYESIAN) && !m_ranges.empty();
+}
+
+Optimizer* ParameterSpace::createOptimizer() const
+{
+    if (!iterative()) {
+        return nullptr;
+    }
+
+    if (m_method == METHOD_DIFFERENTIAL_EVOLUTION) {
+        return new DifferentialEvolution(dimension(), m_seed, m_mutation, m_crossover);
+    } else if (m_method == METHOD_BAYESIAN) {
+        return new BayesianOptimizer(dimension(), m_seed, m_initialSamples);
+    }
+
+    return nullptr;
+}
+
+Json::Value ParameterSpace::candidateAt(const std::vector<o3d::Double> &point) const
+{
+    Json::Value candidate(Json::objectValue);
+
+    for (size_t i = 0; i < m_ranges.size() && i < point.size(); ++i) {
+        candidate[m_ranges[i].name] = valueAt(m_ranges[i], point[i]);
+    }
+
+    return candidate;
+}
+
+o3d::Int32 ParameterSpace::numSteps(const Range &range)
+{
+    if (!range.values.empty()) {
+        return static_cast<o3d::Int32>(range.values.size());
+    }
+
+    if (range.step > 0.0) {
+        return static_cast<o3d::Int32>(std::floor((range.max - range.min) / range.step + 1e-9)) + 1;
+    }
+
+    if (range.integer) {
+        return static_cast<o3d::Int32>(range.max - range.min) + 1;
+    }
+
+    // bounds only
+    return range.max > range.min ? 2 : 1;
+}
+
+Json::Value ParameterSpace::valueAtStep(const Range &range, o3d::Int32 i)
+{
+    if (!range.values.empty()) {
+        return range.values[static_cast<size_t>(i)];
+    }
+
+    o3d::Double v = range.min;
+
+    if (range.step > 0.0) {
+        v = range.min + i * range.step;
+    } else if (range.integer) {
+        v = range.min + i;
+    } else if (i > 0) {
+        v = range.max;
+    }
+
+    v = o3d::min(v, range.max);
+
+    if (range.integer) {
+        return Json::Value(static_cast<Json::Int>(std::lround(v)));
+    }
+
+    return Json::Value(v);
+}
+
+Json::Value ParameterSpace::valueAt(const Range &range, o3d::Double u)
+{
+    if (!range.values.empty()) {
+        size_t i = static_cast<size_t>(u * range.values.size());
+        return range.values[o3d::min(i, range.values.size() - 1)];
+    }
+
+    o3d::Double v = range.min + u * (range.max - range.min);
+
+    if (range.step > 0.0) {
+        // snap to the step
+        v = o3d::min(range.min + std::round((v - range.min) / range.step) * range.step, range.max);
+    }
+
+    if (range.integer) {
+        return Json::Value(static_cast<Json::Int>(std::lround(v)));
+    }
+
+    return Json::Value(v);
+}
@@ -0,0 +1,156 @@
+/**
+ * @brief SiiS strategy pruning rules of the backtest and optimize modes.
+ * @copyright Copyright (C) 2024 SiiS
+ * @author Frederic SCHERMA (frederic.scherma@gmail.com)
+ * @date 2024-10-14
+ */
+
+#include "siis/learning/pruning.h"
+#include "siis/constants.h"
+#include "siis/utils/common.h"
+
+#include <o3d/core/debug.h>
+
+#include <algorithm>
+
+using namespace siis;
+using o3d::Debug;
+using o3d::Logger;
+
+Pruning::Pruning() :
+    m_maxDrawDown(0.0),
+    m_minTradesPerMonth(0.0),
+    m_minTradesAfter(TF_MONTH),
+    m_numCheckpoints(0),
+    m_medianMargin(0.0),
+    m_minReferences(5),
+    m_fromTs(0.0),
+    m_toTs(0.0)
+{
+
+}
+
+o3d::Bool Pruning::parse(const Json::Value &root)
+{
+    m_maxDrawDown = root.get("max-draw-down", 0.0).asDouble();
+    m_minTradesPerMonth = root.get("min-trades-per-month", 0.0).asDouble();
+    m_minTradesAfter = timeframeFromStr(root.get("min-trades-after", "1M").asString().c_str());
+
+    m_numCheckpoints = root.get("checkpoints", 0).asInt();
+    m_medianMargin = root.get("median-margin", 0.0).asDouble();
+    m_minReferences = o3d::max(1, root.get("min-references", 5).asInt());
+
+    if (m_maxDrawDown < 0.0 || m_minTradesPerMonth < 0.0 || m_minTradesAfter < 0.0) {
+        ERR("pruning", "Pruning draw-down and trades rules must be positive");
+        return false;
+    }
+
+    if (m_numCheckpoints < 0 || m_medianMargin < 0.0) {
+        ERR("pruning", "Pruning checkpoints and median margin must be positive");
+        return false;
+    }
+
+    return true;
+}
+
+o3d::Bool Pruning::enabled() const
+{
+    return m_maxDrawDown > 0.0 || m_minTradesPerMonth > 0.0 || m_numCheckpoints > 0;
+}
+
+void Pruning::setPeriod(o3d::Double fromTs, o3d::Double toTs)
+{
+    m_fromTs = fromTs;
+    m_toTs = toTs;
+}
+
+o3d::Bool Pruning::update(State &state, o3d::Double performance, o3d::Int32 numTrades, o3d::Double timestamp) const
+{
+    if (state.pruned()) {
+        return true;
+    }
+
+    state.peak = o3d::max(state.peak, performance);
+    state.drawDown = o3d::max(state.drawDown, state.peak - performance);
+
+    if (m_maxDrawDown > 0.0 && state.drawDown >= m_maxDrawDown) {
+        state.reason = REASON_DRAW_DOWN;
+        state.timestamp = timestamp;
+
+        return true;
+    }
+
+    o3d::Double elapsed = timestamp - m_fromTs;
+
+    if (m_minTradesPerMonth > 0.0 && elapsed >= m_minTradesAfter && elapsed > 0.0) {
+        if (numTrades < m_minTradesPerMonth * elapsed / TF_MONTH) {
+            state.reason = REASON_MIN_TRADES;
+            state.timestamp = timestamp;
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+o3d::Int32 Pruning::reachCheckpoint(State &state, o3d::Double timestamp) const
+{
+    if (state.checkpoint >= m_numCheckpoints || m_toTs <= m_fromTs) {
+        return -1;
+    }
+
+    // checkpoints equally spaced into the period, the end excluded
+    o3d::Double step = (m_toTs - m_fromTs) / (m_numCheckpoints + 1);
+
+    if (timestamp < m_fromTs + (state.checkpoint + 1) * step) {
+        return -1;
+    }
+
+    return state.checkpoint++;
+}
+
+o3d::Bool Pruning::checkMedian(State &state, o3d::Double performance,
+                               const std::vector<o3d::Double> &references, o3d::Double timestamp) const
+{
+    if (state.pruned()) {
+        return true;
+    }
+
+    if (static_cast<o3d::Int32>(references.size()) < m_minReferences) {
+        return false;
+    }
+
+    std::vector<o3d::Double> sorted(references);
+    size_t half = sorted.size() / 2;
+
+    std::nth_element(sorted.begin(), sorted.begin() + half, sorted.end());
+    o3d::Double median = sorted[half];
+
+    if (sorted.size() % 2 == 0) {
+        median = (median + *std::max_element(sorted.begin(), sorted.begin() + half)) * 0.5;
+    }
+
+    if (performance < median - m_medianMargin) {
+        state.reason = REASON_BELOW_MEDIAN;
+        state.timestamp = timestamp;
+
+        return true;
+    }
+
+    return false;
+}
+
+o3d::String Pruning::reasonToStr(Reason reason)
+{
+    switch (reason) {
+        case REASON_DRAW_DOWN:
+            return "draw-down";
+        case REASON_MIN_TRADES:
+            return "min-trades";
+        case REASON_BELOW_MEDIAN:
+            return "below-median";
+        default:
+            return "";
+    }
+}
@@ -0,0 +1,511 @@
+/**
+ * @brief SiiS strategy append-only binary store of the optimization results.
+ * @copyright Copyright (C) 2024 SiiS
+ * @author Frederic SCHERMA (frederic.scherma@gmail.com)
+ * @date 2024-10-16
+ */
+
+#include "siis/learning/resultstore.h"
+#include "siis/utils/common.h"
+
+#include <o3d/core/debug.h>
+
+#include <json/writer.h>
+
+#include <cmath>
+#include <cstring>
+
+using namespace siis;
+using o3d::Debug;
+using o3d::Logger;
+
+namespace {
+
+const char MAGIC[8] = {'S', 'I', 'I', 'S', 'R', 'S', 'L', 'T'};
+
+enum ValueType
+{
+    TYPE_NULL = 0,
+    TYPE_NUMBER = 1,
+    TYPE_STRING = 2
+};
+
+//
+// little endian encoding
+//
+
+class Encoder
+{
+public:
+
+    std::vector<o3d::UInt8> data;
+
+    void writeUInt8(o3d::UInt8 v)
+    {
+        data.push_back(v);
+    }
+
+    void writeUInt32(o3d::UInt32 v)
+    {
+        for (o3d::Int32 i = 0; i < 4; ++i) {
+            data.push_back(static_cast<o3d::UInt8>(v >> (i * 8)));
+        }
+    }
+
+    void writeInt32(o3d::Int32 v)
+    {
+        writeUInt32(static_cast<o3d::UInt32>(v));
+    }
+
+    void writeDouble(o3d::Double v)
+    {
+        o3d::UInt64 bits;
+        memcpy(&bits, &v, sizeof(bits));
+
+        for (o3d::Int32 i = 0; i < 8; ++i) {
+            data.push_back(static_cast<o3d::UInt8>(bits >> (i * 8)));
+        }
+    }
+
+    void writeString(const std::string &v)
+    {
+        writeInt32(static_cast<o3d::Int32>(v.size()));
+        data.insert(data.end(), v.begin(), v.end());
+    }
+
+    void writeVarint(o3d::UInt64 v)
+    {
+        while (v >= 0x80) {
+            data.push_back(static_cast<o3d::UInt8>(v | 0x80));
+            v >>= 7;
+        }
+
+        data.push_back(static_cast<o3d::UInt8>(v));
+    }
+};
+
+class Decoder
+{
+public:
+
+    const std::vector<o3d::UInt8> &data;
+    size_t pos;
+    o3d::Bool failed;
+
+    Decoder(const std::vector<o3d::UInt8> &_data) : data(_data), pos(0), failed(false) {}
+
+    o3d::Bool check(size_t size)
+    {
+        if (failed || pos + size > data.size()) {
+            failed = true;
+            return false;
+        }
+
+        return true;
+    }
+
+    o3d::UInt8 readUInt8()
+    {
+        return check(1) ? data[pos++] : 0;
+    }
+
+    o3d::UInt32 readUInt32()
+    {
+        o3d::UInt32 v = 0;
+        if (check(4)) {
+            for (o3d::Int32 i = 0; i < 4; ++i) {
+                v |= static_cast<o3d::UInt32>(data[pos++]) << (i * 8);
+            }
+        }
+
+        return v;
+    }
+
+    o3d::Int32 readInt32()
+    {
+        return static_cast<o3d::Int32>(readUInt32());
+    }
+
+    o3d::Double readDouble()
+    {
+        o3d::UInt64 bits = 0;
+        if (check(8)) {
+            for (o3d::Int32 i = 0; i < 8; ++i) {
+                bits |= static_cast<o3d::UInt64>(data[pos++]) << (i * 8);
+            }
+        }
+
+        o3d::Double v;
+        memcpy(&v, &bits, sizeof(v));
+
+        return v;
+    }
+
+    std::string readString()
+    {
+        o3d::Int32 size = readInt32();
+        if (size < 0 || !check(static_cast<size_t>(size))) {
+            failed = true;
+            return std::string();
+        }
+
+        std::string v(reinterpret_cast<const char*>(data.data() + pos), static_cast<size_t>(size));
+        pos += static_cast<size_t>(size);
+
+        return v;
+    }
+
+    o3d::UInt64 readVarint(size_t end)
+    {
+        o3d::UInt64 v = 0;
+        o3d::Int32 shift = 0;
+
+        while (pos < end && shift < 64) {
+            o3d::UInt8 b = data[pos++];
+            v |= static_cast<o3d::UInt64>(b & 0x7f) << shift;
+
+            if ((b & 0x80) == 0) {
+                return v;
+            }
+
+            shift += 7;
+        }
+
+        failed = true;
+        return 0;
+    }
+};
+
+o3d::Bool writeBlock(FILE *file, const std::vector<o3d::UInt8> &payload)
+{
+    Encoder header;
+    header.writeUInt32(static_cast<o3d::UInt32>(payload.size()));
+    header.writeUInt32(crc32(payload.data(), payload.size()));
+
+    // a single write per block, then the blocks of concurrent writers never interleave
+    header.data.insert(header.data.end(), payload.begin(), payload.end());
+
+    o3d::Bool ok = ::fwrite(header.data.data(), header.data.size(), 1, file) == 1;
+    return (::fflush(file) == 0) && ok;
+}
+
+o3d::Bool readBlock(FILE *file, std::vector<o3d::UInt8> &payload)
+{
+    o3d::UInt8 buf[8];
+    if (::fread(buf, sizeof(buf), 1, file) != 1) {
+        return false;
+    }
+
+    std::vector<o3d::UInt8> header(buf, buf + sizeof(buf));
+    Decoder decoder(header);
+
+    o3d::UInt32 size = decoder.readUInt32();
+    o3d::UInt32 crc = decoder.readUInt32();
+
+    payload.resize(size);
+    if (size > 0 && ::fread(payload.data(), size, 1, file) != 1) {
+        return false;
+    }
+
+    return crc32(payload.data(), payload.size()) == crc;
+}
+
+inline o3d::UInt64 zigzag(o3d::Int64 v)
+{
+    return (static_cast<o3d::UInt64>(v) << 1) ^ static_cast<o3d::UInt64>(v >> 63);
+}
+
+inline o3d::Int64 unzigzag(o3d::UInt64 v)
+{
+    return static_cast<o3d::Int64>(v >> 1) ^ -static_cast<o3d::Int64>(v & 1);
+}
+
+} // anonymous namespace
+
+ResultStore::ResultStore() :
+    m_file(nullptr),
+    m_numParameters(0),
+    m_numStats(0),
+    m_precision(1e-6),
+    m_numRows(0)
+{
+
+}
+
+ResultStore::~ResultStore()
+{
+    close();
+}
+
+o3d::Bool ResultStore::create(const o3d::String &filename,
+                              const std::vector<std::string> &parameters,
+                              const std::vector<std::string> &stats,
+                              o3d::Double precision)
+{
+    m_mutex.lock();
+
+    if (m_file) {
+        ::fclose(m_file);
+        m_file = nullptr;
+    }
+
+    m_filename = filename;
+    m_numParameters = static_cast<o3d::Int32>(parameters.size());
+    m_numStats = static_cast<o3d::Int32>(stats.size());
+    m_precision = precision > 0.0 ? precision : 1e-6;
+    m_numRows = 0;
+
+    m_file = ::fopen(filename.toUtf8().getData(), "wb");
+    if (!m_file) {
+        m_mutex.unlock();
+
+        ERR("optimization", o3d::String("Unable to create result store {0}").arg(filename));
+        return false;
+    }
+
+    Encoder schema;
+
+    schema.writeInt32(m_numParameters);
+    for (const std::string &name : parameters) {
+        schema.writeString(name);
+    }
+
+    schema.writeInt32(m_numStats);
+    for (const std::string &name : stats) {
+        schema.writeString(name);
+    }
+
+    Encoder header;
+    header.data.assign(MAGIC, MAGIC + sizeof(MAGIC));
+    header.writeUInt32(VERSION);
+
+    o3d::Bool ok = ::fwrite(header.data.data(), header.data.size(), 1, m_file) == 1;
+    ok = ok && writeBlock(m_file, schema.data);
+
+    if (!ok) {
+        ::fclose(m_file);
+        m_file = nullptr;
+    }
+
+    m_mutex.unlock();
+
+    if (!ok) {
+        ERR("optimization", o3d::String("Unable to write result store {0}").arg(filename));
+    }
+
+    return ok;
+}
+
+void ResultStore::close()
+{
+    m_mutex.lock();
+
+    if (m_file) {
+        ::fclose(m_file);
+        m_file = nullptr;
+    }
+
+    m_mutex.unlock();
+}
+
+o3d::Bool ResultStore::append(const Row &row)
+{
+    // encoded out of the lock
+    Encoder encoder;
+    encoder.data.reserve(64 + row.parameters.size() * 16 + row.stats.size() * 8 + row.equity.size() * 2);
+
+    encoder.writeInt32(row.candidate);
+    encoder.writeInt32(row.iteration);
+    encoder.writeInt32(row.pruned);
+    encoder.writeInt32(row.flags);
+
+    for (o3d::Int32 i = 0; i < m_numParameters; ++i) {
+        const Json::Value *value = static_cast<size_t>(i) < row.parameters.size() ? &row.parameters[static_cast<size_t>(i)] : nullptr;
+
+        if (!value || value->isNull()) {
+            encoder.writeUInt8(TYPE_NULL);
+        } else if (value->isNumeric() || value->isBool()) {
+            encoder.writeUInt8(TYPE_NUMBER);
+            encoder.writeDouble(value->asDouble());
+        } else if (value->isString()) {
+            encoder.writeUInt8(TYPE_STRING);
+            encoder.writeString(value->asString());
+        } else {
+            // arrays and objects as compact JSON
+            Json::StreamWriterBuilder builder;
+            builder["indentation"] = "";
+
+            encoder.writeUInt8(TYPE_STRING);
+            encoder.writeString(Json::writeString(builder, *value));
+        }
+    }
+
+    for (o3d::Int32 i = 0; i < m_numStats; ++i) {
+        encoder.writeDouble(static_cast<size_t>(i) < row.stats.size() ? row.stats[static_cast<size_t>(i)] : 0.0);
+    }
+
+    encoder.writeInt32(static_cast<o3d::Int32>(row.equity.size()));
+
+    if (!row.equity.empty()) {
+        encoder.writeDouble(row.equityFrom);
+        encoder.writeDouble(row.equityStep);
+        encoder.writeDouble(m_precision);
+
+        // quantized values, delta then zig-zag varint encoded
+        Encoder deltas;
+        o3d::Int64 prev = 0;
+
+        for (o3d::Double v : row.equity) {
+            o3d::Int64 q = static_cast<o3d::Int64>(std::llround(v / m_precision));
+            deltas.writeVarint(zigzag(q - prev));
+            prev = q;
+        }
+
+        encoder.writeInt32(static_cast<o3d::Int32>(deltas.data.size()));
+        encoder.data.insert(encoder.data.end(), deltas.data.begin(), deltas.data.end());
+    }
+
+    m_mutex.lock();
+
+    o3d::Bool ok = m_file && writeBlock(m_file, encoder.data);
+    if (ok) {
+        ++m_numRows;
+    }
+
+    m_mutex.unlock();
+
+    return ok;
+}
+
+ResultStoreReader::ResultStoreReader() :
+    m_file(nullptr)
+{
+
+}
+
+ResultStoreReader::~ResultStoreReader()
+{
+    close();
+}
+
+o3d::Bool ResultStoreReader::open(const o3d::String &filename)
+{
+    close();
+
+    m_file = ::fopen(filename.toUtf8().getData(), "rb");
+    if (!m_file) {
+        return false;
+    }
+
+    o3d::UInt8 buf[12];
+    if (::fread(buf, sizeof(buf), 1, m_file) != 1 || memcmp(buf, MAGIC, sizeof(MAGIC)) != 0) {
+        WARN("optimization", o3d::String("Invalid result store {0}").arg(filename));
+        close();
+        return false;
+    }
+
+    std::vector<o3d::UInt8> version(buf + sizeof(MAGIC), buf + sizeof(buf));
+    if (Decoder(version).readUInt32() != ResultStore::VERSION) {
+        WARN("optimization", o3d::String("Unsupported result store version for {0}").arg(filename));
+        close();
+        return false;
+    }
+
+    std::vector<o3d::UInt8> payload;
+    if (!readBlock(m_file, payload)) {
+        WARN("optimization", o3d::String("Corrupted result store schema {0}").arg(filename));
+        close();
+        return false;
+    }
+
+    Decoder decoder(payload);
+
+    o3d::Int32 n = decoder.readInt32();
+    for (o3d::Int32 i = 0; i < n && !decoder.failed; ++i) {
+        m_parameters.push_back(decoder.readString());
+    }
+
+    n = decoder.readInt32();
+    for (o3d::Int32 i = 0; i < n && !decoder.failed; ++i) {
+        m_stats.push_back(decoder.readString());
+    }
+
+    if (decoder.failed) {
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void ResultStoreReader::close()
+{
+    if (m_file) {
+        ::fclose(m_file);
+        m_file = nullptr;
+    }
+
+    m_parameters.clear();
+    m_stats.clear();
+}
+
+o3d::Bool ResultStoreReader::next(ResultStore::Row &row)
+{
+    std::vector<o3d::UInt8> payload;
+    if (!m_file || !readBlock(m_file, payload)) {
+        return false;
+    }
+
+    Decoder decoder(payload);
+
+    row.candidate = decoder.readInt32();
+    row.iteration = decoder.readInt32();
+    row.pruned = decoder.readInt32();
+    row.flags = decoder.readInt32();
+
+    row.parameters.clear();
+    for (size_t i = 0; i < m_parameters.size(); ++i) {
+        o3d::UInt8 type = decoder.readUInt8();
+
+        if (type == TYPE_NUMBER) {
+            row.parameters.push_back(Json::Value(decoder.readDouble()));
+        } else if (type == TYPE_STRING) {
+            row.parameters.push_back(Json::Value(decoder.readString()));
+        } else {
+            row.parameters.push_back(Json::Value());
+        }
+    }
+
+    row.stats.clear();
+    for (size_t i = 0; i < m_stats.size(); ++i) {
+        row.stats.push_back(decoder.readDouble());
+    }
+
+    row.equity.clear();
+    row.equityFrom = 0.0;
+    row.equityStep = 0.0;
+
+    o3d::Int32 count = decoder.readInt32();
+    if (count > 0) {
+        row.equityFrom = decoder.readDouble();
+        row.equityStep = decoder.readDouble();
+        o3d::Double precision = decoder.readDouble();
+
+        o3d::Int32 size = decoder.readInt32();
+        if (size < 0 || !decoder.check(static_cast<size_t>(size))) {
+            return false;
+        }
+
+        size_t end = decoder.pos + static_cast<size_t>(size);
+        o3d::Int64 q = 0;
+
+        row.equity.reserve(static_cast<size_t>(count));
+
+        for (o3d::Int32 i = 0; i < count && !decoder.failed; ++i) {
+            q += unzigzag(decoder.readVarint(end));
+            row.equity.push_back(q * precision);
+        }
+    }
+
+    return !decoder.failed;
+}
@@ -0,0 +1,193 @@
+/**
+ * @brief SiiS strategy walk-forward and cross-validation of the optimize mode.
+ * @copyright Copyright (C) 2024 SiiS
+ * @author Frederic SCHERMA (frederic.scherma@gmail.com)
+ * @date 2024-10-11
+ */
+
+#include "siis/learning/validation.h"
+#include "siis/utils/common.h"
+
+#include <o3d/core/debug.h>
+
+#include <algorithm>
+
+using namespace siis;
+using o3d::Debug;
+using o3d::Logger;
+
+Validation::Validation() :
+    m_method(METHOD_WALK_FORWARD),
+    m_numFolds(5),
+    m_inSampleRatio(0.75),
+    m_anchored(false),
+    m_embargo(0.0),
+    m_fromTs(0.0),
+    m_toTs(0.0)
+{
+
+}
+
+o3d::Bool Validation::parse(const Json::Value &root)
+{
+    o3d::String method = root.get("method", "walk-forward").asString().c_str();
+    if (method == "walk-forward") {
+        m_method = METHOD_WALK_FORWARD;
+    } else if (method == "k-fold") {
+        m_method = METHOD_K_FOLD;
+    } else {
+        ERR("optimization", o3d::String("Unsupported validation method {0}").arg(method));
+        return false;
+    }
+
+    m_numFolds = root.get("folds", 5).asInt();
+    m_inSampleRatio = root.get("in-sample-ratio", 0.75).asDouble();
+    m_anchored = root.get("anchored", false).asBool();
+    m_embargo = timeframeFromStr(root.get("embargo", "").asString().c_str());
+
+    if (m_numFolds < 2) {
+        ERR("optimization", "Validation needs at least 2 folds");
+        return false;
+    }
+
+    if (m_inSampleRatio <= 0.0 || m_inSampleRatio >= 1.0) {
+        ERR("optimization", "Validation in-sample ratio must be in ]0, 1[");
+        return false;
+    }
+
+    if (m_embargo < 0.0) {
+        ERR("optimization", "Validation embargo must be positive");
+        return false;
+    }
+
+    return true;
+}
+
+void Validation::generate(o3d::Double fromTs, o3d::Double toTs)
+{
+    m_fromTs = fromTs;
+    m_toTs = toTs;
+
+    m_folds.clear();
+
+    o3d::Double span = toTs - fromTs;
+    if (span <= 0.0) {
+        return;
+    }
+
+    if (m_method == METHOD_WALK_FORWARD) {
+        // span = inSample + n * outOfSample, with inSample = ratio / (1 - ratio) * outOfSample
+        o3d::Double isFactor = m_inSampleRatio / (1.0 - m_inSampleRatio);
+        o3d::Double oosLength = span / (m_numFolds + isFactor);
+        o3d::Double isLength = isFactor * oosLength;
+
+        for (o3d::Int32 i = 0; i < m_numFolds; ++i) {
+            Fold fold;
+            fold.index = i;
+
+            fold.outOfSampleFrom = fromTs + isLength + i * oosLength;
+            fold.outOfSampleTo = (i == m_numFolds - 1) ? toTs : fold.outOfSampleFrom + oosLength;
+
+            fold.inSampleFrom = m_anchored ? fromTs : fold.outOfSampleFrom - isLength;
+            fold.inSampleTo = fold.outOfSampleFrom;
+
+            // the last in-sample trades could still be open in the out-of-sample block
+            fold.purgeFrom = fold.outOfSampleFrom - m_embargo;
+            fold.purgeTo = fold.outOfSampleTo + m_embargo;
+
+            m_folds.push_back(fold);
+        }
+    } else if (m_method == METHOD_K_FOLD) {
+        // contiguous blocks, the in-sample is the whole range except the tested block
+        o3d::Double blockLength = span / m_numFolds;
+
+        for (o3d::Int32 i = 0; i < m_numFolds; ++i) {
+            Fold fold;
+            fold.index = i;
+
+            fold.outOfSampleFrom = fromTs + i * blockLength;
+            fold.outOfSampleTo = (i == m_numFolds - 1) ? toTs : fold.outOfSampleFrom + blockLength;
+
+            fold.inSampleFrom = fromTs;
+            fold.inSampleTo = toTs;
+
+            // on both sides, the following in-sample block would be correlated with the tested one
+            fold.purgeFrom = fold.outOfSampleFrom - m_embargo;
+            fold.purgeTo = fold.outOfSampleTo + m_embargo;
+
+            m_folds.push_back(fold);
+        }
+    }
+}
+
+Validation::WindowStats Validation::inSampleStats(const std::vector<const Statistics*> &stats, const Fold &fold) const
+{
+    return windowStats(stats, fold.inSampleFrom, fold.inSampleTo, fold.purgeFrom, fold.purgeTo);
+}
+
+Validation::WindowStats Validation::outOfSampleStats(const std::vector<const Statistics*> &stats, const Fold &fold) const
+{
+    return windowStats(stats, fold.outOfSampleFrom, fold.outOfSampleTo);
+}
+
+o3d::Double Validation::inSampleDuration(const Fold &fold)
+{
+    o3d::Double purged = o3d::min(fold.inSampleTo, fold.purgeTo) - o3d::max(fold.inSampleFrom, fold.purgeFrom);
+    return fold.inSampleTo - fold.inSampleFrom - o3d::max(0.0, purged);
+}
+
+static bool compareExit(const TradeResults *a, const TradeResults *b)
+{
+    return a->exitTimestamp < b->exitTimestamp;
+}
+
+Validation::WindowStats Validation::windowStats(const std::vector<const Statistics*> &stats,
+                                                o3d::Double from, o3d::Double to,
+                                                o3d::Double excludeFrom, o3d::Double excludeTo)
+{
+    WindowStats result;
+    std::vector<const TradeResults*> trades;
+
+    for (const Statistics *s : stats) {
+        for (const TradeResults &trade : s->tradesResults) {
+            if (trade.entryTimestamp < from || trade.entryTimestamp >= to) {
+                continue;
+            }
+
+            // purged, entered or exited in the excluded period, or spanning it
+            if (trade.entryTimestamp < excludeTo && trade.exitTimestamp >= excludeFrom) {
+                continue;
+            }
+
+            trades.push_back(&trade);
+        }
+    }
+
+    // the trades of the different markets in the order of their exit for the draw-down
+    std::sort(trades.begin(), trades.end(), compareExit);
+
+    o3d::Double cumPerformance = 0.0;
+    o3d::Double maxPerformance = 0.0;
+
+    for (const TradeResults *trade : trades) {
+        cumPerformance += trade->profitLossPct;
+        maxPerformance = o3d::max(maxPerformance, cumPerformance);
+
+        result.maxDrawDownRate = o3d::max(result.maxDrawDownRate, maxPerformance - cumPerformance);
+
+        result.best = o3d::max(result.best, trade->profitLossPct);
+        result.worst = o3d::min(result.worst, trade->profitLossPct);
+
+        if (trade->profitLossPct > 0.0) {
+            ++result.succeedTrades;
+        } else {
+            ++result.failedTrades;
+        }
+
+        ++result.totalTrades;
+    }
+
+    result.performance = cumPerformance;
+
+    return result;
+}
@@ -14,6 +14,10 @@
 #include "siis/market.h"
 #include "siis/collection.h"
 #include "siis/display/displayer.h"
+#include "siis/display/asynclogger.h"
+#include "siis/database/database.h"
+#include "siis/database/tradestore.h"
+#include "siis/cache/cache.h"
 
 #include "siis/utils/common.h"
 
@@ -26,7 +30,11 @@ Live::Live() :
     m_running(false),
     m_paperMode(false),
     m_connector(nullptr),
-    m_traderProxy(nullptr)
+    m_traderProxy(nullptr),
+    m_database(nullptr),
+    m_cache(nullptr),
+    m_logger(nullptr),
+    m_tradeStore(nullptr)
 {
 
 }
@@ -52,7 +60,23 @@ void Live::init(
     O3D_ASSERT(cache != nullptr);
 
     m_displayer = displayer;
+
+    // asynchronous logger (must exists before building the strategies)
+    m_logger = new AsyncLogger(this, displayer, static_cast<o3d::UInt32>(config->getLogRingSize()));
+    m_logger->setEnabled(config->isLogEnabled());
+
+    for (auto pair : config->getLogRateLimits()) {
+        m_logger->setRateLimit(pair.first, pair.second);
+    }
+
     m_database = database;
+    m_cache = cache;
+
+    // asynchronous trade persistence (must exists before building the strategies)
+    m_tradeStore = new TradeStore(database, cache->trade(),
+                                  config->getTradeBatchSize(),
+                                  config->getTradeFlushDelay(),
+                                  config->getTradeHighWatermark());
 
     for (MarketConfig *mc : config->getConfiguredMarkets()) {
         Market *market = new Market(mc->marketId, mc->marketId, "", "");  // @todo fetch market from DB if exists and query from connector
@@ -61,6 +85,13 @@ void Live::init(
         m_strategies[mc->marketId] = strategy;
 
         strategy->setMarket(market);
+        strategy->setDetailedStatistics(config->isDetailedStatistics());
+
+        if (config->isSnapshotRestore()) {
+            // restart from the last snapshot in place of the warm-up
+            strategy->loadSnapshot(config->getSnapshotFilename(strategy->identifier(), mc->marketId),
+                                   timestamp(), config->getSnapshotMaxGap());
+        }
 
         // @todo wait results
 //        strategy->prepareMarketData(m_connector, m_database);
@@ -84,6 +115,10 @@ void Live::terminate(Config *config)
 {
     // delete strategies and markets
     for (auto pair : m_strategies) {
+        if (config->isSnapshotSave()) {
+            pair.second->saveSnapshot(config->getSnapshotFilename(pair.second->identifier(), pair.first));
+        }
+
         pair.second->terminate(m_connector, m_database);
         o3d::deletePtr(pair.second);
     }
@@ -107,6 +142,16 @@ void Live::terminate(Config *config)
         o3d::deletePtr(m_connector);
     }
 
+    if (m_tradeStore) {
+        // write any remaining records
+        m_tradeStore->flush();
+        o3d::deletePtr(m_tradeStore);
+    }
+
+    if (m_logger) {
+        o3d::deletePtr(m_logger);
+    }
+
     m_poolWorker = nullptr;
     m_database = nullptr;
     m_cache = nullptr;
@@ -114,6 +159,14 @@ void Live::terminate(Config *config)
 
 void Live::start()
 {
+    if (m_logger) {
+        m_logger->start();
+    }
+
+    if (m_tradeStore) {
+        m_tradeStore->start();
+    }
+
     // create a decicaded thread for the timecounter
     if (!m_running) {
         m_running = true;
@@ -137,6 +190,14 @@ void Live::stop()
     if (m_connector) {
         m_connector->stop();
     }
+
+    if (m_tradeStore) {
+        m_tradeStore->stop();
+    }
+
+    if (m_logger) {
+        m_logger->stop();
+    }
 }
 
 void Live::sync()
@@ -247,20 +308,25 @@ Cache *Live::cache()
     return m_cache;
 }
 
+TradeStore *Live::tradeStore()
+{
+    return m_tradeStore;
+}
+
+AsyncLogger *Live::logger()
+{
+    return m_logger;
+}
+
 void Live::log(const o3d::String &unit, const o3d::String &marketId, const o3d::String &channel,
                const o3d::String &msg, o3d::System::MessageLevel type)
 {
     // @todo throught the monitor send a log message
-    // m_monitor.log(timestamp(), timeframe, marketId, channel, msg);
-    o3d::DateTime dt;
-    dt.fromTime(timestamp(), true);
-
-    if (unit.isEmpty()) {
-        m_displayer->display(channel, o3d::String("[{0}] <{2}> : {3}").arg(dt.buildString("%Y-%m-%d %H:%M:%S"))
-                                          .arg(marketId).arg(msg), type);
-    } else {
-        m_displayer->display(channel, o3d::String("[{0}] @{1} <{2}> : {3}").arg(dt.buildString("%Y-%m-%d %H:%M:%S"))
-                                          .arg(unit).arg(marketId).arg(msg), type);
+    // m_monitor.log(timestamp(), unit, marketId, channel, msg);
+
+    // deferred datetime formatting and display into the logger thread
+    if (m_logger) {
+        m_logger->logText(unit, marketId, channel, msg, type);
     }
 }
 
@@ -71,6 +71,9 @@ public:
 
     virtual Database* database() override;
     virtual Cache* cache() override;
+    virtual TradeStore* tradeStore() override;
+
+    virtual AsyncLogger* logger() override;
 
     virtual void log(const o3d::String &unit,
                      const o3d::String &marketId,
@@ -100,6 +103,9 @@ private:
 
     Database *m_database;
     Cache *m_cache;
+
+    AsyncLogger *m_logger;
+    TradeStore *m_tradeStore;
 };
 
 } // namespace siis
@@ -20,6 +20,7 @@
 #include "siis/database/database.h"
 #include "siis/cache/cache.h"
 #include "siis/trade/tradesignal.h"
+#include "siis/utils/trace.h"
 
 #include "siis/display/ncursesdisplayer.h"
 #include "siis/display/ttydisplayer.h"
@@ -28,6 +29,8 @@
 #include "backtest/backtest.h"
 #include "learning/learning.h"
 #include "optimization/optimization.h"
+#include "optimization/coordinator.h"
+#include "optimization/distributedworker.h"
 
 #include <stdlib.h>
 #include <stdio.h>
@@ -72,7 +75,8 @@ public:
         m_handler(nullptr),
         m_displayer(nullptr),
         m_analysisLog(nullptr),
-        m_orderLog(nullptr)
+        m_orderLog(nullptr),
+        m_done(false)
     {
         struct passwd *pw = getpwuid(getuid());
         m_siisPath = Dir(pw->pw_dir);
@@ -106,18 +110,26 @@ public:
         printf("  -s --strategy <filename.json> To define the strategy configuration\n");
         printf("  -x --learning <filename.json> To define the learning override configuration\n");
         printf("  -S --supervisor <filename.json> To define the supervisor configuration\n");
+        printf("  -O --space <filename.json> To define the parameter space of the optimize mode\n");
         printf("  -m --market To define one ore more specific markets only (must exists in configuration file)\n");
         printf("\n");
         printf("  -l --live Live (mode) Live real or paper trading (see -p flag) using the connector\n");
         printf("  -P --paper Paper trader only in live mode (see -l flag)\n");
         printf("  -b --backtest (mode) Process a backtesting (need -f -t and -i options). Not compatible with others mode\n");
         printf("  -L --learn (mode) Machine learning training\n");
-        printf("  -o --optimize (mode) Machine learning optimization\n");
+        printf("  -o --optimize (mode) Strategy parameters optimization (see -O flag) or machine learning optimization\n");
+        printf("  -C --coordinator Distribute the optimize mode, serving its jobs to the workers (see -o flag)\n");
+        printf("  -W --worker Run the jobs of a coordinator of the optimize mode (see -o flag)\n");
+        printf("  -A --address Override the address of the coordinator (example tcp://127.0.0.1:5600)\n");
         printf("\n");
         printf("  -f --from Define the start datetime for backtest/learn/optimize mode in format YYYY-mm-ddTHH:MM:SS (example 2019-01-01T00:00:00)\n");
         printf("  -t --to Define the stop datetime for backtest/learn/optimize mode in format YYYY-mm-ddTHH:MM:SS (example 2019-01-01T00:00:00)\n");
         printf("  -i --timestep Timestep increment in second or in string for the backtest/learn/optimize mode (example 1m for 1 minute, 4h, 1M for 1 month)\n");
         printf("\n");
+        printf("  -T --trace <filename> Record the events of the strategies of the backtest into a trace (see -b flag)\n");
+        printf("  -R --reference <filename> Compare the trace with a reference trace, at the end of the backtest or only if no mode is given (see -T flag)\n");
+        printf("  -e --epsilon Relative tolerance of the comparison of the traces, default 0 for identical values\n");
+        printf("\n");
         printf("In interactive mode type the 'q' key and confirm with 'y' to exit the program or cancel with 'n'.\n");
         printf("Else simply type CTRL-C signal.\n");
     }
@@ -127,6 +139,32 @@ public:
         printf("SiiS strategy version 2.0.0a\n");
     }
 
+    /**
+     * @brief checkTrace Compare a trace with a reference trace and display the first divergence.
+     * @return Exit code of the program, 0 if identical, 1 if they diverge.
+     */
+    o3d::Int32 checkTrace(const String &traceFileName, const String &referenceFileName, o3d::Double epsilon)
+    {
+        if (traceFileName.isEmpty()) {
+            throw E_InvalidParameter("No trace file specified to compare with the reference");
+        }
+
+        Trace::Divergence divergence;
+
+        if (!Trace::compare(traceFileName, referenceFileName, epsilon, divergence)) {
+            throw E_InvalidParameter("Unable to read the traces");
+        }
+
+        if (divergence.diverged) {
+            printf("Trace diverges on %s at event %i : %s\n",
+                   divergence.marketId.getData(), divergence.index, divergence.description.toUtf8().getData());
+            return 1;
+        }
+
+        printf("Traces are identical\n");
+        return 0;
+    }
+
     o3d::Int32 init()
     {
         signal(SIGINT, sig_handler);
@@ -141,6 +179,7 @@ public:
         cmd->addOption('s', "strategy");
         cmd->addOption('x', "learning");
         cmd->addOption('S', "supervisor");
+        cmd->addOption('O', "space");
         cmd->addRepeatableOption('m', "market");
         cmd->addOptionalOption('f', "from", "");
         cmd->addOptionalOption('t', "to", "");
@@ -151,6 +190,12 @@ public:
         cmd->addSwitch('n', "nointerative");
         cmd->addSwitch('L', "learn");
         cmd->addSwitch('o', "optimize");
+        cmd->addSwitch('C', "coordinator");
+        cmd->addSwitch('W', "worker");
+        cmd->addOption('A', "address");
+        cmd->addOption('T', "trace");
+        cmd->addOption('R', "reference");
+        cmd->addOptionalOption('e', "epsilon", "0");
         cmd->addOptionalOption('c', "cpu", "0");
         cmd->addOptionalOption('d', "verbose", "0");
 
@@ -172,6 +217,13 @@ public:
         String profileConfigFileName = cmd->getOptionValue('p');
         String learningConfigFileName = cmd->getOptionValue('x');
         String supervisorConfigFileName = cmd->getOptionValue('S');
+        String spaceConfigFileName = cmd->getOptionValue('O');
+
+        if (cmd->getOptionValue('R').isValid() && !cmd->getSwitch('b')) {
+            // reproducibility check of two existing traces only, then exit with its result
+            m_done = true;
+            return checkTrace(cmd->getOptionValue('T'), cmd->getOptionValue('R'), cmd->getOptionValue('e').toDouble());
+        }
 
         if (strategyConfigFileName.isValid() && profileConfigFileName.isValid()) {
             throw E_InvalidParameter("Either strategy or profile configuration file can be specified");
@@ -181,10 +233,19 @@ public:
             throw E_InvalidParameter("No strategy or profile configuration file specified");
         }
 
-        if ((cmd->getSwitch('L') || cmd->getSwitch('o')) && supervisorConfigFileName.isEmpty()) {
+        if (cmd->getSwitch('L') && supervisorConfigFileName.isEmpty()) {
             throw E_InvalidParameter("No supervisor configuration file specified");
         }
 
+        if (cmd->getSwitch('o') && supervisorConfigFileName.isEmpty() && spaceConfigFileName.isEmpty()) {
+            throw E_InvalidParameter("No parameter space neither supervisor configuration file specified");
+        }
+
+        if (cmd->getSwitch('o') && spaceConfigFileName.isValid() &&
+            strategyConfigFileName.isEmpty() && profileConfigFileName.isEmpty()) {
+            throw E_InvalidParameter("No strategy or profile configuration file specified");
+        }
+
         if (strategyConfigFileName.isEmpty() && profileConfigFileName.isEmpty() && supervisorConfigFileName.isEmpty()) {
             displayHelp();
             return 1;
@@ -201,6 +262,7 @@ public:
         String profileConfigFileName = cmd->getOptionValue('p');
         String learningConfigFileName = cmd->getOptionValue('x');
         String supervisorConfigFileName = cmd->getOptionValue('S');
+        String spaceConfigFileName = cmd->getOptionValue('O');
         o3d::Int32 cmdNumCPU = cmd->getOptionValue('c').toInt32();
         o3d::Int32 numWorkers = -1;
 
@@ -225,6 +287,10 @@ public:
             m_config->loadSupervisorSpec(supervisorConfigFileName);
         }
 
+        if (spaceConfigFileName.isValid()) {
+            m_config->loadOptimizationSpec(spaceConfigFileName);
+        }
+
         if (m_config->getNumWorkers() > 0) {
             numWorkers = m_config->getNumWorkers();
         }
@@ -242,8 +308,19 @@ public:
                                             m_config->getDBHost(), m_config->getDBPort(), m_config->getDBName(),
                                             m_config->getDBUser(), m_config->getDBPwd());
 
+        m_database->setPoolSize(m_config->getDBPoolSize());
+
+        if (m_config->getHandlerType() == Config::HANDLER_LIVE) {
+            // the trade store thread writes through its own connection
+            m_database->setNumDedicated(1);
+        }
+
         m_database->init();
 
+        if (m_config->isOhlcCacheEnabled()) {
+            m_database->enableOhlcCache(m_config->getOhlcCachePath());
+        }
+
         m_cache = Cache::builder(m_config->getCacheType(),
                                  m_config->getCacheHost(), m_config->getCachePort(), m_config->getCacheName(),
                                  m_config->getCacheUser(), m_config->getCachePwd());
@@ -298,6 +375,10 @@ public:
             m_handler = new Learning();
         } else if (m_config->getHandlerType() == Config::HANDLER_OPTIMIZE) {
             m_handler = new Optimization();
+        } else if (m_config->getHandlerType() == Config::HANDLER_COORDINATOR) {
+            m_handler = new Coordinator();
+        } else if (m_config->getHandlerType() == Config::HANDLER_WORKER) {
+            m_handler = new DistributedWorker();
         } else {
             O3D_ERROR(E_InvalidParameter("Unsupported handler"));
         }
@@ -507,7 +588,7 @@ public:
 
         try {
             res = siisStrategy->init();
-            if (res != 0) {
+            if (res != 0 || siisStrategy->m_done) {
                 siisStrategy->terminate();
                 o3d::deletePtr(siisStrategy);
 
@@ -567,6 +648,8 @@ private:
 
     Logger *m_analysisLog;
     Logger *m_orderLog;
+
+    Bool m_done;   //!< nothing to run after the initialization
 };
 
 class StrategyAppSettings : public AppSettings
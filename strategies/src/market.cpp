@@ -258,6 +258,47 @@ void Market::setMarginFactor(o3d::Double marginFactor)
     }
 }
 
+void Market::copyInfo(const Market &market)
+{
+    m_pair = market.m_pair;
+    m_alias = market.m_alias;
+
+    m_type = market.m_type;
+    m_contract = market.m_contract;
+    m_unit = market.m_unit;
+
+    m_tradeCaps = market.m_tradeCaps;
+    m_orderCaps = market.m_orderCaps;
+
+    m_lastTimestamp = market.m_lastTimestamp;
+    m_tradeable = market.m_tradeable;
+
+    m_contractSize = market.m_contractSize;
+    m_lotSize = market.m_lotSize;
+    m_valuePerPip = market.m_valuePerPip;
+    m_onePipMean = market.m_onePipMean;
+
+    m_baseExchangeRate = market.m_baseExchangeRate;
+    m_marginFactor = market.m_marginFactor;
+
+    m_bid = market.m_bid;
+    m_ask = market.m_ask;
+    m_last = market.m_last;
+
+    m_hedging = market.m_hedging;
+
+    m_base = market.m_base;
+    m_quote = market.m_quote;
+    m_settlement = market.m_settlement;
+
+    m_makerFees = market.m_makerFees;
+    m_takerFees = market.m_takerFees;
+
+    m_priceFilter = market.m_priceFilter;
+    m_qtyFilter = market.m_qtyFilter;
+    m_notionalFilter = market.m_notionalFilter;
+}
+
 o3d::Double Market::adjustPrice(o3d::Double price) const
 {
     if (std::isnan(price)) {
@@ -0,0 +1,686 @@
+/**
+ * @brief SiiS strategy coordinator of a distributed optimization.
+ * @copyright Copyright (C) 2024 SiiS
+ * @author Frederic SCHERMA (frederic.scherma@gmail.com)
+ * @date 2024-10-17
+ */
+
+#include "coordinator.h"
+
+#include "siis/config/config.h"
+#include "siis/learning/parameterspace.h"
+#include "siis/learning/optimizer.h"
+#include "siis/learning/distribution.h"
+#include "siis/learning/pruning.h"
+#include "siis/display/displayer.h"
+#include "siis/display/asynclogger.h"
+
+#include "siis/utils/common.h"
+
+#include <o3d/core/debug.h>
+#include <o3d/core/filemanager.h>
+
+#include <json/writer.h>
+
+#include <zmq.hpp>
+
+#include <cstring>
+
+using namespace siis;
+using o3d::Debug;
+using o3d::Logger;
+
+Coordinator::Coordinator() :
+    m_thread(this),
+    m_running(false),
+    m_context(nullptr),
+    m_socket(nullptr),
+    m_fromTs(0.0),
+    m_toTs(0.0),
+    m_iteration(0),
+    m_numIterations(1),
+    m_firstJob(0),
+    m_campaignDone(false),
+    m_campaignDoneTime(0.0),
+    m_finished(false),
+    m_progress(0.0),
+    m_config(nullptr),
+    m_displayer(nullptr),
+    m_distribution(nullptr),
+    m_optimizer(nullptr),
+    m_poolWorker(nullptr),
+    m_database(nullptr),
+    m_cache(nullptr),
+    m_logger(nullptr)
+{
+
+}
+
+Coordinator::~Coordinator()
+{
+
+}
+
+void Coordinator::init(
+        Displayer *displayer,
+        Config *config,
+        StrategyCollection *,
+        PoolWorker *poolWorker,
+        Database *database,
+        Cache *cache)
+{
+    O3D_ASSERT(displayer != nullptr);
+    O3D_ASSERT(config != nullptr);
+    O3D_ASSERT(poolWorker != nullptr);
+    O3D_ASSERT(database != nullptr);
+    O3D_ASSERT(cache != nullptr);
+
+    m_displayer = displayer;
+
+    m_logger = new AsyncLogger(this, displayer, static_cast<o3d::UInt32>(config->getLogRingSize()));
+    m_logger->setEnabled(config->isLogEnabled());
+
+    m_config = config;
+    m_poolWorker = poolWorker;
+    m_database = database;
+    m_cache = cache;
+
+    m_fromTs = config->getFromTs();
+    m_toTs = config->getToTs();
+
+    if (m_fromTs <= 0.0) {
+        O3D_ERROR(o3d::E_InvalidPrecondition("From datetime parameters must be valid"));
+    }
+
+    if (m_toTs <= 0.0) {
+        m_toTs = static_cast<o3d::Double>(o3d::System::getTime()) / o3d::System::getTimeFrequency();
+    }
+
+    if (!config->getDistribution()) {
+        O3D_ERROR(o3d::E_InvalidPrecondition("Distribution must be defined for a coordinator"));
+    }
+
+    m_distribution = new Distribution(*config->getDistribution());
+
+    if (config->getValidation()) {
+        WARN("distribution", "Validation is ignored by a distributed optimization, see the time folds");
+    }
+
+    for (MarketConfig *mc : config->getConfiguredMarkets()) {
+        m_markets.push_back(mc->marketId.getData());
+    }
+
+    if (m_markets.empty()) {
+        O3D_ERROR(o3d::E_InvalidPrecondition("At least one market must be configured"));
+    }
+
+    const ParameterSpace *space = config->getParameterSpace();
+
+    if (space && space->iterative()) {
+        // candidates given batch per batch by the optimizer
+        m_optimizer = space->createOptimizer();
+        m_numIterations = space->numIterations();
+    }
+
+    // the workers connect to the coordinator
+    m_context = new zmq::context_t(1);
+    m_socket = new zmq::socket_t(*m_context, ZMQ_ROUTER);
+
+    int linger = 0;
+    m_socket->setsockopt(ZMQ_LINGER, &linger, sizeof(linger));
+
+    try {
+        m_socket->bind(m_distribution->bindAddress().toUtf8().getData());
+    } catch (zmq::error_t &e) {
+        O3D_ERROR(o3d::E_InvalidPrecondition(o3d::String("Unable to bind the coordinator to {0} : {1}")
+                                             .arg(m_distribution->bindAddress()).arg(e.what())));
+    }
+
+    nextBatch();
+
+    INFO("distribution", o3d::String("Coordinate {0} candidates in {1} jobs on {2}")
+         .arg(static_cast<o3d::Int32>(m_candidates.size()))
+         .arg(static_cast<o3d::Int32>(m_distribution->jobs().size()))
+         .arg(m_distribution->bindAddress()));
+}
+
+o3d::Bool Coordinator::isBacktesting() const
+{
+    return true;
+}
+
+void Coordinator::terminate(Config *config)
+{
+    // one row of results per candidate
+    writeResults(config);
+
+    if (m_socket) {
+        m_socket->close();
+        o3d::deletePtr(m_socket);
+    }
+
+    o3d::deletePtr(m_context);
+
+    o3d::deletePtr(m_optimizer);
+    o3d::deletePtr(m_distribution);
+
+    if (m_logger) {
+        o3d::deletePtr(m_logger);
+    }
+
+    m_poolWorker = nullptr;
+    m_database = nullptr;
+    m_cache = nullptr;
+    m_config = nullptr;
+}
+
+void Coordinator::nextBatch()
+{
+    const ParameterSpace *space = m_config->getParameterSpace();
+
+    std::vector<Json::Value> parameters;
+    std::vector<Optimizer::Point> points;
+
+    if (m_optimizer) {
+        m_optimizer->ask(space->batchSize(), points);
+
+        for (const Optimizer::Point &point : points) {
+            parameters.push_back(space->candidateAt(point));
+        }
+    } else if (m_iteration == 0) {
+        // candidates from the parameter space, else a single one with the default parameters
+        if (space) {
+            space->generate(parameters);
+        } else {
+            parameters.push_back(Json::Value(Json::objectValue));
+        }
+    }
+
+    std::vector<o3d::Int32> ids;
+
+    for (size_t c = 0; c < parameters.size(); ++c) {
+        Candidate candidate;
+        candidate.id = static_cast<o3d::Int32>(m_candidates.size());
+        candidate.iteration = m_iteration;
+        candidate.parameters = parameters[c];
+
+        if (c < points.size()) {
+            candidate.point = points[c];
+        }
+
+        ids.push_back(candidate.id);
+        m_candidates.push_back(candidate);
+    }
+
+    m_firstJob = static_cast<o3d::Int32>(m_distribution->jobs().size());
+    m_distribution->partition(m_iteration, ids, m_markets, m_fromTs, m_toTs);
+
+    for (size_t j = static_cast<size_t>(m_firstJob); j < m_distribution->jobs().size(); ++j) {
+        for (o3d::Int32 id : m_distribution->jobs()[j].candidates) {
+            ++m_candidates[static_cast<size_t>(id)].numJobs;
+        }
+    }
+}
+
+void Coordinator::endIteration()
+{
+    std::vector<Optimizer::Point> points;
+    std::vector<o3d::Double> scores;
+    o3d::Int32 numIncompletes = 0;
+
+    for (const Candidate &candidate : m_candidates) {
+        if (candidate.iteration != m_iteration) {
+            continue;
+        }
+
+        if (!candidate.complete()) {
+            ++numIncompletes;
+        }
+
+        points.push_back(candidate.point);
+        scores.push_back(candidate.performance);
+    }
+
+    if (numIncompletes > 0) {
+        WARN("distribution", o3d::String("Iteration {0} has {1} candidates with failed jobs")
+             .arg(m_iteration).arg(numIncompletes));
+    }
+
+    if (m_optimizer && !points.empty()) {
+        m_optimizer->tell(points, scores);
+
+        INFO("optimization", o3d::String("Iteration {0}/{1} best performance {2}%")
+             .arg(m_iteration + 1).arg(m_numIterations).arg(m_optimizer->bestScore()*100, 2));
+    }
+}
+
+o3d::Bool Coordinator::process(const std::string &worker, const Json::Value &message, Json::Value &reply)
+{
+    o3d::Double now = wallTime();
+    std::string type = message.get("type", "").asString();
+
+    if (m_workers.find(worker) == m_workers.end()) {
+        INFO("distribution", o3d::String("Worker {0} connected").arg(worker.c_str()));
+    }
+
+    m_workers[worker] = now;
+
+    reply = Json::Value(Json::objectValue);
+    reply["seq"] = message.get("seq", -1);
+
+    o3d::Int32 jobId = message.get("job", -1).asInt();
+    o3d::Int32 attempt = message.get("attempt", 0).asInt();
+
+    if (type == "heartbeat") {
+        m_distribution->heartbeat(jobId, attempt, now);
+        return false;
+    } else if (type == "result") {
+        if (m_distribution->complete(jobId)) {
+            addResults(message);
+        } else {
+            DBG("distribution", o3d::String("Duplicate results of the job {0} from {1}").arg(jobId).arg(worker.c_str()));
+        }
+    } else if (type == "reject") {
+        WARN("distribution", o3d::String("Job {0} rejected by {1} : {2}")
+             .arg(jobId).arg(worker.c_str()).arg(message.get("error", "").asString().c_str()));
+
+        m_distribution->retry(jobId, attempt);
+    } else if (type != "ready") {
+        return false;
+    }
+
+    // any other message of a worker asks for its next job
+    nextJob(worker, reply);
+
+    return true;
+}
+
+void Coordinator::nextJob(const std::string &worker, Json::Value &reply)
+{
+    if (m_campaignDone) {
+        reply["type"] = "done";
+        m_released.insert(worker);
+
+        return;
+    }
+
+    const Distribution::Job *job = m_distribution->lease(worker, wallTime());
+    if (!job) {
+        // the remaining jobs are running, or the next iteration is not ready
+        reply["type"] = "wait";
+        reply["delay"] = 1.0;
+
+        return;
+    }
+
+    reply["type"] = "job";
+    reply["job"] = job->id;
+    reply["attempt"] = job->attempt;
+    reply["iteration"] = job->iteration;
+    reply["fold"] = job->fold;
+    reply["from"] = job->fromTs;
+    reply["to"] = job->toTs;
+
+    Json::Value markets(Json::arrayValue);
+    for (const std::string &market : job->markets) {
+        markets.append(market);
+    }
+
+    reply["markets"] = markets;
+
+    Json::Value candidates(Json::arrayValue);
+    for (o3d::Int32 id : job->candidates) {
+        Json::Value candidate(Json::objectValue);
+        candidate["id"] = id;
+        candidate["parameters"] = m_candidates[static_cast<size_t>(id)].parameters;
+
+        candidates.append(candidate);
+    }
+
+    reply["candidates"] = candidates;
+}
+
+void Coordinator::addResults(const Json::Value &results)
+{
+    Json::Value candidates = results.get("candidates", Json::Value());
+
+    for (auto it = candidates.begin(); it != candidates.end(); ++it) {
+        o3d::Int32 id = it->get("id", -1).asInt();
+        if (id < 0 || id >= static_cast<o3d::Int32>(m_candidates.size())) {
+            continue;
+        }
+
+        Candidate &candidate = m_candidates[static_cast<size_t>(id)];
+        o3d::Bool first = candidate.numResults == 0;
+
+        ++candidate.numResults;
+
+        candidate.stopped = candidate.stopped || it->get("stopped", false).asBool();
+
+        if (candidate.pruned == Pruning::REASON_NONE) {
+            candidate.pruned = it->get("pruned", 0).asInt();
+        }
+
+        // summed over the markets and the time folds
+        candidate.performance += it->get("performance", 0.0).asDouble();
+        candidate.maxDrawDownRate = o3d::max(candidate.maxDrawDownRate, it->get("max-draw-down-rate", 0.0).asDouble());
+        candidate.maxDrawDown = o3d::max(candidate.maxDrawDown, it->get("max-draw-down", 0.0).asDouble());
+        candidate.succeedTrades += it->get("succeed-trades", 0).asInt();
+        candidate.failedTrades += it->get("failed-trades", 0).asInt();
+        candidate.totalTrades += it->get("total-trades", 0).asInt();
+
+        o3d::Double best = it->get("best", 0.0).asDouble();
+        o3d::Double worst = it->get("worst", 0.0).asDouble();
+
+        candidate.best = first ? best : o3d::max(candidate.best, best);
+        candidate.worst = first ? worst : o3d::min(candidate.worst, worst);
+    }
+}
+
+void Coordinator::send(const std::string &worker, const Json::Value &content)
+{
+    std::string data = Distribution::encode(content);
+
+    // routed to the worker by its identity
+    zmq::message_t identity(worker.size());
+    memcpy(identity.data(), worker.data(), worker.size());
+
+    zmq::message_t msg(data.size());
+    memcpy(msg.data(), data.data(), data.size());
+
+    m_socket->send(identity, ZMQ_SNDMORE);
+    m_socket->send(msg, ZMQ_DONTWAIT);
+}
+
+void Coordinator::updateProgress()
+{
+    if (m_finished) {
+        m_progress = 100.0;
+        return;
+    }
+
+    const std::vector<Distribution::Job> &jobs = m_distribution->jobs();
+
+    o3d::Int32 numJobs = static_cast<o3d::Int32>(jobs.size()) - m_firstJob;
+    o3d::Int32 numFinished = 0;
+
+    for (size_t j = static_cast<size_t>(m_firstJob); j < jobs.size(); ++j) {
+        if (jobs[j].state == Distribution::JOB_DONE || jobs[j].state == Distribution::JOB_FAILED) {
+            ++numFinished;
+        }
+    }
+
+    o3d::Double pass = numJobs > 0 ? static_cast<o3d::Double>(numFinished) / numJobs : 1.0;
+
+    // completed once the workers are released
+    m_progress = o3d::clamp((m_iteration + pass) / m_numIterations * 100.0, 0.0, 99.0);
+}
+
+void Coordinator::writeResults(Config *config)
+{
+    const ParameterSpace *space = config->getParameterSpace();
+
+    o3d::String content("candidate;iteration;early-stopped;pruned;complete;performance;max-draw-down-rate;max-draw-down;succeed-trades;failed-trades;total-trades;best;worst");
+
+    if (space) {
+        for (const ParameterSpace::Range &range : space->ranges()) {
+            content += ';';
+            content += range.name.c_str();
+        }
+    }
+
+    content += '\n';
+
+    Json::StreamWriterBuilder builder;
+    builder["indentation"] = "";
+
+    const Candidate *bestCandidate = nullptr;
+
+    for (const Candidate &candidate : m_candidates) {
+        content += o3d::String("{0};{1};{2};{3};{4};{5};{6};{7};{8};{9};{10};{11};{12}")
+                   .arg(candidate.id)
+                   .arg(candidate.iteration)
+                   .arg(candidate.stopped ? 1 : 0)
+                   .arg(Pruning::reasonToStr(static_cast<Pruning::Reason>(candidate.pruned)))
+                   .arg(candidate.complete() ? 1 : 0)
+                   .arg(candidate.performance*100, 4)
+                   .arg(candidate.maxDrawDownRate*100, 4)
+                   .arg(candidate.maxDrawDown, 4)
+                   .arg(candidate.succeedTrades)
+                   .arg(candidate.failedTrades)
+                   .arg(candidate.totalTrades)
+                   .arg(candidate.best*100, 4)
+                   .arg(candidate.worst*100, 4);
+
+        if (space) {
+            for (const ParameterSpace::Range &range : space->ranges()) {
+                content += ';';
+                content += Json::writeString(builder, candidate.parameters.get(range.name, Json::Value())).c_str();
+            }
+        }
+
+        content += '\n';
+
+        // only the candidates having all their results
+        if (candidate.complete() && (!bestCandidate || candidate.performance > bestCandidate->performance)) {
+            bestCandidate = &candidate;
+        }
+    }
+
+    o3d::String filename = config->getStrategyIdentifier() + "-optimization.csv";
+
+    o3d::File file(config->getReportsPath().getFullPathName(), filename);
+    o3d::OutStream *os = o3d::FileManager::instance()->openOutStream(file.getFullFileName(), o3d::FileOutStream::CREATE);
+
+    os->writeString(content);
+    o3d::deletePtr(os);
+
+    INFO("results", o3d::String("Results of {0} candidates written to {1}")
+         .arg(static_cast<o3d::Int32>(m_candidates.size())).arg(file.getFullFileName()));
+
+    if (m_distribution && m_distribution->numFailed() > 0) {
+        WARN("results", o3d::String("{0} jobs failed").arg(m_distribution->numFailed()));
+    }
+
+    if (bestCandidate) {
+        INFO("results", o3d::String("Best candidate {0} performance {1}%")
+             .arg(bestCandidate->id).arg(bestCandidate->performance*100, 2));
+    }
+}
+
+void Coordinator::start()
+{
+    if (m_logger) {
+        m_logger->start();
+    }
+
+    if (!m_running) {
+        m_running = true;
+        m_thread.start();
+        m_thread.setName("siis::coordinator");
+    }
+}
+
+void Coordinator::stop()
+{
+    if (m_running && m_thread.isThread()) {
+        m_running = false;
+        m_thread.waitFinish();
+    }
+
+    if (m_logger) {
+        m_logger->stop();
+    }
+}
+
+void Coordinator::sync()
+{
+    if (m_running) {
+        // @todo
+    }
+}
+
+o3d::Double Coordinator::timestamp() const
+{
+    return wallTime();
+}
+
+o3d::Double Coordinator::progress() const
+{
+    return m_progress;
+}
+
+const TraderProxy *Coordinator::traderProxy() const
+{
+    return nullptr;
+}
+
+TraderProxy *Coordinator::traderProxy()
+{
+    return nullptr;
+}
+
+void Coordinator::setPaperMode(o3d::Bool)
+{
+    // not available in optimization
+}
+
+void Coordinator::onTick(const o3d::CString &, const Tick &)
+{
+    // nothing in optimization
+}
+
+void Coordinator::onOhlc(const o3d::CString &, Ohlc::Type, const Ohlc &)
+{
+    // nothing in optimization
+}
+
+Market *Coordinator::market(const o3d::CString &)
+{
+    // markets are processed by the workers
+    return nullptr;
+}
+
+const Market *Coordinator::market(const o3d::CString &) const
+{
+    return nullptr;
+}
+
+Strategy *Coordinator::strategy(const o3d::CString &)
+{
+    // strategies are processed by the workers
+    return nullptr;
+}
+
+const Strategy *Coordinator::strategy(const o3d::CString &) const
+{
+    return nullptr;
+}
+
+Database *Coordinator::database()
+{
+    return m_database;
+}
+
+Cache *Coordinator::cache()
+{
+    return m_cache;
+}
+
+AsyncLogger *Coordinator::logger()
+{
+    return m_logger;
+}
+
+void Coordinator::log(const o3d::String &unit, const o3d::String &marketId, const o3d::String &channel,
+                      const o3d::String &msg, o3d::System::MessageLevel type)
+{
+    if (m_logger) {
+        m_logger->logText(unit, marketId, channel, msg, type);
+    }
+}
+
+o3d::Int32 Coordinator::run(void *)
+{
+    while (m_running) {
+        zmq::pollitem_t items[] = {
+            { static_cast<void*>(*m_socket), 0, ZMQ_POLLIN, 0 }
+        };
+
+        zmq::poll(&items[0], 1, 100);
+
+        if (items[0].revents & ZMQ_POLLIN) {
+            // every pending message, as identity then content frames
+            zmq::message_t identity;
+
+            while (m_socket->recv(&identity, ZMQ_DONTWAIT)) {
+                if (!identity.more()) {
+                    continue;
+                }
+
+                zmq::message_t msg;
+                m_socket->recv(&msg);
+
+                std::string worker(static_cast<const char*>(identity.data()), identity.size());
+
+                Json::Value message;
+                Json::Value reply;
+
+                if (Distribution::decode(static_cast<const char*>(msg.data()), msg.size(), message) &&
+                    process(worker, message, reply)) {
+                    send(worker, reply);
+                }
+            }
+        }
+
+        o3d::Double now = wallTime();
+
+        // lost jobs are given to the next ready worker
+        m_distribution->expire(now);
+
+        if (!m_campaignDone && m_distribution->finished(m_iteration)) {
+            endIteration();
+
+            if (m_optimizer && m_iteration + 1 < m_numIterations) {
+                ++m_iteration;
+                nextBatch();
+            } else {
+                m_campaignDone = true;
+                m_campaignDoneTime = now;
+
+                INFO("distribution", o3d::String("Campaign done, {0} jobs of which {1} failed")
+                     .arg(static_cast<o3d::Int32>(m_distribution->jobs().size())).arg(m_distribution->numFailed()));
+            }
+        }
+
+        if (m_campaignDone) {
+            // wait for the active workers to be released, up to the timeout
+            o3d::Bool released = true;
+
+            for (auto pair : m_workers) {
+                if (now - pair.second < m_distribution->timeout() && m_released.find(pair.first) == m_released.end()) {
+                    released = false;
+                    break;
+                }
+            }
+
+            if (released || now - m_campaignDoneTime > m_distribution->timeout()) {
+                m_finished = true;
+            }
+        }
+
+        updateProgress();
+
+        if (m_finished) {
+            break;
+        }
+    }
+
+    m_running = false;
+    return 0;
+}
+
+o3d::Double Coordinator::wallTime()
+{
+    return static_cast<o3d::Double>(o3d::System::getMsTime()) * 0.001;
+}
@@ -0,0 +1,191 @@
+/**
+ * @brief SiiS strategy coordinator of a distributed optimization.
+ * @copyright Copyright (C) 2024 SiiS
+ * @author Frederic SCHERMA (frederic.scherma@gmail.com)
+ * @date 2024-10-17
+ */
+
+#ifndef SIIS_COORDINATOR_H
+#define SIIS_COORDINATOR_H
+
+#include "siis/handler.h"
+
+#include <o3d/core/thread.h>
+
+#include <json/value.h>
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace zmq {
+class context_t;
+class socket_t;
+}
+
+namespace siis {
+
+class Displayer;
+class Distribution;
+class Optimizer;
+
+/**
+ * @brief Coordinator process of a distributed optimization.
+ * @author Frederic Scherma
+ * @date 2024-10-17
+ * Generate the candidates of the parameter space, partition them into jobs, then serve the jobs to the
+ * workers processes (see DistributedWorker) connected to its socket. It runs no strategy itself.
+ * The lost jobs are given again to the next ready worker. With an iterative method, the next batch of
+ * candidates is asked to the optimizer once every job of the current one is finished.
+ * The results of the markets and of the time folds are summed per candidate, and written at termination
+ * in the same report as the optimize mode.
+ */
+class Coordinator : public Handler, public o3d::Runnable
+{
+public:
+
+    Coordinator();
+    virtual ~Coordinator() override;
+
+    virtual void init(
+            Displayer *displayer,
+            Config *config,
+            StrategyCollection *collection,
+            PoolWorker *poolWorker,
+            Database *database,
+            Cache *cache) override;
+
+    virtual o3d::Bool isBacktesting() const override;
+
+    virtual void terminate(Config *config) override;
+
+    virtual void start() override;
+    virtual void stop() override;
+
+    virtual void sync() override;
+
+    virtual o3d::Double timestamp() const override;
+    virtual o3d::Double progress() const override;
+
+    virtual const TraderProxy* traderProxy() const override;
+    virtual TraderProxy* traderProxy() override;
+
+    virtual void setPaperMode(o3d::Bool active) override;
+
+    virtual void onTick(const o3d::CString &marketId, const Tick &tick) override;
+    virtual void onOhlc(const o3d::CString &marketId, Ohlc::Type ohlcType, const Ohlc &ohlc) override;
+
+    virtual Market* market(const o3d::CString &marketId) override;
+    virtual const Market* market(const o3d::CString &marketId) const override;
+
+    virtual Strategy* strategy(const o3d::CString &marketId) override;
+    virtual const Strategy* strategy(const o3d::CString &marketId) const override;
+
+    virtual Database* database() override;
+    virtual Cache* cache() override;
+
+    virtual AsyncLogger* logger() override;
+
+    virtual void log(const o3d::String &unit, const o3d::String &marketId,
+                     const o3d::String &channel, const o3d::String &msg,
+                     o3d::System::MessageLevel type = o3d::System::MSG_INFO) override;
+
+private:
+
+    virtual o3d::Int32 run(void *) override;
+
+    o3d::Thread m_thread;
+    o3d::Bool m_running;
+
+    zmq::context_t *m_context;
+    zmq::socket_t *m_socket;     //!< bound at init, then only used by the handler thread
+
+    o3d::Double m_fromTs;
+    o3d::Double m_toTs;
+
+    /**
+     * @brief A set of parameters and its results summed over the markets and the time folds.
+     */
+    struct Candidate
+    {
+        o3d::Int32 id = 0;
+        o3d::Int32 iteration = 0;
+        Json::Value parameters;
+        std::vector<o3d::Double> point;   //!< optimizer point, empty if not iterative
+
+        o3d::Int32 numJobs = 0;           //!< jobs containing the candidate
+        o3d::Int32 numResults = 0;        //!< jobs done
+
+        o3d::Bool stopped = false;        //!< early stopped into at least one job
+        o3d::Int32 pruned = 0;            //!< first Pruning::Reason of its jobs
+
+        o3d::Double performance = 0.0;
+        o3d::Double maxDrawDownRate = 0.0;
+        o3d::Double maxDrawDown = 0.0;
+        o3d::Int32 succeedTrades = 0;
+        o3d::Int32 failedTrades = 0;
+        o3d::Int32 totalTrades = 0;
+        o3d::Double best = 0.0;
+        o3d::Double worst = 0.0;
+
+        o3d::Bool complete() const { return numResults == numJobs; }
+    };
+
+    std::vector<Candidate> m_candidates;   //!< of every iterations, indexed by id
+    std::vector<std::string> m_markets;
+
+    o3d::Int32 m_iteration;
+    o3d::Int32 m_numIterations;
+    o3d::Int32 m_firstJob;                 //!< of the current iteration
+
+    o3d::Bool m_campaignDone;              //!< every jobs of every iterations are finished
+    o3d::Double m_campaignDoneTime;
+    o3d::Bool m_finished;                  //!< and the workers are released
+    o3d::Double m_progress;
+
+    std::map<std::string, o3d::Double> m_workers;   //!< last message time per worker identity
+    std::set<std::string> m_released;               //!< workers having received the done message
+
+    Config *m_config;
+    Displayer *m_displayer;
+
+    Distribution *m_distribution;
+    Optimizer *m_optimizer;   //!< null if not iterative
+
+    PoolWorker *m_poolWorker;
+
+    Database *m_database;
+    Cache *m_cache;
+
+    AsyncLogger *m_logger;
+
+    //! Create the candidates of the current iteration and their jobs.
+    void nextBatch();
+
+    //! Give the scores of the candidates of the current iteration to the optimizer.
+    void endIteration();
+
+    /**
+     * @brief process Process a message of a worker.
+     * @return True if a reply must be sent to the worker.
+     */
+    o3d::Bool process(const std::string &worker, const Json::Value &message, Json::Value &reply);
+
+    //! Next job for a worker, else wait or done.
+    void nextJob(const std::string &worker, Json::Value &reply);
+
+    void addResults(const Json::Value &results);
+
+    void send(const std::string &worker, const Json::Value &content);
+
+    void updateProgress();
+
+    void writeResults(Config *config);
+
+    static o3d::Double wallTime();
+};
+
+} // namespace siis
+
+#endif // SIIS_COORDINATOR_H
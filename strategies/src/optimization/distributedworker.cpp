@@ -0,0 +1,439 @@
+/**
+ * @brief SiiS strategy worker of a distributed optimization.
+ * @copyright Copyright (C) 2024 SiiS
+ * @author Frederic SCHERMA (frederic.scherma@gmail.com)
+ * @date 2024-10-17
+ */
+
+#include "distributedworker.h"
+
+#include "siis/database/replaybus.h"
+
+#include "siis/strategy.h"
+#include "siis/market.h"
+#include "siis/config/config.h"
+#include "siis/learning/distribution.h"
+#include "siis/statistics/statistics.h"
+#include "siis/utils/common.h"
+
+#include <o3d/core/debug.h>
+
+#include <zmq.hpp>
+
+#include <cstring>
+#include <unistd.h>
+
+using namespace siis;
+using o3d::Debug;
+using o3d::Logger;
+
+DistributedWorker::DistributedWorker() :
+    Optimization(),
+    m_distribution(nullptr),
+    m_context(nullptr),
+    m_socket(nullptr),
+    m_sequence(0),
+    m_jobId(-1),
+    m_attempt(0),
+    m_lastHeartbeat(0.0),
+    m_numJobs(0),
+    m_finished(false)
+{
+
+}
+
+DistributedWorker::~DistributedWorker()
+{
+
+}
+
+void DistributedWorker::init(
+        Displayer *displayer,
+        Config *config,
+        StrategyCollection *collection,
+        PoolWorker *poolWorker,
+        Database *database,
+        Cache *cache)
+{
+    O3D_ASSERT(displayer != nullptr);
+    O3D_ASSERT(config != nullptr);
+    O3D_ASSERT(collection != nullptr);
+    O3D_ASSERT(poolWorker != nullptr);
+    O3D_ASSERT(database != nullptr);
+    O3D_ASSERT(cache != nullptr);
+
+    initHandler(displayer, config, collection, poolWorker, database, cache);
+
+    // the period is given per job
+    m_timestep = config->getTimestep();
+
+    if (m_timestep <= 0.0) {
+        O3D_ERROR(o3d::E_InvalidPrecondition("Timestep must be greater than 0"));
+    }
+
+    if (!config->getDistribution()) {
+        O3D_ERROR(o3d::E_InvalidPrecondition("Distribution must be defined for a worker"));
+    }
+
+    m_distribution = new Distribution(*config->getDistribution());
+
+    if (config->getPruning() && config->getPruning()->enabled()) {
+        // the median rule compares the candidates of the same job only
+        m_pruning = new Pruning(*config->getPruning());
+    }
+
+    char hostname[256] = {0};
+    gethostname(hostname, sizeof(hostname) - 1);
+
+    m_identity = o3d::String("{0}-{1}").arg(hostname).arg(static_cast<o3d::Int32>(::getpid())).toUtf8().getData();
+
+    m_context = new zmq::context_t(1);
+
+    INFO("distribution", o3d::String("Worker {0} pulls its jobs from {1}")
+         .arg(m_identity.c_str()).arg(m_distribution->connectAddress()));
+}
+
+void DistributedWorker::terminate(Config *config)
+{
+    Optimization::terminate(config);
+
+    // sockets are closed by the handler thread
+    o3d::deletePtr(m_context);
+    o3d::deletePtr(m_distribution);
+}
+
+o3d::Double DistributedWorker::progress() const
+{
+    if (m_finished) {
+        return 100.0;
+    }
+
+    if (m_jobId < 0 || m_toTs <= m_fromTs) {
+        return 0.0;
+    }
+
+    // of the current job, completed only once the coordinator has no more jobs
+    return o3d::clamp((m_curTs - m_fromTs) / (m_toTs - m_fromTs) * 100.0, 0.0, 99.0);
+}
+
+o3d::Int32 DistributedWorker::run(void *)
+{
+    connect();
+
+    Json::Value request = message("ready");
+
+    while (m_running) {
+        Json::Value reply;
+
+        if (!exchange(request, reply)) {
+            break;
+        }
+
+        std::string type = reply.get("type", "").asString();
+
+        if (type == "done") {
+            INFO("distribution", o3d::String("Worker {0} done after {1} jobs").arg(m_identity.c_str()).arg(m_numJobs));
+            break;
+        }
+
+        if (type == "wait") {
+            // running jobs of the others workers could be lost and then retried
+            o3d::Double until = wallTime() + reply.get("delay", 1.0).asDouble();
+            while (m_running && wallTime() < until) {
+                o3d::System::waitMs(100);
+            }
+
+            request = message("ready");
+            continue;
+        }
+
+        if (type != "job") {
+            request = message("ready");
+            continue;
+        }
+
+        o3d::String error;
+        o3d::Bool started = false;
+
+        try {
+            started = startJob(reply, error);
+            if (started) {
+                prepareBatch();
+            }
+        } catch (o3d::E_BaseException &e) {
+            error = e.getMsg();
+            started = false;
+        }
+
+        if (!started) {
+            WARN("distribution", o3d::String("Job {0} rejected : {1}").arg(m_jobId).arg(error));
+
+            request = message("reject");
+            request["job"] = m_jobId;
+            request["attempt"] = m_attempt;
+            request["error"] = error.toUtf8().getData();
+
+            releaseJob();
+            continue;
+        }
+
+        runPass();
+
+        if (!m_running) {
+            // interrupted, the job is given to another worker once its lease expired
+            break;
+        }
+
+        endPass();
+
+        request = jobResults();
+        releaseJob();
+
+        ++m_numJobs;
+    }
+
+    disconnect();
+
+    m_finished = true;
+    m_running = false;
+
+    return 0;
+}
+
+void DistributedWorker::onPassStep()
+{
+    // keep the lease of the job
+    o3d::Double now = wallTime();
+
+    if (now - m_lastHeartbeat >= m_distribution->heartbeat()) {
+        Json::Value heartbeat = message("heartbeat");
+        heartbeat["job"] = m_jobId;
+        heartbeat["attempt"] = m_attempt;
+
+        send(heartbeat);
+        m_lastHeartbeat = now;
+    }
+}
+
+void DistributedWorker::writeReports(Config *)
+{
+    // the results are reported by the coordinator
+}
+
+void DistributedWorker::connect()
+{
+    if (!m_socket) {
+        m_socket = new zmq::socket_t(*m_context, ZMQ_DEALER);
+
+        // don't block at termination if the coordinator is gone
+        int linger = 1000;
+        m_socket->setsockopt(ZMQ_LINGER, &linger, sizeof(linger));
+        m_socket->setsockopt(ZMQ_IDENTITY, m_identity.data(), m_identity.size());
+
+        m_socket->connect(m_distribution->connectAddress().toUtf8().getData());
+    }
+}
+
+void DistributedWorker::disconnect()
+{
+    if (m_socket) {
+        m_socket->close();
+        o3d::deletePtr(m_socket);
+    }
+}
+
+void DistributedWorker::send(const Json::Value &content)
+{
+    std::string data = Distribution::encode(content);
+
+    zmq::message_t msg(data.size());
+    memcpy(msg.data(), data.data(), data.size());
+
+    m_socket->send(msg, ZMQ_DONTWAIT);
+}
+
+o3d::Bool DistributedWorker::exchange(Json::Value &request, Json::Value &reply)
+{
+    // replies of the previous requests are ignored
+    request["seq"] = ++m_sequence;
+
+    o3d::Int32 retries = 0;
+    o3d::Double deadline = wallTime() + m_distribution->timeout();
+
+    send(request);
+
+    while (m_running) {
+        zmq::pollitem_t items[] = {
+            { static_cast<void*>(*m_socket), 0, ZMQ_POLLIN, 0 }
+        };
+
+        zmq::poll(&items[0], 1, 100);
+
+        if (items[0].revents & ZMQ_POLLIN) {
+            zmq::message_t msg;
+            m_socket->recv(&msg);
+
+            if (Distribution::decode(static_cast<const char*>(msg.data()), msg.size(), reply) &&
+                reply.get("seq", -1).asInt() == m_sequence) {
+                return true;
+            }
+
+            continue;
+        }
+
+        if (wallTime() > deadline) {
+            if (++retries > m_distribution->maxRetries()) {
+                ERR("distribution", o3d::String("Coordinator {0} lost").arg(m_distribution->connectAddress()));
+                return false;
+            }
+
+            WARN("distribution", o3d::String("No reply from the coordinator, retry {0}").arg(retries));
+
+            send(request);
+            deadline = wallTime() + m_distribution->timeout();
+        }
+    }
+
+    return false;
+}
+
+o3d::Bool DistributedWorker::startJob(const Json::Value &job, o3d::String &error)
+{
+    m_jobId = job.get("job", -1).asInt();
+    m_attempt = job.get("attempt", 0).asInt();
+    m_iteration = job.get("iteration", 0).asInt();
+
+    m_fromTs = job.get("from", 0.0).asDouble();
+    m_toTs = job.get("to", 0.0).asDouble();
+    m_curTs = m_fromTs;
+
+    if (m_fromTs <= 0.0 || m_toTs <= m_fromTs) {
+        error = "Invalid period";
+        return false;
+    }
+
+    // a feed per market of the job, having the same configuration of the markets than the coordinator
+    Json::Value markets = job.get("markets", Json::Value());
+    for (auto it = markets.begin(); it != markets.end(); ++it) {
+        o3d::CString marketId = it->asString().c_str();
+        const MarketConfig *marketConfig = nullptr;
+
+        for (const MarketConfig *mc : m_config->getConfiguredMarkets()) {
+            if (mc->marketId == marketId) {
+                marketConfig = mc;
+                break;
+            }
+        }
+
+        if (!marketConfig) {
+            error = o3d::String("Market {0} is not configured").arg(marketId);
+            return false;
+        }
+
+        m_feeds.push_back(createFeed(marketConfig));
+    }
+
+    if (m_feeds.empty()) {
+        error = "No market";
+        return false;
+    }
+
+    Json::Value candidates = job.get("candidates", Json::Value());
+    for (auto it = candidates.begin(); it != candidates.end(); ++it) {
+        Candidate *candidate = new Candidate(this, it->get("id", -1).asInt(), it->get("parameters", Json::Value()));
+        candidate->iteration = m_iteration;
+
+        m_candidates.push_back(candidate);
+        m_batch.push_back(candidate);
+    }
+
+    if (m_pruning) {
+        m_pruning->setPeriod(m_fromTs, m_toTs);
+        m_checkpointPerformances.assign(static_cast<size_t>(m_pruning->numCheckpoints()), std::vector<o3d::Double>());
+    }
+
+    m_lastHeartbeat = wallTime();
+
+    DBG("distribution", o3d::String("Job {0} attempt {1} of {2} candidates from {3} to {4}")
+        .arg(m_jobId).arg(m_attempt).arg(static_cast<o3d::Int32>(m_batch.size()))
+        .arg(timestampToStr(m_fromTs)).arg(timestampToStr(m_toTs)));
+
+    return true;
+}
+
+Json::Value DistributedWorker::jobResults() const
+{
+    Json::Value results = message("result");
+    results["job"] = m_jobId;
+    results["attempt"] = m_attempt;
+
+    Json::Value candidates(Json::arrayValue);
+
+    for (const Candidate *candidate : m_candidates) {
+        GlobalStatistics stats;
+
+        for (const Strategy *strategy : candidate->strategies) {
+            stats.add(strategy->statistics());
+        }
+
+        Json::Value result(Json::objectValue);
+        result["id"] = candidate->id;
+        result["stopped"] = candidate->stopped && !candidate->pruning.pruned();
+        result["pruned"] = static_cast<Json::Int>(candidate->pruning.reason);
+        result["performance"] = stats.performance;
+        result["max-draw-down-rate"] = stats.maxDrawDownRate;
+        result["max-draw-down"] = stats.maxDrawDown;
+        result["succeed-trades"] = stats.succeedTrades;
+        result["failed-trades"] = stats.failedTrades;
+        result["total-trades"] = stats.totalTrades;
+        result["best"] = stats.best;
+        result["worst"] = stats.worst;
+
+        candidates.append(result);
+    }
+
+    results["candidates"] = candidates;
+
+    return results;
+}
+
+void DistributedWorker::releaseJob()
+{
+    for (Candidate *candidate : m_candidates) {
+        for (Strategy *strategy : candidate->strategies) {
+            o3d::deletePtr(strategy);
+        }
+
+        for (Market *market : candidate->markets) {
+            o3d::deletePtr(market);
+        }
+
+        o3d::deletePtr(candidate);
+    }
+
+    m_candidates.clear();
+    m_batch.clear();
+
+    for (MarketFeed *feed : m_feeds) {
+        o3d::deletePtr(feed->market);
+        o3d::deletePtr(feed->replayBus);
+        o3d::deletePtr(feed);
+    }
+
+    m_feeds.clear();
+
+    m_jobId = -1;
+}
+
+Json::Value DistributedWorker::message(const char *type)
+{
+    Json::Value content(Json::objectValue);
+    content["type"] = type;
+
+    return content;
+}
+
+o3d::Double DistributedWorker::wallTime()
+{
+    return static_cast<o3d::Double>(o3d::System::getMsTime()) * 0.001;
+}
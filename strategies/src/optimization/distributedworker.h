@@ -0,0 +1,103 @@
+/**
+ * @brief SiiS strategy worker of a distributed optimization.
+ * @copyright Copyright (C) 2024 SiiS
+ * @author Frederic SCHERMA (frederic.scherma@gmail.com)
+ * @date 2024-10-17
+ */
+
+#ifndef SIIS_DISTRIBUTEDWORKER_H
+#define SIIS_DISTRIBUTEDWORKER_H
+
+#include "optimization.h"
+
+#include <string>
+
+namespace zmq {
+class context_t;
+class socket_t;
+}
+
+namespace siis {
+
+class Distribution;
+
+/**
+ * @brief Worker process of a distributed optimization.
+ * @author Frederic Scherma
+ * @date 2024-10-17
+ * Pull the jobs from the coordinator, run each one as a pass of the optimize mode over the period and
+ * the markets of the job, with the local market data, then push back the results of its candidates.
+ * While running a job a heartbeat is sent to the coordinator, else the job is given to another worker.
+ * It terminates once the coordinator has no more jobs or is no longer reachable.
+ */
+class DistributedWorker : public Optimization
+{
+public:
+
+    DistributedWorker();
+    virtual ~DistributedWorker() override;
+
+    virtual void init(
+            Displayer *displayer,
+            Config *config,
+            StrategyCollection *collection,
+            PoolWorker *poolWorker,
+            Database *database,
+            Cache *cache) override;
+
+    virtual void terminate(Config *config) override;
+
+    virtual o3d::Double progress() const override;
+
+protected:
+
+    virtual o3d::Int32 run(void *) override;
+
+    virtual void onPassStep() override;
+
+    virtual void writeReports(Config *config) override;
+
+private:
+
+    Distribution *m_distribution;
+
+    zmq::context_t *m_context;
+    zmq::socket_t *m_socket;     //!< only used by the handler thread
+
+    std::string m_identity;
+    o3d::Int32 m_sequence;
+
+    o3d::Int32 m_jobId;
+    o3d::Int32 m_attempt;
+    o3d::Double m_lastHeartbeat;
+
+    o3d::Int32 m_numJobs;
+    o3d::Bool m_finished;
+
+    void connect();
+    void disconnect();
+
+    void send(const Json::Value &content);
+
+    /**
+     * @brief exchange Send a request and wait for its reply, sending it again if the reply is too late.
+     * @return False if the coordinator is lost or if the worker is stopped.
+     */
+    o3d::Bool exchange(Json::Value &request, Json::Value &reply);
+
+    //! Feeds and candidates of a job.
+    o3d::Bool startJob(const Json::Value &job, o3d::String &error);
+
+    //! Results of the candidates of the terminated job.
+    Json::Value jobResults() const;
+
+    //! Delete the candidates and the feeds of the job.
+    void releaseJob();
+
+    static Json::Value message(const char *type);
+    static o3d::Double wallTime();
+};
+
+} // namespace siis
+
+#endif // SIIS_DISTRIBUTEDWORKER_H
@@ -10,27 +10,289 @@
 #include "siis/connector/localconnector.h"
 #include "siis/connector/traderproxy.h"
 
-#include "siis/database/tickstream.h"
+#include "siis/database/replaybus.h"
 
 #include "siis/poolworker.h"
 
 #include "siis/strategy.h"
 #include "siis/market.h"
-#include "siis/learning/optimizer.h"
 #include "siis/collection.h"
+#include "siis/config/config.h"
+#include "siis/learning/parameterspace.h"
+#include "siis/learning/optimizer.h"
+#include "siis/learning/validation.h"
+#include "siis/learning/resultstore.h"
+#include "siis/statistics/statistics.h"
 #include "siis/display/displayer.h"
+#include "siis/display/asynclogger.h"
 
 #include "siis/utils/common.h"
+#include "siis/utils/snapshot.h"
 
 #include "siis/database/database.h"
 #include "siis/database/marketdb.h"
 
 #include <o3d/core/debug.h>
+#include <o3d/core/filemanager.h>
+
+#include <json/writer.h>
+
+#include <algorithm>
+#include <cmath>
 
 using namespace siis;
 using o3d::Debug;
 using o3d::Logger;
 
+Optimization::Candidate::Candidate(Optimization *optimization, o3d::Int32 _id, const Json::Value &_parameters) :
+    id(_id),
+    iteration(0),
+    parameters(_parameters),
+    stopped(false),
+    terminated(false),
+    score(0.0),
+    m_optimization(optimization),
+    m_connector(nullptr),
+    m_traderProxy(nullptr)
+{
+    // own local connector and virtual account
+    m_connector = new LocalConnector(this);
+    m_connector->init(optimization->m_config);
+
+    m_traderProxy = new TraderProxy(m_connector);
+    m_connector->setTraderProxy(m_traderProxy);
+}
+
+Optimization::Candidate::~Candidate()
+{
+    // the strategies are deleted before
+    if (m_connector) {
+        m_connector->terminate();
+        m_connector->setTraderProxy(nullptr);
+    }
+
+    o3d::deletePtr(m_traderProxy);
+    o3d::deletePtr(m_connector);
+}
+
+void Optimization::Candidate::release()
+{
+    statistics.clear();
+    statistics.reserve(strategies.size());
+
+    for (Strategy *strategy : strategies) {
+        statistics.push_back(strategy->statistics());
+        o3d::deletePtr(strategy);
+    }
+
+    for (Market *market : markets) {
+        o3d::deletePtr(market);
+    }
+
+    strategies.clear();
+    markets.clear();
+
+    // the virtual account is no longer needed
+    if (m_connector) {
+        m_connector->terminate();
+        m_connector->setTraderProxy(nullptr);
+    }
+
+    o3d::deletePtr(m_traderProxy);
+    o3d::deletePtr(m_connector);
+}
+
+GlobalStatistics Optimization::Candidate::globalStatistics() const
+{
+    GlobalStatistics stats;
+
+    for (const Statistics &s : statistics) {
+        stats.add(s);
+    }
+
+    return stats;
+}
+
+o3d::Double Optimization::Candidate::performance() const
+{
+    o3d::Double result = 0.0;
+
+    for (const Strategy *strategy : strategies) {
+        result += strategy->statistics().performance + strategy->statistics().unrealizedPerformance;
+    }
+
+    return result;
+}
+
+o3d::Int32 Optimization::Candidate::numTrades() const
+{
+    o3d::Int32 result = 0;
+
+    for (const Strategy *strategy : strategies) {
+        result += strategy->statistics().totalTrades;
+    }
+
+    return result;
+}
+
+o3d::Int32 Optimization::Candidate::run(void *)
+{
+    for (size_t i = 0; i < m_optimization->m_feeds.size(); ++i) {
+        const MarketFeed *feed = m_optimization->m_feeds[i];
+        if (!feed->chunk) {
+            continue;
+        }
+
+        Strategy *strategy = strategies[i];
+
+        if (strategy->running() && !stopped) {
+            // inject the shared ticks and closed ohlc into the strategy, then process one iteration
+            feed->replayBus->feedStrategy(strategy, markets[i], feed->chunk);
+            strategy->process(feed->chunk->lastTimestamp());
+        }
+
+        // one reference per candidate
+        feed->chunk->release();
+    }
+
+    if (!stopped) {
+        // orders, positions and virtual account of this candidate only
+        m_connector->update();
+    }
+
+    return 0;
+}
+
+void Optimization::Candidate::init(Displayer *, Config *, StrategyCollection *, PoolWorker *, Database *, Cache *)
+{
+    // initialized by the optimization
+}
+
+o3d::Bool Optimization::Candidate::isBacktesting() const
+{
+    return m_optimization->isBacktesting();
+}
+
+void Optimization::Candidate::terminate(Config *)
+{
+    // terminated by the optimization
+}
+
+void Optimization::Candidate::start()
+{
+    // run by the optimization
+}
+
+void Optimization::Candidate::stop()
+{
+    // run by the optimization
+}
+
+void Optimization::Candidate::sync()
+{
+    // nothing
+}
+
+o3d::Double Optimization::Candidate::timestamp() const
+{
+    return m_optimization->timestamp();
+}
+
+o3d::Double Optimization::Candidate::progress() const
+{
+    return m_optimization->progress();
+}
+
+const TraderProxy *Optimization::Candidate::traderProxy() const
+{
+    return m_traderProxy;
+}
+
+TraderProxy *Optimization::Candidate::traderProxy()
+{
+    return m_traderProxy;
+}
+
+void Optimization::Candidate::setPaperMode(o3d::Bool)
+{
+    // not available in optimization
+}
+
+void Optimization::Candidate::onTick(const o3d::CString &, const Tick &)
+{
+    // fed by the optimization
+}
+
+void Optimization::Candidate::onOhlc(const o3d::CString &, Ohlc::Type, const Ohlc &)
+{
+    // fed by the optimization
+}
+
+Market *Optimization::Candidate::market(const o3d::CString &marketId)
+{
+    for (Market *market : markets) {
+        if (market->marketId() == marketId) {
+            return market;
+        }
+    }
+
+    return nullptr;
+}
+
+const Market *Optimization::Candidate::market(const o3d::CString &marketId) const
+{
+    for (const Market *market : markets) {
+        if (market->marketId() == marketId) {
+            return market;
+        }
+    }
+
+    return nullptr;
+}
+
+Strategy *Optimization::Candidate::strategy(const o3d::CString &marketId)
+{
+    for (size_t i = 0; i < markets.size() && i < strategies.size(); ++i) {
+        if (markets[i]->marketId() == marketId) {
+            return strategies[i];
+        }
+    }
+
+    return nullptr;
+}
+
+const Strategy *Optimization::Candidate::strategy(const o3d::CString &marketId) const
+{
+    for (size_t i = 0; i < markets.size() && i < strategies.size(); ++i) {
+        if (markets[i]->marketId() == marketId) {
+            return strategies[i];
+        }
+    }
+
+    return nullptr;
+}
+
+Database *Optimization::Candidate::database()
+{
+    return m_optimization->database();
+}
+
+Cache *Optimization::Candidate::cache()
+{
+    return m_optimization->cache();
+}
+
+AsyncLogger *Optimization::Candidate::logger()
+{
+    return m_optimization->logger();
+}
+
+void Optimization::Candidate::log(const o3d::String &unit, const o3d::String &marketId, const o3d::String &channel,
+                                  const o3d::String &msg, o3d::System::MessageLevel type)
+{
+    m_optimization->log(unit, marketId, channel, msg, type);
+}
+
 Optimization::Optimization() :
     m_thread(this),
     m_running(false),
@@ -38,12 +300,23 @@ Optimization::Optimization() :
     m_toTs(0.0),
     m_curTs(0.0),
     m_timestep(0.0),
+    m_iteration(0),
+    m_numIterations(1),
+    m_config(nullptr),
+    m_collection(nullptr),
+    m_optimizer(nullptr),
+    m_pruning(nullptr),
+    m_resultStore(nullptr),
+    m_equityTimeframe(0.0),
+    m_nextEquityTs(0.0),
     m_connector(nullptr),
     m_traderProxy(nullptr),
     m_monitor(nullptr),
     m_poolWorker(nullptr),
     m_database(nullptr),
-    m_cache(nullptr)
+    m_cache(nullptr),
+    m_logger(nullptr),
+    m_validation(nullptr)
 {
 
 }
@@ -68,8 +341,7 @@ void Optimization::init(
     O3D_ASSERT(database != nullptr);
     O3D_ASSERT(cache != nullptr);
 
-    m_displayer = displayer;
-    m_database = database;
+    initHandler(displayer, config, collection, poolWorker, database, cache);
 
     m_fromTs = config->getFromTs();
     m_toTs = config->getToTs();
@@ -88,79 +360,792 @@ void Optimization::init(
         O3D_ERROR(o3d::E_InvalidPrecondition("Timestep must be greater than 0"));
     }
 
+    const ParameterSpace *space = config->getParameterSpace();
+
+    if (space && space->iterative()) {
+        // candidates given batch per batch by the optimizer
+        m_optimizer = space->createOptimizer();
+        m_numIterations = space->numIterations();
+
+        INFO("optimization", o3d::String("Optimize using {0} with {1} iterations of {2} candidates on {3} markets")
+             .arg(m_optimizer->typeName())
+             .arg(m_numIterations)
+             .arg(space->batchSize())
+             .arg(static_cast<o3d::Int32>(config->getConfiguredMarkets().size())));
+    } else {
+        // every candidates of the parameter space in a single pass
+        m_numIterations = 1;
+    }
+
+    if (config->getValidation()) {
+        // folds over the whole period, evaluated from the results of the same pass
+        m_validation = new Validation(*config->getValidation());
+        m_validation->generate(m_fromTs, m_toTs);
+
+        INFO("optimization", o3d::String("Validation using {0} folds").arg(m_validation->numFolds()));
+    }
+
+    if (config->getPruning() && config->getPruning()->enabled()) {
+        // stop on the fly the candidates violating the constraints
+        m_pruning = new Pruning(*config->getPruning());
+        m_pruning->setPeriod(m_fromTs, m_toTs);
+
+        m_checkpointPerformances.resize(static_cast<size_t>(m_pruning->numCheckpoints()));
+    }
+
+    if (config->isResultStoreEnabled()) {
+        // rows appended candidate per candidate
+        createResultStore(config);
+    }
+
+    for (MarketConfig *mc : config->getConfiguredMarkets()) {
+        m_feeds.push_back(createFeed(mc));
+    }
+
+    // the first batch is ready before starting
+    nextBatch();
+    prepareBatch();
+
+    if (!m_optimizer) {
+        INFO("optimization", o3d::String("Evaluate {0} candidates on {1} markets")
+             .arg(static_cast<o3d::Int32>(m_candidates.size()))
+             .arg(static_cast<o3d::Int32>(m_feeds.size())));
+    }
+}
+
+void Optimization::initHandler(
+        Displayer *displayer,
+        Config *config,
+        StrategyCollection *collection,
+        PoolWorker *poolWorker,
+        Database *database,
+        Cache *cache)
+{
+    m_displayer = displayer;
+
+    // asynchronous logger (must exists before building the strategies)
+    m_logger = new AsyncLogger(this, displayer, static_cast<o3d::UInt32>(config->getLogRingSize()));
+    m_logger->setEnabled(config->isLogEnabled());
+
+    for (auto pair : config->getLogRateLimits()) {
+        m_logger->setRateLimit(pair.first, pair.second);
+    }
+
+    m_database = database;
+
+    // create and start a primary local connector in this thread
+    m_connector = new LocalConnector(this);
+    m_connector->init(config);
+
+    // and a trader proxy based on this connector
+    m_traderProxy = new TraderProxy(m_connector);
+
+    // and define this proxy on the primary connector
+    m_connector->setTraderProxy(m_traderProxy);
+
+    m_poolWorker = poolWorker;
+    m_cache = cache;
+
+    m_config = config;
+    m_collection = collection;
+}
+
+Optimization::MarketFeed *Optimization::createFeed(const MarketConfig *mc)
+{
+    MarketFeed *feed = new MarketFeed();
+    feed->marketId = mc->marketId;
+    feed->market = new Market(mc->marketId, mc->marketId, "", "");
+    feed->marketTradeType = mc->marketTradeType;
+
+    // market data from database (synchronous)
+    if (!m_database->market()->fetchMarket(m_config->getBrokerId(), mc->marketId, feed->market)) {
+        o3d::deletePtr(feed->market);
+        o3d::deletePtr(feed);
+
+        O3D_ERROR(o3d::E_InvalidPrecondition(o3d::String("Unable to find market info for ") + mc->marketId));
+    }
+
+    return feed;
+}
+
+void Optimization::onPassStep()
+{
+    // nothing by default
+}
+
+void Optimization::nextBatch()
+{
+    const ParameterSpace *space = m_config->getParameterSpace();
+
+    std::vector<Json::Value> parameters;
+    std::vector<Optimizer::Point> points;
+
+    m_batch.clear();
+
+    if (m_optimizer) {
+        m_optimizer->ask(space->batchSize(), points);
+
+        for (const Optimizer::Point &point : points) {
+            parameters.push_back(space->candidateAt(point));
+        }
+    } else if (m_iteration == 0) {
+        // candidates from the parameter space, else a single one with the default parameters
+        if (space) {
+            space->generate(parameters);
+        } else {
+            parameters.push_back(Json::Value(Json::objectValue));
+        }
+    }
+
+    for (size_t c = 0; c < parameters.size(); ++c) {
+        Candidate *candidate = new Candidate(this, static_cast<o3d::Int32>(m_candidates.size()), parameters[c]);
+        candidate->iteration = m_iteration;
+
+        if (c < points.size()) {
+            candidate->point = points[c];
+        }
+
+        m_candidates.push_back(candidate);
+        m_batch.push_back(candidate);
+    }
+}
+
+void Optimization::prepareBatch()
+{
     o3d::DateTime fromDt;
     fromDt.fromTime(m_fromTs, true);
 
     o3d::DateTime toDt;
     toDt.fromTime(m_toTs, true);
 
-    for (MarketConfig *mc : config->getConfiguredMarkets()) {
-        Market *market = new Market(mc->marketId, mc->marketId, "", "");  // @todo fetch market from DB if exists
-
-        Strategy *strategy = collection->build(this, config->getStrategy(), config->getStrategyIdentifier());
-        strategy->setMarket(market);
-        strategy->init(config);
-
-        // Supervisor *supervisor = collection->builder(this, config->getStrategy(), config->getStrategyIdentifier());
-        // supervisor->init(config);
-
-        OptimizerElt elt;
-        elt.strategy = strategy;
-        // elt.optimizer = optimizer;
-        elt.market = market;
-
-        strategy->prepareMarketData(m_connector, m_database, m_fromTs, m_toTs);
-        strategy->finalizeMarketData(m_connector, m_database);
-
-        for (DataSource ds : strategy->getDataSources()) {
-            // create the stream (for now only tick stream, but could offer OHLC too, but no possibility for order-book history)
-            if (ds.type == DataSource::TICK) {
-                TickStream *ts = new TickStream(config->getMarketsPath().getFullPathName(),
-                                                config->getBrokerId(), mc->marketId, fromDt, toDt);
-
-                elt.tickStream = ts;
-
-            } else if (ds.type == DataSource::OHLC_MID) {
-                // @todo fetch and stream ...
-            } else if (ds.type == DataSource::OHLC_BID) {
-                // @todo ...
-            } else if (ds.type == DataSource::OHLC_ASK) {
-                // @todo ...
-            } else if (ds.type == DataSource::ORDER_BOOK) {
-                // not possible for now
+    for (MarketFeed *feed : m_feeds) {
+        // a new replay of the period per pass
+        feed->replayBus = new ReplayBus(m_database, m_config->getMarketsPath().getFullPathName(),
+                                        m_config->getBrokerId(), feed->marketId, fromDt, toDt);
+
+        // a strategy and its own market per candidate, because of the prices and the trades
+        for (Candidate *candidate : m_batch) {
+            // market info fetched once per feed
+            Market *market = new Market(feed->marketId, feed->marketId, "", "");
+            market->copyInfo(*feed->market);
+
+            if (feed->marketTradeType > -1) {
+                market->setTradeCapacities(feed->marketTradeType);
             }
+
+            // the candidate is the handler, for its own trader proxy
+            Strategy *strategy = m_collection->build(candidate, m_config->getStrategy(), m_config->getStrategyIdentifier());
+            strategy->setParameterOverrides(candidate->parameters);
+            strategy->setMarket(market);
+            strategy->setDetailedStatistics(m_config->isDetailedStatistics());
+            strategy->init(m_config);
+
+            candidate->strategies.push_back(strategy);
+            candidate->markets.push_back(market);
         }
+    }
 
-        m_optimizers[mc->marketId] = elt;
+    if (m_batch.empty()) {
+        return;
     }
 
-    // and a trader proxy based on this connector
-    m_traderProxy = new TraderProxy(m_connector);
+    // warm-up once per market with the first candidate, in parallel, each job using its own connection
+    Candidate *reference = m_batch[0];
 
-    m_poolWorker = poolWorker;
-    m_cache = cache;
+    PoolWorker::CountDown countDown;
+    countDown.count = static_cast<o3d::Int32>(m_feeds.size());
+
+    for (Strategy *strategy : reference->strategies) {
+        m_poolWorker->addPrepareJob(strategy, reference->connector(), m_database, m_fromTs, m_toTs, &countDown);
+    }
+
+    countDown.wait();
+
+    // copy the prepared state into the other candidates
+    std::vector<std::pair<Candidate*, Strategy*>> unprepared;
+
+    for (size_t i = 0; i < m_feeds.size(); ++i) {
+        SnapshotWriter writer;
+        reference->strategies[i]->writeSnapshot(writer);
+
+        for (size_t c = 1; c < m_batch.size(); ++c) {
+            Strategy *strategy = m_batch[c]->strategies[i];
+
+            SnapshotReader reader;
+            reader.load(writer);
+
+            if (!strategy->readSnapshot(reader, m_fromTs, 0.0, "warm-up")) {
+                unprepared.push_back(std::make_pair(m_batch[c], strategy));
+            }
+        }
+    }
+
+    if (!unprepared.empty()) {
+        // other analysers configuration or no snapshot support, prepared by their own
+        countDown.count = static_cast<o3d::Int32>(unprepared.size());
+
+        for (std::pair<Candidate*, Strategy*> &pair : unprepared) {
+            m_poolWorker->addPrepareJob(pair.second, pair.first->connector(), m_database, m_fromTs, m_toTs, &countDown);
+        }
+
+        countDown.wait();
+    }
+
+    for (size_t i = 0; i < m_feeds.size(); ++i) {
+        MarketFeed *feed = m_feeds[i];
+
+        for (Candidate *candidate : m_batch) {
+            Strategy *strategy = candidate->strategies[i];
+            strategy->finalizeMarketData(candidate->connector(), m_database);
+
+            for (DataSource ds : strategy->getDataSources()) {
+                // a single reader per market for all the candidates
+                if (!feed->replayBus->subscribe(ds) && ds.type != DataSource::ORDER_BOOK) {
+                    WARN("optimization", o3d::String("Candidate {0} uses another base timeframe than the shared stream of {1}")
+                         .arg(candidate->id).arg(feed->marketId));
+                }
+            }
+        }
+    }
+}
+
+void Optimization::runPass()
+{
+    PoolWorker::CountDown countDown;
+    o3d::Bool updated = false;
+
+    const ParameterSpace *space = m_config->getParameterSpace();
+
+    o3d::Int32 numCheckpoints = m_optimizer ? space->earlyStopping().checkpoints : 0;
+    o3d::Int32 checkpoint = 0;
+    o3d::Double checkpointStep = (m_toTs - m_fromTs) / (numCheckpoints + 1);
+
+    o3d::Int32 numActives = static_cast<o3d::Int32>(m_batch.size());
+
+    m_curTs = m_fromTs;
+    m_nextEquityTs = m_fromTs;
+
+    while (m_running && numActives > 0) {
+        if (m_curTs > m_toTs) {
+            break;
+        }
+
+        updated = false;
+
+        for (MarketFeed *feed : m_feeds) {
+            // decoded once, referenced by every candidates
+            feed->chunk = feed->replayBus->next(m_curTs, static_cast<o3d::Int32>(m_batch.size()));
+            if (feed->chunk) {
+                updated = true;
+            }
+        }
+
+        if (updated) {
+            // every candidate process its strategies from the shared feeds, in parallel
+            countDown.count = static_cast<o3d::Int32>(m_batch.size());
+
+            for (Candidate *candidate : m_batch) {
+                m_poolWorker->addRunnableJob(candidate, nullptr, &countDown);
+            }
+
+            // sync before continue, the virtual accounts are updated by each candidate
+            countDown.wait();
+
+            for (MarketFeed *feed : m_feeds) {
+                // released by the candidates
+                feed->chunk = nullptr;
+            }
+        }
+
+        if (m_pruning) {
+            numActives -= pruneCandidates();
+        }
+
+        if (m_equityTimeframe > 0.0 && m_curTs >= m_nextEquityTs) {
+            // the equity curve ends when the candidate is stopped
+            for (Candidate *candidate : m_batch) {
+                if (!candidate->stopped) {
+                    candidate->equity.push_back(candidate->performance());
+                }
+            }
+
+            m_nextEquityTs += m_equityTimeframe;
+        }
+
+        if (checkpoint < numCheckpoints && m_curTs >= m_fromTs + (checkpoint + 1) * checkpointStep) {
+            ++checkpoint;
+            numActives -= stopLosingCandidates();
+        }
+
+        m_curTs += m_timestep;
+
+        onPassStep();
+
+        // yield
+        //o3d::System::waitMs(0);
+    }
+}
+
+o3d::Int32 Optimization::stopLosingCandidates()
+{
+    const ParameterSpace::EarlyStopping &earlyStopping = m_config->getParameterSpace()->earlyStopping();
+
+    std::vector<std::pair<o3d::Double, Candidate*>> losing;
+    o3d::Int32 n = 0;
+
+    for (Candidate *candidate : m_batch) {
+        if (candidate->stopped) {
+            continue;
+        }
+
+        o3d::Double performance = candidate->performance();
+
+        if (earlyStopping.maxLoss > 0.0 && performance <= -earlyStopping.maxLoss) {
+            candidate->stopped = true;
+            candidate->score = performance;
+            ++n;
+        } else if (performance < 0.0) {
+            losing.push_back(std::make_pair(performance, candidate));
+        }
+    }
+
+    // the worst quantile of the candidates in loss
+    std::sort(losing.begin(), losing.end(), [](const std::pair<o3d::Double, Candidate*> &a,
+                                              const std::pair<o3d::Double, Candidate*> &b) {
+        return a.first < b.first;
+    });
+
+    size_t count = static_cast<size_t>(earlyStopping.quantile * losing.size());
+
+    for (size_t i = 0; i < count; ++i) {
+        losing[i].second->stopped = true;
+        losing[i].second->score = losing[i].first;
+        ++n;
+    }
+
+    if (n > 0) {
+        INFO("optimization", o3d::String("Iteration {0} early stopped {1} candidates at {2}")
+             .arg(m_iteration).arg(n).arg(timestampToStr(m_curTs)));
+    }
+
+    return n;
+}
+
+o3d::Int32 Optimization::pruneCandidates()
+{
+    std::vector<std::pair<o3d::Double, Candidate*>> reached;
+    o3d::Int32 checkpoint = -1;
+    o3d::Int32 n = 0;
+
+    for (Candidate *candidate : m_batch) {
+        if (candidate->stopped) {
+            continue;
+        }
+
+        o3d::Double performance = candidate->performance();
+
+        if (m_pruning->update(candidate->pruning, performance, candidate->numTrades(), m_curTs)) {
+            candidate->stopped = true;
+            candidate->score = performance;
+            ++n;
+
+            continue;
+        }
+
+        // the active candidates reach the checkpoints at the same timestep
+        o3d::Int32 c = m_pruning->reachCheckpoint(candidate->pruning, m_curTs);
+        if (c >= 0) {
+            checkpoint = c;
+            m_checkpointPerformances[static_cast<size_t>(c)].push_back(performance);
+            reached.push_back(std::make_pair(performance, candidate));
+        }
+    }
+
+    if (checkpoint >= 0) {
+        // compared to the candidates of this batch and of the previous iterations at the same checkpoint
+        const std::vector<o3d::Double> &references = m_checkpointPerformances[static_cast<size_t>(checkpoint)];
+
+        for (std::pair<o3d::Double, Candidate*> &pair : reached) {
+            if (m_pruning->checkMedian(pair.second->pruning, pair.first, references, m_curTs)) {
+                pair.second->stopped = true;
+                pair.second->score = pair.first;
+                ++n;
+            }
+        }
+    }
+
+    if (n > 0) {
+        INFO("optimization", o3d::String("Iteration {0} pruned {1} candidates at {2}")
+             .arg(m_iteration).arg(n).arg(timestampToStr(m_curTs)));
+    }
+
+    return n;
+}
+
+void Optimization::endPass()
+{
+    std::vector<Optimizer::Point> points;
+    std::vector<o3d::Double> scores;
+
+    for (Candidate *candidate : m_batch) {
+        if (!candidate->stopped) {
+            candidate->score = candidate->performance();
+        }
+
+        for (Strategy *strategy : candidate->strategies) {
+            strategy->terminate(candidate->connector(), m_database);
+        }
+
+        // only the results are retained over the iterations
+        candidate->release();
+        candidate->terminated = true;
+
+        if (m_resultStore) {
+            storeCandidate(candidate);
+        }
+
+        points.push_back(candidate->point);
+        scores.push_back(candidate->score);
+    }
+
+    for (MarketFeed *feed : m_feeds) {
+        feed->chunk = nullptr;
+        o3d::deletePtr(feed->replayBus);
+    }
+
+    if (m_optimizer && !m_batch.empty()) {
+        m_optimizer->tell(points, scores);
+
+        INFO("optimization", o3d::String("Iteration {0}/{1} best performance {2}%")
+             .arg(m_iteration + 1).arg(m_numIterations).arg(m_optimizer->bestScore()*100, 2));
+    }
+
+    m_batch.clear();
+
+    // the progress of the next pass
+    m_curTs = m_fromTs;
+}
+
+o3d::Bool Optimization::isBacktesting() const
+{
+    return true;
 }
 
 void Optimization::terminate(Config *config)
 {
-    // delete strategies and markets
-    for (auto pair : m_optimizers) {
-        pair.second.strategy->terminate(m_connector, m_database);
-        // pair.second.optimizer->terminate(m_connector, m_database);
+    // candidates of an interrupted pass
+    for (Candidate *candidate : m_candidates) {
+        if (!candidate->terminated) {
+            for (Strategy *strategy : candidate->strategies) {
+                strategy->terminate(candidate->connector(), m_database);
+            }
+
+            candidate->release();
+            candidate->terminated = true;
+
+            if (m_resultStore) {
+                storeCandidate(candidate);
+            }
+        }
+    }
+
+    m_batch.clear();
+
+    if (m_resultStore) {
+        INFO("results", o3d::String("Results of {0} candidates stored to {1}")
+             .arg(m_resultStore->numRows()).arg(m_resultStore->filename()));
+
+        o3d::deletePtr(m_resultStore);
+    }
+
+    writeReports(config);
 
-        // o3d::deletePtr(pair.second.supervisor);
-        o3d::deletePtr(pair.second.market);
-        o3d::deletePtr(pair.second.tickStream);
+    o3d::deletePtr(m_validation);
+
+    // strategies and markets are released at the end of each pass
+    for (Candidate *candidate : m_candidates) {
+        o3d::deletePtr(candidate);
+    }
+
+    m_candidates.clear();
+
+    for (MarketFeed *feed : m_feeds) {
+        o3d::deletePtr(feed->market);
+        o3d::deletePtr(feed->replayBus);
+        o3d::deletePtr(feed);
+    }
+
+    m_feeds.clear();
+
+    o3d::deletePtr(m_optimizer);
+    o3d::deletePtr(m_pruning);
+
+    // delete before primary connector
+    if (m_traderProxy) {
+        if (m_connector) {
+            m_connector->terminate();
+            m_connector->setTraderProxy(nullptr);
+        }
+
+        o3d::deletePtr(m_traderProxy);
+    }
+
+    if (m_connector) {
+        o3d::deletePtr(m_connector);
+    }
+
+    if (m_logger) {
+        o3d::deletePtr(m_logger);
     }
-    m_optimizers.clear();
 
     m_poolWorker = nullptr;
     m_database = nullptr;
     m_cache = nullptr;
+    m_config = nullptr;
+    m_collection = nullptr;
+}
+
+void Optimization::writeReports(Config *config)
+{
+    // one row of results per candidate
+    writeResults(config);
+
+    if (m_validation) {
+        // one row of results per fold
+        writeValidation(config);
+    }
+}
+
+void Optimization::createResultStore(Config *config)
+{
+    const ParameterSpace *space = config->getParameterSpace();
+
+    std::vector<std::string> parameters;
+    std::vector<std::string> stats = {
+        "performance", "max-draw-down-rate", "max-draw-down", "succeed-trades", "failed-trades",
+        "total-trades", "best", "worst", "score"
+    };
+
+    if (space) {
+        for (const ParameterSpace::Range &range : space->ranges()) {
+            parameters.push_back(range.name);
+        }
+    }
+
+    o3d::String filename = config->getStrategyIdentifier() + "-optimization.rslt";
+    o3d::File file(config->getReportsPath().getFullPathName(), filename);
+
+    m_resultStore = new ResultStore();
+
+    if (!m_resultStore->create(file.getFullFileName(), parameters, stats)) {
+        o3d::deletePtr(m_resultStore);
+        O3D_ERROR(o3d::E_InvalidPrecondition(o3d::String("Unable to create the result store ") + file.getFullFileName()));
+    }
+
+    m_equityTimeframe = config->getEquityCurveTimeframe();
+}
+
+void Optimization::storeCandidate(Candidate *candidate)
+{
+    const ParameterSpace *space = m_config->getParameterSpace();
+
+    GlobalStatistics stats = candidate->globalStatistics();
+
+    ResultStore::Row row;
+    row.candidate = candidate->id;
+    row.iteration = candidate->iteration;
+    row.pruned = candidate->pruning.reason;
+    row.flags = candidate->stopped && !candidate->pruning.pruned() ? ResultStore::FLAG_EARLY_STOPPED : 0;
+
+    if (space) {
+        for (const ParameterSpace::Range &range : space->ranges()) {
+            row.parameters.push_back(candidate->parameters.get(range.name, Json::Value()));
+        }
+    }
+
+    row.stats = {
+        stats.performance, stats.maxDrawDownRate, stats.maxDrawDown,
+        static_cast<o3d::Double>(stats.succeedTrades), static_cast<o3d::Double>(stats.failedTrades),
+        static_cast<o3d::Double>(stats.totalTrades), stats.best, stats.worst, candidate->score
+    };
+
+    row.equityFrom = m_fromTs;
+    row.equityStep = m_equityTimeframe;
+    row.equity.swap(candidate->equity);
+
+    if (!m_resultStore->append(row)) {
+        WARN("results", o3d::String("Unable to store the results of the candidate {0}").arg(candidate->id));
+    }
+}
+
+void Optimization::writeResults(Config *config)
+{
+    const ParameterSpace *space = config->getParameterSpace();
+
+    o3d::String content("candidate;iteration;early-stopped;pruned;performance;max-draw-down-rate;max-draw-down;succeed-trades;failed-trades;total-trades;best;worst");
+
+    if (space) {
+        for (const ParameterSpace::Range &range : space->ranges()) {
+            content += ';';
+            content += range.name.c_str();
+        }
+    }
+
+    content += '\n';
+
+    Json::StreamWriterBuilder builder;
+    builder["indentation"] = "";
+
+    const Candidate *bestCandidate = nullptr;
+    o3d::Double bestPerformance = 0.0;
+
+    for (const Candidate *candidate : m_candidates) {
+        GlobalStatistics stats = candidate->globalStatistics();
+
+        content += o3d::String("{0};{1};{2};{3};{4};{5};{6};{7};{8};{9};{10};{11}")
+                   .arg(candidate->id)
+                   .arg(candidate->iteration)
+                   .arg(candidate->stopped && !candidate->pruning.pruned() ? 1 : 0)
+                   .arg(Pruning::reasonToStr(candidate->pruning.reason))
+                   .arg(stats.performance*100, 4)
+                   .arg(stats.maxDrawDownRate*100, 4)
+                   .arg(stats.maxDrawDown, 4)
+                   .arg(stats.succeedTrades)
+                   .arg(stats.failedTrades)
+                   .arg(stats.totalTrades)
+                   .arg(stats.best*100, 4)
+                   .arg(stats.worst*100, 4);
+
+        if (space) {
+            for (const ParameterSpace::Range &range : space->ranges()) {
+                content += ';';
+                content += Json::writeString(builder, candidate->parameters.get(range.name, Json::Value())).c_str();
+            }
+        }
+
+        content += '\n';
+
+        if (!bestCandidate || stats.performance > bestPerformance) {
+            bestCandidate = candidate;
+            bestPerformance = stats.performance;
+        }
+    }
+
+    o3d::String filename = config->getStrategyIdentifier() + "-optimization.csv";
+
+    o3d::File file(config->getReportsPath().getFullPathName(), filename);
+    o3d::OutStream *os = o3d::FileManager::instance()->openOutStream(file.getFullFileName(), o3d::FileOutStream::CREATE);
+
+    os->writeString(content);
+    o3d::deletePtr(os);
+
+    INFO("results", o3d::String("Results of {0} candidates written to {1}")
+         .arg(static_cast<o3d::Int32>(m_candidates.size())).arg(file.getFullFileName()));
+
+    if (bestCandidate) {
+        INFO("results", o3d::String("Best candidate {0} performance {1}%")
+             .arg(bestCandidate->id).arg(bestPerformance*100, 2));
+    }
+}
+
+void Optimization::writeValidation(Config *config)
+{
+    if (m_candidates.empty()) {
+        return;
+    }
+
+    std::vector<std::vector<const Statistics*>> stats(m_candidates.size());
+
+    for (size_t c = 0; c < m_candidates.size(); ++c) {
+        for (const Statistics &s : m_candidates[c]->statistics) {
+            stats[c].push_back(&s);
+        }
+    }
+
+    o3d::String content("fold;in-sample-from;in-sample-to;out-of-sample-from;out-of-sample-to;candidate;"
+                        "in-sample-performance;out-of-sample-performance;out-of-sample-max-draw-down-rate;"
+                        "out-of-sample-succeed-trades;out-of-sample-failed-trades;out-of-sample-total-trades\n");
+
+    std::vector<o3d::Double> cvScores(m_candidates.size(), 0.0);
+
+    o3d::Double sumIs = 0.0, sumOos = 0.0, sumSqrOos = 0.0;
+    o3d::Double isDuration = 0.0, oosDuration = 0.0;
+
+    for (const Validation::Fold &fold : m_validation->folds()) {
+        size_t best = 0;
+        Validation::WindowStats bestIs;
+
+        for (size_t c = 0; c < m_candidates.size(); ++c) {
+            Validation::WindowStats is = m_validation->inSampleStats(stats[c], fold);
+            if (c == 0 || is.performance > bestIs.performance) {
+                best = c;
+                bestIs = is;
+            }
+
+            // cross-validated score of each candidate
+            cvScores[c] += m_validation->outOfSampleStats(stats[c], fold).performance;
+        }
+
+        Validation::WindowStats oos = m_validation->outOfSampleStats(stats[best], fold);
+
+        content += o3d::String("{0};{1};{2};{3};{4};{5};{6};{7};{8};{9};{10};{11}\n")
+                   .arg(fold.index)
+                   .arg(timestampToStr(fold.inSampleFrom)).arg(timestampToStr(fold.inSampleTo))
+                   .arg(timestampToStr(fold.outOfSampleFrom)).arg(timestampToStr(fold.outOfSampleTo))
+                   .arg(m_candidates[best]->id)
+                   .arg(bestIs.performance*100, 4)
+                   .arg(oos.performance*100, 4)
+                   .arg(oos.maxDrawDownRate*100, 4)
+                   .arg(oos.succeedTrades)
+                   .arg(oos.failedTrades)
+                   .arg(oos.totalTrades);
+
+        sumIs += bestIs.performance;
+        sumOos += oos.performance;
+        sumSqrOos += oos.performance * oos.performance;
+
+        isDuration += Validation::inSampleDuration(fold);
+        oosDuration += fold.outOfSampleTo - fold.outOfSampleFrom;
+    }
+
+    o3d::String filename = config->getStrategyIdentifier() + "-validation.csv";
+
+    o3d::File file(config->getReportsPath().getFullPathName(), filename);
+    o3d::OutStream *os = o3d::FileManager::instance()->openOutStream(file.getFullFileName(), o3d::FileOutStream::CREATE);
+
+    os->writeString(content);
+    o3d::deletePtr(os);
+
+    // aggregated results
+    o3d::Int32 n = static_cast<o3d::Int32>(m_validation->folds().size());
+    if (n <= 0) {
+        return;
+    }
+
+    o3d::Double meanOos = sumOos / n;
+    o3d::Double stdDevOos = std::sqrt(o3d::max(0.0, sumSqrOos / n - meanOos * meanOos));
+
+    // ratio of the out-of-sample to the in-sample performance per unit of time
+    o3d::Double efficiency = 0.0;
+    if (sumIs > 0.0 && isDuration > 0.0 && oosDuration > 0.0) {
+        efficiency = (sumOos / oosDuration) / (sumIs / isDuration);
+    }
+
+    size_t bestCv = static_cast<size_t>(std::max_element(cvScores.begin(), cvScores.end()) - cvScores.begin());
+
+    INFO("results", o3d::String("Validation results of {0} folds written to {1}").arg(n).arg(file.getFullFileName()));
+    INFO("results", o3d::String("Out-of-sample performance {0}% mean {1}% std-dev {2}% efficiency {3}")
+         .arg(sumOos*100, 2).arg(meanOos*100, 2).arg(stdDevOos*100, 2).arg(efficiency, 2));
+    INFO("results", o3d::String("Best cross-validated candidate {0} mean out-of-sample performance {1}%")
+         .arg(m_candidates[bestCv]->id).arg(cvScores[bestCv] / n * 100, 2));
 }
 
 void Optimization::start()
 {
+    if (m_logger) {
+        m_logger->start();
+    }
+
      // create a decicaded thread for the timecounter
     if (!m_running) {
         m_running = true;
@@ -176,6 +1161,10 @@ void Optimization::stop()
         m_running = false;
         m_thread.waitFinish();
     }
+
+    if (m_logger) {
+        m_logger->stop();
+    }
 }
 
 void Optimization::sync()
@@ -192,7 +1181,9 @@ o3d::Double Optimization::timestamp() const
 
 o3d::Double Optimization::progress() const
 {
-    return o3d::clamp((m_curTs - m_fromTs) / (m_toTs - m_fromTs) * 100.0, 0.0, 100.0);
+    // one pass over the period per iteration
+    o3d::Double pass = o3d::clamp((m_curTs - m_fromTs) / (m_toTs - m_fromTs), 0.0, 1.0);
+    return o3d::clamp((m_iteration + pass) / m_numIterations * 100.0, 0.0, 100.0);
 }
 
 const TraderProxy *Optimization::traderProxy() const
@@ -207,24 +1198,26 @@ TraderProxy *Optimization::traderProxy()
 
 void Optimization::setPaperMode(o3d::Bool)
 {
-    // not available in backtest
+    // not available in optimization
 }
 
 void Optimization::onTick(const o3d::CString &, const Tick &)
 {
-    // nothing in backtesting
+    // nothing in optimization
 }
 
 void Optimization::onOhlc(const o3d::CString &, Ohlc::Type, const Ohlc &)
 {
-    // nothing in backtesting
+    // nothing in optimization
 }
 
 Market *Optimization::market(const o3d::CString &marketId)
 {
-    auto it = m_optimizers.find(marketId);
-    if (it != m_optimizers.end()) {
-        return it->second.strategy->market();
+    // the reference market, each candidate having its own instance
+    for (MarketFeed *feed : m_feeds) {
+        if (feed->marketId == marketId) {
+            return feed->market;
+        }
     }
 
     return nullptr;
@@ -232,9 +1225,10 @@ Market *Optimization::market(const o3d::CString &marketId)
 
 const Market *Optimization::market(const o3d::CString &marketId) const
 {
-    auto cit = m_optimizers.find(marketId);
-    if (cit != m_optimizers.cend()) {
-        return cit->second.strategy->market();
+    for (const MarketFeed *feed : m_feeds) {
+        if (feed->marketId == marketId) {
+            return feed->market;
+        }
     }
 
     return nullptr;
@@ -242,9 +1236,11 @@ const Market *Optimization::market(const o3d::CString &marketId) const
 
 Strategy *Optimization::strategy(const o3d::CString &marketId)
 {
-    auto it = m_optimizers.find(marketId);
-    if (it != m_optimizers.end()) {
-        return it->second.strategy;
+    // strategy of the first candidate of the current pass
+    for (size_t i = 0; i < m_feeds.size(); ++i) {
+        if (m_feeds[i]->marketId == marketId && !m_batch.empty() && i < m_batch[0]->strategies.size()) {
+            return m_batch[0]->strategies[i];
+        }
     }
 
     return nullptr;
@@ -252,9 +1248,10 @@ Strategy *Optimization::strategy(const o3d::CString &marketId)
 
 const Strategy *Optimization::strategy(const o3d::CString &marketId) const
 {
-    auto cit = m_optimizers.find(marketId);
-    if (cit != m_optimizers.cend()) {
-        return cit->second.strategy;
+    for (size_t i = 0; i < m_feeds.size(); ++i) {
+        if (m_feeds[i]->marketId == marketId && !m_batch.empty() && i < m_batch[0]->strategies.size()) {
+            return m_batch[0]->strategies[i];
+        }
     }
 
     return nullptr;
@@ -270,130 +1267,35 @@ Cache *Optimization::cache()
     return m_cache;
 }
 
+AsyncLogger *Optimization::logger()
+{
+    return m_logger;
+}
+
 void Optimization::log(const o3d::String &unit, const o3d::String &marketId, const o3d::String &channel,
                        const o3d::String &msg, o3d::System::MessageLevel type)
 {
     // @todo throught the monitor send a log message
-    // m_monitor.log(timestamp(), timeframe, marketId, channel, msg);                        
-    o3d::DateTime dt;
-    dt.fromTime(timestamp(), true);
+    // m_monitor.log(timestamp(), unit, marketId, channel, msg);
 
-    if (unit.isEmpty()) {
-        m_displayer->display(channel, o3d::String("[{0}] <{2}> : {3}").arg(dt.buildString("%Y-%m-%d %H:%M:%S"))
-                                          .arg(marketId).arg(msg), type);
-    } else {
-        m_displayer->display(channel, o3d::String("[{0}] @{1} <{2}> : {3}").arg(dt.buildString("%Y-%m-%d %H:%M:%S"))
-                                          .arg(unit).arg(marketId).arg(msg), type);
+    // deferred datetime formatting and display into the logger thread
+    if (m_logger) {
+        m_logger->logText(unit, marketId, channel, msg, type);
     }
 }
 
 o3d::Int32 Optimization::run(void *)
 {
-    Strategy *strategy = nullptr;
-    Optimizer *optimizer = nullptr;
-    Market *market = nullptr;
-    o3d::Int32 n = 0;
-    o3d::Double lastTimestamp = 0.0;
-    o3d::Double maxDeltaTime = 0.0;
-    // DataArray ticks;
-
-    if (m_optimizers.size() <= 1) {
-        while (m_running) {
-            if (m_curTs > m_toTs) {
-                break;
-            }
-
-            for (auto pair : m_optimizers) {
-                strategy = pair.second.strategy;
-                optimizer = pair.second.optimizer;
-                market = pair.second.market;
+    while (m_running && !m_batch.empty()) {
+        runPass();
+        endPass();
 
-                if (pair.second.tickStream) {
-                    // no need to acquire/release because we are always synchronous in backtesting
-                    n = pair.second.tickStream->fillNext(m_curTs, market->getTickBuffer());
-                    // n = pair.second.tickStream->fillNext(m_curTs, ticks);
-                }
-
-                if (n <= 0) {
-                    // no ticks for this run
-                    continue;
-                }
-
-                lastTimestamp = market->getTickBuffer().last().timestamp();
-
-                // inject the tick to the strategy
-                strategy->onTickUpdate(m_curTs, market->getTickBuffer());
-
-                // consume them
-                market->setLastTick(market->getTickBuffer().last());
-                market->getTickBuffer().forceSize(0);
-                // ticks.destroy();
-
-                // process one strategy iteration
-                strategy->process(lastTimestamp/*m_curTs*/);
-
-                // from strategy trades, once a trade is active follow and compare with the bests entry/exit prices
-                // optimizer->optimize();
-
-                if (m_curTs - lastTimestamp > maxDeltaTime) {
-                    maxDeltaTime = m_curTs - lastTimestamp;
-                    DBG("general", o3d::String("Higher time deviation : {0}").arg(maxDeltaTime));
-                }
-            }
-
-            m_curTs += m_timestep;
-
-            // yield
-            //o3d::System::waitMs(0);
+        if (++m_iteration >= m_numIterations || !m_running) {
+            break;
         }
-    } else {
-        // using PoolWorker and synchronization
-        PoolWorker::CountDown countDown;
-
-        while (m_running) {
-            if (m_curTs > m_toTs) {
-                break;
-            }
-
-            // reset the countdown
-            countDown.count = static_cast<o3d::Int32>(m_optimizers.size());
-
-            for (auto pair : m_optimizers) {
-                strategy = pair.second.strategy;
-                optimizer = pair.second.optimizer;
-                market = pair.second.market;
-
-                if (pair.second.tickStream) {
-                    // no need to acquire/release because we are always synchronous in backtesting
-                    n = pair.second.tickStream->fillNext(m_curTs, market->getTickBuffer());
-                    // n = pair.second.tickStream->fillNext(m_curTs, ticks);
-                }
-
-                if (n <= 0) {
-                    // no ticks for this run
-                    continue;
-                }
-
-                // inject the tick to the strategy
-                strategy->onTickUpdate(m_curTs, market->getTickBuffer());
 
-                // consume them
-                market->setLastTick(market->getTickBuffer().last());
-                market->getTickBuffer().forceSize(0);
-                // ticks.destroy();
-
-                // process one strategy iteration
-                // m_poolWorker->addJob(strategy, m_curTs, &countDown);
-            }
-
-            // sync before continue
-            countDown.wait();
-
-            m_curTs += m_timestep;
-
-            // yield
-            //o3d::System::waitMs(0);
-        }
+        nextBatch();
+        prepareBatch();
     }
 
     m_running = false;
@@ -5,29 +5,50 @@
  * @date 2019-03-28
  */
 
-#ifndef SIIS_OPTIMIZER_H
-#define SIIS_OPTIMIZER_H
+#ifndef SIIS_OPTIMIZATION_H
+#define SIIS_OPTIMIZATION_H
 
 #include "siis/handler.h"
+#include "siis/learning/pruning.h"
+#include "siis/statistics/statistics.h"
 
 #include <o3d/core/configfile.h>
 #include <o3d/core/mutex.h>
 #include <o3d/core/thread.h>
 #include <o3d/core/stringmap.h>
 
+#include <json/value.h>
+
+#include <vector>
+
 namespace siis {
 
 class Displayer;
 class Monitor;
 class Database;
-class Optimizer;
 class Strategy;
 class TraderProxy;
+class Validation;
+class Optimizer;
+class ResultStore;
+class MarketConfig;
 
 /**
- * @brief SiiS strategy machine learning process handler.
+ * @brief SiiS strategy parameters optimization process handler.
  * @author Frederic Scherma
  * @date 2019-03-28
+ * Run in a single process every candidate of the parameter space of the optimize mode, over the
+ * same period. The market data are decoded only once per timestep and per market, then shared
+ * by the candidates, processed in parallel on the pool of workers.
+ * Each candidate is the handler of its strategies, with its own local connector and virtual account.
+ * The market data are prepared once per market, then the prepared state is copied into each candidate.
+ * With an iterative method, a pass is done per batch of candidates given by the optimizer, and the
+ * clearly losing candidates can be stopped at some checkpoints of the period.
+ * With pruning rules, any candidate violating them is stopped on the fly, during any pass.
+ * With a validation, the folds are windows over the results of the whole period.
+ * With a result store, each candidate is appended to it as soon as terminated, optionally with its
+ * equity curve, so the results of a long or interrupted campaign are not only kept in memory.
+ * The passes could be distributed over many processes, see Coordinator and DistributedWorker.
  */
 class Optimization : public Handler, public o3d::Runnable
 {
@@ -44,6 +65,8 @@ public:
             Database *database,
             Cache *cache) override;
 
+    virtual o3d::Bool isBacktesting() const override;
+
     virtual void terminate(Config *config) override;
 
     virtual void start() override;
@@ -71,11 +94,13 @@ public:
     virtual Database* database() override;
     virtual Cache* cache() override;
 
+    virtual AsyncLogger* logger() override;
+
     virtual void log(const o3d::String &unit, const o3d::String &marketId,
                      const o3d::String &channel, const o3d::String &msg,
                      o3d::System::MessageLevel type = o3d::System::MSG_INFO) override;
 
-private:
+protected:
 
     virtual o3d::Int32 run(void *) override;
 
@@ -89,16 +114,196 @@ private:
     o3d::Double m_curTs;
     o3d::Double m_timestep;
 
-    struct OptimizerElt
+    /**
+     * @brief Market data of a market for the current timestep, shared by every candidates.
+     */
+    struct MarketFeed
+    {
+        o3d::CString marketId;
+        class Market *market;            //!< reference market, for the market info only
+        o3d::Int32 marketTradeType;
+
+        class ReplayBus *replayBus;      //!< single reader of the market data, during a pass
+        const class ReplayChunk *chunk;  //!< chunk of the current timestep, released by each candidate
+
+        MarketFeed() : market(nullptr), marketTradeType(-1), replayBus(nullptr), chunk(nullptr) {}
+    };
+
+    /**
+     * @brief One set of parameters, with a strategy and a market per configured market.
+     * Handler of its strategies, forwarding to the optimization except for the trader proxy, then
+     * the orders, positions and account of a candidate are never mixed with the other ones.
+     */
+    class Candidate : public Handler, public o3d::Runnable
     {
-        class Market *market;
-        class TickStream *tickStream;
-        class Strategy *strategy;
-        class Optimizer *optimizer;
-        class OhlcStream *ohlcStream;
+    public:
+
+        Candidate(Optimization *optimization, o3d::Int32 id, const Json::Value &parameters);
+        virtual ~Candidate() override;
+
+        o3d::Int32 id;
+        o3d::Int32 iteration;
+        Json::Value parameters;
+        std::vector<o3d::Double> point;     //!< optimizer point, empty if not iterative
+
+        std::vector<Strategy*> strategies;  //!< indexed as the feeds
+        std::vector<Market*> markets;       //!< indexed as the feeds
+
+        o3d::Bool stopped;                  //!< early stopped or pruned, no longer processed
+        o3d::Bool terminated;
+        o3d::Double score;                  //!< performance at the end of the pass or when stopped
+
+        Pruning::State pruning;
+
+        std::vector<o3d::Double> equity;    //!< sampled performance, if the equity curve is stored
+
+        std::vector<Statistics> statistics; //!< of the strategies, retained once released
+
+        //! Realized plus unrealized performance of the strategies.
+        o3d::Double performance() const;
+
+        //! Closed trades of the strategies.
+        o3d::Int32 numTrades() const;
+
+        //! Retain the statistics of the terminated strategies, then delete them, their markets and the connector.
+        void release();
+
+        //! Merged statistics of the strategies, once released.
+        GlobalStatistics globalStatistics() const;
+
+        //! Local connector of the virtual account of the candidate.
+        class Connector* connector() { return m_connector; }
+
+        //! Process one timestep from the shared feeds, then update the virtual account.
+        virtual o3d::Int32 run(void *) override;
+
+        virtual void init(
+                Displayer *displayer,
+                Config *config,
+                StrategyCollection *collection,
+                PoolWorker *poolWorker,
+                Database *database,
+                Cache *cache) override;
+
+        virtual o3d::Bool isBacktesting() const override;
+
+        virtual void terminate(Config *config) override;
+
+        virtual void start() override;
+        virtual void stop() override;
+
+        virtual void sync() override;
+
+        virtual o3d::Double timestamp() const override;
+        virtual o3d::Double progress() const override;
+
+        virtual const TraderProxy* traderProxy() const override;
+        virtual TraderProxy* traderProxy() override;
+
+        virtual void setPaperMode(o3d::Bool active) override;
+
+        virtual void onTick(const o3d::CString &marketId, const Tick &tick) override;
+        virtual void onOhlc(const o3d::CString &marketId, Ohlc::Type ohlcType, const Ohlc &ohlc) override;
+
+        virtual Market* market(const o3d::CString &marketId) override;
+        virtual const Market* market(const o3d::CString &marketId) const override;
+
+        virtual Strategy* strategy(const o3d::CString &marketId) override;
+        virtual const Strategy* strategy(const o3d::CString &marketId) const override;
+
+        virtual Database* database() override;
+        virtual Cache* cache() override;
+
+        virtual AsyncLogger* logger() override;
+
+        virtual void log(const o3d::String &unit, const o3d::String &marketId,
+                         const o3d::String &channel, const o3d::String &msg,
+                         o3d::System::MessageLevel type = o3d::System::MSG_INFO) override;
+
+    private:
+
+        Optimization *m_optimization;
+
+        class Connector *m_connector;
+        TraderProxy *m_traderProxy;
     };
 
-    o3d::StringMap<OptimizerElt> m_optimizers;
+    std::vector<MarketFeed*> m_feeds;
+    std::vector<Candidate*> m_candidates;  //!< of every iterations, released at the end of their pass
+    std::vector<Candidate*> m_batch;       //!< of the current iteration
+
+    o3d::Int32 m_iteration;
+    o3d::Int32 m_numIterations;
+
+    Config *m_config;
+    StrategyCollection *m_collection;
+
+    Optimizer *m_optimizer;   //!< null if not iterative
+
+    Pruning *m_pruning;       //!< null if no pruning rules
+    std::vector<std::vector<o3d::Double>> m_checkpointPerformances;  //!< per pruning checkpoint, of every iterations
+
+    ResultStore *m_resultStore;       //!< null if the results are not stored
+    o3d::Double m_equityTimeframe;    //!< 0 if the equity curve is not stored
+    o3d::Double m_nextEquityTs;
+
+    //! Logger, connector and references, common to the distributed worker.
+    void initHandler(Displayer *displayer,
+                     Config *config,
+                     StrategyCollection *collection,
+                     PoolWorker *poolWorker,
+                     Database *database,
+                     Cache *cache);
+
+    //! Shared feed of a configured market, with the market info from the database.
+    MarketFeed* createFeed(const MarketConfig *mc);
+
+    //! Called after each timestep of a pass, from the handler thread.
+    virtual void onPassStep();
+
+    //! Write the reports of the candidates at termination.
+    virtual void writeReports(Config *config);
+
+    //! Create the candidates of the current iteration.
+    void nextBatch();
+
+    /**
+     * @brief prepareBatch Build, prepare and finalize the strategies of the batch, and open the replay of the feeds.
+     * The market data are prepared for the first candidate of each market, whose state is copied into the other
+     * candidates. A candidate whose analysers differ (or a strategy without snapshot support) is prepared by its own.
+     */
+    void prepareBatch();
+
+    //! Process the whole period for the candidates of the batch.
+    void runPass();
+
+    //! Terminate the strategies of the batch, close the replay, and give the scores to the optimizer.
+    void endPass();
+
+    /**
+     * @brief stopLosingCandidates Early stop the clearly losing candidates of the batch.
+     * @return Number of newly stopped candidates.
+     */
+    o3d::Int32 stopLosingCandidates();
+
+    /**
+     * @brief pruneCandidates Stop the candidates of the batch violating the pruning rules.
+     * @return Number of newly pruned candidates.
+     */
+    o3d::Int32 pruneCandidates();
+
+    //! Create the result store and write its schema.
+    void createResultStore(Config *config);
+
+    //! Append a terminated candidate to the result store, then release its equity curve.
+    void storeCandidate(Candidate *candidate);
+
+    void writeResults(Config *config);
+
+    /**
+     * @brief writeValidation Select per fold the best in-sample candidate and report its out-of-sample results.
+     */
+    void writeValidation(Config *config);
 
     Displayer *m_displayer;
 
@@ -111,8 +316,12 @@ private:
 
     Database *m_database;
     Cache *m_cache;
+
+    AsyncLogger *m_logger;
+
+    Validation *m_validation;   //!< null if no walk-forward or cross-validation
 };
 
 } // namespace siis
 
-#endif // SIIS_OPTIMIZER_H
+#endif // SIIS_OPTIMIZATION_H
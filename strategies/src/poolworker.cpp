@@ -84,6 +84,45 @@ void PoolWorker::addJob(Strategy *strategy, o3d::Double timestamp, CountDown *co
     m_mutex.unlock();
 }
 
+void PoolWorker::addPrepareJob(Strategy *strategy, Connector *connector, Database *database,
+                               o3d::Double fromTs, o3d::Double toTs, CountDown *countDown)
+{
+    O3D_ASSERT(strategy != nullptr);
+    O3D_ASSERT(database != nullptr);
+
+    Job *job = new Job();
+
+    job->type = Job::PREPARE;
+    job->strategy = strategy;
+    job->timestamp = fromTs;
+    job->toTimestamp = toTs;
+    job->connector = connector;
+    job->database = database;
+    job->countDown = countDown;
+
+    m_mutex.lock();
+    m_jobs.push_back(job);
+    m_mutex.unlock();
+}
+
+void PoolWorker::addRunnableJob(o3d::Runnable *runnable, void *data, CountDown *countDown)
+{
+    O3D_ASSERT(runnable != nullptr);
+
+    Job *job = new Job();
+
+    job->type = Job::RUNNABLE;
+    job->strategy = nullptr;
+    job->timestamp = 0.0;
+    job->runnable = runnable;
+    job->data = data;
+    job->countDown = countDown;
+
+    m_mutex.lock();
+    m_jobs.push_back(job);
+    m_mutex.unlock();
+}
+
 void PoolWorker::ping()
 {
     if (m_workers != nullptr) {
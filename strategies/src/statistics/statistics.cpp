@@ -7,6 +7,8 @@
 
 #include "siis/statistics/statistics.h"
 #include "siis/trade/trade.h"
+#include "siis/constants.h"
+#include "siis/utils/common.h"
 
 #include <o3d/core/math.h>
 
@@ -14,69 +16,122 @@
 
 using namespace siis;
 
-o3d::Double average(const std::vector<o3d::Double> &samples) {
-    o3d::Double avg = 0.0;
+Sampler::Sampler(const o3d::String &_name, o3d::Bool _keepSamples) :
+    name(_name),
+    keepSamples(_keepSamples)
+{
+}
 
-    if (samples.size() > 0) {
-        for (o3d::Double x : samples) {
-            avg += x;
-        }
+void Sampler::addSample(o3d::Double value)
+{
+    if (keepSamples) {
+        samples.push_back(value);
+    }
 
-        avg /= samples.size();
+    cumulated += value;
+
+    if (n > 0) {
+        maxValue = o3d::max(maxValue, value);
+        minValue = o3d::min(minValue, value);
+    } else {
+        minValue = maxValue = value;
     }
 
-    return avg;
+    // Welford's online mean and variance
+    ++n;
+
+    o3d::Double delta = value - avg;
+    avg += delta / n;
+    m2 += delta * (value - avg);
 }
 
-o3d::Double stdDeviation(const std::vector<o3d::Double> &samples) {
-    if (samples.size() < 2) {
-        return 0.0;
+void Sampler::merge(const Sampler &other)
+{
+    if (other.n == 0) {
+        return;
+    }
+
+    if (keepSamples) {
+        samples.insert(samples.end(), other.samples.begin(), other.samples.end());
     }
 
-    o3d::Double sqrSum = 0.0;
-    o3d::Double avg = average(samples);
+    cumulated += other.cumulated;
+
+    if (n == 0) {
+        minValue = other.minValue;
+        maxValue = other.maxValue;
+        avg = other.avg;
+        m2 = other.m2;
+        n = other.n;
 
-    for (o3d::Double x : samples) {
-        sqrSum += o3d::sqr(x - avg);
+        return;
     }
 
-    o3d::Double variance = sqrSum / (samples.size() - 1);  // n - 1 degree of freedom
-    return o3d::Math::sqrt(variance);
+    minValue = o3d::min(minValue, other.minValue);
+    maxValue = o3d::max(maxValue, other.maxValue);
+
+    o3d::Int32 total = n + other.n;
+    o3d::Double delta = other.avg - avg;
+
+    avg += delta * other.n / total;
+    m2 += other.m2 + delta * delta * (static_cast<o3d::Double>(n) * other.n / total);
+    n = total;
 }
 
-Sampler::Sampler(const o3d::String &_name) :
-    name(_name)
+o3d::Int32 Sampler::count() const
 {
+    return n;
 }
 
-void Sampler::addSample(o3d::Double value)
+Sampler& Sampler::finalize()
 {
-    samples.push_back(value);
-    cumulated += value;
+    // n - 1 degree of freedom
+    stdDev = n > 1 ? o3d::Math::sqrt(m2 / (n - 1)) : 0.0;
 
-    if (samples.size() > 0) {
-        maxValue = o3d::max(maxValue, value);
-        minValue = o3d::min(minValue, value);
-    } else {
-        minValue = maxValue = value;
-    }
+    return *this;
 }
 
-o3d::Int32 Sampler::count() const
+PercentSampler& PercentSampler::finalize()
 {
-    return static_cast<o3d::Int32>(samples.size());
+    Sampler::finalize();
+    return *this;
 }
 
-Sampler& Sampler::finalize()
+PeriodSampler::PeriodSampler(const o3d::String &_name, o3d::Double _period) :
+    Sampler(_name),
+    period(_period)
 {
-    avg = average(samples);
-    stdDev = stdDeviation(samples);
+}
 
-    return *this;
+void PeriodSampler::advance(o3d::Double timestamp)
+{
+    o3d::Double bt = baseTime(timestamp, period);
+
+    if (periodTimestamp <= 0.0) {
+        periodTimestamp = bt;
+        return;
+    }
+
+    o3d::Int32 elapsed = o3d::min(999, static_cast<o3d::Int32>((bt - periodTimestamp) / period));
+    if (elapsed > 0) {
+        // the completed period, then the periods without value
+        while (elapsed-- > 0) {
+            addSample(current);
+            current = 0.0;
+        }
+
+        periodTimestamp = bt;
+    }
 }
 
-PercentSampler& PercentSampler::finalize()
+PeriodSampler& PeriodSampler::finalize()
 {
+    // the current period, at least one sample
+    addSample(current);
+
+    current = 0.0;
+    periodTimestamp = 0.0;
+
     Sampler::finalize();
     return *this;
 }
@@ -97,8 +152,8 @@ void CurrencyStatToken::reset()
     samplers.clear();
 }
 
-PercentSampler::PercentSampler(const o3d::String &_name) :
-    Sampler(_name)
+PercentSampler::PercentSampler(const o3d::String &_name, o3d::Bool _keepSamples) :
+    Sampler(_name, _keepSamples)
 {
 }
 
@@ -108,6 +163,184 @@ void PercentStatToken::reset()
     samplers.clear();
 }
 
+TradesAccumulator::TradesAccumulator() :
+    anyTradePnl("trade-pnl"),
+    anyTradePnlPct("trade-pnl"),
+    winningTradePnl("winning-pnl"),
+    winningTradePnlPct("winning-pnl"),
+    loosingTradePnl("loosing-pnl"),
+    loosingTradePnlPct("loosing-pnl"),
+    mfePct("mfe"),
+    maePct("mae"),
+    etdPct("etd"),
+    eefPct("entry-efficiency"),
+    xefPct("exit-efficiency"),
+    tefPct("total-efficiency"),
+    timeInMarket("time-in-market"),
+    profitPerMonthPct("profit-per-month", TF_MONTH),
+    profitPerMonth("profit-per-month", TF_MONTH)
+{
+}
+
+void TradesAccumulator::addTrade(const TradeResults &trade)
+{
+    // cumulative PNL
+    anyTradePnlPct.addSample(trade.profitLossPct);
+    anyTradePnl.addSample(trade.profitLoss);
+
+    // but this cumulative is used for max time to recover
+    cumPnlPct += trade.profitLossPct;
+    cumPnl += trade.profitLoss;
+
+    // max time to recover (by percentage)
+    if (cumPnlPct >= maxPnlPct) {
+        maxPnlPct = cumPnlPct;
+
+        if (maxPnlPctTs > 0) {
+            maxTimeToRecoverPct = o3d::max(maxTimeToRecoverPct, trade.exitTimestamp - maxPnlPctTs);
+        }
+
+        maxPnlPctTs = trade.exitTimestamp;
+    }
+
+    // max time to recover (by currency)
+    if (cumPnl >= maxPnl) {
+        maxPnl = cumPnl;
+
+        if (maxPnlTs > 0) {
+            maxTimeToRecover = o3d::max(maxTimeToRecover, trade.exitTimestamp - maxPnlTs);
+        }
+
+        maxPnlTs = trade.exitTimestamp;
+    }
+
+    // longest flat period
+    if (numTrades > 0) {
+        longestFlatPeriod = o3d::max(longestFlatPeriod, trade.entryTimestamp - lastExitTs);
+    }
+
+    // new monthly sample
+    profitPerMonthPct.advance(trade.entryTimestamp);
+    profitPerMonth.advance(trade.entryTimestamp);
+
+    // average time in market
+    timeInMarket.addSample(trade.exitTimestamp - trade.entryTimestamp);
+
+    //  for avg num trades per day
+    if (firstTradeTs == 0.0) {
+        firstTradeTs = trade.entryTimestamp;
+    }
+
+    lastTradeTs = trade.entryTimestamp;
+
+    // winning, loosing trade profit/loss
+    if (trade.profitLossPct > 0.0) {
+        winningTradePnlPct.addSample(trade.profitLossPct);
+    } else if (trade.profitLossPct < 0.0) {
+        loosingTradePnlPct.addSample(trade.profitLossPct);
+    }
+
+    if (trade.profitLoss > 0.0) {
+        winningTradePnl.addSample(trade.profitLoss);
+    } else if (trade.profitLoss < 0.0) {
+        loosingTradePnl.addSample(trade.profitLoss);
+    }
+
+    // cumulative per month
+    profitPerMonthPct.accumulate(trade.profitLossPct);
+    profitPerMonth.accumulate(trade.profitLoss);
+
+    // draw-downs square samples for Ulcer ratio (relative or absolute percentage)
+    // sumDrawDownsSqrPct += o3d::sqr((1.0 + cumPnlPct) / (1.0 + maxPnlPct) - 1.0);
+    sumDrawDownsSqrPct += o3d::sqr(cumPnlPct - maxPnlPct);
+    sumDrawDownsSqr += o3d::sqr(cumPnl - maxPnl);
+
+    // MFE (positive), MAE (negative), ETD (negative) (gross value, no trade fees)
+    mfePct.addSample(trade.direction * (trade.bestPrice - trade.entryPrice) / trade.entryPrice);
+    maePct.addSample(trade.direction * (trade.worstPrice - trade.entryPrice) / trade.entryPrice);
+    etdPct.addSample(trade.direction * (trade.exitPrice - trade.bestPrice) / trade.bestPrice);
+
+    // efficiency (-1..1)
+    eefPct.addSample((trade.bestPrice - trade.entryPrice) / (trade.bestPrice - trade.worstPrice));
+    xefPct.addSample((trade.exitPrice - trade.worstPrice) / (trade.bestPrice - trade.worstPrice));
+    tefPct.addSample((trade.exitPrice - trade.entryPrice) / (trade.bestPrice - trade.worstPrice));
+
+    lastExitTs = trade.exitTimestamp;
+    ++numTrades;
+}
+
+void TradesAccumulator::merge(const TradesAccumulator &other)
+{
+    if (other.numTrades == 0) {
+        return;
+    }
+
+    if (numTrades == 0) {
+        // exact
+        *this = other;
+        return;
+    }
+
+    anyTradePnl.merge(other.anyTradePnl);
+    anyTradePnlPct.merge(other.anyTradePnlPct);
+    winningTradePnl.merge(other.winningTradePnl);
+    winningTradePnlPct.merge(other.winningTradePnlPct);
+    loosingTradePnl.merge(other.loosingTradePnl);
+    loosingTradePnlPct.merge(other.loosingTradePnlPct);
+
+    mfePct.merge(other.mfePct);
+    maePct.merge(other.maePct);
+    etdPct.merge(other.etdPct);
+
+    eefPct.merge(other.eefPct);
+    xefPct.merge(other.xefPct);
+    tefPct.merge(other.tefPct);
+
+    timeInMarket.merge(other.timeInMarket);
+
+    // approximated by the months of each market
+    profitPerMonthPct.merge(other.profitPerMonthPct);
+    profitPerMonthPct.accumulate(other.profitPerMonthPct.current);
+    profitPerMonth.merge(other.profitPerMonth);
+    profitPerMonth.accumulate(other.profitPerMonth.current);
+
+    cumPnlPct += other.cumPnlPct;
+    cumPnl += other.cumPnl;
+
+    maxPnlPct = o3d::max(maxPnlPct, other.maxPnlPct);
+    maxPnl = o3d::max(maxPnl, other.maxPnl);
+
+    maxTimeToRecoverPct = o3d::max(maxTimeToRecoverPct, other.maxTimeToRecoverPct);
+    maxTimeToRecover = o3d::max(maxTimeToRecover, other.maxTimeToRecover);
+
+    sumDrawDownsSqrPct += other.sumDrawDownsSqrPct;
+    sumDrawDownsSqr += other.sumDrawDownsSqr;
+
+    longestFlatPeriod = o3d::max(longestFlatPeriod, other.longestFlatPeriod);
+
+    firstTradeTs = o3d::min(firstTradeTs, other.firstTradeTs);
+    lastTradeTs = o3d::max(lastTradeTs, other.lastTradeTs);
+    lastExitTs = o3d::max(lastExitTs, other.lastExitTs);
+
+    numTrades += other.numTrades;
+}
+
+AccountAccumulator::AccountAccumulator() :
+    drawDownPerMonthPct("draw-down-per-month", TF_MONTH),
+    drawDownPerMonth("draw-down-per-month", TF_MONTH)
+{
+}
+
+void AccountAccumulator::addSample(const AccountSample &sample)
+{
+    // a positive value, the highest of the month
+    drawDownPerMonthPct.advance(sample.timestamp);
+    drawDownPerMonthPct.peak(sample.drawDownRate);
+
+    drawDownPerMonth.advance(sample.timestamp);
+    drawDownPerMonth.peak(sample.drawDown);
+}
+
 void Statistics::addTrade(const Trade *trade)
 {
     if (trade == nullptr) {
@@ -135,7 +368,11 @@ void Statistics::addTrade(const Trade *trade)
     results.profitLossPct = trade->profitLossRate();
     results.profitLoss = trade->stats().unrealizedProfitLoss;
 
-    tradesResults.push_back(results);
+    accumulator.addTrade(results);
+
+    if (detailed) {
+        tradesResults.push_back(results);
+    }
 }
 
 void GlobalStatistics::reset()
@@ -164,8 +401,11 @@ void GlobalStatistics::reset()
     stopLossInGain = 0;
     takeProfitInGain = 0;
 
+    detailed = true;
     tradesResults.clear();
 
+    accumulator = TradesAccumulator();
+
     longestFlatPeriod = 0.0;
     avgTimeInMarket = 0.0;
 
@@ -204,7 +444,13 @@ void GlobalStatistics::add(const Statistics &stats)
     stopLossInGain += stats.stopLossInGain;
     takeProfitInGain += stats.takeProfitInGain;
 
-    tradesResults.insert(tradesResults.end(), stats.tradesResults.begin(), stats.tradesResults.end());
+    if (stats.detailed) {
+        tradesResults.insert(tradesResults.end(), stats.tradesResults.begin(), stats.tradesResults.end());
+    } else {
+        detailed = false;
+    }
+
+    accumulator.merge(stats.accumulator);
 }
 
 // Comparison operator for TradeResults
@@ -217,234 +463,98 @@ void GlobalStatistics::computeStats(const AccountStatistics &accountStats)
 {
     const o3d::Double RISK_FREE_RATE_OF_RETURN = 0.0;
 
-    std::vector<o3d::Double> timeInMarketSamples;
-
-    std::vector<o3d::Double> profitPerMonthPct {0.0};
-    std::vector<o3d::Double> profitPerMonth {0.0};
-    std::vector<o3d::Double> drawDownPerMonthPct {0.0};
-    std::vector<o3d::Double> drawDownPerMonth {0.0};
-
-    std::vector<o3d::Double> drawDownsSqrPct;
-    std::vector<o3d::Double> drawDownsSqr;
-
-    o3d::Double firstTradeTs = 0.0;
-    o3d::Double lastTradeTs = 0.0;
-
-    Sampler anyTradePnl("trade-pnl");
-    PercentSampler anyTradePnlPct("trade-pnl");
-
-    Sampler winningTradePnl("winning-pnl");
-    PercentSampler winningTradePnlPct("winning-pnl");
-
-    Sampler loosingTradePnl("loosing-pnl");
-    PercentSampler loosingTradePnlPct("loosing-pnl");
-
-    PercentSampler mfePct("mfe");
-    PercentSampler maePct("mae");
-    PercentSampler etdPct("etd");
+    TradesAccumulator trades;
 
-    PercentSampler eefPct("entry-efficiency");
-    PercentSampler xefPct("exit-efficiency");
-    PercentSampler tefPct("total-efficiency");
+    if (detailed) {
+        // sort trades results by exit timestamp, and replay them for the exact values
+        std::sort(tradesResults.begin(), tradesResults.end(), &compare);
 
-    o3d::Double cumPnlPct = 0.0;
-    o3d::Double cumPnl = 0.0;
-
-    o3d::Double maxPnlPct = 0.0;
-    o3d::Double maxPnl = 0.0;
-
-    o3d::Double maxPnlPctTs = 0.0;
-    o3d::Double maxPnlTs = 0.0;
-
-    std::vector<TradeResults>::iterator prevTradeIt = tradesResults.end();
-
-    // sort trades results by exit timestamp
-    std::sort(tradesResults.begin(), tradesResults.end(), &compare);
-
-    o3d::Int32 numTrades = static_cast<o3d::Int32>(tradesResults.size());
-
-    for (auto it = tradesResults.begin(); it != tradesResults.end(); ++it) {
-        const TradeResults &trade = *it;
-
-        // cumulative PNL
-        anyTradePnlPct.addSample(trade.profitLossPct);
-        anyTradePnl.addSample(trade.profitLoss);
-
-        // but this cumulative is used for max time to recover
-        cumPnlPct += trade.profitLossPct;
-        cumPnl += trade.profitLoss;
-
-        // max time to recover (by percentage)
-        if (cumPnlPct >= maxPnlPct) {
-            maxPnlPct = cumPnlPct;
-
-            if (maxPnlPctTs > 0) {
-                percent.maxTimeToRecover = o3d::max(percent.maxTimeToRecover, trade.exitTimestamp - maxPnlPctTs);
-            }
-
-            maxPnlPctTs = trade.exitTimestamp;
-        }
-
-        // max time to recover (by currency)
-        if (cumPnl >= maxPnl) {
-            maxPnl = cumPnl;
-
-            if (maxPnlTs > 0) {
-                currency.maxTimeToRecover = o3d::max(currency.maxTimeToRecover, trade.exitTimestamp - maxPnlTs);
-            }
-
-            maxPnlTs = trade.exitTimestamp;
-        }
-
-        // longest flat period and average trades per day
-        if (prevTradeIt != tradesResults.end()) {
-            longestFlatPeriod = o3d::max(longestFlatPeriod, trade.entryTimestamp - prevTradeIt->exitTimestamp);
-
-            // new monthly sample
-            o3d::Int32 elapsedMonths = o3d::min(999, static_cast<o3d::Int32>(
-                (baseTime(trade.entryTimestamp, TF_MONTH) - baseTime(prevTradeIt->entryTimestamp, TF_MONTH)) / TF_MONTH));
-
-            if (elapsedMonths > 0) {
-                while (elapsedMonths-- > 0) {
-                    profitPerMonthPct.push_back(0.0);
-                    profitPerMonth.push_back(0.0);
-                }
-            }
-        }
-
-        // average time in market
-        timeInMarketSamples.push_back(trade.exitTimestamp - trade.entryTimestamp);
-
-        //  for avg num trades per day
-        if (firstTradeTs == 0.0) {
-            firstTradeTs = trade.entryTimestamp;
-        }
-
-        lastTradeTs = trade.entryTimestamp;
-
-        // winning, loosing trade profit/loss
-        if (trade.profitLossPct > 0.0) {
-            winningTradePnlPct.addSample(trade.profitLossPct);
-        } else if (trade.profitLossPct < 0.0) {
-            loosingTradePnlPct.addSample(trade.profitLossPct);
+        for (const TradeResults &trade : tradesResults) {
+            trades.addTrade(trade);
         }
-
-        if (trade.profitLoss > 0.0) {
-            winningTradePnl.addSample(trade.profitLoss);
-        } else if (trade.profitLoss < 0.0) {
-            loosingTradePnl.addSample(trade.profitLoss);
-        }
-
-        // cumulative per month
-        profitPerMonthPct.back() += trade.profitLossPct;
-        profitPerMonth.back() += trade.profitLoss;
-
-        // draw-downs square samples for Ulcer ratio (relative or absolute percentage)
-        // drawDownsSqrPct.push_back(o3d::sqr((1.0 + cumPnlPct) / (1.0 + maxPnlPct) - 1.0));
-        drawDownsSqrPct.push_back(o3d::sqr(cumPnlPct - maxPnlPct));
-        drawDownsSqr.push_back(o3d::sqr(cumPnl - maxPnl));
-
-        // MFE (positive), MAE (negative), ETD (negative) (gross value, no trade fees)
-        mfePct.addSample(trade.direction * (trade.bestPrice - trade.entryPrice) / trade.entryPrice);
-        maePct.addSample(trade.direction * (trade.worstPrice - trade.entryPrice) / trade.entryPrice);
-        etdPct.addSample(trade.direction * (trade.exitPrice - trade.bestPrice) / trade.bestPrice);
-
-        // efficiency (-1..1)
-        eefPct.addSample((trade.bestPrice - trade.entryPrice) / (trade.bestPrice - trade.worstPrice));
-        xefPct.addSample((trade.exitPrice - trade.worstPrice) / (trade.bestPrice - trade.worstPrice));
-        tefPct.addSample((trade.exitPrice - trade.entryPrice) / (trade.bestPrice - trade.worstPrice));
-
-        // keep the previous trade details
-        prevTradeIt = it;
+    } else {
+        trades = accumulator;
     }
 
     // per month draw-down from trader account samples
-    o3d::Int32 prevSampleMonth = 0;
-
-    for (size_t n = 0; n < accountStats.samples.size(); ++n) {
-        if (prevSampleMonth == 0) {
-            prevSampleMonth = baseTime(accountStats.samples[n].timestamp, TF_MONTH);
-        }
+    AccountAccumulator account = accountStats.accumulator;
 
-        o3d::Double sampleBt = baseTime(accountStats.samples[n].timestamp, TF_MONTH);
-        o3d::Double elapsedMonths = static_cast<o3d::Int32>((sampleBt - prevSampleMonth) / TF_MONTH);
-        if (elapsedMonths > 0) {
-            while (elapsedMonths-- > 0) {
-                drawDownPerMonthPct.push_back(0.0);
-                drawDownPerMonth.push_back(0.0);
-            }
-        }
-
-        // a positive value
-        drawDownPerMonthPct.back() = o3d::max(drawDownPerMonthPct.back(), accountStats.samples[n].drawDownRate);
-        drawDownPerMonth.back() = o3d::max(drawDownPerMonth.back(), accountStats.samples[n].drawDown);
-    }
+    PeriodSampler &profitPerMonthPct = trades.profitPerMonthPct.finalize();
+    PeriodSampler &profitPerMonth = trades.profitPerMonth.finalize();
+    PeriodSampler &drawDownPerMonthPct = account.drawDownPerMonthPct.finalize();
+    PeriodSampler &drawDownPerMonth = account.drawDownPerMonth.finalize();
 
     // results
-    avgTimeInMarket = average(timeInMarketSamples);
+    avgTimeInMarket = trades.timeInMarket.avg;
+    longestFlatPeriod = trades.longestFlatPeriod;
 
-    o3d::Double firstDayTs = baseTime(firstTradeTs, TF_DAY);
-    o3d::Double lastDayTs = baseTime(lastTradeTs, TF_DAY);
+    percent.maxTimeToRecover = trades.maxTimeToRecoverPct;
+    currency.maxTimeToRecover = trades.maxTimeToRecover;
+
+    o3d::Double firstDayTs = baseTime(trades.firstTradeTs, TF_DAY);
+    o3d::Double lastDayTs = baseTime(trades.lastTradeTs, TF_DAY);
 
     // at least one day because of min one trade
     numTradedDays = static_cast<o3d::Int32>(((lastDayTs - firstDayTs) / TF_DAY) + 1);
 
-    avgTradePerDayIncWe = static_cast<o3d::Double>(numTrades) / numTradedDays;
+    avgTradePerDayIncWe = static_cast<o3d::Double>(trades.numTrades) / numTradedDays;
     avgTradePerDay = avgTradePerDayIncWe * (252.0 / 365.0);
 
     // estimate profitability per month
-    // percent.estimateProfitPerMonth = pow((1.0 + cumPnlPct), (1.0 * (30.5 / numTradedDays))) - 1.0;
-    percent.estimateProfitPerMonth = cumPnlPct * (30.5 / numTradedDays);
-    currency.estimateProfitPerMonth = cumPnl * (30.5 / numTradedDays);
+    // percent.estimateProfitPerMonth = pow((1.0 + trades.cumPnlPct), (1.0 * (30.5 / numTradedDays))) - 1.0;
+    percent.estimateProfitPerMonth = trades.cumPnlPct * (30.5 / numTradedDays);
+    currency.estimateProfitPerMonth = trades.cumPnl * (30.5 / numTradedDays);
 
     // Sharpe Ratio
-    if (profitPerMonthPct.size() > 1) {
-        // o3d::Int32 dof = static_cast<o3d::Int32>(profitPerMonthPct.size() - 1);
+    if (profitPerMonthPct.count() > 1) {
+        // o3d::Int32 dof = profitPerMonthPct.count() - 1;
 
         // Sharpe ratio (Student t distribution)
-        o3d::Double tmp = stdDeviation(profitPerMonthPct);
+        o3d::Double tmp = profitPerMonthPct.stdDev;
         if (tmp != 0.0) {
             percent.sharpeRatio = ((percent.estimateProfitPerMonth - RISK_FREE_RATE_OF_RETURN) / tmp);
         }
-        tmp = stdDeviation(profitPerMonth);
+        tmp = profitPerMonth.stdDev;
         if (tmp != 0.0) {
             currency.sharpeRatio = ((currency.estimateProfitPerMonth - RISK_FREE_RATE_OF_RETURN) / tmp);
         }
 
         // Sortino ratio (Student t distribution)
-        tmp = stdDeviation(drawDownPerMonthPct);
+        tmp = drawDownPerMonthPct.stdDev;
         if (tmp != 0.0) {
             percent.sortinoRatio = ((percent.estimateProfitPerMonth - RISK_FREE_RATE_OF_RETURN) / tmp);
         }
-        tmp = stdDeviation(drawDownPerMonth);
+        tmp = drawDownPerMonth.stdDev;
         if (tmp != 0.0) {
             currency.sortinoRatio = ((currency.estimateProfitPerMonth - RISK_FREE_RATE_OF_RETURN) / tmp);
         }
 
         // Ulcer index
-        percent.ulcerIndex = o3d::Math::sqrt(average(drawDownsSqrPct));
-        currency.ulcerIndex = o3d::Math::sqrt(average(drawDownsSqr));
+        if (trades.numTrades > 0) {
+            percent.ulcerIndex = o3d::Math::sqrt(trades.sumDrawDownsSqrPct / trades.numTrades);
+            currency.ulcerIndex = o3d::Math::sqrt(trades.sumDrawDownsSqr / trades.numTrades);
+        }
     }
 
     // Total PNL, Winning PNL, Loosing PNL
-    percent.samplers.push_back(anyTradePnlPct.finalize());
-    currency.samplers.push_back(anyTradePnl.finalize());
-    percent.samplers.push_back(winningTradePnlPct.finalize());
-    currency.samplers.push_back(winningTradePnl.finalize());
-    percent.samplers.push_back(loosingTradePnlPct.finalize());
-    currency.samplers.push_back(loosingTradePnl.finalize());
+    percent.samplers.push_back(trades.anyTradePnlPct.finalize());
+    currency.samplers.push_back(trades.anyTradePnl.finalize());
+    percent.samplers.push_back(trades.winningTradePnlPct.finalize());
+    currency.samplers.push_back(trades.winningTradePnl.finalize());
+    percent.samplers.push_back(trades.loosingTradePnlPct.finalize());
+    currency.samplers.push_back(trades.loosingTradePnl.finalize());
 
     // Avg Win/Loss Rate (after finalize)
-    percent.avgWinLossRate = loosingTradePnlPct.avg != 0.0 ? (winningTradePnlPct.avg / -loosingTradePnlPct.avg) : 1.0;
-    currency.avgWinLossRate = loosingTradePnl.avg != 0.0 ? (winningTradePnl.avg / -loosingTradePnl.avg) : 1.0;
+    percent.avgWinLossRate = trades.loosingTradePnlPct.avg != 0.0 ? (trades.winningTradePnlPct.avg / -trades.loosingTradePnlPct.avg) : 1.0;
+    currency.avgWinLossRate = trades.loosingTradePnl.avg != 0.0 ? (trades.winningTradePnl.avg / -trades.loosingTradePnl.avg) : 1.0;
 
     // MFE, MAE, ETD
-    percent.samplers.push_back(mfePct.finalize());
-    percent.samplers.push_back(maePct.finalize());
-    percent.samplers.push_back(etdPct.finalize());
+    percent.samplers.push_back(trades.mfePct.finalize());
+    percent.samplers.push_back(trades.maePct.finalize());
+    percent.samplers.push_back(trades.etdPct.finalize());
 
     // efficiency
-    percent.samplers.push_back(eefPct.finalize());
-    percent.samplers.push_back(xefPct.finalize());
-    percent.samplers.push_back(tefPct.finalize());
+    percent.samplers.push_back(trades.eefPct.finalize());
+    percent.samplers.push_back(trades.xefPct.finalize());
+    percent.samplers.push_back(trades.tefPct.finalize());
 }
@@ -58,10 +58,10 @@ void FaAAnalyser::compute(o3d::Double timestamp, o3d::Double lastTimestamp)
 {
     m_lastSignal.reset();
 
-    m_rsi.compute(lastTimestamp, price().price());
-    m_sma.compute(lastTimestamp, price().price());
-    m_ema.compute(lastTimestamp, price().price());
-    m_atr.compute(lastTimestamp, price().high(), price().low(), price().close());
+    m_rsi.compute(lastTimestamp, price().timestamp(), price().price());
+    m_sma.compute(lastTimestamp, price().timestamp(), price().price());
+    m_ema.compute(lastTimestamp, price().timestamp(), price().price());
+    m_atr.compute(lastTimestamp, price().timestamp(), price().high(), price().low(), price().close());
     m_td9.compute(lastTimestamp, price().timestamp(), price().high(), price().low(), price().close());
 
     o3d::Int32 lvl1Signal = 0;
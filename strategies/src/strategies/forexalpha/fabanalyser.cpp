@@ -54,10 +54,10 @@ void FaBAnalyser::terminate()
 
 void FaBAnalyser::compute(o3d::Double timestamp, o3d::Double lastTimestamp)
 {
-    m_rsi.compute(lastTimestamp, price().price());
-    m_sma.compute(lastTimestamp, price().price());
-    m_ema.compute(lastTimestamp, price().price());
-    m_atr.compute(lastTimestamp, price().high(), price().low(), price().close());
+    m_rsi.compute(lastTimestamp, price().timestamp(), price().price());
+    m_sma.compute(lastTimestamp, price().timestamp(), price().price());
+    m_ema.compute(lastTimestamp, price().timestamp(), price().price());
+    m_atr.compute(lastTimestamp, price().timestamp(), price().high(), price().low(), price().close());
 
     o3d::Int32 lvl1Signal = 0;
 
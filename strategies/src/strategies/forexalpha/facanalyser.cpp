@@ -54,8 +54,8 @@ void FaCAnalyser::terminate()
 
 void FaCAnalyser::compute(o3d::Double timestamp, o3d::Double lastTimestamp)
 {
-    m_rsi.compute(lastTimestamp, price().price());
-    m_sma.compute(lastTimestamp, price().price());
-    m_ema.compute(lastTimestamp, price().price());
-    m_atr.compute(lastTimestamp, price().high(), price().low(), price().close());
+    m_rsi.compute(lastTimestamp, price().timestamp(), price().price());
+    m_sma.compute(lastTimestamp, price().timestamp(), price().price());
+    m_ema.compute(lastTimestamp, price().timestamp(), price().price());
+    m_atr.compute(lastTimestamp, price().timestamp(), price().high(), price().low(), price().close());
 }
@@ -40,6 +40,9 @@ public:
     virtual void terminate() override;
     virtual void compute(o3d::Double timestamp, o3d::Double lastTimestamp) override;
 
+    virtual void saveState(SnapshotWriter &writer) const override;
+    virtual o3d::Bool loadState(SnapshotReader &reader) override;
+
     inline o3d::Bool inRange() const { return m_inRange; }
 
 private:
@@ -37,6 +37,7 @@ SIIS_PLUGIN_API siis::Strategy* siisStrategy(Handler *handler, const o3d::String
 
 IchimokuStRb::IchimokuStRb(Handler *handler, const o3d::String &identifier) :
     Strategy(handler, identifier),
+    m_tradeManager(nullptr),
     m_sigAnalyser(nullptr),
     m_rangeAnalyser(nullptr),
     m_confAnalyser(nullptr),
@@ -68,7 +69,7 @@ void IchimokuStRb::init(Config *config)
     // strategie parameters
     StrategyConfig conf;
     conf.parseDefaults(IchimokuStRbParameters);
-    conf.parseOverrides(config);
+    conf.parseOverrides(config, parameterOverrides());
 
     initBasicsParameters(conf);
 
@@ -356,6 +357,16 @@ void IchimokuStRb::updateStats()
     setActiveStats(performance, drawDownRate, drawDown, pending, actives);
 }
 
+void IchimokuStRb::saveState(SnapshotWriter &writer) const
+{
+    saveAnalysersState(writer, m_analysers);
+}
+
+o3d::Bool IchimokuStRb::loadState(SnapshotReader &reader)
+{
+    return loadAnalysersState(reader, m_analysers);
+}
+
 void IchimokuStRb::orderEntry(o3d::Double timestamp,
         o3d::Int32 barSize,
         o3d::Int32 direction,
@@ -364,6 +375,8 @@ void IchimokuStRb::orderEntry(o3d::Double timestamp,
         o3d::Double takeProfitPrice,
         o3d::Double stopLossPrice)
 {
+    traceEntrySignal(timestamp, direction, price, takeProfitPrice, stopLossPrice);
+
     Trade* trade = handler()->traderProxy()->createTrade(market(), tradeType(), barSize);
     if (trade) {
         m_tradeManager->addTrade(trade);
@@ -373,22 +386,15 @@ void IchimokuStRb::orderEntry(o3d::Double timestamp,
         // query open
         trade->open(this, direction, orderType, price, quantity, takeProfitPrice, stopLossPrice);
 
-        o3d::String msg = o3d::String("#{0} {1} at {2} sl={3} tp={4} q={5} {6}%/{7}%")
-                          .arg(trade->id())
-                          .arg(direction > 0 ? "LONG" : "SHORT")
-                          .arg(market()->formatPrice(price))
-                          .arg(market()->formatPrice(stopLossPrice))
-                          .arg(market()->formatPrice(takeProfitPrice))
-                          .arg(market()->formatQty(quantity))
-                          .arg(trade->estimateTakeProfitRate() * 100, 2)
-                          .arg(trade->estimateStopLossRate() * 100, 2);
-        log(m_sigAnalyser->formatUnit(), "trade-entry", msg);
+        logTradeEntry(m_sigAnalyser->formatUnit(), trade, direction, price, stopLossPrice, takeProfitPrice, quantity);
     }
 }
 
 void IchimokuStRb::orderExit(o3d::Double timestamp, Trade *trade, o3d::Double price)
 {
     if (trade) {
+        traceExitSignal(timestamp, trade, price);
+
         if (price > 0.0) {
             // if price defined, limit/stop close else market close
         } else {
@@ -398,8 +404,7 @@ void IchimokuStRb::orderExit(o3d::Double timestamp, Trade *trade, o3d::Double pr
             handler()->traderProxy()->freeTrade(trade);
         }
 
-        o3d::String msg = o3d::String("#{0}").arg(trade->id());
-        log(m_sigAnalyser->formatUnit(), "order-exit", msg);
+        logOrderExit(m_sigAnalyser->formatUnit(), trade);
     }
 }
 
@@ -8,6 +8,7 @@
 #include "ichimokustrbrangeanalyser.h"
 
 #include "siis/config/strategyconfig.h"
+#include "siis/utils/snapshot.h"
 
 using namespace siis;
 
@@ -55,10 +56,10 @@ void IchimokuStRbRangeAnalyser::terminate()
 void IchimokuStRbRangeAnalyser::compute(o3d::Double timestamp, o3d::Double lastTimestamp)
 {
     if (price().consolidated()) {
-        m_slow_ma_high.compute(timestamp, price().high());
-        m_slow_ma_low.compute(timestamp, price().low());
-        m_fast_ma_high.compute(timestamp, price().high());
-        m_fast_ma_low.compute(timestamp, price().low());
+        m_slow_ma_high.compute(timestamp, price().timestamp(), price().high());
+        m_slow_ma_low.compute(timestamp, price().timestamp(), price().low());
+        m_fast_ma_high.compute(timestamp, price().timestamp(), price().high());
+        m_fast_ma_low.compute(timestamp, price().timestamp(), price().low());
 
         if (m_fast_ma_low.last() >= m_slow_ma_low.last() && m_fast_ma_low.last() <= m_slow_ma_high.last()) {
             // fast low between slow MAs
@@ -77,3 +78,23 @@ void IchimokuStRbRangeAnalyser::compute(o3d::Double timestamp, o3d::Double lastT
         }
     }
 }
+
+void IchimokuStRbRangeAnalyser::saveState(SnapshotWriter &writer) const
+{
+    RangeBarAnalyser::saveState(writer);
+
+    m_slow_ma_high.saveState(writer);
+    m_slow_ma_low.saveState(writer);
+    m_fast_ma_high.saveState(writer);
+    m_fast_ma_low.saveState(writer);
+}
+
+o3d::Bool IchimokuStRbRangeAnalyser::loadState(SnapshotReader &reader)
+{
+    if (!RangeBarAnalyser::loadState(reader)) {
+        return false;
+    }
+
+    return m_slow_ma_high.loadState(reader) && m_slow_ma_low.loadState(reader) &&
+           m_fast_ma_high.loadState(reader) && m_fast_ma_low.loadState(reader);
+}
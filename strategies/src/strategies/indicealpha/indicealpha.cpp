@@ -265,6 +265,8 @@ void IndiceAlpha::orderEntry(
         o3d::Double limitPrice,
         o3d::Double stopPrice)
 {
+    traceEntrySignal(timestamp, direction, price, limitPrice, stopPrice);
+
     Trade* trade = handler()->traderProxy()->createTrade(market(), tradeType(), timeframe);
     if (trade) {
         m_tradeManager->addTrade(trade);
@@ -281,6 +283,8 @@ void IndiceAlpha::orderEntry(
 void IndiceAlpha::orderExit(o3d::Double timestamp, Trade *trade, o3d::Double price)
 {
     if (trade) {
+        traceExitSignal(timestamp, trade, price);
+
         if (price > 0.0) {
             // if price defined, limit close else market close
         } else {
@@ -37,6 +37,7 @@ SIIS_PLUGIN_API siis::Strategy* siisStrategy(Handler *handler, const o3d::String
 
 KahlmanFibo::KahlmanFibo(Handler *handler, const o3d::String &identifier) :
     Strategy(handler, identifier),
+    m_tradeManager(nullptr),
     m_trendAnalyser(nullptr),
     m_sigAnalyser(nullptr),
     m_confAnalyser(nullptr),
@@ -75,7 +76,7 @@ void KahlmanFibo::init(Config *config)
     // strategie parameters
     StrategyConfig conf;
     conf.parseDefaults(KahlmanFiboParameters);
-    conf.parseOverrides(config);
+    conf.parseOverrides(config, parameterOverrides());
 
     initBasicsParameters(conf);
 
@@ -191,54 +192,8 @@ void KahlmanFibo::prepareMarketData(Connector *connector, Database *db, o3d::Dou
 {
     Ohlc::Type ohlcType = Ohlc::TYPE_MID;
 
-    for (Analyser *analyser : m_analysers) {
-        if (analyser->depth() <= 0) {
-            continue;
-        }
-
-        o3d::Int32 k = 0;
-
-        o3d::Double srcTs = 0.0;
-        o3d::Double dstTs = fromTs - 1.0;
-        o3d::Int32 lastN = 0;
-
-        if (analyser->history() > 0) {
-            srcTs = fromTs - 1.0 - analyser->history();
-        } else if (analyser->timeframe() > 0) {
-            srcTs = fromTs - 1.0 - analyser->timeframe() * analyser->depth();
-        } else {
-            lastN = analyser->depth();
-        }
-
-        adjustOhlcFetchRange(analyser->history(), analyser->depth(), srcTs, dstTs, lastN);
-
-        if (lastN > 0) {
-            k = handler()->database()->ohlc()->fetchOhlcArrayLastTo(
-                    analyser->strategy()->brokerId(), market()->marketId(), analyser->timeframe(),
-                    lastN, dstTs,
-                    market()->getOhlcBuffer(ohlcType));
-        } else {
-            k = handler()->database()->ohlc()->fetchOhlcArrayFromTo(
-                    analyser->strategy()->brokerId(), market()->marketId(), analyser->timeframe(),
-                    srcTs, dstTs,
-                    market()->getOhlcBuffer(ohlcType));
-        }
-
-        if (k > 0) {
-            o3d::Int32 lastN = market()->getOhlcBuffer(ohlcType).getSize() - 1;
-
-            o3d::String msg = o3d::String("Retrieved {0}/{1} OHLCs with most recent at {2}").arg(k)
-                                  .arg(analyser->depth())
-                                  .arg(timestampToStr(market()->getOhlcBuffer(ohlcType).get(lastN)->timestamp()));
-
-            log(analyser->formatUnit(), "init", msg);
-
-            analyser->onOhlcUpdate(toTs, analyser->timeframe(), market()->getOhlcBuffer(ohlcType));
-        } else {
-            o3d::String msg = o3d::String("No OHLCs founds (0/{0})").arg(analyser->depth());
-            log(analyser->formatUnit(), "init", msg);
-        }
-    }
+    // every timeframes in a single query
+    prepareOhlcAnalysers(m_analysers, ohlcType, fromTs, toTs);
 
     setMarketDataPrepared();
 }
@@ -363,6 +318,16 @@ void KahlmanFibo::updateStats()
     setActiveStats(performance, drawDownRate, drawDown, pending, actives);
 }
 
+void KahlmanFibo::saveState(SnapshotWriter &writer) const
+{
+    saveAnalysersState(writer, m_analysers);
+}
+
+o3d::Bool KahlmanFibo::loadState(SnapshotReader &reader)
+{
+    return loadAnalysersState(reader, m_analysers);
+}
+
 void KahlmanFibo::orderEntry(
         o3d::Double timestamp,
         o3d::Double timeframe,
@@ -372,6 +337,8 @@ void KahlmanFibo::orderEntry(
         o3d::Double takeProfitPrice,
         o3d::Double stopLossPrice)
 {
+    traceEntrySignal(timestamp, direction, price, takeProfitPrice, stopLossPrice);
+
     Trade* trade = handler()->traderProxy()->createTrade(market(), tradeType(), timeframe);
     if (trade) {
         // from entry but works only in single context
@@ -384,22 +351,15 @@ void KahlmanFibo::orderEntry(
         // query open
         trade->open(this, direction, orderType, price, quantity, takeProfitPrice, stopLossPrice);
 
-        o3d::String msg = o3d::String("#{0} {1} at {2} sl={3} tp={4} q={5} {6}%/{7}%")
-                          .arg(trade->id())
-                          .arg(direction > 0 ? "LONG" : "SHORT")
-                          .arg(market()->formatPrice(price))
-                          .arg(market()->formatPrice(stopLossPrice))
-                          .arg(market()->formatPrice(takeProfitPrice))
-                          .arg(market()->formatQty(quantity))
-                          .arg(trade->estimateTakeProfitRate() * 100, 2)
-                          .arg(trade->estimateStopLossRate() * 100, 2);
-        log(m_sigAnalyser->formatUnit(), "trade-entry", msg);
+        logTradeEntry(m_sigAnalyser->formatUnit(), trade, direction, price, stopLossPrice, takeProfitPrice, quantity);
     }
 }
 
 void KahlmanFibo::orderExit(o3d::Double timestamp, Trade *trade, o3d::Double price)
 {
     if (trade) {
+        traceExitSignal(timestamp, trade, price);
+
         if (price > 0.0) {
             // if price defined, limit/stop close else market close
         } else {
@@ -409,8 +369,7 @@ void KahlmanFibo::orderExit(o3d::Double timestamp, Trade *trade, o3d::Double pri
             handler()->traderProxy()->freeTrade(trade);
         }
 
-        o3d::String msg = o3d::String("#{0}").arg(trade->id());
-        log(m_sigAnalyser->formatUnit(), "order-exit", msg);
+        logOrderExit(m_sigAnalyser->formatUnit(), trade);
     }
 }
 
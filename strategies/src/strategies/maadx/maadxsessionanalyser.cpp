@@ -9,6 +9,7 @@
 
 #include "siis/config/strategyconfig.h"
 #include "siis/strategy.h"
+#include "siis/utils/snapshot.h"
 
 using namespace siis;
 
@@ -109,3 +110,23 @@ void MaAdxSessionAnalyser::updateTick(const Tick &tick, o3d::Bool finalize)
 {
     m_vp.update(tick, finalize);
 }
+
+void MaAdxSessionAnalyser::saveState(SnapshotWriter &writer) const
+{
+    TimeframeBarAnalyser::saveState(writer);
+
+    m_vp.saveState(writer);
+    m_vpoc_bollinger.saveState(writer);
+
+    writer.writeCircular(m_vPocs);
+}
+
+o3d::Bool MaAdxSessionAnalyser::loadState(SnapshotReader &reader)
+{
+    if (!TimeframeBarAnalyser::loadState(reader)) {
+        return false;
+    }
+
+    return m_vp.loadState(reader) && m_vpoc_bollinger.loadState(reader) &&
+           reader.readCircular(m_vPocs);
+}
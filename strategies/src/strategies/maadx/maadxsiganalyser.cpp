@@ -9,6 +9,7 @@
 
 #include "siis/config/strategyconfig.h"
 #include "siis/strategy.h"
+#include "siis/utils/snapshot.h"
 
 using namespace siis;
 
@@ -111,8 +112,8 @@ void MaAdxSigAnalyser::compute(o3d::Double timestamp, o3d::Double lastTimestamp)
         // m_fast_m_ma.compute(timestamp, price().price());
         m_fast_l_ma.compute(timestamp, price().low());
 
-        m_adx.compute(timestamp, price().high(), price().low(), price().close());
-        m_wma.compute(timestamp, price().close());
+        m_adx.compute(timestamp, price().timestamp(), price().high(), price().low(), price().close());
+        m_wma.compute(timestamp, price().timestamp(), price().close());
 
         hc = DataArray::cross(price().close(), m_fast_h_ma.hma());
         lc = DataArray::cross(price().close(), m_fast_l_ma.hma());
@@ -160,6 +161,24 @@ void MaAdxSigAnalyser::updateTick(const Tick &tick, o3d::Bool finalize)
     }*/
 }
 
+void MaAdxSigAnalyser::saveState(SnapshotWriter &writer) const
+{
+    TimeframeBarAnalyser::saveState(writer);
+
+    m_adx.saveState(writer);
+    m_wma.saveState(writer);
+    m_cvd.saveState(writer);
+}
+
+o3d::Bool MaAdxSigAnalyser::loadState(SnapshotReader &reader)
+{
+    if (!TimeframeBarAnalyser::loadState(reader)) {
+        return false;
+    }
+
+    return m_adx.loadState(reader) && m_wma.loadState(reader) && m_cvd.loadState(reader);
+}
+
 o3d::Double MaAdxSigAnalyser::takeProfit(o3d::Double profitScale) const
 {
     if (m_trend > 0) {
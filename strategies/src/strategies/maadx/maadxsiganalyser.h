@@ -47,6 +47,9 @@ public:
     virtual void compute(o3d::Double timestamp, o3d::Double lastTimestamp) override;
     virtual void updateTick(const Tick& tick, o3d::Bool finalize) override;
 
+    virtual void saveState(SnapshotWriter &writer) const override;
+    virtual o3d::Bool loadState(SnapshotReader &reader) override;
+
     inline o3d::Double adx() const { return m_adx.last(); }
     inline o3d::Int32 sig() const { return m_sig; }
     inline o3d::Int32 sig2() const { return m_sig2; }
@@ -9,6 +9,7 @@
 
 #include "siis/strategy.h"
 #include "siis/config/strategyconfig.h"
+#include "siis/utils/snapshot.h"
 
 using namespace siis;
 
@@ -139,3 +140,19 @@ void MaAdxTrendAnalyser::updateTick(const Tick &tick, o3d::Bool finalize)
         m_vwap.update(tick, finalize);
     }
 }
+
+void MaAdxTrendAnalyser::saveState(SnapshotWriter &writer) const
+{
+    TimeframeBarAnalyser::saveState(writer);
+
+    m_vwap.saveState(writer);
+}
+
+o3d::Bool MaAdxTrendAnalyser::loadState(SnapshotReader &reader)
+{
+    if (!TimeframeBarAnalyser::loadState(reader)) {
+        return false;
+    }
+
+    return m_vwap.loadState(reader);
+}
@@ -44,6 +44,9 @@ public:
     virtual void compute(o3d::Double timestamp, o3d::Double lastTimestamp) override;
     virtual void updateTick(const Tick& tick, o3d::Bool finalize) override;
 
+    virtual void saveState(SnapshotWriter &writer) const override;
+    virtual o3d::Bool loadState(SnapshotReader &reader) override;
+
     inline o3d::Double lastMaHigh() const { return m_slow_h_ma.last(); }
     inline o3d::Double lastMaLow() const { return m_slow_l_ma.last(); }
 
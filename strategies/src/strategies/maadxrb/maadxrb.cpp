@@ -39,6 +39,7 @@ SIIS_PLUGIN_API siis::Strategy* siisStrategy(Handler *handler, const o3d::String
 
 MaAdxRb::MaAdxRb(Handler *handler, const o3d::String &identifier) :
     Strategy(handler, identifier),
+    m_tradeManager(nullptr),
     m_profileAnalyser(nullptr),
     m_sessionAnalyser(nullptr),
     m_trendAnalyser(nullptr),
@@ -73,7 +74,7 @@ void MaAdxRb::init(Config *config)
     // strategie parameters
     StrategyConfig conf;
     conf.parseDefaults(MaAdxRbParameters);
-    conf.parseOverrides(config);
+    conf.parseOverrides(config, parameterOverrides());
 
     initBasicsParameters(conf);
 
@@ -239,16 +240,12 @@ void MaAdxRb::prepareMarketData(Connector *connector, Database *db, o3d::Double
         if (k > 0) {
             o3d::Int32 lastN = market()->getOhlcBuffer(ohlcType).getSize() - 1;
 
-            o3d::String msg = o3d::String("Retrieved {0}/{1} OHLCs with most recent at {2}").arg(k)
-                                  .arg(analyser->depth())
-                                  .arg(timestampToStr(market()->getOhlcBuffer(ohlcType).get(lastN)->timestamp()));
-
-            log(analyser->formatUnit(), "init", msg);
+            logOhlcFetch(analyser->formatUnit(), k, analyser->depth(),
+                         market()->getOhlcBuffer(ohlcType).get(lastN)->timestamp());
 
             analyser->onOhlcUpdate(toTs, 0.0, market()->getOhlcBuffer(ohlcType));
         } else {
-            o3d::String msg = o3d::String("No OHLCs founds (0/{0})").arg(analyser->depth());
-            log(analyser->formatUnit(), "init", msg);
+            logOhlcFetch(analyser->formatUnit(), 0, analyser->depth(), 0.0);
         }
     }
 
@@ -383,6 +380,16 @@ void MaAdxRb::updateStats()
     setActiveStats(performance, drawDownRate, drawDown, pending, actives);
 }
 
+void MaAdxRb::saveState(SnapshotWriter &writer) const
+{
+    saveAnalysersState(writer, m_analysers);
+}
+
+o3d::Bool MaAdxRb::loadState(SnapshotReader &reader)
+{
+    return loadAnalysersState(reader, m_analysers);
+}
+
 void MaAdxRb::orderEntry(
         o3d::Double timestamp,
         o3d::Int32 barSize,
@@ -392,6 +399,8 @@ void MaAdxRb::orderEntry(
         o3d::Double takeProfitPrice,
         o3d::Double stopLossPrice)
 {
+    traceEntrySignal(timestamp, direction, price, takeProfitPrice, stopLossPrice);
+
     Trade* trade = handler()->traderProxy()->createTrade(market(), tradeType(), barSize);
     if (trade) {
         m_tradeManager->addTrade(trade);
@@ -401,22 +410,15 @@ void MaAdxRb::orderEntry(
         // query open
         trade->open(this, direction, orderType, price, quantity, takeProfitPrice, stopLossPrice);
 
-        o3d::String msg = o3d::String("#{0} {1} at {2} sl={3} tp={4} q={5} {6}%/{7}%")
-                          .arg(trade->id())
-                          .arg(direction > 0 ? "LONG" : "SHORT")
-                          .arg(market()->formatPrice(price))
-                          .arg(market()->formatPrice(stopLossPrice))
-                          .arg(market()->formatPrice(takeProfitPrice))
-                          .arg(market()->formatQty(quantity))
-                          .arg(trade->estimateTakeProfitRate() * 100, 2)
-                          .arg(trade->estimateStopLossRate() * 100, 2);
-        log(m_sigAnalyser->formatUnit(), "trade-entry", msg);
+        logTradeEntry(m_sigAnalyser->formatUnit(), trade, direction, price, stopLossPrice, takeProfitPrice, quantity);
     }
 }
 
 void MaAdxRb::orderExit(o3d::Double timestamp, Trade *trade, o3d::Double price)
 {
     if (trade) {
+        traceExitSignal(timestamp, trade, price);
+
         if (price > 0.0) {
             // if price defined, limit/stop close else market close
         } else {
@@ -426,8 +428,7 @@ void MaAdxRb::orderExit(o3d::Double timestamp, Trade *trade, o3d::Double price)
             handler()->traderProxy()->freeTrade(trade);
         }
 
-        o3d::String msg = o3d::String("#{0}").arg(trade->id());
-        log(m_sigAnalyser->formatUnit()/*trade->tf()*/, "order-exit", msg);
+        logOrderExit(m_sigAnalyser->formatUnit()/*trade->tf()*/, trade);
     }
 }
 
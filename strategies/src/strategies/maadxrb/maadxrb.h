@@ -70,6 +70,9 @@ public:
 
     virtual void updateStats() override;
 
+    virtual void saveState(SnapshotWriter &writer) const override;
+    virtual o3d::Bool loadState(SnapshotReader &reader) override;
+
 private:
 
     static constexpr o3d::Double ADX_MAX = 75.0;
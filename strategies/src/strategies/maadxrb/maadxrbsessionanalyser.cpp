@@ -9,6 +9,7 @@
 
 #include "siis/config/strategyconfig.h"
 #include "siis/strategy.h"
+#include "siis/utils/snapshot.h"
 
 using namespace siis;
 
@@ -119,7 +120,7 @@ void MaAdxRbSessionAnalyser::compute(o3d::Double timestamp, o3d::Double lastTime
             }
 
             if (m_ma.active()) {
-                m_ma.compute(timestamp, price().close());
+                m_ma.compute(timestamp, price().timestamp(), price().close());
                 m_vpCross = m_ma.wma().cross(vPocs);
 
                 // need up bar
@@ -147,3 +148,24 @@ void MaAdxRbSessionAnalyser::updateTick(const Tick &tick, o3d::Bool finalize)
 {
     m_vp.update(tick, finalize);
 }
+
+void MaAdxRbSessionAnalyser::saveState(SnapshotWriter &writer) const
+{
+    RangeBarAnalyser::saveState(writer);
+
+    m_vp.saveState(writer);
+    m_vpoc_bollinger.saveState(writer);
+    m_ma.saveState(writer);
+
+    writer.writeCircular(m_vPocs);
+}
+
+o3d::Bool MaAdxRbSessionAnalyser::loadState(SnapshotReader &reader)
+{
+    if (!RangeBarAnalyser::loadState(reader)) {
+        return false;
+    }
+
+    return m_vp.loadState(reader) && m_vpoc_bollinger.loadState(reader) && m_ma.loadState(reader) &&
+           reader.readCircular(m_vPocs);
+}
@@ -46,6 +46,9 @@ public:
     virtual void compute(o3d::Double timestamp, o3d::Double lastTimestamp) override;
     virtual void updateTick(const Tick& tick, o3d::Bool finalize) override;
 
+    virtual void saveState(SnapshotWriter &writer) const override;
+    virtual o3d::Bool loadState(SnapshotReader &reader) override;
+
     inline const VolumeProfile& vp() const { return m_vp; }
 
     inline o3d::Int32 vPocBreakout() const { return m_vPocBreakout; }
@@ -9,6 +9,7 @@
 
 #include "siis/config/strategyconfig.h"
 #include "siis/strategy.h"
+#include "siis/utils/snapshot.h"
 
 using namespace siis;
 
@@ -25,7 +26,7 @@ MaAdxRbSigAnalyser::MaAdxRbSigAnalyser(
     m_fast_l_ma("sfast_l_ma", rangeSize),
     m_adx("adx", rangeSize),
     m_wma("wma", rangeSize),
-    m_cvd("cvd", rangeSize, depth, "1d"),
+    m_orderFlow("cvd", rangeSize, depth, "1d"),
     m_cvd_ma("cvd_ma", rangeSize),
     m_trend(0),
     m_sig(0),
@@ -56,10 +57,12 @@ void MaAdxRbSigAnalyser::init(const AnalyserConfig &conf)
     configureIndicator(conf, "adx", m_adx);
     configureIndicator(conf, "wma", m_wma);
 
-    configureIndicator(conf, "cvd", m_cvd);
+    // the CVD is the one of the order flow, keeping the "cvd" indicator name
+    configureIndicator(conf, "cvd", m_orderFlow);
     configureIndicator(conf, "cvd_ma", m_cvd_ma);
 
-    m_cvd.setSession(strategy()->sessionOffset(), strategy()->sessionDuration());
+    m_orderFlow.init(strategy()->market()->stepPrice());
+    m_orderFlow.setSession(strategy()->sessionOffset(), strategy()->sessionDuration());
 
     m_confirmation = 0;
     m_trend = 0;
@@ -110,19 +113,19 @@ void MaAdxRbSigAnalyser::compute(o3d::Double timestamp, o3d::Double lastTimestam
         m_fast_m_ma.compute(timestamp, price().price());
         m_fast_l_ma.compute(timestamp, price().low());
 
-        m_adx.compute(timestamp, price().high(), price().low(), price().close());
-        m_wma.compute(timestamp, price().close());
+        m_adx.compute(timestamp, price().timestamp(), price().high(), price().low(), price().close());
+        m_wma.compute(timestamp, price().timestamp(), price().close());
 
         hc = DataArray::cross(price().close(), m_fast_h_ma.hma());
         lc = DataArray::cross(price().close(), m_fast_l_ma.hma());
 
-        if (m_cvd.active() && m_cvd_ma.active()) {
-            m_cvd_ma.compute(timestamp, m_cvd.cvd().asArray());
+        if (m_orderFlow.active() && m_cvd_ma.active()) {
+            m_cvd_ma.compute(timestamp, m_orderFlow.cvd().asArray());
 
             o3d::Int32 cvdTrend = 0;
-            if (m_cvd.last() > m_cvd_ma.last()) {
+            if (m_orderFlow.last() > m_cvd_ma.last()) {
                 cvdTrend = 1;
-            } else if (m_cvd.last() < m_cvd_ma.last()) {
+            } else if (m_orderFlow.last() < m_cvd_ma.last()) {
                 cvdTrend = -1;
             }
 
@@ -154,11 +157,29 @@ void MaAdxRbSigAnalyser::compute(o3d::Double timestamp, o3d::Double lastTimestam
 
 void MaAdxRbSigAnalyser::updateTick(const Tick &tick, o3d::Bool finalize)
 {
-    if (m_cvd.active()) {
-        m_cvd.update(tick, finalize);
+    if (m_orderFlow.active()) {
+        m_orderFlow.update(tick, finalize);
     }
 }
 
+void MaAdxRbSigAnalyser::saveState(SnapshotWriter &writer) const
+{
+    RangeBarAnalyser::saveState(writer);
+
+    m_adx.saveState(writer);
+    m_wma.saveState(writer);
+    m_orderFlow.saveState(writer);
+}
+
+o3d::Bool MaAdxRbSigAnalyser::loadState(SnapshotReader &reader)
+{
+    if (!RangeBarAnalyser::loadState(reader)) {
+        return false;
+    }
+
+    return m_adx.loadState(reader) && m_wma.loadState(reader) && m_orderFlow.loadState(reader);
+}
+
 o3d::Double MaAdxRbSigAnalyser::takeProfit(o3d::Double profitScale) const
 {
     if (m_trend > 0) {
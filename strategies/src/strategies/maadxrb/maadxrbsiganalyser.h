@@ -14,7 +14,7 @@
 #include "siis/indicators/hma/hma.h"
 #include "siis/indicators/wma/wma.h"
 #include "siis/indicators/adx/adx.h"
-#include "siis/indicators/cumulativevolumedelta/cvd.h"
+#include "siis/indicators/orderflow/orderflow.h"
 
 
 namespace siis {
@@ -46,12 +46,15 @@ public:
     virtual void compute(o3d::Double timestamp, o3d::Double lastTimestamp) override;
     virtual void updateTick(const Tick& tick, o3d::Bool finalize) override;
 
+    virtual void saveState(SnapshotWriter &writer) const override;
+    virtual o3d::Bool loadState(SnapshotReader &reader) override;
+
     inline o3d::Double adx() const { return m_adx.last(); }
     inline o3d::Int32 sig() const { return m_sig; }
     inline o3d::Int32 sig2() const { return m_sig2; }
     inline o3d::Int32 trend() const { return m_trend; }
 
-    inline const CumulativeVolumeDelta& cvd() const { return m_cvd; }
+    inline const OrderFlow& orderFlow() const { return m_orderFlow; }
     inline o3d::Int32 cvdTrend() const { return m_cvdTrend; }
     inline o3d::Int32 cvdCross() const { return m_cvdCross; }
 
@@ -70,7 +73,7 @@ private:
     Adx m_adx;
     Wma m_wma;
 
-    CumulativeVolumeDelta m_cvd;
+    OrderFlow m_orderFlow;  //!< CVD, footprint and profile from a single classification of the ticks
     Hma m_cvd_ma;
 
     o3d::Int32 m_trend;
@@ -9,6 +9,7 @@
 
 #include "siis/strategy.h"
 #include "siis/config/strategyconfig.h"
+#include "siis/utils/snapshot.h"
 
 using namespace siis;
 
@@ -128,3 +129,19 @@ void MaAdxRbTrendAnalyser::updateTick(const Tick &tick, o3d::Bool finalize)
         m_vwap.update(tick, finalize);
     }
 }
+
+void MaAdxRbTrendAnalyser::saveState(SnapshotWriter &writer) const
+{
+    RangeBarAnalyser::saveState(writer);
+
+    m_vwap.saveState(writer);
+}
+
+o3d::Bool MaAdxRbTrendAnalyser::loadState(SnapshotReader &reader)
+{
+    if (!RangeBarAnalyser::loadState(reader)) {
+        return false;
+    }
+
+    return m_vwap.loadState(reader);
+}
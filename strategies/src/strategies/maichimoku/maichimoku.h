@@ -67,6 +67,9 @@ public:
 
     virtual void updateStats() override;
 
+    virtual void saveState(SnapshotWriter &writer) const override;
+    virtual o3d::Bool loadState(SnapshotReader &reader) override;
+
 private:
 
     std::vector<Analyser*> m_analysers;
@@ -8,6 +8,7 @@
 #include "pullbackbbanalyser.h"
 
 #include "siis/config/strategyconfig.h"
+#include "siis/utils/snapshot.h"
 
 using namespace siis;
 
@@ -82,7 +83,7 @@ void PullbackBBAnalyser::compute(o3d::Double timestamp, o3d::Double lastTimestam
     }
 
     if (compute) {
-        m_bollinger.compute(timestamp, price().close());
+        m_bollinger.compute(timestamp, price().timestamp(), price().close());
 
         o3d::Int32 uc = DataArray::cross(price().close(), m_bollinger.upper());
         o3d::Int32 lc = DataArray::cross(price().close(), m_bollinger.lower());
@@ -100,11 +101,28 @@ void PullbackBBAnalyser::compute(o3d::Double timestamp, o3d::Double lastTimestam
         }
 
         if (m_hasAdx) {
-            m_adx.compute(timestamp, price().high(), price().low(), price().close());
+            m_adx.compute(timestamp, price().timestamp(), price().high(), price().low(), price().close());
         }
     }
 }
 
+void PullbackBBAnalyser::saveState(SnapshotWriter &writer) const
+{
+    TimeframeBarAnalyser::saveState(writer);
+
+    m_bollinger.saveState(writer);
+    m_adx.saveState(writer);
+}
+
+o3d::Bool PullbackBBAnalyser::loadState(SnapshotReader &reader)
+{
+    if (!TimeframeBarAnalyser::loadState(reader)) {
+        return false;
+    }
+
+    return m_bollinger.loadState(reader) && m_adx.loadState(reader);
+}
+
 o3d::Double PullbackBBAnalyser::entryPrice() const
 {
     return 0.0;   // @todo for limit entry
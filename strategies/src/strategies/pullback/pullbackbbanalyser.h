@@ -42,6 +42,9 @@ public:
     virtual void terminate() override;
     virtual void compute(o3d::Double timestamp, o3d::Double lastTimestamp) override;
 
+    virtual void saveState(SnapshotWriter &writer) const override;
+    virtual o3d::Bool loadState(SnapshotReader &reader) override;
+
     inline o3d::Int32 breakout() const { return m_breakout; }
     inline o3d::Int32 integrate() const { return m_integrate; }
 
@@ -9,6 +9,7 @@
 
 #include "siis/config/strategyconfig.h"
 #include "siis/strategy.h"
+#include "siis/utils/snapshot.h"
 
 using namespace siis;
 
@@ -60,3 +61,19 @@ void PullbackSessionAnalyser::updateTick(const Tick &tick, o3d::Bool finalize)
 {
     m_vp.update(tick, finalize);
 }
+
+void PullbackSessionAnalyser::saveState(SnapshotWriter &writer) const
+{
+    TimeframeBarAnalyser::saveState(writer);
+
+    m_vp.saveState(writer);
+}
+
+o3d::Bool PullbackSessionAnalyser::loadState(SnapshotReader &reader)
+{
+    if (!TimeframeBarAnalyser::loadState(reader)) {
+        return false;
+    }
+
+    return m_vp.loadState(reader);
+}
@@ -8,6 +8,7 @@
 #include "pullbacksranalyser.h"
 
 #include "siis/config/strategyconfig.h"
+#include "siis/utils/snapshot.h"
 
 using namespace siis;
 
@@ -21,6 +22,7 @@ PullbackSRAnalyser::PullbackSRAnalyser(
             Price::Method priceMethod) :
     TimeframeBarAnalyser(strategy, name, timeframe, sourceTimeframe, depth, history, priceMethod),
     m_pivotpoint("pivotpoint", timeframe),
+    m_atrsr("atrsr", timeframe),
     m_breakoutDirection(0),
     m_breakoutPrice(0.0),
     m_srLevel(0)
@@ -41,6 +43,7 @@ o3d::String PullbackSRAnalyser::typeName() const
 void PullbackSRAnalyser::init(const AnalyserConfig &conf)
 {
     configureIndicator(conf, "pivotpoint", m_pivotpoint);
+    configureIndicator(conf, "atrsr", m_atrsr);
 
     TimeframeBarAnalyser::init(conf);
 
@@ -59,6 +62,11 @@ void PullbackSRAnalyser::compute(o3d::Double timestamp, o3d::Double lastTimestam
     if (price().consolidated()) {
         // compute at close
         m_pivotpoint.compute(timestamp, price().open(), price().high(), price().low(), price().close());
+
+        if (m_atrsr.active()) {
+            // only the new closed bars are processed
+            m_atrsr.compute(timestamp, price().timestamp(), price().high(), price().low(), price().close());
+        }
     }
 
     // check for support and resistance break
@@ -112,3 +120,19 @@ void PullbackSRAnalyser::compute(o3d::Double timestamp, o3d::Double lastTimestam
 //        printf("%s %f dir=%i sr=%i\n", timestampToStr(timestamp).toAscii().getData(), m_breakoutPrice, m_breakoutDirection, m_srLevel);
 //    }
 }
+
+void PullbackSRAnalyser::saveState(SnapshotWriter &writer) const
+{
+    TimeframeBarAnalyser::saveState(writer);
+
+    m_atrsr.saveState(writer);
+}
+
+o3d::Bool PullbackSRAnalyser::loadState(SnapshotReader &reader)
+{
+    if (!TimeframeBarAnalyser::loadState(reader)) {
+        return false;
+    }
+
+    return m_atrsr.loadState(reader);
+}
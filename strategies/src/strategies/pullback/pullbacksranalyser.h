@@ -11,6 +11,7 @@
 #include "siis/analysers/timeframebaranalyser.h"
 
 #include "siis/indicators/pivotpoint/pivotpoint.h"
+#include "siis/indicators/atrsr/atrsr.h"
 
 namespace siis {
 
@@ -41,13 +42,22 @@ public:
     virtual void terminate() override;
     virtual void compute(o3d::Double timestamp, o3d::Double lastTimestamp) override;
 
+    virtual void saveState(SnapshotWriter &writer) const override;
+    virtual o3d::Bool loadState(SnapshotReader &reader) override;
+
     o3d::Int32 breakoutDirection() const { return m_breakoutDirection; }
     o3d::Double breakoutPrice() const { return m_breakoutPrice; }
     o3d::Int32 srLevel() const { return m_srLevel; }
 
+    /**
+     * @brief atrSR Swing pivots support/resistance levels, if the "atrsr" indicator is configured.
+     */
+    const AtrSR& atrSR() const { return m_atrsr; }
+
 private:
 
     PivotPoint m_pivotpoint;
+    AtrSR m_atrsr;
 
     o3d::Int32 m_breakoutDirection;
     o3d::Double m_breakoutPrice;
@@ -38,6 +38,7 @@ SIIS_PLUGIN_API siis::Strategy* siisStrategy(Handler *handler, const o3d::String
 
 PullbackRb::PullbackRb(Handler *handler, const o3d::String &identifier) :
     Strategy(handler, identifier),
+    m_tradeManager(nullptr),
     m_sessionAnalyser(nullptr),
     m_srAnalyser(nullptr),
     m_bbAnalyser(nullptr),
@@ -77,7 +78,7 @@ void PullbackRb::init(Config *config)
     // strategie parameters
     StrategyConfig conf;
     conf.parseDefaults(PullbackRbParameters);
-    conf.parseOverrides(config);
+    conf.parseOverrides(config, parameterOverrides());
 
     initBasicsParameters(conf);
 
@@ -251,16 +252,12 @@ void PullbackRb::prepareMarketData(Connector *connector, Database *db, o3d::Doub
         if (k > 0) {
             o3d::Int32 lastN = market()->getOhlcBuffer(ohlcType).getSize() - 1;
 
-            o3d::String msg = o3d::String("Retrieved {0}/{1} OHLCs with most recent at {2}").arg(k)
-                                  .arg(analyser->depth())
-                                  .arg(timestampToStr(market()->getOhlcBuffer(ohlcType).get(lastN)->timestamp()));
-
-            log(analyser->formatUnit(), "init", msg);
+            logOhlcFetch(analyser->formatUnit(), k, analyser->depth(),
+                         market()->getOhlcBuffer(ohlcType).get(lastN)->timestamp());
 
             analyser->onOhlcUpdate(toTs, 0.0, market()->getOhlcBuffer(ohlcType));
         } else {
-            o3d::String msg = o3d::String("No OHLCs founds (0/{0})").arg(analyser->depth());
-            log(analyser->formatUnit(), "init", msg);
+            logOhlcFetch(analyser->formatUnit(), 0, analyser->depth(), 0.0);
         }
     }
 
@@ -389,6 +386,16 @@ void PullbackRb::updateStats()
     setActiveStats(performance, drawDownRate, drawDown, pending, actives);
 }
 
+void PullbackRb::saveState(SnapshotWriter &writer) const
+{
+    saveAnalysersState(writer, m_analysers);
+}
+
+o3d::Bool PullbackRb::loadState(SnapshotReader &reader)
+{
+    return loadAnalysersState(reader, m_analysers);
+}
+
 void PullbackRb::orderEntry(
         o3d::Double timestamp,
         o3d::Double timeframe,
@@ -398,6 +405,8 @@ void PullbackRb::orderEntry(
         o3d::Double takeProfitPrice,
         o3d::Double stopLossPrice)
 {
+    traceEntrySignal(timestamp, direction, price, takeProfitPrice, stopLossPrice);
+
     Trade* trade = handler()->traderProxy()->createTrade(market(), tradeType(), timeframe);
     if (trade) {
         m_tradeManager->addTrade(trade);
@@ -407,22 +416,15 @@ void PullbackRb::orderEntry(
         // query open
         trade->open(this, direction, orderType, price, quantity, takeProfitPrice, stopLossPrice);
 
-        o3d::String msg = o3d::String("#{0} {1} at {2} sl={3} tp={4} q={5} {6}%/{7}%")
-                          .arg(trade->id())
-                          .arg(direction > 0 ? "LONG" : "SHORT")
-                          .arg(market()->formatPrice(price))
-                          .arg(market()->formatPrice(stopLossPrice))
-                          .arg(market()->formatPrice(takeProfitPrice))
-                          .arg(market()->formatQty(quantity))
-                          .arg(trade->estimateTakeProfitRate() * 100, 2)
-                          .arg(trade->estimateStopLossRate() * 100, 2);
-        log(m_bbAnalyser->formatUnit(), "trade-entry", msg);
+        logTradeEntry(m_bbAnalyser->formatUnit(), trade, direction, price, stopLossPrice, takeProfitPrice, quantity);
     }
 }
 
 void PullbackRb::orderExit(o3d::Double timestamp, Trade *trade, o3d::Double price)
 {
     if (trade) {
+        traceExitSignal(timestamp, trade, price);
+
         if (price > 0.0) {
             // if price defined, limit/stop close else market close
         } else {
@@ -432,8 +434,7 @@ void PullbackRb::orderExit(o3d::Double timestamp, Trade *trade, o3d::Double pric
             handler()->traderProxy()->freeTrade(trade);
         }
 
-        o3d::String msg = o3d::String("#{0}").arg(trade->id());
-        log(m_bbAnalyser->formatUnit(), "order-exit", msg);
+        logOrderExit(m_bbAnalyser->formatUnit(), trade);
     }
 }
 
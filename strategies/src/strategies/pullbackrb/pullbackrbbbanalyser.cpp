@@ -8,6 +8,7 @@
 #include "pullbackrbbbanalyser.h"
 
 #include "siis/config/strategyconfig.h"
+#include "siis/utils/snapshot.h"
 
 using namespace siis;
 
@@ -80,7 +81,7 @@ void PullbackRbBBAnalyser::compute(o3d::Double timestamp, o3d::Double lastTimest
     }
 
     if (compute) {
-        m_bollinger.compute(timestamp, price().close());
+        m_bollinger.compute(timestamp, price().timestamp(), price().close());
 
         o3d::Int32 uc = DataArray::cross(price().close(), m_bollinger.upper());
         o3d::Int32 lc = DataArray::cross(price().close(), m_bollinger.lower());
@@ -98,11 +99,28 @@ void PullbackRbBBAnalyser::compute(o3d::Double timestamp, o3d::Double lastTimest
         }
 
         if (m_hasAdx) {
-            m_adx.compute(timestamp, price().high(), price().low(), price().close());
+            m_adx.compute(timestamp, price().timestamp(), price().high(), price().low(), price().close());
         }
     }
 }
 
+void PullbackRbBBAnalyser::saveState(SnapshotWriter &writer) const
+{
+    RangeBarAnalyser::saveState(writer);
+
+    m_bollinger.saveState(writer);
+    m_adx.saveState(writer);
+}
+
+o3d::Bool PullbackRbBBAnalyser::loadState(SnapshotReader &reader)
+{
+    if (!RangeBarAnalyser::loadState(reader)) {
+        return false;
+    }
+
+    return m_bollinger.loadState(reader) && m_adx.loadState(reader);
+}
+
 o3d::Double PullbackRbBBAnalyser::entryPrice() const
 {
     return 0.0;   // @todo for limit entry
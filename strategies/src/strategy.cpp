@@ -10,6 +10,12 @@
 #include "siis/config/strategyconfig.h"
 
 #include "siis/trade/stdtrademanager.h"
+#include "siis/analysers/analyser.h"
+#include "siis/database/database.h"
+#include "siis/database/ohlcdb.h"
+#include "siis/utils/common.h"
+#include "siis/utils/snapshot.h"
+#include "siis/utils/trace.h"
 
 #include <algorithm>
 #include <map>
@@ -23,9 +29,11 @@ Handler::~Handler()
 
 Strategy::Strategy(Handler *handler, const o3d::String &identifier) :
     m_handler(handler),
+    m_logger(handler ? handler->logger() : nullptr),
     m_identifier(identifier),
     m_curState(STATE_NEW),
     m_nextState(STATE_INITIALIZED),
+    m_trace(nullptr),
     m_market(nullptr),
     m_lastTimestamp(0),
     m_processing(false),
@@ -39,7 +47,13 @@ Strategy::Strategy(Handler *handler, const o3d::String &identifier) :
     m_baseQuantity(1.0),
     m_timezone(0.0),
     m_sessionOffset(0.0),
-    m_sessionDuration(0.0)
+    m_sessionDuration(0.0),
+    m_dailyReportFmt(0),
+    m_tradeEntryFmt(0),
+    m_orderExitFmt(0),
+    m_ohlcFetchFmt(0),
+    m_ohlcNotFoundFmt(0),
+    m_parameterOverrides(nullptr)
 {
     m_properties["name"] = "undefined";
     m_properties["author"] = "undefined";
@@ -47,11 +61,19 @@ Strategy::Strategy(Handler *handler, const o3d::String &identifier) :
     m_properties["revision"] = "0";
     m_properties["copyright"] = "undefined";
     m_properties["comment"] = "";
+
+    if (m_logger) {
+        m_dailyReportFmt = m_logger->registerFormat("daily-report", "Daily perf {0}% on {1}%", o3d::System::MSG_CRITICAL);
+        m_tradeEntryFmt = m_logger->registerFormat("trade-entry", "#{0} {1} at {2} sl={3} tp={4} q={5} {6}%/{7}%");
+        m_orderExitFmt = m_logger->registerFormat("order-exit", "#{0}");
+        m_ohlcFetchFmt = m_logger->registerFormat("init", "Retrieved {0}/{1} OHLCs with most recent at {2}");
+        m_ohlcNotFoundFmt = m_logger->registerFormat("init", "No OHLCs founds (0/{0})");
+    }
 }
 
 Strategy::~Strategy()
 {
-
+    o3d::deletePtr(m_parameterOverrides);
 }
 
 void Strategy::init(Config *config)
@@ -76,6 +98,7 @@ void Strategy::init(Config *config)
     }
 
     m_brokerId = config->getBrokerId();
+    m_accountId = config->getAccountId();
 }
 
 static void tradingSessionFromStr(Json::Value &trading, std::vector<TradingSession> &out)
@@ -219,6 +242,15 @@ void Strategy::setMarket(Market *market)
     m_market = market;
 }
 
+void Strategy::setParameterOverrides(const Json::Value &overrides)
+{
+    if (!m_parameterOverrides) {
+        m_parameterOverrides = new Json::Value();
+    }
+
+    *m_parameterOverrides = overrides;
+}
+
 void Strategy::setBaseQuantity(o3d::Double qty)
 {
     m_baseQuantity = qty;
@@ -274,12 +306,63 @@ void Strategy::process(o3d::Double timestamp)
     m_processing = false;
 }
 
+void Strategy::feedTicks(o3d::Double timestamp, const TickArray &ticks)
+{
+    if (m_baseTimeframe == TF_TICK) {
+        // before the analysers, that derive their bars from the updated base bars
+        m_cascade.onTickUpdate(timestamp, ticks);
+    }
+
+    onTickUpdate(timestamp, ticks);
+}
+
 void Strategy::log(const o3d::String &unit, const o3d::String &channel, const o3d::String &msg,
                    o3d::System::MessageLevel type)
 {
     m_handler->log(unit, m_market->marketId(), channel, msg, type);
 }
 
+void Strategy::logTradeEntry(const o3d::String &unit, const Trade *trade, o3d::Int32 direction, o3d::Double price,
+                             o3d::Double stopLossPrice, o3d::Double takeProfitPrice, o3d::Double quantity)
+{
+    if (!m_logger || !m_logger->enabled() || !trade) {
+        return;
+    }
+
+    const o3d::Int32 pricePrecision = static_cast<o3d::Int32>(m_market->precisionPrice());
+    const o3d::Int32 qtyPrecision = static_cast<o3d::Int32>(m_market->precisionQty());
+
+    logf(m_tradeEntryFmt, unit,
+         trade->id(),
+         direction > 0 ? "LONG" : "SHORT",
+         LogArg::dec(price, pricePrecision),
+         LogArg::dec(stopLossPrice, pricePrecision),
+         LogArg::dec(takeProfitPrice, pricePrecision),
+         LogArg::dec(quantity, qtyPrecision),
+         LogArg::dec(trade->estimateTakeProfitRate() * 100, 2),
+         LogArg::dec(trade->estimateStopLossRate() * 100, 2));
+}
+
+void Strategy::logOrderExit(const o3d::String &unit, const Trade *trade)
+{
+    if (m_logger && m_logger->enabled() && trade) {
+        logf(m_orderExitFmt, unit, trade->id());
+    }
+}
+
+void Strategy::logOhlcFetch(const o3d::String &unit, o3d::Int32 count, o3d::Int32 depth, o3d::Double lastTimestamp)
+{
+    if (!m_logger || !m_logger->enabled()) {
+        return;
+    }
+
+    if (count > 0) {
+        logf(m_ohlcFetchFmt, unit, count, depth, LogArg::ts(lastTimestamp));
+    } else {
+        logf(m_ohlcNotFoundFmt, unit, depth);
+    }
+}
+
 void Strategy::addClosedTrade(Trade *trade)
 {
     if (trade) {
@@ -352,11 +435,9 @@ void Strategy::addClosedTrade(Trade *trade)
             if (lastTimestamp() - m_stats.dailyStartTimestamp >= TF_DAY) {
                 m_stats.dailyStartTimestamp = baseTime(lastTimestamp(), TF_DAY);
 
-                o3d::String msg = o3d::String("Daily perf {0}% on {1}%")
-                                      .arg(m_stats.dailyPerformance * 100, 2)
-                                      .arg(m_stats.performance * 100, 2);
-
-                log("1d", "daily-report", msg, o3d::System::MSG_CRITICAL);
+                logf(m_dailyReportFmt, "1d",
+                     LogArg::dec(m_stats.dailyPerformance * 100, 2),
+                     LogArg::dec(m_stats.performance * 100, 2));
 
                 m_stats.dailyPerformance = 0.0;
             }
@@ -365,10 +446,29 @@ void Strategy::addClosedTrade(Trade *trade)
 
             // keep some interesting values for final stats
             m_stats.addTrade(trade);
+
+            if (m_trace) {
+                m_trace->tradeExit(trade->exitTs(), trade->direction(), trade->entryPrice(), trade->exitPrice(), rpnl);
+            }
         }
     }
 }
 
+void Strategy::traceEntrySignal(o3d::Double timestamp, o3d::Int32 direction,
+                                o3d::Double price, o3d::Double takeProfitPrice, o3d::Double stopLossPrice)
+{
+    if (m_trace) {
+        m_trace->entrySignal(timestamp, direction, price, takeProfitPrice, stopLossPrice);
+    }
+}
+
+void Strategy::traceExitSignal(o3d::Double timestamp, Trade *trade, o3d::Double price)
+{
+    if (m_trace && trade) {
+        m_trace->exitSignal(timestamp, trade->id(), price);
+    }
+}
+
 o3d::Bool Strategy::allowedTradingSession(o3d::Double timestamp) const
 {
     if (hasTradingSessions()) {
@@ -582,6 +682,207 @@ void Strategy::adjustOhlcFetchRange(o3d::Double history, o3d::Int32 depth,
     }
 }
 
+void Strategy::prepareOhlcAnalysers(const std::vector<Analyser*> &analysers, Ohlc::Type ohlcType,
+                                    o3d::Double fromTs, o3d::Double toTs)
+{
+    std::vector<OhlcRequest> requests;
+    std::vector<Analyser*> requesters;
+
+    requests.reserve(analysers.size());
+
+    for (Analyser *analyser : analysers) {
+        if (analyser->depth() <= 0) {
+            continue;
+        }
+
+        o3d::Double srcTs = 0.0;
+        o3d::Double dstTs = fromTs - 1.0;
+        o3d::Int32 lastN = 0;
+
+        if (analyser->history() > 0) {
+            srcTs = fromTs - 1.0 - analyser->history();
+        } else if (analyser->timeframe() > 0) {
+            srcTs = fromTs - 1.0 - analyser->timeframe() * analyser->depth();
+        } else {
+            lastN = analyser->depth();
+        }
+
+        adjustOhlcFetchRange(analyser->history(), analyser->depth(), srcTs, dstTs, lastN);
+
+        OhlcRequest request;
+        request.timeframe = analyser->timeframe();
+        request.from = srcTs;
+        request.to = dstTs;
+        request.lastN = lastN;
+        request.out = new OhlcArray();
+
+        requests.push_back(request);
+        requesters.push_back(analyser);
+    }
+
+    if (requests.empty()) {
+        return;
+    }
+
+    // single round-trip for every timeframes
+    handler()->database()->ohlc()->fetchOhlcArrays(brokerId(), market()->marketId(), requests);
+
+    OhlcArray &buffer = market()->getOhlcBuffer(ohlcType);
+
+    for (size_t i = 0; i < requests.size(); ++i) {
+        Analyser *analyser = requesters[i];
+        OhlcRequest &request = requests[i];
+
+        if (request.count > 0) {
+            buffer.pushArray(request.out->getContent(0), request.out->getSize());
+
+            logOhlcFetch(analyser->formatUnit(), request.count, analyser->depth(),
+                         buffer.get(buffer.getSize() - 1)->timestamp());
+
+            analyser->onOhlcUpdate(toTs, analyser->timeframe(), buffer);
+        } else {
+            logOhlcFetch(analyser->formatUnit(), 0, analyser->depth(), 0.0);
+        }
+
+        o3d::deletePtr(request.out);
+    }
+}
+
+o3d::Bool Strategy::saveSnapshot(const o3d::String &filename) const
+{
+    if (!m_market) {
+        return false;
+    }
+
+    SnapshotWriter writer;
+    writeSnapshot(writer);
+
+    return writer.save(filename);
+}
+
+o3d::Bool Strategy::loadSnapshot(const o3d::String &filename, o3d::Double fromTs, o3d::Double maxGap)
+{
+    if (!m_market) {
+        return false;
+    }
+
+    SnapshotReader reader;
+    if (!reader.load(filename)) {
+        return false;
+    }
+
+    return readSnapshot(reader, fromTs, maxGap, filename);
+}
+
+void Strategy::writeSnapshot(SnapshotWriter &writer) const
+{
+    // identity
+    writer.writeString(property("name"));
+    writer.writeString(m_identifier);
+    writer.writeString(m_brokerId);
+    writer.writeString(m_market ? o3d::String(m_market->marketId()) : o3d::String());
+
+    writer.writeDouble(m_lastTimestamp);
+
+    saveState(writer);
+}
+
+o3d::Bool Strategy::readSnapshot(SnapshotReader &reader, o3d::Double fromTs, o3d::Double maxGap,
+                                 const o3d::String &origin)
+{
+    if (!m_market) {
+        return false;
+    }
+
+    o3d::String name = reader.readString();
+    o3d::String identifier = reader.readString();
+    o3d::String brokerId = reader.readString();
+    o3d::String marketId = reader.readString();
+
+    o3d::Double lastTimestamp = reader.readDouble();
+
+    if (reader.failed() || name != property("name") || identifier != m_identifier || brokerId != m_brokerId ||
+        marketId != o3d::String(m_market->marketId())) {
+        log("", "init", o3d::String("Snapshot {0} does not match the strategy").arg(origin));
+        return false;
+    }
+
+    if (lastTimestamp > fromTs || (maxGap > 0.0 && fromTs - lastTimestamp > maxGap)) {
+        log("", "init", o3d::String("Snapshot {0} at {1} is outdated").arg(origin).arg(timestampToStr(lastTimestamp)));
+        return false;
+    }
+
+    if (!loadState(reader)) {
+        log("", "init", o3d::String("Snapshot {0} does not match the configuration of the strategy").arg(origin));
+        return false;
+    }
+
+    m_lastTimestamp = lastTimestamp;
+
+    log("", "init", o3d::String("Restored from snapshot at {0}").arg(timestampToStr(lastTimestamp)));
+
+    setMarketDataPrepared();
+    return true;
+}
+
+void Strategy::saveState(SnapshotWriter &writer) const
+{
+    // nothing by default
+}
+
+o3d::Bool Strategy::loadState(SnapshotReader &reader)
+{
+    // no snapshot support by default
+    return false;
+}
+
+void Strategy::saveAnalysersState(SnapshotWriter &writer, const std::vector<Analyser*> &analysers) const
+{
+    writer.writeInt32(static_cast<o3d::Int32>(analysers.size()));
+
+    for (const Analyser *analyser : analysers) {
+        writer.writeString(analyser->typeName());
+        writer.writeString(analyser->name());
+        writer.writeDouble(analyser->timeframe());
+        writer.writeInt32(analyser->barSize());
+        writer.writeInt32(analyser->depth());
+    }
+
+    for (const Analyser *analyser : analysers) {
+        analyser->saveState(writer);
+    }
+}
+
+o3d::Bool Strategy::loadAnalysersState(SnapshotReader &reader, const std::vector<Analyser*> &analysers)
+{
+    o3d::Int32 n = reader.readInt32();
+    if (reader.failed() || n != static_cast<o3d::Int32>(analysers.size())) {
+        return false;
+    }
+
+    // the whole layout must match before modifying any analyser
+    for (const Analyser *analyser : analysers) {
+        o3d::String typeName = reader.readString();
+        o3d::String name = reader.readString();
+        o3d::Double timeframe = reader.readDouble();
+        o3d::Int32 barSize = reader.readInt32();
+        o3d::Int32 depth = reader.readInt32();
+
+        if (reader.failed() || typeName != analyser->typeName() || name != analyser->name() ||
+            timeframe != analyser->timeframe() || barSize != analyser->barSize() || depth != analyser->depth()) {
+            return false;
+        }
+    }
+
+    for (Analyser *analyser : analysers) {
+        if (!analyser->loadState(reader)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 void Strategy::setInitialized()
 {
     if (m_nextState == STATE_INITIALIZED) {
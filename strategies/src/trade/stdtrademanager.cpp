@@ -7,6 +7,7 @@
 
 #include "siis/trade/stdtrademanager.h"
 #include "siis/database/tradedb.h"
+#include "siis/database/tradestore.h"
 #include "siis/strategy.h"
 #include "siis/connector/traderproxy.h"
 #include "siis/handler.h"
@@ -14,8 +15,14 @@
 using namespace siis;
 
 StdTradeManager::StdTradeManager(Strategy *strategy) :
-    m_strategy(strategy)
+    m_strategy(strategy),
+    m_tradeExitFmt(0),
+    m_tradeStore(strategy->handler() ? strategy->handler()->tradeStore() : nullptr)
 {
+    if (m_strategy->logger()) {
+        m_tradeExitFmt = m_strategy->logger()->registerFormat(
+                             "trade-exit", "#{0} {1} exit at p={2} pl={3}% ({4}pips) {5}");
+    }
 
 }
 
@@ -50,6 +57,7 @@ void StdTradeManager::addTrade(Trade *trade)
 {
     if (trade) {
         m_trades.push_back(trade);
+        persistTrade(trade);
     }
 }
 
@@ -60,6 +68,8 @@ void StdTradeManager::removeTrade(Trade *trade)
         m_trades.remove(trade);
         m_mutex.unlock();
 
+        unpersistTrade(trade);
+
         // free trade
         strategy()->handler()->traderProxy()->freeTrade(trade);
     }
@@ -99,17 +109,18 @@ void StdTradeManager::process(o3d::Double timestamp)
             o3d::Double pips = trade->direction() * (trade->exitPrice() - trade->entryPrice()) /
                                strategy()->market()->onePipMean();
 
-            o3d::String msg = o3d::String("#{0} {1} exit at p={2} pl={3}% ({4}pips) {5}")
-                                  .arg(trade->id())
-                                  .arg(trade->direction() > 0 ? "LONG" : "SHORT")
-                                  .arg(trade->strategy()->market()->formatPrice(trade->exitPrice()))
-                                  .arg(trade->profitLossRate()*100.0, 2)
-                                  .arg(pips, 1)
-                                  .arg(trade->profitLossRate() > 0 ? "WIN" : "LOSS");
-            m_strategy->log(""/*trade->tf()*/, "trade-exit", msg);
+            // deferred formatting
+            m_strategy->logf(m_tradeExitFmt, ""/*trade->tf()*/,
+                             trade->id(),
+                             trade->direction() > 0 ? "LONG" : "SHORT",
+                             LogArg::dec(trade->exitPrice(), static_cast<o3d::Int32>(strategy()->market()->precisionPrice())),
+                             LogArg::dec(trade->profitLossRate()*100.0, 2),
+                             LogArg::dec(pips, 1),
+                             trade->profitLossRate() > 0 ? "WIN" : "LOSS");
         }
 
         m_trades.remove(trade);
+        unpersistTrade(trade);
 
         // for statistics
         strategy()->addClosedTrade(trade);
@@ -392,6 +403,9 @@ void StdTradeManager::onOrderSignal(const OrderSignal &orderSignal)
             // found : apply
             m_mutex.unlock();
             trade->orderSignal(orderSignal);
+
+            // the state of the trade changed
+            persistTrade(trade);
             return;
         }
     }
@@ -408,6 +422,9 @@ void StdTradeManager::onPositionSignal(const PositionSignal &positionSignal)
             // found : apply
             m_mutex.unlock();
             trade->positionSignal(positionSignal);
+
+            // the state of the trade changed
+            persistTrade(trade);
             return;
         }
     }
@@ -417,15 +434,23 @@ void StdTradeManager::onPositionSignal(const PositionSignal &positionSignal)
 
 void StdTradeManager::saveTrades(TradeDb *tradeDb)
 {
+    std::vector<TradeRecord> records;
+
     m_mutex.lock();
 
     for (const Trade *trade : m_trades) {
         if (trade->isActive()) {
-            tradeDb->storeTrade(m_strategy->brokerId(), m_strategy->market()->marketId(), m_strategy->identifier(), *trade);
+            records.push_back(TradeRecord(m_strategy->brokerId(), m_strategy->accountId(),
+                                          m_strategy->market()->marketId(), m_strategy->identifier(), *trade));
         }
     }
 
     m_mutex.unlock();
+
+    // synchronous, in a single batch
+    if (!records.empty()) {
+        tradeDb->storeTrades(records);
+    }
 }
 
 void StdTradeManager::loadTrades(TradeDb *tradeDb, TraderProxy *traderProxy)
@@ -436,3 +461,19 @@ void StdTradeManager::loadTrades(TradeDb *tradeDb, TraderProxy *traderProxy)
 
     m_mutex.unlock();
 }
+
+void StdTradeManager::persistTrade(const Trade *trade)
+{
+    if (m_tradeStore && trade) {
+        m_tradeStore->storeTrade(m_strategy->brokerId(), m_strategy->accountId(),
+                                 m_strategy->market()->marketId(), m_strategy->identifier(), *trade);
+    }
+}
+
+void StdTradeManager::unpersistTrade(const Trade *trade)
+{
+    if (m_tradeStore && trade) {
+        m_tradeStore->removeTrade(m_strategy->brokerId(), m_strategy->accountId(),
+                                  m_strategy->market()->marketId(), m_strategy->identifier(), trade->id());
+    }
+}
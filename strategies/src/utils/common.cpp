@@ -374,3 +374,32 @@ o3d::Double siis::durationFromStr(const o3d::String &deltaTime)
 
     return sign * (hours * 3600.0 + minutes * 60.0);
 }
+
+o3d::UInt32 siis::crc32(const o3d::UInt8 *data, size_t size)
+{
+    struct Table
+    {
+        o3d::UInt32 values[256];
+
+        Table()
+        {
+            for (o3d::UInt32 i = 0; i < 256; ++i) {
+                o3d::UInt32 c = i;
+                for (o3d::Int32 k = 0; k < 8; ++k) {
+                    c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+                }
+                values[i] = c;
+            }
+        }
+    };
+
+    // thread-safe initialization
+    static const Table table;
+
+    o3d::UInt32 crc = 0xffffffffu;
+    for (size_t i = 0; i < size; ++i) {
+        crc = table.values[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    }
+
+    return crc ^ 0xffffffffu;
+}
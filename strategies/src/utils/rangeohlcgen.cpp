@@ -8,20 +8,28 @@
 #include "siis/utils/rangeohlcgen.h"
 #include "siis/utils/math.h"
 #include "siis/analysers/analyser.h"
+#include "siis/utils/snapshot.h"
 
 using namespace siis;
 
 RangeOhlcGen::RangeOhlcGen(o3d::Int32 barSize, o3d::Double tickScale, Ohlc::Type ohlcType):
+    m_genTicks(nullptr),
+    m_genTicksAnalyser(nullptr),
     m_barSize(barSize),
     m_tickScale(tickScale),
     m_ohlcType(ohlcType),
     m_lastTimestamp(0),
     m_numLastConsumed(0),
     m_tickSize(1.0),
+    m_invTickSize(1.0),
     m_pricePrecision(1),
-    m_curOhlc(nullptr)
+    m_curOhlc(nullptr),
+    m_highLevel(0),
+    m_lowLevel(0)
 {
     O3D_ASSERT(barSize > 0 && tickScale > 0);
+
+    selectGenTicks();
 }
 
 RangeOhlcGen::~RangeOhlcGen()
@@ -41,96 +49,87 @@ void RangeOhlcGen::init(o3d::Int32 pricePrecision, o3d::Double tickSize)
 
     m_pricePrecision = pricePrecision;
     m_tickSize = tickSize * m_tickScale;  // pre-mult
+    m_invTickSize = 1.0 / m_tickSize;
 }
 
 o3d::UInt32 RangeOhlcGen::genFromTicks(const TickArray &ticks, OhlcCircular &out)
+{
+    return (this->*m_genTicks)(ticks, out, nullptr);
+}
+
+o3d::UInt32 RangeOhlcGen::genFromTicks(const TickArray &ticks, OhlcCircular &out, Analyser &analyser)
+{
+    return (this->*m_genTicksAnalyser)(ticks, out, &analyser);
+}
+
+template <class P, o3d::Bool A>
+o3d::UInt32 RangeOhlcGen::genTicks(const TickArray &ticks, OhlcCircular &out, Analyser *analyser)
 {
     o3d::UInt32 n = 0;
     m_numLastConsumed = 0;
 
-    if (m_ohlcType == Ohlc::TYPE_LAST) {
-        for (o3d::Int32 i = 0; i < ticks.getSize(); ++i) {
-            if (updateFromTickLast(ticks.get(i), out)) {
-                n += 1;
-            }
-        }
-    } else if (m_ohlcType == Ohlc::TYPE_MID) {
-        for (o3d::Int32 i = 0; i < ticks.getSize(); ++i) {
-            if (updateFromTickMid(ticks.get(i), out)) {
-                n += 1;
-            }
-        }
-    } else if (m_ohlcType == Ohlc::TYPE_BID) {
-        for (o3d::Int32 i = 0; i < ticks.getSize(); ++i) {
-            if (updateFromTickBid(ticks.get(i), out)) {
-                n += 1;
-            }
+    for (o3d::Int32 i = 0; i < ticks.getSize(); ++i) {
+        const Tick *lastTick = ticks.get(i);
+        const o3d::Bool newBar = updateFromPrice(lastTick, P::price(lastTick), out);
+
+        if (A) {
+            analyser->updateTick(*lastTick, newBar);
         }
-    } else if (m_ohlcType == Ohlc::TYPE_ASK) {
-        for (o3d::Int32 i = 0; i < ticks.getSize(); ++i) {
-            if (updateFromTickAsk(ticks.get(i), out)) {
-                n += 1;
-            }
+
+        if (newBar) {
+            n += 1;
         }
     }
 
     return n;
 }
 
-o3d::UInt32 RangeOhlcGen::genFromTicks(const TickArray &ticks, OhlcCircular &out, Analyser &analyser)
+void RangeOhlcGen::selectGenTicks()
 {
-    o3d::UInt32 n = 0;
-    m_numLastConsumed = 0;
-
-    o3d::Bool newBar = false;
-
     if (m_ohlcType == Ohlc::TYPE_LAST) {
-        for (o3d::Int32 i = 0; i < ticks.getSize(); ++i) {
-            const Tick *lastTick = ticks.get(i);
-
-            newBar = updateFromTickLast(lastTick, out);
-            analyser.updateTick(*lastTick, newBar);
-
-            if (newBar) {
-                n += 1;
-            }
-        }
-    } else if (m_ohlcType == Ohlc::TYPE_MID) {
-        for (o3d::Int32 i = 0; i < ticks.getSize(); ++i) {
-            const Tick *lastTick = ticks.get(i);
+        m_genTicks = &RangeOhlcGen::genTicks<TickPriceLast, false>;
+        m_genTicksAnalyser = &RangeOhlcGen::genTicks<TickPriceLast, true>;
+    } else if (m_ohlcType == Ohlc::TYPE_BID) {
+        m_genTicks = &RangeOhlcGen::genTicks<TickPriceBid, false>;
+        m_genTicksAnalyser = &RangeOhlcGen::genTicks<TickPriceBid, true>;
+    } else if (m_ohlcType == Ohlc::TYPE_ASK) {
+        m_genTicks = &RangeOhlcGen::genTicks<TickPriceAsk, false>;
+        m_genTicksAnalyser = &RangeOhlcGen::genTicks<TickPriceAsk, true>;
+    } else {
+        m_genTicks = &RangeOhlcGen::genTicks<TickPriceMid, false>;
+        m_genTicksAnalyser = &RangeOhlcGen::genTicks<TickPriceMid, true>;
+    }
+}
 
-            newBar = updateFromTickMid(lastTick, out);
-            analyser.updateTick(*lastTick, newBar);
+void RangeOhlcGen::saveState(SnapshotWriter &writer) const
+{
+    writer.writeDouble(m_lastTimestamp);
+    writer.writeInt32(static_cast<o3d::Int32>(m_numLastConsumed));
+    writer.writeBool(m_curOhlc != nullptr);
+}
 
-            if (newBar) {
-                n += 1;
-            }
-        }
-    } else if (m_ohlcType == Ohlc::TYPE_BID) {
-        for (o3d::Int32 i = 0; i < ticks.getSize(); ++i) {
-            const Tick *lastTick = ticks.get(i);
+o3d::Bool RangeOhlcGen::loadState(SnapshotReader &reader, OhlcCircular &out)
+{
+    o3d::Double lastTimestamp = reader.readDouble();
+    o3d::Int32 numLastConsumed = reader.readInt32();
+    o3d::Bool hasCurrent = reader.readBool();
 
-            newBar = updateFromTickBid(lastTick, out);
-            analyser.updateTick(*lastTick, newBar);
+    if (reader.failed() || (hasCurrent && out.size() == 0)) {
+        return false;
+    }
 
-            if (newBar) {
-                n += 1;
-            }
-        }
-    } else if (m_ohlcType == Ohlc::TYPE_ASK) {
-        for (o3d::Int32 i = 0; i < ticks.getSize(); ++i) {
-            const Tick *lastTick = ticks.get(i);
+    m_lastTimestamp = lastTimestamp;
+    m_numLastConsumed = static_cast<o3d::UInt32>(numLastConsumed);
 
-            newBar = updateFromTickAsk(lastTick, out);
-            analyser.updateTick(*lastTick, newBar);
+    // the current non consolidated bar is the last one of out
+    m_curOhlc = hasCurrent ? out.lastElt() : nullptr;
 
-            if (newBar) {
-                n += 1;
-            }
-        }
+    if (m_curOhlc) {
+        m_highLevel = tickLevel(m_curOhlc->high(), m_invTickSize);
+        m_lowLevel = tickLevel(m_curOhlc->low(), m_invTickSize);
     }
 
-    return n;
+    return true;
 }
 
 o3d::Bool RangeOhlcGen::valid() const
@@ -152,187 +151,29 @@ o3d::Bool RangeOhlcGen::valid() const
 
 o3d::Bool RangeOhlcGen::updateFromTickMid(const Tick *tick, OhlcCircular &out)
 {
-    o3d::Bool isNew = false;
-
-    if (tick->timestamp() <= m_lastTimestamp) {
-        // already done (but what if two consecutives ticks have the same exact timestamp ?)
-        return false;
-    }
-
     // compute the middle price
-    const o3d::Double price = tick->price();  // last()
-
-    if (m_curOhlc) {
-        // is the price extend the size of the range-bar outside its allowed range
-        if (price > m_curOhlc->high()) {
-            o3d::Int32 size = static_cast<o3d::Int32>((price - m_curOhlc->low()) / m_tickSize);
-            if (size > m_barSize) {
-                m_curOhlc->setConsolidated();
-                m_curOhlc = nullptr;
-            }
-        } else if (price < m_curOhlc->low()) {
-            o3d::Int32 size = static_cast<o3d::Int32>((m_curOhlc->high() - price) / m_tickSize);
-            if (size > m_barSize) {
-                m_curOhlc->setConsolidated();
-                m_curOhlc = nullptr;
-            }
-        }
-    }
-
-    if (!m_curOhlc) {
-        // have a new ohlc, and init a new one as current
-        isNew = true;
-        m_curOhlc = out.writeElt();
-
-        m_curOhlc->setTimestamp(tick->timestamp());
-        m_curOhlc->setDuration(0.0);
-
-        // all OHLC from the current price
-        m_curOhlc->setOhlc(price);
-        m_curOhlc->setVolume(0.0);
-    }
-
-    // update volumes
-    m_curOhlc->setVolume(m_curOhlc->volume() + tick->volume());
-
-    // bid high/low
-    m_curOhlc->setH(o3d::max(m_curOhlc->h(), price));
-    m_curOhlc->setL(o3d::min(m_curOhlc->l(), price));
-
-    // potential close
-    m_curOhlc->setC(price);
-
-    // bar duration
-    m_curOhlc->setDuration(tick->timestamp() - m_curOhlc->timestamp());
-
-    // keep last timestamp
-    m_lastTimestamp = tick->timestamp();
-
-    return isNew;
+    return updateFromPrice(tick, tick->price(), out);
 }
 
 o3d::Bool RangeOhlcGen::updateFromTickLast(const Tick *tick, OhlcCircular &out)
 {
-    o3d::Bool isNew = false;
-
-    if (tick->timestamp() <= m_lastTimestamp) {
-        // already done (but what if two consecutives ticks have the same exact timestamp ?)
-        return false;
-    }
-
     // compute the last traded price
-    const o3d::Double price = tick->last();
-
-    if (m_curOhlc) {
-        // is the price extend the size of the range-bar outside its allowed range
-        if (price > m_curOhlc->high()) {
-            o3d::Int32 size = static_cast<o3d::Int32>((price - m_curOhlc->low()) / m_tickSize);
-            if (size > m_barSize) {
-                m_curOhlc->setConsolidated();
-                m_curOhlc = nullptr;
-            }
-        } else if (price < m_curOhlc->low()) {
-            o3d::Int32 size = static_cast<o3d::Int32>((m_curOhlc->high() - price) / m_tickSize);
-            if (size > m_barSize) {
-                m_curOhlc->setConsolidated();
-                m_curOhlc = nullptr;
-            }
-        }
-    }
-
-    if (!m_curOhlc) {
-        // have a new ohlc, and init a new one as current
-        isNew = true;
-        m_curOhlc = out.writeElt();
-
-        m_curOhlc->setTimestamp(tick->timestamp());
-        m_curOhlc->setDuration(0.0);
-
-        // all OHLC from the current price
-        m_curOhlc->setOhlc(price);
-        m_curOhlc->setVolume(0.0);
-    }
-
-    // update volumes
-    m_curOhlc->setVolume(m_curOhlc->volume() + tick->volume());
-
-    // bid high/low
-    m_curOhlc->setH(o3d::max(m_curOhlc->h(), price));
-    m_curOhlc->setL(o3d::min(m_curOhlc->l(), price));
-
-    // potential close
-    m_curOhlc->setC(price);
-
-    // bar duration
-    m_curOhlc->setDuration(tick->timestamp() - m_curOhlc->timestamp());
-
-    // keep last timestamp
-    m_lastTimestamp = tick->timestamp();
-
-    return isNew;
+    return updateFromPrice(tick, tick->last(), out);
 }
 
 o3d::Bool RangeOhlcGen::updateFromTickBid(const Tick *tick, OhlcCircular &out)
 {
-    o3d::Bool isNew = false;
-
-    if (tick->timestamp() <= m_lastTimestamp) {
-        // already done (but what if two consecutives ticks have the same exact timestamp ?)
-        return false;
-    }
-
     // the bid price
-    const o3d::Double price = tick->bid();
-    if (m_curOhlc) {
-        // is the price extend the size of the range-bar outside its allowed range
-        if (price > m_curOhlc->high()) {
-            o3d::Int32 size = static_cast<o3d::Int32>((price - m_curOhlc->low()) / m_tickSize);
-            if (size > m_barSize) {
-                m_curOhlc->setConsolidated();
-                m_curOhlc = nullptr;
-            }
-        } else if (price < m_curOhlc->low()) {
-            o3d::Int32 size = static_cast<o3d::Int32>((m_curOhlc->high() - price) / m_tickSize);
-            if (size > m_barSize) {
-                m_curOhlc->setConsolidated();
-                m_curOhlc = nullptr;
-            }
-        }
-    }
-
-    if (!m_curOhlc) {
-        // have a new ohlc, and init a new one as current
-        isNew = true;
-        m_curOhlc = out.writeElt();
-
-        m_curOhlc->setTimestamp(tick->timestamp());
-        m_curOhlc->setDuration(0.0);
-
-        // all OHLC from the current price
-        m_curOhlc->setOhlc(price);
-        m_curOhlc->setVolume(0.0);
-    }
-
-    // update volumes
-    m_curOhlc->setVolume(m_curOhlc->volume() + tick->volume());
-
-    // bid high/low
-    m_curOhlc->setH(o3d::max(m_curOhlc->h(), price));
-    m_curOhlc->setL(o3d::min(m_curOhlc->l(), price));
-
-    // potential close
-    m_curOhlc->setC(price);
-
-    // bar duration
-    m_curOhlc->setDuration(tick->timestamp() - m_curOhlc->timestamp());
-
-    // keep last timestamp
-    m_lastTimestamp = tick->timestamp();
-
-    return isNew;
+    return updateFromPrice(tick, tick->bid(), out);
 }
 
 o3d::Bool RangeOhlcGen::updateFromTickAsk(const Tick *tick, OhlcCircular &out)
+{
+    // the ask price
+    return updateFromPrice(tick, tick->ask(), out);
+}
+
+o3d::Bool RangeOhlcGen::updateFromPrice(const Tick *tick, o3d::Double price, OhlcCircular &out)
 {
     o3d::Bool isNew = false;
 
@@ -341,19 +182,17 @@ o3d::Bool RangeOhlcGen::updateFromTickAsk(const Tick *tick, OhlcCircular &out)
         return false;
     }
 
-    // the ask price
-    const o3d::Double price = tick->ask();
+    const o3d::Int64 level = tickLevel(price, m_invTickSize);
+
     if (m_curOhlc) {
         // is the price extend the size of the range-bar outside its allowed range
-        if (price > m_curOhlc->high()) {
-            o3d::Int32 size = static_cast<o3d::Int32>((price - m_curOhlc->low()) / m_tickSize);
-            if (size > m_barSize) {
+        if (level > m_highLevel) {
+            if (level - m_lowLevel > m_barSize) {
                 m_curOhlc->setConsolidated();
                 m_curOhlc = nullptr;
             }
-        } else if (price < m_curOhlc->low()) {
-            o3d::Int32 size = static_cast<o3d::Int32>((m_curOhlc->high() - price) / m_tickSize);
-            if (size > m_barSize) {
+        } else if (level < m_lowLevel) {
+            if (m_highLevel - level > m_barSize) {
                 m_curOhlc->setConsolidated();
                 m_curOhlc = nullptr;
             }
@@ -371,12 +210,20 @@ o3d::Bool RangeOhlcGen::updateFromTickAsk(const Tick *tick, OhlcCircular &out)
         // all OHLC from the current price
         m_curOhlc->setOhlc(price);
         m_curOhlc->setVolume(0.0);
+
+        m_highLevel = m_lowLevel = level;
     }
 
     // update volumes
     m_curOhlc->setVolume(m_curOhlc->volume() + tick->volume());
 
     // bid high/low
+    if (level > m_highLevel) {
+        m_highLevel = level;
+    } else if (level < m_lowLevel) {
+        m_lowLevel = level;
+    }
+
     m_curOhlc->setH(o3d::max(m_curOhlc->h(), price));
     m_curOhlc->setL(o3d::min(m_curOhlc->l(), price));
 
@@ -391,12 +238,3 @@ o3d::Bool RangeOhlcGen::updateFromTickAsk(const Tick *tick, OhlcCircular &out)
 
     return isNew;
 }
-
-o3d::Double RangeOhlcGen::adjustPrice(o3d::Double price) const
-{
-    if (price == 0.0) {
-        return 0.0;
-    }
-
-    return truncate(::round(price / m_tickSize) * m_tickSize, m_pricePrecision);
-}
@@ -0,0 +1,174 @@
+/**
+ * @brief SiiS streaming rolling minimum or maximum.
+ * @copyright Copyright (C) 2024 SiiS
+ * @author Frederic SCHERMA (frederic.scherma@gmail.com)
+ * @date 2024-10-18
+ */
+
+#include "siis/utils/rollingextremum.h"
+#include "siis/utils/snapshot.h"
+
+#include <cstring>
+
+using namespace siis;
+
+RollingExtremum::RollingExtremum(Mode mode, o3d::Int32 len) :
+    m_mode(mode),
+    m_len(0),
+    m_head(0),
+    m_size(0),
+    m_count(0)
+{
+    setLen(len);
+}
+
+void RollingExtremum::setLen(o3d::Int32 len)
+{
+    m_len = o3d::max(len, 1);
+    m_items.assign(static_cast<size_t>(m_len), Item());
+
+    reset();
+}
+
+void RollingExtremum::reset()
+{
+    m_head = 0;
+    m_size = 0;
+    m_count = 0;
+
+    // the next compute is a full one
+    m_prev.setSize(0);
+}
+
+void RollingExtremum::saveState(SnapshotWriter &writer) const
+{
+    writer.writeInt32(static_cast<o3d::Int32>(m_mode));
+    writer.writeInt32(m_len);
+
+    writer.writeInt32(m_count);
+    writer.writeInt32(static_cast<o3d::Int32>(m_size));
+
+    // from the front of the deque
+    for (size_t i = 0; i < m_size; ++i) {
+        const Item &item = m_items[(m_head + i) % m_items.size()];
+
+        writer.writeInt32(item.pos);
+        writer.writeDouble(item.value);
+    }
+}
+
+o3d::Bool RollingExtremum::loadState(SnapshotReader &reader)
+{
+    if (reader.readInt32() != static_cast<o3d::Int32>(m_mode) || reader.readInt32() != m_len) {
+        return false;
+    }
+
+    reset();
+
+    m_count = reader.readInt32();
+
+    const o3d::Int32 size = reader.readInt32();
+    if (reader.failed() || size < 0 || size > m_len) {
+        reset();
+        return false;
+    }
+
+    for (o3d::Int32 i = 0; i < size; ++i) {
+        m_items[static_cast<size_t>(i)].pos = reader.readInt32();
+        m_items[static_cast<size_t>(i)].value = reader.readDouble();
+    }
+
+    m_size = static_cast<size_t>(size);
+
+    return !reader.failed();
+}
+
+void RollingExtremum::push(o3d::Double value)
+{
+    const size_t capacity = m_items.size();
+
+    // the previous values dominated by this one can no longer be an extremum
+    while (m_size > 0) {
+        const Item &back = m_items[(m_head + m_size - 1) % capacity];
+        if (m_mode == MODE_MAX ? back.value > value : back.value < value) {
+            break;
+        }
+
+        --m_size;
+    }
+
+    Item &item = m_items[(m_head + m_size) % capacity];
+    item.pos = m_count++;
+    item.value = value;
+    ++m_size;
+
+    // keep the last len-1 closed values, the last value of a window is the forming one
+    while (m_size > 0 && m_items[m_head].pos <= m_count - m_len) {
+        m_head = (m_head + 1) % capacity;
+        --m_size;
+    }
+}
+
+o3d::Int32 RollingExtremum::compute(const DataArray &in)
+{
+    const o3d::Int32 size = in.getSize();
+    if (size <= 0) {
+        return 0;
+    }
+
+    if (m_values.getSize() != size) {
+        m_values.setSize(size);
+    }
+
+    // number of new bars since the previous array, its closed values being the same
+    o3d::Int32 shift = -1;
+
+    if (m_prev.getSize() == size) {
+        const o3d::Int32 maxShift = o3d::min(MAX_SHIFT, size - 1);
+
+        for (o3d::Int32 k = 0; k <= maxShift; ++k) {
+            const size_t bytes = static_cast<size_t>(size - 1 - k) * sizeof(o3d::Double);
+            if (memcmp(in.getData(), m_prev.getData() + k, bytes) == 0) {
+                shift = k;
+                break;
+            }
+        }
+    }
+
+    o3d::Int32 from = 0;
+
+    if (shift < 0) {
+        m_head = 0;
+        m_size = 0;
+        m_count = 0;
+    } else {
+        if (shift > 0) {
+            // results of the windows of the same values, the deque is relative to the stream
+            memmove(m_values.getData(), m_values.getData() + shift, static_cast<size_t>(size - shift) * sizeof(o3d::Double));
+        }
+
+        // the previous forming bar and the new bars
+        from = size - 1 - shift;
+    }
+
+    const o3d::Double *data = in.getData();
+    o3d::Double *values = m_values.getData();
+
+    for (o3d::Int32 i = from; i < size; ++i) {
+        if (i >= m_len - 1) {
+            values[i] = provisional(data[i]);
+        }
+
+        if (i < size - 1) {
+            push(data[i]);
+        }
+    }
+
+    if (m_prev.getSize() != size) {
+        m_prev.setSize(size);
+    }
+
+    memcpy(m_prev.getData(), data, static_cast<size_t>(size) * sizeof(o3d::Double));
+
+    return from;
+}
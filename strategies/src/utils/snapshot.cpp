@@ -0,0 +1,296 @@
+/**
+ * @brief SiiS strategy binary snapshot of states.
+ * @copyright Copyright (C) 2024 SiiS
+ * @author Frederic SCHERMA (frederic.scherma@gmail.com)
+ * @date 2024-10-12
+ */
+
+#include "siis/utils/snapshot.h"
+#include "siis/utils/common.h"
+
+#include <o3d/core/debug.h>
+
+#include <cstdio>
+#include <cstring>
+
+#include <unistd.h>
+
+using namespace siis;
+using o3d::Debug;
+using o3d::Logger;
+
+namespace {
+
+const char MAGIC[8] = {'S', 'I', 'I', 'S', 'S', 'N', 'A', 'P'};
+
+struct Header
+{
+    char magic[8];
+    o3d::UInt32 version;
+    o3d::UInt32 crc;
+    o3d::UInt64 size;
+};
+
+} // anonymous namespace
+
+SnapshotWriter::SnapshotWriter()
+{
+    m_data.reserve(65536);
+}
+
+void SnapshotWriter::write(const void *data, size_t size)
+{
+    const o3d::UInt8 *p = reinterpret_cast<const o3d::UInt8*>(data);
+    m_data.insert(m_data.end(), p, p + size);
+}
+
+void SnapshotWriter::writeBool(o3d::Bool value)
+{
+    o3d::UInt8 v = value ? 1 : 0;
+    write(&v, 1);
+}
+
+void SnapshotWriter::writeInt32(o3d::Int32 value)
+{
+    write(&value, sizeof(o3d::Int32));
+}
+
+void SnapshotWriter::writeInt64(o3d::Int64 value)
+{
+    write(&value, sizeof(o3d::Int64));
+}
+
+void SnapshotWriter::writeDouble(o3d::Double value)
+{
+    write(&value, sizeof(o3d::Double));
+}
+
+void SnapshotWriter::writeDoubles(const o3d::Double *values, o3d::Int32 count)
+{
+    writeInt32(count);
+
+    if (count > 0) {
+        write(values, sizeof(o3d::Double) * static_cast<size_t>(count));
+    }
+}
+
+void SnapshotWriter::writeString(const o3d::String &value)
+{
+    o3d::CString utf8 = value.toUtf8();
+
+    writeInt32(utf8.length());
+    write(utf8.getData(), static_cast<size_t>(utf8.length()));
+}
+
+void SnapshotWriter::writeArray(const DataArray &array)
+{
+    writeDoubles(array.getData(), array.getSize());
+}
+
+void SnapshotWriter::writeCircular(const DataCircular &circular)
+{
+    writeInt32(circular.size());
+
+    for (auto cit = circular.cbegin(); cit != circular.cend(); ++cit) {
+        writeDouble(*cit);
+    }
+}
+
+o3d::Bool SnapshotWriter::save(const o3d::String &filename) const
+{
+    Header header;
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.crc = crc32(m_data.data(), m_data.size());
+    header.size = m_data.size();
+
+    // write to a temporary file then rename, never a partial snapshot
+    o3d::CString path = filename.toUtf8();
+
+    char suffix[32];
+    snprintf(suffix, sizeof(suffix), ".tmp.%i", static_cast<int>(::getpid()));
+
+    std::string tmpName(path.getData());
+    tmpName += suffix;
+
+    FILE *f = ::fopen(tmpName.c_str(), "wb");
+    if (!f) {
+        ERR("snapshot", o3d::String("Unable to create snapshot {0}").arg(filename));
+        return false;
+    }
+
+    o3d::Bool ok = ::fwrite(&header, sizeof(Header), 1, f) == 1;
+    if (ok && !m_data.empty()) {
+        ok = ::fwrite(m_data.data(), m_data.size(), 1, f) == 1;
+    }
+
+    ok = (::fclose(f) == 0) && ok;
+
+    if (!ok || ::rename(tmpName.c_str(), path.getData()) != 0) {
+        ::unlink(tmpName.c_str());
+        ERR("snapshot", o3d::String("Unable to write snapshot {0}").arg(filename));
+        return false;
+    }
+
+    return true;
+}
+
+SnapshotReader::SnapshotReader() :
+    m_pos(0),
+    m_failed(false)
+{
+
+}
+
+o3d::Bool SnapshotReader::load(const o3d::String &filename)
+{
+    m_data.clear();
+    m_pos = 0;
+    m_failed = true;
+
+    FILE *f = ::fopen(filename.toUtf8().getData(), "rb");
+    if (!f) {
+        return false;
+    }
+
+    Header header;
+    o3d::Bool ok = ::fread(&header, sizeof(Header), 1, f) == 1;
+
+    if (ok && memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+        WARN("snapshot", o3d::String("Invalid snapshot {0}").arg(filename));
+        ok = false;
+    }
+
+    if (ok && header.version != SnapshotWriter::VERSION) {
+        WARN("snapshot", o3d::String("Unsupported snapshot version {0} for {1}").arg(header.version).arg(filename));
+        ok = false;
+    }
+
+    if (ok) {
+        m_data.resize(static_cast<size_t>(header.size));
+        ok = m_data.empty() || ::fread(m_data.data(), m_data.size(), 1, f) == 1;
+
+        if (!ok) {
+            WARN("snapshot", o3d::String("Truncated snapshot {0}").arg(filename));
+        }
+    }
+
+    ::fclose(f);
+
+    if (ok && crc32(m_data.data(), m_data.size()) != header.crc) {
+        WARN("snapshot", o3d::String("Corrupted snapshot {0}").arg(filename));
+        ok = false;
+    }
+
+    if (!ok) {
+        m_data.clear();
+        return false;
+    }
+
+    m_failed = false;
+    return true;
+}
+
+void SnapshotReader::load(const SnapshotWriter &writer)
+{
+    m_data = writer.data();
+    m_pos = 0;
+    m_failed = false;
+}
+
+o3d::Bool SnapshotReader::read(void *data, size_t size)
+{
+    if (m_failed || m_pos + size > m_data.size()) {
+        m_failed = true;
+        memset(data, 0, size);
+        return false;
+    }
+
+    memcpy(data, m_data.data() + m_pos, size);
+    m_pos += size;
+
+    return true;
+}
+
+o3d::Bool SnapshotReader::readBool()
+{
+    o3d::UInt8 v = 0;
+    read(&v, 1);
+    return v != 0;
+}
+
+o3d::Int32 SnapshotReader::readInt32()
+{
+    o3d::Int32 v = 0;
+    read(&v, sizeof(o3d::Int32));
+    return v;
+}
+
+o3d::Int64 SnapshotReader::readInt64()
+{
+    o3d::Int64 v = 0;
+    read(&v, sizeof(o3d::Int64));
+    return v;
+}
+
+o3d::Double SnapshotReader::readDouble()
+{
+    o3d::Double v = 0.0;
+    read(&v, sizeof(o3d::Double));
+    return v;
+}
+
+o3d::Bool SnapshotReader::readDoubles(o3d::Double *values, o3d::Int32 count)
+{
+    // the stored count must match the expected one
+    if (readInt32() != count || count < 0) {
+        m_failed = true;
+        return false;
+    }
+
+    return count == 0 || read(values, sizeof(o3d::Double) * static_cast<size_t>(count));
+}
+
+o3d::String SnapshotReader::readString()
+{
+    o3d::Int32 len = readInt32();
+    if (len < 0 || m_failed || m_pos + static_cast<size_t>(len) > m_data.size()) {
+        m_failed = true;
+        return o3d::String();
+    }
+
+    o3d::CString utf8(reinterpret_cast<const char*>(m_data.data() + m_pos), len);
+    m_pos += static_cast<size_t>(len);
+
+    return o3d::String(utf8);
+}
+
+o3d::Bool SnapshotReader::readArray(DataArray &array)
+{
+    o3d::Int32 count = readInt32();
+    if (m_failed || count < 0 || m_pos + sizeof(o3d::Double) * static_cast<size_t>(count) > m_data.size()) {
+        m_failed = true;
+        return false;
+    }
+
+    array.setSize(count);
+
+    return count == 0 || read(array.getData(), sizeof(o3d::Double) * static_cast<size_t>(count));
+}
+
+o3d::Bool SnapshotReader::readCircular(DataCircular &circular)
+{
+    o3d::Int32 count = readInt32();
+    if (m_failed || count < 0 || count > circular.capacity()) {
+        m_failed = true;
+        return false;
+    }
+
+    circular.clear();
+
+    for (o3d::Int32 i = 0; i < count; ++i) {
+        circular.append(readDouble());
+    }
+
+    return !m_failed;
+}
@@ -0,0 +1,157 @@
+/**
+ * @brief SiiS strategy multi-timeframe bar cascade.
+ * @copyright Copyright (C) 2024 SiiS
+ * @author Frederic SCHERMA (frederic.scherma@gmail.com)
+ * @date 2024-10-18
+ */
+
+#include "siis/utils/timeframecascade.h"
+#include "siis/analysers/timeframebaranalyser.h"
+
+#include <algorithm>
+
+using namespace siis;
+
+TimeframeCascade::TimeframeCascade(Ohlc::Type ohlcType) :
+    m_ohlcType(ohlcType),
+    m_baseTf(0.0),
+    m_ohlcGen(0.0, 0.0, ohlcType),
+    m_ohlc(2),
+    m_bars(100),
+    m_updateTicks(&TimeframeCascade::updateTicks<TickPriceMid>)
+{
+    if (ohlcType == Ohlc::TYPE_LAST) {
+        m_updateTicks = &TimeframeCascade::updateTicks<TickPriceLast>;
+    } else if (ohlcType == Ohlc::TYPE_BID) {
+        m_updateTicks = &TimeframeCascade::updateTicks<TickPriceBid>;
+    } else if (ohlcType == Ohlc::TYPE_ASK) {
+        m_updateTicks = &TimeframeCascade::updateTicks<TickPriceAsk>;
+    }
+}
+
+TimeframeCascade::~TimeframeCascade()
+{
+
+}
+
+void TimeframeCascade::add(TimeframeBarAnalyser *analyser)
+{
+    if (!analyser || std::find(m_added.begin(), m_added.end(), analyser) != m_added.end()) {
+        return;
+    }
+
+    m_added.push_back(analyser);
+
+    // the base timeframe could be lower
+    setup();
+}
+
+void TimeframeCascade::remove(TimeframeBarAnalyser *analyser)
+{
+    auto it = std::find(m_added.begin(), m_added.end(), analyser);
+    if (it == m_added.end()) {
+        return;
+    }
+
+    detach();
+    m_added.erase(it);
+
+    setup();
+}
+
+void TimeframeCascade::setup()
+{
+    detach();
+
+    m_baseTf = 0.0;
+
+    for (TimeframeBarAnalyser *analyser : m_added) {
+        if (analyser->timeframe() >= 1.0 && (m_baseTf == 0.0 || analyser->timeframe() < m_baseTf)) {
+            m_baseTf = analyser->timeframe();
+        }
+    }
+
+    if (m_baseTf == 0.0) {
+        return;
+    }
+
+    m_ohlcGen = TimeframeOhlcGen(0.0, m_baseTf, m_ohlcType);
+
+    for (TimeframeBarAnalyser *analyser : m_added) {
+        if (analyser->timeframe() >= 1.0 &&
+            static_cast<o3d::Int32>(analyser->timeframe()) % static_cast<o3d::Int32>(m_baseTf) == 0) {
+
+            analyser->attachCascade(this);
+
+            m_analysers.push_back(analyser);
+            m_barTimestamps.push_back(0.0);
+        }
+    }
+}
+
+void TimeframeCascade::clear()
+{
+    detach();
+    m_added.clear();
+}
+
+void TimeframeCascade::detach()
+{
+    for (TimeframeBarAnalyser *analyser : m_analysers) {
+        analyser->attachCascade(nullptr);
+    }
+
+    m_analysers.clear();
+    m_barTimestamps.clear();
+
+    m_ohlc.clear();
+    m_bars.clear();
+}
+
+void TimeframeCascade::onTickUpdate(o3d::Double timestamp, const TickArray &ticks)
+{
+    m_bars.clear();
+
+    if (m_analysers.empty() || ticks.getSize() == 0) {
+        return;
+    }
+
+    (this->*m_updateTicks)(ticks);
+
+    // plus the current one
+    if (m_ohlcGen.current()) {
+        m_bars.push(*m_ohlcGen.current());
+    }
+}
+
+template <class P>
+void TimeframeCascade::updateTicks(const TickArray &ticks)
+{
+    const o3d::Int32 numAnalysers = static_cast<o3d::Int32>(m_analysers.size());
+
+    for (o3d::Int32 i = 0; i < ticks.getSize(); ++i) {
+        const Tick *tick = ticks.get(i);
+
+        // the previous base bar, finished when a new one starts
+        const Ohlc *prevOhlc = m_ohlcGen.current();
+
+        if (m_ohlcGen.updateFromTick<P>(tick, m_ohlc)) {
+            if (prevOhlc) {
+                m_bars.push(*prevOhlc);
+            }
+
+            // a bar of an analyser can only finish with a base bar
+            for (o3d::Int32 j = 0; j < numAnalysers; ++j) {
+                const o3d::Double barTimestamp = siis::baseTime(tick->timestamp(), m_analysers[j]->timeframe());
+                const o3d::Bool finalize = barTimestamp != m_barTimestamps[j];
+
+                m_barTimestamps[j] = barTimestamp;
+                m_analysers[j]->updateTick(*tick, finalize);
+            }
+        } else {
+            for (o3d::Int32 j = 0; j < numAnalysers; ++j) {
+                m_analysers[j]->updateTick(*tick, false);
+            }
+        }
+    }
+}
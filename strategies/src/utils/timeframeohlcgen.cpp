@@ -7,18 +7,28 @@
 
 #include "siis/utils/timeframeohlcgen.h"
 #include "siis/analysers/analyser.h"
+#include "siis/utils/snapshot.h"
 
 using namespace siis;
 
 TimeframeOhlcGen::TimeframeOhlcGen(o3d::Double fromTf, o3d::Double toTf, Ohlc::Type ohlcType) :
+    m_genTicks(nullptr),
+    m_genTicksAnalyser(nullptr),
     m_fromTf(fromTf),
     m_toTf(toTf),
     m_ohlcType(ohlcType),
     m_lastTimestamp(0),
     m_numLastConsumed(0),
-    m_curOhlc(nullptr)
+    m_curOhlc(nullptr),
+    m_hasMerged(false),
+    m_mergedOpen(0.0),
+    m_mergedHigh(0.0),
+    m_mergedLow(0.0),
+    m_mergedVolume(0.0)
 {
     O3D_ASSERT((fromTf == 0.0) || (fromTf > 0 && static_cast<o3d::Int32>(toTf) % static_cast<o3d::Int32>(fromTf) == 0));
+
+    selectGenTicks();
 }
 
 TimeframeOhlcGen::~TimeframeOhlcGen()
@@ -28,92 +38,51 @@ TimeframeOhlcGen::~TimeframeOhlcGen()
 
 o3d::UInt32 TimeframeOhlcGen::genFromTicks(const TickArray &ticks, OhlcCircular &out)
 {
-    o3d::UInt32 n = 0;
-    m_numLastConsumed = 0;
-
-    if (m_ohlcType == Ohlc::TYPE_LAST) {
-        for (o3d::Int32 i = 0; i < ticks.getSize(); ++i) {
-            if (updateFromTickLast(ticks.get(i), out)) {
-                n += 1;
-            }
-        }
-    } else if (m_ohlcType == Ohlc::TYPE_MID) {
-        for (o3d::Int32 i = 0; i < ticks.getSize(); ++i) {
-            if (updateFromTickMid(ticks.get(i), out)) {
-                n += 1;
-            }
-        }
-    } else if (m_ohlcType == Ohlc::TYPE_BID) {
-        for (o3d::Int32 i = 0; i < ticks.getSize(); ++i) {
-            if (updateFromTickBid(ticks.get(i), out)) {
-                n += 1;
-            }
-        }
-    } else if (m_ohlcType == Ohlc::TYPE_ASK) {
-        for (o3d::Int32 i = 0; i < ticks.getSize(); ++i) {
-            if (updateFromTickAsk(ticks.get(i), out)) {
-                n += 1;
-            }
-        }
-    }
-
-    return n;
+    return (this->*m_genTicks)(ticks, out, nullptr);
 }
 
 o3d::UInt32 TimeframeOhlcGen::genFromTicks(const TickArray &ticks, OhlcCircular &out, Analyser &analyser)
+{
+    return (this->*m_genTicksAnalyser)(ticks, out, &analyser);
+}
+
+template <class P, o3d::Bool A>
+o3d::UInt32 TimeframeOhlcGen::genTicks(const TickArray &ticks, OhlcCircular &out, Analyser *analyser)
 {
     o3d::UInt32 n = 0;
     m_numLastConsumed = 0;
 
-    o3d::Bool newBar = false;
-
-    if (m_ohlcType == Ohlc::TYPE_LAST) {
-        for (o3d::Int32 i = 0; i < ticks.getSize(); ++i) {
-            const Tick *lastTick = ticks.get(i);
-
-            newBar = updateFromTickLast(lastTick, out);
-            analyser.updateTick(*lastTick, newBar);
+    for (o3d::Int32 i = 0; i < ticks.getSize(); ++i) {
+        const Tick *lastTick = ticks.get(i);
+        const o3d::Bool newBar = updateFromTick<P>(lastTick, out);
 
-            if (newBar) {
-                n += 1;
-            }
+        if (A) {
+            analyser->updateTick(*lastTick, newBar);
         }
-    } else if (m_ohlcType == Ohlc::TYPE_MID) {
-        for (o3d::Int32 i = 0; i < ticks.getSize(); ++i) {
-            const Tick *lastTick = ticks.get(i);
 
-            newBar = updateFromTickMid(lastTick, out);
-            analyser.updateTick(*lastTick, newBar);
-
-            if (newBar) {
-                n += 1;
-            }
+        if (newBar) {
+            n += 1;
         }
-    } else if (m_ohlcType == Ohlc::TYPE_BID) {
-        for (o3d::Int32 i = 0; i < ticks.getSize(); ++i) {
-            const Tick *lastTick = ticks.get(i);
+    }
 
-            newBar = updateFromTickBid(lastTick, out);
-            analyser.updateTick(*lastTick, newBar);
+    return n;
+}
 
-            if (newBar) {
-                n += 1;
-            }
-        }
+void TimeframeOhlcGen::selectGenTicks()
+{
+    if (m_ohlcType == Ohlc::TYPE_LAST) {
+        m_genTicks = &TimeframeOhlcGen::genTicks<TickPriceLast, false>;
+        m_genTicksAnalyser = &TimeframeOhlcGen::genTicks<TickPriceLast, true>;
+    } else if (m_ohlcType == Ohlc::TYPE_BID) {
+        m_genTicks = &TimeframeOhlcGen::genTicks<TickPriceBid, false>;
+        m_genTicksAnalyser = &TimeframeOhlcGen::genTicks<TickPriceBid, true>;
     } else if (m_ohlcType == Ohlc::TYPE_ASK) {
-        for (o3d::Int32 i = 0; i < ticks.getSize(); ++i) {
-            const Tick *lastTick = ticks.get(i);
-
-            newBar = updateFromTickAsk(lastTick, out);
-            analyser.updateTick(*lastTick, newBar);
-
-            if (newBar) {
-                n += 1;
-            }
-        }
+        m_genTicks = &TimeframeOhlcGen::genTicks<TickPriceAsk, false>;
+        m_genTicksAnalyser = &TimeframeOhlcGen::genTicks<TickPriceAsk, true>;
+    } else {
+        m_genTicks = &TimeframeOhlcGen::genTicks<TickPriceMid, false>;
+        m_genTicksAnalyser = &TimeframeOhlcGen::genTicks<TickPriceMid, true>;
     }
-
-    return n;
 }
 
 o3d::UInt32 TimeframeOhlcGen::genFromOhlc(const OhlcArray &ohlc, OhlcCircular &out)
@@ -121,29 +90,10 @@ o3d::UInt32 TimeframeOhlcGen::genFromOhlc(const OhlcArray &ohlc, OhlcCircular &o
     o3d::UInt32 n = 0;
     m_numLastConsumed = 0;
 
-    if (m_ohlcType == Ohlc::TYPE_LAST) {
-        for (o3d::Int32 i = 0; i < ohlc.getSize(); ++i) {
-            if (updateFromOhlcLast(ohlc.get(i), out)) {
-                n += 1;
-            }
-        }
-    } else if (m_ohlcType == Ohlc::TYPE_MID) {
-        for (o3d::Int32 i = 0; i < ohlc.getSize(); ++i) {
-            if (updateFromOhlcMid(ohlc.get(i), out)) {
-                n += 1;
-            }
-        }
-    } else if (m_ohlcType == Ohlc::TYPE_BID) {
-        for (o3d::Int32 i = 0; i < ohlc.getSize(); ++i) {
-            if (updateFromOhlcBid(ohlc.get(i), out)) {
-                n += 1;
-            }
-        }
-    } else if (m_ohlcType == Ohlc::TYPE_ASK) {
-        for (o3d::Int32 i = 0; i < ohlc.getSize(); ++i) {
-            if (updateFromOhlcAsk(ohlc.get(i), out)) {
-                n += 1;
-            }
+    // the source bars are already of the ohlc type
+    for (o3d::Int32 i = 0; i < ohlc.getSize(); ++i) {
+        if (updateFromOhlc(ohlc.get(i), out)) {
+            n += 1;
         }
     }
 
@@ -157,51 +107,57 @@ o3d::UInt32 TimeframeOhlcGen::genFromOhlc(const OhlcArray &ohlc, OhlcCircular &o
 
     o3d::Bool newBar = false;
 
-    if (m_ohlcType == Ohlc::TYPE_LAST) {
-        for (o3d::Int32 i = 0; i < ohlc.getSize(); ++i) {
-            const Ohlc *lastBar = ohlc.get(i);
-            newBar = updateFromOhlcLast(ohlc.get(i), out);
-            analyser.updateBar(*lastBar, newBar);
-
-            if (newBar) {
-                n += 1;
-            }
-        }
-    } else if (m_ohlcType == Ohlc::TYPE_MID) {
-        for (o3d::Int32 i = 0; i < ohlc.getSize(); ++i) {
-            const Ohlc *lastBar = ohlc.get(i);
-            newBar = updateFromOhlcMid(ohlc.get(i), out);
-            analyser.updateBar(*lastBar, newBar);
-
-            if (newBar) {
-                n += 1;
-            }
-        }
-    } else if (m_ohlcType == Ohlc::TYPE_BID) {
-        for (o3d::Int32 i = 0; i < ohlc.getSize(); ++i) {
-            const Ohlc *lastBar = ohlc.get(i);
-            newBar = updateFromOhlcBid(ohlc.get(i), out);
-            analyser.updateBar(*lastBar, newBar);
-
-            if (newBar) {
-                n += 1;
-            }
-        }
-    } else if (m_ohlcType == Ohlc::TYPE_ASK) {
-        for (o3d::Int32 i = 0; i < ohlc.getSize(); ++i) {
-            const Ohlc *lastBar = ohlc.get(i);
-            newBar = updateFromOhlcAsk(ohlc.get(i), out);
-            analyser.updateBar(*lastBar, newBar);
-
-            if (newBar) {
-                n += 1;
-            }
+    for (o3d::Int32 i = 0; i < ohlc.getSize(); ++i) {
+        const Ohlc *lastBar = ohlc.get(i);
+
+        newBar = updateFromOhlc(lastBar, out);
+        analyser.updateBar(*lastBar, newBar);
+
+        if (newBar) {
+            n += 1;
         }
     }
 
     return n;
 }
 
+void TimeframeOhlcGen::saveState(SnapshotWriter &writer) const
+{
+    writer.writeDouble(m_lastTimestamp);
+    writer.writeInt32(static_cast<o3d::Int32>(m_numLastConsumed));
+    writer.writeBool(m_curOhlc != nullptr);
+}
+
+o3d::Bool TimeframeOhlcGen::loadState(SnapshotReader &reader, OhlcCircular &out)
+{
+    o3d::Double lastTimestamp = reader.readDouble();
+    o3d::Int32 numLastConsumed = reader.readInt32();
+    o3d::Bool hasCurrent = reader.readBool();
+
+    if (reader.failed() || (hasCurrent && out.size() == 0)) {
+        return false;
+    }
+
+    m_lastTimestamp = lastTimestamp;
+    m_numLastConsumed = static_cast<o3d::UInt32>(numLastConsumed);
+
+    // the current non consolidated bar is the last one of out
+    m_curOhlc = hasCurrent ? out.lastElt() : nullptr;
+
+    // from a lower timeframe the current bar contains the finished part of the source bar, then it is the merged
+    // part, the next source bars being merged to it
+    m_hasMerged = m_curOhlc != nullptr && m_fromTf > 0.0;
+
+    if (m_hasMerged) {
+        m_mergedOpen = m_curOhlc->open();
+        m_mergedHigh = m_curOhlc->high();
+        m_mergedLow = m_curOhlc->low();
+        m_mergedVolume = m_curOhlc->volume();
+    }
+
+    return true;
+}
+
 o3d::Bool TimeframeOhlcGen::valid() const
 {
     if (m_fromTf == 0.0) {
@@ -217,7 +173,8 @@ o3d::Bool TimeframeOhlcGen::valid() const
     }
 }
 
-o3d::Bool TimeframeOhlcGen::updateFromTickLast(const Tick *tick, OhlcCircular &out)
+template <class P>
+o3d::Bool TimeframeOhlcGen::updateFromTick(const Tick *tick, OhlcCircular &out)
 {
     o3d::Bool isNew = false;
 
@@ -226,8 +183,8 @@ o3d::Bool TimeframeOhlcGen::updateFromTickLast(const Tick *tick, OhlcCircular &o
         return false;
     }
 
-    // compute the middle price
-    const o3d::Double price = tick->last();
+    // last, middle, bid or ask price
+    const o3d::Double price = P::price(tick);
 
     if (m_curOhlc && !m_curOhlc->consolidated() && (tick->timestamp() >= m_curOhlc->timestamp() + m_toTf)) {
         // need to close the current ohlc
@@ -265,124 +222,71 @@ o3d::Bool TimeframeOhlcGen::updateFromTickLast(const Tick *tick, OhlcCircular &o
     return isNew;
 }
 
-o3d::Bool TimeframeOhlcGen::updateFromTickMid(const Tick *tick, OhlcCircular &out)
-{
-    o3d::Bool isNew = false;
-
-    if (tick->timestamp() <= m_lastTimestamp) {
-        // already done (but what if two consecutives ticks have the same exact timestamp ?)
-        return false;
-    }
-
-    // compute the middle price
-    const o3d::Double price = tick->price();
-
-    if (m_curOhlc && !m_curOhlc->consolidated() && (tick->timestamp() >= m_curOhlc->timestamp() + m_toTf)) {
-        // need to close the current ohlc
-        m_curOhlc->setConsolidated();
-        m_curOhlc = nullptr;
-    }
+// for the callers of the update per tick
+template o3d::Bool TimeframeOhlcGen::updateFromTick<TickPriceLast>(const Tick *tick, OhlcCircular &out);
+template o3d::Bool TimeframeOhlcGen::updateFromTick<TickPriceMid>(const Tick *tick, OhlcCircular &out);
+template o3d::Bool TimeframeOhlcGen::updateFromTick<TickPriceBid>(const Tick *tick, OhlcCircular &out);
+template o3d::Bool TimeframeOhlcGen::updateFromTick<TickPriceAsk>(const Tick *tick, OhlcCircular &out);
 
-    if (!m_curOhlc) {
-        o3d::Double curBaseTime = baseTime(tick->timestamp());
-
-        // have a new ohlc, and init a new one as current
-        isNew = true;
-        m_curOhlc = out.writeElt();
-
-        m_curOhlc->setTimestamp(curBaseTime);
-        m_curOhlc->setTimeframe(m_toTf);
-
-        // all OHLC from the current price
-        m_curOhlc->setOhlc(price);
-    }
-
-    // update volumes
-    m_curOhlc->setVolume(m_curOhlc->volume() + tick->volume());
-
-    // bid high/low
-    m_curOhlc->setH(o3d::max(m_curOhlc->h(), price));
-    m_curOhlc->setL(o3d::min(m_curOhlc->l(), price));
-
-    // potential close
-    m_curOhlc->setC(price);
-
-    // keep last timestamp
-    m_lastTimestamp = tick->timestamp();
+o3d::Bool TimeframeOhlcGen::updateFromTickLast(const Tick *tick, OhlcCircular &out)
+{
+    return updateFromTick<TickPriceLast>(tick, out);
+}
 
-    return isNew;
+o3d::Bool TimeframeOhlcGen::updateFromTickMid(const Tick *tick, OhlcCircular &out)
+{
+    return updateFromTick<TickPriceMid>(tick, out);
 }
 
 o3d::Bool TimeframeOhlcGen::updateFromTickBid(const Tick *tick, OhlcCircular &out)
 {
-    o3d::Bool isNew = false;
-
-    if (tick->timestamp() <= m_lastTimestamp) {
-        // already done (but what if two consecutives ticks have the same exact timestamp ?)
-        return false;
-    }
-
-    // the bid price
-    const o3d::Double price = tick->bid();
-
-    if (m_curOhlc && !m_curOhlc->consolidated() && (tick->timestamp() >= m_curOhlc->timestamp() + m_toTf)) {
-        // need to close the current ohlc
-        m_curOhlc->setConsolidated();
-        m_curOhlc = nullptr;
-    }
-
-    if (!m_curOhlc) {
-        o3d::Double curBaseTime = baseTime(tick->timestamp());
-
-        // have a new ohlc, and init a new one as current
-        isNew = true;
-        m_curOhlc = out.writeElt();
-
-        m_curOhlc->setTimestamp(curBaseTime);
-        m_curOhlc->setTimeframe(m_toTf);
-
-        // all OHLC from the current price
-        m_curOhlc->setOhlc(price, price, price, price);
-        m_curOhlc->setVolume(0.0);
-    }
+    return updateFromTick<TickPriceBid>(tick, out);
+}
 
-    // update volumes
-    m_curOhlc->setVolume(m_curOhlc->volume() + tick->volume());
+o3d::Bool TimeframeOhlcGen::updateFromTickAsk(const Tick *tick, OhlcCircular &out)
+{
+    return updateFromTick<TickPriceAsk>(tick, out);
+}
 
-    // bid high/low
-    m_curOhlc->setH(o3d::max(m_curOhlc->h(), price));
-    m_curOhlc->setL(o3d::min(m_curOhlc->l(), price));
+o3d::Bool TimeframeOhlcGen::updateFromOhlcLast(const Ohlc *ohlc, OhlcCircular &out)
+{
+    // the source bar is already of the last price
+    return updateFromOhlc(ohlc, out);
+}
 
-    // potential close
-    m_curOhlc->setC(price);
+o3d::Bool TimeframeOhlcGen::updateFromOhlcMid(const Ohlc *ohlc, OhlcCircular &out)
+{
+    return updateFromOhlc(ohlc, out);
+}
 
-    // keep last timestamp
-    m_lastTimestamp = tick->timestamp();
+o3d::Bool TimeframeOhlcGen::updateFromOhlcBid(const Ohlc *ohlc, OhlcCircular &out)
+{
+    return updateFromOhlc(ohlc, out);
+}
 
-    return isNew;
+o3d::Bool TimeframeOhlcGen::updateFromOhlcAsk(const Ohlc *ohlc, OhlcCircular &out)
+{
+    return updateFromOhlc(ohlc, out);
 }
 
-o3d::Bool TimeframeOhlcGen::updateFromTickAsk(const Tick *tick, OhlcCircular &out)
+o3d::Bool TimeframeOhlcGen::updateFromOhlc(const Ohlc *ohlc, OhlcCircular &out)
 {
     o3d::Bool isNew = false;
 
-    if (tick->timestamp() <= m_lastTimestamp) {
-        // already done (but what if two consecutives ticks have the same exact timestamp ?)
+    if (ohlc->timestamp() <= m_lastTimestamp) {
+        // finished source bar already merged
         return false;
     }
 
-    // the ask price
-    const o3d::Double price = tick->ask();
+    const o3d::Double curBaseTime = baseTime(ohlc->timestamp());
 
-    if (m_curOhlc && !m_curOhlc->consolidated() && (tick->timestamp() >= m_curOhlc->timestamp() + m_toTf)) {
+    if (m_curOhlc && !m_curOhlc->consolidated() && (curBaseTime >= m_curOhlc->timestamp() + m_toTf)) {
         // need to close the current ohlc
         m_curOhlc->setConsolidated();
         m_curOhlc = nullptr;
     }
 
     if (!m_curOhlc) {
-        o3d::Double curBaseTime = baseTime(tick->timestamp());
-
         // have a new ohlc, and init a new one as current
         isNew = true;
         m_curOhlc = out.writeElt();
@@ -390,59 +294,34 @@ o3d::Bool TimeframeOhlcGen::updateFromTickAsk(const Tick *tick, OhlcCircular &ou
         m_curOhlc->setTimestamp(curBaseTime);
         m_curOhlc->setTimeframe(m_toTf);
 
-        // all OHLC from the current price
-        m_curOhlc->setOhlc(price, price, price, price);
-        m_curOhlc->setVolume(0.0);
+        m_hasMerged = false;
     }
 
-    // update volumes
-    m_curOhlc->setVolume(m_curOhlc->volume() + tick->volume());
+    // merged part plus the source bar
+    if (m_hasMerged) {
+        m_curOhlc->setOhlc(m_mergedOpen,
+                           o3d::max(m_mergedHigh, ohlc->high()),
+                           o3d::min(m_mergedLow, ohlc->low()),
+                           ohlc->close());
 
-    // bid high/low
-    m_curOhlc->setH(o3d::max(m_curOhlc->h(), price));
-    m_curOhlc->setL(o3d::min(m_curOhlc->l(), price));
-
-    // potential close
-    m_curOhlc->setC(price);
-
-    // keep last timestamp
-    m_lastTimestamp = tick->timestamp();
-
-    return isNew;
-}
-
-o3d::Bool TimeframeOhlcGen::updateFromOhlcLast(const Ohlc *ohlc, OhlcCircular &out)
-{
-    o3d::Bool isNew = false;
-
-    // @todo
-
-    return isNew;
-}
-
-o3d::Bool TimeframeOhlcGen::updateFromOhlcMid(const Ohlc *ohlc, OhlcCircular &out)
-{
-    o3d::Bool isNew = false;
-
-    // @todo
-
-    return isNew;
-}
+        m_curOhlc->setVolume(m_mergedVolume + ohlc->volume());
+    } else {
+        m_curOhlc->setOhlc(ohlc->open(), ohlc->high(), ohlc->low(), ohlc->close());
+        m_curOhlc->setVolume(ohlc->volume());
+    }
 
-o3d::Bool TimeframeOhlcGen::updateFromOhlcBid(const Ohlc *ohlc, OhlcCircular &out)
-{
-    o3d::Bool isNew = false;
+    if (ohlc->consolidated()) {
+        // finished source bar, merged once
+        m_hasMerged = true;
 
-    // @todo
+        m_mergedOpen = m_curOhlc->open();
+        m_mergedHigh = m_curOhlc->high();
+        m_mergedLow = m_curOhlc->low();
+        m_mergedVolume = m_curOhlc->volume();
 
-    return isNew;
-}
-
-o3d::Bool TimeframeOhlcGen::updateFromOhlcAsk(const Ohlc *ohlc, OhlcCircular &out)
-{
-    o3d::Bool isNew = false;
-
-    // @todo
+        // keep last timestamp
+        m_lastTimestamp = ohlc->timestamp();
+    }
 
     return isNew;
 }
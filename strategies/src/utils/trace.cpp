@@ -0,0 +1,557 @@
+/**
+ * @brief SiiS strategy event trace of a backtest and its reproducibility checker.
+ * @copyright Copyright (C) 2024 SiiS
+ * @author Frederic SCHERMA (frederic.scherma@gmail.com)
+ * @date 2024-10-18
+ */
+
+#include "siis/utils/trace.h"
+#include "siis/utils/common.h"
+
+#include <o3d/core/debug.h>
+
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <string>
+
+using namespace siis;
+using o3d::Debug;
+using o3d::Logger;
+
+namespace {
+
+const char MAGIC[8] = {'S', 'I', 'I', 'S', 'T', 'R', 'C', 'E'};
+
+enum BlockType
+{
+    BLOCK_STREAM = 1,
+    BLOCK_EVENTS = 2
+};
+
+const size_t EVENT_SIZE = 1 + 4 + 4 * 8;
+
+//
+// little endian encoding
+//
+
+void putUInt32(std::vector<o3d::UInt8> &data, o3d::UInt32 v)
+{
+    for (o3d::Int32 i = 0; i < 4; ++i) {
+        data.push_back(static_cast<o3d::UInt8>(v >> (i * 8)));
+    }
+}
+
+void putDouble(std::vector<o3d::UInt8> &data, o3d::Double v)
+{
+    o3d::UInt64 bits;
+    memcpy(&bits, &v, sizeof(bits));
+
+    for (o3d::Int32 i = 0; i < 8; ++i) {
+        data.push_back(static_cast<o3d::UInt8>(bits >> (i * 8)));
+    }
+}
+
+o3d::UInt32 getUInt32(const o3d::UInt8 *data)
+{
+    o3d::UInt32 v = 0;
+    for (o3d::Int32 i = 0; i < 4; ++i) {
+        v |= static_cast<o3d::UInt32>(data[i]) << (i * 8);
+    }
+
+    return v;
+}
+
+o3d::Double getDouble(const o3d::UInt8 *data)
+{
+    o3d::UInt64 bits = 0;
+    for (o3d::Int32 i = 0; i < 8; ++i) {
+        bits |= static_cast<o3d::UInt64>(data[i]) << (i * 8);
+    }
+
+    o3d::Double v;
+    memcpy(&v, &bits, sizeof(v));
+
+    return v;
+}
+
+void decodeEvent(const o3d::UInt8 *data, TraceStream::Event &evt)
+{
+    evt.type = data[0];
+    evt.value = static_cast<o3d::Int32>(getUInt32(data + 1));
+    evt.timestamp = getDouble(data + 5);
+    evt.a = getDouble(data + 13);
+    evt.b = getDouble(data + 21);
+    evt.c = getDouble(data + 29);
+}
+
+/**
+ * @brief Index of the blocks of the streams of a trace file, read the events of a stream in order.
+ */
+class TraceFile
+{
+public:
+
+    struct Block
+    {
+        long offset;
+        o3d::UInt32 count;
+    };
+
+    struct Stream
+    {
+        std::vector<Block> blocks;
+    };
+
+    std::map<std::string, Stream> streams;
+
+    TraceFile() : m_file(nullptr) {}
+    ~TraceFile()
+    {
+        if (m_file) {
+            ::fclose(m_file);
+        }
+    }
+
+    o3d::Bool open(const o3d::String &filename)
+    {
+        m_file = ::fopen(filename.toUtf8().getData(), "rb");
+        if (!m_file) {
+            return false;
+        }
+
+        char magic[8];
+        o3d::UInt8 buf[12];
+
+        if (::fread(magic, sizeof(magic), 1, m_file) != 1 || memcmp(magic, MAGIC, sizeof(MAGIC)) != 0) {
+            return false;
+        }
+
+        if (::fread(buf, 4, 1, m_file) != 1 || getUInt32(buf) != Trace::VERSION) {
+            return false;
+        }
+
+        std::map<o3d::UInt32, std::string> names;
+
+        while (::fread(buf, 1, 1, m_file) == 1) {
+            o3d::UInt8 type = buf[0];
+
+            if (type == BLOCK_STREAM) {
+                if (::fread(buf, 8, 1, m_file) != 1) {
+                    break;
+                }
+
+                o3d::UInt32 size = getUInt32(buf + 4);
+                std::string marketId(size, '\0');
+
+                if (size > 0 && ::fread(&marketId[0], size, 1, m_file) != 1) {
+                    break;
+                }
+
+                names[getUInt32(buf)] = marketId;
+                streams[marketId];
+
+            } else if (type == BLOCK_EVENTS) {
+                if (::fread(buf, 8, 1, m_file) != 1) {
+                    break;
+                }
+
+                auto it = names.find(getUInt32(buf));
+                if (it == names.end()) {
+                    break;
+                }
+
+                Block block;
+                block.offset = ::ftell(m_file);
+                block.count = getUInt32(buf + 4);
+
+                if (::fseek(m_file, static_cast<long>(block.count * EVENT_SIZE), SEEK_CUR) != 0) {
+                    break;
+                }
+
+                streams[it->second].blocks.push_back(block);
+            } else {
+                break;
+            }
+        }
+
+        // ignore a truncated last block
+        ::fseek(m_file, 0, SEEK_END);
+        long size = ::ftell(m_file);
+
+        for (auto &pair : streams) {
+            std::vector<Block> &blocks = pair.second.blocks;
+            if (!blocks.empty() && blocks.back().offset + static_cast<long>(blocks.back().count * EVENT_SIZE) > size) {
+                blocks.pop_back();
+            }
+        }
+
+        return true;
+    }
+
+    o3d::Bool readBlock(const Block &block, std::vector<o3d::UInt8> &data)
+    {
+        data.resize(block.count * EVENT_SIZE);
+
+        if (::fseek(m_file, block.offset, SEEK_SET) != 0) {
+            return false;
+        }
+
+        return data.empty() || ::fread(data.data(), data.size(), 1, m_file) == 1;
+    }
+
+private:
+
+    FILE *m_file;
+};
+
+/**
+ * @brief Sequential reading of the events of a stream.
+ */
+class Cursor
+{
+public:
+
+    Cursor(TraceFile &file, const TraceFile::Stream &stream) :
+        m_file(file),
+        m_stream(stream),
+        m_block(0),
+        m_pos(0)
+    {
+    }
+
+    o3d::Bool next(TraceStream::Event &evt)
+    {
+        while (m_pos >= m_data.size()) {
+            if (m_block >= m_stream.blocks.size()) {
+                return false;
+            }
+
+            if (!m_file.readBlock(m_stream.blocks[m_block++], m_data)) {
+                return false;
+            }
+
+            m_pos = 0;
+        }
+
+        decodeEvent(m_data.data() + m_pos, evt);
+        m_pos += EVENT_SIZE;
+
+        return true;
+    }
+
+private:
+
+    TraceFile &m_file;
+    const TraceFile::Stream &m_stream;
+
+    size_t m_block;
+    size_t m_pos;
+    std::vector<o3d::UInt8> m_data;
+};
+
+o3d::Bool sameValue(o3d::Double a, o3d::Double b, o3d::Double epsilon)
+{
+    if (memcmp(&a, &b, sizeof(a)) == 0) {
+        return true;
+    }
+
+    return epsilon > 0.0 && std::fabs(a - b) <= epsilon * o3d::max(std::fabs(a), std::fabs(b));
+}
+
+o3d::Bool sameEvent(const TraceStream::Event &a, const TraceStream::Event &b, o3d::Double epsilon)
+{
+    return a.type == b.type && a.value == b.value &&
+            sameValue(a.timestamp, b.timestamp, epsilon) &&
+            sameValue(a.a, b.a, epsilon) && sameValue(a.b, b.b, epsilon) && sameValue(a.c, b.c, epsilon);
+}
+
+o3d::String formatEvent(const TraceStream::Event &evt)
+{
+    // full precision, a difference could be on the last digit only
+    char values[128];
+    snprintf(values, sizeof(values), "value=%d a=%.17g b=%.17g c=%.17g", evt.value, evt.a, evt.b, evt.c);
+
+    return o3d::String("{0} at {1} {2}").arg(Trace::eventTypeToStr(evt.type)).arg(timestampToStr(evt.timestamp)).arg(values);
+}
+
+} // anonymous namespace
+
+TraceStream::TraceStream(Trace *trace, o3d::UInt32 index, const o3d::CString &marketId) :
+    m_trace(trace),
+    m_index(index),
+    m_marketId(marketId),
+    m_timestamp(0.0)
+{
+    m_events.reserve(BLOCK_SIZE);
+}
+
+TraceStream::~TraceStream()
+{
+
+}
+
+void TraceStream::step(o3d::Double timestamp, o3d::Int32 numTicks, o3d::Int32 numOhlcs)
+{
+    add(EVENT_STEP, numTicks, timestamp, numOhlcs);
+}
+
+void TraceStream::entrySignal(o3d::Double timestamp, o3d::Int32 direction,
+                              o3d::Double price, o3d::Double takeProfitPrice, o3d::Double stopLossPrice)
+{
+    add(EVENT_ENTRY_SIGNAL, direction, timestamp, price, takeProfitPrice, stopLossPrice);
+}
+
+void TraceStream::exitSignal(o3d::Double timestamp, o3d::Int32 tradeId, o3d::Double price)
+{
+    add(EVENT_EXIT_SIGNAL, tradeId, timestamp, price);
+}
+
+void TraceStream::order(o3d::Int32 direction, o3d::Int32 orderType, o3d::Double quantity, o3d::Double price)
+{
+    add(EVENT_ORDER, direction, m_timestamp, quantity, price, orderType);
+}
+
+void TraceStream::fill(o3d::Double timestamp, o3d::Int32 direction,
+                       o3d::Double price, o3d::Double filled, o3d::Double cumulativeFilled)
+{
+    add(EVENT_FILL, direction, timestamp, price, filled, cumulativeFilled);
+}
+
+void TraceStream::tradeExit(o3d::Double timestamp, o3d::Int32 direction,
+                            o3d::Double entryPrice, o3d::Double exitPrice, o3d::Double profitLossRate)
+{
+    add(EVENT_TRADE_EXIT, direction, timestamp, entryPrice, exitPrice, profitLossRate);
+}
+
+void TraceStream::flush()
+{
+    m_mutex.lock();
+
+    if (!m_events.empty()) {
+        std::vector<o3d::UInt8> data;
+        data.reserve(9 + m_events.size() * EVENT_SIZE);
+
+        data.push_back(BLOCK_EVENTS);
+        putUInt32(data, m_index);
+        putUInt32(data, static_cast<o3d::UInt32>(m_events.size()));
+
+        for (const Event &evt : m_events) {
+            data.push_back(evt.type);
+            putUInt32(data, static_cast<o3d::UInt32>(evt.value));
+            putDouble(data, evt.timestamp);
+            putDouble(data, evt.a);
+            putDouble(data, evt.b);
+            putDouble(data, evt.c);
+        }
+
+        m_trace->write(data);
+        m_events.clear();
+    }
+
+    m_mutex.unlock();
+}
+
+void TraceStream::add(o3d::UInt8 type, o3d::Int32 value, o3d::Double timestamp,
+                      o3d::Double a, o3d::Double b, o3d::Double c)
+{
+    m_mutex.lock();
+
+    Event evt;
+    evt.type = type;
+    evt.value = value;
+    evt.timestamp = timestamp;
+    evt.a = a;
+    evt.b = b;
+    evt.c = c;
+
+    m_events.push_back(evt);
+
+    if (type == EVENT_STEP) {
+        m_timestamp = timestamp;
+    }
+
+    o3d::Bool full = m_events.size() >= BLOCK_SIZE;
+
+    m_mutex.unlock();
+
+    if (full) {
+        flush();
+    }
+}
+
+Trace::Trace() :
+    m_file(nullptr)
+{
+
+}
+
+Trace::~Trace()
+{
+    close();
+}
+
+o3d::Bool Trace::create(const o3d::String &filename)
+{
+    close();
+
+    m_file = ::fopen(filename.toUtf8().getData(), "wb");
+    m_filename = filename;
+
+    if (!m_file) {
+        ERR("trace", o3d::String("Unable to create trace {0}").arg(filename));
+        return false;
+    }
+
+    std::vector<o3d::UInt8> header(MAGIC, MAGIC + sizeof(MAGIC));
+    putUInt32(header, VERSION);
+
+    write(header);
+
+    return true;
+}
+
+TraceStream *Trace::addStream(const o3d::CString &marketId)
+{
+    TraceStream *stream = new TraceStream(this, static_cast<o3d::UInt32>(m_streams.size()), marketId);
+    m_streams.push_back(stream);
+
+    std::vector<o3d::UInt8> data;
+    data.push_back(BLOCK_STREAM);
+    putUInt32(data, stream->index());
+    putUInt32(data, static_cast<o3d::UInt32>(marketId.length()));
+    data.insert(data.end(), marketId.getData(), marketId.getData() + marketId.length());
+
+    write(data);
+
+    return stream;
+}
+
+void Trace::close()
+{
+    for (TraceStream *stream : m_streams) {
+        stream->flush();
+        o3d::deletePtr(stream);
+    }
+
+    m_streams.clear();
+
+    if (m_file) {
+        ::fclose(m_file);
+        m_file = nullptr;
+    }
+}
+
+void Trace::write(const std::vector<o3d::UInt8> &data)
+{
+    m_mutex.lock();
+
+    if (m_file && !data.empty() && ::fwrite(data.data(), data.size(), 1, m_file) != 1) {
+        ERR("trace", o3d::String("Unable to write trace {0}").arg(m_filename));
+
+        ::fclose(m_file);
+        m_file = nullptr;
+    }
+
+    m_mutex.unlock();
+}
+
+o3d::Bool Trace::compare(const o3d::String &filename,
+                         const o3d::String &reference,
+                         o3d::Double epsilon,
+                         Divergence &divergence)
+{
+    TraceFile traceFile;
+    TraceFile referenceFile;
+
+    divergence = Divergence();
+
+    if (!traceFile.open(filename)) {
+        ERR("trace", o3d::String("Unable to read trace {0}").arg(filename));
+        return false;
+    }
+
+    if (!referenceFile.open(reference)) {
+        ERR("trace", o3d::String("Unable to read trace {0}").arg(reference));
+        return false;
+    }
+
+    std::map<std::string, o3d::Bool> marketIds;
+    for (const auto &pair : traceFile.streams) {
+        marketIds[pair.first] = true;
+    }
+    for (const auto &pair : referenceFile.streams) {
+        marketIds[pair.first] = true;
+    }
+
+    const TraceFile::Stream empty;
+
+    for (const auto &pair : marketIds) {
+        auto it = traceFile.streams.find(pair.first);
+        auto rit = referenceFile.streams.find(pair.first);
+
+        Cursor cursor(traceFile, it != traceFile.streams.end() ? it->second : empty);
+        Cursor refCursor(referenceFile, rit != referenceFile.streams.end() ? rit->second : empty);
+
+        TraceStream::Event evt, refEvt;
+        o3d::Int32 index = 0;
+
+        // the events of each stream are ordered, then compare until the first difference
+        while (true) {
+            o3d::Bool has = cursor.next(evt);
+            o3d::Bool refHas = refCursor.next(refEvt);
+
+            if (!has && !refHas) {
+                break;
+            }
+
+            if (has && refHas && sameEvent(evt, refEvt, epsilon)) {
+                ++index;
+                continue;
+            }
+
+            o3d::Double timestamp = has && refHas ? o3d::min(evt.timestamp, refEvt.timestamp) :
+                                                    (has ? evt.timestamp : refEvt.timestamp);
+
+            // keep the earliest divergence over the streams, else the first one in the order of the markets
+            if (!divergence.diverged || timestamp < divergence.timestamp) {
+                divergence.diverged = true;
+                divergence.marketId = pair.first.c_str();
+                divergence.index = index;
+                divergence.timestamp = timestamp;
+
+                if (has && refHas) {
+                    divergence.description = o3d::String("{0} instead of {1}").arg(formatEvent(evt)).arg(formatEvent(refEvt));
+                } else if (has) {
+                    divergence.description = o3d::String("{0} not in the reference").arg(formatEvent(evt));
+                } else {
+                    divergence.description = o3d::String("missing {0}").arg(formatEvent(refEvt));
+                }
+            }
+
+            break;
+        }
+    }
+
+    return true;
+}
+
+o3d::String Trace::eventTypeToStr(o3d::Int32 type)
+{
+    switch (type) {
+        case TraceStream::EVENT_STEP:
+            return "step";
+        case TraceStream::EVENT_ENTRY_SIGNAL:
+            return "entry-signal";
+        case TraceStream::EVENT_EXIT_SIGNAL:
+            return "exit-signal";
+        case TraceStream::EVENT_ORDER:
+            return "order";
+        case TraceStream::EVENT_FILL:
+            return "fill";
+        case TraceStream::EVENT_TRADE_EXIT:
+            return "trade-exit";
+        default:
+            return "unknown";
+    }
+}
@@ -8,11 +8,24 @@
 #include "siis/worker.h"
 #include "siis/poolworker.h"
 #include "siis/strategy.h"
+#include "siis/database/database.h"
 
 #include <o3d/core/application.h>
 
+#include <exception>
+
 using namespace siis;
 
+static void failed(PoolWorker::Job *job, const o3d::String &msg)
+{
+    if (job->countDown) {
+        // given back to the waiting thread
+        job->countDown->fail(msg);
+    } else {
+        o3d::System::print(msg, "siis::worker", o3d::System::MSG_ERROR);
+    }
+}
+
 Worker::Worker(PoolWorker *poolWorker, o3d::Int32 id) :
     m_id(id),
     m_poolWorker(poolWorker),
@@ -33,9 +46,29 @@ o3d::Int32 Worker::run(void *)
     while (m_running) {
         PoolWorker::Job *job = m_poolWorker->nextJob();
         if (job != nullptr) {
+            try {
+                if (job->type == PoolWorker::Job::PREPARE) {
+                    // own connection during the fetch of the market data
+                    job->database->acquire();
+                    job->strategy->prepareMarketData(job->connector, job->database,
+                                                     job->timestamp, job->toTimestamp);
+                } else if (job->type == PoolWorker::Job::RUNNABLE) {
+                    job->runnable->run(job->data);
+                } else {
+                    job->strategy->process(job->timestamp);
+                }
+            } catch (o3d::E_BaseException &e) {
+                failed(job, e.getMsg());
+            } catch (std::exception &e) {
+                failed(job, e.what());
+            }
 
-            job->strategy->process(job->timestamp);
+            if (job->type == PoolWorker::Job::PREPARE) {
+                // even on error, else the connection is lost for the other jobs
+                job->database->release();
+            }
 
+            // always, else the waiting thread never returns
             if (job->countDown) {
                 job->countDown->done();
             }
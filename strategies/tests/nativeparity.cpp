@@ -0,0 +1,380 @@
+/**
+ * @brief SiiS native indicators parity test with their TA-Lib backend.
+ * @copyright Copyright (C) 2024 SiiS
+ * @author Frederic SCHERMA (frederic.scherma@gmail.com)
+ * @date 2024-10-22
+ */
+
+#include "testutils.h"
+
+#include "siis/indicators/sma/sma.h"
+#include "siis/indicators/ema/ema.h"
+#include "siis/indicators/wma/wma.h"
+#include "siis/indicators/rsi/rsi.h"
+#include "siis/indicators/momentum/momentum.h"
+#include "siis/indicators/atr/atr.h"
+#include "siis/indicators/cci/cci.h"
+#include "siis/indicators/adx/adx.h"
+#include "siis/indicators/sar/sar.h"
+#include "siis/indicators/macd/macd.h"
+#include "siis/indicators/bollinger/bollinger.h"
+#include "siis/indicators/stoch/stoch.h"
+#include "siis/indicators/native/nativefeed.h"
+#include "siis/utils/snapshot.h"
+
+#include <memory>
+
+#include <ta-lib/ta_func.h>
+
+using namespace siis;
+using namespace siis::test;
+
+namespace {
+
+const o3d::Int32 NUM_BARS = 4000;
+const o3d::Int32 NUM_STATES = 3;
+const o3d::Int32 DEPTH = 200;
+
+typedef std::vector<const DataArray*> Outputs;
+
+enum Kind
+{
+    WINDOW,      //!< the value only depends on the previous bars of its period
+    RECURSIVE,   //!< the value depends on all the previous bars, TA-Lib restarting at the first bar of the window
+    TALIB_ONLY   //!< not implemented by the native backend
+};
+
+/**
+ * Arrays of the bars given to a compute.
+ */
+struct Bars
+{
+    DataArray timestamps;
+    DataArray high;
+    DataArray low;
+    DataArray close;
+
+    o3d::Int32 size() const { return close.getSize(); }
+};
+
+// with the timestamps of the bars if given, else without
+void compute(Sma &i, o3d::Double ts, const Bars &b, o3d::Bool t) {
+    t ? i.compute(ts, b.timestamps, b.close) : i.compute(ts, b.close); }
+void compute(Ema &i, o3d::Double ts, const Bars &b, o3d::Bool t) {
+    t ? i.compute(ts, b.timestamps, b.close) : i.compute(ts, b.close); }
+void compute(Wma &i, o3d::Double ts, const Bars &b, o3d::Bool t) {
+    t ? i.compute(ts, b.timestamps, b.close) : i.compute(ts, b.close); }
+void compute(Rsi &i, o3d::Double ts, const Bars &b, o3d::Bool t) {
+    t ? i.compute(ts, b.timestamps, b.close) : i.compute(ts, b.close); }
+void compute(Momentum &i, o3d::Double ts, const Bars &b, o3d::Bool t) {
+    t ? i.compute(ts, b.timestamps, b.close) : i.compute(ts, b.close); }
+void compute(Atr &i, o3d::Double ts, const Bars &b, o3d::Bool t) {
+    t ? i.compute(ts, b.timestamps, b.high, b.low, b.close) : i.compute(ts, b.high, b.low, b.close); }
+void compute(Cci &i, o3d::Double ts, const Bars &b, o3d::Bool t) {
+    t ? i.compute(ts, b.timestamps, b.high, b.low, b.close) : i.compute(ts, b.high, b.low, b.close); }
+void compute(Adx &i, o3d::Double ts, const Bars &b, o3d::Bool t) {
+    t ? i.compute(ts, b.timestamps, b.high, b.low, b.close) : i.compute(ts, b.high, b.low, b.close); }
+void compute(Sar &i, o3d::Double ts, const Bars &b, o3d::Bool t) {
+    t ? i.compute(ts, b.timestamps, b.high, b.low) : i.compute(ts, b.high, b.low); }
+void compute(Macd &i, o3d::Double ts, const Bars &b, o3d::Bool t) {
+    t ? i.compute(ts, b.timestamps, b.close) : i.compute(ts, b.close); }
+void compute(Bollinger &i, o3d::Double ts, const Bars &b, o3d::Bool t) {
+    t ? i.compute(ts, b.timestamps, b.close) : i.compute(ts, b.close); }
+void compute(Stoch &i, o3d::Double ts, const Bars &b, o3d::Bool t) {
+    t ? i.compute(ts, b.timestamps, b.high, b.low, b.close) : i.compute(ts, b.high, b.low, b.close); }
+
+Outputs outputs(const Sma &i) { return {&i.sma()}; }
+Outputs outputs(const Ema &i) { return {&i.ema()}; }
+Outputs outputs(const Wma &i) { return {&i.wma()}; }
+Outputs outputs(const Rsi &i) { return {&i.rsi()}; }
+Outputs outputs(const Momentum &i) { return {&i.momentum()}; }
+Outputs outputs(const Atr &i) { return {&i.atr()}; }
+Outputs outputs(const Cci &i) { return {&i.cci()}; }
+Outputs outputs(const Adx &i) { return {&i.adx()}; }
+Outputs outputs(const Sar &i) { return {&i.sar()}; }
+Outputs outputs(const Macd &i) { return {&i.macd(), &i.signal(), &i.hist()}; }
+Outputs outputs(const Bollinger &i) { return {&i.upper(), &i.middle(), &i.lower()}; }
+Outputs outputs(const Stoch &i) { return {&i.slowK(), &i.slowD()}; }
+
+/**
+ * An indicator computed by each backend with the same window, and by TA-Lib with the whole history of the bars
+ * since the last restart of the native states.
+ */
+class Case
+{
+public:
+
+    virtual ~Case() {}
+
+    virtual void compute(o3d::Double timestamp, const Bars &window, const Bars &history) = 0;
+    virtual void check(Checker &checker, o3d::Int32 t) const = 0;
+
+    //! Continue with another native instance restored from a snapshot of the current one.
+    virtual void restore(Checker &checker, o3d::Int32 t) = 0;
+};
+
+template <class T>
+class Parity : public Case
+{
+public:
+
+    template <class... Args>
+    Parity(const char *name, Kind kind, Args... args) :
+        m_name(name),
+        m_kind(kind),
+        m_native(name, args...),
+        m_spare(name, args...),
+        m_current(&m_native),
+        m_restart(name, args...),
+        m_verify(name, args...),
+        m_talib(name, args...),
+        m_history(name, args...),
+        m_offset(0)
+    {
+        m_native.setBackend(Indicator::BACKEND_NATIVE);
+        m_spare.setBackend(Indicator::BACKEND_NATIVE);
+        m_restart.setBackend(Indicator::BACKEND_NATIVE);
+        m_verify.setBackend(Indicator::BACKEND_VERIFY);
+        m_talib.setBackend(Indicator::BACKEND_TALIB);
+        m_history.setBackend(Indicator::BACKEND_TALIB);
+    }
+
+    virtual void compute(o3d::Double timestamp, const Bars &window, const Bars &history) override
+    {
+        ::compute(*m_current, timestamp, window, true);
+        ::compute(m_restart, timestamp, window, false);
+        ::compute(m_verify, timestamp, window, true);
+        ::compute(m_talib, timestamp, window, false);
+        ::compute(m_history, timestamp, history, false);
+
+        m_offset = history.size() - window.size();
+    }
+
+    /**
+     * The native states fed with the new bars only are the TA-Lib ones over the whole history since their seed.
+     * Seeded at the first bar of the window, as without the timestamps, they are the TA-Lib ones over the window.
+     * The verify mode checks the last value of the recursive ones within its tolerance, and must not change them.
+     * The indicators not implemented natively are computed by TA-Lib over the window whatever the backend.
+     */
+    virtual void check(Checker &checker, o3d::Int32 t) const override
+    {
+        const o3d::Int32 lb = m_current->lookback();
+        const o3d::Int32 size = outputs(m_talib)[0]->getSize();
+
+        if (size <= lb) {
+            return;
+        }
+
+        const Outputs native = outputs(*m_current);
+        const Outputs restart = outputs(m_restart);
+        const Outputs verify = outputs(m_verify);
+        const Outputs talib = outputs(m_talib);
+        const Outputs history = outputs(m_history);
+
+        for (size_t o = 0; o < native.size(); ++o) {
+            if (m_kind == TALIB_ONLY) {
+                checker.compare(m_name, t, *native[o], 0, *talib[o], 0, 0.0);
+                checker.compare(m_name, t, *verify[o], 0, *talib[o], 0, 0.0);
+                continue;
+            }
+
+            checker.compare(m_name, t, *native[o], lb - m_offset, *history[o], m_offset, NativeFeed::WINDOW_TOLERANCE);
+            checker.compare(m_name, t, *restart[o], lb, *talib[o], 0, NativeFeed::WINDOW_TOLERANCE);
+            checker.compare(m_name, t, *native[o], 0, *verify[o], 0, 0.0);
+
+            if (m_kind == RECURSIVE) {
+                checker.compare(m_name, t, *native[o], size - 1, *talib[o], 0, NativeFeed::RECURSIVE_TOLERANCE);
+            } else {
+                checker.compare(m_name, t, *native[o], lb, *talib[o], 0, NativeFeed::WINDOW_TOLERANCE);
+            }
+        }
+    }
+
+    /**
+     * The spare instance has the state of its previous use, that the snapshot must entirely replace.
+     */
+    virtual void restore(Checker &checker, o3d::Int32 t) override
+    {
+        T *restored = m_current == &m_native ? &m_spare : &m_native;
+
+        SnapshotWriter writer;
+        m_current->saveState(writer);
+
+        SnapshotReader reader;
+        reader.load(writer);
+
+        checker.check(restored->loadState(reader) && reader.atEnd(), m_name, t);
+
+        m_current = restored;
+    }
+
+private:
+
+    const char *m_name;
+    Kind m_kind;
+
+    T m_native;     //!< with the timestamps of the bars
+    T m_spare;
+    T *m_current;   //!< the one of both in use
+    T m_restart;    //!< without, restarted at each compute
+    T m_verify;
+    T m_talib;
+    T m_history;
+
+    o3d::Int32 m_offset;  //!< index in the history of the first bar of the window
+};
+
+/**
+ * The shift found by the feed with some bars sharing their timestamp, as range bars, and the previous results
+ * moved at the index of their bar.
+ */
+void checkFeed(Checker &checker)
+{
+    const o3d::Int32 numBars = 20000;
+    const o3d::Int32 depth = 20;
+
+    std::mt19937 rng(5);
+    std::uniform_int_distribution<o3d::Int32> same(0, 2);
+    std::uniform_int_distribution<o3d::Int32> step(0, 40);
+
+    // a third of the bars with the timestamp of the previous one, and two thirds in the fast segments
+    std::vector<o3d::Double> ts(static_cast<size_t>(numBars));
+    std::vector<o3d::Int32> groupFirst(static_cast<size_t>(numBars));
+
+    for (o3d::Int32 b = 0; b < numBars; ++b) {
+        const o3d::Bool fast = b / 500 % 2 == 1;
+        const o3d::Bool shared = b > 0 && (fast ? same(rng) != 0 : same(rng) == 0);
+
+        ts[b] = shared ? ts[b-1] : b * 60.0;
+        groupFirst[b] = shared ? groupFirst[b-1] : b;
+    }
+
+    NativeFeed feed;
+    DataArray timestamps, out;
+
+    o3d::Int32 prevFirst = -1;
+    o3d::Int32 prevLast = -1;
+
+    for (o3d::Int32 t = 0; t < numBars; ) {
+        const o3d::Int32 first = std::max(0, t - depth + 1);
+        const o3d::Int32 size = t - first + 1;
+
+        timestamps.setSize(size);
+        for (o3d::Int32 i = 0; i < size; ++i) {
+            timestamps[i] = ts[first + i];
+        }
+
+        // the bars of the previous forming bar timestamp preceded by an older one in both the windows
+        const o3d::Int32 g = prevLast >= 0 ? groupFirst[prevLast] : -1;
+        const o3d::Bool incremental = prevLast >= 0 && g > prevFirst && g > first &&
+                                      first - prevFirst <= NativeFeed::MAX_SHIFT;
+
+        const o3d::Int32 from = feed.compute(&timestamps, size);
+
+        checker.check(feed.restarted() == !incremental, "feed restart", t);
+        checker.check(from == (incremental ? prevLast - first : 0), "feed from", t);
+
+        feed.align(out);
+
+        // the previous results are the index of their bar
+        for (o3d::Int32 i = 0; i < from; ++i) {
+            checker.check(out[i] == first + i, "feed align", t);
+        }
+
+        for (o3d::Int32 i = 0; i < size; ++i) {
+            out[i] = first + i;
+        }
+
+        prevFirst = first;
+        prevLast = t;
+
+        // mostly the same forming bar or some new bars, sometimes a gap over the max shift
+        const o3d::Int32 s = step(rng);
+        t += s < 12 ? s / 4 : (s < 40 ? 1 : NativeFeed::MAX_SHIFT + 1 + s % 4);
+    }
+
+    // without the timestamps always restarted
+    checker.check(feed.compute(nullptr, 10) == 0 && feed.restarted(), "feed without timestamps", numBars);
+}
+
+} // namespace
+
+/**
+ * Each tick of a bar updates the forming bar over a window of DEPTH bars. Some bars are skipped, the next compute
+ * being shifted by two bars, and some gaps are longer than NativeFeed::MAX_SHIFT, restarting the native states.
+ * Periodically the native states are saved then restored into another instance, that must continue the same.
+ */
+int main()
+{
+    ::TA_Initialize();
+
+    BarStream stream(NUM_BARS, NUM_STATES, 11);
+    Checker checker("nativeparity");
+
+    checkFeed(checker);
+
+    std::vector<std::unique_ptr<Case>> cases;
+
+    cases.emplace_back(new Parity<Sma>("sma", WINDOW, 60.0, 20));
+    cases.emplace_back(new Parity<Ema>("ema", RECURSIVE, 60.0, 21));
+    cases.emplace_back(new Parity<Wma>("wma", WINDOW, 60.0, 9));
+    cases.emplace_back(new Parity<Rsi>("rsi", RECURSIVE, 60.0, 14));
+    cases.emplace_back(new Parity<Momentum>("momentum", WINDOW, 60.0, 20));
+    cases.emplace_back(new Parity<Atr>("atr", RECURSIVE, 60.0, 14));
+    cases.emplace_back(new Parity<Cci>("cci", WINDOW, 60.0, 20));
+    cases.emplace_back(new Parity<Adx>("adx", RECURSIVE, 60.0, 5));
+    cases.emplace_back(new Parity<Sar>("sar", RECURSIVE, 60.0, 0.02, 0.2));
+    cases.emplace_back(new Parity<Macd>("macd", RECURSIVE, 60.0, 26, 12, 9));
+    cases.emplace_back(new Parity<Bollinger>("bollinger sma", WINDOW, 60.0, 20, MA_SMA, 2.0, 2.0));
+    cases.emplace_back(new Parity<Bollinger>("bollinger ema", RECURSIVE, 60.0, 20, MA_EMA, 2.0, 2.0));
+    cases.emplace_back(new Parity<Stoch>("stoch", WINDOW, 60.0, 9, 3, MA_SMA, 3, MA_SMA));
+    cases.emplace_back(new Parity<Stoch>("stoch wma ema", RECURSIVE, 60.0, 14, 5, MA_WMA, 3, MA_EMA));
+    cases.emplace_back(new Parity<Stoch>("stoch t3", TALIB_ONLY, 60.0, 14, 5, MA_T3, 3, MA_SMA));
+
+    std::mt19937 rng(13);
+    std::uniform_int_distribution<o3d::Int32> percent(0, 99);
+
+    Bars window, history;
+
+    o3d::Int32 prevFirst = -1;
+    o3d::Int32 historyFirst = 0;
+
+    for (o3d::Int32 t = 0; t < NUM_BARS; ++t) {
+        if (t % 997 == 500) {
+            // gap over the max shift
+            t += NativeFeed::MAX_SHIFT + 4;
+            continue;
+        }
+
+        if (t > DEPTH && percent(rng) < 20) {
+            // a shift of two bars at the next compute
+            continue;
+        }
+
+        // as the feed, a restart if the previous forming bar is shifted by more than the max
+        const o3d::Int32 first = std::max(0, t - DEPTH + 1);
+        if (prevFirst < 0 || first - prevFirst > NativeFeed::MAX_SHIFT) {
+            historyFirst = first;
+        }
+
+        prevFirst = first;
+
+        for (o3d::Int32 k = 0; k < NUM_STATES; ++k) {
+            stream.window(t, k, DEPTH, window.timestamps, window.high, window.low, window.close);
+            stream.window(t, k, t - historyFirst + 1, history.timestamps, history.high, history.low, history.close);
+
+            for (auto &c : cases) {
+                if (t % 97 == 0 && k == 1) {
+                    c->restore(checker, t);
+                }
+
+                c->compute(t * 60.0 + k, window, history);
+                c->check(checker, t);
+            }
+        }
+    }
+
+    ::TA_Shutdown();
+
+    return checker.report();
+}
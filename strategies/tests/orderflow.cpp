@@ -0,0 +1,153 @@
+/**
+ * @brief SiiS order flow indicator parity test with the cumulative volume delta.
+ * @copyright Copyright (C) 2024 SiiS
+ * @author Frederic SCHERMA (frederic.scherma@gmail.com)
+ * @date 2024-10-22
+ */
+
+#include "testutils.h"
+
+#include "siis/indicators/orderflow/orderflow.h"
+#include "siis/indicators/cumulativevolumedelta/cvd.h"
+#include "siis/constants.h"
+#include "siis/utils/snapshot.h"
+
+#include <cstring>
+
+using namespace siis;
+using namespace siis::test;
+
+namespace {
+
+const o3d::Int32 NUM_TICKS = 200000;
+const o3d::Int32 DEPTH = 120;
+
+const o3d::Double TICK_SIZE = 0.25;
+
+//! Sums of a different order of the same volumes.
+const o3d::Double VOLUME_TOLERANCE = 1e-9;
+
+//! Save the state of an indicator then load it into the spare one, that continues in place of it.
+template<class T>
+T* restore(Checker &checker, T *current, T *spare, o3d::Int32 i)
+{
+    SnapshotWriter writer;
+    current->saveState(writer);
+
+    SnapshotReader reader;
+    reader.load(writer);
+
+    checker.check(spare->loadState(reader) && reader.atEnd(), "restore", i);
+
+    return spare;
+}
+
+} // namespace
+
+/**
+ * Ticks with and without aggressor side, unchanged prices, bars of 60 ticks and some gaps of a day. The CVD of the order flow must be the one of CumulativeVolumeDelta, its profile and footprints
+ * must sum the volumes of the session and of the bars.
+ * Periodically their states are saved then restored into other instances, that must continue the same.
+ */
+int main()
+{
+    OrderFlow orderFlows[2] = {{"orderflow", 60.0, DEPTH, "1d", 10, 3.0}, {"orderflow", 60.0, DEPTH, "1d", 10, 3.0}};
+    CumulativeVolumeDelta cvds[2] = {{"cvd", 60.0, DEPTH, "1d"}, {"cvd", 60.0, DEPTH, "1d"}};
+
+    orderFlows[0].init(TICK_SIZE);
+    orderFlows[1].init(TICK_SIZE);
+
+    OrderFlow *orderFlow = &orderFlows[0];
+    CumulativeVolumeDelta *cvd = &cvds[0];
+
+    Checker checker("orderflow");
+
+    std::mt19937 rng(17);
+    std::uniform_int_distribution<o3d::Int32> move(-2, 2);
+    std::uniform_int_distribution<o3d::Int32> side(-4, 1);
+    std::uniform_real_distribution<o3d::Double> volume(0.0, 5.0);
+
+    o3d::Double price = 1000.0;
+    o3d::Double timestamp = 1700000000.0;
+
+    o3d::Double sessionTimestamp = 0.0;
+    o3d::Double sessionVolume = 0.0;
+    o3d::Double barVolume = 0.0;
+    o3d::Double prevBarVolume = 0.0;
+
+    for (o3d::Int32 i = 0; i < NUM_TICKS; ++i) {
+        const o3d::Bool finalize = i > 0 && i % 60 == 0;
+
+        // a gap of a day every two thousand ticks
+        timestamp += i % 2000 == 0 ? 86400.0 : 1.0;
+        price += move(rng) * TICK_SIZE;
+
+        // mostly without side, as the tick rule applies
+        const o3d::Int32 bos = side(rng);
+        const Tick tick(timestamp, price - TICK_SIZE, price + TICK_SIZE, price, volume(rng),
+                        static_cast<o3d::Int8>(bos < -1 ? 0 : bos));
+
+        // as the indicators, a new session once the previous one is over
+        if (timestamp > sessionTimestamp + TF_DAY) {
+            sessionTimestamp = static_cast<o3d::Int64>(timestamp / TF_DAY) * TF_DAY;
+            sessionVolume = 0.0;
+        }
+
+        if (finalize) {
+            prevBarVolume = barVolume;
+            barVolume = 0.0;
+        }
+
+        // the spare instances keep a stale state, fully replaced
+        if (i > 0 && i % 7919 == 0) {
+            const o3d::Int32 spare = orderFlow == &orderFlows[0] ? 1 : 0;
+
+            orderFlow = restore(checker, orderFlow, &orderFlows[spare], i);
+            cvd = restore(checker, cvd, &cvds[spare], i);
+        }
+
+        cvd->update(tick, finalize);
+        orderFlow->update(tick, finalize);
+
+        sessionVolume += tick.volume();
+        barVolume += tick.volume();
+
+        checker.check(orderFlow->cvd().size() == cvd->cvd().size(), "cvd size", i);
+        checker.check(orderFlow->last() == cvd->last(), "cvd last", i);
+        checker.check(orderFlow->prev() == cvd->prev(), "cvd prev", i);
+
+        if (finalize) {
+            const DataArray a = orderFlow->cvd().asArray();
+            const DataArray b = cvd->cvd().asArray();
+
+            checker.check(memcmp(a.getData(), b.getData(), a.getSize() * sizeof(o3d::Double)) == 0, "cvd series", i);
+
+            if (orderFlow->numPrevious() > 0) {
+                checker.check(Checker::error(orderFlow->footprint(-1).volume(), prevBarVolume) <= VOLUME_TOLERANCE,
+                              "previous footprint volume", i);
+            }
+        }
+
+        checker.check(Checker::error(orderFlow->footprint().volume(), barVolume) <= VOLUME_TOLERANCE,
+                      "footprint volume", i);
+        checker.check(Checker::error(orderFlow->profile().volume(), sessionVolume) <= VOLUME_TOLERANCE,
+                      "profile volume", i);
+        checker.check(orderFlow->footprint().high >= price && orderFlow->footprint().low <= price, "footprint range", i);
+    }
+
+    // levels out of the 32 bits range, as a small tick size on a high price, and a bounded range
+    PriceLadder ladders[2];
+    const o3d::Int64 base = static_cast<o3d::Int64>(1) << 40;
+
+    checker.check(ladders[0].add(base, 1.0, 2.0), "ladder add", 0);
+    checker.check(ladders[0].add(base - 1000, 3.0, 0.0), "ladder grow", 0);
+    checker.check(!ladders[0].add(base + PriceLadder::MAX_LEVELS, 1.0, 1.0), "ladder bound", 0);
+    checker.check(ladders[0].lowLevel() == base - 1000 && ladders[0].highLevel() == base, "ladder range", 0);
+
+    restore(checker, &ladders[0], &ladders[1], 0);
+
+    checker.check(ladders[1].lowLevel() == base - 1000 && ladders[1].highLevel() == base &&
+                  ladders[1].pocLevel() == ladders[0].pocLevel() && ladders[1].askAt(base) == 2.0, "ladder restored", 0);
+
+    return checker.report();
+}
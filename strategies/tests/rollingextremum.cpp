@@ -0,0 +1,230 @@
+/**
+ * @brief SiiS rolling extremum and channel indicators parity test with TA-Lib.
+ * @copyright Copyright (C) 2024 SiiS
+ * @author Frederic SCHERMA (frederic.scherma@gmail.com)
+ * @date 2024-10-22
+ */
+
+#include "testutils.h"
+
+#include "siis/utils/rollingextremum.h"
+#include "siis/indicators/donchian/donchian.h"
+#include "siis/indicators/ichimoku/ichimoku.h"
+#include "siis/indicators/stoch/stoch.h"
+#include "siis/indicators/stochrsi/stochrsi.h"
+
+#include <ta-lib/ta_func.h>
+
+using namespace siis;
+using namespace siis::test;
+
+namespace {
+
+const o3d::Int32 NUM_BARS = 3000;
+const o3d::Int32 NUM_STATES = 4;
+const o3d::Int32 DEPTH = 120;
+
+//! Window of the bars of the kernel tests, of the default Donchian.
+const o3d::Int32 LEN = 14;
+
+//! The native stochastic averages are running sums.
+const o3d::Double STOCH_TOLERANCE = 1e-9;
+
+typedef TA_RetCode (*TaExtremum)(int, int, const double[], int, int*, int*, double[]);
+
+/**
+ * Output of a TA-Lib function over a whole array, with the index of its first value.
+ */
+struct Reference
+{
+    std::vector<o3d::Double> a;
+    std::vector<o3d::Double> b;
+    o3d::Int32 begIdx;
+
+    void resize(o3d::Int32 size)
+    {
+        a.assign(static_cast<size_t>(size), 0.0);
+        b.assign(static_cast<size_t>(size), 0.0);
+        begIdx = 0;
+    }
+};
+
+void extremum(TaExtremum func, const DataArray &in, o3d::Int32 len, Reference &ref)
+{
+    int b, n;
+    ref.resize(in.getSize());
+    func(0, in.getSize()-1, in.getData(), len, &b, &n, ref.a.data());
+    ref.begIdx = b;
+}
+
+void midPrice(const DataArray &high, const DataArray &low, o3d::Int32 len, Reference &ref)
+{
+    int b, n;
+    ref.resize(high.getSize());
+    ::TA_MIDPRICE(0, high.getSize()-1, high.getData(), low.getData(), len, &b, &n, ref.a.data());
+    ref.begIdx = b;
+}
+
+/**
+ * All the instances given the same windows, as the analysers give them at each tick.
+ */
+class Suite
+{
+public:
+
+    Suite() :
+        m_max(RollingExtremum::MODE_MAX, LEN),
+        m_min(RollingExtremum::MODE_MIN, LEN),
+        m_donchian("donchian", 60.0, LEN),
+        m_ichimoku("ichimoku", 60.0, 9, 26, 52),
+        m_stoch("stoch", 60.0, 9, 3, MA_SMA, 3, MA_SMA),
+        m_stochRsi("stochrsi", 60.0, 14, 14, 3, MA_SMA),
+        m_ssa(static_cast<size_t>(DEPTH)),
+        m_checker("rollingextremum")
+    {
+        m_stoch.setBackend(Indicator::BACKEND_NATIVE);
+    }
+
+    void compute(o3d::Int32 t, const DataArray &high, const DataArray &low, const DataArray &close)
+    {
+        const o3d::Int32 size = high.getSize();
+        const o3d::Double timestamp = t * 60.0;
+
+        // kernel, the first recomputed index must be from the forming bar or before
+        m_checker.check(m_max.compute(high) <= size - 1, "max from", t);
+        m_checker.check(m_min.compute(low) <= size - 1, "min from", t);
+
+        extremum(::TA_MAX, high, LEN, m_ref);
+        m_checker.compare("TA_MAX", t, m_max.values(), LEN-1, m_ref.a, m_ref.begIdx, 0.0);
+
+        extremum(::TA_MIN, low, LEN, m_ref);
+        m_checker.compare("TA_MIN", t, m_min.values(), LEN-1, m_ref.a, m_ref.begIdx, 0.0);
+
+        // donchian channel
+        if (size > m_donchian.lookback()) {
+            m_donchian.compute(timestamp, high, low);
+
+            extremum(::TA_MAX, high, LEN, m_ref);
+            m_checker.compare("donchian upper", t, m_donchian.upper(), m_ref.begIdx, m_ref.a, m_ref.begIdx, 0.0);
+
+            extremum(::TA_MIN, low, LEN, m_ref);
+            m_checker.compare("donchian lower", t, m_donchian.lower(), m_ref.begIdx, m_ref.a, m_ref.begIdx, 0.0);
+        }
+
+        // ichimoku lines
+        if (size > m_ichimoku.lookback()) {
+            m_ichimoku.compute(timestamp, high, low, close);
+
+            midPrice(high, low, m_ichimoku.tenkanLen(), m_ref);
+            m_checker.compare("tenkan", t, m_ichimoku.tenkan(), m_ref.begIdx, m_ref.a, m_ref.begIdx, 0.0);
+
+            midPrice(high, low, m_ichimoku.kijunLen(), m_ref);
+            m_checker.compare("kijun", t, m_ichimoku.kijun(), m_ref.begIdx, m_ref.a, m_ref.begIdx, 0.0);
+
+            midPrice(high, low, m_ichimoku.senkouSpanBLen(), m_ref);
+            m_checker.compare("ssb", t, m_ichimoku.ssb(), m_ref.begIdx, m_ref.a, m_ref.begIdx, 0.0);
+
+            const o3d::Int32 lb = m_ichimoku.kijunLen() - 1;
+
+            for (o3d::Int32 i = lb; i < size; ++i) {
+                m_ssa[static_cast<size_t>(i - lb)] = (m_ichimoku.tenkan()[i] + m_ichimoku.kijun()[i]) * 0.5;
+            }
+
+            m_checker.compare("ssa", t, m_ichimoku.ssa(), lb, m_ssa, lb, 0.0);
+        }
+
+        // stochastic, native backend
+        if (size > m_stoch.lookback()) {
+            m_stoch.compute(timestamp, high, low, close);
+
+            int b, n;
+            m_ref.resize(size);
+            ::TA_STOCH(0, size-1, high.getData(), low.getData(), close.getData(),
+                       m_stoch.fastK_Len(),
+                       m_stoch.slowK_Len(), static_cast<TA_MAType>(m_stoch.slowK_MAType()),
+                       m_stoch.slowD_Len(), static_cast<TA_MAType>(m_stoch.slowD_MAType()),
+                       &b, &n, m_ref.a.data(), m_ref.b.data());
+            m_ref.begIdx = b;
+
+            m_checker.compare("stoch slowK", t, m_stoch.slowK(), b, m_ref.a, b, STOCH_TOLERANCE);
+            m_checker.compare("stoch slowD", t, m_stoch.slowD(), b, m_ref.b, b, STOCH_TOLERANCE);
+        }
+
+        // stochastic rsi
+        if (size > m_stochRsi.lookback()) {
+            m_stochRsi.compute(timestamp, close);
+
+            int b, n;
+            m_ref.resize(size);
+            ::TA_STOCHRSI(0, size-1, close.getData(), m_stochRsi.len(), m_stochRsi.fastK_Len(), m_stochRsi.fastD_Len(),
+                          static_cast<TA_MAType>(m_stochRsi.fastD_MAType()), &b, &n, m_ref.a.data(), m_ref.b.data());
+            m_ref.begIdx = b;
+
+            m_checker.compare("stochrsi fastK", t, m_stochRsi.fastK(), b, m_ref.a, b, 0.0);
+            m_checker.compare("stochrsi fastD", t, m_stochRsi.fastD(), b, m_ref.b, b, 0.0);
+        }
+    }
+
+    Checker& checker() { return m_checker; }
+
+private:
+
+    RollingExtremum m_max;
+    RollingExtremum m_min;
+
+    Donchian m_donchian;
+    Ichimoku m_ichimoku;
+    Stoch m_stoch;
+    StochRsi m_stochRsi;
+
+    Reference m_ref;
+    std::vector<o3d::Double> m_ssa;
+
+    Checker m_checker;
+};
+
+} // namespace
+
+/**
+ * Each tick of a bar updates the forming bar. Some bars are skipped, the next compute being shifted by two bars,
+ * some gaps are longer than RollingExtremum::MAX_SHIFT, and some past bars are amended, forcing a full rescan.
+ */
+int main()
+{
+    ::TA_Initialize();
+
+    BarStream stream(NUM_BARS, NUM_STATES, 7);
+    Suite suite;
+
+    std::mt19937 rng(13);
+    std::uniform_int_distribution<o3d::Int32> percent(0, 99);
+
+    DataArray high, low, close;
+
+    for (o3d::Int32 t = 0; t < NUM_BARS; ++t) {
+        if (t % 401 == 200) {
+            // gap over the max shift
+            t += RollingExtremum::MAX_SHIFT + 4;
+            continue;
+        }
+
+        if (percent(rng) < 10) {
+            // a shift of two bars at the next compute
+            continue;
+        }
+
+        if (t % 97 == 50) {
+            // history correction at a varying depth inside the window
+            stream.amend(t - 5 - (t / 97 % 8) * 10, 0.75);
+        }
+
+        for (o3d::Int32 k = 0; k < NUM_STATES; ++k) {
+            stream.window(t, k, DEPTH, high, low, close);
+            suite.compute(t, high, low, close);
+        }
+    }
+
+    ::TA_Shutdown();
+
+    return suite.checker().report();
+}
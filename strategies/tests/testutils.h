@@ -0,0 +1,243 @@
+/**
+ * @brief SiiS strategy tests common utilities.
+ * @copyright Copyright (C) 2024 SiiS
+ * @author Frederic SCHERMA (frederic.scherma@gmail.com)
+ * @date 2024-10-22
+ */
+
+#ifndef SIIS_TESTS_TESTUTILS_H
+#define SIIS_TESTS_TESTUTILS_H
+
+#include "siis/dataarray.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace siis {
+namespace test {
+
+/**
+ * @brief Synthetic random walk bars, with the intermediate states of each bar.
+ * @author Frederic Scherma
+ * @date 2024-10-22
+ * A state k of a bar is the bar as it is formed after its k-th tick, the last state being the closed bar.
+ * Some bars return to their open price, producing equal values and flat windows.
+ */
+class BarStream
+{
+public:
+
+    struct State
+    {
+        o3d::Double high;
+        o3d::Double low;
+        o3d::Double close;
+    };
+
+    BarStream(o3d::Int32 numBars, o3d::Int32 numStates, o3d::UInt32 seed) :
+        m_numBars(numBars),
+        m_numStates(numStates),
+        m_states(static_cast<size_t>(numBars * numStates))
+    {
+        std::mt19937 rng(seed);
+        std::normal_distribution<o3d::Double> move(0.0, 1.0);
+
+        o3d::Double price = 1000.0;
+
+        for (o3d::Int32 t = 0; t < numBars; ++t) {
+            const o3d::Double open = price;
+            o3d::Double high = price, low = price;
+
+            for (o3d::Int32 k = 0; k < numStates; ++k) {
+                // rounded to a tick size of 0.25, as real prices, for some equal extremums
+                price = std::round((price + move(rng) * 2.0) * 4.0) * 0.25;
+
+                if (t % 53 == 7) {
+                    price = open;
+                }
+
+                high = std::max(high, price);
+                low = std::min(low, price);
+
+                m_states[static_cast<size_t>(t * numStates + k)] = {high, low, price};
+            }
+        }
+    }
+
+    o3d::Int32 numBars() const { return m_numBars; }
+    o3d::Int32 numStates() const { return m_numStates; }
+
+    const State& state(o3d::Int32 bar, o3d::Int32 k) const
+    {
+        return m_states[static_cast<size_t>(bar * m_numStates + k)];
+    }
+
+    //! Modify a closed bar, as a correction of the history.
+    void amend(o3d::Int32 bar, o3d::Double delta)
+    {
+        State &closed = m_states[static_cast<size_t>(bar * m_numStates + m_numStates - 1)];
+
+        closed.high += delta;
+        closed.low -= delta;
+    }
+
+    /**
+     * @brief window Fill the arrays with at most depth bars ending at the state k of the bar t (the forming bar),
+     * as the analysers give them to the indicators.
+     * @return Size of the arrays.
+     */
+    o3d::Int32 window(o3d::Int32 t, o3d::Int32 k, o3d::Int32 depth,
+                      DataArray &high, DataArray &low, DataArray &close) const
+    {
+        const o3d::Int32 first = std::max(0, t - depth + 1);
+        const o3d::Int32 size = t - first + 1;
+
+        high.setSize(size);
+        low.setSize(size);
+        close.setSize(size);
+
+        for (o3d::Int32 i = 0; i < size; ++i) {
+            const State &s = state(first + i, i == size - 1 ? k : m_numStates - 1);
+
+            high[i] = s.high;
+            low[i] = s.low;
+            close[i] = s.close;
+        }
+
+        return size;
+    }
+
+    //! Timestamp of a bar, of one minute.
+    static o3d::Double timestamp(o3d::Int32 bar) { return bar * 60.0; }
+
+    //! Same with the timestamp of each bar.
+    o3d::Int32 window(o3d::Int32 t, o3d::Int32 k, o3d::Int32 depth, DataArray &timestamps,
+                      DataArray &high, DataArray &low, DataArray &close) const
+    {
+        const o3d::Int32 size = window(t, k, depth, high, low, close);
+        const o3d::Int32 first = t - size + 1;
+
+        timestamps.setSize(size);
+
+        for (o3d::Int32 i = 0; i < size; ++i) {
+            timestamps[i] = timestamp(first + i);
+        }
+
+        return size;
+    }
+
+private:
+
+    o3d::Int32 m_numBars;
+    o3d::Int32 m_numStates;
+
+    std::vector<State> m_states;
+};
+
+/**
+ * @brief Count and report the mismatches of a test.
+ * @author Frederic Scherma
+ * @date 2024-10-22
+ */
+class Checker
+{
+public:
+
+    static const o3d::Int32 MAX_REPORTS = 10;
+
+    explicit Checker(const char *name) :
+        m_name(name),
+        m_checks(0),
+        m_failures(0)
+    {
+    }
+
+    //! Relative difference, absolute under 1.
+    static o3d::Double error(o3d::Double value, o3d::Double expected)
+    {
+        return std::fabs(value - expected) / std::max(1.0, std::fabs(expected));
+    }
+
+    /**
+     * @brief compare Compare the values of an array from an index with the compact output of a TA-Lib function.
+     * @param begIdx Index of the first output of the TA-Lib function.
+     * @param tolerance Max relative difference, 0 for an exact equality.
+     */
+    void compare(const char *what, o3d::Int32 t, const DataArray &values, o3d::Int32 from,
+                 const std::vector<o3d::Double> &expected, o3d::Int32 begIdx, o3d::Double tolerance)
+    {
+        for (o3d::Int32 i = std::max(from, begIdx); i < values.getSize(); ++i) {
+            const o3d::Double e = expected[static_cast<size_t>(i - begIdx)];
+
+            ++m_checks;
+
+            if (error(values[i], e) > tolerance) {
+                fail(what, t, i, values[i], e);
+            }
+        }
+    }
+
+    /**
+     * @brief compare Compare the values of an array from an index with the end of a longer or same size array.
+     * @param offset Index of the expected value of the first value, their size difference.
+     * @param tolerance Max relative difference, 0 for an exact equality.
+     */
+    void compare(const char *what, o3d::Int32 t, const DataArray &values, o3d::Int32 from,
+                 const DataArray &expected, o3d::Int32 offset, o3d::Double tolerance)
+    {
+        if (values.getSize() + offset != expected.getSize()) {
+            check(false, what, t);
+            return;
+        }
+
+        for (o3d::Int32 i = std::max(from, 0); i < values.getSize(); ++i) {
+            const o3d::Double e = expected[i + offset];
+
+            ++m_checks;
+
+            if (error(values[i], e) > tolerance) {
+                fail(what, t, i, values[i], e);
+            }
+        }
+    }
+
+    void check(o3d::Bool condition, const char *what, o3d::Int32 t)
+    {
+        ++m_checks;
+
+        if (!condition) {
+            fail(what, t, -1, 0.0, 0.0);
+        }
+    }
+
+    o3d::Int32 failures() const { return m_failures; }
+
+    //! Print the summary, return the exit code of the test.
+    int report() const
+    {
+        printf("%s: %d checks, %d failures\n", m_name, m_checks, m_failures);
+        return m_failures > 0 ? 1 : 0;
+    }
+
+private:
+
+    const char *m_name;
+
+    o3d::Int32 m_checks;
+    o3d::Int32 m_failures;
+
+    void fail(const char *what, o3d::Int32 t, o3d::Int32 i, o3d::Double value, o3d::Double expected)
+    {
+        if (++m_failures <= MAX_REPORTS) {
+            printf("%s: %s mismatch at bar %d index %d : %.12g expected %.12g\n", m_name, what, t, i, value, expected);
+        }
+    }
+};
+
+} // namespace test
+} // namespace siis
+
+#endif // SIIS_TESTS_TESTUTILS_H
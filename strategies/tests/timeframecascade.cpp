@@ -0,0 +1,187 @@
+/**
+ * @brief SiiS timeframe cascade parity test with the per analyser bar generation.
+ * @copyright Copyright (C) 2024 SiiS
+ * @author Frederic SCHERMA (frederic.scherma@gmail.com)
+ * @date 2024-10-23
+ */
+
+#include "testutils.h"
+
+#include "siis/analysers/timeframebaranalyser.h"
+#include "siis/strategy.h"
+#include "siis/utils/timeframecascade.h"
+#include "siis/constants.h"
+
+#include <cstring>
+
+using namespace siis;
+using namespace siis::test;
+
+namespace {
+
+const o3d::Int32 NUM_TICKS = 300000;
+const o3d::Int32 DEPTH = 20;
+const o3d::Double TICK_SIZE = 0.25;
+
+//! Attached ones, from the base timeframe, and one not multiple of it that keeps generating from the ticks.
+const o3d::Double TIMEFRAMES[] = {60.0, 180.0, 300.0, 900.0, 3600.0, 90.0};
+const o3d::Int32 NUM_TIMEFRAMES = 6;
+
+/**
+ * @brief Strategy owning the cascade, nothing more.
+ */
+class TestStrategy : public Strategy
+{
+public:
+
+    TestStrategy() : Strategy(nullptr, "test") {}
+
+    virtual void terminate(Connector *, Database *) override {}
+
+    virtual void prepareMarketData(Connector *, Database *, o3d::Double, o3d::Double) override {}
+    virtual void finalizeMarketData(Connector *, Database *) override {}
+
+    virtual void onTickUpdate(o3d::Double, const TickArray &) override {}
+    virtual void onOhlcUpdate(o3d::Double, o3d::Double, Ohlc::Type, const OhlcArray &) override {}
+
+    virtual void onOrderSignal(const OrderSignal &) override {}
+    virtual void onPositionSignal(const PositionSignal &) override {}
+
+    virtual void prepare(o3d::Double) override {}
+    virtual void compute(o3d::Double) override {}
+    virtual void finalize(o3d::Double) override {}
+
+    virtual void updateTrade(Trade *) override {}
+    virtual void updateStats() override {}
+};
+
+/**
+ * @brief Analyser recording the per tick updates, its bars being those of its price indicator.
+ */
+class TestAnalyser : public TimeframeBarAnalyser
+{
+public:
+
+    struct Update
+    {
+        o3d::Double timestamp;
+        o3d::Bool finalize;
+    };
+
+    TestAnalyser(Strategy *strategy, o3d::Double timeframe) :
+        TimeframeBarAnalyser(strategy, "test", timeframe, 0.0, DEPTH, 0.0)
+    {
+    }
+
+    virtual o3d::String typeName() const override { return "test"; }
+    virtual void terminate() override {}
+    virtual void compute(o3d::Double, o3d::Double) override {}
+
+    virtual void updateTick(const Tick &tick, o3d::Bool finalize) override
+    {
+        updates.push_back({tick.timestamp(), finalize});
+    }
+
+    std::vector<Update> updates;
+};
+
+o3d::Bool sameArray(const DataArray &a, const DataArray &b)
+{
+    return a.getSize() == b.getSize() &&
+           memcmp(a.getData(), b.getData(), static_cast<size_t>(a.getSize()) * sizeof(o3d::Double)) == 0;
+}
+
+} // namespace
+
+/**
+ * Batches of 1 to 40 ticks, one to twenty seconds apart, with some gaps of several hours. The bars of the analysers
+ * derived from the base bars of the cascade must be exactly the ones generated from the ticks by each analyser,
+ * as well as their number of new bars and their per tick updates with the finalize state.
+ */
+int main()
+{
+    TestStrategy strategy;
+
+    std::vector<TestAnalyser*> cascaded;
+    std::vector<TestAnalyser*> direct;
+
+    for (o3d::Int32 t = 0; t < NUM_TIMEFRAMES; ++t) {
+        cascaded.push_back(new TestAnalyser(&strategy, TIMEFRAMES[t]));
+        direct.push_back(new TestAnalyser(&strategy, TIMEFRAMES[t]));
+
+        // as at the init of a tick based strategy
+        strategy.cascade().add(cascaded.back());
+    }
+
+    Checker checker("timeframecascade");
+
+    checker.check(strategy.cascade().baseTimeframe() == 60.0, "base timeframe", 0);
+    checker.check(strategy.cascade().numAttached() == NUM_TIMEFRAMES - 1, "attached", 0);
+    checker.check(cascaded.back()->cascade() == nullptr, "not multiple", 0);
+
+    std::mt19937 rng(23);
+    std::uniform_int_distribution<o3d::Int32> move(-2, 2);
+    std::uniform_int_distribution<o3d::Int32> delay(1, 20);
+    std::uniform_int_distribution<o3d::Int32> batch(1, 40);
+
+    o3d::Double price = 1000.0;
+    o3d::Double timestamp = 1700000000.0;
+
+    TickArray ticks(64);
+
+    for (o3d::Int32 i = 0, b = 0; i < NUM_TICKS; ++b) {
+        const o3d::Int32 n = o3d::min(batch(rng), NUM_TICKS - i);
+
+        ticks.forceSize(n);
+
+        for (o3d::Int32 k = 0; k < n; ++k, ++i) {
+            // a gap of some hours every ten thousand ticks
+            timestamp += i % 10000 == 0 ? 3600.0 * (1 + i % 5) : delay(rng);
+            price += move(rng) * TICK_SIZE;
+
+            ticks.get(k)->set(timestamp, price - TICK_SIZE, price + TICK_SIZE, price, 1.0, 0);
+        }
+
+        // as Strategy::feedTicks
+        strategy.cascade().onTickUpdate(timestamp, ticks);
+
+        for (o3d::Int32 t = 0; t < NUM_TIMEFRAMES; ++t) {
+            cascaded[t]->onTickUpdate(timestamp, ticks);
+            direct[t]->onTickUpdate(timestamp, ticks);
+
+            checker.check(cascaded[t]->numLastBars() == direct[t]->numLastBars(), "new bars", b);
+
+            cascaded[t]->process(timestamp, timestamp);
+            direct[t]->process(timestamp, timestamp);
+
+            const Price &a = cascaded[t]->price();
+            const Price &e = direct[t]->price();
+
+            checker.check(sameArray(a.timestamp(), e.timestamp()) && sameArray(a.open(), e.open()) &&
+                          sameArray(a.high(), e.high()) && sameArray(a.low(), e.low()) &&
+                          sameArray(a.close(), e.close()) && a.consolidated() == e.consolidated(), "bars", b);
+        }
+    }
+
+    for (o3d::Int32 t = 0; t < NUM_TIMEFRAMES; ++t) {
+        const std::vector<TestAnalyser::Update> &a = cascaded[t]->updates;
+        const std::vector<TestAnalyser::Update> &e = direct[t]->updates;
+
+        checker.check(a.size() == e.size(), "updates", t);
+
+        for (size_t u = 0; u < a.size() && u < e.size(); ++u) {
+            checker.check(a[u].timestamp == e[u].timestamp && a[u].finalize == e[u].finalize,
+                          "update", static_cast<o3d::Int32>(u));
+        }
+    }
+
+    for (o3d::Int32 t = 0; t < NUM_TIMEFRAMES; ++t) {
+        // removed from the cascade of the strategy
+        o3d::deletePtr(cascaded[t]);
+        o3d::deletePtr(direct[t]);
+    }
+
+    checker.check(strategy.cascade().numAttached() == 0, "detached", 0);
+
+    return checker.report();
+}
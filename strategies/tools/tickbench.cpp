@@ -0,0 +1,160 @@
+/**
+ * @brief SiiS tick throughput benchmark of the bar generators.
+ * @copyright Copyright (C) 2024 SiiS
+ * @author Frederic SCHERMA (frederic.scherma@gmail.com)
+ * @date 2024-10-22
+ */
+
+#include "siis/utils/timeframeohlcgen.h"
+#include "siis/utils/rangeohlcgen.h"
+#include "siis/utils/reversalohlcgen.h"
+#include "siis/analysers/analyser.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+using namespace siis;
+
+namespace {
+
+const o3d::Int32 NUM_TICKS = 1 << 20;
+const o3d::Int32 DEFAULT_RUNS = 10;
+
+const char* TYPES[] = {"last", "mid", "bid", "ask"};
+
+/**
+ * @brief Analyser counting the ticks given by the generators, without any computation.
+ * @author Frederic Scherma
+ * @date 2024-10-22
+ */
+class CountAnalyser : public Analyser
+{
+public:
+
+    CountAnalyser() :
+        Analyser(nullptr, "bench", 60.0, 0, 10, 0.0),
+        m_ticks(0),
+        m_bars(0)
+    {
+    }
+
+    virtual o3d::String typeName() const override { return "bench"; }
+
+    virtual void init(const AnalyserConfig &conf) override {}
+    virtual void terminate() override {}
+    virtual void prepare(o3d::Double timestamp) override {}
+
+    virtual void onTickUpdate(o3d::Double timestamp, const TickArray &ticks) override {}
+    virtual void onOhlcUpdate(o3d::Double timestamp, o3d::Double timeframe, const OhlcArray &ohlc) override {}
+    virtual void process(o3d::Double timestamp, o3d::Double lastTimestamp) override {}
+
+    virtual o3d::Double lastPrice() const override { return 0.0; }
+    virtual o3d::String formatUnit() const override { return ""; }
+
+    virtual void updateTick(const Tick &tick, o3d::Bool finalize) override
+    {
+        ++m_ticks;
+        m_bars += finalize;
+    }
+
+    o3d::Int64 ticks() const { return m_ticks; }
+    o3d::Int64 bars() const { return m_bars; }
+
+private:
+
+    o3d::Int64 m_ticks;
+    o3d::Int64 m_bars;
+};
+
+//! Best duration in seconds of the runs, a new generator for each run.
+template <class F>
+o3d::Double best(o3d::Int32 runs, F run)
+{
+    o3d::Double result = 1e9;
+
+    for (o3d::Int32 r = 0; r < runs; ++r) {
+        auto t0 = std::chrono::steady_clock::now();
+        run();
+        auto t1 = std::chrono::steady_clock::now();
+
+        result = std::min(result, std::chrono::duration<o3d::Double>(t1 - t0).count());
+    }
+
+    return result;
+}
+
+o3d::Double mticks(o3d::Double duration)
+{
+    return NUM_TICKS / duration * 1e-6;
+}
+
+} // namespace
+
+/**
+ * Random walk ticks of a quarter of second, given at once to each generator, for each price type.
+ * The result is the best throughput of the runs, in millions of ticks per second.
+ * Only the public generators API is used, for a comparison of two revisions of the generators.
+ * Usage : siis-tickbench [runs]
+ */
+int main(int argc, char **argv)
+{
+    const o3d::Int32 runs = argc > 1 ? std::max(1, atoi(argv[1])) : DEFAULT_RUNS;
+
+    TickArray ticks(NUM_TICKS);
+    ticks.forceSize(NUM_TICKS);
+
+    std::mt19937 rng(1);
+    o3d::Double price = 100.0;
+
+    for (o3d::Int32 i = 0; i < NUM_TICKS; ++i) {
+        price += (static_cast<o3d::Int32>(rng() % 7) - 3) * 0.01;
+        ticks.get(i)->set(1000.0 + i * 0.25, price - 0.005, price + 0.005, price, 1.0, 0);
+    }
+
+    CountAnalyser analyser;
+    o3d::Int64 sink = 0;
+
+    printf("%d ticks, best of %d runs, Mticks/s\n", NUM_TICKS, runs);
+    printf("%-6s %12s %20s %16s %19s\n", "type", "timeframe", "timeframe+analyser", "range+analyser", "reversal+analyser");
+
+    for (o3d::Int32 type = Ohlc::TYPE_LAST; type <= Ohlc::MAX_TYPE; ++type) {
+        const Ohlc::Type ohlcType = static_cast<Ohlc::Type>(type);
+
+        const o3d::Double timeframe = best(runs, [&] () {
+            TimeframeOhlcGen gen(0.0, 60.0, ohlcType);
+            OhlcCircular out(100);
+            sink += gen.genFromTicks(ticks, out);
+        });
+
+        const o3d::Double timeframeAnalyser = best(runs, [&] () {
+            TimeframeOhlcGen gen(0.0, 60.0, ohlcType);
+            OhlcCircular out(100);
+            sink += gen.genFromTicks(ticks, out, analyser);
+        });
+
+        const o3d::Double rangeAnalyser = best(runs, [&] () {
+            RangeOhlcGen gen(10, 1.0, ohlcType);
+            gen.init(2, 0.01);
+            OhlcCircular out(100);
+            sink += gen.genFromTicks(ticks, out, analyser);
+        });
+
+        const o3d::Double reversalAnalyser = best(runs, [&] () {
+            ReversalOhlcGen gen(10, 5, 1.0, ohlcType);
+            gen.init(2, 0.01);
+            OhlcCircular out(100);
+            sink += gen.genFromTicks(ticks, out, analyser);
+        });
+
+        printf("%-6s %12.1f %20.1f %16.1f %19.1f\n", TYPES[type],
+               mticks(timeframe), mticks(timeframeAnalyser), mticks(rangeAnalyser), mticks(reversalAnalyser));
+    }
+
+    // keep the results used
+    printf("%lld bars, %lld analyser ticks\n", static_cast<long long>(sink), static_cast<long long>(analyser.ticks()));
+
+    return 0;
+}